@@ -68,6 +68,13 @@ namespace otb
  * This functionality assumes that all the band involved have the same
  * spacing and origin.
  *
+ * By default, the expression is compiled once into a ParserProgram
+ * shared by all the threads, and evaluated over whole image lines
+ * instead of pixel by pixel. Only the bands used by the expression
+ * are read. Results and underflow/overflow counts are the same as with
+ * the pixel by pixel evaluation, which is still used when scanline
+ * evaluation is turned off or when the expression can not be compiled.
+ *
  *
  * \sa Parser
  *
@@ -101,6 +108,7 @@ public:
   typedef typename ImageType::PointType           OrigineType;
   typedef typename ImageType::SpacingType         SpacingType;
   typedef Parser                                  ParserType;
+  typedef ParserProgram                           ParserProgramType;
   
   /** Set the nth filter input with or without a specified associated variable name */
   void SetNthInput( unsigned int idx, const ImageType * image);
@@ -121,6 +129,11 @@ public:
   /** Return a pointer on the nth filter input */
   ImageType * GetNthInput(unsigned int idx);
 
+  /** Set/Get the scanline evaluation mode (on by default) */
+  itkSetMacro(UseScanlineEvaluation, bool);
+  itkGetMacro(UseScanlineEvaluation, bool);
+  itkBooleanMacro(UseScanlineEvaluation);
+
 protected :
   BandMathImageFilter();
   virtual ~BandMathImageFilter();
@@ -130,12 +143,17 @@ protected :
   void ThreadedGenerateData(const ImageRegionType& outputRegionForThread, int threadId );
   void AfterThreadedGenerateData();
 
+  /** Evaluate the compiled expression line by line */
+  void ScanlineThreadedGenerateData(const ImageRegionType& outputRegionForThread, int threadId );
+
 private :
   BandMathImageFilter(const Self&); //purposely not implemented
   void operator=(const Self&); //purposely not implemented
 
   std::string                           m_Expression;
   std::vector<ParserType::Pointer>      m_VParser;
+  ParserProgramType::Pointer            m_Program;
+  bool                                  m_UseScanlineEvaluation;
   std::vector< std::vector<double> >    m_AImage;
   std::vector< std::string >            m_VVarName;
   unsigned int                          m_NbVar;
@@ -24,6 +24,8 @@
 
 #include "itkImageRegionIterator.h"
 #include "itkImageRegionConstIterator.h"
+#include "itkImageLinearIteratorWithIndex.h"
+#include "itkImageLinearConstIteratorWithIndex.h"
 #include "itkNumericTraits.h"
 #include "itkProgressReporter.h"
 #include "otbMacro.h"
@@ -47,6 +49,7 @@ BandMathImageFilter<TImage>
 
   m_UnderflowCount = 0;
   m_OverflowCount = 0;
+  m_UseScanlineEvaluation = true;
   m_ThreadUnderflow.SetSize(1);
   m_ThreadOverflow.SetSize(1);
 }
@@ -65,6 +68,7 @@ void BandMathImageFilter<TImage>
   Superclass::PrintSelf(os, indent);
 
   os << indent << "Expression: "      << m_Expression                  << std::endl;
+  os << indent << "UseScanlineEvaluation: " << m_UseScanlineEvaluation << std::endl;
   os << indent << "Computed values follow:"                            << std::endl;
   os << indent << "UnderflowCount: "  << m_UnderflowCount              << std::endl;
   os << indent << "OverflowCount: "   << m_OverflowCount               << std::endl;
@@ -213,6 +217,21 @@ void BandMathImageFilter<TImage>
       m_VParser.at(i)->DefineVar(m_VVarName.at(j), &(m_AImage.at(i).at(j)));
       }
     }
+
+  // Compile the expression once, the program is shared by all threads
+  m_Program = NULL;
+  if (m_UseScanlineEvaluation)
+    {
+    ParserProgramType::Pointer program = ParserProgramType::New();
+    if (m_VParser.at(0)->Compile(m_VVarName, program))
+      {
+      m_Program = program;
+      }
+    else
+      {
+      otbMsgDevMacro(<< "Expression " << m_Expression << " can not be compiled, using pixel by pixel evaluation");
+      }
+    }
 }
 
 template< typename TImage >
@@ -247,6 +266,12 @@ void BandMathImageFilter<TImage>
 ::ThreadedGenerateData(const ImageRegionType& outputRegionForThread,
            int threadId)
 {
+  if (m_Program.IsNotNull())
+    {
+    this->ScanlineThreadedGenerateData(outputRegionForThread, threadId);
+    return;
+    }
+
   double value;
   unsigned int j;
   unsigned int nbInputImages = this->GetNumberOfInputs();
@@ -322,6 +347,121 @@ void BandMathImageFilter<TImage>
     }
 }
 
+template< typename TImage >
+void BandMathImageFilter<TImage>
+::ScanlineThreadedGenerateData(const ImageRegionType& outputRegionForThread,
+           int threadId)
+{
+  unsigned int j;
+  unsigned int i;
+  unsigned int nbInputImages = this->GetNumberOfInputs();
+  unsigned int lineLength = outputRegionForThread.GetSize(0);
+  unsigned int stackSize = m_Program->GetStackSize();
+
+  typedef itk::ImageLinearConstIteratorWithIndex<TImage> LineConstIteratorType;
+  typedef itk::ImageLinearIteratorWithIndex<TImage>      LineIteratorType;
+
+  // Line buffers: one per variable, then the program stack and the result
+  std::vector<double> buffer((m_NbVar + stackSize + 1) * lineLength);
+  std::vector<const double *> variables(m_NbVar);
+  for(j=0; j < m_NbVar; j++)
+    {
+    variables[j] = &buffer[j * lineLength];
+    }
+  double * stack = &buffer[m_NbVar * lineLength];
+  double * result = stack + stackSize * lineLength;
+
+  // Only iterate over the bands used by the expression
+  std::vector< LineConstIteratorType > Vit;
+  Vit.resize(nbInputImages);
+  for(j=0; j < nbInputImages; j++)
+    {
+    if (m_Program->IsVariableUsed(j))
+      {
+      Vit[j] = LineConstIteratorType(this->GetNthInput(j), outputRegionForThread);
+      Vit[j].SetDirection(0);
+      Vit[j].GoToBegin();
+      }
+    }
+
+  LineIteratorType ot(this->GetOutput(), outputRegionForThread);
+  ot.SetDirection(0);
+  ot.GoToBegin();
+
+  // support progress methods/callbacks
+  itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels());
+
+  while(!ot.IsAtEnd())
+    {
+    IndexType lineIndex = ot.GetIndex();
+
+    for(j=0; j < nbInputImages; j++)
+      {
+      if (m_Program->IsVariableUsed(j))
+        {
+        double * line = &buffer[j * lineLength];
+        for(i = 0; !Vit[j].IsAtEndOfLine(); ++i, ++Vit[j])
+          {
+          line[i] = static_cast<double>(Vit[j].Get());
+          }
+        Vit[j].NextLine();
+        }
+      }
+
+    // Image Indexes
+    for(j=0; j < 2; j++)
+      {
+      if (m_Program->IsVariableUsed(nbInputImages+j))
+        {
+        double * line = &buffer[(nbInputImages+j) * lineLength];
+        for(i = 0; i < lineLength; ++i)
+          {
+          IndexType index = lineIndex;
+          index[0] += i;
+          line[i] = static_cast<double>(index[j]);
+          }
+        }
+      }
+    for(j=0; j < 2; j++)
+      {
+      if (m_Program->IsVariableUsed(nbInputImages+2+j))
+        {
+        double * line = &buffer[(nbInputImages+2+j) * lineLength];
+        for(i = 0; i < lineLength; ++i)
+          {
+          IndexType index = lineIndex;
+          index[0] += i;
+          line[i] = static_cast<double>(m_Origin[j])
+            +static_cast<double>(index[j]) * static_cast<double>(m_Spacing[j]);
+          }
+        }
+      }
+
+    m_Program->Evaluate(&variables[0], stack, result, lineLength);
+
+    for(i = 0; !ot.IsAtEndOfLine(); ++i, ++ot)
+      {
+      // Same underflow/overflow handling as the pixel by pixel evaluation
+      if (result[i] < double(itk::NumericTraits<PixelType>::NonpositiveMin()))
+        {
+        ot.Set(itk::NumericTraits<PixelType>::NonpositiveMin());
+        m_ThreadUnderflow[threadId]++;
+        }
+      else if (result[i] > double(itk::NumericTraits<PixelType>::max()))
+        {
+        ot.Set(itk::NumericTraits<PixelType>::max());
+        m_ThreadOverflow[threadId]++;
+        }
+      else
+        {
+        ot.Set(static_cast<PixelType>(result[i]));
+        }
+      progress.CompletedPixel();
+      }
+    ot.NextLine();
+    }
+}
+
 }// end namespace otb
 
 #endif
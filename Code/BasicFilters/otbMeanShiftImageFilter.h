@@ -23,6 +23,9 @@
 #include "otbImage.h"
 #include "otbObjectList.h"
 #include "otbPolygon.h"
+#include <map>
+#include <set>
+#include <vector>
 
 namespace otb
 {
@@ -74,17 +77,33 @@ public:
  *
  * The MinimumRegionSize parameter allows you to prune small clustered regions.
  *
- * Please note that the filtering part is multi-threaded, while the clustering one is not (this is
- * not really noticeable, because the clustering step is really faster
- * than the filtering one).
+ * By default, this filter uses the Edison mean shift algorithm implementation. The filtering part is
+ * multi-threaded, while the clustering one is not and is run on the whole requested region after the
+ * threaded part. Results may show seams at the borders of the thread regions and of the streaming tiles.
  *
- * Please also note that if both parts are streamable, only the filtering part will ensure you to get the same
- * results than without streaming. In the clustering results, you
- * might find region split due to tiling. Morover, the labeled output will not give consistent results when
- * streamed. The cluster boundaries might work though.
+ * When UseEdison is off, the filter uses its own mean shift engine instead. Each pixel follows the
+ * mean shift of a joint spatial-range uniform kernel for at most MaxIterationNumber iterations,
+ * or until the squared norm of the shift, normalized by the spatial and range radii, is below
+ * ConvergenceThreshold. Each thread reads the input with a margin of (MaxIterationNumber + 1) *
+ * SpatialRadius pixels, which bounds the pixel trajectories: the filtered output is the same whatever
+ * the number of threads and the streaming tiles. Connected regions are then labeled by each thread
+ * on its own region, stitched deterministically along the borders of the thread regions, fused
+ * when their modes are closer than half the range radius, and regions smaller than MinimumRegionSize
+ * are merged with their closest neighbor. Labels are numbered in the raster order of the first
+ * pixel of each region, so the clustered outputs do not depend on the number of threads either.
  *
- * This filter uses the Edison mean shift algorithm implementation. Please note that data whose precision
- * is more than float are casted to float before processing.
+ * The native engine can also segment an image tile by tile. Fusion and pruning need the regions
+ * of the whole image, so streaming is done in two passes. Between Reset() and Synthetize(), each
+ * tile smaller than the largest possible region is labeled on its own: its labeled output holds
+ * provisional labels, unique over all the tiles, while its clustered and boundaries outputs are
+ * filled with zeros. The statistics and adjacency of the regions of each tile are kept, as well as
+ * the filtered values of its border pixels. Synthetize() then stitches the regions along the tile
+ * borders, fuses and prunes them as above, and fills GetStitchedLabels(), which maps each
+ * provisional label to the label of the whole image segmentation (see itk::ChangeLabelImageFilter),
+ * and GetModes(). The labels are the same whatever the tiles. Only the tables of the regions are
+ * kept between the tiles, so the memory grows with the number of regions instead of the image size.
+ *
+ * Please note that data whose precision is more than float are casted to float before processing.
  *
  * The Scale parameter allows you to stretch the data dynamic
  *
@@ -144,6 +163,9 @@ public:
   /** Typedef for mean-shift modes map */
   typedef std::map<LabelType, InputPixelType> ModeMapType;
 
+  /** Typedef for the map from the provisional labels of the tiles to the final labels */
+  typedef std::map<LabelType, LabelType> LabelMapType;
+
   /** Setters / Getters */
   itkSetMacro(SpatialRadius, unsigned int);
   itkGetMacro(SpatialRadius, unsigned int);
@@ -153,6 +175,13 @@ public:
   itkGetMacro(MinimumRegionSize, unsigned int);
   itkSetMacro(Scale, double);
   itkGetMacro(Scale, double);
+  itkSetMacro(UseEdison, bool);
+  itkGetMacro(UseEdison, bool);
+  itkBooleanMacro(UseEdison);
+  itkSetMacro(MaxIterationNumber, unsigned int);
+  itkGetMacro(MaxIterationNumber, unsigned int);
+  itkSetMacro(ConvergenceThreshold, double);
+  itkGetMacro(ConvergenceThreshold, double);
 
   /** Return the const clustered image output */
   const OutputImageType * GetClusteredOutput() const;
@@ -171,11 +200,23 @@ public:
   {
     return m_Modes;
   }
+  /** Return the final label of each provisional label of the tiles (filled by Synthetize()) */
+  const LabelMapType& GetStitchedLabels() const
+  {
+    return m_StitchedLabels;
+  }
+
+  /** Native engine: clear the regions kept from the previous tiles */
+  void Reset();
+  /** Native engine: stitch, fuse and prune the regions of the tiles processed since Reset() */
+  void Synthetize();
 
 protected:
   /** This filters use a neighborhood around the pixel, so it needs to redfine the
    * input requested region */
   virtual void GenerateInputRequestedRegion();
+  /** Before threaded generate data (allocate the buffers of the native engine) */
+  virtual void BeforeThreadedGenerateData();
   /** Threaded generate data (handle the filtering part) */
   virtual void ThreadedGenerateData(const RegionType& outputRegionForThread, int threadId);
   /** After threaded generate data (handle the clustering part) */
@@ -197,10 +238,61 @@ protected:
   /**PrintSelf method */
   virtual void PrintSelf(std::ostream& os, itk::Indent indent) const;
 
+  /** Native engine: filter the thread region and label its connected regions */
+  void ThreadedMeanShift(const RegionType& outputRegionForThread, int threadId);
+  /** Native engine: stitch the regions of the thread regions, then fuse and prune them, or keep
+   * them for Synthetize() if the requested region is a tile */
+  void ClusterRegions();
+  /** Native engine: accumulate the statistics of the regions of a thread region */
+  void ThreadedRegionStatistics(const RegionType& outputRegionForThread, int threadId);
+  /** Native engine: write the clustered, labeled and boundaries outputs of a thread region */
+  void ThreadedClusteredOutputs(const RegionType& outputRegionForThread, int threadId);
+
+  /** Static function used as a "callback" by the MultiThreader for the clustering passes */
+  static ITK_THREAD_RETURN_TYPE ClusteringThreaderCallback(void *arg);
+
 private:
   MeanShiftImageFilter(const Self &); //purposely not implemented
   void operator =(const Self&);             //purposely not implemented
 
+  /** Statistics of a connected region */
+  struct RegionStatistics
+  {
+    unsigned long       Count;
+    std::vector<double> Sum;
+  };
+  typedef std::map<unsigned int, RegionStatistics>        RegionStatisticsMapType;
+  typedef std::set<std::pair<unsigned int, unsigned int> > RegionAdjacencyType;
+  typedef std::vector<std::set<unsigned int> >             RegionNeighborsType;
+
+  /** Internal structure used to pass the filter and the pass to the threads */
+  struct ClusteringThreadStruct
+  {
+    Pointer Filter;
+    bool    WriteOutputs;
+  };
+
+  /** Root of the connected region of a pixel (offset in the requested region) */
+  unsigned int FindRoot(unsigned int offset) const;
+  /** Merge two connected regions, the root of the lowest offset is kept */
+  void MergeRoots(unsigned int offset1, unsigned int offset2);
+  /** Final label of a pixel */
+  unsigned int GetRegionLabel(unsigned int offset) const;
+  /** True if two filtered pixels belong to the same connected region */
+  bool IsConnected(const float * data1, const float * data2, unsigned int nbComp) const;
+  /** Fuse and prune the regions, sorted by first pixel, and label them in this order.
+   * Fills the modes and the clustered pixel of each label. */
+  void FuseRegions(std::vector<RegionStatistics>& statistics, RegionNeighborsType& neighbors,
+                   std::vector<unsigned int>& labels);
+  /** Keep the regions of the tile for Synthetize(), and give them provisional labels */
+  void KeepTileRegions(const std::vector<RegionStatistics>& statistics, const RegionNeighborsType& neighbors,
+                       std::vector<unsigned int>& labels);
+  /** Margin needed by the native engine around the thread regions */
+  unsigned int GetMeanShiftMargin() const
+  {
+    return (m_MaxIterationNumber + 1) * m_SpatialRadius;
+  }
+
   /** Spatial radius for mean shift convergence */
   unsigned int m_SpatialRadius;
   /** Range radius for mean shift convergence */
@@ -211,6 +303,39 @@ private:
   double m_Scale;
   /** A map of the different modes by segmented regions */
   ModeMapType m_Modes;
+  /** Use the Edison implementation */
+  bool m_UseEdison;
+  /** Maximum number of iterations of the native engine */
+  unsigned int m_MaxIterationNumber;
+  /** Convergence threshold of the native engine */
+  double m_ConvergenceThreshold;
+
+  /** Native engine: the requested region is a tile, whose regions get provisional labels */
+  bool m_ProvisionalLabels;
+  /** Native engine: filtered data of the requested region (scaled) */
+  std::vector<float> m_FilteredData;
+  /** Native engine: union-find forest of the connected regions */
+  std::vector<unsigned int> m_RegionParents;
+  /** Native engine: per thread statistics and adjacency of the regions */
+  std::vector<RegionStatisticsMapType> m_ThreadRegionStatistics;
+  std::vector<RegionAdjacencyType>     m_ThreadRegionAdjacency;
+  /** Native engine: sorted roots of the connected regions and their final label */
+  std::vector<unsigned int> m_RegionRoots;
+  std::vector<unsigned int> m_RootLabels;
+  /** Native engine: clustered pixel of each label */
+  std::vector<OutputPixelType> m_ClusterPixels;
+  /** Native engine: first pixel (offset in the largest possible region), statistics and
+   * adjacency of the regions of the tiles, by provisional label */
+  std::vector<unsigned long>    m_TileRegionFirstPixels;
+  std::vector<RegionStatistics> m_TileRegionStatistics;
+  RegionAdjacencyType           m_TileRegionAdjacency;
+  /** Native engine: index of the border pixels of the tiles (by offset in the largest possible
+   * region), with their provisional label and filtered value (scaled) */
+  std::map<unsigned long, unsigned int> m_TileBorderPixels;
+  std::vector<unsigned int>             m_TileBorderLabels;
+  std::vector<float>                    m_TileBorderData;
+  /** Native engine: final label of each provisional label */
+  LabelMapType m_StitchedLabels;
 };
 } // end namespace otb
 
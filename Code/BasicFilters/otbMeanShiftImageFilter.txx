@@ -21,10 +21,14 @@
 
 #include "otbMeanShiftImageFilter.h"
 
+#include "itkImageRegionConstIterator.h"
 #include "itkImageRegionConstIteratorWithIndex.h"
 #include "itkImageRegionIterator.h"
 #include "itkImageRegionIteratorWithIndex.h"
+#include "itkProgressReporter.h"
 #include "otbMacro.h"
+#include "vcl_cmath.h"
+#include <algorithm>
 
 #include "msImageProcessor.h"
 
@@ -38,6 +42,10 @@ MeanShiftImageFilter<TInputImage, TOutputImage, TLabeledOutput, TBufferConverter
   m_RangeRadius        = 10;
   m_MinimumRegionSize  = 10;
   m_Scale              = 100000.;
+  m_UseEdison          = true;
+  m_MaxIterationNumber = 10;
+  m_ConvergenceThreshold = 0.01;
+  m_ProvisionalLabels = false;
 
   this->SetNumberOfOutputs(4);
   this->SetNthOutput(1, OutputImageType::New());
@@ -163,8 +171,9 @@ MeanShiftImageFilter<TInputImage, TOutputImage, TLabeledOutput, TBufferConverter
   typename TInputImage::RegionType inputRequestedRegion;
   inputRequestedRegion = inputPtr->GetRequestedRegion();
 
-  // pad the input requested region by the operator radius
-  inputRequestedRegion.PadByRadius(static_cast<unsigned int>(m_SpatialRadius));
+  // pad the input requested region by the operator radius (the
+  // native engine needs the whole extent of the pixel trajectories)
+  inputRequestedRegion.PadByRadius(m_UseEdison ? m_SpatialRadius : this->GetMeanShiftMargin());
 
   // crop the input requested region at the input's largest possible region
   if (inputRequestedRegion.Crop(inputPtr->GetLargestPossibleRegion()))
@@ -192,8 +201,44 @@ MeanShiftImageFilter<TInputImage, TOutputImage, TLabeledOutput, TBufferConverter
 template <class TInputImage, class TOutputImage, class TLabeledOutput, class TBufferConverter>
 void
 MeanShiftImageFilter<TInputImage, TOutputImage, TLabeledOutput, TBufferConverter>
-::ThreadedGenerateData(const RegionType& outputRegionForThread, int itkNotUsed(threadId))
+::BeforeThreadedGenerateData()
 {
+  if (m_UseEdison)
+    {
+    return;
+    }
+
+  if (m_SpatialRadius == 0 || m_RangeRadius <= 0)
+    {
+    itkExceptionMacro(<< "Spatial and range radii must be strictly positive");
+    }
+
+  const unsigned int nbComp = this->GetOutput()->GetNumberOfComponentsPerPixel();
+  const unsigned int nbPixels = this->GetOutput()->GetRequestedRegion().GetNumberOfPixels();
+
+  // The regions of a tile get provisional labels, and are fused with
+  // the ones of the other tiles by Synthetize()
+  m_ProvisionalLabels =
+    (this->GetOutput()->GetRequestedRegion() != this->GetOutput()->GetLargestPossibleRegion());
+
+  m_FilteredData.resize(nbPixels * nbComp);
+  m_RegionParents.resize(nbPixels);
+  m_ThreadRegionStatistics.clear();
+  m_ThreadRegionAdjacency.clear();
+  m_Modes.clear();
+}
+
+template <class TInputImage, class TOutputImage, class TLabeledOutput, class TBufferConverter>
+void
+MeanShiftImageFilter<TInputImage, TOutputImage, TLabeledOutput, TBufferConverter>
+::ThreadedGenerateData(const RegionType& outputRegionForThread, int threadId)
+{
+  if (!m_UseEdison)
+    {
+    this->ThreadedMeanShift(outputRegionForThread, threadId);
+    return;
+    }
+
   // Input and output pointers
   typename InputImageType::ConstPointer inputPtr  = this->GetInput();
   typename OutputImageType::Pointer     outputPtr = this->GetOutput();
@@ -284,6 +329,12 @@ void
 MeanShiftImageFilter<TInputImage, TOutputImage, TLabeledOutput, TBufferConverter>
 ::AfterThreadedGenerateData()
 {
+  if (!m_UseEdison)
+    {
+    this->ClusterRegions();
+    return;
+    }
+
   double invScale = 1 / m_Scale;
 
   typename OutputImageType::Pointer   outputPtr = this->GetOutput();
@@ -413,6 +464,918 @@ MeanShiftImageFilter<TInputImage, TOutputImage, TLabeledOutput, TBufferConverter
   delete[] modesPointsCount;
 }
 
+template <class TInputImage, class TOutputImage, class TLabeledOutput, class TBufferConverter>
+void
+MeanShiftImageFilter<TInputImage, TOutputImage, TLabeledOutput, TBufferConverter>
+::ThreadedMeanShift(const RegionType& outputRegionForThread, int threadId)
+{
+  typename InputImageType::ConstPointer inputPtr  = this->GetInput();
+  typename OutputImageType::Pointer     outputPtr = this->GetOutput();
+
+  const unsigned int nbComp = inputPtr->GetNumberOfComponentsPerPixel();
+  const double       invScale = 1 / m_Scale;
+
+  // The margin contains every pixel the trajectories of the thread
+  // region can reach: each iteration moves by at most SpatialRadius
+  RegionType bufferRegion = outputRegionForThread;
+  bufferRegion.PadByRadius(this->GetMeanShiftMargin());
+  bufferRegion.Crop(inputPtr->GetRequestedRegion());
+
+  const long bufferX0 = bufferRegion.GetIndex()[0];
+  const long bufferY0 = bufferRegion.GetIndex()[1];
+  const long bufferX1 = bufferX0 + static_cast<long>(bufferRegion.GetSize()[0]) - 1;
+  const long bufferY1 = bufferY0 + static_cast<long>(bufferRegion.GetSize()[1]) - 1;
+  const long bufferWidth = bufferRegion.GetSize()[0];
+
+  std::vector<float> data(bufferRegion.GetNumberOfPixels() * nbComp);
+  unsigned int       index = 0;
+
+  itk::ImageRegionConstIterator<InputImageType> inputIt(inputPtr, bufferRegion);
+  for (inputIt.GoToBegin(); !inputIt.IsAtEnd(); ++inputIt)
+    {
+    TBufferConverter::PixelToFloatArray(&data[0], index, inputIt.Get(), m_Scale);
+    index += nbComp;
+    }
+
+  const RegionType requestedRegion = outputPtr->GetRequestedRegion();
+  const long       requestedX0 = requestedRegion.GetIndex()[0];
+  const long       requestedY0 = requestedRegion.GetIndex()[1];
+  const long       requestedWidth = requestedRegion.GetSize()[0];
+
+  const long   spatialRadius = m_SpatialRadius;
+  const double spatialRadius2 = static_cast<double>(m_SpatialRadius) * m_SpatialRadius;
+  const double rangeRadius2 = (m_RangeRadius * m_Scale) * (m_RangeRadius * m_Scale);
+
+  std::vector<double> yk(nbComp + 2);
+  std::vector<double> sum(nbComp + 2);
+  std::vector<float>  mode(nbComp);
+
+  itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels());
+
+  itk::ImageRegionIteratorWithIndex<OutputImageType> outputIt(outputPtr, outputRegionForThread);
+  for (outputIt.GoToBegin(); !outputIt.IsAtEnd(); ++outputIt)
+    {
+    const typename RegionType::IndexType pixelIndex = outputIt.GetIndex();
+    const float * pixelData = &data[((pixelIndex[1] - bufferY0) * bufferWidth + pixelIndex[0] - bufferX0) * nbComp];
+
+    yk[0] = pixelIndex[0];
+    yk[1] = pixelIndex[1];
+    std::copy(pixelData, pixelData + nbComp, yk.begin() + 2);
+
+    for (unsigned int iteration = 0; iteration < m_MaxIterationNumber; ++iteration)
+      {
+      // Window of the joint spatial-range uniform kernel
+      const long centerX = static_cast<long>(vcl_floor(yk[0] + 0.5));
+      const long centerY = static_cast<long>(vcl_floor(yk[1] + 0.5));
+      const long x0 = std::max(centerX - spatialRadius, bufferX0);
+      const long x1 = std::min(centerX + spatialRadius, bufferX1);
+      const long y0 = std::max(centerY - spatialRadius, bufferY0);
+      const long y1 = std::min(centerY + spatialRadius, bufferY1);
+
+      std::fill(sum.begin(), sum.end(), 0.);
+      unsigned long count = 0;
+
+      for (long y = y0; y <= y1; ++y)
+        {
+        const double dy = y - yk[1];
+        for (long x = x0; x <= x1; ++x)
+          {
+          const double dx = x - yk[0];
+          if (dx * dx + dy * dy > spatialRadius2)
+            {
+            continue;
+            }
+          const float * neighborData = &data[((y - bufferY0) * bufferWidth + x - bufferX0) * nbComp];
+          double        rangeDistance2 = 0;
+          for (unsigned int comp = 0; comp < nbComp && rangeDistance2 <= rangeRadius2; ++comp)
+            {
+            const double diff = neighborData[comp] - yk[comp + 2];
+            rangeDistance2 += diff * diff;
+            }
+          if (rangeDistance2 > rangeRadius2)
+            {
+            continue;
+            }
+          sum[0] += x;
+          sum[1] += y;
+          for (unsigned int comp = 0; comp < nbComp; ++comp)
+            {
+            sum[comp + 2] += neighborData[comp];
+            }
+          ++count;
+          }
+        }
+
+      if (count == 0)
+        {
+        break;
+        }
+
+      // Shift the window to the mean of its points
+      double spatialShift2 = 0;
+      double rangeShift2 = 0;
+      for (unsigned int dim = 0; dim < nbComp + 2; ++dim)
+        {
+        const double mean = sum[dim] / count;
+        const double shift = mean - yk[dim];
+        if (dim < 2)
+          {
+          spatialShift2 += shift * shift;
+          }
+        else
+          {
+          rangeShift2 += shift * shift;
+          }
+        yk[dim] = mean;
+        }
+
+      if (spatialShift2 / spatialRadius2 + rangeShift2 / rangeRadius2 < m_ConvergenceThreshold)
+        {
+        break;
+        }
+      }
+
+    for (unsigned int comp = 0; comp < nbComp; ++comp)
+      {
+      mode[comp] = static_cast<float>(yk[comp + 2]);
+      }
+    OutputPixelType pixel;
+    TBufferConverter::FloatArrayToPixel(&mode[0], 0, pixel, outputPtr->GetNumberOfComponentsPerPixel(), invScale);
+    outputIt.Set(pixel);
+
+    // The regions are computed from the output values, as in the Edison clustering
+    const unsigned int offset = (pixelIndex[1] - requestedY0) * requestedWidth + pixelIndex[0] - requestedX0;
+    TBufferConverter::PixelToFloatArray(&m_FilteredData[0], offset * nbComp, outputIt.Get(), m_Scale);
+
+    progress.CompletedPixel();
+    }
+
+  // Label the connected regions of the thread region (eight-connected,
+  // previous neighbors only)
+  const long regionX0 = outputRegionForThread.GetIndex()[0];
+  const long regionY0 = outputRegionForThread.GetIndex()[1];
+  const long regionX1 = regionX0 + static_cast<long>(outputRegionForThread.GetSize()[0]) - 1;
+  const long regionY1 = regionY0 + static_cast<long>(outputRegionForThread.GetSize()[1]) - 1;
+
+  for (long y = regionY0; y <= regionY1; ++y)
+    {
+    for (long x = regionX0; x <= regionX1; ++x)
+      {
+      const unsigned int offset = (y - requestedY0) * requestedWidth + x - requestedX0;
+      m_RegionParents[offset] = offset;
+
+      const long neighbors[4][2] = {{x - 1, y}, {x - 1, y - 1}, {x, y - 1}, {x + 1, y - 1}};
+      for (unsigned int n = 0; n < 4; ++n)
+        {
+        if (neighbors[n][0] < regionX0 || neighbors[n][0] > regionX1 || neighbors[n][1] < regionY0)
+          {
+          continue;
+          }
+        const unsigned int neighborOffset = (neighbors[n][1] - requestedY0) * requestedWidth
+                                            + neighbors[n][0] - requestedX0;
+        if (this->IsConnected(&m_FilteredData[offset * nbComp], &m_FilteredData[neighborOffset * nbComp], nbComp))
+          {
+          this->MergeRoots(offset, neighborOffset);
+          }
+        }
+      }
+    }
+}
+
+template <class TInputImage, class TOutputImage, class TLabeledOutput, class TBufferConverter>
+bool
+MeanShiftImageFilter<TInputImage, TOutputImage, TLabeledOutput, TBufferConverter>
+::IsConnected(const float * data1, const float * data2, unsigned int nbComp) const
+{
+  // Same criterion as the Edison implementation: each scaled component
+  // differs by less than one
+  for (unsigned int comp = 0; comp < nbComp; ++comp)
+    {
+    if (vcl_fabs(data1[comp] - data2[comp]) >= 1.0)
+      {
+      return false;
+      }
+    }
+  return true;
+}
+
+template <class TInputImage, class TOutputImage, class TLabeledOutput, class TBufferConverter>
+unsigned int
+MeanShiftImageFilter<TInputImage, TOutputImage, TLabeledOutput, TBufferConverter>
+::FindRoot(unsigned int offset) const
+{
+  while (m_RegionParents[offset] != offset)
+    {
+    offset = m_RegionParents[offset];
+    }
+  return offset;
+}
+
+template <class TInputImage, class TOutputImage, class TLabeledOutput, class TBufferConverter>
+void
+MeanShiftImageFilter<TInputImage, TOutputImage, TLabeledOutput, TBufferConverter>
+::MergeRoots(unsigned int offset1, unsigned int offset2)
+{
+  unsigned int root1 = this->FindRoot(offset1);
+  unsigned int root2 = this->FindRoot(offset2);
+
+  // The root is always the first pixel of the region in raster order,
+  // which makes the labels independent of the thread regions
+  const unsigned int root = std::min(root1, root2);
+
+  // Path compression
+  for (unsigned int offset = offset1; offset != root1; )
+    {
+    const unsigned int parent = m_RegionParents[offset];
+    m_RegionParents[offset] = root;
+    offset = parent;
+    }
+  for (unsigned int offset = offset2; offset != root2; )
+    {
+    const unsigned int parent = m_RegionParents[offset];
+    m_RegionParents[offset] = root;
+    offset = parent;
+    }
+  m_RegionParents[root1] = root;
+  m_RegionParents[root2] = root;
+}
+
+template <class TInputImage, class TOutputImage, class TLabeledOutput, class TBufferConverter>
+unsigned int
+MeanShiftImageFilter<TInputImage, TOutputImage, TLabeledOutput, TBufferConverter>
+::GetRegionLabel(unsigned int offset) const
+{
+  const unsigned int root = this->FindRoot(offset);
+  return m_RootLabels[std::lower_bound(m_RegionRoots.begin(), m_RegionRoots.end(), root) - m_RegionRoots.begin()];
+}
+
+template <class TInputImage, class TOutputImage, class TLabeledOutput, class TBufferConverter>
+ITK_THREAD_RETURN_TYPE
+MeanShiftImageFilter<TInputImage, TOutputImage, TLabeledOutput, TBufferConverter>
+::ClusteringThreaderCallback(void *arg)
+{
+  ClusteringThreadStruct *str;
+  int                     total, threadId, threadCount;
+
+  threadId = ((itk::MultiThreader::ThreadInfoStruct *) (arg))->ThreadID;
+  threadCount = ((itk::MultiThreader::ThreadInfoStruct *) (arg))->NumberOfThreads;
+  str = (ClusteringThreadStruct *) (((itk::MultiThreader::ThreadInfoStruct *) (arg))->UserData);
+
+  // Same split as ThreadedGenerateData()
+  RegionType splitRegion;
+  total = str->Filter->SplitRequestedRegion(threadId, threadCount, splitRegion);
+
+  if (threadId < total)
+    {
+    if (str->WriteOutputs)
+      {
+      str->Filter->ThreadedClusteredOutputs(splitRegion, threadId);
+      }
+    else
+      {
+      str->Filter->ThreadedRegionStatistics(splitRegion, threadId);
+      }
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template <class TInputImage, class TOutputImage, class TLabeledOutput, class TBufferConverter>
+void
+MeanShiftImageFilter<TInputImage, TOutputImage, TLabeledOutput, TBufferConverter>
+::ClusterRegions()
+{
+  typename OutputImageType::Pointer outputPtr = this->GetOutput();
+
+  const RegionType   requestedRegion = outputPtr->GetRequestedRegion();
+  const long         requestedX0 = requestedRegion.GetIndex()[0];
+  const long         requestedY0 = requestedRegion.GetIndex()[1];
+  const long         requestedWidth = requestedRegion.GetSize()[0];
+  const unsigned int nbComp = outputPtr->GetNumberOfComponentsPerPixel();
+  const int          nbThreads = this->GetMultiThreader()->GetNumberOfThreads();
+
+  // Stitch the connected regions along the borders of the thread regions
+  RegionType threadRegion;
+  int        total = this->SplitRequestedRegion(0, nbThreads, threadRegion);
+  for (int threadId = 0; threadId < total; ++threadId)
+    {
+    this->SplitRequestedRegion(threadId, nbThreads, threadRegion);
+
+    const long x0 = threadRegion.GetIndex()[0];
+    const long y0 = threadRegion.GetIndex()[1];
+    const long x1 = x0 + static_cast<long>(threadRegion.GetSize()[0]) - 1;
+    const long y1 = y0 + static_cast<long>(threadRegion.GetSize()[1]) - 1;
+
+    for (long y = y0; y <= y1; ++y)
+      {
+      // Only the border pixels of the thread region
+      const bool borderRow = (y == y0 || y == y1);
+      for (long x = x0; x <= x1; x = (borderRow || x == x1) ? x + 1 : x1)
+        {
+        const unsigned int offset = (y - requestedY0) * requestedWidth + x - requestedX0;
+        for (long dy = -1; dy <= 1; ++dy)
+          {
+          for (long dx = -1; dx <= 1; ++dx)
+            {
+            typename RegionType::IndexType neighborIndex;
+            neighborIndex[0] = x + dx;
+            neighborIndex[1] = y + dy;
+            if (threadRegion.IsInside(neighborIndex) || !requestedRegion.IsInside(neighborIndex))
+              {
+              continue;
+              }
+            const unsigned int neighborOffset = (neighborIndex[1] - requestedY0) * requestedWidth
+                                                + neighborIndex[0] - requestedX0;
+            if (this->IsConnected(&m_FilteredData[offset * nbComp], &m_FilteredData[neighborOffset * nbComp],
+                                  nbComp))
+              {
+              this->MergeRoots(offset, neighborOffset);
+              }
+            }
+          }
+        }
+      }
+    }
+
+  // Statistics and adjacency of the connected regions
+  m_ThreadRegionStatistics.assign(nbThreads, RegionStatisticsMapType());
+  m_ThreadRegionAdjacency.assign(nbThreads, RegionAdjacencyType());
+
+  ClusteringThreadStruct str;
+  str.Filter = this;
+  str.WriteOutputs = false;
+  this->GetMultiThreader()->SetSingleMethod(this->ClusteringThreaderCallback, &str);
+  this->GetMultiThreader()->SingleMethodExecute();
+
+  // Gather the regions, sorted by root
+  RegionStatisticsMapType regionStatistics;
+  RegionAdjacencyType     adjacency;
+  for (int threadId = 0; threadId < nbThreads; ++threadId)
+    {
+    for (typename RegionStatisticsMapType::const_iterator it = m_ThreadRegionStatistics[threadId].begin();
+         it != m_ThreadRegionStatistics[threadId].end(); ++it)
+      {
+      typename RegionStatisticsMapType::iterator regionIt = regionStatistics.find(it->first);
+      if (regionIt == regionStatistics.end())
+        {
+        regionStatistics.insert(*it);
+        }
+      else
+        {
+        regionIt->second.Count += it->second.Count;
+        for (unsigned int comp = 0; comp < nbComp; ++comp)
+          {
+          regionIt->second.Sum[comp] += it->second.Sum[comp];
+          }
+        }
+      }
+    adjacency.insert(m_ThreadRegionAdjacency[threadId].begin(), m_ThreadRegionAdjacency[threadId].end());
+    }
+  m_ThreadRegionStatistics.clear();
+  m_ThreadRegionAdjacency.clear();
+
+  const unsigned int nbRegions = regionStatistics.size();
+  m_RegionRoots.clear();
+  m_RegionRoots.reserve(nbRegions);
+
+  std::vector<RegionStatistics> statistics;
+  statistics.reserve(nbRegions);
+  for (typename RegionStatisticsMapType::const_iterator it = regionStatistics.begin();
+       it != regionStatistics.end(); ++it)
+    {
+    m_RegionRoots.push_back(it->first);
+    statistics.push_back(it->second);
+    }
+  regionStatistics.clear();
+
+  RegionNeighborsType neighbors(nbRegions);
+  for (typename RegionAdjacencyType::const_iterator it = adjacency.begin(); it != adjacency.end(); ++it)
+    {
+    const unsigned int region1 = std::lower_bound(m_RegionRoots.begin(), m_RegionRoots.end(), it->first)
+                                 - m_RegionRoots.begin();
+    const unsigned int region2 = std::lower_bound(m_RegionRoots.begin(), m_RegionRoots.end(), it->second)
+                                 - m_RegionRoots.begin();
+    neighbors[region1].insert(region2);
+    neighbors[region2].insert(region1);
+    }
+  adjacency.clear();
+
+  if (m_ProvisionalLabels)
+    {
+    this->KeepTileRegions(statistics, neighbors, m_RootLabels);
+    otbMsgDevMacro(<< "MeanShiftImageFilter: " << nbRegions << " connected regions in the tile");
+    }
+  else
+    {
+    this->FuseRegions(statistics, neighbors, m_RootLabels);
+    otbMsgDevMacro(<< "MeanShiftImageFilter: " << nbRegions << " connected regions, " << m_ClusterPixels.size()
+                   << " clusters");
+    }
+
+  // Write the outputs
+  str.WriteOutputs = true;
+  this->GetMultiThreader()->SetSingleMethod(this->ClusteringThreaderCallback, &str);
+  this->GetMultiThreader()->SingleMethodExecute();
+
+  m_FilteredData.clear();
+  m_RegionParents.clear();
+  m_RegionRoots.clear();
+  m_RootLabels.clear();
+  m_ClusterPixels.clear();
+}
+
+template <class TInputImage, class TOutputImage, class TLabeledOutput, class TBufferConverter>
+void
+MeanShiftImageFilter<TInputImage, TOutputImage, TLabeledOutput, TBufferConverter>
+::FuseRegions(std::vector<RegionStatistics>& statistics, RegionNeighborsType& neighbors,
+              std::vector<unsigned int>& labels)
+{
+  const unsigned int nbRegions = statistics.size();
+  const unsigned int nbComp = this->GetOutput()->GetNumberOfComponentsPerPixel();
+  const double       invScale = 1 / m_Scale;
+
+  // Regions are merged in a union-find forest of their indices, the
+  // statistics and neighbors being accumulated in the root
+  std::vector<unsigned int> parents(nbRegions);
+  for (unsigned int region = 0; region < nbRegions; ++region)
+    {
+    parents[region] = region;
+    }
+
+  const double rangeRadius = m_RangeRadius * m_Scale;
+  const double fusionDistance2 = 0.25 * rangeRadius * rangeRadius;
+
+  bool merged = true;
+  for (unsigned int pass = 0; merged; ++pass)
+    {
+    merged = false;
+
+    // Fuse the neighboring regions whose modes are close (first
+    // passes), then prune the small regions
+    const bool pruning = (pass >= 5);
+    if (pruning && m_MinimumRegionSize <= 1)
+      {
+      break;
+      }
+
+    for (unsigned int region = 0; region < nbRegions; ++region)
+      {
+      if (parents[region] != region || (pruning && statistics[region].Count >= m_MinimumRegionSize))
+        {
+        continue;
+        }
+
+      // Resolve the current neighbors of the region
+      std::set<unsigned int> currentNeighbors;
+      for (std::set<unsigned int>::const_iterator it = neighbors[region].begin(); it != neighbors[region].end(); ++it)
+        {
+        unsigned int neighbor = *it;
+        while (parents[neighbor] != neighbor)
+          {
+          neighbor = parents[neighbor];
+          }
+        if (neighbor != region)
+          {
+          currentNeighbors.insert(neighbor);
+          }
+        }
+      neighbors[region].swap(currentNeighbors);
+
+      double       bestDistance2 = itk::NumericTraits<double>::max();
+      unsigned int bestNeighbor = region;
+      for (std::set<unsigned int>::const_iterator it = neighbors[region].begin(); it != neighbors[region].end(); ++it)
+        {
+        double distance2 = 0;
+        for (unsigned int comp = 0; comp < nbComp; ++comp)
+          {
+          const double diff = statistics[region].Sum[comp] / statistics[region].Count
+                              - statistics[*it].Sum[comp] / statistics[*it].Count;
+          distance2 += diff * diff;
+          }
+        if (distance2 < bestDistance2)
+          {
+          bestDistance2 = distance2;
+          bestNeighbor = *it;
+          }
+        }
+
+      if (bestNeighbor == region || (!pruning && bestDistance2 >= fusionDistance2))
+        {
+        continue;
+        }
+
+      // Merge into the lowest index
+      const unsigned int root = std::min(region, bestNeighbor);
+      const unsigned int child = std::max(region, bestNeighbor);
+      parents[child] = root;
+      statistics[root].Count += statistics[child].Count;
+      for (unsigned int comp = 0; comp < nbComp; ++comp)
+        {
+        statistics[root].Sum[comp] += statistics[child].Sum[comp];
+        }
+      neighbors[root].insert(neighbors[child].begin(), neighbors[child].end());
+      neighbors[child].clear();
+      merged = true;
+      }
+
+    // Keep on pruning until no small region is left
+    if (!merged && !pruning)
+      {
+      merged = true;
+      pass = 4;
+      }
+    }
+
+  // Labels in the order of the regions
+  labels.assign(nbRegions, 0);
+  m_ClusterPixels.clear();
+  m_Modes.clear();
+  std::vector<float> mode(nbComp);
+  for (unsigned int region = 0; region < nbRegions; ++region)
+    {
+    if (parents[region] == region)
+      {
+      labels[region] = m_ClusterPixels.size();
+
+      for (unsigned int comp = 0; comp < nbComp; ++comp)
+        {
+        mode[comp] = static_cast<float>(statistics[region].Sum[comp] / statistics[region].Count);
+        }
+      OutputPixelType pixel;
+      TBufferConverter::FloatArrayToPixel(&mode[0], 0, pixel, nbComp, invScale);
+      m_Modes[static_cast<LabelType>(m_ClusterPixels.size())] = pixel;
+      m_ClusterPixels.push_back(pixel);
+      }
+    else
+      {
+      // Parents have lower indices, and are already labeled
+      labels[region] = labels[parents[region]];
+      }
+    }
+}
+
+template <class TInputImage, class TOutputImage, class TLabeledOutput, class TBufferConverter>
+void
+MeanShiftImageFilter<TInputImage, TOutputImage, TLabeledOutput, TBufferConverter>
+::KeepTileRegions(const std::vector<RegionStatistics>& statistics, const RegionNeighborsType& neighbors,
+                  std::vector<unsigned int>& labels)
+{
+  const RegionType   requestedRegion = this->GetOutput()->GetRequestedRegion();
+  const RegionType   largestRegion = this->GetOutput()->GetLargestPossibleRegion();
+  const long         requestedX0 = requestedRegion.GetIndex()[0];
+  const long         requestedY0 = requestedRegion.GetIndex()[1];
+  const long         requestedWidth = requestedRegion.GetSize()[0];
+  const long         requestedX1 = requestedX0 + requestedWidth - 1;
+  const long         requestedY1 = requestedY0 + static_cast<long>(requestedRegion.GetSize()[1]) - 1;
+  const long         largestX0 = largestRegion.GetIndex()[0];
+  const long         largestY0 = largestRegion.GetIndex()[1];
+  const long         largestWidth = largestRegion.GetSize()[0];
+  const long         largestX1 = largestX0 + largestWidth - 1;
+  const long         largestY1 = largestY0 + static_cast<long>(largestRegion.GetSize()[1]) - 1;
+  const unsigned int nbComp = m_FilteredData.size() / m_RegionParents.size();
+  const unsigned int nbRegions = statistics.size();
+
+  // The provisional labels follow the ones of the previous tiles
+  const unsigned long firstLabel = m_TileRegionFirstPixels.size();
+  if (firstLabel + nbRegions - 1 > static_cast<unsigned long>(itk::NumericTraits<LabelType>::max()))
+    {
+    itkExceptionMacro(<< "Too many regions in the tiles (" << firstLabel + nbRegions
+                      << ") for the type of the labeled output");
+    }
+
+  labels.resize(nbRegions);
+  for (unsigned int region = 0; region < nbRegions; ++region)
+    {
+    labels[region] = firstLabel + region;
+
+    const long x = requestedX0 + m_RegionRoots[region] % requestedWidth;
+    const long y = requestedY0 + m_RegionRoots[region] / requestedWidth;
+    m_TileRegionFirstPixels.push_back((y - largestY0) * largestWidth + x - largestX0);
+    m_TileRegionStatistics.push_back(statistics[region]);
+
+    for (std::set<unsigned int>::const_iterator it = neighbors[region].begin(); it != neighbors[region].end(); ++it)
+      {
+      if (*it > region)
+        {
+        m_TileRegionAdjacency.insert(std::make_pair(firstLabel + region, firstLabel + *it));
+        }
+      }
+    }
+
+  // Keep the border pixels facing another tile, to stitch the regions
+  for (long y = requestedY0; y <= requestedY1; ++y)
+    {
+    const bool borderRow = (y == requestedY0 || y == requestedY1);
+    for (long x = requestedX0; x <= requestedX1; x = (borderRow || x == requestedX1) ? x + 1 : requestedX1)
+      {
+      if ((x > requestedX0 || x == largestX0) && (x < requestedX1 || x == largestX1)
+          && (y > requestedY0 || y == largestY0) && (y < requestedY1 || y == largestY1))
+        {
+        continue;
+        }
+
+      const unsigned int offset = (y - requestedY0) * requestedWidth + x - requestedX0;
+      const unsigned int region = std::lower_bound(m_RegionRoots.begin(), m_RegionRoots.end(),
+                                                   this->FindRoot(offset)) - m_RegionRoots.begin();
+
+      m_TileBorderPixels[(y - largestY0) * largestWidth + x - largestX0] = m_TileBorderLabels.size();
+      m_TileBorderLabels.push_back(firstLabel + region);
+      m_TileBorderData.insert(m_TileBorderData.end(), m_FilteredData.begin() + offset * nbComp,
+                              m_FilteredData.begin() + (offset + 1) * nbComp);
+      }
+    }
+}
+
+template <class TInputImage, class TOutputImage, class TLabeledOutput, class TBufferConverter>
+void
+MeanShiftImageFilter<TInputImage, TOutputImage, TLabeledOutput, TBufferConverter>
+::Reset()
+{
+  m_TileRegionFirstPixels.clear();
+  m_TileRegionStatistics.clear();
+  m_TileRegionAdjacency.clear();
+  m_TileBorderPixels.clear();
+  m_TileBorderLabels.clear();
+  m_TileBorderData.clear();
+  m_StitchedLabels.clear();
+  m_Modes.clear();
+}
+
+template <class TInputImage, class TOutputImage, class TLabeledOutput, class TBufferConverter>
+void
+MeanShiftImageFilter<TInputImage, TOutputImage, TLabeledOutput, TBufferConverter>
+::Synthetize()
+{
+  const unsigned int nbTileRegions = m_TileRegionFirstPixels.size();
+  if (nbTileRegions == 0)
+    {
+    return;
+    }
+
+  const RegionType   largestRegion = this->GetOutput()->GetLargestPossibleRegion();
+  const long         largestWidth = largestRegion.GetSize()[0];
+  const long         largestHeight = largestRegion.GetSize()[1];
+  const unsigned int nbComp = this->GetOutput()->GetNumberOfComponentsPerPixel();
+
+  // Stitch the regions along the tile borders, in a union-find forest of
+  // the provisional labels, the other neighboring regions being adjacent
+  std::vector<unsigned int> parents(nbTileRegions);
+  for (unsigned int label = 0; label < nbTileRegions; ++label)
+    {
+    parents[label] = label;
+    }
+
+  RegionAdjacencyType adjacency;
+  adjacency.swap(m_TileRegionAdjacency);
+
+  for (std::map<unsigned long, unsigned int>::const_iterator it = m_TileBorderPixels.begin();
+       it != m_TileBorderPixels.end(); ++it)
+    {
+    const long         x = it->first % largestWidth;
+    const long         y = it->first / largestWidth;
+    const unsigned int label = m_TileBorderLabels[it->second];
+
+    // Next neighbors in the eight-connected neighborhood
+    const long neighbors[4][2] = {{x + 1, y}, {x - 1, y + 1}, {x, y + 1}, {x + 1, y + 1}};
+    for (unsigned int n = 0; n < 4; ++n)
+      {
+      if (neighbors[n][0] < 0 || neighbors[n][0] >= largestWidth || neighbors[n][1] >= largestHeight)
+        {
+        continue;
+        }
+
+      // The pixels of another tile are border pixels too
+      std::map<unsigned long, unsigned int>::const_iterator neighborIt =
+        m_TileBorderPixels.find(neighbors[n][1] * largestWidth + neighbors[n][0]);
+      if (neighborIt == m_TileBorderPixels.end() || m_TileBorderLabels[neighborIt->second] == label)
+        {
+        continue;
+        }
+      const unsigned int neighborLabel = m_TileBorderLabels[neighborIt->second];
+
+      if (this->IsConnected(&m_TileBorderData[it->second * nbComp], &m_TileBorderData[neighborIt->second * nbComp],
+                            nbComp))
+        {
+        unsigned int root1 = label;
+        unsigned int root2 = neighborLabel;
+        while (parents[root1] != root1)
+          {
+          root1 = parents[root1];
+          }
+        while (parents[root2] != root2)
+          {
+          root2 = parents[root2];
+          }
+        parents[std::max(root1, root2)] = std::min(root1, root2);
+        }
+      else
+        {
+        adjacency.insert(std::make_pair(std::min(label, neighborLabel), std::max(label, neighborLabel)));
+        }
+      }
+    }
+  m_TileBorderPixels.clear();
+  m_TileBorderLabels.clear();
+  m_TileBorderData.clear();
+
+  // Gather the regions of the whole image in their roots. Parents have
+  // lower labels, so that they are already resolved.
+  for (unsigned int label = 0; label < nbTileRegions; ++label)
+    {
+    const unsigned int root = parents[parents[label]];
+    parents[label] = root;
+    if (root != label)
+      {
+      m_TileRegionFirstPixels[root] = std::min(m_TileRegionFirstPixels[root], m_TileRegionFirstPixels[label]);
+      m_TileRegionStatistics[root].Count += m_TileRegionStatistics[label].Count;
+      for (unsigned int comp = 0; comp < nbComp; ++comp)
+        {
+        m_TileRegionStatistics[root].Sum[comp] += m_TileRegionStatistics[label].Sum[comp];
+        }
+      }
+    }
+
+  // Sort the regions by first pixel, as in ClusterRegions()
+  std::vector<std::pair<unsigned long, unsigned int> > roots;
+  for (unsigned int label = 0; label < nbTileRegions; ++label)
+    {
+    if (parents[label] == label)
+      {
+      roots.push_back(std::make_pair(m_TileRegionFirstPixels[label], label));
+      }
+    }
+  std::sort(roots.begin(), roots.end());
+
+  const unsigned int        nbRegions = roots.size();
+  std::vector<unsigned int> regionIndices(nbTileRegions);
+  std::vector<RegionStatistics> statistics;
+  statistics.reserve(nbRegions);
+  for (unsigned int region = 0; region < nbRegions; ++region)
+    {
+    regionIndices[roots[region].second] = region;
+    statistics.push_back(m_TileRegionStatistics[roots[region].second]);
+    }
+  m_TileRegionFirstPixels.clear();
+  m_TileRegionStatistics.clear();
+
+  RegionNeighborsType neighbors(nbRegions);
+  for (typename RegionAdjacencyType::const_iterator it = adjacency.begin(); it != adjacency.end(); ++it)
+    {
+    const unsigned int region1 = regionIndices[parents[it->first]];
+    const unsigned int region2 = regionIndices[parents[it->second]];
+    if (region1 != region2)
+      {
+      neighbors[region1].insert(region2);
+      neighbors[region2].insert(region1);
+      }
+    }
+  adjacency.clear();
+
+  std::vector<unsigned int> labels;
+  this->FuseRegions(statistics, neighbors, labels);
+  otbMsgDevMacro(<< "MeanShiftImageFilter: " << nbTileRegions << " regions in the tiles, " << nbRegions
+                 << " connected regions, " << m_ClusterPixels.size() << " clusters");
+  m_ClusterPixels.clear();
+
+  m_StitchedLabels.clear();
+  for (unsigned int label = 0; label < nbTileRegions; ++label)
+    {
+    m_StitchedLabels[static_cast<LabelType>(label)] = static_cast<LabelType>(labels[regionIndices[parents[label]]]);
+    }
+}
+
+template <class TInputImage, class TOutputImage, class TLabeledOutput, class TBufferConverter>
+void
+MeanShiftImageFilter<TInputImage, TOutputImage, TLabeledOutput, TBufferConverter>
+::ThreadedRegionStatistics(const RegionType& outputRegionForThread, int threadId)
+{
+  const RegionType   requestedRegion = this->GetOutput()->GetRequestedRegion();
+  const long         requestedX0 = requestedRegion.GetIndex()[0];
+  const long         requestedY0 = requestedRegion.GetIndex()[1];
+  const long         requestedWidth = requestedRegion.GetSize()[0];
+  const long         requestedX1 = requestedX0 + requestedWidth - 1;
+  const long         requestedY1 = requestedY0 + static_cast<long>(requestedRegion.GetSize()[1]) - 1;
+  const unsigned int nbComp = m_FilteredData.size() / m_RegionParents.size();
+
+  RegionStatisticsMapType& regionStatistics = m_ThreadRegionStatistics[threadId];
+  RegionAdjacencyType&     adjacency = m_ThreadRegionAdjacency[threadId];
+
+  const long x0 = outputRegionForThread.GetIndex()[0];
+  const long y0 = outputRegionForThread.GetIndex()[1];
+  const long x1 = x0 + static_cast<long>(outputRegionForThread.GetSize()[0]) - 1;
+  const long y1 = y0 + static_cast<long>(outputRegionForThread.GetSize()[1]) - 1;
+
+  for (long y = y0; y <= y1; ++y)
+    {
+    typename RegionStatisticsMapType::iterator regionIt = regionStatistics.end();
+    for (long x = x0; x <= x1; ++x)
+      {
+      const unsigned int offset = (y - requestedY0) * requestedWidth + x - requestedX0;
+      const unsigned int root = this->FindRoot(offset);
+
+      // Consecutive pixels often belong to the same region
+      if (regionIt == regionStatistics.end() || regionIt->first != root)
+        {
+        regionIt = regionStatistics.find(root);
+        if (regionIt == regionStatistics.end())
+          {
+          RegionStatistics statistics;
+          statistics.Count = 0;
+          statistics.Sum.assign(nbComp, 0.);
+          regionIt = regionStatistics.insert(std::make_pair(root, statistics)).first;
+          }
+        }
+      ++regionIt->second.Count;
+      for (unsigned int comp = 0; comp < nbComp; ++comp)
+        {
+        regionIt->second.Sum[comp] += m_FilteredData[offset * nbComp + comp];
+        }
+
+      // Next neighbors in the eight-connected neighborhood
+      const long neighbors[4][2] = {{x + 1, y}, {x - 1, y + 1}, {x, y + 1}, {x + 1, y + 1}};
+      for (unsigned int n = 0; n < 4; ++n)
+        {
+        if (neighbors[n][0] < requestedX0 || neighbors[n][0] > requestedX1 || neighbors[n][1] > requestedY1)
+          {
+          continue;
+          }
+        const unsigned int neighborRoot = this->FindRoot((neighbors[n][1] - requestedY0) * requestedWidth
+                                                         + neighbors[n][0] - requestedX0);
+        if (neighborRoot != root)
+          {
+          adjacency.insert(std::make_pair(std::min(root, neighborRoot), std::max(root, neighborRoot)));
+          }
+        }
+      }
+    }
+}
+
+template <class TInputImage, class TOutputImage, class TLabeledOutput, class TBufferConverter>
+void
+MeanShiftImageFilter<TInputImage, TOutputImage, TLabeledOutput, TBufferConverter>
+::ThreadedClusteredOutputs(const RegionType& outputRegionForThread, int itkNotUsed(threadId))
+{
+  typename OutputImageType::Pointer   clusteredOutputPtr = this->GetClusteredOutput();
+  typename LabeledOutputType::Pointer labeledClusteredOutputPtr = this->GetLabeledClusteredOutput();
+  typename LabeledOutputType::Pointer clusterBoundariesOutputPtr = this->GetClusterBoundariesOutput();
+
+  const RegionType requestedRegion = this->GetOutput()->GetRequestedRegion();
+  const long       requestedX0 = requestedRegion.GetIndex()[0];
+  const long       requestedY0 = requestedRegion.GetIndex()[1];
+  const long       requestedWidth = requestedRegion.GetSize()[0];
+
+  itk::ImageRegionIteratorWithIndex<OutputImageType> clusteredIt(clusteredOutputPtr, outputRegionForThread);
+  itk::ImageRegionIterator<LabeledOutputType>        labeledIt(labeledClusteredOutputPtr, outputRegionForThread);
+  itk::ImageRegionIterator<LabeledOutputType>        boundariesIt(clusterBoundariesOutputPtr, outputRegionForThread);
+
+  if (m_ProvisionalLabels)
+    {
+    // Only the provisional labels are known in a tile
+    const unsigned int nbComp = this->GetOutput()->GetNumberOfComponentsPerPixel();
+    std::vector<float> zeros(nbComp, 0.);
+    OutputPixelType    zeroPixel;
+    TBufferConverter::FloatArrayToPixel(&zeros[0], 0, zeroPixel, nbComp, 1.);
+
+    for (clusteredIt.GoToBegin(), labeledIt.GoToBegin(), boundariesIt.GoToBegin();
+         !clusteredIt.IsAtEnd(); ++clusteredIt, ++labeledIt, ++boundariesIt)
+      {
+      const typename RegionType::IndexType pixelIndex = clusteredIt.GetIndex();
+      clusteredIt.Set(zeroPixel);
+      labeledIt.Set(static_cast<LabelType>(this->GetRegionLabel((pixelIndex[1] - requestedY0) * requestedWidth
+                                                                + pixelIndex[0] - requestedX0)));
+      boundariesIt.Set(0);
+      }
+    return;
+    }
+
+  for (clusteredIt.GoToBegin(), labeledIt.GoToBegin(), boundariesIt.GoToBegin();
+       !clusteredIt.IsAtEnd(); ++clusteredIt, ++labeledIt, ++boundariesIt)
+    {
+    const typename RegionType::IndexType pixelIndex = clusteredIt.GetIndex();
+    const unsigned int label = this->GetRegionLabel((pixelIndex[1] - requestedY0) * requestedWidth
+                                                    + pixelIndex[0] - requestedX0);
+    clusteredIt.Set(m_ClusterPixels[label]);
+    labeledIt.Set(static_cast<LabelType>(label));
+
+    // A pixel is on a boundary if one of its four neighbors has another label
+    LabelType boundary = 0;
+    const long neighbors[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+    for (unsigned int n = 0; n < 4 && boundary == 0; ++n)
+      {
+      typename RegionType::IndexType neighborIndex = pixelIndex;
+      neighborIndex[0] += neighbors[n][0];
+      neighborIndex[1] += neighbors[n][1];
+      if (requestedRegion.IsInside(neighborIndex)
+          && this->GetRegionLabel((neighborIndex[1] - requestedY0) * requestedWidth
+                                  + neighborIndex[0] - requestedX0) != label)
+        {
+        boundary = 1;
+        }
+      }
+    boundariesIt.Set(boundary);
+    }
+}
+
 template <class TInputImage, class TOutputImage, class TLabeledOutput, class TBufferConverter>
 void
 MeanShiftImageFilter<TInputImage, TOutputImage, TLabeledOutput, TBufferConverter>
@@ -423,6 +1386,9 @@ MeanShiftImageFilter<TInputImage, TOutputImage, TLabeledOutput, TBufferConverter
   os << indent << "Range radius: "                  << m_RangeRadius                 << std::endl;
   os << indent << "Minimum region size: "           << m_MinimumRegionSize           << std::endl;
   os << indent << "Scale: "                         << m_Scale                       << std::endl;
+  os << indent << "Use Edison: "                    << m_UseEdison                   << std::endl;
+  os << indent << "Max iteration number: "          << m_MaxIterationNumber          << std::endl;
+  os << indent << "Convergence threshold: "         << m_ConvergenceThreshold        << std::endl;
 }
 
 } // end namespace otb
@@ -0,0 +1,155 @@
+/*=========================================================================
+
+  Program:   ORFEO Toolbox
+    Language:  C++
+    Date:      $Date$
+    Version:   $Revision$
+
+
+    Copyright (c) Centre National d'Etudes Spatiales. All rights reserved.
+    See OTBCopyright.txt for details.
+
+    Some parts of this code are derived from ITK. See ITKCopyright.txt
+    for details.
+
+
+    This software is distributed WITHOUT ANY WARRANTY; without even
+    the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+        PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+
+#ifndef __otbMultiExpressionBandMathImageFilter_h
+#define __otbMultiExpressionBandMathImageFilter_h
+
+#include "itkImageToImageFilter.h"
+#include "itkArray.h"
+
+#include "otbParser.h"
+#include "otbParserProgramGraph.h"
+
+namespace otb
+{
+/** \class MultiExpressionBandMathImageFilter
+ * \brief Evaluates several mathematical expressions on the input images
+ * in a single pass, one output band per expression.
+ *
+ * This filter accepts the same inputs, variable names (b1, b2...,
+ * idxX, idxY, idxPhyX, idxPhyY), functions and constants as
+ * BandMathImageFilter, but takes a list of expressions and produces a
+ * VectorImage whose nth band holds the result of the nth expression.
+ *
+ * The inputs are read once for all the expressions, and the
+ * expressions are compiled into a single ParserProgramGraph where the
+ * subexpressions they have in common (for instance ndvi(b3, b4) in
+ * "ndvi(b3, b4)" and "ndvi(b3, b4) > 0.2") are only computed once.
+ * Evaluation is done line by line, as in BandMathImageFilter, and each
+ * band is identical to the output of a BandMathImageFilter with the
+ * same expression, including the underflow/overflow handling.
+ *
+ * Expressions with assignments are not supported.
+ *
+ * \sa BandMathImageFilter
+ * \sa ParserProgramGraph
+ *
+ * \ingroup Streamed
+ * \ingroup Threaded
+ */
+
+template< class TImage, class TOutputImage >
+class ITK_EXPORT MultiExpressionBandMathImageFilter
+  : public itk::ImageToImageFilter< TImage, TOutputImage >
+{
+public:
+  /** Standard class typedefs. */
+  typedef MultiExpressionBandMathImageFilter             Self;
+  typedef itk::ImageToImageFilter< TImage, TOutputImage > Superclass;
+  typedef itk::SmartPointer< Self >                      Pointer;
+  typedef itk::SmartPointer< const Self >                ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(MultiExpressionBandMathImageFilter, ImageToImageFilter);
+
+  /** Some convenient typedefs. */
+  typedef TImage                                    ImageType;
+  typedef typename ImageType::ConstPointer          ImagePointer;
+  typedef typename ImageType::RegionType            ImageRegionType;
+  typedef typename ImageType::PixelType             PixelType;
+  typedef typename ImageType::IndexType             IndexType;
+  typedef typename ImageType::PointType             OrigineType;
+  typedef typename ImageType::SpacingType           SpacingType;
+  typedef TOutputImage                              OutputImageType;
+  typedef typename OutputImageType::RegionType      OutputImageRegionType;
+  typedef typename OutputImageType::PixelType       OutputPixelType;
+  typedef typename OutputImageType::InternalPixelType OutputInternalPixelType;
+  typedef Parser                                    ParserType;
+  typedef ParserProgram                             ParserProgramType;
+  typedef ParserProgramGraph                        ParserProgramGraphType;
+  typedef std::vector<std::string>                  ExpressionListType;
+
+  /** Set the nth filter input with or without a specified associated variable name */
+  void SetNthInput( unsigned int idx, const ImageType * image);
+  void SetNthInput( unsigned int idx, const ImageType * image, const std::string& varName);
+
+  /** Change the nth filter input associated variable name */
+  void SetNthInputName(unsigned int idx, const std::string& varName);
+
+  /** Return the nth filter input associated variable name */
+  std::string GetNthInputName(unsigned int idx) const;
+
+  /** Return a pointer on the nth filter input */
+  ImageType * GetNthInput(unsigned int idx);
+
+  /** Set the list of expressions, one per output band */
+  void SetExpressions(const ExpressionListType& expressions);
+
+  /** Return the list of expressions */
+  const ExpressionListType& GetExpressions() const;
+
+  /** Append an expression, computed in a new output band */
+  void AddExpression(const std::string& expression);
+
+  /** Remove all the expressions */
+  void ClearExpressions();
+
+  /** Return the number of expressions, which is the number of output bands */
+  unsigned int GetNumberOfExpressions() const;
+
+protected :
+  MultiExpressionBandMathImageFilter();
+  virtual ~MultiExpressionBandMathImageFilter();
+  virtual void PrintSelf(std::ostream& os, itk::Indent indent) const;
+
+  void GenerateOutputInformation();
+  void BeforeThreadedGenerateData();
+  void ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, int threadId );
+  void AfterThreadedGenerateData();
+
+private :
+  MultiExpressionBandMathImageFilter(const Self&); //purposely not implemented
+  void operator=(const Self&); //purposely not implemented
+
+  ExpressionListType                    m_Expressions;
+  ParserProgramGraphType::Pointer       m_ProgramGraph;
+  std::vector< std::string >            m_VVarName;
+  unsigned int                          m_NbVar;
+
+  SpacingType                           m_Spacing;
+  OrigineType                           m_Origin;
+
+  long                                  m_UnderflowCount;
+  long                                  m_OverflowCount;
+  itk::Array<long>                      m_ThreadUnderflow;
+  itk::Array<long>                      m_ThreadOverflow;
+};
+
+}//end namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbMultiExpressionBandMathImageFilter.txx"
+#endif
+
+#endif
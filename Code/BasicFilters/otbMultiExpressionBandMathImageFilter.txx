@@ -0,0 +1,403 @@
+/*=========================================================================
+
+  Program:   ORFEO Toolbox
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+
+  Copyright (c) Centre National d'Etudes Spatiales. All rights reserved.
+  See OTBCopyright.txt for details.
+
+  Some parts of this code are derived from ITK. See ITKCopyright.txt
+  for details.
+
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __otbMultiExpressionBandMathImageFilter_txx
+#define __otbMultiExpressionBandMathImageFilter_txx
+#include "otbMultiExpressionBandMathImageFilter.h"
+
+#include "itkImageLinearIteratorWithIndex.h"
+#include "itkImageLinearConstIteratorWithIndex.h"
+#include "itkNumericTraits.h"
+#include "itkProgressReporter.h"
+#include "otbMacro.h"
+#include "itkMacro.h"
+
+#include <iostream>
+#include <string>
+#include <sstream>
+
+namespace otb
+{
+
+/** Constructor */
+template <class TImage, class TOutputImage>
+MultiExpressionBandMathImageFilter<TImage, TOutputImage>
+::MultiExpressionBandMathImageFilter()
+{
+  //This number will be incremented each time an image
+  //is added over the one minimumrequired
+  this->SetNumberOfRequiredInputs( 1 );
+
+  m_NbVar = 0;
+  m_UnderflowCount = 0;
+  m_OverflowCount = 0;
+  m_ThreadUnderflow.SetSize(1);
+  m_ThreadOverflow.SetSize(1);
+}
+
+/** Destructor */
+template <class TImage, class TOutputImage>
+MultiExpressionBandMathImageFilter<TImage, TOutputImage>
+::~MultiExpressionBandMathImageFilter()
+{
+}
+
+template <class TImage, class TOutputImage>
+void MultiExpressionBandMathImageFilter<TImage, TOutputImage>
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  for (unsigned int i = 0; i < m_Expressions.size(); ++i)
+    {
+    os << indent << "Expression " << i << ": " << m_Expressions[i] << std::endl;
+    }
+  if (m_ProgramGraph.IsNotNull())
+    {
+    os << indent << "Number of shared operations: " << m_ProgramGraph->GetNumberOfNodes() << std::endl;
+    }
+  os << indent << "Computed values follow:"                            << std::endl;
+  os << indent << "UnderflowCount: "  << m_UnderflowCount              << std::endl;
+  os << indent << "OverflowCount: "   << m_OverflowCount               << std::endl;
+}
+
+template <class TImage, class TOutputImage>
+void MultiExpressionBandMathImageFilter<TImage, TOutputImage>
+::SetNthInput(unsigned int idx, const ImageType * image)
+{
+  this->SetInput(idx, const_cast<TImage *>( image ));
+  unsigned int nbInput = this->GetNumberOfInputs();
+  if (m_VVarName.size() < nbInput)
+    {
+    m_VVarName.resize(nbInput);
+    }
+  std::ostringstream varName;
+  varName << "b" << nbInput;
+  m_VVarName[idx] = varName.str();
+}
+
+template <class TImage, class TOutputImage>
+void MultiExpressionBandMathImageFilter<TImage, TOutputImage>
+::SetNthInput(unsigned int idx, const ImageType * image, const std::string& varName)
+{
+  this->SetInput(idx, const_cast<TImage *>( image ));
+  if (m_VVarName.size() < this->GetNumberOfInputs())
+    {
+    m_VVarName.resize(this->GetNumberOfInputs());
+    }
+  m_VVarName[idx] = varName;
+}
+
+template <class TImage, class TOutputImage>
+void MultiExpressionBandMathImageFilter<TImage, TOutputImage>
+::SetNthInputName(unsigned int idx, const std::string& varName)
+{
+  m_VVarName.at(idx) = varName;
+  this->Modified();
+}
+
+template <class TImage, class TOutputImage>
+std::string MultiExpressionBandMathImageFilter<TImage, TOutputImage>
+::GetNthInputName(unsigned int idx) const
+{
+  return m_VVarName.at(idx);
+}
+
+template <class TImage, class TOutputImage>
+TImage * MultiExpressionBandMathImageFilter<TImage, TOutputImage>
+::GetNthInput(unsigned int idx)
+{
+  return const_cast<TImage *>(this->GetInput(idx));
+}
+
+template <class TImage, class TOutputImage>
+void MultiExpressionBandMathImageFilter<TImage, TOutputImage>
+::SetExpressions(const ExpressionListType& expressions)
+{
+  m_Expressions = expressions;
+  this->Modified();
+}
+
+template <class TImage, class TOutputImage>
+const typename MultiExpressionBandMathImageFilter<TImage, TOutputImage>::ExpressionListType&
+MultiExpressionBandMathImageFilter<TImage, TOutputImage>
+::GetExpressions() const
+{
+  return m_Expressions;
+}
+
+template <class TImage, class TOutputImage>
+void MultiExpressionBandMathImageFilter<TImage, TOutputImage>
+::AddExpression(const std::string& expression)
+{
+  m_Expressions.push_back(expression);
+  this->Modified();
+}
+
+template <class TImage, class TOutputImage>
+void MultiExpressionBandMathImageFilter<TImage, TOutputImage>
+::ClearExpressions()
+{
+  m_Expressions.clear();
+  this->Modified();
+}
+
+template <class TImage, class TOutputImage>
+unsigned int MultiExpressionBandMathImageFilter<TImage, TOutputImage>
+::GetNumberOfExpressions() const
+{
+  return m_Expressions.size();
+}
+
+template <class TImage, class TOutputImage>
+void MultiExpressionBandMathImageFilter<TImage, TOutputImage>
+::GenerateOutputInformation()
+{
+  Superclass::GenerateOutputInformation();
+
+  if (m_Expressions.empty())
+    {
+    itkExceptionMacro(<< "No expression set.");
+    }
+
+  this->GetOutput()->SetNumberOfComponentsPerPixel(m_Expressions.size());
+}
+
+template <class TImage, class TOutputImage>
+void MultiExpressionBandMathImageFilter<TImage, TOutputImage>
+::BeforeThreadedGenerateData()
+{
+  unsigned int nbThreads = this->GetNumberOfThreads();
+  unsigned int nbInputImages = this->GetNumberOfInputs();
+  unsigned int inputSize[2];
+
+  // Check if input image dimensions matches
+  inputSize[0] = this->GetNthInput(0)->GetLargestPossibleRegion().GetSize(0);
+  inputSize[1] = this->GetNthInput(0)->GetLargestPossibleRegion().GetSize(1);
+
+  for(unsigned int p = 1; p < nbInputImages; p++)
+    {
+    if((inputSize[0] != this->GetNthInput(p)->GetLargestPossibleRegion().GetSize(0))
+       || (inputSize[1] != this->GetNthInput(p)->GetLargestPossibleRegion().GetSize(1)))
+      {
+      itkExceptionMacro(<< "Input images must have the same dimensions." << std::endl
+                        << "band #1 is [" << inputSize[0] << ";" << inputSize[1] << "]" << std::endl
+                        << "band #" << p+1 << " is ["
+                        << this->GetNthInput(p)->GetLargestPossibleRegion().GetSize(0) << ";"
+                        << this->GetNthInput(p)->GetLargestPossibleRegion().GetSize(1) << "]");
+      }
+    }
+
+  // Store images specs
+  m_Spacing = this->GetNthInput(0)->GetSpacing();
+  m_Origin = this->GetNthInput(0)->GetOrigin();
+
+  // Allocate and initialize the thread temporaries
+  m_ThreadUnderflow.SetSize(nbThreads);
+  m_ThreadUnderflow.Fill(0);
+  m_ThreadOverflow.SetSize(nbThreads);
+  m_ThreadOverflow.Fill(0);
+
+  // Variables are the input bands followed by the index variables
+  std::vector<std::string> varNames(m_VVarName.begin(), m_VVarName.begin() + nbInputImages);
+  varNames.push_back("idxX");
+  varNames.push_back("idxY");
+  varNames.push_back("idxPhyX");
+  varNames.push_back("idxPhyY");
+  m_NbVar = varNames.size();
+
+  // Compile all the expressions into a single graph, shared by all threads
+  m_ProgramGraph = ParserProgramGraphType::New();
+  ParserType::Pointer parser = ParserType::New();
+
+  for(unsigned int i = 0; i < m_Expressions.size(); i++)
+    {
+    ParserProgramType::Pointer program = ParserProgramType::New();
+    parser->SetExpr(m_Expressions[i]);
+    if (!parser->Compile(varNames, program))
+      {
+      itkExceptionMacro(<< "Expression " << m_Expressions[i] << " can not be compiled.");
+      }
+    m_ProgramGraph->AddProgram(program);
+    }
+
+  otbMsgDevMacro(<< m_Expressions.size() << " expressions compiled into "
+                 << m_ProgramGraph->GetNumberOfNodes() << " operations");
+}
+
+template <class TImage, class TOutputImage>
+void MultiExpressionBandMathImageFilter<TImage, TOutputImage>
+::AfterThreadedGenerateData()
+{
+  unsigned int nbThreads = this->GetNumberOfThreads();
+  unsigned int i;
+
+  m_UnderflowCount = 0;
+  m_OverflowCount = 0;
+
+  // Accumulate counts for each thread
+  for(i = 0; i < nbThreads; i++)
+    {
+    m_UnderflowCount += m_ThreadUnderflow[i];
+    m_OverflowCount += m_ThreadOverflow[i];
+    }
+
+  if((m_UnderflowCount != 0) || (m_OverflowCount!=0))
+    otbWarningMacro(<< std::endl
+        << "The Parsed Expressions Generated "
+        << m_UnderflowCount << " Underflow(s) "
+        << "And " << m_OverflowCount        << " Overflow(s) "   << std::endl
+        << "The Parsed Expressions, The Inputs And The Output "
+        << "Type May Be Incompatible !");
+}
+
+template <class TImage, class TOutputImage>
+void MultiExpressionBandMathImageFilter<TImage, TOutputImage>
+::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread,
+           int threadId)
+{
+  unsigned int j;
+  unsigned int k;
+  unsigned int i;
+  unsigned int nbInputImages = this->GetNumberOfInputs();
+  unsigned int nbOutputs = m_Expressions.size();
+  unsigned int lineLength = outputRegionForThread.GetSize(0);
+  unsigned int nbBuffers = m_ProgramGraph->GetNumberOfBuffers();
+
+  typedef itk::ImageLinearConstIteratorWithIndex<TImage>      LineConstIteratorType;
+  typedef itk::ImageLinearIteratorWithIndex<TOutputImage>     LineIteratorType;
+
+  // Line buffers: one per variable, then the graph scratch arrays and
+  // one per output
+  std::vector<double> buffer((m_NbVar + nbBuffers + nbOutputs) * lineLength);
+  std::vector<const double *> variables(m_NbVar);
+  for(j=0; j < m_NbVar; j++)
+    {
+    variables[j] = &buffer[j * lineLength];
+    }
+  double * scratch = &buffer[m_NbVar * lineLength];
+  std::vector<double *> results(nbOutputs);
+  for(k=0; k < nbOutputs; k++)
+    {
+    results[k] = &buffer[(m_NbVar + nbBuffers + k) * lineLength];
+    }
+
+  // Only iterate over the bands used by the expressions
+  std::vector< LineConstIteratorType > Vit;
+  Vit.resize(nbInputImages);
+  for(j=0; j < nbInputImages; j++)
+    {
+    if (m_ProgramGraph->IsVariableUsed(j))
+      {
+      Vit[j] = LineConstIteratorType(this->GetNthInput(j), outputRegionForThread);
+      Vit[j].SetDirection(0);
+      Vit[j].GoToBegin();
+      }
+    }
+
+  LineIteratorType ot(this->GetOutput(), outputRegionForThread);
+  ot.SetDirection(0);
+  ot.GoToBegin();
+
+  OutputPixelType outputPixel(nbOutputs);
+
+  // support progress methods/callbacks
+  itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels());
+
+  while(!ot.IsAtEnd())
+    {
+    IndexType lineIndex = ot.GetIndex();
+
+    for(j=0; j < nbInputImages; j++)
+      {
+      if (m_ProgramGraph->IsVariableUsed(j))
+        {
+        double * line = &buffer[j * lineLength];
+        for(i = 0; !Vit[j].IsAtEndOfLine(); ++i, ++Vit[j])
+          {
+          line[i] = static_cast<double>(Vit[j].Get());
+          }
+        Vit[j].NextLine();
+        }
+      }
+
+    // Image Indexes
+    for(j=0; j < 2; j++)
+      {
+      if (m_ProgramGraph->IsVariableUsed(nbInputImages+j))
+        {
+        double * line = &buffer[(nbInputImages+j) * lineLength];
+        for(i = 0; i < lineLength; ++i)
+          {
+          IndexType index = lineIndex;
+          index[0] += i;
+          line[i] = static_cast<double>(index[j]);
+          }
+        }
+      }
+    for(j=0; j < 2; j++)
+      {
+      if (m_ProgramGraph->IsVariableUsed(nbInputImages+2+j))
+        {
+        double * line = &buffer[(nbInputImages+2+j) * lineLength];
+        for(i = 0; i < lineLength; ++i)
+          {
+          IndexType index = lineIndex;
+          index[0] += i;
+          line[i] = static_cast<double>(m_Origin[j])
+            +static_cast<double>(index[j]) * static_cast<double>(m_Spacing[j]);
+          }
+        }
+      }
+
+    m_ProgramGraph->Evaluate(&variables[0], scratch, &results[0], lineLength);
+
+    for(i = 0; !ot.IsAtEndOfLine(); ++i, ++ot)
+      {
+      for(k = 0; k < nbOutputs; k++)
+        {
+        double value = results[k][i];
+
+        // Same underflow/overflow handling as BandMathImageFilter
+        if (value < double(itk::NumericTraits<OutputInternalPixelType>::NonpositiveMin()))
+          {
+          outputPixel[k] = itk::NumericTraits<OutputInternalPixelType>::NonpositiveMin();
+          m_ThreadUnderflow[threadId]++;
+          }
+        else if (value > double(itk::NumericTraits<OutputInternalPixelType>::max()))
+          {
+          outputPixel[k] = itk::NumericTraits<OutputInternalPixelType>::max();
+          m_ThreadOverflow[threadId]++;
+          }
+        else
+          {
+          outputPixel[k] = static_cast<OutputInternalPixelType>(value);
+          }
+        }
+      ot.Set(outputPixel);
+      progress.CompletedPixel();
+      }
+    ot.NextLine();
+    }
+}
+
+}// end namespace otb
+
+#endif
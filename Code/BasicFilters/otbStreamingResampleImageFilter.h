@@ -20,7 +20,7 @@
 
 #include "itkImageToImageFilter.h"
 #include "otbStreamingWarpImageFilter.h"
-#include "itkTransformToDeformationFieldSource.h"
+#include "otbBatchTransformToDeformationFieldSource.h"
 #include "itkLinearInterpolateImageFunction.h"
 #include "itkInterpolateImageFunction.h"
 #include "otbImage.h"
@@ -40,7 +40,9 @@ namespace otb
  * otb::VectorImage using a transformation set with SetTransform()
  * method. First, a deformation grid, with a spacing m_DeformationGridSpacing
  * and a size relative to this spacing, is built. Then, the image is
- * wraped using this deformation grid. The size (SetOuputSize()), the
+ * wraped using this deformation grid. Remote sensing and rational
+ * transforms are evaluated one grid row at a time (see
+ * BatchTransformToDeformationFieldSource). The size (SetOuputSize()), the
  * spacing (SetOuputSpacing()), the start index (SetOutputIndex()) and
  * the  interpolator (SetInterpolator()) and the origin (SetOrigin())
  * can be set using the method between brackets.
@@ -84,7 +86,7 @@ public:
                                    DeformationFieldType>        WarpImageFilterType;
   
   /** Internal filters typedefs*/
-  typedef itk::TransformToDeformationFieldSource<DeformationFieldType,
+  typedef BatchTransformToDeformationFieldSource<DeformationFieldType,
                                                  double>        DeformationFieldGeneratorType;
   typedef typename DeformationFieldGeneratorType::TransformType TransformType;
   typedef typename DeformationFieldGeneratorType::SizeType      SizeType;
@@ -18,7 +18,7 @@
 #ifndef __otbCorrelationChangeDetector_h
 #define __otbCorrelationChangeDetector_h
 
-#include "otbBinaryFunctorNeighborhoodImageFilter.h"
+#include "otbBinaryFunctorNeighborhoodSumsImageFilter.h"
 #include "otbCrossCorrelation.h"
 
 namespace otb
@@ -45,12 +45,16 @@ namespace otb
  * The filter expect all images to have the same dimension
  * (e.g. all 2D, or all 3D, or all ND)
  *
+ * Means, variances and covariance are derived from running window sums
+ * (see BinaryFunctorNeighborhoodSumsImageFilter), which makes large radii
+ * as fast as small ones.
+ *
  * \ingroup IntensityImageFilters Multithreaded
  */
 
 template <class TInputImage1, class TInputImage2, class TOutputImage>
 class ITK_EXPORT CorrelationChangeDetector :
-  public BinaryFunctorNeighborhoodImageFilter<
+  public BinaryFunctorNeighborhoodSumsImageFilter<
       TInputImage1, TInputImage2, TOutputImage,
       Functor::CrossCorrelation<
           ITK_TYPENAME itk::ConstNeighborhoodIterator<TInputImage1>,
@@ -60,7 +64,7 @@ class ITK_EXPORT CorrelationChangeDetector :
 public:
   /** Standard class typedefs. */
   typedef CorrelationChangeDetector Self;
-  typedef BinaryFunctorNeighborhoodImageFilter<
+  typedef BinaryFunctorNeighborhoodSumsImageFilter<
       TInputImage1, TInputImage2, TOutputImage,
       Functor::CrossCorrelation<
           ITK_TYPENAME itk::ConstNeighborhoodIterator<TInputImage1>,
@@ -18,6 +18,8 @@
 #ifndef __otbCrossCorrelation_h
 #define __otbCrossCorrelation_h
 
+#include "otbBinaryNeighborhoodSums.h"
+
 namespace otb
 {
 
@@ -96,6 +98,21 @@ public:
       }
     return static_cast<TOutput>(itk::NumericTraits<TOutput>::One - crossCorrel);
   }
+
+  inline TOutput operator ()(const BinaryNeighborhoodSums& sums)
+  {
+    double crossCorrel = 0.;
+
+    if (sums.CenteredSumAA != 0. && sums.CenteredSumBB != 0.)
+      {
+      crossCorrel = sums.CenteredSumAB / vcl_sqrt(sums.CenteredSumAA * sums.CenteredSumBB);
+      }
+    else if (sums.CenteredSumAA == 0. && sums.CenteredSumBB == 0.)
+      {
+      crossCorrel = 1.;
+      }
+    return static_cast<TOutput>(1. - crossCorrel);
+  }
 };
 }
 
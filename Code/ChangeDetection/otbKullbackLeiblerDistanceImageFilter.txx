@@ -143,16 +143,11 @@ CumulantsForEdgeworth<TInput>
 
   double sigma = sqrt(fMu2);
 
-  itk::VariableLengthVector<double> tab(input.Size());
-  double * x = const_cast<double *> (tab.GetDataPointer());
-  for (unsigned long i = 0; i < input.Size(); ++i)
-    *x++ = (static_cast<double> (input.GetPixel(i)) - fMu1) / sigma;
-
+  // Centered moments, without storing the normalized neighborhood
   fMu3 = fMu4 = 0.0;
-  x = const_cast<double *> (tab.GetDataPointer());
   for (unsigned long i = 0; i < input.Size(); ++i)
     {
-    pixel = *x++;
+    pixel = (static_cast<double> (input.GetPixel(i)) - fMu1) / sigma;
     pixel_2 = pixel * pixel;
 
     fMu3 += pixel * pixel_2;
@@ -24,7 +24,6 @@
 #include <vector>
 
 #include "itkArray.h"
-#include "itkArray2D.h"
 #include "itkVariableLengthVector.h"
 
 #include "otbBinaryFunctorNeighborhoodVectorImageFilter.h"
@@ -44,7 +43,16 @@ public:
   typedef std::vector<CumulantType> CumulantSet;
   typedef CumulantSet::iterator     Iterator;
 
-  CumulantsForEdgeworthProfile (const TInput& input, std::vector<itk::Array2D<int> >& mask);
+  /** Neighborhood positions of the pixels added at each scale */
+  typedef std::vector<unsigned long> ShellType;
+  typedef std::vector<ShellType>     ShellSet;
+
+  /** Sums of (pixel - shift)^k, k = 0..4, over the window of each scale */
+  typedef itk::Vector<double, 5> SumType;
+  typedef std::vector<SumType>   SumSet;
+
+  CumulantsForEdgeworthProfile (const TInput& input, const ShellSet& shells);
+  CumulantsForEdgeworthProfile (const SumSet& sums, double shift);
   virtual ~CumulantsForEdgeworthProfile () {}
 
   // Kullback-Leibler Profile
@@ -69,11 +77,13 @@ public:
 protected:
 
   // Momentum Estimation from encapsulated neighborhood
-  int  MakeSumAndMoments(const TInput& input, std::vector<itk::Array2D<int> >& mask);
+  int  MakeSumAndMoments(const TInput& input, const ShellSet& shells);
   // momentum estimation from the smaller window
-  int InitSumAndMoments(const TInput& input, itk::Array2D<int>& mask);
-  //
-  int ReInitSumAndMoments(const TInput& input, itk::Array2D<int>& mask, int level);
+  int InitSumAndMoments(const TInput& input, const ShellType& shell);
+  // momentum update with the pixels of the next scale
+  int ReInitSumAndMoments(const TInput& input, const ShellType& shell, int level);
+  // momentum estimation from the window sums of each scale
+  int MakeMomentsFromSums(const SumSet& sums, double shift);
   // transformation moment -> cumulants (for Edgeworth)
   int MakeCumulants();
 
@@ -109,17 +119,21 @@ public:
   // Gives the size of the profile
   int  GetNumberOfComponentsPerPixel() const
   {
-    return m_mask.size();
+    return m_Shells.size();
   }
   // functor
   TOutput operator ()(const TInput1& it1, const TInput2& it2);
+  // functor, from the window sums of each scale of both images
+  typedef typename CumulantsForEdgeworthProfile<TInput1>::SumSet SumSet;
+  TOutput operator ()(const SumSet& sums1, double shift1, const SumSet& sums2, double shift2);
 protected:
-  // Make the set of masks to play the increase in window size
+  // Make the set of shells to play the increase in window size
   void MakeMultiscaleProfile();
   // Internal attributes
   unsigned char                   m_RadiusMin;
   unsigned char                   m_RadiusMax;
-  std::vector<itk::Array2D<int> > m_mask;
+  // Neighborhood positions of the smaller window, then of each added ring
+  std::vector<std::vector<unsigned long> > m_Shells;
 };
 } // Functor
 
@@ -151,6 +165,14 @@ protected:
  *
  *  TOutput is expected to be a itk::VariableLengthVector< TPixel > and comes from an otbVectorImage< TPixel, 2 >
  *
+ * With UseSlidingMomentsOn(), the sums of the powers of the pixels over the window of each
+ * scale are updated while sliding along the rows, instead of reading the whole neighborhood
+ * of each pixel: the cost per pixel grows linearly with the maximum radius instead of
+ * quadratically. The pixels are shifted by the first pixel of the row to limit the
+ * cancellations, but the moments computed from raw sums remain less accurate than the
+ * default two-pass computation of the smallest window, especially for large pixel values
+ * with a small variance. This mode is off by default.
+ *
  * \ingroup IntensityImageFilters Multithreaded
  */
 template <class TInputImage1, class TInputImage2, class TOutputImage>
@@ -175,17 +197,33 @@ public:
   typedef itk::SmartPointer<Self>       Pointer;
   typedef itk::SmartPointer<const Self> ConstPointer;
 
+  typedef typename Superclass::FunctorType           FunctorType;
+  typedef typename Superclass::OutputImageRegionType OutputImageRegionType;
+  typedef typename Superclass::OutputImagePointer    OutputImagePointer;
+
   /** Method for creation through the object factory. */
   itkNewMacro(Self);
 
+  /** Enable/disable the sliding computation of the window sums.
+   *  Default is off. */
+  itkSetMacro(UseSlidingMoments, bool);
+  itkGetMacro(UseSlidingMoments, bool);
+  itkBooleanMacro(UseSlidingMoments);
+
 protected:
-  KullbackLeiblerProfileImageFilter() {}
+  KullbackLeiblerProfileImageFilter() : m_UseSlidingMoments(false) {}
   virtual ~KullbackLeiblerProfileImageFilter() {}
 
+  /** Compute the profiles from the sliding window sums, or with the
+   *  neighborhood iterators of the superclass */
+  virtual void ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread,
+                                    int threadId);
+
 private:
   KullbackLeiblerProfileImageFilter(const Self &); //purposely not implemented
   void operator =(const Self&); //purposely not implemented
 
+  bool m_UseSlidingMoments;
 };
 
 } // namespace otb
@@ -22,9 +22,13 @@
 #define __otbKullbackLeiblerProfileImageFilter_txx
 
 #include <vector>
+#include <algorithm>
+#include <cstdlib>
 
 #include "otbKullbackLeiblerProfileImageFilter.h"
 #include "otbMath.h"
+#include "itkImageRegionIterator.h"
+#include "itkProgressReporter.h"
 
 namespace otb
 {
@@ -36,9 +40,18 @@ namespace otb
 template <class TInput>
 CumulantsForEdgeworthProfile<TInput>
 ::CumulantsForEdgeworthProfile
-  (const TInput& input, std::vector<itk::Array2D<int> >& mask)
+  (const TInput& input, const ShellSet& shells)
 {
-  m_debug = MakeSumAndMoments(input, mask);
+  m_debug = MakeSumAndMoments(input, shells);
+  MakeCumulants();
+}
+
+template <class TInput>
+CumulantsForEdgeworthProfile<TInput>
+::CumulantsForEdgeworthProfile
+  (const SumSet& sums, double shift)
+{
+  m_debug = MakeMomentsFromSums(sums, shift);
   MakeCumulants();
 }
 
@@ -127,14 +140,14 @@ template <class TInput>
 int
 CumulantsForEdgeworthProfile<TInput>
 ::MakeSumAndMoments
-  (const TInput& input, std::vector<itk::Array2D<int> >& mask)
+  (const TInput& input, const ShellSet& shells)
 {
-  fMu.resize(mask.size());
-  std::vector<itk::Array2D<int> >::iterator iter = mask.begin();
+  fMu.resize(shells.size());
+  typename ShellSet::const_iterator iter = shells.begin();
 
   if (InitSumAndMoments (input, (*iter++))) return 1;
 
-  for (unsigned int level = 1; level < mask.size(); level++)
+  for (unsigned int level = 1; level < shells.size(); level++)
     if (ReInitSumAndMoments(input, (*iter++), level)) return 1;
 
   return 0;
@@ -147,35 +160,23 @@ template <class TInput>
 int
 CumulantsForEdgeworthProfile<TInput>
 ::InitSumAndMoments
-  (const TInput& input, itk::Array2D<int>& mask)
+  (const TInput& input, const ShellType& shell)
 {
   fSum0 = fSum1 = fSum2 = fSum3 = fSum4 = 0.0;
   fMu[0].Fill(0.0);
 
-  unsigned int  i, j;
-  unsigned long k = 0;
-  double        pixel, pixel_2;
+  double pixel, pixel_2;
 
-  // for ( unsigned long i = 0; i < input.Size(); ++i )
-  for (i = 0; i < mask.rows(); ++i)
+  for (typename ShellType::const_iterator k = shell.begin(); k != shell.end(); ++k)
     {
-    for (j = 0; j < mask.cols(); ++j)
-      {
-      // std::cerr << "(" << i << "," << j << ") k=" << k << " ";
-      if (mask.get(i, j) == 1)
-        {
-        pixel = static_cast<double> (input.GetPixel(k));
-        pixel_2 = pixel * pixel;
-
-        fSum0 += 1.0;
-        fSum1 += pixel;
-        fSum2 += pixel_2;
-        fSum3 += pixel_2 * pixel;
-        fSum4 += pixel_2 * pixel_2;
-        // std::cerr << "*\n";
-        }
-      ++k;
-      }
+    pixel = static_cast<double> (input.GetPixel(*k));
+    pixel_2 = pixel * pixel;
+
+    fSum0 += 1.0;
+    fSum1 += pixel;
+    fSum2 += pixel_2;
+    fSum3 += pixel_2 * pixel;
+    fSum4 += pixel_2 * pixel_2;
     }
   if (fSum0 == 0.0)
     {
@@ -196,30 +197,16 @@ CumulantsForEdgeworthProfile<TInput>
 
   double sigma = sqrt(mu2);
 
-  itk::VariableLengthVector<double> tab(input.Size());
-  double * x = const_cast<double *> (tab.GetDataPointer());
-  for (unsigned long cp = 0; cp < input.Size(); ++cp)
-    *x++ = (static_cast<double> (input.GetPixel(cp)) - mu1) / sigma;
-
   double mu3 = 0.0;
   double mu4 = 0.0;
-  x = const_cast<double *> (tab.GetDataPointer());
 
-  // for ( unsigned long i = 0; i < input.Size(); ++i )
-  for (i = 0; i < mask.rows(); ++i)
+  for (typename ShellType::const_iterator k = shell.begin(); k != shell.end(); ++k)
     {
-    for (j = 0; j < mask.cols(); ++j)
-      {
-      if (mask.get(i, j) == 1)
-        {
-        pixel = *x++;
-        pixel_2 = pixel * pixel;
+    pixel = (static_cast<double> (input.GetPixel(*k)) - mu1) / sigma;
+    pixel_2 = pixel * pixel;
 
-        mu3 += pixel * pixel_2;
-        mu4 += pixel_2 * pixel_2;
-        }
-      else ++x;
-      }
+    mu3 += pixel * pixel_2;
+    mu4 += pixel_2 * pixel_2;
     }
 
   mu3 /= fSum0;
@@ -247,7 +234,7 @@ template <class TInput>
 int
 CumulantsForEdgeworthProfile<TInput>
 ::ReInitSumAndMoments
-  (const TInput& input, itk::Array2D<int>& mask, int level)
+  (const TInput& input, const ShellType& shell, int level)
 {
   fMu[level].Fill(0.0);
   // mise a jour du comptage...
@@ -259,27 +246,17 @@ CumulantsForEdgeworthProfile<TInput>
 
   double pixel, pixel_2;
 
-  unsigned int  i, j;
-  unsigned long k = 0L;
-
-  // for ( unsigned long i = 0; i < input.Size(); ++i )
-  for (i = 0; i < mask.rows(); ++i)
+  // only the ring added at this scale is read
+  for (typename ShellType::const_iterator k = shell.begin(); k != shell.end(); ++k)
     {
-    for (j = 0; j < mask.cols(); ++j)
-      {
-      if (mask.get(i, j) == 1)
-        {
-        pixel = static_cast<double> (input.GetPixel(k));
-        pixel_2 = pixel * pixel;
-
-        sum0 += 1.0;
-        sum1 += pixel;
-        sum2 += pixel_2;
-        sum3 += pixel * pixel_2;
-        sum4 += pixel_2 * pixel_2;
-        }
-      ++k;
-      }
+    pixel = static_cast<double> (input.GetPixel(*k));
+    pixel_2 = pixel * pixel;
+
+    sum0 += 1.0;
+    sum1 += pixel;
+    sum2 += pixel_2;
+    sum3 += pixel * pixel_2;
+    sum4 += pixel_2 * pixel_2;
     }
 
   fSum0 += sum0;
@@ -310,6 +287,71 @@ CumulantsForEdgeworthProfile<TInput>
   return 0;
 }
 
+/* ============ Estimation des moments a partir des sommes ============ */
+
+template <class TInput>
+int
+CumulantsForEdgeworthProfile<TInput>
+::MakeMomentsFromSums
+  (const SumSet& sums, double shift)
+{
+  fMu.resize(sums.size());
+
+  for (unsigned int level = 0; level < sums.size(); level++)
+    {
+    const double sum0 = sums[level][0];
+    const double mean1 = sums[level][1] / sum0;
+    const double mean2 = sums[level][2] / sum0;
+    const double mean3 = sums[level][3] / sum0;
+    const double mean4 = sums[level][4] / sum0;
+
+    // Centered moments, which do not depend on the shift
+    const double mu1 = mean1 + shift;
+    const double mu2 = mean2 - mean1 * mean1;
+    const double mu3 = mean3 - 3.0 * mean1 * mean2 + 2.0 * mean1 * mean1 * mean1;
+    const double mu4 = mean4 - 4.0 * mean1 * mean3 + 6.0 * mean1 * mean1 * mean2
+                       - 3.0 * mean1 * mean1 * mean1 * mean1;
+
+    fMu[level][0] = mu1;
+    fMu[level][1] = mu2;
+
+    if (level == 0)
+      {
+      // Same normalization and checks as InitSumAndMoments()
+      if (!(mu2 > 0.0))
+        {
+        fDataAvailable = false;
+        return 1;
+        }
+
+      double sigma = sqrt(mu2);
+      fMu[0][2] = mu3 / (sigma * mu2);
+      fMu[0][3] = mu4 / (mu2 * mu2);
+
+      if (vnl_math_isnan(fMu[0][2]) || vnl_math_isnan(fMu[0][3]))
+        {
+        fDataAvailable = false;
+        return 1;
+        }
+      }
+    else
+      {
+      // Same normalization as ReInitSumAndMoments(), by the sum of the
+      // squares of the pixels which are not shifted
+      const double sumSquares = sums[level][2] + shift * (2.0 * sums[level][1] + sum0 * shift);
+      const double sigma = sqrt(sumSquares);
+
+      fMu[level][2] = mu3 / (sigma * sumSquares);
+      fMu[level][3] = mu4 / (sumSquares * sumSquares);
+      }
+    }
+
+  fSum0 = sums.back()[0];
+  fDataAvailable = true;
+
+  return 0;
+}
+
 /* =========== transformation moment -> cumulants ==================== */
 
 template <class TInput>
@@ -374,44 +416,28 @@ KullbackLeiblerProfile<TInput1, TInput2, TOutput>
   return m_RadiusMax;
 }
 
-/* ====== Make the set of masks to play the increase in window size == */
+/* ====== Make the set of shells to play the increase in window size = */
 
 template<class TInput1, class TInput2, class TOutput>
 void
 KullbackLeiblerProfile<TInput1, TInput2, TOutput>
 ::MakeMultiscaleProfile()
 {
-  m_mask.resize(m_RadiusMax - m_RadiusMin + 1);
+  m_Shells.clear();
+  m_Shells.resize(m_RadiusMax - m_RadiusMin + 1);
   int lenMax = 2 * m_RadiusMax + 1;
   int i, j, middle = m_RadiusMax;
 
-  // let's begin by the smaller neighborhood
-  std::vector<itk::Array2D<int> >::iterator outer_iter = m_mask.begin();
-  (*outer_iter).SetSize(lenMax, lenMax);
-  (*outer_iter).fill(0);
-  for (i = middle - m_RadiusMin; i <= middle + m_RadiusMin; ++i)
-    for (j = middle - m_RadiusMin; j <= middle + m_RadiusMin; ++j)
-      (*outer_iter).put(i, j, 1);
-
-  // std::cerr << "outerIter = " << (*outer_iter) << std::endl;
-
-  // let's continue with increasing neighborhoods
-  ++outer_iter;
-  for (int radius = m_RadiusMin + 1; radius <= m_RadiusMax; ++radius)
+  // Each neighborhood position is given to the scale where it enters the
+  // window, scanning rows in the neighborhood order
+  for (i = 0; i < lenMax; ++i)
     {
-    (*outer_iter).SetSize(lenMax, lenMax);
-    (*outer_iter).fill(0);
-
-    for (i = middle - radius; i <= middle + radius; ++i)
+    for (j = 0; j < lenMax; ++j)
       {
-      (*outer_iter).put(i, middle - radius, 1);
-      (*outer_iter).put(i, middle + radius, 1);
-      (*outer_iter).put(middle - radius, i, 1);
-      (*outer_iter).put(middle + radius, i, 1);
+      int radius = std::max(std::abs(i - middle), std::abs(j - middle));
+      int level = radius > m_RadiusMin ? radius - m_RadiusMin : 0;
+      m_Shells[level].push_back(i * lenMax + j);
       }
-
-    // std::cerr << "outerIter = " << (*outer_iter) << std::endl;
-    ++outer_iter;
     }
 }
 
@@ -423,7 +449,34 @@ KullbackLeiblerProfile<TInput1, TInput2, TOutput>
 ::operator()
   (const TInput1 &it1, const TInput2 &it2)
   {
-  CumulantsForEdgeworthProfile<TInput1> cum1(it1, m_mask);
+  CumulantsForEdgeworthProfile<TInput1> cum1(it1, m_Shells);
+
+  if (cum1.m_debug)
+    {
+    itk::VariableLengthVector<double> resu(m_RadiusMax - m_RadiusMin + 1);
+    resu.Fill(1e3);
+    return static_cast<TOutput> (resu);
+    }
+
+  CumulantsForEdgeworthProfile<TInput2> cum2(it2, m_Shells);
+
+  if (cum2.m_debug)
+    {
+    itk::VariableLengthVector<double> resu(m_RadiusMax - m_RadiusMin + 1);
+    resu.Fill(1e3);
+    return static_cast<TOutput> (resu);
+    }
+
+  return static_cast<TOutput> (cum1.KL_profile(cum2) + cum2.KL_profile(cum1));
+  }
+
+template<class TInput1, class TInput2, class TOutput>
+TOutput
+KullbackLeiblerProfile<TInput1, TInput2, TOutput>
+::operator()
+  (const SumSet& sums1, double shift1, const SumSet& sums2, double shift2)
+  {
+  CumulantsForEdgeworthProfile<TInput1> cum1(sums1, shift1);
 
   if (cum1.m_debug)
     {
@@ -432,7 +485,7 @@ KullbackLeiblerProfile<TInput1, TInput2, TOutput>
     return static_cast<TOutput> (resu);
     }
 
-  CumulantsForEdgeworthProfile<TInput2> cum2(it2, m_mask);
+  CumulantsForEdgeworthProfile<TInput2> cum2(sums2, shift2);
 
   if (cum2.m_debug)
     {
@@ -446,6 +499,167 @@ KullbackLeiblerProfile<TInput1, TInput2, TOutput>
 
 } // Functor
 
+/* *******************************************************************
+*
+*  Filter
+*
+* ********************************************************************
+*/
+
+template <class TInputImage1, class TInputImage2, class TOutputImage>
+void
+KullbackLeiblerProfileImageFilter<TInputImage1, TInputImage2, TOutputImage>
+::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread,
+                       int threadId)
+{
+  if (!m_UseSlidingMoments)
+    {
+    Superclass::ThreadedGenerateData(outputRegionForThread, threadId);
+    return;
+    }
+
+  const TInputImage1 * inputPtr1 = dynamic_cast<const TInputImage1 *>(this->itk::ProcessObject::GetInput(0));
+  const TInputImage2 * inputPtr2 = dynamic_cast<const TInputImage2 *>(this->itk::ProcessObject::GetInput(1));
+  OutputImagePointer   outputPtr = this->GetOutput();
+
+  FunctorType& functor = this->GetFunctor();
+
+  typedef typename FunctorType::SumSet SumSet;
+  const unsigned int nbSums = 5;
+
+  const long radiusMin = functor.GetRadiusMin();
+  const long radiusMax = functor.GetRadiusMax();
+  const long nbScales = radiusMax - radiusMin + 1;
+  const long width = outputRegionForThread.GetSize()[0];
+  const long height = outputRegionForThread.GetSize()[1];
+  const long startX = outputRegionForThread.GetIndex()[0];
+  const long startY = outputRegionForThread.GetIndex()[1];
+  const long paddedWidth = width + 2 * radiusMax;
+
+  // The image borders are handled as a zero flux Neumann boundary
+  // condition on the buffered region, like the neighborhood iterators
+  const typename TInputImage1::RegionType bufferedRegion1 = inputPtr1->GetBufferedRegion();
+  const typename TInputImage2::RegionType bufferedRegion2 = inputPtr2->GetBufferedRegion();
+
+  // Sums over the column of height 2*r+1 of each scale, for each padded column
+  std::vector<double> columnSums1(nbSums * nbScales * paddedWidth);
+  std::vector<double> columnSums2(nbSums * nbScales * paddedWidth);
+
+  SumSet windowSums1(nbScales);
+  SumSet windowSums2(nbScales);
+
+  // support progress methods/callbacks
+  itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels());
+
+  itk::ImageRegionIterator<TOutputImage> outputIt(outputPtr, outputRegionForThread);
+  outputIt.GoToBegin();
+
+  typename TInputImage1::IndexType index1;
+  typename TInputImage2::IndexType index2;
+
+  for (long y = startY; y < startY + height; ++y)
+    {
+    // The pixels are shifted by the first pixel of the row
+    index1[0] = std::min(std::max(startX, static_cast<long>(bufferedRegion1.GetIndex()[0])),
+                         static_cast<long>(bufferedRegion1.GetIndex()[0] + bufferedRegion1.GetSize()[0]) - 1);
+    index1[1] = std::min(std::max(y, static_cast<long>(bufferedRegion1.GetIndex()[1])),
+                         static_cast<long>(bufferedRegion1.GetIndex()[1] + bufferedRegion1.GetSize()[1]) - 1);
+    index2[0] = std::min(std::max(startX, static_cast<long>(bufferedRegion2.GetIndex()[0])),
+                         static_cast<long>(bufferedRegion2.GetIndex()[0] + bufferedRegion2.GetSize()[0]) - 1);
+    index2[1] = std::min(std::max(y, static_cast<long>(bufferedRegion2.GetIndex()[1])),
+                         static_cast<long>(bufferedRegion2.GetIndex()[1] + bufferedRegion2.GetSize()[1]) - 1);
+    const double shift1 = static_cast<double>(inputPtr1->GetPixel(index1));
+    const double shift2 = static_cast<double>(inputPtr2->GetPixel(index2));
+
+    // Column sums of all the scales, the column growing by one pixel
+    // above and below at each scale
+    for (long column = 0; column < paddedWidth; ++column)
+      {
+      const long x = startX - radiusMax + column;
+      index1[0] = std::min(std::max(x, static_cast<long>(bufferedRegion1.GetIndex()[0])),
+                           static_cast<long>(bufferedRegion1.GetIndex()[0] + bufferedRegion1.GetSize()[0]) - 1);
+      index2[0] = std::min(std::max(x, static_cast<long>(bufferedRegion2.GetIndex()[0])),
+                           static_cast<long>(bufferedRegion2.GetIndex()[0] + bufferedRegion2.GetSize()[0]) - 1);
+
+      double sums1[5] = {0., 0., 0., 0., 0.};
+      double sums2[5] = {0., 0., 0., 0., 0.};
+      for (long dy = 0; dy <= radiusMax; ++dy)
+        {
+        for (long side = (dy == 0 ? 1 : -1); side <= 1; side += 2)
+          {
+          const long yy = y + side * dy;
+          index1[1] = std::min(std::max(yy, static_cast<long>(bufferedRegion1.GetIndex()[1])),
+                               static_cast<long>(bufferedRegion1.GetIndex()[1] + bufferedRegion1.GetSize()[1]) - 1);
+          index2[1] = std::min(std::max(yy, static_cast<long>(bufferedRegion2.GetIndex()[1])),
+                               static_cast<long>(bufferedRegion2.GetIndex()[1] + bufferedRegion2.GetSize()[1]) - 1);
+
+          const double pixel1 = static_cast<double>(inputPtr1->GetPixel(index1)) - shift1;
+          const double pixel1_2 = pixel1 * pixel1;
+          sums1[0] += 1.0;
+          sums1[1] += pixel1;
+          sums1[2] += pixel1_2;
+          sums1[3] += pixel1_2 * pixel1;
+          sums1[4] += pixel1_2 * pixel1_2;
+
+          const double pixel2 = static_cast<double>(inputPtr2->GetPixel(index2)) - shift2;
+          const double pixel2_2 = pixel2 * pixel2;
+          sums2[0] += 1.0;
+          sums2[1] += pixel2;
+          sums2[2] += pixel2_2;
+          sums2[3] += pixel2_2 * pixel2;
+          sums2[4] += pixel2_2 * pixel2_2;
+          }
+
+        if (dy >= radiusMin)
+          {
+          const long offset = nbSums * ((dy - radiusMin) * paddedWidth + column);
+          std::copy(sums1, sums1 + nbSums, &columnSums1[offset]);
+          std::copy(sums2, sums2 + nbSums, &columnSums2[offset]);
+          }
+        }
+      }
+
+    // Window sums of each scale, sliding along the row
+    for (long column = 0; column < width; ++column)
+      {
+      for (long level = 0; level < nbScales; ++level)
+        {
+        const long    radius = radiusMin + level;
+        const double * scaleSums1 = &columnSums1[nbSums * level * paddedWidth];
+        const double * scaleSums2 = &columnSums2[nbSums * level * paddedWidth];
+
+        if (column == 0)
+          {
+          windowSums1[level].Fill(0.0);
+          windowSums2[level].Fill(0.0);
+          for (long c = radiusMax - radius; c <= radiusMax + radius; ++c)
+            {
+            for (unsigned int s = 0; s < nbSums; ++s)
+              {
+              windowSums1[level][s] += scaleSums1[nbSums * c + s];
+              windowSums2[level][s] += scaleSums2[nbSums * c + s];
+              }
+            }
+          }
+        else
+          {
+          const long added = column + radiusMax + radius;
+          const long removed = column + radiusMax - radius - 1;
+          for (unsigned int s = 0; s < nbSums; ++s)
+            {
+            windowSums1[level][s] += scaleSums1[nbSums * added + s] - scaleSums1[nbSums * removed + s];
+            windowSums2[level][s] += scaleSums2[nbSums * added + s] - scaleSums2[nbSums * removed + s];
+            }
+          }
+        }
+
+      outputIt.Set(functor(windowSums1, shift1, windowSums2, shift2));
+      ++outputIt;
+      progress.CompletedPixel();
+      }
+    }
+}
+
 } // namespace otb
 
 #endif
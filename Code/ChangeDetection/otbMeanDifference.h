@@ -18,6 +18,8 @@
 #ifndef __otbMeanDifference_h
 #define __otbMeanDifference_h
 
+#include "otbBinaryNeighborhoodSums.h"
+
 namespace otb
 {
 
@@ -46,6 +48,14 @@ public:
       }
     return static_cast<TOutput>((meanA - meanB) / itA.Size());
   }
+
+  inline TOutput operator ()(const BinaryNeighborhoodSums& sums)
+  {
+    TOutput meanA = static_cast<TOutput>(sums.SumA);
+    TOutput meanB = static_cast<TOutput>(sums.SumB);
+
+    return static_cast<TOutput>((meanA - meanB) / static_cast<TOutput>(sums.Count));
+  }
 };
 }
 }
@@ -18,7 +18,7 @@
 #ifndef __otbMeanDifferenceImageFilter_h
 #define __otbMeanDifferenceImageFilter_h
 
-#include "otbBinaryFunctorNeighborhoodImageFilter.h"
+#include "otbBinaryFunctorNeighborhoodSumsImageFilter.h"
 #include "otbMeanDifference.h"
 
 namespace otb
@@ -44,12 +44,15 @@ namespace otb
  * The filter expect all images to have the same dimension
  * (e.g. all 2D, or all 3D, or all ND)
  *
+ * The mean difference is computed from window sums updated along the rows
+ * and columns (see BinaryFunctorNeighborhoodSumsImageFilter).
+ *
  * \ingroup IntensityImageFilters Multithreaded
  */
 
 template <class TInputImage1, class TInputImage2, class TOutputImage>
 class ITK_EXPORT MeanDifferenceImageFilter :
-  public BinaryFunctorNeighborhoodImageFilter<
+  public BinaryFunctorNeighborhoodSumsImageFilter<
       TInputImage1, TInputImage2, TOutputImage,
       Functor::MeanDifference<
           ITK_TYPENAME itk::ConstNeighborhoodIterator<TInputImage1>,
@@ -59,7 +62,7 @@ class ITK_EXPORT MeanDifferenceImageFilter :
 public:
   /** Standard class typedefs. */
   typedef MeanDifferenceImageFilter Self;
-  typedef BinaryFunctorNeighborhoodImageFilter<
+  typedef BinaryFunctorNeighborhoodSumsImageFilter<
       TInputImage1, TInputImage2, TOutputImage,
       Functor::MeanDifference<
           ITK_TYPENAME itk::ConstNeighborhoodIterator<TInputImage1>,
@@ -19,6 +19,7 @@
 #define __otbMeanRatio_h
 
 #include "otbBinaryFunctorNeighborhoodImageFilter.h"
+#include "otbBinaryNeighborhoodSums.h"
 
 namespace otb
 {
@@ -70,6 +71,23 @@ public:
 
     return ratio;
   }
+
+  inline TOutput operator ()(const BinaryNeighborhoodSums& sums)
+  {
+    TOutput meanA = static_cast<TOutput>(sums.SumA);
+    TOutput meanB = static_cast<TOutput>(sums.SumB);
+
+    meanA /= static_cast<TOutput>(sums.Count);
+    meanB /= static_cast<TOutput>(sums.Count);
+
+    TOutput ratio;
+
+    if (meanA == meanB) ratio = 0.;
+    else if (meanA > meanB) ratio = static_cast<TOutput>(1.0 - meanB / meanA);
+    else ratio = static_cast<TOutput>(1.0 - meanA / meanB);
+
+    return ratio;
+  }
 };
 }
 } // end namespace otb
@@ -18,7 +18,7 @@
 #ifndef __otbMeanRatioImageFilter_h
 #define __otbMeanRatioImageFilter_h
 
-#include "otbBinaryFunctorNeighborhoodImageFilter.h"
+#include "otbBinaryFunctorNeighborhoodSumsImageFilter.h"
 #include "otbMeanRatio.h"
 
 namespace otb
@@ -43,12 +43,15 @@ namespace otb
  * The filter expect all images to have the same dimension
  * (e.g. all 2D, or all 3D, or all ND)
  *
+ * The neighborhood means are obtained from running window sums, so the
+ * cost per pixel does not depend on the radius.
+ *
  * \ingroup IntensityImageFilters Multithreaded
  */
 
 template <class TInputImage1, class TInputImage2, class TOutputImage>
 class ITK_EXPORT MeanRatioImageFilter :
-  public BinaryFunctorNeighborhoodImageFilter<
+  public BinaryFunctorNeighborhoodSumsImageFilter<
       TInputImage1, TInputImage2, TOutputImage,
       Functor::MeanRatio<
           ITK_TYPENAME itk::ConstNeighborhoodIterator<TInputImage1>,
@@ -58,7 +61,7 @@ class ITK_EXPORT MeanRatioImageFilter :
 public:
   /** Standard class typedefs. */
   typedef MeanRatioImageFilter Self;
-  typedef BinaryFunctorNeighborhoodImageFilter<
+  typedef BinaryFunctorNeighborhoodSumsImageFilter<
       TInputImage1, TInputImage2, TOutputImage,
       Functor::MeanRatio<
           ITK_TYPENAME itk::ConstNeighborhoodIterator<TInputImage1>,
@@ -0,0 +1,89 @@
+/*=========================================================================
+
+  Program:   ORFEO Toolbox
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+
+  Copyright (c) Centre National d'Etudes Spatiales. All rights reserved.
+  See OTBCopyright.txt for details.
+
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __otbBinaryFunctorNeighborhoodSumsImageFilter_h
+#define __otbBinaryFunctorNeighborhoodSumsImageFilter_h
+
+#include "otbBinaryFunctorNeighborhoodImageFilter.h"
+#include "otbBinaryNeighborhoodSums.h"
+
+namespace otb
+{
+
+/** \class BinaryFunctorNeighborhoodSumsImageFilter
+ * \brief Implements neighborhood-wise operations of two images depending only on window sums.
+ *
+ * This filter is a BinaryFunctorNeighborhoodImageFilter for functors which only need the
+ * sums, sums of squares and sum of cross-products of the two neighborhoods. Instead of
+ * the neighborhood iterators, the functor receives a BinaryNeighborhoodSums through:
+ *
+ * TOutput operator()(const BinaryNeighborhoodSums& sums)
+ *
+ * The sums are updated with running box sums over the rows and columns of each thread
+ * region (see RunningWindowSums), so that the cost per pixel does not depend on the radius. The image borders are
+ * handled as a zero flux Neumann boundary condition, like in the superclass.
+ *
+ * \ingroup IntensityImageFilters   Multithreaded
+ * \sa BinaryFunctorNeighborhoodImageFilter
+ */
+template <class TInputImage1, class TInputImage2,
+    class TOutputImage, class TFunction>
+class ITK_EXPORT BinaryFunctorNeighborhoodSumsImageFilter
+  : public BinaryFunctorNeighborhoodImageFilter<TInputImage1, TInputImage2, TOutputImage, TFunction>
+{
+public:
+  /** Standard class typedefs. */
+  typedef BinaryFunctorNeighborhoodSumsImageFilter Self;
+  typedef BinaryFunctorNeighborhoodImageFilter<TInputImage1, TInputImage2, TOutputImage, TFunction>
+  Superclass;
+  typedef itk::SmartPointer<Self>       Pointer;
+  typedef itk::SmartPointer<const Self> ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(BinaryFunctorNeighborhoodSumsImageFilter, BinaryFunctorNeighborhoodImageFilter);
+
+  /** Some convenient typedefs. */
+  typedef typename Superclass::FunctorType             FunctorType;
+  typedef typename Superclass::Input1ImageConstPointer Input1ImageConstPointer;
+  typedef typename Superclass::Input2ImageConstPointer Input2ImageConstPointer;
+  typedef typename Superclass::OutputImagePointer      OutputImagePointer;
+  typedef typename Superclass::OutputImageRegionType   OutputImageRegionType;
+  typedef typename Superclass::ProcessObjectType       ProcessObjectType;
+
+protected:
+  BinaryFunctorNeighborhoodSumsImageFilter() {}
+  virtual ~BinaryFunctorNeighborhoodSumsImageFilter() {}
+
+  /** Compute the window sums of the thread region and apply the functor */
+  virtual void ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread,
+                                    int threadId);
+
+private:
+  BinaryFunctorNeighborhoodSumsImageFilter(const Self &); //purposely not implemented
+  void operator =(const Self&); //purposely not implemented
+};
+
+} // end namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbBinaryFunctorNeighborhoodSumsImageFilter.txx"
+#endif
+
+#endif
@@ -0,0 +1,122 @@
+/*=========================================================================
+
+  Program:   ORFEO Toolbox
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+
+  Copyright (c) Centre National d'Etudes Spatiales. All rights reserved.
+  See OTBCopyright.txt for details.
+
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __otbBinaryFunctorNeighborhoodSumsImageFilter_txx
+#define __otbBinaryFunctorNeighborhoodSumsImageFilter_txx
+
+#include "otbBinaryFunctorNeighborhoodSumsImageFilter.h"
+#include "itkImageRegionIterator.h"
+#include "itkProgressReporter.h"
+#include "otbRunningWindowSums.h"
+
+#include <algorithm>
+
+namespace otb
+{
+
+/**
+ * ThreadedGenerateData Performs the neighborhood-wise operation from running sums
+ */
+template <class TInputImage1, class TInputImage2, class TOutputImage, class TFunction>
+void
+BinaryFunctorNeighborhoodSumsImageFilter<TInputImage1, TInputImage2, TOutputImage, TFunction>
+::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread,
+                       int threadId)
+{
+  Input1ImageConstPointer inputPtr1
+    = dynamic_cast<const TInputImage1*>(ProcessObjectType::GetInput(0));
+  Input2ImageConstPointer inputPtr2
+    = dynamic_cast<const TInputImage2*>(ProcessObjectType::GetInput(1));
+  OutputImagePointer outputPtr = this->GetOutput(0);
+
+  FunctorType& functor = this->GetFunctor();
+
+  const typename TInputImage1::RegionType bufferedRegion1 = inputPtr1->GetBufferedRegion();
+  const typename TInputImage2::RegionType bufferedRegion2 = inputPtr2->GetBufferedRegion();
+
+  const long radiusX = this->m_Radius[0];
+  const long radiusY = this->m_Radius[1];
+  const long width   = outputRegionForThread.GetSize()[0];
+  const long height  = outputRegionForThread.GetSize()[1];
+  const long startX  = outputRegionForThread.GetIndex()[0] - radiusX;
+  const long startY  = outputRegionForThread.GetIndex()[1] - radiusY;
+  const long paddedWidth  = width + 2 * radiusX;
+  const long paddedHeight = height + 2 * radiusY;
+
+  // Sums of a, b, a*a, b*b and a*b
+  RunningWindowSums windowSums(5, width, radiusX, radiusY);
+
+  BinaryNeighborhoodSums sums;
+  sums.Count = windowSums.GetWindowCount();
+
+  // support progress methods/callbacks
+  itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels());
+
+  itk::ImageRegionIterator<TOutputImage> outputIt(outputPtr, outputRegionForThread);
+  outputIt.GoToBegin();
+
+  typename TInputImage1::IndexType index1;
+  typename TInputImage2::IndexType index2;
+
+  for (long row = 0; row < paddedHeight; ++row)
+    {
+    // Read the row, replicating the buffer borders
+    const long y = startY + row;
+    index1[1] = std::min(std::max(y, static_cast<long>(bufferedRegion1.GetIndex()[1])),
+                         static_cast<long>(bufferedRegion1.GetIndex()[1] + bufferedRegion1.GetSize()[1]) - 1);
+    index2[1] = std::min(std::max(y, static_cast<long>(bufferedRegion2.GetIndex()[1])),
+                         static_cast<long>(bufferedRegion2.GetIndex()[1] + bufferedRegion2.GetSize()[1]) - 1);
+
+    double * pixel = windowSums.GetRowBuffer();
+    for (long column = 0; column < paddedWidth; ++column, pixel += 5)
+      {
+      const long x = startX + column;
+      index1[0] = std::min(std::max(x, static_cast<long>(bufferedRegion1.GetIndex()[0])),
+                           static_cast<long>(bufferedRegion1.GetIndex()[0] + bufferedRegion1.GetSize()[0]) - 1);
+      index2[0] = std::min(std::max(x, static_cast<long>(bufferedRegion2.GetIndex()[0])),
+                           static_cast<long>(bufferedRegion2.GetIndex()[0] + bufferedRegion2.GetSize()[0]) - 1);
+      const double a = static_cast<double>(inputPtr1->GetPixel(index1));
+      const double b = static_cast<double>(inputPtr2->GetPixel(index2));
+      pixel[0] = a;
+      pixel[1] = b;
+      pixel[2] = a * a;
+      pixel[3] = b * b;
+      pixel[4] = a * b;
+      }
+
+    if (windowSums.PushRow())
+      {
+      for (long column = 0; column < width; ++column)
+        {
+        const double * w = windowSums.GetWindowSums(column);
+        sums.SumA          = w[0];
+        sums.SumB          = w[1];
+        sums.CenteredSumAA = std::max(0., w[2] - w[0] * w[0] / sums.Count);
+        sums.CenteredSumBB = std::max(0., w[3] - w[1] * w[1] / sums.Count);
+        sums.CenteredSumAB = w[4] - w[0] * w[1] / sums.Count;
+
+        outputIt.Set(functor(sums));
+        ++outputIt;
+        progress.CompletedPixel();
+        }
+      }
+    }
+}
+
+} // end namespace otb
+
+#endif
@@ -0,0 +1,58 @@
+/*=========================================================================
+
+  Program:   ORFEO Toolbox
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+
+  Copyright (c) Centre National d'Etudes Spatiales. All rights reserved.
+  See OTBCopyright.txt for details.
+
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __otbBinaryNeighborhoodSums_h
+#define __otbBinaryNeighborhoodSums_h
+
+namespace otb
+{
+
+/** \class BinaryNeighborhoodSums
+ * \brief First and second order sums of a pair of co-located neighborhoods.
+ *
+ * This is what the BinaryFunctorNeighborhoodSumsImageFilter gives to its
+ * functor for each output pixel, instead of the neighborhood iterators.
+ * The second order sums are centered: CenteredSumAA is the sum of
+ * (a - mean(a))^2 over the neighborhood, and CenteredSumAB the sum of
+ * (a - mean(a)) * (b - mean(b)).
+ *
+ * \sa BinaryFunctorNeighborhoodSumsImageFilter
+ */
+class BinaryNeighborhoodSums
+{
+public:
+  BinaryNeighborhoodSums()
+    : Count(0.), SumA(0.), SumB(0.), CenteredSumAA(0.), CenteredSumBB(0.), CenteredSumAB(0.)
+  {}
+
+  /** Number of pixels in the neighborhood */
+  double Count;
+  /** Sum of the pixels of the first neighborhood */
+  double SumA;
+  /** Sum of the pixels of the second neighborhood */
+  double SumB;
+  /** Centered sum of squares of the first neighborhood */
+  double CenteredSumAA;
+  /** Centered sum of squares of the second neighborhood */
+  double CenteredSumBB;
+  /** Centered sum of cross-products */
+  double CenteredSumAB;
+};
+
+} // end namespace otb
+
+#endif
@@ -0,0 +1,68 @@
+/*=========================================================================
+
+  Program:   ORFEO Toolbox
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+
+  Copyright (c) Centre National d'Etudes Spatiales. All rights reserved.
+  See OTBCopyright.txt for details.
+
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __otbMersenneTwisterRandomVariateGenerator_h
+#define __otbMersenneTwisterRandomVariateGenerator_h
+
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+
+namespace otb
+{
+/** \class MersenneTwisterRandomVariateGenerator
+ * \brief Mersenne Twister generator with independent instances.
+ *
+ * itk::Statistics::MersenneTwisterRandomVariateGenerator::New() returns
+ * a global instance shared by all its users. This class creates a new
+ * generator at each call to New(), so that several threads can each draw
+ * from their own seeded sequence.
+ *
+ * \ingroup Common
+ */
+class ITK_EXPORT MersenneTwisterRandomVariateGenerator :
+  public itk::Statistics::MersenneTwisterRandomVariateGenerator
+{
+public:
+  /** Standard class typedefs. */
+  typedef MersenneTwisterRandomVariateGenerator                 Self;
+  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator Superclass;
+  typedef itk::SmartPointer<Self>                               Pointer;
+  typedef itk::SmartPointer<const Self>                         ConstPointer;
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(MersenneTwisterRandomVariateGenerator,
+               itk::Statistics::MersenneTwisterRandomVariateGenerator);
+
+  /** Create a new generator, independent from the global one. */
+  static Pointer New()
+  {
+    Pointer smartPtr = new Self;
+    smartPtr->UnRegister();
+    return smartPtr;
+  }
+
+protected:
+  MersenneTwisterRandomVariateGenerator() {}
+  virtual ~MersenneTwisterRandomVariateGenerator() {}
+
+private:
+  MersenneTwisterRandomVariateGenerator(const Self &); //purposely not implemented
+  void operator =(const Self&); //purposely not implemented
+};
+
+} // end namespace otb
+
+#endif
@@ -22,6 +22,8 @@
 #include "muParser.h"
 #include "otbParser.h"
 
+#include <algorithm>
+
 namespace otb
 {
 
@@ -134,6 +136,100 @@ public:
     return true;
   }
 
+  /** Translate the bytecode of the expression into program. The
+   *  expression must have been evaluated once, with the variables
+   *  bound to the addresses given in variables. */
+  bool ExportByteCode(const std::vector<ValueType*>& variables, ParserProgram * program) const
+  {
+    const mu::ParserByteCode&       byteCode = m_MuParser.GetByteCode();
+    const mu::ParserByteCode::map_type * code = byteCode.GetRawData();
+    std::size_t i = 0;
+
+    program->Clear();
+
+    while (true)
+      {
+      // Each entry starts with the stack index and the command code
+      unsigned int  idx = static_cast<unsigned int>(code[i]);
+      mu::ECmdCode  cmd = static_cast<mu::ECmdCode>(code[i+1]);
+      i += 2;
+
+      switch (cmd)
+        {
+        case mu::cmLE:  program->AddOperator(idx, ParserProgram::LESS_EQUAL);    break;
+        case mu::cmGE:  program->AddOperator(idx, ParserProgram::GREATER_EQUAL); break;
+        case mu::cmNEQ: program->AddOperator(idx, ParserProgram::NOT_EQUAL);     break;
+        case mu::cmEQ:  program->AddOperator(idx, ParserProgram::EQUAL);         break;
+        case mu::cmLT:  program->AddOperator(idx, ParserProgram::LESS);          break;
+        case mu::cmGT:  program->AddOperator(idx, ParserProgram::GREATER);       break;
+        case mu::cmADD: program->AddOperator(idx, ParserProgram::ADD);           break;
+        case mu::cmSUB: program->AddOperator(idx, ParserProgram::SUBTRACT);      break;
+        case mu::cmMUL: program->AddOperator(idx, ParserProgram::MULTIPLY);      break;
+        case mu::cmDIV: program->AddOperator(idx, ParserProgram::DIVIDE);        break;
+        case mu::cmPOW: program->AddOperator(idx, ParserProgram::POWER);         break;
+        case mu::cmAND: program->AddOperator(idx, ParserProgram::LOGICAL_AND);   break;
+        case mu::cmOR:  program->AddOperator(idx, ParserProgram::LOGICAL_OR);    break;
+        case mu::cmXOR: program->AddOperator(idx, ParserProgram::LOGICAL_XOR);   break;
+
+        case mu::cmVAR:
+          {
+          ValueType * address = *(ValueType**)(&code[i]);
+          i += byteCode.GetValSize();
+
+          std::vector<ValueType*>::const_iterator it = std::find(variables.begin(), variables.end(), address);
+          if (it == variables.end())
+            {
+            itkExceptionMacro(<< "Unknown variable in expression " << GetExpr());
+            }
+          program->AddVariable(idx, static_cast<unsigned int>(it - variables.begin()));
+          }
+          break;
+
+        case mu::cmVAL:
+          program->AddValue(idx, *(ValueType*)(&code[i]));
+          i += byteCode.GetValSize();
+          break;
+
+        case mu::cmFUNC:
+          {
+          int nbArgs = static_cast<int>(code[i++]);
+          switch (nbArgs)
+            {
+            case 0: program->AddFunction(idx, *(mu::fun_type0*)(&code[i])); break;
+            case 1: program->AddFunction(idx, *(mu::fun_type1*)(&code[i])); break;
+            case 2: program->AddFunction(idx, *(mu::fun_type2*)(&code[i])); break;
+            case 3: program->AddFunction(idx, *(mu::fun_type3*)(&code[i])); break;
+            case 4: program->AddFunction(idx, *(mu::fun_type4*)(&code[i])); break;
+            case 5: program->AddFunction(idx, *(mu::fun_type5*)(&code[i])); break;
+            default:
+              if (nbArgs > 0)
+                {
+                program->Clear();
+                return false;
+                }
+              // Functions with a variable number of arguments store the
+              // number as a negative value
+              program->AddFunction(idx, *(mu::multfun_type*)(&code[i]), static_cast<unsigned int>(-nbArgs));
+              break;
+            }
+          i += byteCode.GetPtrSize();
+          }
+          break;
+
+        case mu::cmEND:
+          // The parser leaves the result in the second stack row
+          program->SetResultIndex(1);
+          return true;
+
+        default:
+          // Assignments, string functions and user defined binary
+          // operators are not supported
+          program->Clear();
+          return false;
+        }
+      }
+  }
+
   // Get the map with the functions
   Parser::FunctionMapType GetFunList() const
   {
@@ -256,6 +352,27 @@ const std::string& Parser::GetExpr() const
   return m_InternalParser->GetExpr();
 }
 
+bool Parser::Compile(const std::vector<std::string>& varNames, ParserProgram * program) const
+{
+  // Parse the expression with a private parser, so that the variables
+  // defined on this one are left untouched
+  ParserImplPtr parser = ParserImpl::New();
+  parser->SetExpr(this->GetExpr());
+
+  std::vector<ValueType>  values(varNames.size(), 0.);
+  std::vector<ValueType*> variables(varNames.size());
+  for (unsigned int i = 0; i < varNames.size(); ++i)
+    {
+    variables[i] = &values[i];
+    parser->DefineVar(varNames[i], variables[i]);
+    }
+
+  // The first evaluation builds the bytecode
+  parser->Eval();
+
+  return parser->ExportByteCode(variables, program);
+}
+
 // Get the map with the variables
 const std::map<std::string, Parser::ValueType*>& Parser::GetVar() const
 {
@@ -20,6 +20,8 @@
 
 #include "itkLightObject.h"
 #include "itkObjectFactory.h"
+#include "otbParserProgram.h"
+#include <vector>
 
 namespace otb
 {
@@ -80,6 +82,15 @@ public:
   /**  Check Expression **/
   bool CheckExpr();
 
+  /** Compile the expression into a program evaluated over arrays of
+   *  values. Variables are numbered following their order in varNames.
+   *  Syntax errors raise an exception. Returns false if the expression
+   *  uses constructs which can not be compiled (assignments, string
+   *  functions), in which case Eval() must be used instead.
+   *  The variables defined on this parser are left untouched.
+   *  \sa ParserProgram */
+  bool Compile(const std::vector<std::string>& varNames, ParserProgram * program) const;
+
 protected:
   Parser();
   virtual ~Parser();
@@ -0,0 +1,322 @@
+/*=========================================================================
+
+  Program:   ORFEO Toolbox
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+
+  Copyright (c) Centre National d'Etudes Spatiales. All rights reserved.
+  See OTBCopyright.txt for details.
+
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#include "otbParserProgram.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "vcl_cmath.h"
+
+namespace otb
+{
+
+ParserProgram::ParserProgram()
+  : m_StackSize(0), m_ResultIndex(0)
+{
+}
+
+ParserProgram::~ParserProgram()
+{
+}
+
+void ParserProgram::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Number of instructions: " << m_Instructions.size() << std::endl;
+  os << indent << "Stack size: " << m_StackSize << std::endl;
+  os << indent << "Result index: " << m_ResultIndex << std::endl;
+}
+
+void ParserProgram::Clear()
+{
+  m_Instructions.clear();
+  m_UsedVariables.clear();
+  m_StackSize = 0;
+  m_ResultIndex = 0;
+}
+
+void ParserProgram::AddInstruction(const Instruction& instruction, unsigned int nbRows)
+{
+  m_Instructions.push_back(instruction);
+  m_StackSize = std::max(m_StackSize, instruction.StackIndex + nbRows);
+}
+
+void ParserProgram::AddVariable(unsigned int stackIndex, unsigned int variableIndex)
+{
+  Instruction instruction;
+  instruction.Kind = VARIABLE;
+  instruction.StackIndex = stackIndex;
+  instruction.VariableIndex = variableIndex;
+  this->AddInstruction(instruction, 1);
+
+  if (variableIndex >= m_UsedVariables.size())
+    {
+    m_UsedVariables.resize(variableIndex + 1, false);
+    }
+  m_UsedVariables[variableIndex] = true;
+}
+
+void ParserProgram::AddValue(unsigned int stackIndex, ValueType value)
+{
+  Instruction instruction;
+  instruction.Kind = VALUE;
+  instruction.StackIndex = stackIndex;
+  instruction.Value = value;
+  this->AddInstruction(instruction, 1);
+}
+
+void ParserProgram::AddOperator(unsigned int stackIndex, OperatorType op)
+{
+  Instruction instruction;
+  instruction.Kind = OPERATOR;
+  instruction.StackIndex = stackIndex;
+  instruction.Operator = op;
+  this->AddInstruction(instruction, 2);
+}
+
+void ParserProgram::AddFunction(unsigned int stackIndex, Function0Type function)
+{
+  Instruction instruction;
+  instruction.Kind = FUNCTION;
+  instruction.StackIndex = stackIndex;
+  instruction.Function.f0 = function;
+  instruction.NbArgs = 0;
+  this->AddInstruction(instruction, 1);
+}
+
+void ParserProgram::AddFunction(unsigned int stackIndex, Function1Type function)
+{
+  Instruction instruction;
+  instruction.Kind = FUNCTION;
+  instruction.StackIndex = stackIndex;
+  instruction.Function.f1 = function;
+  instruction.NbArgs = 1;
+  this->AddInstruction(instruction, 1);
+}
+
+void ParserProgram::AddFunction(unsigned int stackIndex, Function2Type function)
+{
+  Instruction instruction;
+  instruction.Kind = FUNCTION;
+  instruction.StackIndex = stackIndex;
+  instruction.Function.f2 = function;
+  instruction.NbArgs = 2;
+  this->AddInstruction(instruction, 2);
+}
+
+void ParserProgram::AddFunction(unsigned int stackIndex, Function3Type function)
+{
+  Instruction instruction;
+  instruction.Kind = FUNCTION;
+  instruction.StackIndex = stackIndex;
+  instruction.Function.f3 = function;
+  instruction.NbArgs = 3;
+  this->AddInstruction(instruction, 3);
+}
+
+void ParserProgram::AddFunction(unsigned int stackIndex, Function4Type function)
+{
+  Instruction instruction;
+  instruction.Kind = FUNCTION;
+  instruction.StackIndex = stackIndex;
+  instruction.Function.f4 = function;
+  instruction.NbArgs = 4;
+  this->AddInstruction(instruction, 4);
+}
+
+void ParserProgram::AddFunction(unsigned int stackIndex, Function5Type function)
+{
+  Instruction instruction;
+  instruction.Kind = FUNCTION;
+  instruction.StackIndex = stackIndex;
+  instruction.Function.f5 = function;
+  instruction.NbArgs = 5;
+  this->AddInstruction(instruction, 5);
+}
+
+void ParserProgram::AddFunction(unsigned int stackIndex, MultiArgFunctionType function, unsigned int nbArgs)
+{
+  Instruction instruction;
+  instruction.Kind = FUNCTION;
+  instruction.StackIndex = stackIndex;
+  instruction.Function.fn = function;
+  // Multiple arguments functions are flagged by a negative count
+  instruction.NbArgs = -static_cast<int>(nbArgs);
+  this->AddInstruction(instruction, std::max(nbArgs, 1U));
+}
+
+void ParserProgram::SetResultIndex(unsigned int stackIndex)
+{
+  m_ResultIndex = stackIndex;
+  m_StackSize = std::max(m_StackSize, stackIndex + 1);
+}
+
+unsigned int ParserProgram::GetStackSize() const
+{
+  return m_StackSize;
+}
+
+bool ParserProgram::IsVariableUsed(unsigned int variableIndex) const
+{
+  return variableIndex < m_UsedVariables.size() && m_UsedVariables[variableIndex];
+}
+
+void ParserProgram::ApplyOperator(OperatorType op, const ValueType * left, const ValueType * right,
+                                  ValueType * output, unsigned int nbValues)
+{
+  unsigned int i;
+
+  // Same semantic as the parser built-in operators
+  switch (op)
+    {
+    case LESS_EQUAL:
+      for (i = 0; i < nbValues; ++i) output[i] = left[i] <= right[i];
+      break;
+    case GREATER_EQUAL:
+      for (i = 0; i < nbValues; ++i) output[i] = left[i] >= right[i];
+      break;
+    case NOT_EQUAL:
+      for (i = 0; i < nbValues; ++i) output[i] = left[i] != right[i];
+      break;
+    case EQUAL:
+      for (i = 0; i < nbValues; ++i) output[i] = left[i] == right[i];
+      break;
+    case LESS:
+      for (i = 0; i < nbValues; ++i) output[i] = left[i] < right[i];
+      break;
+    case GREATER:
+      for (i = 0; i < nbValues; ++i) output[i] = left[i] > right[i];
+      break;
+    case ADD:
+      for (i = 0; i < nbValues; ++i) output[i] = left[i] + right[i];
+      break;
+    case SUBTRACT:
+      for (i = 0; i < nbValues; ++i) output[i] = left[i] - right[i];
+      break;
+    case MULTIPLY:
+      for (i = 0; i < nbValues; ++i) output[i] = left[i] * right[i];
+      break;
+    case DIVIDE:
+      for (i = 0; i < nbValues; ++i) output[i] = left[i] / right[i];
+      break;
+    case POWER:
+      for (i = 0; i < nbValues; ++i) output[i] = vcl_pow(left[i], right[i]);
+      break;
+    case LOGICAL_AND:
+      for (i = 0; i < nbValues; ++i) output[i] = static_cast<int>(left[i]) & static_cast<int>(right[i]);
+      break;
+    case LOGICAL_OR:
+      for (i = 0; i < nbValues; ++i) output[i] = static_cast<int>(left[i]) | static_cast<int>(right[i]);
+      break;
+    case LOGICAL_XOR:
+      for (i = 0; i < nbValues; ++i) output[i] = static_cast<int>(left[i]) ^ static_cast<int>(right[i]);
+      break;
+    }
+}
+
+void ParserProgram::ApplyFunction(const Instruction& instruction, const ValueType * const * args,
+                                  ValueType * output, unsigned int nbValues)
+{
+  unsigned int i;
+
+  switch (instruction.NbArgs)
+    {
+    case 0:
+      for (i = 0; i < nbValues; ++i) output[i] = (*instruction.Function.f0)();
+      break;
+    case 1:
+      for (i = 0; i < nbValues; ++i) output[i] = (*instruction.Function.f1)(args[0][i]);
+      break;
+    case 2:
+      for (i = 0; i < nbValues; ++i) output[i] = (*instruction.Function.f2)(args[0][i], args[1][i]);
+      break;
+    case 3:
+      for (i = 0; i < nbValues; ++i)
+        output[i] = (*instruction.Function.f3)(args[0][i], args[1][i], args[2][i]);
+      break;
+    case 4:
+      for (i = 0; i < nbValues; ++i)
+        output[i] = (*instruction.Function.f4)(args[0][i], args[1][i], args[2][i], args[3][i]);
+      break;
+    case 5:
+      for (i = 0; i < nbValues; ++i)
+        output[i] = (*instruction.Function.f5)(args[0][i], args[1][i], args[2][i], args[3][i], args[4][i]);
+      break;
+    default:
+      {
+      // Gather the arguments of each value
+      const unsigned int nbArgs = static_cast<unsigned int>(-instruction.NbArgs);
+      std::vector<ValueType> values(nbArgs);
+      for (i = 0; i < nbValues; ++i)
+        {
+        for (unsigned int k = 0; k < nbArgs; ++k)
+          {
+          values[k] = args[k][i];
+          }
+        output[i] = (*instruction.Function.fn)(&values[0], nbArgs);
+        }
+      }
+      break;
+    }
+}
+
+void ParserProgram::Evaluate(const ValueType * const * variables, ValueType * stack,
+                             ValueType * output, unsigned int nbValues) const
+{
+  std::vector<const ValueType *> args;
+
+  for (InstructionListType::const_iterator it = m_Instructions.begin(); it != m_Instructions.end(); ++it)
+    {
+    ValueType * row = stack + it->StackIndex * nbValues;
+
+    switch (it->Kind)
+      {
+      case VARIABLE:
+        std::memcpy(row, variables[it->VariableIndex], nbValues * sizeof(ValueType));
+        break;
+
+      case VALUE:
+        std::fill(row, row + nbValues, it->Value);
+        break;
+
+      case OPERATOR:
+        // Operands are in two consecutive rows, the result overwrites
+        // the first one
+        ApplyOperator(it->Operator, row, row + nbValues, row, nbValues);
+        break;
+
+      case FUNCTION:
+        {
+        // Arguments are in consecutive rows, the result overwrites the
+        // first one
+        const unsigned int nbArgs = static_cast<unsigned int>(it->NbArgs < 0 ? -it->NbArgs : it->NbArgs);
+        args.resize(std::max(nbArgs, 1U));
+        for (unsigned int k = 0; k < nbArgs; ++k)
+          {
+          args[k] = row + k * nbValues;
+          }
+        ApplyFunction(*it, &args[0], row, nbValues);
+        }
+        break;
+      }
+    }
+
+  std::memcpy(output, stack + m_ResultIndex * nbValues, nbValues * sizeof(ValueType));
+}
+
+}//end namespace otb
@@ -0,0 +1,200 @@
+/*=========================================================================
+
+  Program:   ORFEO Toolbox
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+
+  Copyright (c) Centre National d'Etudes Spatiales. All rights reserved.
+  See OTBCopyright.txt for details.
+
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __otbParserProgram_h
+#define __otbParserProgram_h
+
+#include "itkLightObject.h"
+#include "itkObjectFactory.h"
+#include <vector>
+
+namespace otb
+{
+
+/** \class ParserProgram
+ * \brief Compiled form of a Parser expression, evaluated over arrays of values.
+ *
+ * A ParserProgram is built once by Parser::Compile() from the bytecode
+ * of the parsed expression. Variables are referred to by their index
+ * instead of their address, so that the program does not depend on any
+ * variable storage and can be shared by several threads.
+ *
+ * Evaluate() runs each instruction over a whole array of values at
+ * once (typically an image line), which removes the per-value
+ * interpretation cost and lets the compiler vectorize the arithmetic
+ * operators. Each value goes through exactly the same operations as
+ * with Parser::Eval(), so both give identical results.
+ *
+ * \sa Parser
+ * \sa BandMathImageFilter
+ */
+class ITK_EXPORT ParserProgram : public itk::LightObject
+{
+public:
+  /** Standard class typedefs. */
+  typedef ParserProgram                            Self;
+  typedef itk::LightObject                         Superclass;
+  typedef itk::SmartPointer<Self>                  Pointer;
+  typedef itk::SmartPointer<const Self>            ConstPointer;
+
+  /** New macro for creation of through a Smart Pointer */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods) */
+  itkTypeMacro(ParserProgram, itk::LightObject);
+
+  /** Convenient type definitions */
+  typedef double                                   ValueType;
+
+  /** Function callbacks, with the signatures used by the parser */
+  typedef ValueType (*Function0Type)();
+  typedef ValueType (*Function1Type)(ValueType);
+  typedef ValueType (*Function2Type)(ValueType, ValueType);
+  typedef ValueType (*Function3Type)(ValueType, ValueType, ValueType);
+  typedef ValueType (*Function4Type)(ValueType, ValueType, ValueType, ValueType);
+  typedef ValueType (*Function5Type)(ValueType, ValueType, ValueType, ValueType, ValueType);
+  typedef ValueType (*MultiArgFunctionType)(const ValueType*, int);
+
+  /** Built-in binary operators */
+  typedef enum
+    {
+    LESS_EQUAL,
+    GREATER_EQUAL,
+    NOT_EQUAL,
+    EQUAL,
+    LESS,
+    GREATER,
+    ADD,
+    SUBTRACT,
+    MULTIPLY,
+    DIVIDE,
+    POWER,
+    LOGICAL_AND,
+    LOGICAL_OR,
+    LOGICAL_XOR
+    } OperatorType;
+
+  /** Remove all the instructions */
+  void Clear();
+
+  /** Load the variable of index variableIndex in the stack row stackIndex */
+  void AddVariable(unsigned int stackIndex, unsigned int variableIndex);
+
+  /** Load a constant value in the stack row stackIndex */
+  void AddValue(unsigned int stackIndex, ValueType value);
+
+  /** Apply a binary operator to the stack rows stackIndex and
+   *  stackIndex+1, the result is stored in row stackIndex */
+  void AddOperator(unsigned int stackIndex, OperatorType op);
+
+  /** Apply a function to the nbArgs stack rows starting at stackIndex,
+   *  the result is stored in row stackIndex */
+  void AddFunction(unsigned int stackIndex, Function0Type function);
+  void AddFunction(unsigned int stackIndex, Function1Type function);
+  void AddFunction(unsigned int stackIndex, Function2Type function);
+  void AddFunction(unsigned int stackIndex, Function3Type function);
+  void AddFunction(unsigned int stackIndex, Function4Type function);
+  void AddFunction(unsigned int stackIndex, Function5Type function);
+  void AddFunction(unsigned int stackIndex, MultiArgFunctionType function, unsigned int nbArgs);
+
+  /** Set the stack row holding the result once all the instructions
+   *  have been run */
+  void SetResultIndex(unsigned int stackIndex);
+
+  /** Return the number of stack rows needed by Evaluate() */
+  unsigned int GetStackSize() const;
+
+  /** Return true if the variable of index variableIndex is read by
+   *  the program */
+  bool IsVariableUsed(unsigned int variableIndex) const;
+
+  /** Evaluate the program over nbValues values.
+   *  variables[j] must point to the nbValues values of the jth variable
+   *  (only the used ones are read), stack to GetStackSize()*nbValues
+   *  values of scratch memory, and output receives the nbValues
+   *  results. The program is not modified, so this method can be called
+   *  concurrently from several threads with distinct buffers. */
+  void Evaluate(const ValueType * const * variables, ValueType * stack,
+                ValueType * output, unsigned int nbValues) const;
+
+protected:
+  ParserProgram();
+  virtual ~ParserProgram();
+  virtual void PrintSelf(std::ostream& os, itk::Indent indent) const;
+
+private:
+  ParserProgram(const Self &);      //purposely not implemented
+  void operator =(const Self &);    //purposely not implemented
+
+  // Reads the instructions to merge several programs
+  friend class ParserProgramGraph;
+
+  typedef enum
+    {
+    VARIABLE,
+    VALUE,
+    OPERATOR,
+    FUNCTION
+    } InstructionKindType;
+
+  typedef union
+    {
+    Function0Type        f0;
+    Function1Type        f1;
+    Function2Type        f2;
+    Function3Type        f3;
+    Function4Type        f4;
+    Function5Type        f5;
+    MultiArgFunctionType fn;
+    } FunctionType;
+
+  /** One step of the program */
+  struct Instruction
+    {
+    InstructionKindType Kind;
+    unsigned int        StackIndex;
+    unsigned int        VariableIndex;
+    ValueType           Value;
+    OperatorType        Operator;
+    FunctionType        Function;
+    int                 NbArgs;
+    };
+
+  typedef std::vector<Instruction> InstructionListType;
+
+  /** Append an instruction and update the stack size */
+  void AddInstruction(const Instruction& instruction, unsigned int nbRows);
+
+  /** Apply an operator over arrays of values. The output may be one of
+   *  the operands. */
+  static void ApplyOperator(OperatorType op, const ValueType * left, const ValueType * right,
+                            ValueType * output, unsigned int nbValues);
+
+  /** Apply the function of instruction over arrays of values. The
+   *  output may be one of the arguments. */
+  static void ApplyFunction(const Instruction& instruction, const ValueType * const * args,
+                            ValueType * output, unsigned int nbValues);
+
+  InstructionListType  m_Instructions;
+  std::vector<bool>    m_UsedVariables;
+  unsigned int         m_StackSize;
+  unsigned int         m_ResultIndex;
+}; // end class
+
+}//end namespace otb
+
+#endif
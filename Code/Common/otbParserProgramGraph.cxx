@@ -0,0 +1,298 @@
+/*=========================================================================
+
+  Program:   ORFEO Toolbox
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+
+  Copyright (c) Centre National d'Etudes Spatiales. All rights reserved.
+  See OTBCopyright.txt for details.
+
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#include "otbParserProgramGraph.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace otb
+{
+
+ParserProgramGraph::ParserProgramGraph()
+  : m_NumberOfBuffers(0)
+{
+}
+
+ParserProgramGraph::~ParserProgramGraph()
+{
+}
+
+void ParserProgramGraph::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Number of outputs: " << m_Outputs.size() << std::endl;
+  os << indent << "Number of nodes: " << m_Nodes.size() << std::endl;
+  os << indent << "Number of buffers: " << m_NumberOfBuffers << std::endl;
+}
+
+void ParserProgramGraph::Clear()
+{
+  m_Nodes.clear();
+  m_NodeMap.clear();
+  m_Outputs.clear();
+  m_UsedVariables.clear();
+  m_NumberOfBuffers = 0;
+}
+
+unsigned int ParserProgramGraph::GetNode(const InstructionType& instruction, const std::vector<unsigned int>& args)
+{
+  // The key identifies the operation and its operands
+  KeyType key;
+  key.push_back(instruction.Kind);
+
+  switch (instruction.Kind)
+    {
+    case ParserProgram::VARIABLE:
+      key.push_back(instruction.VariableIndex);
+      break;
+
+    case ParserProgram::VALUE:
+      {
+      unsigned int words[sizeof(ValueType) / sizeof(unsigned int)];
+      std::memcpy(words, &instruction.Value, sizeof(ValueType));
+      key.insert(key.end(), words, words + sizeof(ValueType) / sizeof(unsigned int));
+      }
+      break;
+
+    case ParserProgram::OPERATOR:
+      key.push_back(instruction.Operator);
+      break;
+
+    case ParserProgram::FUNCTION:
+      {
+      unsigned int words[sizeof(ParserProgram::FunctionType) / sizeof(unsigned int)];
+      std::memcpy(words, &instruction.Function, sizeof(ParserProgram::FunctionType));
+      key.insert(key.end(), words, words + sizeof(ParserProgram::FunctionType) / sizeof(unsigned int));
+      key.push_back(static_cast<unsigned int>(instruction.NbArgs));
+
+      // Functions without arguments may not return constant values
+      // (random generators), they are never shared
+      if (instruction.NbArgs == 0)
+        {
+        key.push_back(m_Nodes.size());
+        }
+      }
+      break;
+    }
+
+  key.insert(key.end(), args.begin(), args.end());
+
+  NodeMapType::const_iterator it = m_NodeMap.find(key);
+  if (it != m_NodeMap.end())
+    {
+    return it->second;
+    }
+
+  Node node;
+  node.Instruction = instruction;
+  node.Args = args;
+  node.Buffer = 0;
+  m_Nodes.push_back(node);
+
+  const unsigned int nodeIndex = m_Nodes.size() - 1;
+  m_NodeMap[key] = nodeIndex;
+
+  return nodeIndex;
+}
+
+unsigned int ParserProgramGraph::AddProgram(const ParserProgram * program)
+{
+  // Replay the program on a stack of node indices
+  std::vector<unsigned int> stack(program->GetStackSize(), 0);
+  std::vector<unsigned int> args;
+
+  ParserProgram::InstructionListType::const_iterator it;
+  for (it = program->m_Instructions.begin(); it != program->m_Instructions.end(); ++it)
+    {
+    args.clear();
+
+    switch (it->Kind)
+      {
+      case ParserProgram::VARIABLE:
+        if (it->VariableIndex >= m_UsedVariables.size())
+          {
+          m_UsedVariables.resize(it->VariableIndex + 1, false);
+          }
+        m_UsedVariables[it->VariableIndex] = true;
+        break;
+
+      case ParserProgram::VALUE:
+        break;
+
+      case ParserProgram::OPERATOR:
+        args.push_back(stack[it->StackIndex]);
+        args.push_back(stack[it->StackIndex + 1]);
+        break;
+
+      case ParserProgram::FUNCTION:
+        {
+        const unsigned int nbArgs = static_cast<unsigned int>(it->NbArgs < 0 ? -it->NbArgs : it->NbArgs);
+        for (unsigned int k = 0; k < nbArgs; ++k)
+          {
+          args.push_back(stack[it->StackIndex + k]);
+          }
+        }
+        break;
+      }
+
+    stack[it->StackIndex] = this->GetNode(*it, args);
+    }
+
+  m_Outputs.push_back(stack[program->m_ResultIndex]);
+
+  this->AllocateBuffers();
+
+  return m_Outputs.size() - 1;
+}
+
+void ParserProgramGraph::AllocateBuffers()
+{
+  const unsigned int nbNodes = m_Nodes.size();
+  const unsigned int noBuffer = std::numeric_limits<unsigned int>::max();
+
+  // Last node reading each node, outputs are kept until the end
+  std::vector<unsigned int> lastUse(nbNodes, 0);
+  for (unsigned int i = 0; i < nbNodes; ++i)
+    {
+    for (unsigned int k = 0; k < m_Nodes[i].Args.size(); ++k)
+      {
+      lastUse[m_Nodes[i].Args[k]] = i;
+      }
+    }
+  for (unsigned int k = 0; k < m_Outputs.size(); ++k)
+    {
+    lastUse[m_Outputs[k]] = nbNodes;
+    }
+
+  std::vector<unsigned int> freeBuffers;
+  m_NumberOfBuffers = 0;
+
+  for (unsigned int i = 0; i < nbNodes; ++i)
+    {
+    Node& node = m_Nodes[i];
+
+    // Release the arguments read for the last time. Operations work
+    // value by value, so the result may overwrite one of them.
+    for (unsigned int k = 0; k < node.Args.size(); ++k)
+      {
+      const unsigned int arg = node.Args[k];
+      if (lastUse[arg] == i && m_Nodes[arg].Buffer != noBuffer
+          && std::find(freeBuffers.begin(), freeBuffers.end(), m_Nodes[arg].Buffer) == freeBuffers.end())
+        {
+        freeBuffers.push_back(m_Nodes[arg].Buffer);
+        }
+      }
+
+    // Variables are read in place
+    if (node.Instruction.Kind == ParserProgram::VARIABLE)
+      {
+      node.Buffer = noBuffer;
+      }
+    else if (!freeBuffers.empty())
+      {
+      node.Buffer = freeBuffers.back();
+      freeBuffers.pop_back();
+      }
+    else
+      {
+      node.Buffer = m_NumberOfBuffers++;
+      }
+    }
+}
+
+unsigned int ParserProgramGraph::GetNumberOfOutputs() const
+{
+  return m_Outputs.size();
+}
+
+unsigned int ParserProgramGraph::GetNumberOfNodes() const
+{
+  return m_Nodes.size();
+}
+
+unsigned int ParserProgramGraph::GetNumberOfBuffers() const
+{
+  return m_NumberOfBuffers;
+}
+
+bool ParserProgramGraph::IsVariableUsed(unsigned int variableIndex) const
+{
+  return variableIndex < m_UsedVariables.size() && m_UsedVariables[variableIndex];
+}
+
+const ParserProgramGraph::ValueType *
+ParserProgramGraph::GetNodeData(const Node& node, const ValueType * const * variables,
+                                ValueType * buffers, unsigned int nbValues) const
+{
+  if (node.Instruction.Kind == ParserProgram::VARIABLE)
+    {
+    return variables[node.Instruction.VariableIndex];
+    }
+  return buffers + node.Buffer * nbValues;
+}
+
+void ParserProgramGraph::Evaluate(const ValueType * const * variables, ValueType * buffers,
+                                  ValueType * const * outputs, unsigned int nbValues) const
+{
+  std::vector<const ValueType *> args;
+
+  for (NodeListType::const_iterator it = m_Nodes.begin(); it != m_Nodes.end(); ++it)
+    {
+    const InstructionType& instruction = it->Instruction;
+
+    if (instruction.Kind == ParserProgram::VARIABLE)
+      {
+      continue;
+      }
+
+    ValueType * data = buffers + it->Buffer * nbValues;
+
+    args.resize(std::max<size_t>(it->Args.size(), 1));
+    for (unsigned int k = 0; k < it->Args.size(); ++k)
+      {
+      args[k] = this->GetNodeData(m_Nodes[it->Args[k]], variables, buffers, nbValues);
+      }
+
+    switch (instruction.Kind)
+      {
+      case ParserProgram::VALUE:
+        std::fill(data, data + nbValues, instruction.Value);
+        break;
+
+      case ParserProgram::OPERATOR:
+        ParserProgram::ApplyOperator(instruction.Operator, args[0], args[1], data, nbValues);
+        break;
+
+      case ParserProgram::FUNCTION:
+        ParserProgram::ApplyFunction(instruction, &args[0], data, nbValues);
+        break;
+
+      default:
+        break;
+      }
+    }
+
+  for (unsigned int k = 0; k < m_Outputs.size(); ++k)
+    {
+    const ValueType * result = this->GetNodeData(m_Nodes[m_Outputs[k]], variables, buffers, nbValues);
+    std::memcpy(outputs[k], result, nbValues * sizeof(ValueType));
+    }
+}
+
+}//end namespace otb
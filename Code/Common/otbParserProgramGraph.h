@@ -0,0 +1,138 @@
+/*=========================================================================
+
+  Program:   ORFEO Toolbox
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+
+  Copyright (c) Centre National d'Etudes Spatiales. All rights reserved.
+  See OTBCopyright.txt for details.
+
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __otbParserProgramGraph_h
+#define __otbParserProgramGraph_h
+
+#include "otbParserProgram.h"
+#include <map>
+
+namespace otb
+{
+
+/** \class ParserProgramGraph
+ * \brief Several ParserProgram merged into a single evaluation graph.
+ *
+ * Each added program is turned into a graph where every node holds the
+ * result of one operation. Nodes computing the same operation on the
+ * same operands are shared, so a subexpression common to several
+ * expressions (a band, a constant, a sum of bands, a ndvi...) is only
+ * computed once. The result of each program is available as one output
+ * of the graph.
+ *
+ * Nodes are evaluated over arrays of values, in the same way as
+ * ParserProgram::Evaluate(), and give the same results. The scratch
+ * arrays of the intermediate nodes are recycled as soon as all their
+ * consumers have been evaluated.
+ *
+ * \sa ParserProgram
+ * \sa MultiExpressionBandMathImageFilter
+ */
+class ITK_EXPORT ParserProgramGraph : public itk::LightObject
+{
+public:
+  /** Standard class typedefs. */
+  typedef ParserProgramGraph                       Self;
+  typedef itk::LightObject                         Superclass;
+  typedef itk::SmartPointer<Self>                  Pointer;
+  typedef itk::SmartPointer<const Self>            ConstPointer;
+
+  /** New macro for creation of through a Smart Pointer */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods) */
+  itkTypeMacro(ParserProgramGraph, itk::LightObject);
+
+  /** Convenient type definitions */
+  typedef ParserProgram::ValueType                 ValueType;
+
+  /** Remove all the programs */
+  void Clear();
+
+  /** Merge a program into the graph. Returns the index of the
+   *  corresponding output. */
+  unsigned int AddProgram(const ParserProgram * program);
+
+  /** Return the number of outputs, which is the number of programs added */
+  unsigned int GetNumberOfOutputs() const;
+
+  /** Return the number of distinct operations of the graph */
+  unsigned int GetNumberOfNodes() const;
+
+  /** Return the number of scratch arrays needed by Evaluate() */
+  unsigned int GetNumberOfBuffers() const;
+
+  /** Return true if the variable of index variableIndex is read by
+   *  one of the programs */
+  bool IsVariableUsed(unsigned int variableIndex) const;
+
+  /** Evaluate all the outputs over nbValues values.
+   *  variables[j] must point to the nbValues values of the jth variable
+   *  (only the used ones are read), buffers to
+   *  GetNumberOfBuffers()*nbValues values of scratch memory, and
+   *  outputs[k] to the nbValues results of the kth output. The graph is
+   *  not modified, so this method can be called concurrently from
+   *  several threads with distinct buffers. */
+  void Evaluate(const ValueType * const * variables, ValueType * buffers,
+                ValueType * const * outputs, unsigned int nbValues) const;
+
+protected:
+  ParserProgramGraph();
+  virtual ~ParserProgramGraph();
+  virtual void PrintSelf(std::ostream& os, itk::Indent indent) const;
+
+private:
+  ParserProgramGraph(const Self &);   //purposely not implemented
+  void operator =(const Self &);      //purposely not implemented
+
+  typedef ParserProgram::Instruction InstructionType;
+
+  /** One operation of the graph. For a variable, the data is read
+   *  directly from the variable array, otherwise it is stored in the
+   *  scratch array of index Buffer. */
+  struct Node
+    {
+    InstructionType           Instruction;
+    std::vector<unsigned int> Args;
+    unsigned int              Buffer;
+    };
+
+  typedef std::vector<Node>                   NodeListType;
+  typedef std::vector<unsigned int>           KeyType;
+  typedef std::map<KeyType, unsigned int>     NodeMapType;
+
+  /** Return the index of the node computing instruction on args,
+   *  creating it if needed */
+  unsigned int GetNode(const InstructionType& instruction, const std::vector<unsigned int>& args);
+
+  /** Assign the scratch arrays to the nodes */
+  void AllocateBuffers();
+
+  /** Return the data of a node */
+  const ValueType * GetNodeData(const Node& node, const ValueType * const * variables,
+                                ValueType * buffers, unsigned int nbValues) const;
+
+  NodeListType              m_Nodes;
+  NodeMapType               m_NodeMap;
+  std::vector<unsigned int> m_Outputs;
+  std::vector<bool>         m_UsedVariables;
+  unsigned int              m_NumberOfBuffers;
+}; // end class
+
+}//end namespace otb
+
+#endif
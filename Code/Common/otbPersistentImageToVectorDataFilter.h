@@ -26,6 +26,9 @@
 
 #include "otbConcatenateVectorDataFilter.h"
 
+#include <vector>
+#include <map>
+
 namespace otb
 {
 
@@ -39,6 +42,18 @@ namespace otb
  *  the VectorData from the different tiles/strips used during streaming into
  *  a single VectorData, which can be accessed via GetVectorData()
  *
+ *  When MergeSeams is on, the features lying close to a border between two
+ *  tiles are held back until Synthetize(), where the pieces of the same
+ *  object cut by the streaming are fused:
+ *  - polygons sharing a portion of a tile border are united, by cancelling
+ *  their common edges (the fields of the largest piece are kept),
+ *  - two points segments with aligned supports and close extremities
+ *  (SeamTolerance, in pixels, and SeamAngleTolerance, in radians) are
+ *  replaced by the segment joining their farthest extremities.
+ *  The candidate pairs are found with an index of the edges lying on each
+ *  seam line and a grid of the segments extremities. Sub-classes can
+ *  reject a pair by overriding IsConnectedAcrossSeam().
+ *
  * \sa PersistentImageFilter
  *
  */
@@ -76,6 +91,31 @@ public:
   /** Smart Pointer type to a DataObject. */
   typedef itk::DataObject::Pointer DataObjectPointer;
 
+  typedef typename OutputVectorDataType::DataNodeType DataNodeType;
+  typedef typename DataNodeType::Pointer              DataNodePointerType;
+  typedef typename DataNodeType::LineType             LineType;
+  typedef typename DataNodeType::PolygonType          PolygonType;
+  typedef typename DataNodeType::PolygonListType      PolygonListType;
+  typedef typename PolygonType::VertexType            VertexType;
+  typedef typename OutputVectorDataType::DataTreeType DataTreeType;
+  typedef typename DataTreeType::TreeNodeType         TreeNodeType;
+  typedef typename TreeNodeType::ChildrenListType     ChildrenListType;
+
+  /** Set/Get the fusion of the features cut by the tiles borders */
+  itkSetMacro(MergeSeams, bool);
+  itkGetMacro(MergeSeams, bool);
+  itkBooleanMacro(MergeSeams);
+
+  /** Set/Get the distance (in pixels) between two segment extremities
+   * to fuse them across a seam */
+  itkSetMacro(SeamTolerance, double);
+  itkGetMacro(SeamTolerance, double);
+
+  /** Set/Get the maximum angle (in radians) between two segments to
+   * fuse them across a seam */
+  itkSetMacro(SeamAngleTolerance, double);
+  itkGetMacro(SeamAngleTolerance, double);
+
   OutputVectorDataType* GetOutputVectorData() const;
 
   void AllocateOutputs();
@@ -92,6 +132,29 @@ protected:
 
   virtual void GenerateData();
 
+  /** Vectorize the current requested region. The default implementation
+   * calls ProcessTile() on the whole region; sub-classes can cut it into
+   * several tiles, which are then handled as streaming tiles (seams
+   * included). */
+  virtual void ProcessTiles(std::vector<RegionType>& regions,
+                            std::vector<OutputVectorDataPointerType>& tilesVectorData);
+
+  /** Tell whether two features from different tiles, sharing a seam,
+   * belong to the same object. The default implementation accepts all
+   * the geometric candidates. */
+  virtual bool IsConnectedAcrossSeam(unsigned int itkNotUsed(tile1), const DataNodeType * itkNotUsed(feature1),
+                                     unsigned int itkNotUsed(tile2), const DataNodeType * itkNotUsed(feature2)) const
+  {
+    return true;
+  }
+
+  /** Regions of the tiles processed since the last Reset(), in
+   * processing order */
+  const std::vector<RegionType>& GetTileRegions() const
+  {
+    return m_TileRegions;
+  }
+
   ExtractImageFilterPointerType          m_ExtractFilter;
 
   OutputVectorDataPointerType m_OutputVectorData;
@@ -100,6 +163,66 @@ private:
   PersistentImageToVectorDataFilter(const Self &); //purposely not implemented
   void operator =(const Self&); //purposely not implemented
 
+  /** Point with coordinates in thousandths of pixels */
+  typedef std::pair<double, double>                 GridPointType;
+  typedef std::vector<GridPointType>                GridRingType;
+  typedef std::pair<GridPointType, GridPointType>   GridEdgeType;
+
+  /** Axis-aligned polygon edge, indexed by its supporting line */
+  struct SeamEdgeType
+  {
+    double       m_Low;
+    double       m_High;
+    int          m_Direction;
+    unsigned int m_Polygon;
+    bool operator <(const SeamEdgeType& edge) const
+    {
+      return m_Low < edge.m_Low;
+    }
+  };
+
+  /** Flatten the features of a vector data tree */
+  void CollectFeatures(TreeNodeType * source, std::vector<DataNodePointerType>& features) const;
+
+  /** Check if a feature lies close to an internal border of a tile */
+  bool IsOnSeam(const DataNodeType * feature, const RegionType& tile) const;
+
+  /** Fuse the held back segments and polygons */
+  void MergeSeamLines(std::vector<DataNodePointerType>& merged);
+  void MergeSeamPolygons(std::vector<DataNodePointerType>& merged);
+
+  /** Union of polygons with disjoint interiors, by cancellation of their
+   * common edges. Returns false if the result is not a single polygon. */
+  bool FusePolygons(const std::vector<GridRingType>& rings,
+                    GridRingType& exterior, std::vector<GridRingType>& interiors) const;
+
+  /** Union-find helper */
+  static unsigned int FindRoot(std::vector<unsigned int>& parents, unsigned int i);
+
+  /** Conversions between physical coordinates, pixels and the grid */
+  VertexType ToPixel(const VertexType& vertex) const;
+  VertexType FromPixel(const VertexType& pixel) const;
+  GridPointType ToGrid(const VertexType& vertex) const;
+  VertexType FromGrid(const GridPointType& point) const;
+  GridRingType RingToGrid(const PolygonType * ring) const;
+  typename PolygonType::Pointer RingFromGrid(const GridRingType& ring) const;
+
+  /** Merge the vector data of one tile into the output */
+  void AddTile(const RegionType& region, OutputVectorDataType * tileVectorData);
+
+  bool         m_MergeSeams;
+  double       m_SeamTolerance;
+  double       m_SeamAngleTolerance;
+
+  typename InputImageType::PointType   m_Origin;
+  typename InputImageType::SpacingType m_Spacing;
+  RegionType                           m_LargestRegion;
+
+  DataNodePointerType              m_Document;
+  std::vector<RegionType>          m_TileRegions;
+  std::vector<DataNodePointerType> m_SeamFeatures;
+  std::vector<unsigned int>        m_SeamFeatureTiles;
+
   virtual OutputVectorDataPointerType ProcessTile() = 0;
 
 }; // end of class
@@ -23,12 +23,19 @@
 
 #include "otbPersistentImageToVectorDataFilter.h"
 
+#include <algorithm>
+#include <set>
+#include "vcl_cmath.h"
+
 namespace otb
 {
 
 template<class TImage, class TOutputVectorData>
 PersistentImageToVectorDataFilter<TImage, TOutputVectorData>
 ::PersistentImageToVectorDataFilter()
+  : m_MergeSeams(false),
+    m_SeamTolerance(2.0),
+    m_SeamAngleTolerance(0.1)
 {
   m_ExtractFilter = ExtractImageFilterType::New();
   m_OutputVectorData = OutputVectorDataType::New();
@@ -71,6 +78,11 @@ PersistentImageToVectorDataFilter<TImage, TOutputVectorData>
 
   this->GetOutputVectorData()->GetDataTree()->Add(folder, this->GetOutputVectorData()->GetDataTree()->GetRoot()->Get());
   this->GetOutputVectorData()->GetDataTree()->Add(document , folder);
+
+  m_Document = document;
+  m_TileRegions.clear();
+  m_SeamFeatures.clear();
+  m_SeamFeatureTiles.clear();
 }
 
 template<class TImage, class TOutputVectorData>
@@ -78,7 +90,24 @@ void
 PersistentImageToVectorDataFilter<TImage, TOutputVectorData>
 ::Synthetize()
 {
+  if (!m_MergeSeams || m_SeamFeatures.empty())
+    {
+    return;
+    }
+
+  std::vector<DataNodePointerType> merged;
+  this->MergeSeamLines(merged);
+  this->MergeSeamPolygons(merged);
+
+  for (unsigned int i = 0; i < merged.size(); ++i)
+    {
+    this->GetOutputVectorData()->GetDataTree()->Add(merged[i], m_Document);
+    }
 
+  otbMsgDevMacro(<< m_SeamFeatures.size() << " features along the seams merged into " << merged.size());
+
+  m_SeamFeatures.clear();
+  m_SeamFeatureTiles.clear();
 }
 
 template<class TImage, class TOutputVectorData>
@@ -87,11 +116,69 @@ PersistentImageToVectorDataFilter<TImage, TOutputVectorData>
 ::GenerateData()
 {
   // call the processing function for this tile
-  OutputVectorDataPointerType currentTileVD = this->ProcessTile();
+  std::vector<RegionType>                  regions;
+  std::vector<OutputVectorDataPointerType> tilesVectorData;
+  this->ProcessTiles(regions, tilesVectorData);
+
+  // merge the results into the output vector data object
+  for (unsigned int i = 0; i < tilesVectorData.size(); ++i)
+    {
+    this->AddTile(regions[i], tilesVectorData[i]);
+    }
+}
 
-  // merge the result into the output vector data object
+template<class TImage, class TOutputVectorData>
+void
+PersistentImageToVectorDataFilter<TImage, TOutputVectorData>
+::ProcessTiles(std::vector<RegionType>& regions, std::vector<OutputVectorDataPointerType>& tilesVectorData)
+{
+  regions.push_back(this->GetOutput()->GetRequestedRegion());
+  tilesVectorData.push_back(this->ProcessTile());
+}
+
+template<class TImage, class TOutputVectorData>
+void
+PersistentImageToVectorDataFilter<TImage, TOutputVectorData>
+::AddTile(const RegionType& region, OutputVectorDataType * currentTileVD)
+{
   OutputVectorDataPointerType output = GetOutputVectorData();
 
+  if (m_MergeSeams)
+    {
+    if (m_Document.IsNull())
+      {
+      // Only initialize the output document: the Reset() of the
+      // subclasses may pull the input, which is being streamed
+      this->Self::Reset();
+      }
+    m_Origin = this->GetInput()->GetOrigin();
+    m_Spacing = this->GetInput()->GetSpacing();
+    m_LargestRegion = this->GetInput()->GetLargestPossibleRegion();
+
+    const unsigned int tile = m_TileRegions.size();
+    m_TileRegions.push_back(region);
+
+    // The features away from the tile borders are final, the other ones
+    // wait for their neighbours in Synthetize()
+    std::vector<DataNodePointerType> features;
+    this->CollectFeatures(const_cast<TreeNodeType *>(currentTileVD->GetDataTree()->GetRoot()), features);
+    for (unsigned int i = 0; i < features.size(); ++i)
+      {
+      if (this->IsOnSeam(features[i], region))
+        {
+        m_SeamFeatures.push_back(features[i]);
+        m_SeamFeatureTiles.push_back(tile);
+        }
+      else
+        {
+        output->GetDataTree()->Add(features[i], m_Document);
+        }
+      }
+
+    output->SetMetaDataDictionary(currentTileVD->GetMetaDataDictionary());
+    return;
+    }
+
   ConcatenateVectorDataFilterPointerType concatenate = ConcatenateVectorDataFilterType::New();
   concatenate->AddInput(currentTileVD);
   concatenate->AddInput(output);
@@ -109,6 +196,683 @@ PersistentImageToVectorDataFilter<TImage, TOutputVectorData>
 ::PrintSelf(std::ostream& os, itk::Indent indent) const
 {
   Superclass::PrintSelf(os, indent);
+  os << indent << "MergeSeams: " << m_MergeSeams << std::endl;
+  os << indent << "SeamTolerance: " << m_SeamTolerance << std::endl;
+  os << indent << "SeamAngleTolerance: " << m_SeamAngleTolerance << std::endl;
+}
+
+template<class TImage, class TOutputVectorData>
+void
+PersistentImageToVectorDataFilter<TImage, TOutputVectorData>
+::CollectFeatures(TreeNodeType * source, std::vector<DataNodePointerType>& features) const
+{
+  if (source == 0)
+    {
+    return;
+    }
+
+  ChildrenListType children = source->GetChildrenList();
+  for (typename ChildrenListType::iterator it = children.begin(); it != children.end(); ++it)
+    {
+    DataNodePointerType dataNode = (*it)->Get();
+    if (dataNode->IsPointFeature() || dataNode->IsLineFeature() || dataNode->IsPolygonFeature())
+      {
+      features.push_back(dataNode);
+      }
+    else
+      {
+      this->CollectFeatures(*it, features);
+      }
+    }
+}
+
+template<class TImage, class TOutputVectorData>
+bool
+PersistentImageToVectorDataFilter<TImage, TOutputVectorData>
+::IsOnSeam(const DataNodeType * feature, const RegionType& tile) const
+{
+  typename PolygonType::VertexListType::ConstPointer vertices;
+  if (feature->IsLineFeature())
+    {
+    vertices = feature->GetLine()->GetVertexList();
+    }
+  else if (feature->IsPolygonFeature())
+    {
+    vertices = feature->GetPolygonExteriorRing()->GetVertexList();
+    }
+  else
+    {
+    return false;
+    }
+  if (vertices->Size() == 0)
+    {
+    return false;
+    }
+
+  // Bounding box in pixels
+  VertexType lower = this->ToPixel(vertices->Begin().Value());
+  VertexType upper = lower;
+  for (typename PolygonType::VertexListType::ConstIterator it = vertices->Begin(); it != vertices->End(); ++it)
+    {
+    const VertexType pixel = this->ToPixel(it.Value());
+    for (unsigned int d = 0; d < 2; ++d)
+      {
+      lower[d] = std::min(lower[d], pixel[d]);
+      upper[d] = std::max(upper[d], pixel[d]);
+      }
+    }
+
+  // Pixel edges of the tile borders shared with another tile
+  const RegionType largest = m_LargestRegion;
+  const double     tolerance = std::max(m_SeamTolerance, 1.0);
+  for (unsigned int d = 0; d < 2; ++d)
+    {
+    const long tileBegin = tile.GetIndex()[d];
+    const long tileEnd = tileBegin + static_cast<long>(tile.GetSize()[d]);
+    const long imageBegin = largest.GetIndex()[d];
+    const long imageEnd = imageBegin + static_cast<long>(largest.GetSize()[d]);
+    if (tileBegin > imageBegin && lower[d] <= tileBegin - 0.5 + tolerance)
+      {
+      return true;
+      }
+    if (tileEnd < imageEnd && upper[d] >= tileEnd - 0.5 - tolerance)
+      {
+      return true;
+      }
+    }
+  return false;
+}
+
+template<class TImage, class TOutputVectorData>
+void
+PersistentImageToVectorDataFilter<TImage, TOutputVectorData>
+::MergeSeamLines(std::vector<DataNodePointerType>& merged)
+{
+  // Segments with their extremities in pixels
+  std::vector<unsigned int> lines;
+  std::vector<VertexType>   firsts, lasts;
+  for (unsigned int i = 0; i < m_SeamFeatures.size(); ++i)
+    {
+    if (!m_SeamFeatures[i]->IsLineFeature())
+      {
+      continue;
+      }
+    typename LineType::VertexListType::ConstPointer vertices = m_SeamFeatures[i]->GetLine()->GetVertexList();
+    if (vertices->Size() != 2)
+      {
+      merged.push_back(m_SeamFeatures[i]);
+      continue;
+      }
+    lines.push_back(i);
+    firsts.push_back(this->ToPixel(vertices->ElementAt(0)));
+    lasts.push_back(this->ToPixel(vertices->ElementAt(1)));
+    }
+  if (lines.empty())
+    {
+    return;
+    }
+
+  // Grid of the extremities, with cells as large as the tolerance
+  typedef std::pair<long, long>                             CellType;
+  typedef std::map<CellType, std::vector<unsigned int> >   CellMapType;
+  const double cellSize = std::max(m_SeamTolerance, 1.0);
+  CellMapType  cells;
+  for (unsigned int i = 0; i < lines.size(); ++i)
+    {
+    cells[CellType(static_cast<long>(vcl_floor(firsts[i][0] / cellSize)),
+                   static_cast<long>(vcl_floor(firsts[i][1] / cellSize)))].push_back(i);
+    cells[CellType(static_cast<long>(vcl_floor(lasts[i][0] / cellSize)),
+                   static_cast<long>(vcl_floor(lasts[i][1] / cellSize)))].push_back(i);
+    }
+
+  std::vector<unsigned int> parents(lines.size());
+  for (unsigned int i = 0; i < lines.size(); ++i)
+    {
+    parents[i] = i;
+    }
+
+  const double sinTolerance = vcl_sin(m_SeamAngleTolerance);
+  std::set<std::pair<unsigned int, unsigned int> > tested;
+
+  for (unsigned int i = 0; i < lines.size(); ++i)
+    {
+    const VertexType extremities[2] = {firsts[i], lasts[i]};
+    for (unsigned int e = 0; e < 2; ++e)
+      {
+      const long cx = static_cast<long>(vcl_floor(extremities[e][0] / cellSize));
+      const long cy = static_cast<long>(vcl_floor(extremities[e][1] / cellSize));
+      for (long dy = -1; dy <= 1; ++dy)
+        {
+        for (long dx = -1; dx <= 1; ++dx)
+          {
+          typename CellMapType::const_iterator cell = cells.find(CellType(cx + dx, cy + dy));
+          if (cell == cells.end())
+            {
+            continue;
+            }
+          for (unsigned int k = 0; k < cell->second.size(); ++k)
+            {
+            const unsigned int j = cell->second[k];
+            if (j <= i || m_SeamFeatureTiles[lines[i]] == m_SeamFeatureTiles[lines[j]]
+                || !tested.insert(std::make_pair(i, j)).second)
+              {
+              continue;
+              }
+
+            // Aligned supports
+            const double lengthI = firsts[i].EuclideanDistanceTo(lasts[i]);
+            const double lengthJ = firsts[j].EuclideanDistanceTo(lasts[j]);
+            if (lengthI == 0. || lengthJ == 0.)
+              {
+              continue;
+              }
+            const double ux = (lasts[i][0] - firsts[i][0]) / lengthI;
+            const double uy = (lasts[i][1] - firsts[i][1]) / lengthI;
+            const double vx = (lasts[j][0] - firsts[j][0]) / lengthJ;
+            const double vy = (lasts[j][1] - firsts[j][1]) / lengthJ;
+            if (vcl_abs(ux * vy - uy * vx) > sinTolerance)
+              {
+              continue;
+              }
+
+            // Close supports and no gap along them
+            const double d1 = vcl_abs((firsts[j][0] - firsts[i][0]) * uy - (firsts[j][1] - firsts[i][1]) * ux);
+            const double d2 = vcl_abs((lasts[j][0] - firsts[i][0]) * uy - (lasts[j][1] - firsts[i][1]) * ux);
+            const double t1 = (firsts[j][0] - firsts[i][0]) * ux + (firsts[j][1] - firsts[i][1]) * uy;
+            const double t2 = (lasts[j][0] - firsts[i][0]) * ux + (lasts[j][1] - firsts[i][1]) * uy;
+            const double gap = std::max(std::min(t1, t2) - lengthI, -std::max(t1, t2));
+            if (d1 > m_SeamTolerance || d2 > m_SeamTolerance || gap > m_SeamTolerance)
+              {
+              continue;
+              }
+
+            if (this->IsConnectedAcrossSeam(m_SeamFeatureTiles[lines[i]], m_SeamFeatures[lines[i]],
+                                            m_SeamFeatureTiles[lines[j]], m_SeamFeatures[lines[j]]))
+              {
+              parents[FindRoot(parents, j)] = FindRoot(parents, i);
+              }
+            }
+          }
+        }
+      }
+    }
+
+  // Each group is replaced by the segment joining its farthest
+  // extremities along the longest piece
+  std::map<unsigned int, std::vector<unsigned int> > groups;
+  for (unsigned int i = 0; i < lines.size(); ++i)
+    {
+    groups[FindRoot(parents, i)].push_back(i);
+    }
+
+  for (typename std::map<unsigned int, std::vector<unsigned int> >::const_iterator group = groups.begin();
+       group != groups.end(); ++group)
+    {
+    const std::vector<unsigned int>& members = group->second;
+    unsigned int longest = members[0];
+    for (unsigned int k = 1; k < members.size(); ++k)
+      {
+      if (firsts[members[k]].EuclideanDistanceTo(lasts[members[k]])
+          > firsts[longest].EuclideanDistanceTo(lasts[longest]))
+        {
+        longest = members[k];
+        }
+      }
+    DataNodePointerType node = m_SeamFeatures[lines[longest]];
+    if (members.size() > 1)
+      {
+      const double length = firsts[longest].EuclideanDistanceTo(lasts[longest]);
+      const double ux = (lasts[longest][0] - firsts[longest][0]) / length;
+      const double uy = (lasts[longest][1] - firsts[longest][1]) / length;
+      VertexType   first = firsts[longest], last = lasts[longest];
+      double       tMin = 0., tMax = length;
+      for (unsigned int k = 0; k < members.size(); ++k)
+        {
+        const VertexType extremities[2] = {firsts[members[k]], lasts[members[k]]};
+        for (unsigned int e = 0; e < 2; ++e)
+          {
+          const double t = (extremities[e][0] - firsts[longest][0]) * ux
+                           + (extremities[e][1] - firsts[longest][1]) * uy;
+          if (t < tMin)
+            {
+            tMin = t;
+            first = extremities[e];
+            }
+          if (t > tMax)
+            {
+            tMax = t;
+            last = extremities[e];
+            }
+          }
+        }
+      typename LineType::Pointer line = LineType::New();
+      line->SetMetaDataDictionary(node->GetLine()->GetMetaDataDictionary());
+      line->AddVertex(this->FromPixel(first));
+      line->AddVertex(this->FromPixel(last));
+      node->SetLine(line);
+      }
+    merged.push_back(node);
+    }
+}
+
+template<class TImage, class TOutputVectorData>
+void
+PersistentImageToVectorDataFilter<TImage, TOutputVectorData>
+::MergeSeamPolygons(std::vector<DataNodePointerType>& merged)
+{
+  // Exterior rings on the grid, counter-clockwise
+  std::vector<unsigned int> polygons;
+  std::vector<GridRingType> exteriors;
+  std::vector<double>       areas;
+  for (unsigned int i = 0; i < m_SeamFeatures.size(); ++i)
+    {
+    if (!m_SeamFeatures[i]->IsPolygonFeature())
+      {
+      if (m_SeamFeatures[i]->IsPointFeature())
+        {
+        merged.push_back(m_SeamFeatures[i]);
+        }
+      continue;
+      }
+    GridRingType ring = this->RingToGrid(m_SeamFeatures[i]->GetPolygonExteriorRing());
+    double       area = 0.;
+    for (unsigned int k = 0; k < ring.size(); ++k)
+      {
+      const GridPointType& a = ring[k];
+      const GridPointType& b = ring[(k + 1) % ring.size()];
+      area += a.first * b.second - b.first * a.second;
+      }
+    if (area < 0)
+      {
+      std::reverse(ring.begin(), ring.end());
+      }
+    polygons.push_back(i);
+    exteriors.push_back(ring);
+    areas.push_back(vcl_abs(area));
+    }
+  if (polygons.empty())
+    {
+    return;
+    }
+
+  // Index of the axis-aligned edges by supporting line: first member of
+  // the key is 0 for horizontal edges and 1 for vertical ones
+  typedef std::pair<int, double>                          LineKeyType;
+  typedef std::map<LineKeyType, std::vector<SeamEdgeType> > LineMapType;
+  LineMapType edgesByLine;
+  for (unsigned int p = 0; p < polygons.size(); ++p)
+    {
+    const GridRingType& ring = exteriors[p];
+    for (unsigned int k = 0; k < ring.size(); ++k)
+      {
+      const GridPointType& a = ring[k];
+      const GridPointType& b = ring[(k + 1) % ring.size()];
+      SeamEdgeType edge;
+      edge.m_Polygon = p;
+      if (a.second == b.second && a.first != b.first)
+        {
+        edge.m_Low = std::min(a.first, b.first);
+        edge.m_High = std::max(a.first, b.first);
+        edge.m_Direction = (b.first > a.first) ? 1 : -1;
+        edgesByLine[LineKeyType(0, a.second)].push_back(edge);
+        }
+      else if (a.first == b.first && a.second != b.second)
+        {
+        edge.m_Low = std::min(a.second, b.second);
+        edge.m_High = std::max(a.second, b.second);
+        edge.m_Direction = (b.second > a.second) ? 1 : -1;
+        edgesByLine[LineKeyType(1, a.first)].push_back(edge);
+        }
+      }
+    }
+
+  // Polygons from different tiles with overlapping opposite edges are
+  // two pieces of the same object
+  std::vector<unsigned int> parents(polygons.size());
+  for (unsigned int p = 0; p < polygons.size(); ++p)
+    {
+    parents[p] = p;
+    }
+  std::set<std::pair<unsigned int, unsigned int> > tested;
+
+  for (typename LineMapType::iterator line = edgesByLine.begin(); line != edgesByLine.end(); ++line)
+    {
+    std::vector<SeamEdgeType>& edges = line->second;
+    std::sort(edges.begin(), edges.end());
+    for (unsigned int i = 0; i < edges.size(); ++i)
+      {
+      for (unsigned int j = i + 1; j < edges.size() && edges[j].m_Low < edges[i].m_High; ++j)
+        {
+        const unsigned int p1 = std::min(edges[i].m_Polygon, edges[j].m_Polygon);
+        const unsigned int p2 = std::max(edges[i].m_Polygon, edges[j].m_Polygon);
+        if (edges[i].m_Direction == edges[j].m_Direction
+            || m_SeamFeatureTiles[polygons[p1]] == m_SeamFeatureTiles[polygons[p2]]
+            || !tested.insert(std::make_pair(p1, p2)).second)
+          {
+          continue;
+          }
+        if (this->IsConnectedAcrossSeam(m_SeamFeatureTiles[polygons[p1]], m_SeamFeatures[polygons[p1]],
+                                        m_SeamFeatureTiles[polygons[p2]], m_SeamFeatures[polygons[p2]]))
+          {
+          parents[FindRoot(parents, p2)] = FindRoot(parents, p1);
+          }
+        }
+      }
+    }
+
+  std::map<unsigned int, std::vector<unsigned int> > groups;
+  for (unsigned int p = 0; p < polygons.size(); ++p)
+    {
+    groups[FindRoot(parents, p)].push_back(p);
+    }
+
+  for (typename std::map<unsigned int, std::vector<unsigned int> >::const_iterator group = groups.begin();
+       group != groups.end(); ++group)
+    {
+    const std::vector<unsigned int>& members = group->second;
+    if (members.size() == 1)
+      {
+      merged.push_back(m_SeamFeatures[polygons[members[0]]]);
+      continue;
+      }
+
+    // Rings of all the pieces: exteriors counter-clockwise, holes clockwise
+    std::vector<GridRingType> rings;
+    unsigned int              largest = members[0];
+    for (unsigned int k = 0; k < members.size(); ++k)
+      {
+      rings.push_back(exteriors[members[k]]);
+      if (areas[members[k]] > areas[largest])
+        {
+        largest = members[k];
+        }
+      typename PolygonListType::Pointer holes = m_SeamFeatures[polygons[members[k]]]->GetPolygonInteriorRings();
+      for (unsigned int h = 0; holes.IsNotNull() && h < holes->Size(); ++h)
+        {
+        GridRingType hole = this->RingToGrid(holes->GetNthElement(h));
+        double       area = 0.;
+        for (unsigned int v = 0; v < hole.size(); ++v)
+          {
+          area += hole[v].first * hole[(v + 1) % hole.size()].second
+                  - hole[(v + 1) % hole.size()].first * hole[v].second;
+          }
+        if (area > 0)
+          {
+          std::reverse(hole.begin(), hole.end());
+          }
+        rings.push_back(hole);
+        }
+      }
+
+    GridRingType              exterior;
+    std::vector<GridRingType> interiors;
+    if (!this->FusePolygons(rings, exterior, interiors))
+      {
+      // Keep the pieces rather than a wrong geometry
+      for (unsigned int k = 0; k < members.size(); ++k)
+        {
+        merged.push_back(m_SeamFeatures[polygons[members[k]]]);
+        }
+      continue;
+      }
+
+    // The largest piece carries the fields of the merged object
+    DataNodePointerType node = m_SeamFeatures[polygons[largest]];
+    node->SetPolygonExteriorRing(this->RingFromGrid(exterior));
+    typename PolygonListType::Pointer holes = PolygonListType::New();
+    for (unsigned int h = 0; h < interiors.size(); ++h)
+      {
+      holes->PushBack(this->RingFromGrid(interiors[h]));
+      }
+    node->SetPolygonInteriorRings(holes);
+    merged.push_back(node);
+    }
+}
+
+template<class TImage, class TOutputVectorData>
+bool
+PersistentImageToVectorDataFilter<TImage, TOutputVectorData>
+::FusePolygons(const std::vector<GridRingType>& rings,
+               GridRingType& exterior, std::vector<GridRingType>& interiors) const
+{
+  // Split the axis-aligned edges at the vertices lying on their line, so
+  // that the common parts of two boundaries become identical edges
+  std::map<double, std::vector<double> > onHorizontal, onVertical;
+  for (unsigned int r = 0; r < rings.size(); ++r)
+    {
+    for (unsigned int k = 0; k < rings[r].size(); ++k)
+      {
+      onHorizontal[rings[r][k].second].push_back(rings[r][k].first);
+      onVertical[rings[r][k].first].push_back(rings[r][k].second);
+      }
+    }
+
+  std::map<GridEdgeType, int> edges;
+  for (unsigned int r = 0; r < rings.size(); ++r)
+    {
+    for (unsigned int k = 0; k < rings[r].size(); ++k)
+      {
+      const GridPointType& a = rings[r][k];
+      const GridPointType& b = rings[r][(k + 1) % rings[r].size()];
+      if (a == b)
+        {
+        continue;
+        }
+
+      std::vector<GridPointType> points;
+      points.push_back(a);
+      if (a.second == b.second || a.first == b.first)
+        {
+        const bool                 horizontal = (a.second == b.second);
+        const std::vector<double>& cuts = horizontal ? onHorizontal[a.second] : onVertical[a.first];
+        const double               from = horizontal ? a.first : a.second;
+        const double               to = horizontal ? b.first : b.second;
+        std::vector<double>        inside;
+        for (unsigned int c = 0; c < cuts.size(); ++c)
+          {
+          if (cuts[c] > std::min(from, to) && cuts[c] < std::max(from, to))
+            {
+            inside.push_back(cuts[c]);
+            }
+          }
+        std::sort(inside.begin(), inside.end());
+        inside.erase(std::unique(inside.begin(), inside.end()), inside.end());
+        if (to < from)
+          {
+          std::reverse(inside.begin(), inside.end());
+          }
+        for (unsigned int c = 0; c < inside.size(); ++c)
+          {
+          points.push_back(horizontal ? GridPointType(inside[c], a.second) : GridPointType(a.first, inside[c]));
+          }
+        }
+      points.push_back(b);
+
+      // An edge cancels the opposite one
+      for (unsigned int c = 0; c + 1 < points.size(); ++c)
+        {
+        const GridEdgeType edge(points[c], points[c + 1]);
+        const GridEdgeType opposite(points[c + 1], points[c]);
+        typename std::map<GridEdgeType, int>::iterator it = edges.find(opposite);
+        if (it != edges.end())
+          {
+          if (--(it->second) == 0)
+            {
+            edges.erase(it);
+            }
+          }
+        else
+          {
+          ++edges[edge];
+          }
+        }
+      }
+    }
+
+  // Link the remaining edges into rings
+  std::multimap<GridPointType, GridPointType> nexts;
+  for (typename std::map<GridEdgeType, int>::const_iterator it = edges.begin(); it != edges.end(); ++it)
+    {
+    for (int c = 0; c < it->second; ++c)
+      {
+      nexts.insert(it->first);
+      }
+    }
+
+  std::vector<GridRingType> outers;
+  interiors.clear();
+  while (!nexts.empty())
+    {
+    typename std::multimap<GridPointType, GridPointType>::iterator it = nexts.begin();
+    const GridPointType start = it->first;
+    GridPointType       current = it->second;
+    GridRingType        ring(1, start);
+    nexts.erase(it);
+    while (current != start)
+      {
+      ring.push_back(current);
+      it = nexts.find(current);
+      if (it == nexts.end())
+        {
+        return false;
+        }
+      current = it->second;
+      nexts.erase(it);
+      }
+
+    // Remove the vertices in the middle of straight edges
+    GridRingType simplified;
+    for (unsigned int k = 0; k < ring.size(); ++k)
+      {
+      const GridPointType& previous = ring[(k + ring.size() - 1) % ring.size()];
+      const GridPointType& next = ring[(k + 1) % ring.size()];
+      const double         cross = (ring[k].first - previous.first) * (next.second - ring[k].second)
+                                   - (ring[k].second - previous.second) * (next.first - ring[k].first);
+      const double         scale = (vcl_abs(ring[k].first - previous.first) + vcl_abs(ring[k].second - previous.second))
+                                   * (vcl_abs(next.first - ring[k].first) + vcl_abs(next.second - ring[k].second));
+      if (vcl_abs(cross) > 1e-12 * scale)
+        {
+        simplified.push_back(ring[k]);
+        }
+      }
+    if (simplified.size() < 3)
+      {
+      continue;
+      }
+
+    double area = 0.;
+    for (unsigned int k = 0; k < simplified.size(); ++k)
+      {
+      area += simplified[k].first * simplified[(k + 1) % simplified.size()].second
+              - simplified[(k + 1) % simplified.size()].first * simplified[k].second;
+      }
+    if (area > 0)
+      {
+      outers.push_back(simplified);
+      }
+    else
+      {
+      interiors.push_back(simplified);
+      }
+    }
+
+  if (outers.size() != 1)
+    {
+    return false;
+    }
+  exterior = outers[0];
+  return true;
+}
+
+template<class TImage, class TOutputVectorData>
+unsigned int
+PersistentImageToVectorDataFilter<TImage, TOutputVectorData>
+::FindRoot(std::vector<unsigned int>& parents, unsigned int i)
+{
+  while (parents[i] != i)
+    {
+    parents[i] = parents[parents[i]];
+    i = parents[i];
+    }
+  return i;
+}
+
+template<class TImage, class TOutputVectorData>
+typename PersistentImageToVectorDataFilter<TImage, TOutputVectorData>::VertexType
+PersistentImageToVectorDataFilter<TImage, TOutputVectorData>
+::ToPixel(const VertexType& vertex) const
+{
+  VertexType pixel;
+  pixel[0] = (vertex[0] - m_Origin[0]) / m_Spacing[0];
+  pixel[1] = (vertex[1] - m_Origin[1]) / m_Spacing[1];
+  return pixel;
+}
+
+template<class TImage, class TOutputVectorData>
+typename PersistentImageToVectorDataFilter<TImage, TOutputVectorData>::VertexType
+PersistentImageToVectorDataFilter<TImage, TOutputVectorData>
+::FromPixel(const VertexType& pixel) const
+{
+  VertexType vertex;
+  vertex[0] = m_Origin[0] + pixel[0] * m_Spacing[0];
+  vertex[1] = m_Origin[1] + pixel[1] * m_Spacing[1];
+  return vertex;
+}
+
+template<class TImage, class TOutputVectorData>
+typename PersistentImageToVectorDataFilter<TImage, TOutputVectorData>::GridPointType
+PersistentImageToVectorDataFilter<TImage, TOutputVectorData>
+::ToGrid(const VertexType& vertex) const
+{
+  const VertexType pixel = this->ToPixel(vertex);
+  return GridPointType(vcl_floor(pixel[0] * 1000. + 0.5), vcl_floor(pixel[1] * 1000. + 0.5));
+}
+
+template<class TImage, class TOutputVectorData>
+typename PersistentImageToVectorDataFilter<TImage, TOutputVectorData>::VertexType
+PersistentImageToVectorDataFilter<TImage, TOutputVectorData>
+::FromGrid(const GridPointType& point) const
+{
+  VertexType pixel;
+  pixel[0] = point.first / 1000.;
+  pixel[1] = point.second / 1000.;
+  return this->FromPixel(pixel);
+}
+
+template<class TImage, class TOutputVectorData>
+typename PersistentImageToVectorDataFilter<TImage, TOutputVectorData>::GridRingType
+PersistentImageToVectorDataFilter<TImage, TOutputVectorData>
+::RingToGrid(const PolygonType * ring) const
+{
+  GridRingType gridRing;
+  for (typename PolygonType::VertexListType::ConstIterator it = ring->GetVertexList()->Begin();
+       it != ring->GetVertexList()->End(); ++it)
+    {
+    const GridPointType point = this->ToGrid(it.Value());
+    if (gridRing.empty() || point != gridRing.back())
+      {
+      gridRing.push_back(point);
+      }
+    }
+  // Closed rings repeat their first vertex
+  if (gridRing.size() > 1 && gridRing.front() == gridRing.back())
+    {
+    gridRing.pop_back();
+    }
+  return gridRing;
+}
+
+template<class TImage, class TOutputVectorData>
+typename PersistentImageToVectorDataFilter<TImage, TOutputVectorData>::PolygonType::Pointer
+PersistentImageToVectorDataFilter<TImage, TOutputVectorData>
+::RingFromGrid(const GridRingType& ring) const
+{
+  typename PolygonType::Pointer polygon = PolygonType::New();
+  for (unsigned int k = 0; k < ring.size(); ++k)
+    {
+    polygon->AddVertex(this->FromGrid(ring[k]));
+    }
+  return polygon;
 }
 
 } // end namespace otb
@@ -22,19 +22,66 @@
 #include "otbImage.h"
 #include "otbVectorImage.h"
 #include "itkFixedArray.h"
+#include "itkCommand.h"
 #include "otbImageList.h"
 
+#include <algorithm>
+#include <typeinfo>
+#include <cstdio>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#elif defined(__linux__)
+#include <unistd.h>
+#endif
+
 namespace otb
 {
 const double PipelineMemoryPrintCalculator::ByteToMegabyte = 1./vcl_pow(2.0, 20);
 const double PipelineMemoryPrintCalculator::MegabyteToByte = vcl_pow(2.0, 20);
 
+/** Default allocated memory function: bytes in use according to the
+ * malloc statistics, or resident size of the process */
+static PipelineMemoryPrintCalculator::MemoryPrintType DefaultAllocatedMemory()
+{
+  typedef PipelineMemoryPrintCalculator::MemoryPrintType MemoryPrintType;
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+  struct mallinfo2 info = mallinfo2();
+  return static_cast<MemoryPrintType>(info.uordblks) + static_cast<MemoryPrintType>(info.hblkhd);
+#elif defined(__GLIBC__)
+  struct mallinfo info = mallinfo();
+  return static_cast<MemoryPrintType>(static_cast<unsigned int>(info.uordblks))
+    + static_cast<MemoryPrintType>(static_cast<unsigned int>(info.hblkhd));
+#elif defined(__linux__)
+  MemoryPrintType residentPages = 0;
+  FILE * statm = fopen("/proc/self/statm", "r");
+  if (statm)
+    {
+    long size, resident;
+    if (fscanf(statm, "%ld %ld", &size, &resident) == 2)
+      {
+      residentPages = resident;
+      }
+    fclose(statm);
+    }
+  return residentPages * sysconf(_SC_PAGESIZE);
+#else
+  return 0;
+#endif
+}
+
+PipelineMemoryPrintCalculator::AllocatedMemoryFunctionType
+PipelineMemoryPrintCalculator::m_AllocatedMemoryFunction = &DefaultAllocatedMemory;
+
 PipelineMemoryPrintCalculator
 ::PipelineMemoryPrintCalculator()
   : m_MemoryPrint(0),
     m_DataToWrite(NULL),
     m_BiasCorrectionFactor(1.),
-    m_VisitedProcessObjects()
+    m_VisitedProcessObjects(),
+    m_UseMeasuredMemoryPrint(false),
+    m_MemoryPrintMeasured(false),
+    m_StartAllocatedMemory(0),
+    m_PeakAllocatedMemory(0)
 {}
 
 PipelineMemoryPrintCalculator
@@ -52,6 +99,22 @@ PipelineMemoryPrintCalculator
   return divisions;
 }
 
+// [static]
+void
+PipelineMemoryPrintCalculator
+::SetAllocatedMemoryFunction(AllocatedMemoryFunctionType function)
+{
+  m_AllocatedMemoryFunction = function ? function : &DefaultAllocatedMemory;
+}
+
+// [static]
+PipelineMemoryPrintCalculator::MemoryPrintType
+PipelineMemoryPrintCalculator
+::GetAllocatedMemory()
+{
+  return (*m_AllocatedMemoryFunction)();
+}
+
 void
 PipelineMemoryPrintCalculator
 ::PrintSelf(std::ostream& os, itk::Indent indent) const
@@ -63,6 +126,19 @@ PipelineMemoryPrintCalculator
   os<<indent<<"Data to write:                      "<<m_DataToWrite<<std::endl;
   os<<indent<<"Memory print of whole pipeline:     "<<m_MemoryPrint * ByteToMegabyte <<" Mb"<<std::endl;
   os<<indent<<"Bias correction factor applied:     "<<m_BiasCorrectionFactor<<std::endl;
+  os<<indent<<"Measured memory print:              "<<(m_UseMeasuredMemoryPrint ? "On" : "Off")<<std::endl;
+  os<<indent<<"Memory print was measured:          "<<(m_MemoryPrintMeasured ? "Yes" : "No")<<std::endl;
+
+  for(unsigned int i = 0; i < m_FilterMemoryPrints.size(); ++i)
+    {
+    os<<indent<<"  "<<m_FilterMemoryPrints[i].m_NameOfClass<<" ("<<m_FilterMemoryPrints[i].m_Filter<<"): "
+      <<m_FilterMemoryPrints[i].m_EstimatedPrint * ByteToMegabyte<<" Mb estimated";
+    if(m_UseMeasuredMemoryPrint)
+      {
+      os<<", "<<m_FilterMemoryPrints[i].m_MeasuredPrint * ByteToMegabyte<<" Mb measured";
+      }
+    os<<std::endl;
+    }
 }
 
 void
@@ -71,6 +147,9 @@ PipelineMemoryPrintCalculator
 {
   // Clear the visited process objects set
   m_VisitedProcessObjects.clear();
+  m_FilterMemoryPrints.clear();
+  m_FilterIndices.clear();
+  m_MemoryPrintMeasured = false;
 
   // Dry run of pipeline synchronisation
   m_DataToWrite->UpdateOutputInformation();
@@ -92,9 +171,145 @@ PipelineMemoryPrintCalculator
     m_MemoryPrint = EvaluateDataObjectPrint(m_DataToWrite);
     }
 
+  // Replace the estimation by the measured print if possible
+  if(m_UseMeasuredMemoryPrint)
+    {
+    MemoryPrintType measuredPrint = this->MeasurePipelinePrint();
+
+    if(measuredPrint > 0)
+      {
+      otbMsgDevMacro(<< "Measured memory print: " << measuredPrint << " bytes, estimated: " << m_MemoryPrint << " bytes")
+      m_MemoryPrint = measuredPrint;
+      m_MemoryPrintMeasured = true;
+      }
+    else
+      {
+      otbWarningMacro(<< "Unable to measure the allocated memory, using the estimated memory print.");
+      }
+    }
+
   // Apply bias correction factor
   m_MemoryPrint *= m_BiasCorrectionFactor;
 
+  for(unsigned int i = 0; i < m_FilterMemoryPrints.size(); ++i)
+    {
+    m_FilterMemoryPrints[i].m_EstimatedPrint *= m_BiasCorrectionFactor;
+    m_FilterMemoryPrints[i].m_MeasuredPrint *= m_BiasCorrectionFactor;
+    m_FilterMemoryPrints[i].m_PeakPrint *= m_BiasCorrectionFactor;
+    }
+}
+
+PipelineMemoryPrintCalculator::MemoryPrintType
+PipelineMemoryPrintCalculator
+::MeasurePipelinePrint()
+{
+  MemoryPrintType startAllocatedMemory = GetAllocatedMemory();
+  if(startAllocatedMemory == 0)
+    {
+    return 0;
+    }
+
+  // Observe the filters of the pipeline
+  typedef itk::MemberCommand<Self> CommandType;
+  CommandType::Pointer command = CommandType::New();
+  command->SetCallbackFunction(this, &Self::ObserveFilterEvent);
+
+  std::vector<unsigned long> startTags, progressTags, endTags;
+  for(unsigned int i = 0; i < m_FilterMemoryPrints.size(); ++i)
+    {
+    const ProcessObjectType * filter = m_FilterMemoryPrints[i].m_Filter;
+    startTags.push_back(filter->AddObserver(itk::StartEvent(), command));
+    progressTags.push_back(filter->AddObserver(itk::ProgressEvent(), command));
+    endTags.push_back(filter->AddObserver(itk::EndEvent(), command));
+    }
+
+  m_FilterStartAllocatedMemory.assign(m_FilterMemoryPrints.size(), startAllocatedMemory);
+  m_StartAllocatedMemory = startAllocatedMemory;
+  m_PeakAllocatedMemory = startAllocatedMemory;
+
+  // Buffers computed before (or kept by a previous probe) would be
+  // reused instead of being allocated by the probe
+  this->ReleasePipelineData();
+
+  // Run the probe, the requested region has already been propagated
+  bool success = true;
+  try
+    {
+    m_DataToWrite->UpdateOutputData();
+    }
+  catch(itk::ExceptionObject & err)
+    {
+    otbWarningMacro(<< "Memory print measurement failed: " << err.GetDescription());
+    success = false;
+    }
+
+  for(unsigned int i = 0; i < m_FilterMemoryPrints.size(); ++i)
+    {
+    ProcessObjectType * filter = const_cast<ProcessObjectType *>(m_FilterMemoryPrints[i].m_Filter);
+    filter->RemoveObserver(startTags[i]);
+    filter->RemoveObserver(progressTags[i]);
+    filter->RemoveObserver(endTags[i]);
+    }
+
+  MemoryPrintType peakAllocatedMemory = std::max(m_PeakAllocatedMemory, GetAllocatedMemory());
+
+  // Do not keep the probe buffers until the actual processing
+  this->ReleasePipelineData();
+
+  if(!success)
+    {
+    return 0;
+    }
+
+  return peakAllocatedMemory - startAllocatedMemory;
+}
+
+void
+PipelineMemoryPrintCalculator
+::ReleasePipelineData()
+{
+  for(unsigned int i = 0; i < m_FilterMemoryPrints.size(); ++i)
+    {
+    const ProcessObjectType * filter = m_FilterMemoryPrints[i].m_Filter;
+    for(unsigned int j = 0; j < filter->GetNumberOfOutputs(); ++j)
+      {
+      if(filter->GetOutputs()[j])
+        {
+        filter->GetOutputs()[j]->ReleaseData();
+        }
+      }
+    }
+}
+
+void
+PipelineMemoryPrintCalculator
+::ObserveFilterEvent(itk::Object * object, const itk::EventObject & event)
+{
+  MemoryPrintType allocatedMemory = GetAllocatedMemory();
+  m_PeakAllocatedMemory = std::max(m_PeakAllocatedMemory, allocatedMemory);
+
+  std::map<const ProcessObjectType *, unsigned int>::const_iterator it =
+    m_FilterIndices.find(dynamic_cast<ProcessObjectType *>(object));
+  if(it == m_FilterIndices.end())
+    {
+    return;
+    }
+  unsigned int index = it->second;
+
+  if(typeid(event) == typeid(itk::StartEvent))
+    {
+    // The inputs are already allocated at this point
+    m_FilterStartAllocatedMemory[index] = allocatedMemory;
+    m_FilterMemoryPrints[index].m_MeasuredPrint = 0;
+    m_FilterMemoryPrints[index].m_PeakPrint = allocatedMemory - m_StartAllocatedMemory;
+    }
+  else
+    {
+    m_FilterMemoryPrints[index].m_MeasuredPrint = std::max(m_FilterMemoryPrints[index].m_MeasuredPrint,
+                                                           allocatedMemory - m_FilterStartAllocatedMemory[index]);
+    m_FilterMemoryPrints[index].m_PeakPrint = std::max(m_FilterMemoryPrints[index].m_PeakPrint,
+                                                       allocatedMemory - m_StartAllocatedMemory);
+    }
 }
 
 PipelineMemoryPrintCalculator::MemoryPrintType
@@ -146,11 +361,23 @@ PipelineMemoryPrintCalculator
   ProcessObjectType::DataObjectPointerArray outputs = process->GetOutputs();
 
   // Now, evaluate the current object print
+  MemoryPrintType processPrint = 0;
   for(unsigned int i = 0; i < process->GetNumberOfOutputs(); ++i)
     {
       MemoryPrintType localPrint = this->EvaluateDataObjectPrint(outputs[0]);
-      print += localPrint;
+      processPrint += localPrint;
     }
+  print += processPrint;
+
+  // Register the filter print, upstream filters come first
+  FilterMemoryPrintType filterPrint;
+  filterPrint.m_Filter = process;
+  filterPrint.m_NameOfClass = process->GetNameOfClass();
+  filterPrint.m_EstimatedPrint = processPrint;
+  filterPrint.m_MeasuredPrint = 0;
+  filterPrint.m_PeakPrint = 0;
+  m_FilterIndices[process] = m_FilterMemoryPrints.size();
+  m_FilterMemoryPrints.push_back(filterPrint);
 
   // Finally, return the total print
   return print;
@@ -21,6 +21,9 @@
 #include "itkProcessObject.h"
 #include "itkDataObject.h"
 #include <set>
+#include <map>
+#include <vector>
+#include <string>
 
 namespace otb
 {
@@ -46,6 +49,35 @@ namespace otb
  *  memory usage. The optimal number of stream divisions can be
  *  retrieved using the GetOptimalNumberOfStreamDivisions().
  *
+ *  The memory print of each filter of the pipeline is available
+ *  through GetFilterMemoryPrints(), to find out which stage
+ *  dominates the memory usage.
+ *
+ *  When UseMeasuredMemoryPrint is on, the pipeline is actually
+ *  updated on the requested region of the data to write (which should
+ *  therefore be a small probe region, the bias correction factor being
+ *  used to extrapolate to the full region). The memory allocated by
+ *  the process is sampled at the start, progress and end events of
+ *  each filter, and the peak allocation replaces the static estimate.
+ *  This takes into account the internal allocations of the filters
+ *  (histograms, neighborhoods, models...), which the static estimate
+ *  ignores. By default the allocated memory is retrieved from the
+ *  malloc statistics (or the resident size of the process when they
+ *  are not available); applications using their own tracking
+ *  allocator can plug it in with SetAllocatedMemoryFunction(). If no
+ *  measurement is available, the static estimate is kept. The outputs
+ *  of the filters are released before and after the probe, so that it
+ *  actually runs and does not keep its buffers.
+ *
+ *  The default measurement is process-wide: the allocations made by
+ *  other threads while the probe runs (another pipeline, a viewer...)
+ *  are counted too. It should therefore be run while the rest of the
+ *  process is idle, or with an allocated memory function restricted
+ *  to the pipeline. The measured print also holds the allocations
+ *  which do not depend on the size of the probe region (models,
+ *  lookup tables...): extrapolating it with the bias correction factor
+ *  overestimates them, see StreamingManager for a two probes fit.
+ *
  *  Please note that for now this calculator suffers from the
  *  following limitations:
  *  - DataObject taken into account for memory usage estimation are
@@ -76,6 +108,26 @@ public:
   typedef long long int                       MemoryPrintType;
   typedef std::set<const ProcessObjectType *> ProcessObjectPointerSetType;
 
+  /** Memory print of a single filter of the pipeline. The estimated
+   * print is the print of the filter outputs, the measured print is
+   * the peak allocation while the filter was running, and the peak
+   * print is the peak allocation of the whole pipeline meanwhile (both
+   * in measured mode only). All are weighted by the bias correction
+   * factor. */
+  struct FilterMemoryPrintType
+  {
+    const ProcessObjectType * m_Filter;
+    std::string               m_NameOfClass;
+    MemoryPrintType           m_EstimatedPrint;
+    MemoryPrintType           m_MeasuredPrint;
+    MemoryPrintType           m_PeakPrint;
+  };
+  typedef std::vector<FilterMemoryPrintType>  FilterMemoryPrintListType;
+
+  /** Function returning the number of bytes currently allocated by
+   * the process, or 0 if it is unknown */
+  typedef MemoryPrintType (*AllocatedMemoryFunctionType)();
+
   /** Run-time type information (and related methods). */
   itkTypeMacro(PipelineMemoryPrintCalculator, itk::Object);
 
@@ -98,6 +150,31 @@ public:
   /** Set last pipeline filter */
   itkSetObjectMacro(DataToWrite, DataObjectType);
 
+  /** Set/Get the measured mode, where the pipeline is updated on the
+   * requested region to measure its actual memory print (default is
+   * false, i.e. static estimation only) */
+  itkSetMacro(UseMeasuredMemoryPrint, bool);
+  itkGetMacro(UseMeasuredMemoryPrint, bool);
+  itkBooleanMacro(UseMeasuredMemoryPrint);
+
+  /** Get whether the last Compute() used the measured print (false if
+   * the measurement was not requested or not available) */
+  itkGetMacro(MemoryPrintMeasured, bool);
+
+  /** Get the memory print of each filter, in execution order */
+  const FilterMemoryPrintListType& GetFilterMemoryPrints() const
+  {
+    return m_FilterMemoryPrints;
+  }
+
+  /** Set the function used to retrieve the allocated memory in
+   * measured mode. NULL restores the default one */
+  static void SetAllocatedMemoryFunction(AllocatedMemoryFunctionType function);
+
+  /** Return the number of bytes currently allocated by the process,
+   * or 0 if it is unknown */
+  static MemoryPrintType GetAllocatedMemory();
+
   /** Compute pipeline memory print */
   void Compute();
 
@@ -121,6 +198,16 @@ protected:
   /** Recursive method to evaluate memory print in bytes */
   MemoryPrintType EvaluateProcessObjectPrintRecursive(ProcessObjectType * process);
 
+  /** Update the pipeline and return the peak allocation, or 0 if the
+   * allocated memory can not be measured */
+  MemoryPrintType MeasurePipelinePrint();
+
+  /** Release the outputs of the filters of the pipeline */
+  void ReleasePipelineData();
+
+  /** Sample the allocated memory on the filters events */
+  void ObserveFilterEvent(itk::Object * object, const itk::EventObject & event);
+
 private:
   PipelineMemoryPrintCalculator(const Self &); //purposely not implemented
   void operator =(const Self&);                //purposely not implemented
@@ -137,6 +224,30 @@ private:
   /** Visited ProcessObject set */
   ProcessObjectPointerSetType m_VisitedProcessObjects;
 
+  /** Measured mode */
+  bool m_UseMeasuredMemoryPrint;
+
+  /** Whether the last memory print was measured */
+  bool m_MemoryPrintMeasured;
+
+  /** Memory print of each filter */
+  FilterMemoryPrintListType m_FilterMemoryPrints;
+
+  /** Index of each filter in m_FilterMemoryPrints */
+  std::map<const ProcessObjectType *, unsigned int> m_FilterIndices;
+
+  /** Allocated memory when each filter started */
+  std::vector<MemoryPrintType> m_FilterStartAllocatedMemory;
+
+  /** Allocated memory when the measurement started */
+  MemoryPrintType m_StartAllocatedMemory;
+
+  /** Peak allocated memory during the measurement */
+  MemoryPrintType m_PeakAllocatedMemory;
+
+  /** Function used to retrieve the allocated memory */
+  static AllocatedMemoryFunctionType m_AllocatedMemoryFunction;
+
 };
 } // end of namespace otb
 
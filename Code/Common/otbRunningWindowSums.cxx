@@ -0,0 +1,93 @@
+/*=========================================================================
+
+  Program:   ORFEO Toolbox
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+
+  Copyright (c) Centre National d'Etudes Spatiales. All rights reserved.
+  See OTBCopyright.txt for details.
+
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#include "otbRunningWindowSums.h"
+
+#include <algorithm>
+
+namespace otb
+{
+
+RunningWindowSums
+::RunningWindowSums(unsigned int nbSums, long width, long radiusX, long radiusY)
+  : m_NumberOfSums(nbSums), m_Width(width), m_WindowWidth(2 * radiusX + 1), m_WindowHeight(2 * radiusY + 1),
+    m_NumberOfPushedRows(0),
+    m_Row(nbSums * (width + 2 * radiusX)),
+    m_RowSums(nbSums * width * m_WindowHeight, 0.),
+    m_WindowSums(nbSums * width, 0.),
+    m_Current(nbSums)
+{
+}
+
+bool
+RunningWindowSums
+::PushRow()
+{
+  const long nbValues = m_NumberOfSums * m_Width;
+  const long paddedWidth = m_Width + m_WindowWidth - 1;
+
+  // The row leaving the window shares its slot with the new one
+  double * slot = &m_RowSums[nbValues * (m_NumberOfPushedRows % m_WindowHeight)];
+  if (m_NumberOfPushedRows >= m_WindowHeight)
+    {
+    for (long i = 0; i < nbValues; ++i)
+      {
+      m_WindowSums[i] -= slot[i];
+      }
+    }
+
+  // Horizontal running sums
+  std::fill(m_Current.begin(), m_Current.end(), 0.);
+  for (long column = 0; column < paddedWidth; ++column)
+    {
+    const double * pixel = &m_Row[m_NumberOfSums * column];
+    for (unsigned int s = 0; s < m_NumberOfSums; ++s)
+      {
+      m_Current[s] += pixel[s];
+      }
+
+    if (column >= m_WindowWidth)
+      {
+      const double * oldPixel = &m_Row[m_NumberOfSums * (column - m_WindowWidth)];
+      for (unsigned int s = 0; s < m_NumberOfSums; ++s)
+        {
+        m_Current[s] -= oldPixel[s];
+        }
+      }
+
+    if (column >= m_WindowWidth - 1)
+      {
+      double * sumsForColumn = slot + m_NumberOfSums * (column - m_WindowWidth + 1);
+      for (unsigned int s = 0; s < m_NumberOfSums; ++s)
+        {
+        sumsForColumn[s] = m_Current[s];
+        }
+      }
+    }
+
+  for (long i = 0; i < nbValues; ++i)
+    {
+    m_WindowSums[i] += slot[i];
+    }
+
+  ++m_NumberOfPushedRows;
+
+  // Once the window is full, the output row is available
+  return m_NumberOfPushedRows >= m_WindowHeight;
+}
+
+} // end namespace otb
@@ -0,0 +1,101 @@
+/*=========================================================================
+
+  Program:   ORFEO Toolbox
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+
+  Copyright (c) Centre National d'Etudes Spatiales. All rights reserved.
+  See OTBCopyright.txt for details.
+
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __otbRunningWindowSums_h
+#define __otbRunningWindowSums_h
+
+#include <vector>
+
+namespace otb
+{
+
+/** \class RunningWindowSums
+ *  \brief Sums of several quantities over a sliding rectangular window.
+ *
+ *  The window of (2*radiusX+1) x (2*radiusY+1) pixels slides over the
+ *  rows of a region of the given width. The caller fills the row buffer
+ *  (GetRowBuffer()) with the NumberOfSums quantities of each pixel of the
+ *  next row, padded by radiusX pixels on each side, and pushes it with
+ *  PushRow(). Once 2*radiusY+1 rows have been pushed, each push makes the
+ *  window sums of one output row available through GetWindowSums().
+ *
+ *  The horizontal sums of each row are computed with a running sum and
+ *  kept in a ring buffer of 2*radiusY+1 rows, the vertical sums are
+ *  updated by adding the new row and removing the oldest one: the cost
+ *  per pixel does not depend on the radius.
+ *
+ *  This is used by the filters that compute local statistics over
+ *  neighborhoods of each thread region.
+ *
+ *  \sa BinaryFunctorNeighborhoodSumsImageFilter
+ *  \sa SinclairToReciprocalHAlphaImageFilter
+ */
+class RunningWindowSums
+{
+public:
+  /** Constructor */
+  RunningWindowSums(unsigned int nbSums, long width, long radiusX, long radiusY);
+
+  /** Destructor */
+  virtual ~RunningWindowSums() {}
+
+  /** Buffer of the next row, of NumberOfSums values for each of the
+   *  width + 2 * radiusX pixels, pixel after pixel */
+  double * GetRowBuffer()
+  {
+    return &m_Row[0];
+  }
+
+  /** Add the row buffer to the window. Returns true when the window
+   *  sums of an output row are available. */
+  bool PushRow();
+
+  /** Window sums of the given column of the current output row */
+  const double * GetWindowSums(long column) const
+  {
+    return &m_WindowSums[m_NumberOfSums * column];
+  }
+
+  /** Number of pixels of the window */
+  double GetWindowCount() const
+  {
+    return static_cast<double>(m_WindowWidth * m_WindowHeight);
+  }
+
+private:
+  unsigned int m_NumberOfSums;
+  long         m_Width;
+  long         m_WindowWidth;
+  long         m_WindowHeight;
+  long         m_NumberOfPushedRows;
+
+  /** Values of the current padded row */
+  std::vector<double> m_Row;
+
+  /** Horizontal window sums of the last windowHeight rows */
+  std::vector<double> m_RowSums;
+
+  /** Window sums of the current output row */
+  std::vector<double> m_WindowSums;
+
+  /** Running horizontal sums */
+  std::vector<double> m_Current;
+};
+
+} // end namespace otb
+
+#endif
@@ -85,6 +85,48 @@ public:
    * GetNumberOfSplits() returns. */
   virtual RegionType GetSplit(unsigned int i);
 
+  /** Returns the dimension of the square tiles generated by the splitter,
+   * or 0 if the divisions are not square tiles.
+   * PrepareStreaming() must have been called before. */
+  virtual unsigned int GetTileDimension();
+
+  /** Set/Get the number of additional copies of the output buffer kept
+   * alive by the caller (for instance the write-behind buffers of
+   * StreamingImageFileWriter). They are added to the estimated pipeline
+   * memory print when the number of divisions is computed from the
+   * available RAM. Default is 0. */
+  itkSetMacro(NumberOfExtraOutputBuffers, unsigned int);
+  itkGetMacro(NumberOfExtraOutputBuffers, unsigned int);
+
+  /** Set/Get the number of divisions the caller computes at the same
+   * time (for instance the concurrent pipelines of
+   * StreamingImageFileWriter). When the number of divisions is computed
+   * from the available RAM, each division is given this fraction of the
+   * RAM, and at least this number of divisions is generated so that
+   * every pipeline has some work. Default is 1. */
+  itkSetMacro(NumberOfConcurrentDivisions, unsigned int);
+  itkGetMacro(NumberOfConcurrentDivisions, unsigned int);
+
+  /** Set/Get the measured memory print mode. When on, the memory
+   * print used to compute the number of divisions from the available
+   * RAM is measured by running the pipeline on a small probe region
+   * instead of being estimated from the buffer sizes only
+   * (see PipelineMemoryPrintCalculator). The pipeline is run on two
+   * probe regions, 100 and 50 pixels wide, and a linear fit of the
+   * two prints separates the allocations which do not depend on the
+   * region size from the ones proportional to it: only the latter are
+   * divided between the stream divisions. Default is false. */
+  itkSetMacro(UseMeasuredMemoryPrint, bool);
+  itkGetMacro(UseMeasuredMemoryPrint, bool);
+  itkBooleanMacro(UseMeasuredMemoryPrint);
+
+  /** Get the memory print of each filter of the pipeline, computed
+   * by the last memory estimation, for the full region to stream */
+  const PipelineMemoryPrintCalculator::FilterMemoryPrintListType& GetFilterMemoryPrints() const
+  {
+    return m_FilterMemoryPrints;
+  }
+
 protected:
   StreamingManager();
   virtual ~StreamingManager();
@@ -93,9 +135,38 @@ protected:
                                                         MemoryPrintType availableRAMInMB,
                                                         double bias = 1.0);
 
+  /** Compute a probe region of the given width around the center of
+   * the region, cropped by the region. Return false if the crop fails */
+  static bool ComputeProbeRegion(const RegionType& region, unsigned long width, RegionType& probeRegion);
+
+  /** Compute the memory print of the pipeline on a probe region of
+   * the input image, without the print of the extract filter used to
+   * select the probe, and the print of each filter of the pipeline */
+  MemoryPrintType ComputeProbeMemoryPrint(ImageType * inputImage, const RegionType& probeRegion,
+                                          PipelineMemoryPrintCalculator::FilterMemoryPrintListType& filterPrints);
+
+  /** Extrapolate to fullPixels pixels the prints measured on two probes
+   * of pixels and smallerPixels pixels, with a linear fit. The fixed
+   * part of the print is returned in fixedPrint */
+  static MemoryPrintType ExtrapolateMemoryPrint(MemoryPrintType print, MemoryPrintType smallerPrint,
+                                                double pixels, double smallerPixels, double fullPixels,
+                                                MemoryPrintType& fixedPrint);
+
   /** The number of splits generated by the splitter */
   unsigned int m_ComputedNumberOfSplits;
 
+  /** Number of extra output buffers to account for in memory estimation */
+  unsigned int m_NumberOfExtraOutputBuffers;
+
+  /** Number of divisions computed at the same time */
+  unsigned int m_NumberOfConcurrentDivisions;
+
+  /** Measure the memory print on a probe region */
+  bool m_UseMeasuredMemoryPrint;
+
+  /** Memory print of each filter from the last estimation */
+  PipelineMemoryPrintCalculator::FilterMemoryPrintListType m_FilterMemoryPrints;
+
   /** The region to stream */
   RegionType m_Region;
 
@@ -23,13 +23,19 @@
 #include "otbConfigure.h"
 #include "otbConfigurationFile.h"
 #include "itkExtractImageFilter.h"
+#include "otbImageRegionSquareTileSplitter.h"
+
+#include <algorithm>
 
 namespace otb
 {
 
 template <class TImage>
 StreamingManager<TImage>::StreamingManager()
-  : m_ComputedNumberOfSplits(0)
+  : m_ComputedNumberOfSplits(0),
+    m_NumberOfExtraOutputBuffers(0),
+    m_NumberOfConcurrentDivisions(1),
+    m_UseMeasuredMemoryPrint(false)
 {
 }
 
@@ -80,6 +86,14 @@ StreamingManager<TImage>::EstimateOptimalNumberOfDivisions(itk::DataObject * inp
 
   MemoryPrintType availableRAMInBytes = GetActualAvailableRAMInBytes(availableRAM);
 
+  // Concurrent divisions share the available RAM
+  if (m_NumberOfConcurrentDivisions > 1)
+    {
+    availableRAMInBytes /= m_NumberOfConcurrentDivisions;
+    otbMsgDevMacro("RAM available for each of the " << m_NumberOfConcurrentDivisions
+                   << " concurrent divisions : " << availableRAMInBytes / 1024 / 1024 << " MB")
+    }
+
   otb::PipelineMemoryPrintCalculator::Pointer memoryPrintCalculator;
   memoryPrintCalculator = otb::PipelineMemoryPrintCalculator::New();
 
@@ -89,63 +103,111 @@ StreamingManager<TImage>::EstimateOptimalNumberOfDivisions(itk::DataObject * inp
   ImageType* inputImage = dynamic_cast<ImageType*>(input);
 
   MemoryPrintType pipelineMemoryPrint;
-  if (inputImage)
-    {
 
-    typedef itk::ExtractImageFilter<ImageType, ImageType> ExtractFilterType;
-    typename ExtractFilterType::Pointer extractFilter = ExtractFilterType::New();
-    extractFilter->SetInput(inputImage);
+  // Part of the memory print which does not depend on the size of the
+  // divisions
+  MemoryPrintType fixedMemoryPrint = 0;
 
+  if (inputImage)
+    {
     // Define a small region to run the memory footprint estimation,
     // around the image center, 100 pixels wide in each dimension
-    SizeType smallSize;
-    smallSize.Fill(100);
-    IndexType index;
-    index[0] = region.GetIndex()[0] + region.GetSize()[0]/2 - 50;
-    index[1] = region.GetIndex()[1] + region.GetSize()[1]/2 - 50;
-
     RegionType smallRegion;
-    smallRegion.SetSize(smallSize);
-    smallRegion.SetIndex(index);
-
-    // In case the image is smaller than 100 pixels in a direction
-    smallRegion.Crop(region);
-
-    extractFilter->SetExtractionRegion(smallRegion);
-
-    bool smallRegionSuccess = smallRegion.Crop(region);
+    bool       smallRegionSuccess = Self::ComputeProbeRegion(region, 100, smallRegion);
 
-    if (smallRegionSuccess)
+    RegionType smallerRegion;
+    if (smallRegionSuccess && m_UseMeasuredMemoryPrint
+        && Self::ComputeProbeRegion(region, 50, smallerRegion)
+        && smallerRegion.GetNumberOfPixels() < smallRegion.GetNumberOfPixels())
       {
-      otbMsgDevMacro("Using an extract to estimate memory : " << smallRegion)
-      // the region is well behaved, inside the largest possible region
-      memoryPrintCalculator->SetDataToWrite(extractFilter->GetOutput() );
-
-      regionTrickFactor = static_cast<double>( region.GetNumberOfPixels() )
-        / static_cast<double>(smallRegion.GetNumberOfPixels() );
-
-      memoryPrintCalculator->SetBiasCorrectionFactor(regionTrickFactor * bias);
+      otbMsgDevMacro("Measuring memory on the extracts : " << smallRegion << " and " << smallerRegion)
+      PipelineMemoryPrintCalculator::FilterMemoryPrintListType filterPrints, smallerFilterPrints;
+      MemoryPrintType print = this->ComputeProbeMemoryPrint(inputImage, smallRegion, filterPrints);
+      MemoryPrintType smallerPrint = this->ComputeProbeMemoryPrint(inputImage, smallerRegion, smallerFilterPrints);
+
+      // Linear fit of the two prints against the number of pixels: the
+      // intercept is the fixed part, the slope is extrapolated to the
+      // full region
+      const double pixels = region.GetNumberOfPixels();
+      const double smallPixels = smallRegion.GetNumberOfPixels();
+      const double smallerPixels = smallerRegion.GetNumberOfPixels();
+
+      pipelineMemoryPrint = Self::ExtrapolateMemoryPrint(print, smallerPrint, smallPixels, smallerPixels,
+                                                         pixels, fixedMemoryPrint);
+      pipelineMemoryPrint = static_cast<MemoryPrintType>(pipelineMemoryPrint * bias);
+      fixedMemoryPrint = static_cast<MemoryPrintType>(fixedMemoryPrint * bias);
+
+      // Same fit for each filter of the pipeline
+      if (filterPrints.size() == smallerFilterPrints.size())
+        {
+        for (unsigned int i = 0; i < filterPrints.size(); ++i)
+          {
+          MemoryPrintType filterFixedPrint;
+          filterPrints[i].m_EstimatedPrint = static_cast<MemoryPrintType>(bias * Self::ExtrapolateMemoryPrint(
+            filterPrints[i].m_EstimatedPrint, smallerFilterPrints[i].m_EstimatedPrint,
+            smallPixels, smallerPixels, pixels, filterFixedPrint));
+          filterPrints[i].m_MeasuredPrint = static_cast<MemoryPrintType>(bias * Self::ExtrapolateMemoryPrint(
+            filterPrints[i].m_MeasuredPrint, smallerFilterPrints[i].m_MeasuredPrint,
+            smallPixels, smallerPixels, pixels, filterFixedPrint));
+          filterPrints[i].m_PeakPrint = static_cast<MemoryPrintType>(bias * Self::ExtrapolateMemoryPrint(
+            filterPrints[i].m_PeakPrint, smallerFilterPrints[i].m_PeakPrint,
+            smallPixels, smallerPixels, pixels, filterFixedPrint));
+          }
+        }
+      m_FilterMemoryPrints = filterPrints;
       }
     else
       {
-      otbMsgDevMacro("Using the input region to estimate memory : " << region)
-      // the region is not well behaved
-      // use the full region
-      memoryPrintCalculator->SetDataToWrite(input);
-      memoryPrintCalculator->SetBiasCorrectionFactor(bias);
+      typedef itk::ExtractImageFilter<ImageType, ImageType> ExtractFilterType;
+      typename ExtractFilterType::Pointer extractFilter = ExtractFilterType::New();
+      extractFilter->SetInput(inputImage);
+
+      if (smallRegionSuccess)
+        {
+        otbMsgDevMacro("Using an extract to estimate memory : " << smallRegion)
+        // the region is well behaved, inside the largest possible region
+        extractFilter->SetExtractionRegion(smallRegion);
+        memoryPrintCalculator->SetDataToWrite(extractFilter->GetOutput() );
+
+        regionTrickFactor = static_cast<double>( region.GetNumberOfPixels() )
+          / static_cast<double>(smallRegion.GetNumberOfPixels() );
+
+        memoryPrintCalculator->SetBiasCorrectionFactor(regionTrickFactor * bias);
+
+        // The probe is run on the small region only
+        memoryPrintCalculator->SetUseMeasuredMemoryPrint(m_UseMeasuredMemoryPrint);
+        }
+      else
+        {
+        otbMsgDevMacro("Using the input region to estimate memory : " << region)
+        // the region is not well behaved
+        // use the full region
+        memoryPrintCalculator->SetDataToWrite(input);
+        memoryPrintCalculator->SetBiasCorrectionFactor(bias);
+        }
+
+      memoryPrintCalculator->Compute();
+
+      pipelineMemoryPrint = memoryPrintCalculator->GetMemoryPrint();
+      m_FilterMemoryPrints = memoryPrintCalculator->GetFilterMemoryPrints();
+
+      if (smallRegionSuccess)
+        {
+        // remove the contribution of the ExtractImageFilter
+        MemoryPrintType extractContrib =
+            memoryPrintCalculator->EvaluateDataObjectPrint(extractFilter->GetOutput());
+
+        pipelineMemoryPrint -= extractContrib;
+        }
       }
 
-    memoryPrintCalculator->Compute();
-
-    pipelineMemoryPrint = memoryPrintCalculator->GetMemoryPrint();
-
-    if (smallRegionSuccess)
+    // Each extra output buffer holds a copy of the output of a division
+    if (m_NumberOfExtraOutputBuffers > 0)
       {
-      // remove the contribution of the ExtractImageFilter
-      MemoryPrintType extractContrib =
-          memoryPrintCalculator->EvaluateDataObjectPrint(extractFilter->GetOutput());
-
-      pipelineMemoryPrint -= extractContrib;
+      MemoryPrintType outputPrint = static_cast<MemoryPrintType>(region.GetNumberOfPixels())
+        * inputImage->GetNumberOfComponentsPerPixel() * sizeof(PixelType);
+      otbMsgDevMacro("Adding the contribution of " << m_NumberOfExtraOutputBuffers << " extra output buffers")
+      pipelineMemoryPrint += m_NumberOfExtraOutputBuffers * outputPrint;
       }
     }
   else
@@ -157,19 +219,127 @@ StreamingManager<TImage>::EstimateOptimalNumberOfDivisions(itk::DataObject * inp
     memoryPrintCalculator->Compute();
 
     pipelineMemoryPrint = memoryPrintCalculator->GetMemoryPrint();
+    m_FilterMemoryPrints = memoryPrintCalculator->GetFilterMemoryPrints();
+    }
+
+  // The fixed part of the print is allocated by each division, only
+  // the rest is divided
+  MemoryPrintType dividedMemoryPrint = pipelineMemoryPrint;
+  MemoryPrintType availableDividedRAMInBytes = availableRAMInBytes;
+  if (fixedMemoryPrint > 0)
+    {
+    if (fixedMemoryPrint < availableRAMInBytes)
+      {
+      dividedMemoryPrint -= fixedMemoryPrint;
+      availableDividedRAMInBytes -= fixedMemoryPrint;
+      }
+    else
+      {
+      otbWarningMacro(<< "The fixed memory print of the pipeline (" << fixedMemoryPrint
+                      << " bytes) exceeds the available RAM (" << availableRAMInBytes << " bytes)");
+      }
     }
 
   unsigned int optimalNumberOfDivisions =
-      otb::PipelineMemoryPrintCalculator::EstimateOptimalNumberOfStreamDivisions(pipelineMemoryPrint, availableRAMInBytes);
+      otb::PipelineMemoryPrintCalculator::EstimateOptimalNumberOfStreamDivisions(dividedMemoryPrint,
+                                                                                 availableDividedRAMInBytes);
+
+  // Give some work to each concurrent pipeline
+  if (optimalNumberOfDivisions < m_NumberOfConcurrentDivisions)
+    {
+    optimalNumberOfDivisions = m_NumberOfConcurrentDivisions;
+    }
 
   otbMsgDevMacro( "Estimated Memory print for the full image : "
                   << static_cast<unsigned int>(pipelineMemoryPrint * otb::PipelineMemoryPrintCalculator::ByteToMegabyte ) << std::endl)
+  otbMsgDevMacro( "Fixed memory print : "
+                  << static_cast<unsigned int>(fixedMemoryPrint * otb::PipelineMemoryPrintCalculator::ByteToMegabyte ) << std::endl)
   otbMsgDevMacro( "Optimal number of stream divisions: "
                   << optimalNumberOfDivisions << std::endl)
 
   return optimalNumberOfDivisions;
 }
 
+template <class TImage>
+bool
+StreamingManager<TImage>::ComputeProbeRegion(const RegionType& region, unsigned long width, RegionType& probeRegion)
+{
+  SizeType probeSize;
+  probeSize.Fill(width);
+  IndexType index;
+  index[0] = region.GetIndex()[0] + region.GetSize()[0]/2 - width/2;
+  index[1] = region.GetIndex()[1] + region.GetSize()[1]/2 - width/2;
+
+  probeRegion.SetSize(probeSize);
+  probeRegion.SetIndex(index);
+
+  // In case the image is smaller than the probe in a direction
+  return probeRegion.Crop(region);
+}
+
+template <class TImage>
+typename StreamingManager<TImage>::MemoryPrintType
+StreamingManager<TImage>::ComputeProbeMemoryPrint(ImageType * inputImage, const RegionType& probeRegion,
+                                                  PipelineMemoryPrintCalculator::FilterMemoryPrintListType& filterPrints)
+{
+  typedef itk::ExtractImageFilter<ImageType, ImageType> ExtractFilterType;
+  typename ExtractFilterType::Pointer extractFilter = ExtractFilterType::New();
+  extractFilter->SetInput(inputImage);
+  extractFilter->SetExtractionRegion(probeRegion);
+
+  otb::PipelineMemoryPrintCalculator::Pointer memoryPrintCalculator = otb::PipelineMemoryPrintCalculator::New();
+  memoryPrintCalculator->SetDataToWrite(extractFilter->GetOutput());
+  memoryPrintCalculator->SetUseMeasuredMemoryPrint(m_UseMeasuredMemoryPrint);
+  memoryPrintCalculator->Compute();
+
+  MemoryPrintType print = memoryPrintCalculator->GetMemoryPrint();
+  const bool      measured = memoryPrintCalculator->GetMemoryPrintMeasured();
+
+  // Remove the contribution of the ExtractImageFilter. When measured,
+  // its output only counts if the peak of the pipeline occurred while
+  // it was running: the print is then the peak of the other filters,
+  // or the peak during the extract without its own allocation
+  const PipelineMemoryPrintCalculator::FilterMemoryPrintListType& calculatorFilterPrints =
+    memoryPrintCalculator->GetFilterMemoryPrints();
+  MemoryPrintType measuredPrint = 0;
+  filterPrints.clear();
+  for (unsigned int i = 0; i < calculatorFilterPrints.size(); ++i)
+    {
+    if (calculatorFilterPrints[i].m_Filter == extractFilter.GetPointer())
+      {
+      print -= calculatorFilterPrints[i].m_EstimatedPrint;
+      measuredPrint = std::max(measuredPrint,
+                               calculatorFilterPrints[i].m_PeakPrint - calculatorFilterPrints[i].m_MeasuredPrint);
+      }
+    else
+      {
+      measuredPrint = std::max(measuredPrint, calculatorFilterPrints[i].m_PeakPrint);
+      filterPrints.push_back(calculatorFilterPrints[i]);
+      }
+    }
+
+  if (measured)
+    {
+    print = measuredPrint;
+    }
+
+  return std::max(print, static_cast<MemoryPrintType>(0));
+}
+
+template <class TImage>
+typename StreamingManager<TImage>::MemoryPrintType
+StreamingManager<TImage>::ExtrapolateMemoryPrint(MemoryPrintType print, MemoryPrintType smallerPrint,
+                                                 double pixels, double smallerPixels, double fullPixels,
+                                                 MemoryPrintType& fixedPrint)
+{
+  // Neither part can be negative, whatever the measurement noise
+  double printPerPixel = static_cast<double>(print - smallerPrint) / (pixels - smallerPixels);
+  printPerPixel = std::max(printPerPixel, 0.0);
+  fixedPrint = static_cast<MemoryPrintType>(std::max(print - printPerPixel * pixels, 0.0));
+
+  return fixedPrint + static_cast<MemoryPrintType>(printPerPixel * fullPixels);
+}
+
 template <class TImage>
 unsigned int
 StreamingManager<TImage>::GetNumberOfSplits()
@@ -184,6 +354,16 @@ StreamingManager<TImage>::GetSplit(unsigned int i)
   return m_Splitter->GetSplit(i, m_ComputedNumberOfSplits, m_Region);
 }
 
+template <class TImage>
+unsigned int
+StreamingManager<TImage>::GetTileDimension()
+{
+  typedef ImageRegionSquareTileSplitter<itkGetStaticConstMacro(ImageDimension)> TileSplitterType;
+
+  TileSplitterType* tileSplitter = dynamic_cast<TileSplitterType*>(m_Splitter.GetPointer());
+  return tileSplitter != NULL ? tileSplitter->GetTileDimension() : 0;
+}
+
 } // End namespace otb
 
 #endif
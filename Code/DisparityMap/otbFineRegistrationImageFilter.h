@@ -25,6 +25,8 @@
 #include "itkTranslationTransform.h"
 #include "itkImageToImageMetric.txx"
 
+#include <vector>
+
 namespace otb
 {
 
@@ -60,6 +62,19 @@ namespace otb
  *
  * The FineRegistrationImageFilter allows to use the full range of itk::ImageToImageMetric provided by itk.
  *
+ * When the UseDenseCorrelationOn() flag is set and the configuration allows it (normalized correlation
+ * metric without masks, no transform, linear or nearest neighbor interpolator, fixed and moving images
+ * with the same spacing, identity direction and an initial offset falling on the moving pixel grid), the
+ * filter switches to a dense correlation engine: for each displacement of the search window, the
+ * correlation of every output location is read from running sums of the fixed and moving values,
+ * so that the cost no longer depends on the radius. These sums are only kept for the 2*radius+1 rows
+ * of the current metric windows. Apart from ties between equally good displacements, the pixel-wise
+ * optimum is the same as the one of the generic path. The sub-pixel offset is then given by the optimum
+ * of a quadratic fitted to the correlation of the 3x3 displacements around it, and the output value
+ * is the one of the quadratic. This fit needs a radius large enough for the correlation surface to be
+ * smooth. If the UseMetricRefinementOn() flag is set, the dichotomic search is performed with the
+ * metric instead, as in the generic path.
+ *
  * \example DisparityMap/FineRegistrationImageFilterExample.cxx
  *
  * \sa      FastCorrelationImageFilter, DisparityMapEstimationMethod
@@ -98,6 +113,7 @@ public:
   typedef typename MetricType::Pointer                            MetricPointerType;
   typedef itk::TranslationTransform<double, 2>                     TranslationType;
   typedef typename TranslationType::Pointer                       TranslationPointerType;
+  typedef typename TranslationType::ParametersType                ParametersType;
   typedef typename itk::Transform<double, 2, 2>                     TransformType;
   typedef typename TransformType::Pointer                         TransformPointerType;
 
@@ -172,6 +188,17 @@ public:
   itkSetObjectMacro(Transform, TransformType);
   itkGetConstObjectMacro(Transform, TransformType);
 
+  /** True if the dense correlation engine should be used when possible (default is Off) */
+  itkSetMacro(UseDenseCorrelation, bool);
+  itkGetMacro(UseDenseCorrelation, bool);
+  itkBooleanMacro(UseDenseCorrelation);
+
+  /** True if the dense correlation engine should refine the optimum with the dichotomic search
+   *  on the metric instead of the quadratic fit (default is Off) */
+  itkSetMacro(UseMetricRefinement, bool);
+  itkGetMacro(UseMetricRefinement, bool);
+  itkBooleanMacro(UseMetricRefinement);
+
 protected:
   /** Constructor */
   FineRegistrationImageFilter();
@@ -187,10 +214,39 @@ protected:
   /** Generate output information */
   virtual void GenerateOutputInformation(void);
 
+  /** Check if the dense correlation engine can be used. If so, movingShift
+   *  receives the offset from a fixed index to the matching moving index. */
+  bool CanUseDenseCorrelation(OffsetType& movingShift);
+
+  /** Generate data using the dense correlation engine */
+  void GenerateDenseCorrelationData(const OffsetType& movingShift);
+
+  /** Refine the optimum by dichotomic search until sub-pixel accuracy is reached */
+  void RefineOptimum(ParametersType& optParams, double& optMetric, const SpacingType& fixedSpacing);
+
 private:
   FineRegistrationImageFilter(const Self&); //purposely not implemented
   void operator=(const Self&); //purposely not implemented
 
+  /** Normalized correlation from the window sums, as computed by
+   *  itk::NormalizedCorrelationImageToImageMetric */
+  static double CorrelationFromSums(double n, double sf, double sff, double sm, double smm, double sfm,
+                                    bool subtractMean);
+
+  /** Normalized correlation over the fixed window, the moving index being the fixed
+   *  index plus movingOffset. Moving pixels outside the buffered region are skipped,
+   *  as in the dense correlation engine. */
+  double DenseCorrelation(const InputImageRegionType& window, const OffsetType& movingOffset,
+                          double fixedMean, double movingMean, bool subtractMean);
+
+  /** Optimum of the quadratic fitted to the 3x3 values around the pixel-wise optimum.
+   *  Returns false if the quadratic has no such optimum in the neighborhood. */
+  static bool FitQuadraticOptimum(const double values[3][3], bool minimize,
+                                  double& dx, double& dy, double& value);
+
+  /** Mean of the image values over the region */
+  static double MeanValue(const TInputImage * image, const InputImageRegionType& region);
+
   /** The radius for correlation */
   SizeType                      m_Radius;
 
@@ -224,6 +280,12 @@ private:
   /** Transform for initial offset */
   TransformPointerType          m_Transform;
 
+  /** Use the dense correlation engine when possible */
+  bool                          m_UseDenseCorrelation;
+
+  /** Refine the dense correlation optimum with the metric */
+  bool                          m_UseMetricRefinement;
+
 };
 
 } // end namespace otb
@@ -22,9 +22,13 @@
 
 #include "itkProgressReporter.h"
 #include "itkLinearInterpolateImageFunction.h"
+#include "itkNearestNeighborInterpolateImageFunction.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
 #include "itkImageRegionIteratorWithIndex.h"
 #include "itkNormalizedCorrelationImageToImageMetric.h"
 #include "itkExceptionObject.h"
+#include "otbMacro.h"
 
 namespace otb
 {
@@ -67,6 +71,10 @@ FineRegistrationImageFilter<TInputImage, T0utputCorrelation, TOutputDeformationF
   m_InitialOffset.Fill(0);
 
   m_Transform = NULL;
+
+  // Generic path by default
+  m_UseDenseCorrelation = false;
+  m_UseMetricRefinement = false;
  }
 
 template <class TInputImage, class T0utputCorrelation, class TOutputDeformationField>
@@ -305,6 +313,18 @@ FineRegistrationImageFilter<TInputImage, TOutputCorrelation, TOutputDeformationF
   m_Metric->SetMovingImage(movingPtr);
   m_Metric->SetComputeGradient(false);
 
+  // Use the dense correlation engine if possible
+  OffsetType movingShift;
+  if (m_UseDenseCorrelation)
+    {
+    if (this->CanUseDenseCorrelation(movingShift))
+      {
+      this->GenerateDenseCorrelationData(movingShift);
+      return;
+      }
+    otbMsgDevMacro(<< "Dense correlation can not be used with this configuration, falling back to the generic path.");
+    }
+
   /** Output iterators */
   itk::ImageRegionIteratorWithIndex<TOutputCorrelation> outputIt(outputPtr, outputPtr->GetRequestedRegion());
   itk::ImageRegionIterator<TOutputDeformationField> outputDfIt(outputDfPtr, outputPtr->GetRequestedRegion());
@@ -322,7 +342,7 @@ FineRegistrationImageFilter<TInputImage, TOutputCorrelation, TOutputDeformationF
   double currentMetric, optMetric;
 
   // Optimal translation parameters
-  typename TranslationType::ParametersType params(2), optParams(2), tmpOptParams(2);
+  ParametersType params(2), optParams(2);
 
   // Final deformation value
   DeformationValueType deformationValue;
@@ -410,46 +430,410 @@ FineRegistrationImageFilter<TInputImage, TOutputCorrelation, TOutputDeformationF
       }
 
     // Dichotomic sub-pixel
-    SpacingType subPixelSpacing = fixedSpacing;
-    while(subPixelSpacing[0] > m_SubPixelAccuracy || subPixelSpacing[1] > m_SubPixelAccuracy)
+    this->RefineOptimum(optParams, optMetric, fixedSpacing);
+
+    // Store the offset and the correlation value
+    outputIt.Set(optMetric);
+    if(m_UseSpacing)
+      {
+      deformationValue[0] = optParams[0];
+      deformationValue[1] = optParams[1];
+      }
+    else
+      {
+      deformationValue[0] = optParams[0]/fixedSpacing[0];
+      deformationValue[1] = optParams[1]/fixedSpacing[1];
+      }
+    outputDfIt.Set(deformationValue);
+    // Update iterators
+    ++outputIt;
+    ++outputDfIt;
+
+    // Update progress
+    progress.CompletedPixel();
+    }
+ }
+
+template <class TInputImage, class TOutputCorrelation, class TOutputDeformationField>
+void
+FineRegistrationImageFilter<TInputImage, TOutputCorrelation, TOutputDeformationField>
+::RefineOptimum(ParametersType& optParams, double& optMetric, const SpacingType& fixedSpacing)
+ {
+  ParametersType params(2), tmpOptParams(2);
+  double currentMetric;
+
+  SpacingType subPixelSpacing = fixedSpacing;
+  while(subPixelSpacing[0] > m_SubPixelAccuracy || subPixelSpacing[1] > m_SubPixelAccuracy)
+    {
+    // Perform 1 step of dichotomic search
+    subPixelSpacing /= 2.;
+
+    // Store last opt params
+    tmpOptParams = optParams;
+
+    for(int i = -1; i <= 1; i+=2)
+      {
+      for(int j = -1; j <= 1; j+=2)
+        {
+        params = tmpOptParams;
+        params[0] += static_cast<double>(i*subPixelSpacing[0]);
+        params[1] += static_cast<double>(j*subPixelSpacing[1]);
+
+        try
+        {
+          // compute currentMetric
+          currentMetric = m_Metric->GetValue(params);
+
+          // Check for maximum
+          if((m_Minimize && (currentMetric < optMetric)) || (!m_Minimize && (currentMetric > optMetric)))
+            {
+            optMetric = currentMetric;
+            optParams = params;
+            }
+        }
+        catch(itk::ExceptionObject& err)
+        {
+          itkWarningMacro(<<err.GetDescription());
+        }
+        }
+      }
+    }
+ }
+
+template <class TInputImage, class TOutputCorrelation, class TOutputDeformationField>
+bool
+FineRegistrationImageFilter<TInputImage, TOutputCorrelation, TOutputDeformationField>
+::CanUseDenseCorrelation(OffsetType& movingShift)
+ {
+  typedef itk::NormalizedCorrelationImageToImageMetric<TInputImage, TInputImage> CorrelationMetricType;
+  typedef itk::LinearInterpolateImageFunction<TInputImage, double>               LinearInterpolatorType;
+  typedef itk::NearestNeighborInterpolateImageFunction<TInputImage, double>      NearestInterpolatorType;
+
+  const TInputImage * fixedPtr = this->GetFixedInput();
+  const TInputImage * movingPtr = this->GetMovingInput();
+
+  // Only the normalized correlation without masks can be computed from running sums
+  if (dynamic_cast<CorrelationMetricType *>(m_Metric.GetPointer()) == NULL
+      || m_Metric->GetFixedImageMask() != NULL || m_Metric->GetMovingImageMask() != NULL)
+    {
+    return false;
+    }
+
+  // Per pixel offsets are not supported
+  if (m_Transform.IsNotNull())
+    {
+    return false;
+    }
+
+  // Both interpolators give back the moving pixel values on the pixel grid
+  if (dynamic_cast<LinearInterpolatorType *>(m_Interpolator.GetPointer()) == NULL
+      && dynamic_cast<NearestInterpolatorType *>(m_Interpolator.GetPointer()) == NULL)
+    {
+    return false;
+    }
+
+  // Displacements must map fixed pixels onto moving pixels
+  SpacingType fixedSpacing = fixedPtr->GetSpacing();
+  if (fixedSpacing != movingPtr->GetSpacing())
+    {
+    return false;
+    }
+
+  for(unsigned int i = 0; i < TInputImage::ImageDimension; ++i)
+    {
+    for(unsigned int j = 0; j < TInputImage::ImageDimension; ++j)
+      {
+      const double identity = (i == j) ? 1. : 0.;
+      if (fixedPtr->GetDirection()[i][j] != identity || movingPtr->GetDirection()[i][j] != identity)
+        {
+        return false;
+        }
+      }
+    }
+
+  for(unsigned int dim = 0; dim < TInputImage::ImageDimension; ++dim)
+    {
+    const double shift = (fixedPtr->GetOrigin()[dim] + m_InitialOffset[dim] - movingPtr->GetOrigin()[dim])
+                         / fixedSpacing[dim];
+    const long roundedShift = static_cast<long>(vcl_floor(shift + 0.5));
+
+    if (vcl_abs(shift - roundedShift) > 1e-6)
+      {
+      return false;
+      }
+    movingShift[dim] = roundedShift;
+    }
+
+  return true;
+ }
+
+template <class TInputImage, class TOutputCorrelation, class TOutputDeformationField>
+void
+FineRegistrationImageFilter<TInputImage, TOutputCorrelation, TOutputDeformationField>
+::GenerateDenseCorrelationData(const OffsetType& movingShift)
+ {
+  typedef itk::NormalizedCorrelationImageToImageMetric<TInputImage, TInputImage> CorrelationMetricType;
+
+  // Get the image pointers
+  const TInputImage * fixedPtr = this->GetFixedInput();
+  const TInputImage * movingPtr = this->GetMovingInput();
+  TOutputCorrelation * outputPtr = this->GetOutput();
+  TOutputDeformationField * outputDfPtr = this->GetOutputDeformationField();
+
+  const OutputImageRegionType outputRegion = outputPtr->GetRequestedRegion();
+  const InputImageRegionType  fixedLargestRegion = fixedPtr->GetLargestPossibleRegion();
+  const SpacingType           fixedSpacing = fixedPtr->GetSpacing();
+  const bool subtractMean = static_cast<CorrelationMetricType *>(m_Metric.GetPointer())->GetSubtractMean();
+
+  if (outputRegion.GetNumberOfPixels() == 0)
+    {
+    return;
+    }
+
+  // Fixed area covered by the metric windows
+  InputImageRegionType fixedArea;
+  for(unsigned int dim = 0; dim < TInputImage::ImageDimension; ++dim)
+    {
+    fixedArea.SetIndex(dim, outputRegion.GetIndex()[dim] * m_GridStep[dim]);
+    fixedArea.SetSize(dim, (outputRegion.GetSize()[dim] - 1) * m_GridStep[dim] + 1);
+    }
+  fixedArea.PadByRadius(m_Radius);
+  fixedArea.Crop(fixedLargestRegion);
+
+  const InputImageRegionType movingArea = movingPtr->GetBufferedRegion();
+
+  // The centered correlation does not depend on the values mean: remove it to
+  // keep the running sums small
+  double fixedMean = 0.;
+  double movingMean = 0.;
+  if (subtractMean)
+    {
+    fixedMean = MeanValue(fixedPtr, fixedArea);
+    movingMean = MeanValue(movingPtr, movingArea);
+    }
+
+  // Bounds of the metric windows along each axis, in fixed area coordinates
+  // (lower bound included, upper bound excluded)
+  std::vector<long> windowBegin[2], windowEnd[2];
+  for(unsigned int dim = 0; dim < 2; ++dim)
+    {
+    const long largestBegin = fixedLargestRegion.GetIndex()[dim];
+    const long largestEnd   = largestBegin + static_cast<long>(fixedLargestRegion.GetSize()[dim]);
+
+    for(unsigned long k = 0; k < outputRegion.GetSize()[dim]; ++k)
       {
-      // Perform 1 step of dichotomic search
-      subPixelSpacing /= 2.;
+      const long center = (outputRegion.GetIndex()[dim] + static_cast<long>(k)) * m_GridStep[dim];
+      const long begin  = std::max(center - static_cast<long>(m_Radius[dim]), largestBegin);
+      const long end    = std::min(center + static_cast<long>(m_Radius[dim]) + 1, largestEnd);
+      windowBegin[dim].push_back(begin - fixedArea.GetIndex()[dim]);
+      windowEnd[dim].push_back(end - fixedArea.GetIndex()[dim]);
+      }
+    }
 
-      // Store last opt params
-      tmpOptParams = optParams;
+  const long areaWidth   = fixedArea.GetSize()[0];
+  const long movingWidth = movingArea.GetSize()[0];
+  const long outputWidth = outputRegion.GetSize()[0];
+  const long outputHeight = outputRegion.GetSize()[1];
+  const long nbOutputPixels = outputWidth * outputHeight;
+
+  const typename TInputImage::PixelType * fixedBuffer = fixedPtr->GetBufferPointer();
+  const typename TInputImage::PixelType * movingBuffer = movingPtr->GetBufferPointer();
+
+  // Running sums of count, f, f*f, m, m*m and f*m along the rows of the
+  // current metric windows. A window holds at most 2*radius+1 rows, so the
+  // row sums are kept in a ring of that many rows, and their sum over the
+  // window rows is updated as the windows move down.
+  const unsigned int nbSums = 6;
+  const long sumsWidth = areaWidth + 1;
+  const long ringHeight = 2 * m_Radius[1] + 1;
+  std::vector<double> rowSums(nbSums * sumsWidth * ringHeight, 0.);
+  std::vector<double> windowRowsSums(nbSums * sumsWidth);
+
+  // Optimum value and displacement at each output location
+  std::vector<double> optMetric(nbOutputPixels,
+                                m_Minimize ? itk::NumericTraits<double>::max()
+                                           : itk::NumericTraits<double>::NonpositiveMin());
+  OffsetType nullOffset;
+  nullOffset.Fill(0);
+  std::vector<OffsetType> optDisplacement(nbOutputPixels, nullOffset);
 
-      for(int i = -1; i <= 1; i+=2)
+  // support progress methods/callbacks
+  itk::ProgressReporter progress(this, 0, (2 * m_SearchRadius[0] + 1) * (2 * m_SearchRadius[1] + 1));
+
+  // Compute the correlation at each location, in the same order as the generic path
+  OffsetType displacement;
+  for(int i = -static_cast<int>(m_SearchRadius[0]); i <= static_cast<int>(m_SearchRadius[0]); ++i)
+    {
+    for(int j = -static_cast<int>(m_SearchRadius[1]); j <= static_cast<int>(m_SearchRadius[1]); ++j)
+      {
+      displacement[0] = i;
+      displacement[1] = j;
+
+      // Range of the fixed area columns whose moving pixel is buffered
+      const long shiftX = fixedArea.GetIndex()[0] + movingShift[0] + i - movingArea.GetIndex()[0];
+      const long validBegin = std::max(-shiftX, 0L);
+      const long validEnd   = std::min(movingWidth - shiftX, areaWidth);
+
+      // Rows of the fixed area currently summed in windowRowsSums
+      long rowsBegin = 0;
+      long rowsEnd = 0;
+      std::fill(windowRowsSums.begin(), windowRowsSums.end(), 0.);
+
+      long k = 0;
+      for(long oy = 0; oy < outputHeight; ++oy)
         {
-        for(int j = -1; j <= 1; j+=2)
+        // Remove the rows above the window
+        for(long y = rowsBegin; y < std::min(windowBegin[1][oy], rowsEnd); ++y)
           {
-          params = tmpOptParams;
-          params[0] += static_cast<double>(i*subPixelSpacing[0]);
-          params[1] += static_cast<double>(j*subPixelSpacing[1]);
+          const double * row = &rowSums[nbSums * sumsWidth * (y % ringHeight)];
+          for(long c = 0; c < nbSums * sumsWidth; ++c)
+            {
+            windowRowsSums[c] -= row[c];
+            }
+          }
 
-          try
+        // Sum the new rows of the window and add them
+        for(long y = std::max(windowBegin[1][oy], rowsEnd); y < windowEnd[1][oy]; ++y)
           {
-            // compute currentMetric
-            currentMetric = m_Metric->GetValue(params);
+          double * current = &rowSums[nbSums * sumsWidth * (y % ringHeight)];
+          double   row[6] = {0., 0., 0., 0., 0., 0.};
+
+          IndexType fixedIndex = fixedArea.GetIndex();
+          fixedIndex[1] += y;
+          const typename TInputImage::PixelType * fixedRow = fixedBuffer + fixedPtr->ComputeOffset(fixedIndex);
 
-            // Check for maximum
-            if((m_Minimize && (currentMetric < optMetric)) || (!m_Minimize && (currentMetric > optMetric)))
+          const long movingY = fixedArea.GetIndex()[1] + y + movingShift[1] + j - movingArea.GetIndex()[1];
+          const bool validRow = movingY >= 0 && movingY < static_cast<long>(movingArea.GetSize()[1]);
+          const typename TInputImage::PixelType * movingRow =
+            validRow ? movingBuffer + movingY * movingWidth + shiftX : movingBuffer;
+
+          for(unsigned int c = 0; c < nbSums; ++c)
+            {
+            current[c] = 0.;
+            }
+          for(long x = 0; x < areaWidth; ++x)
+            {
+            if (validRow && x >= validBegin && x < validEnd)
               {
-              optMetric = currentMetric;
-              optParams = params;
+              const double f = static_cast<double>(fixedRow[x]) - fixedMean;
+              const double m = static_cast<double>(movingRow[x]) - movingMean;
+              row[0] += 1.;
+              row[1] += f;
+              row[2] += f * f;
+              row[3] += m;
+              row[4] += m * m;
+              row[5] += f * m;
               }
+            for(unsigned int c = 0; c < nbSums; ++c)
+              {
+              current[nbSums * (x + 1) + c] = row[c];
+              }
+            }
+
+          for(long c = 0; c < nbSums * sumsWidth; ++c)
+            {
+            windowRowsSums[c] += current[c];
+            }
           }
-          catch(itk::ExceptionObject& err)
+
+        rowsBegin = windowBegin[1][oy];
+        rowsEnd = windowEnd[1][oy];
+
+        // Read the window sums at each output location of the row
+        for(long ox = 0; ox < outputWidth; ++ox, ++k)
           {
-            itkWarningMacro(<<err.GetDescription());
+          const long left  = nbSums * windowBegin[0][ox];
+          const long right = nbSums * windowEnd[0][ox];
+          double windowSums[6];
+          for(unsigned int c = 0; c < nbSums; ++c)
+            {
+            windowSums[c] = windowRowsSums[right + c] - windowRowsSums[left + c];
+            }
+
+          const double currentMetric = CorrelationFromSums(windowSums[0], windowSums[1], windowSums[2],
+                                                           windowSums[3], windowSums[4], windowSums[5],
+                                                           subtractMean);
 
+          // Check for maximum
+          if((m_Minimize && (currentMetric < optMetric[k])) || (!m_Minimize && (currentMetric > optMetric[k])))
+            {
+            optMetric[k] = currentMetric;
+            optDisplacement[k] = displacement;
+            }
+          }
+        }
+
+      // Update progress
+      progress.CompletedPixel();
+      }
+    }
+
+  /** Output iterators */
+  itk::ImageRegionIteratorWithIndex<TOutputCorrelation> outputIt(outputPtr, outputRegion);
+  itk::ImageRegionIterator<TOutputDeformationField> outputDfIt(outputDfPtr, outputRegion);
+  outputIt.GoToBegin();
+  outputDfIt.GoToBegin();
+
+  ParametersType optParams(2);
+  DeformationValueType deformationValue;
+  long k = 0;
+
+  while (!outputIt.IsAtEnd() && !outputDfIt.IsAtEnd())
+    {
+    double value = optMetric[k];
+    for(unsigned int dim = 0; dim < 2; ++dim)
+      {
+      optParams[dim] = m_InitialOffset[dim] + optDisplacement[k][dim] * fixedSpacing[dim];
+      }
+
+    if (fixedSpacing[0] > m_SubPixelAccuracy || fixedSpacing[1] > m_SubPixelAccuracy)
+      {
+      InputImageRegionType window;
+      const long ox = k % outputWidth;
+      const long oy = k / outputWidth;
+      window.SetIndex(0, fixedArea.GetIndex()[0] + windowBegin[0][ox]);
+      window.SetIndex(1, fixedArea.GetIndex()[1] + windowBegin[1][oy]);
+      window.SetSize(0, windowEnd[0][ox] - windowBegin[0][ox]);
+      window.SetSize(1, windowEnd[1][oy] - windowBegin[1][oy]);
+
+      if (m_UseMetricRefinement)
+        {
+        // Dichotomic sub-pixel, on the same metric window as the generic path
+        m_Metric->SetFixedImageRegion(window);
+        m_Metric->Initialize();
+
+        this->RefineOptimum(optParams, value, fixedSpacing);
+        }
+      else if (vcl_abs(optDisplacement[k][0]) < static_cast<long>(m_SearchRadius[0])
+               && vcl_abs(optDisplacement[k][1]) < static_cast<long>(m_SearchRadius[1]))
+        {
+        // Quadratic fit of the correlation around the optimum. The optimum is
+        // not bracketed on the search window border, where no fit is done.
+        double neighborhood[3][3];
+        for(int u = -1; u <= 1; ++u)
+          {
+          for(int v = -1; v <= 1; ++v)
+            {
+            OffsetType movingOffset = movingShift + optDisplacement[k];
+            movingOffset[0] += u;
+            movingOffset[1] += v;
+            neighborhood[u + 1][v + 1] = (u == 0 && v == 0) ? value
+              : this->DenseCorrelation(window, movingOffset, fixedMean, movingMean, subtractMean);
+            }
           }
+
+        double dx, dy, fittedValue;
+        if (FitQuadraticOptimum(neighborhood, m_Minimize, dx, dy, fittedValue))
+          {
+          optParams[0] += dx * fixedSpacing[0];
+          optParams[1] += dy * fixedSpacing[1];
+          value = fittedValue;
           }
         }
       }
 
     // Store the offset and the correlation value
-    outputIt.Set(optMetric);
+    outputIt.Set(value);
     if(m_UseSpacing)
       {
       deformationValue[0] = optParams[0];
@@ -461,14 +845,136 @@ FineRegistrationImageFilter<TInputImage, TOutputCorrelation, TOutputDeformationF
       deformationValue[1] = optParams[1]/fixedSpacing[1];
       }
     outputDfIt.Set(deformationValue);
-    // Update iterators
+
     ++outputIt;
     ++outputDfIt;
+    ++k;
+    }
+ }
 
-    // Update progress
-    progress.CompletedPixel();
+template <class TInputImage, class TOutputCorrelation, class TOutputDeformationField>
+double
+FineRegistrationImageFilter<TInputImage, TOutputCorrelation, TOutputDeformationField>
+::CorrelationFromSums(double n, double sf, double sff, double sm, double smm, double sfm, bool subtractMean)
+ {
+  // Variances below this fraction of the sum of squares are rounding residuals of flat windows
+  const double flatThreshold = 1e-9;
+
+  if (subtractMean && n > 0)
+    {
+    const double rawSff = sff;
+    const double rawSmm = smm;
+    sff -= sf * sf / n;
+    smm -= sm * sm / n;
+    sfm -= sf * sm / n;
+
+    if (sff <= flatThreshold * rawSff || smm <= flatThreshold * rawSmm)
+      {
+      return 0.;
+      }
+    }
+
+  if (n > 0 && sff * smm > 0.)
+    {
+    return sfm / (-1.0 * vcl_sqrt(sff * smm));
     }
+  return 0.;
  }
+
+template <class TInputImage, class TOutputCorrelation, class TOutputDeformationField>
+double
+FineRegistrationImageFilter<TInputImage, TOutputCorrelation, TOutputDeformationField>
+::DenseCorrelation(const InputImageRegionType& window, const OffsetType& movingOffset,
+                   double fixedMean, double movingMean, bool subtractMean)
+ {
+  const TInputImage * fixedPtr = this->GetFixedInput();
+  const TInputImage * movingPtr = this->GetMovingInput();
+  const InputImageRegionType movingArea = movingPtr->GetBufferedRegion();
+
+  double sums[6] = {0., 0., 0., 0., 0., 0.};
+
+  itk::ImageRegionConstIteratorWithIndex<TInputImage> fixedIt(fixedPtr, window);
+  for (fixedIt.GoToBegin(); !fixedIt.IsAtEnd(); ++fixedIt)
+    {
+    const IndexType movingIndex = fixedIt.GetIndex() + movingOffset;
+    if (movingArea.IsInside(movingIndex))
+      {
+      const double f = static_cast<double>(fixedIt.Get()) - fixedMean;
+      const double m = static_cast<double>(movingPtr->GetPixel(movingIndex)) - movingMean;
+      sums[0] += 1.;
+      sums[1] += f;
+      sums[2] += f * f;
+      sums[3] += m;
+      sums[4] += m * m;
+      sums[5] += f * m;
+      }
+    }
+
+  return CorrelationFromSums(sums[0], sums[1], sums[2], sums[3], sums[4], sums[5], subtractMean);
+ }
+
+template <class TInputImage, class TOutputCorrelation, class TOutputDeformationField>
+bool
+FineRegistrationImageFilter<TInputImage, TOutputCorrelation, TOutputDeformationField>
+::FitQuadraticOptimum(const double values[3][3], bool minimize, double& dx, double& dy, double& value)
+ {
+  // Least squares fit of a + b*x + c*y + d*x*x + e*y*y + g*x*y, the first
+  // index of values being along x
+  double columnSums[3], rowSums[3];
+  for(unsigned int u = 0; u < 3; ++u)
+    {
+    columnSums[u] = values[u][0] + values[u][1] + values[u][2];
+    rowSums[u] = values[0][u] + values[1][u] + values[2][u];
+    }
+
+  const double edges   = values[0][1] + values[2][1] + values[1][0] + values[1][2];
+  const double corners = values[0][0] + values[0][2] + values[2][0] + values[2][2];
+
+  const double a = (5. * values[1][1] + 2. * edges - corners) / 9.;
+  const double b = (columnSums[2] - columnSums[0]) / 6.;
+  const double c = (rowSums[2] - rowSums[0]) / 6.;
+  const double d = (columnSums[0] + columnSums[2] - 2. * columnSums[1]) / 6.;
+  const double e = (rowSums[0] + rowSums[2] - 2. * rowSums[1]) / 6.;
+  const double g = (values[2][2] - values[2][0] - values[0][2] + values[0][0]) / 4.;
+
+  // The quadratic must have a minimum (resp. maximum)
+  const double det = 4. * d * e - g * g;
+  if (det <= 0. || (minimize && d <= 0.) || (!minimize && d >= 0.))
+    {
+    return false;
+    }
+
+  dx = (g * c - 2. * e * b) / det;
+  dy = (g * b - 2. * d * c) / det;
+
+  if (vcl_abs(dx) > 1. || vcl_abs(dy) > 1.)
+    {
+    return false;
+    }
+
+  value = a + b * dx + c * dy + d * dx * dx + e * dy * dy + g * dx * dy;
+  return true;
+ }
+
+template <class TInputImage, class TOutputCorrelation, class TOutputDeformationField>
+double
+FineRegistrationImageFilter<TInputImage, TOutputCorrelation, TOutputDeformationField>
+::MeanValue(const TInputImage * image, const InputImageRegionType& region)
+ {
+  if (region.GetNumberOfPixels() == 0)
+    {
+    return 0.;
+    }
+
+  double mean = 0.;
+  itk::ImageRegionConstIterator<TInputImage> it(image, region);
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+    mean += static_cast<double>(it.Get());
+    }
+  return mean / region.GetNumberOfPixels();
+ }
+
 } // end namespace otb
 
 #endif
@@ -22,6 +22,7 @@
 #include "itkFixedArray.h"
 #include "otbMaskedScalarImageToGreyLevelCoocurenceMatrixGenerator.h"
 #include "itkGreyLevelCooccurrenceMatrixTextureCoefficientsCalculator.h"
+#include "otbSlidingWindowGreyLevelCooccurrenceMatrix.h"
 
 namespace otb
 {
@@ -59,6 +60,11 @@ namespace otb
  * This class is templated over the input image type and the
  * coordinate representation type (e.g. float or double).
  *
+ * The co-occurence matrix is computed by a dense
+ * SlidingWindowGreyLevelCooccurrenceMatrix, which avoids building a sparse
+ * histogram for each evaluation.
+ *
+ * \sa otb::SlidingWindowGreyLevelCooccurrenceMatrix
  * \sa otb::MaskedScalarImageToGreyLevelCooccurrenceMatrixGenerator
  * \sa itk::GreyLevelCooccurrenceMatrixTextureCoefficientsCalculator
  *
@@ -115,6 +121,10 @@ public:
     <HistogramType>                                TextureCoefficientsCalculatorType;
     typedef typename TextureCoefficientsCalculatorType
         ::Pointer                                  TextureCoefficientsCalculatorPointerType;
+    typedef otb::SlidingWindowGreyLevelCooccurrenceMatrix
+    <InputImageType>                               CooccurrenceMatrixType;
+    typedef typename CooccurrenceMatrixType
+        ::Pointer                                  CooccurrenceMatrixPointerType;
 
   // Output typedef support
   typedef typename Superclass::OutputType          OutputType;
@@ -76,48 +76,32 @@ HaralickTexturesImageFunction<TInputImage, TCoordRep>
     return textures;
     }
   
-  // Build the co-occurence matrix generator
-  CoocurrenceMatrixGeneratorPointerType coOccurenceMatrixGenerator = CoocurrenceMatrixGeneratorType::New();
-  coOccurenceMatrixGenerator->SetInput(this->GetInputImage());
-  coOccurenceMatrixGenerator->SetOffset(m_Offset);
-  coOccurenceMatrixGenerator->SetNumberOfBinsPerAxis(m_NumberOfBinsPerAxis);
-  coOccurenceMatrixGenerator->SetPixelValueMinMax(m_InputImageMinimum, m_InputImageMaximum);
-
-  // Compute the region on which co-occurence will be estimated
-  typename InputRegionType::IndexType inputIndex = index;
-  for(unsigned int dim = 0; dim<InputImageType::ImageDimension; ++dim)
-    {
-    inputIndex[dim]-= m_NeighborhoodRadius;
-    }
-  typename InputRegionType::SizeType  inputSize;
-  inputSize.Fill(2*m_NeighborhoodRadius+1);
-
-  // Build the input  region
-  InputRegionType inputRegion;
-  inputRegion.SetIndex(inputIndex);
-  inputRegion.SetSize(inputSize);
+  // Build the co-occurence matrix
+  CooccurrenceMatrixPointerType cooccurrenceMatrix = CooccurrenceMatrixType::New();
+  cooccurrenceMatrix->SetInput(this->GetInputImage());
+  cooccurrenceMatrix->SetRegion(this->GetInputImage()->GetRequestedRegion());
+  cooccurrenceMatrix->SetOffset(m_Offset);
+  cooccurrenceMatrix->SetNumberOfBinsPerAxis(m_NumberOfBinsPerAxis);
+  cooccurrenceMatrix->SetPixelValueMinMax(m_InputImageMinimum, m_InputImageMaximum);
+
+  // Set the neighborhood on which co-occurence will be estimated
+  typename InputRegionType::SizeType radius;
+  radius.Fill(m_NeighborhoodRadius);
+  cooccurrenceMatrix->SetRadius(radius);
 
   // Compute the co-occurence matrix
-  coOccurenceMatrixGenerator->SetRegion(inputRegion);
-  coOccurenceMatrixGenerator->SetNormalize(true);
-  coOccurenceMatrixGenerator->Compute();
-
-  // Build the texture calculator
-  TextureCoefficientsCalculatorPointerType texturesCalculator = TextureCoefficientsCalculatorType::New();
+  cooccurrenceMatrix->Initialize();
+  cooccurrenceMatrix->SetCenter(index);
 
   // Compute textures indices
-  texturesCalculator->SetHistogram(coOccurenceMatrixGenerator->GetOutput());
-  texturesCalculator->Compute();
+  typename CooccurrenceMatrixType::HaralickTexturesType haralickTextures =
+    cooccurrenceMatrix->ComputeHaralickTextures();
 
   // Fill the output vector
-  textures[0]=texturesCalculator->GetEnergy();
-  textures[1]=texturesCalculator->GetEntropy();
-  textures[2]=texturesCalculator->GetCorrelation();
-  textures[3]=texturesCalculator->GetInverseDifferenceMoment();
-  textures[4]=texturesCalculator->GetInertia();
-  textures[5]=texturesCalculator->GetClusterShade();
-  textures[6]=texturesCalculator->GetClusterProminence();
-  textures[7]=texturesCalculator->GetHaralickCorrelation();
+  for (unsigned int i = 0; i < haralickTextures.Size(); ++i)
+    {
+    textures[i] = static_cast<ScalarRealType>(haralickTextures[i]);
+    }
 
   // Return result
   return textures;
@@ -71,6 +71,14 @@ public:
  *  and implements the density control, the NOTINIT status and the
  *  incremental rectangle optimisation.
  *
+ *  The number of tests of the a contrario model is derived from the
+ *  input size. When the input is a tile of a larger scene, SetReferenceSize()
+ *  gives the size of the scene, so that the detection thresholds do not
+ *  depend on the tiling. In the same way, the gradient threshold and the
+ *  seed histogram are normalized with the range of the gradient modulus
+ *  of the input, unless SetModulusMinimum() and SetModulusMaximum() give
+ *  the range over the scene.
+ *
  *  \sa StreamingLineSegmentDetector (streamed version)
  *  \ingroup FeatureExtraction
  *
@@ -166,6 +174,20 @@ public:
   virtual void SetInput(const InputImageType *input);
   virtual const InputImageType * GetInput(void);
 
+  /** Set/Get the size of the image used to compute the number of
+   * tests. A null size (the default) stands for the input largest
+   * possible region. */
+  itkSetMacro(ReferenceSize, SizeType);
+  itkGetConstReferenceMacro(ReferenceSize, SizeType);
+
+  /** Set/Get the range of the gradient modulus used to normalize the
+   * threshold and the seed histogram. A maximum lower than the minimum
+   * (the default) stands for the range over the input. */
+  itkSetMacro(ModulusMinimum, double);
+  itkGetMacro(ModulusMinimum, double);
+  itkSetMacro(ModulusMaximum, double);
+  itkGetMacro(ModulusMaximum, double);
+
   /** Custom Get methods to access intermediate data*/
   LabelImagePointerType GetMap()
   {
@@ -192,6 +214,7 @@ protected:
   /** Sort the image and store the coordinates in a histogram
    *  this method is used to determine the seeds where to begin the search segments
    *  Points with large gradient modulus are more able to belong to a segment
+   *  The sort is a linear time bucket sort of the modulus on 1024 bins.
    */
   virtual CoordinateHistogramType SortImageByModulusValue(MagnitudeImagePointerType modulusImage);
 
@@ -246,6 +269,9 @@ protected:
   /** Create a copy of a rectangle*/
   virtual void CopyRectangle(RectangleType& rDst, RectangleType& rSrc) const;
 
+  /** Logarithm of the number of tests, from the reference size */
+  double GetLogNumberOfTests() const;
+
   /** Printself method*/
   void PrintSelf(std::ostream& os, itk::Indent indent) const;
 
@@ -253,11 +279,17 @@ private:
   LineSegmentDetector(const Self &);  //purposely not implemented
   void operator =(const Self&);      //purposely not implemented
 
+  /** Bin of a gradient modulus in the seed histogram */
+  static unsigned int ComputeBin(double value, double min, double lengthBin, unsigned int nbBins);
+
   VectorOfIndexVectorType m_RegionList;
   DirectionVectorType     m_DirectionVector;
   LabelImagePointerType   m_UsedPointImage;
   RectangleListType       m_RectangleList;
 
+  SizeType     m_ReferenceSize;
+  double       m_ModulusMinimum;
+  double       m_ModulusMaximum;
   double       m_Threshold;
   double       m_Prec;
   double       m_DirectionsAllowed;
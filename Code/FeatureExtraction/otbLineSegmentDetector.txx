@@ -23,7 +23,7 @@
 #include "otbLineSegmentDetector.h"
 #include "itkImageRegionIterator.h"
 #include "itkNumericTraits.h"
-#include "itkMinimumMaximumImageCalculator.h"
+#include "itkImageRegionConstIterator.h"
 #include "itkConstNeighborhoodIterator.h"
 #include "itkImageConstIterator.h"
 #include "itkNeighborhoodIterator.h"
@@ -51,6 +51,9 @@ LineSegmentDetector<TInputImage, TPrecision>
   m_DirectionsAllowed = 1. / 8.;
   m_Prec = CONST_PI * m_DirectionsAllowed;
   m_Threshold = 5.2;
+  m_ReferenceSize.Fill(0);
+  m_ModulusMinimum = 0.;
+  m_ModulusMaximum = -1.;
 
   /** Compute the modulus and the orientation gradient images */
   m_GradientFilter = GradientFilterType::New();
@@ -124,12 +127,16 @@ LineSegmentDetector<TInputImage, TPrecision>
   typedef itk::CastImageFilter<InputImageType, OutputImageType> castFilerType;
   typename castFilerType::Pointer castFilter =  castFilerType::New();
   castFilter->SetInput(this->GetInput());
+  castFilter->SetNumberOfThreads(this->GetNumberOfThreads());
 
   /** Compute the modulus and the orientation gradient image */
   m_GradientFilter->SetInput(castFilter->GetOutput());
   m_GradientFilter->SetSigma(0.6);
   m_MagnitudeFilter->SetInput(m_GradientFilter->GetOutput());
   m_OrientationFilter->SetInput(m_GradientFilter->GetOutput());
+  m_GradientFilter->SetNumberOfThreads(this->GetNumberOfThreads());
+  m_MagnitudeFilter->SetNumberOfThreads(this->GetNumberOfThreads());
+  m_OrientationFilter->SetNumberOfThreads(this->GetNumberOfThreads());
 
   m_MagnitudeFilter->Update();
   m_OrientationFilter->Update();
@@ -154,23 +161,33 @@ LineSegmentDetector<TInputImage, TPrecision>
   RegionType largestRegion = this->GetInput()->GetLargestPossibleRegion();
 
   // Compute the minimum region size
-  double logNT = 5. * vcl_log10( static_cast<double>(largestRegion.GetNumberOfPixels()) ) / 2.;
+  double logNT = this->GetLogNumberOfTests();
   double log1_p = vcl_log10(m_DirectionsAllowed);
   double rapport = logNT / log1_p;
   m_MinimumRegionSize = static_cast<unsigned int>(-rapport);
 
   // Computing the min & max of the image
-  typedef  itk::MinimumMaximumImageCalculator<OutputImageType> MinMaxCalculatorFilter;
-  typename MinMaxCalculatorFilter::Pointer minmaxCalculator =   MinMaxCalculatorFilter::New();
+  OutputPixelType min = itk::NumericTraits<OutputPixelType>::max();
+  OutputPixelType max = itk::NumericTraits<OutputPixelType>::NonpositiveMin();
 
-  minmaxCalculator->SetImage(modulusImage);
-  minmaxCalculator->ComputeMinimum();
-  OutputPixelType min = minmaxCalculator->GetMinimum();
-  minmaxCalculator->ComputeMaximum();
-  OutputPixelType max = minmaxCalculator->GetMaximum();
+  if (m_ModulusMaximum >= m_ModulusMinimum)
+    {
+    // Range given over the whole scene
+    min = static_cast<OutputPixelType>(m_ModulusMinimum);
+    max = static_cast<OutputPixelType>(m_ModulusMaximum);
+    }
+  else
+    {
+    itk::ImageRegionConstIterator<OutputImageType> itMinMax(modulusImage, modulusImage->GetRequestedRegion());
+    for (itMinMax.GoToBegin(); !itMinMax.IsAtEnd(); ++itMinMax)
+      {
+      if (itMinMax.Get() < min) min = itMinMax.Get();
+      if (itMinMax.Get() > max) max = itMinMax.Get();
+      }
+    }
 
   /** Compute the threshold on the gradient*/
-  m_Threshold = m_Threshold * ((max - min) / 255.);     // threshold normalized with min & max of the values
+  const double threshold = m_Threshold * ((max - min) / 255.);     // threshold normalized with min & max of the values
 
   /** Computing the length of the bins*/
   unsigned int NbBin = 1024;
@@ -215,21 +232,63 @@ LineSegmentDetector<TInputImage, TPrecision>
   region.SetSize(size);
   
   itk::ImageRegionIterator<OutputImageType> it(modulusImage, region);
-  
-  it.GoToBegin();
-  while (!it.IsAtEnd())
+
+  // First pass to size the bins, second pass to fill them: the buckets
+  // are allocated once
+  std::vector<unsigned long> binSizes(NbBin, 0);
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
     {
-    unsigned int    bin = static_cast<unsigned int> (static_cast<double>(it.Value()) / lengthBin);
-    
-    if (it.Value() - m_Threshold > 1e-10) tempHisto[NbBin - bin - 1].push_back(it.GetIndex());
-    else SetPixelToUsed(it.GetIndex());
+    if (it.Value() - threshold > 1e-10)
+      {
+      ++binSizes[NbBin - this->ComputeBin(it.Value(), min, lengthBin, NbBin) - 1];
+      }
+    else
+      {
+      this->SetPixelToUsed(it.GetIndex());
+      }
+    }
+  for (unsigned int bin = 0; bin < NbBin; ++bin)
+    {
+    tempHisto[bin].reserve(binSizes[bin]);
+    }
 
-    ++it;
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+    if (it.Value() - threshold > 1e-10)
+      {
+      tempHisto[NbBin - this->ComputeBin(it.Value(), min, lengthBin, NbBin) - 1].push_back(it.GetIndex());
+      }
     }
 
   return tempHisto;
 }
 
+template <class TInputImage, class TPrecision>
+unsigned int
+LineSegmentDetector<TInputImage, TPrecision>
+::ComputeBin(double value, double min, double lengthBin, unsigned int nbBins)
+{
+  if (lengthBin <= 0.)
+    {
+    return 0;
+    }
+  unsigned int bin = static_cast<unsigned int>((value - min) / lengthBin);
+  return bin < nbBins ? bin : nbBins - 1;
+}
+
+template <class TInputImage, class TPrecision>
+double
+LineSegmentDetector<TInputImage, TPrecision>
+::GetLogNumberOfTests() const
+{
+  double nbPixels = static_cast<double>(m_ReferenceSize[0]) * static_cast<double>(m_ReferenceSize[1]);
+  if (nbPixels == 0.)
+    {
+    nbPixels = static_cast<double>(const_cast<Self*>(this)->GetInput()->GetLargestPossibleRegion().GetNumberOfPixels());
+    }
+  return 5. * vcl_log10(nbPixels) / 2.;
+}
+
 /**************************************************************************************************************/
 /**
  * Method used to search the segments
@@ -491,16 +550,11 @@ LineSegmentDetector<TInputImage, TPrecision>
 {
   bool isNotUsed = false;
 
-  typedef itk::ImageConstIterator<LabelImageType> ImageIteratorType;
-  RegionType     region = m_UsedPointImage->GetLargestPossibleRegion();
-  InputIndexType indexRef = region.GetIndex();
-  ImageIteratorType itLabel(m_UsedPointImage, region);
-  itLabel.GoToBegin();
+  RegionType region = m_UsedPointImage->GetLargestPossibleRegion();
 
-  if (m_UsedPointImage->GetLargestPossibleRegion().IsInside(index))
+  if (region.IsInside(index))
     {
-    itLabel.SetIndex(index);
-    if (itLabel.Get() == 0) isNotUsed = true;
+    if (m_UsedPointImage->GetPixel(index) == 0) isNotUsed = true;
     }
   else
     {
@@ -521,16 +575,11 @@ LineSegmentDetector<TInputImage, TPrecision>
 {
   bool isUsed = false;
 
-  typedef itk::ImageConstIterator<LabelImageType> ImageIteratorType;
-  RegionType     region = m_UsedPointImage->GetLargestPossibleRegion();
-  InputIndexType indexRef = region.GetIndex();
-  ImageIteratorType itLabel(m_UsedPointImage, region);
-  itLabel.GoToBegin();
+  RegionType region = m_UsedPointImage->GetLargestPossibleRegion();
 
-  if (m_UsedPointImage->GetLargestPossibleRegion().IsInside(index))
+  if (region.IsInside(index))
     {
-    itLabel.SetIndex(index);
-    if (itLabel.Get() == 255) isUsed = true;
+    if (m_UsedPointImage->GetPixel(index) == 255) isUsed = true;
     }
   else
     {
@@ -552,16 +601,11 @@ LineSegmentDetector<TInputImage, TPrecision>
 {
   bool isNotIni = false;
 
-  typedef itk::ImageConstIterator<LabelImageType> ImageIteratorType;
-  RegionType     region = m_UsedPointImage->GetLargestPossibleRegion();
-  InputIndexType indexRef = region.GetIndex();
-  ImageIteratorType itLabel(m_UsedPointImage, region);
-  itLabel.GoToBegin();
+  RegionType region = m_UsedPointImage->GetLargestPossibleRegion();
 
-  if (m_UsedPointImage->GetLargestPossibleRegion().IsInside(index))
+  if (region.IsInside(index))
     {
-    itLabel.SetIndex(index);
-    if (itLabel.Get() == 127) isNotIni = true;
+    if (m_UsedPointImage->GetPixel(index) == 127) isNotIni = true;
     }
   else
     {
@@ -582,13 +626,7 @@ void
 LineSegmentDetector<TInputImage, TPrecision>
 ::SetPixelToUsed(InputIndexType index)
 {
-  typedef itk::NeighborhoodIterator<LabelImageType> NeighborhoodLabelIteratorType;
-  typename NeighborhoodLabelIteratorType::SizeType radiusLabel;
-  radiusLabel.Fill(0);
-  NeighborhoodLabelIteratorType                       itLabel(radiusLabel, m_UsedPointImage,
-                                                              m_UsedPointImage->GetRequestedRegion());
-  itLabel.SetLocation(index);
-  itLabel.SetCenterPixel(255);     // 255 : Set the point status to : Used Point
+  m_UsedPointImage->SetPixel(index, 255);     // 255 : Set the point status to : Used Point
 }
 
 /**************************************************************************************************************/
@@ -601,13 +639,7 @@ void
 LineSegmentDetector<TInputImage, TPrecision>
 ::SetPixelToNotIni(InputIndexType index)
 {
-  typedef itk::NeighborhoodIterator<LabelImageType> NeighborhoodLabelIteratorType;
-  typename NeighborhoodLabelIteratorType::SizeType radiusLabel;
-  radiusLabel.Fill(0);
-  NeighborhoodLabelIteratorType                       itLabel(radiusLabel, m_UsedPointImage,
-                                                              m_UsedPointImage->GetRequestedRegion());
-  itLabel.SetLocation(index);
-  itLabel.SetCenterPixel(127);     // 127 : Set the point status to : Not Ini Point
+  m_UsedPointImage->SetPixel(index, 127);     // 127 : Set the point status to : Not Ini Point
 }
 
 /**************************************************************************************************************/
@@ -989,8 +1021,7 @@ LineSegmentDetector<TInputImage, TPrecision>
     }
 
   /** Compute the NFA from the rectangle computed below*/
-  RegionType largestRegion = const_cast<Self*>(this)->GetInput()->GetLargestPossibleRegion();
-  double logNT = 5. * vcl_log10( static_cast<double>(largestRegion.GetNumberOfPixels()) ) / 2.;
+  double logNT = this->GetLogNumberOfTests();
 
   nfa_val = NFA(pts, NbAligned, m_DirectionsAllowed, logNT);
 
@@ -1036,7 +1067,9 @@ LineSegmentDetector<TInputImage, TPrecision>
 ::PrintSelf(std::ostream& os, itk::Indent indent) const
 {
   Superclass::PrintSelf(os, indent);
-
+  os << indent << "ReferenceSize: " << m_ReferenceSize << std::endl;
+  os << indent << "ModulusMinimum: " << m_ModulusMinimum << std::endl;
+  os << indent << "ModulusMaximum: " << m_ModulusMaximum << std::endl;
 }
 
 } // end namespace otb
@@ -22,6 +22,7 @@
 
 #include "otbMaskedScalarImageToGreyLevelCoocurenceMatrixGenerator.h"
 #include "otbGreyLevelCooccurrenceMatrixAdvancedTextureCoefficientsCalculator.h"
+#include "otbSlidingWindowGreyLevelCooccurrenceMatrix.h"
 
 namespace otb
 {
@@ -65,6 +66,9 @@ public:
   typedef GreyLevelCooccurrenceMatrixAdvancedTextureCoefficientsCalculator
   <HistogramType>                                                TextureCoefficientsCalculatorType;
   typedef typename TextureCoefficientsCalculatorType::Pointer TextureCoefficientsCalculatorPointerType;
+  typedef otb::SlidingWindowGreyLevelCooccurrenceMatrix<InputImageType> CooccurrenceMatrixType;
+  typedef typename CooccurrenceMatrixType::Pointer                    CooccurrenceMatrixPointerType;
+  typedef typename CooccurrenceMatrixType::AdvancedTexturesType       TexturesType;
 
   /** Set the radius of the window on which textures will be computed */
   itkSetMacro(Radius, SizeType);
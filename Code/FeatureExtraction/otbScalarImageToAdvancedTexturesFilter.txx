@@ -269,15 +269,16 @@ ScalarImageToAdvancedTexturesFilter<TInputImage, TOutputImage>
   ic1It.GoToBegin();
   ic2It.GoToBegin();
 
-  // Build the co-occurence matrix generator
-  CoocurrenceMatrixGeneratorPointerType coOccurenceMatrixGenerator = CoocurrenceMatrixGeneratorType::New();
-  coOccurenceMatrixGenerator->SetInput(inputPtr);
-  coOccurenceMatrixGenerator->SetOffset(m_Offset);
-  coOccurenceMatrixGenerator->SetNumberOfBinsPerAxis(m_NumberOfBinsPerAxis);
-  coOccurenceMatrixGenerator->SetPixelValueMinMax(m_InputImageMinimum, m_InputImageMaximum);
-
-  // Build the texture calculator
-  TextureCoefficientsCalculatorPointerType texturesCalculator = TextureCoefficientsCalculatorType::New();
+  // Build the sliding window co-occurence matrix. The window is slid
+  // along the rows of the output region, which allows incremental updates.
+  CooccurrenceMatrixPointerType cooccurrenceMatrix = CooccurrenceMatrixType::New();
+  cooccurrenceMatrix->SetInput(inputPtr);
+  cooccurrenceMatrix->SetRegion(inputPtr->GetRequestedRegion());
+  cooccurrenceMatrix->SetRadius(m_Radius);
+  cooccurrenceMatrix->SetOffset(m_Offset);
+  cooccurrenceMatrix->SetNumberOfBinsPerAxis(m_NumberOfBinsPerAxis);
+  cooccurrenceMatrix->SetPixelValueMinMax(m_InputImageMinimum, m_InputImageMaximum);
+  cooccurrenceMatrix->Initialize();
 
   // Set-up progress reporting
   itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels());
@@ -293,40 +294,22 @@ ScalarImageToAdvancedTexturesFilter<TInputImage, TOutputImage>
          && !ic1It.IsAtEnd()
          && !ic2It.IsAtEnd())
     {
-    // Find the input region on which texture will be computed
-    InputRegionType                     currentRegion;
-    typename InputRegionType::IndexType currentIndex = varianceIt.GetIndex() - m_Radius;
-    typename InputRegionType::SizeType  currentSize;
-
-    for (unsigned int dim = 0; dim < InputImageType::ImageDimension; ++dim)
-      {
-      // Compute current size before applying offset
-      currentSize[dim] = 2 * m_Radius[dim] + 1;
-      }
-
-    // Fill current region
-    currentRegion.SetIndex(currentIndex);
-    currentRegion.SetSize(currentSize);
-
-    // Compute the co-occurence matrix
-    coOccurenceMatrixGenerator->SetRegion(currentRegion);
-    coOccurenceMatrixGenerator->SetNormalize(true);
-    coOccurenceMatrixGenerator->Compute();
+    // Update the co-occurence matrix for the window centered on the current pixel
+    cooccurrenceMatrix->SetCenter(varianceIt.GetIndex());
 
     // Compute textures indices
-    texturesCalculator->SetHistogram(coOccurenceMatrixGenerator->GetOutput());
-    texturesCalculator->Compute();
+    TexturesType textures = cooccurrenceMatrix->ComputeAdvancedTextures();
 
     // Fill outputs
-    varianceIt.Set(texturesCalculator->GetVariance());
-    meanIt.Set(texturesCalculator->GetMean());
-    sumAverageIt.Set(texturesCalculator->GetSumAverage());
-    sumVarianceIt.Set(texturesCalculator->GetSumVariance());
-    sumEntropytIt.Set(texturesCalculator->GetSumEntropy());
-    differenceEntropyIt.Set(texturesCalculator->GetDifferenceEntropy());
-    differenceVarianceIt.Set(texturesCalculator->GetDifferenceVariance());
-    ic1It.Set(texturesCalculator->GetIC1());
-    ic2It.Set(texturesCalculator->GetIC2());
+    varianceIt.Set(static_cast<typename OutputImageType::PixelType>(textures[0]));
+    meanIt.Set(static_cast<typename OutputImageType::PixelType>(textures[1]));
+    sumAverageIt.Set(static_cast<typename OutputImageType::PixelType>(textures[2]));
+    sumVarianceIt.Set(static_cast<typename OutputImageType::PixelType>(textures[3]));
+    sumEntropytIt.Set(static_cast<typename OutputImageType::PixelType>(textures[4]));
+    differenceEntropyIt.Set(static_cast<typename OutputImageType::PixelType>(textures[5]));
+    differenceVarianceIt.Set(static_cast<typename OutputImageType::PixelType>(textures[6]));
+    ic1It.Set(static_cast<typename OutputImageType::PixelType>(textures[7]));
+    ic2It.Set(static_cast<typename OutputImageType::PixelType>(textures[8]));
 
     // Update progress
     progress.CompletedPixel();
@@ -22,6 +22,7 @@
 
 #include "otbMaskedScalarImageToGreyLevelCoocurenceMatrixGenerator.h"
 #include "itkGreyLevelCooccurrenceMatrixTextureCoefficientsCalculator.h"
+#include "otbSlidingWindowGreyLevelCooccurrenceMatrix.h"
 
 namespace otb
 {
@@ -60,6 +61,13 @@ namespace otb
  * Neighborhood size can be set using the SetRadius() method. Offset for co-occurence estimation
  * is set using the SetOffset() method.
  *
+ * The co-occurence matrix is maintained incrementally by a
+ * SlidingWindowGreyLevelCooccurrenceMatrix while the window slides along the
+ * rows of the output region, which makes the cost per pixel linear in
+ * the radius instead of quadratic. Pixels whose window contains no valid
+ * co-occurence get all their textures set to 0.
+ *
+ * \sa otb::SlidingWindowGreyLevelCooccurrenceMatrix
  * \sa otb::MaskedScalarImageToGreyLevelCooccurrenceMatrixGenerator
  * \sa itk::GreyLevelCooccurrenceMatrixTextureCoefficientsCalculator
  *
@@ -103,6 +111,9 @@ public:
   typedef itk::Statistics::GreyLevelCooccurrenceMatrixTextureCoefficientsCalculator
   <HistogramType>                                                TextureCoefficientsCalculatorType;
   typedef typename TextureCoefficientsCalculatorType::Pointer TextureCoefficientsCalculatorPointerType;
+  typedef otb::SlidingWindowGreyLevelCooccurrenceMatrix<InputImageType> CooccurrenceMatrixType;
+  typedef typename CooccurrenceMatrixType::Pointer                    CooccurrenceMatrixPointerType;
+  typedef typename CooccurrenceMatrixType::HaralickTexturesType       TexturesType;
 
   /** Set the radius of the window on which textures will be computed */
   itkSetMacro(Radius, SizeType);
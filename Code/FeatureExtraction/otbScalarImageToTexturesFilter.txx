@@ -252,15 +252,16 @@ ScalarImageToTexturesFilter<TInputImage, TOutputImage>
   clusterProminenceIt.GoToBegin();
   haralickCorIt.GoToBegin();
 
-  // Build the co-occurence matrix generator
-  CoocurrenceMatrixGeneratorPointerType coOccurenceMatrixGenerator = CoocurrenceMatrixGeneratorType::New();
-  coOccurenceMatrixGenerator->SetInput(inputPtr);
-  coOccurenceMatrixGenerator->SetOffset(m_Offset);
-  coOccurenceMatrixGenerator->SetNumberOfBinsPerAxis(m_NumberOfBinsPerAxis);
-  coOccurenceMatrixGenerator->SetPixelValueMinMax(m_InputImageMinimum, m_InputImageMaximum);
-
-  // Build the texture calculator
-  TextureCoefficientsCalculatorPointerType texturesCalculator = TextureCoefficientsCalculatorType::New();
+  // Build the sliding window co-occurence matrix. The window is slid
+  // along the rows of the output region, which allows incremental updates.
+  CooccurrenceMatrixPointerType cooccurrenceMatrix = CooccurrenceMatrixType::New();
+  cooccurrenceMatrix->SetInput(inputPtr);
+  cooccurrenceMatrix->SetRegion(inputPtr->GetRequestedRegion());
+  cooccurrenceMatrix->SetRadius(m_Radius);
+  cooccurrenceMatrix->SetOffset(m_Offset);
+  cooccurrenceMatrix->SetNumberOfBinsPerAxis(m_NumberOfBinsPerAxis);
+  cooccurrenceMatrix->SetPixelValueMinMax(m_InputImageMinimum, m_InputImageMaximum);
+  cooccurrenceMatrix->Initialize();
 
   // Set-up progress reporting
   itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels());
@@ -275,39 +276,21 @@ ScalarImageToTexturesFilter<TInputImage, TOutputImage>
          && !clusterProminenceIt.IsAtEnd()
          && !haralickCorIt.IsAtEnd())
     {
-    // Compute the region on which co-occurence will be estimated
-    typename InputRegionType::IndexType inputIndex = energyIt.GetIndex() - m_Radius;
-    typename InputRegionType::SizeType  inputSize;
-
-    // First, apply offset
-    for (unsigned int dim = 0; dim < InputImageType::ImageDimension; ++dim)
-      {
-      inputSize[dim] = 2 * m_Radius[dim] + 1;
-      }
-
-    // Build the input  region
-    InputRegionType inputRegion;
-    inputRegion.SetIndex(inputIndex);
-    inputRegion.SetSize(inputSize);
-
-    // Compute the co-occurence matrix
-    coOccurenceMatrixGenerator->SetRegion(inputRegion);
-    coOccurenceMatrixGenerator->SetNormalize(true);
-    coOccurenceMatrixGenerator->Compute();
+    // Update the co-occurence matrix for the window centered on the current pixel
+    cooccurrenceMatrix->SetCenter(energyIt.GetIndex());
 
     // Compute textures indices
-    texturesCalculator->SetHistogram(coOccurenceMatrixGenerator->GetOutput());
-    texturesCalculator->Compute();
+    TexturesType textures = cooccurrenceMatrix->ComputeHaralickTextures();
 
     // Fill outputs
-    energyIt.Set(texturesCalculator->GetEnergy());
-    entropyIt.Set(texturesCalculator->GetEntropy());
-    correlationIt.Set(texturesCalculator->GetCorrelation());
-    invDiffMomentIt.Set(texturesCalculator->GetInverseDifferenceMoment());
-    inertiaIt.Set(texturesCalculator->GetInertia());
-    clusterShadeIt.Set(texturesCalculator->GetClusterShade());
-    clusterProminenceIt.Set(texturesCalculator->GetClusterProminence());
-    haralickCorIt.Set(texturesCalculator->GetHaralickCorrelation());
+    energyIt.Set(static_cast<typename OutputImageType::PixelType>(textures[0]));
+    entropyIt.Set(static_cast<typename OutputImageType::PixelType>(textures[1]));
+    correlationIt.Set(static_cast<typename OutputImageType::PixelType>(textures[2]));
+    invDiffMomentIt.Set(static_cast<typename OutputImageType::PixelType>(textures[3]));
+    inertiaIt.Set(static_cast<typename OutputImageType::PixelType>(textures[4]));
+    clusterShadeIt.Set(static_cast<typename OutputImageType::PixelType>(textures[5]));
+    clusterProminenceIt.Set(static_cast<typename OutputImageType::PixelType>(textures[6]));
+    haralickCorIt.Set(static_cast<typename OutputImageType::PixelType>(textures[7]));
 
     // Update progress
     progress.CompletedPixel();
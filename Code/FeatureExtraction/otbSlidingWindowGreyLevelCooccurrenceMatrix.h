@@ -0,0 +1,194 @@
+/*=========================================================================
+
+ Program:   ORFEO Toolbox
+ Language:  C++
+ Date:      $Date$
+ Version:   $Revision$
+
+
+ Copyright (c) Centre National d'Etudes Spatiales. All rights reserved.
+ See OTBCopyright.txt for details.
+
+
+ This software is distributed WITHOUT ANY WARRANTY; without even
+ the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ PURPOSE.  See the above copyright notices for more information.
+
+ =========================================================================*/
+#ifndef __otbSlidingWindowGreyLevelCooccurrenceMatrix_h
+#define __otbSlidingWindowGreyLevelCooccurrenceMatrix_h
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "itkFixedArray.h"
+#include "itkNumericTraits.h"
+#include <vector>
+
+namespace otb
+{
+/** \class SlidingWindowGreyLevelCooccurrenceMatrix
+ *  \brief Incremental dense grey-level co-occurrence matrix over a sliding window.
+ *
+ *  This class maintains the symmetric co-occurrence matrix of the pixels of a
+ *  window of radius Radius centered on a given index, with the same pair
+ *  definition as itk::Statistics::ScalarImageToGreyLevelCooccurrenceMatrixGenerator
+ *  used through otb::MaskedScalarImageToGreyLevelCooccurrenceMatrixGenerator:
+ *  each pixel p of the window (cropped to the Region) whose value lies in
+ *  [min, max] is paired with p + Offset if this pixel lies in the buffered
+ *  region of the input and in [min, max], and both (i, j) and (j, i) bins
+ *  are incremented. Bin boundaries are those of the itk::Statistics::Histogram.
+ *
+ *  The matrix is stored as a dense array of NumberOfBinsPerAxis^2 counts.
+ *  When SetCenter() is called with the index following the previous center
+ *  along the first dimension, the matrix is updated by removing the pairs of
+ *  the leaving column and adding those of the entering column, so that
+ *  scanning a region row by row costs O(radius) per pixel instead of
+ *  O(radius^2). Any other move rebuilds the matrix from scratch.
+ *
+ *  The Haralick textures (as computed by
+ *  itk::Statistics::GreyLevelCooccurrenceMatrixTextureCoefficientsCalculator)
+ *  and the advanced textures (as computed by
+ *  otb::GreyLevelCooccurrenceMatrixAdvancedTextureCoefficientsCalculator) can be
+ *  computed directly from the dense matrix, without building any histogram.
+ *  If the window contains no valid pair, all textures are set to 0.
+ *
+ *  This class is not thread safe: each thread must use its own instance.
+ *
+ * \sa ScalarImageToTexturesFilter
+ * \sa ScalarImageToAdvancedTexturesFilter
+ * \sa HaralickTexturesImageFunction
+ */
+template <class TImage>
+class ITK_EXPORT SlidingWindowGreyLevelCooccurrenceMatrix : public itk::Object
+{
+public:
+  /** Standard class typedefs */
+  typedef SlidingWindowGreyLevelCooccurrenceMatrix Self;
+  typedef itk::Object                              Superclass;
+  typedef itk::SmartPointer<Self>                  Pointer;
+  typedef itk::SmartPointer<const Self>            ConstPointer;
+
+  /** Creation through the object factory */
+  itkNewMacro(Self);
+
+  /** RTTI */
+  itkTypeMacro(SlidingWindowGreyLevelCooccurrenceMatrix, itk::Object);
+
+  /** Image typedefs */
+  typedef TImage                                              ImageType;
+  typedef typename ImageType::PixelType                       PixelType;
+  typedef typename ImageType::RegionType                      RegionType;
+  typedef typename ImageType::IndexType                       IndexType;
+  typedef typename ImageType::SizeType                        SizeType;
+  typedef typename ImageType::OffsetType                      OffsetType;
+  typedef typename itk::NumericTraits<PixelType>::RealType    MeasurementType;
+
+  itkStaticConstMacro(ImageDimension, unsigned int, ImageType::ImageDimension);
+
+  /** Textures typedefs */
+  typedef itk::FixedArray<double, 8> HaralickTexturesType;
+  typedef itk::FixedArray<double, 9> AdvancedTexturesType;
+
+  /** Set/Get the input image */
+  itkSetConstObjectMacro(Input, ImageType);
+  itkGetConstObjectMacro(Input, ImageType);
+
+  /** Set/Get the region to which the windows are cropped (usually
+   *  the requested region of the input) */
+  itkSetMacro(Region, RegionType);
+  itkGetConstReferenceMacro(Region, RegionType);
+
+  /** Set/Get the radius of the window */
+  itkSetMacro(Radius, SizeType);
+  itkGetConstReferenceMacro(Radius, SizeType);
+
+  /** Set/Get the co-occurrence offset */
+  itkSetMacro(Offset, OffsetType);
+  itkGetConstReferenceMacro(Offset, OffsetType);
+
+  /** Set/Get the number of bins per axis */
+  itkSetMacro(NumberOfBinsPerAxis, unsigned int);
+  itkGetMacro(NumberOfBinsPerAxis, unsigned int);
+
+  /** Set the range of pixel values taken into account */
+  void SetPixelValueMinMax(PixelType min, PixelType max);
+  itkGetMacro(Min, PixelType);
+  itkGetMacro(Max, PixelType);
+
+  /** Allocate the matrix and compute the bin boundaries. Must be
+   *  called once parameters are set, before the first SetCenter(). */
+  void Initialize();
+
+  /** Move the window to the given center, incrementally if possible */
+  void SetCenter(const IndexType& center);
+
+  /** Get the number of co-occurrences in bin (i, j) */
+  unsigned long GetFrequency(unsigned int i, unsigned int j) const
+  {
+    return m_Counts[i + j * m_NumberOfBinsPerAxis];
+  }
+
+  /** Get the total number of co-occurrences in the window */
+  itkGetConstMacro(TotalFrequency, unsigned long);
+
+  /** Compute the 8 Haralick textures, in the order of the outputs of
+   *  ScalarImageToTexturesFilter: energy, entropy, correlation,
+   *  inverse difference moment, inertia, cluster shade, cluster
+   *  prominence and Haralick correlation. */
+  HaralickTexturesType ComputeHaralickTextures() const;
+
+  /** Compute the 9 advanced textures, in the order of the outputs of
+   *  ScalarImageToAdvancedTexturesFilter: variance, mean, sum
+   *  average, sum variance, sum entropy, difference entropy, difference
+   *  variance, IC1 and IC2. */
+  AdvancedTexturesType ComputeAdvancedTextures() const;
+
+protected:
+  /** Constructor */
+  SlidingWindowGreyLevelCooccurrenceMatrix();
+  /** Destructor */
+  virtual ~SlidingWindowGreyLevelCooccurrenceMatrix() {}
+  /** PrintSelf method */
+  void PrintSelf(std::ostream& os, itk::Indent indent) const;
+
+  /** Add (increment = 1) or remove (increment = -1) the pairs whose
+   *  first pixel lies in the given region */
+  void UpdateCounts(const RegionType& region, long increment);
+
+  /** Get the bin of a pixel value, or -1 if the value is out of range */
+  int GetBin(PixelType value) const;
+
+  /** Get the normalized frequency of bin (i, j), 0 if out of range
+   *  (mimics the behaviour of the dense histogram container) */
+  double GetNormalizedFrequency(unsigned long i, unsigned long j) const;
+
+private:
+  SlidingWindowGreyLevelCooccurrenceMatrix(const Self&); //purposely not implemented
+  void operator =(const Self&); //purposely not implemented
+
+  typename ImageType::ConstPointer m_Input;
+  RegionType                       m_Region;
+  SizeType                         m_Radius;
+  OffsetType                       m_Offset;
+  unsigned int                     m_NumberOfBinsPerAxis;
+  PixelType                        m_Min;
+  PixelType                        m_Max;
+
+  /** Lower bound of each bin */
+  std::vector<MeasurementType> m_BinMin;
+
+  /** Dense co-occurrence counts, bin (i, j) stored at i + j * nbBins */
+  std::vector<unsigned long> m_Counts;
+  unsigned long              m_TotalFrequency;
+
+  /** Current center, and whether the matrix is valid for it */
+  IndexType m_Center;
+  bool      m_IsCenterValid;
+};
+} // End namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbSlidingWindowGreyLevelCooccurrenceMatrix.txx"
+#endif
+
+#endif
@@ -0,0 +1,475 @@
+/*=========================================================================
+
+ Program:   ORFEO Toolbox
+ Language:  C++
+ Date:      $Date$
+ Version:   $Revision$
+
+
+ Copyright (c) Centre National d'Etudes Spatiales. All rights reserved.
+ See OTBCopyright.txt for details.
+
+
+ This software is distributed WITHOUT ANY WARRANTY; without even
+ the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ PURPOSE.  See the above copyright notices for more information.
+
+ =========================================================================*/
+#ifndef __otbSlidingWindowGreyLevelCooccurrenceMatrix_txx
+#define __otbSlidingWindowGreyLevelCooccurrenceMatrix_txx
+
+#include "otbSlidingWindowGreyLevelCooccurrenceMatrix.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "vnl/vnl_math.h"
+#include <algorithm>
+
+namespace otb
+{
+template <class TImage>
+SlidingWindowGreyLevelCooccurrenceMatrix<TImage>
+::SlidingWindowGreyLevelCooccurrenceMatrix() : m_Input(),
+  m_Region(),
+  m_Radius(),
+  m_Offset(),
+  m_NumberOfBinsPerAxis(8),
+  m_Min(itk::NumericTraits<PixelType>::NonpositiveMin()),
+  m_Max(itk::NumericTraits<PixelType>::max()),
+  m_BinMin(),
+  m_Counts(),
+  m_TotalFrequency(0),
+  m_Center(),
+  m_IsCenterValid(false)
+{
+  m_Radius.Fill(0);
+  m_Offset.Fill(0);
+  m_Center.Fill(0);
+}
+
+template <class TImage>
+void
+SlidingWindowGreyLevelCooccurrenceMatrix<TImage>
+::SetPixelValueMinMax(PixelType min, PixelType max)
+{
+  m_Min = min;
+  m_Max = max;
+  m_IsCenterValid = false;
+  this->Modified();
+}
+
+template <class TImage>
+void
+SlidingWindowGreyLevelCooccurrenceMatrix<TImage>
+::Initialize()
+{
+  if (m_NumberOfBinsPerAxis == 0)
+    {
+    itkExceptionMacro(<< "The number of bins per axis must be strictly positive.");
+    }
+
+  // Same bin boundaries as itk::Statistics::Histogram::Initialize(),
+  // with the bounds set by the co-occurrence matrix generator
+  const MeasurementType lowerBound = m_Min;
+  const MeasurementType upperBound = m_Max + 1;
+  const double interval = static_cast<double>(upperBound - lowerBound)
+                          / static_cast<MeasurementType>(m_NumberOfBinsPerAxis);
+
+  m_BinMin.resize(m_NumberOfBinsPerAxis);
+  for (unsigned int j = 0; j < m_NumberOfBinsPerAxis; ++j)
+    {
+    m_BinMin[j] = static_cast<MeasurementType>(lowerBound + static_cast<double>(j) * interval);
+    }
+
+  m_Counts.assign(m_NumberOfBinsPerAxis * m_NumberOfBinsPerAxis, 0);
+  m_TotalFrequency = 0;
+  m_IsCenterValid = false;
+}
+
+template <class TImage>
+int
+SlidingWindowGreyLevelCooccurrenceMatrix<TImage>
+::GetBin(PixelType value) const
+{
+  if (value < m_Min || value > m_Max)
+    {
+    return -1;
+    }
+
+  const MeasurementType measurement = static_cast<MeasurementType>(value);
+
+  // Direct estimate, then adjusted against the actual bin boundaries
+  const double interval = (m_NumberOfBinsPerAxis > 1) ?
+                          static_cast<double>(m_BinMin[1] - m_BinMin[0]) : 1.;
+  int bin = static_cast<int>((measurement - m_BinMin[0]) / interval);
+  bin = std::max(0, std::min(bin, static_cast<int>(m_NumberOfBinsPerAxis) - 1));
+
+  while (bin > 0 && measurement < m_BinMin[bin])
+    {
+    --bin;
+    }
+  while (bin < static_cast<int>(m_NumberOfBinsPerAxis) - 1 && measurement >= m_BinMin[bin + 1])
+    {
+    ++bin;
+    }
+  return bin;
+}
+
+template <class TImage>
+void
+SlidingWindowGreyLevelCooccurrenceMatrix<TImage>
+::UpdateCounts(const RegionType& region, long increment)
+{
+  const RegionType& bufferedRegion = m_Input->GetBufferedRegion();
+
+  itk::ImageRegionConstIteratorWithIndex<ImageType> it(m_Input, region);
+
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+    const int centerBin = this->GetBin(it.Get());
+    if (centerBin < 0)
+      {
+      continue;
+      }
+
+    const IndexType pairIndex = it.GetIndex() + m_Offset;
+    if (!bufferedRegion.IsInside(pairIndex))
+      {
+      continue;
+      }
+
+    const int pairBin = this->GetBin(m_Input->GetPixel(pairIndex));
+    if (pairBin < 0)
+      {
+      continue;
+      }
+
+    // Both co-occurrence combinations are accounted for
+    const unsigned long id1 = centerBin + pairBin * m_NumberOfBinsPerAxis;
+    const unsigned long id2 = pairBin + centerBin * m_NumberOfBinsPerAxis;
+    if (increment > 0)
+      {
+      ++m_Counts[id1];
+      ++m_Counts[id2];
+      m_TotalFrequency += 2;
+      }
+    else
+      {
+      --m_Counts[id1];
+      --m_Counts[id2];
+      m_TotalFrequency -= 2;
+      }
+    }
+}
+
+template <class TImage>
+void
+SlidingWindowGreyLevelCooccurrenceMatrix<TImage>
+::SetCenter(const IndexType& center)
+{
+  if (m_Counts.size() != m_NumberOfBinsPerAxis * m_NumberOfBinsPerAxis)
+    {
+    this->Initialize();
+    }
+
+  // Check if the window moved by one pixel along the first dimension
+  bool slide = m_IsCenterValid && (center[0] == m_Center[0] + 1);
+  for (unsigned int dim = 1; dim < ImageDimension && slide; ++dim)
+    {
+    slide = (center[dim] == m_Center[dim]);
+    }
+
+  IndexType windowIndex;
+  SizeType  windowSize;
+  for (unsigned int dim = 0; dim < ImageDimension; ++dim)
+    {
+    windowIndex[dim] = center[dim] - static_cast<long>(m_Radius[dim]);
+    windowSize[dim] = 2 * m_Radius[dim] + 1;
+    }
+
+  if (slide)
+    {
+    // Remove the leaving column, add the entering one
+    RegionType column;
+    IndexType  columnIndex = windowIndex;
+    SizeType   columnSize = windowSize;
+    columnSize[0] = 1;
+
+    columnIndex[0] = m_Center[0] - static_cast<long>(m_Radius[0]);
+    column.SetIndex(columnIndex);
+    column.SetSize(columnSize);
+    if (column.Crop(m_Region))
+      {
+      this->UpdateCounts(column, -1);
+      }
+
+    columnIndex[0] = center[0] + static_cast<long>(m_Radius[0]);
+    column.SetIndex(columnIndex);
+    column.SetSize(columnSize);
+    if (column.Crop(m_Region))
+      {
+      this->UpdateCounts(column, 1);
+      }
+    }
+  else
+    {
+    // Rebuild the matrix from scratch
+    std::fill(m_Counts.begin(), m_Counts.end(), 0);
+    m_TotalFrequency = 0;
+
+    RegionType window;
+    window.SetIndex(windowIndex);
+    window.SetSize(windowSize);
+    if (window.Crop(m_Region))
+      {
+      this->UpdateCounts(window, 1);
+      }
+    }
+
+  m_Center = center;
+  m_IsCenterValid = true;
+}
+
+template <class TImage>
+double
+SlidingWindowGreyLevelCooccurrenceMatrix<TImage>
+::GetNormalizedFrequency(unsigned long i, unsigned long j) const
+{
+  const unsigned long id = i + j * m_NumberOfBinsPerAxis;
+  if (id >= m_Counts.size())
+    {
+    return 0.;
+    }
+  return static_cast<double>(m_Counts[id]) / static_cast<double>(m_TotalFrequency);
+}
+
+template <class TImage>
+typename SlidingWindowGreyLevelCooccurrenceMatrix<TImage>::HaralickTexturesType
+SlidingWindowGreyLevelCooccurrenceMatrix<TImage>
+::ComputeHaralickTextures() const
+{
+  HaralickTexturesType textures;
+  textures.Fill(0.);
+
+  if (m_TotalFrequency == 0)
+    {
+    return textures;
+    }
+
+  const unsigned int nbBins = m_NumberOfBinsPerAxis;
+
+  // Pixel mean and marginal sums
+  std::vector<double> marginalSums(nbBins, 0.);
+  double pixelMean = 0;
+  for (unsigned int j = 0; j < nbBins; ++j)
+    {
+    for (unsigned int i = 0; i < nbBins; ++i)
+      {
+      const double frequency = this->GetNormalizedFrequency(i, j);
+      pixelMean += i * frequency;
+      marginalSums[i] += frequency;
+      }
+    }
+
+  // Mean and deviation of the marginal sums, with the same incremental
+  // scheme as the itk calculator
+  double marginalMean = marginalSums[0];
+  double marginalDevSquared = 0;
+  for (unsigned int arrayIndex = 1; arrayIndex < nbBins; ++arrayIndex)
+    {
+    int    k = arrayIndex + 1;
+    double M_k_minus_1 = marginalMean;
+    double S_k_minus_1 = marginalDevSquared;
+    double x_k = marginalSums[arrayIndex];
+
+    double M_k = M_k_minus_1 + (x_k - M_k_minus_1) / k;
+    double S_k = S_k_minus_1 + (x_k - M_k_minus_1) * (x_k - M_k);
+
+    marginalMean = M_k;
+    marginalDevSquared = S_k;
+    }
+  marginalDevSquared = marginalDevSquared / nbBins;
+
+  double pixelVariance = 0;
+  for (unsigned int j = 0; j < nbBins; ++j)
+    {
+    for (unsigned int i = 0; i < nbBins; ++i)
+      {
+      pixelVariance += (i - pixelMean) * (i - pixelMean) * this->GetNormalizedFrequency(i, j);
+      }
+    }
+
+  double pixelVarianceSquared = pixelVariance * pixelVariance;
+  // Avoid NaN correlation for constant windows
+  if (pixelVarianceSquared < 0.0001)
+    {
+    pixelVarianceSquared = 1.;
+    }
+
+  double energy = 0, entropy = 0, correlation = 0, inverseDifferenceMoment = 0;
+  double inertia = 0, clusterShade = 0, clusterProminence = 0, haralickCorrelation = 0;
+  const double log2 = vcl_log(2.);
+
+  for (unsigned int j = 0; j < nbBins; ++j)
+    {
+    for (unsigned int i = 0; i < nbBins; ++i)
+      {
+      const double frequency = this->GetNormalizedFrequency(i, j);
+      if (frequency == 0)
+        {
+        continue;
+        }
+      const double di = static_cast<double>(i);
+      const double dj = static_cast<double>(j);
+      const double sum = (di - pixelMean) + (dj - pixelMean);
+
+      energy += frequency * frequency;
+      entropy -= (frequency > 0.0001) ? frequency * vcl_log(frequency) / log2 : 0;
+      correlation += ((di - pixelMean) * (dj - pixelMean) * frequency) / pixelVarianceSquared;
+      inverseDifferenceMoment += frequency / (1.0 + (di - dj) * (di - dj));
+      inertia += (di - dj) * (di - dj) * frequency;
+      clusterShade += sum * sum * sum * frequency;
+      clusterProminence += sum * sum * sum * sum * frequency;
+      haralickCorrelation += di * dj * frequency;
+      }
+    }
+
+  haralickCorrelation = (haralickCorrelation - marginalMean * marginalMean) / marginalDevSquared;
+
+  textures[0] = energy;
+  textures[1] = entropy;
+  textures[2] = correlation;
+  textures[3] = inverseDifferenceMoment;
+  textures[4] = inertia;
+  textures[5] = clusterShade;
+  textures[6] = clusterProminence;
+  textures[7] = haralickCorrelation;
+
+  return textures;
+}
+
+template <class TImage>
+typename SlidingWindowGreyLevelCooccurrenceMatrix<TImage>::AdvancedTexturesType
+SlidingWindowGreyLevelCooccurrenceMatrix<TImage>
+::ComputeAdvancedTextures() const
+{
+  AdvancedTexturesType textures;
+  textures.Fill(0.);
+
+  if (m_TotalFrequency == 0)
+    {
+    return textures;
+    }
+
+  const unsigned long nbBins = m_NumberOfBinsPerAxis;
+  const double log2 = vcl_log(2.);
+
+  // Marginal frequencies along each axis and pixel mean
+  std::vector<double> marginalX(nbBins, 0.);
+  std::vector<double> marginalY(nbBins, 0.);
+  double mean = 0;
+  for (unsigned long j = 0; j < nbBins; ++j)
+    {
+    for (unsigned long i = 0; i < nbBins; ++i)
+      {
+      const double frequency = this->GetNormalizedFrequency(i, j);
+      mean += i * frequency;
+      marginalX[i] += frequency;
+      marginalY[j] += frequency;
+      }
+    }
+
+  // Sum average, sum entropy and sum variance. The bounds of the sum
+  // follow otb::GreyLevelCooccurrenceMatrixAdvancedTextureCoefficientsCalculator::ComputePS(),
+  // unsigned wrap-around included, so that the texture filters keep their
+  // outputs. Out of range cells have a null frequency.
+  double sumAverage = 0, sumEntropy = 0, psSquareCumul = 0;
+  for (unsigned long k = 0; k < 2 * nbBins; ++k)
+    {
+    double ps = 0;
+    unsigned long start = std::max(static_cast<unsigned long>(0), k - nbBins);
+    unsigned long end = std::min(k, nbBins);
+    for (unsigned long i = start; i < end; ++i)
+      {
+      ps += this->GetNormalizedFrequency(i, k - i);
+      }
+
+    sumAverage += k * ps;
+    sumEntropy -= (ps > 0.0001) ? ps * vcl_log(ps) / log2 : 0;
+    psSquareCumul += k * k * ps;
+    }
+  const double sumVariance = psSquareCumul - sumAverage * sumAverage;
+
+  // Difference entropy and difference variance
+  double differenceEntropy = 0, pdSquareCumul = 0, pdCumul = 0;
+  for (unsigned long k = 0; k < nbBins; ++k)
+    {
+    double pd = 0;
+    for (unsigned long j = 0; j < nbBins - k; ++j)
+      {
+      pd += this->GetNormalizedFrequency(j + k, j);
+      }
+
+    pdCumul += k * pd;
+    differenceEntropy -= (pd > 0.0001) ? pd * vcl_log(pd) / log2 : 0;
+    pdSquareCumul += k * k * pd;
+    }
+  const double differenceVariance = pdSquareCumul - pdCumul * pdCumul;
+
+  // Information measures of correlation
+  double hx = 0, hy = 0;
+  for (unsigned long i = 0; i < nbBins; ++i)
+    {
+    hx += (marginalX[i] > 0.0001) ? vcl_log(marginalX[i]) * marginalX[i] : 0;
+    hy += (marginalY[i] > 0.0001) ? vcl_log(marginalY[i]) * marginalY[i] : 0;
+    }
+
+  double variance = 0, entropy = 0, hxy1 = 0, hxy2 = 0;
+  for (unsigned long j = 0; j < nbBins; ++j)
+    {
+    for (unsigned long i = 0; i < nbBins; ++i)
+      {
+      const double frequency = this->GetNormalizedFrequency(i, j);
+      variance += (i - mean) * (i - mean) * frequency;
+      entropy -= (frequency > 0.0001) ? frequency * vcl_log(frequency) / log2 : 0;
+
+      const double pipj = marginalX[i] * marginalY[j];
+      hxy1 -= (pipj > 0.0001) ? frequency * vcl_log(pipj) : 0;
+      hxy2 -= (pipj > 0.0001) ? pipj * vcl_log(pipj) : 0;
+      }
+    }
+
+  const double hmax = std::max(hx, hy);
+  const double ic1 = (vcl_abs(hmax) > 0.0001) ? (entropy - hxy1) / hmax : 0;
+  double ic2 = 1 - vcl_exp(-2. * vcl_abs(hxy2 - entropy));
+  ic2 = (ic2 >= 0) ? vcl_sqrt(ic2) : 0;
+
+  textures[0] = variance;
+  textures[1] = mean;
+  textures[2] = sumAverage;
+  textures[3] = sumVariance;
+  textures[4] = sumEntropy;
+  textures[5] = differenceEntropy;
+  textures[6] = differenceVariance;
+  textures[7] = ic1;
+  textures[8] = ic2;
+
+  return textures;
+}
+
+template <class TImage>
+void
+SlidingWindowGreyLevelCooccurrenceMatrix<TImage>
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Region: " << m_Region << std::endl;
+  os << indent << "Radius: " << m_Radius << std::endl;
+  os << indent << "Offset: " << m_Offset << std::endl;
+  os << indent << "NumberOfBinsPerAxis: " << m_NumberOfBinsPerAxis << std::endl;
+  os << indent << "Min: " << m_Min << std::endl;
+  os << indent << "Max: " << m_Max << std::endl;
+  os << indent << "TotalFrequency: " << m_TotalFrequency << std::endl;
+}
+
+} // End namespace otb
+
+#endif
@@ -22,6 +22,7 @@
 #define __otbStreamingLineSegmentDetector_h
 
 #include <vector>
+#include <string>
 
 #include "itkImageRegion.h"
 #include "otbVectorData.h"
@@ -46,6 +47,18 @@ namespace otb
  *  This filter is a generic PersistentImageFilter, which encapsulate
  *  the Line Segment detector filter.
  *
+ *  When TileSize is not null, each streamed region is cut into square
+ *  tiles of this size, processed independently by the filter threads.
+ *  The number of tests of the a contrario model is then computed from
+ *  the size of the whole image, so that the detection does not depend
+ *  on the tiling, and the memory used is bounded by the tile size times
+ *  the number of threads. The gradient threshold of all the tiles is
+ *  normalized with the range of the gradient modulus over the whole
+ *  image, computed tile by tile by Reset() (the decorator calls it before
+ *  streaming; without Reset(), each tile uses its own range). The
+ *  segments cut by the tiles are fused with MergeSeams: without it, a
+ *  segment crossing a tile border is reported once per tile it crosses.
+ *
  * \sa PersistentImageToVectorDataFilter
  *
  */
@@ -63,8 +76,10 @@ public:
   typedef itk::SmartPointer<const Self>                                       ConstPointer;
 
   typedef otb::LineSegmentDetector<TImageType, double>     LSDType;
+  typedef typename LSDType::Pointer                        LSDPointerType;
   typedef typename Superclass::InputImageType              InputImageType;
   typedef typename Superclass::InputImagePointer           InputImagePointerType;
+  typedef typename Superclass::RegionType                  RegionType;
 
   typedef typename Superclass::OutputVectorDataType        OutputVectorDataType;
   typedef typename Superclass::OutputVectorDataPointerType OutputVectorDataPointerType;
@@ -75,6 +90,20 @@ public:
   /** Runtime information support. */
   itkTypeMacro(PersistentStreamingLineSegmentDetector, PersistentImageToVectorDataFilter);
 
+  /** Set/Get the size of the tiles processed in parallel (0, the
+   * default, processes each streamed region as a whole) */
+  itkSetMacro(TileSize, unsigned int);
+  itkGetMacro(TileSize, unsigned int);
+
+  /** Range of the gradient modulus over the whole image, computed by
+   * Reset() when TileSize is not null */
+  itkGetMacro(ModulusMinimum, double);
+  itkGetMacro(ModulusMaximum, double);
+
+  /** Reset the output and, when TileSize is not null, compute the range
+   * of the gradient modulus over the input */
+  virtual void Reset(void);
+
 protected:
   PersistentStreamingLineSegmentDetector();
 
@@ -82,11 +111,43 @@ protected:
 
   void GenerateInputRequestedRegion();
 
+  virtual void ProcessTiles(std::vector<RegionType>& regions,
+                            std::vector<OutputVectorDataPointerType>& tilesVectorData);
+
+  void PrintSelf(std::ostream& os, itk::Indent indent) const;
+
+  /** Compute the range of the gradient modulus of the input, tile by tile */
+  void ComputeModulusRange();
+
+  /** Run the detectors of the tiles handled by a thread */
+  void ThreadedDetection(unsigned int threadId, unsigned int threadCount);
+
+  /** Static function used as a "callback" by the MultiThreader. */
+  static ITK_THREAD_RETURN_TYPE ThreaderCallback(void *arg);
+
+  /** Internal structure used for passing image data into the threading library */
+  struct ThreadStruct
+  {
+    Pointer Filter;
+  };
+
 private:
   PersistentStreamingLineSegmentDetector(const Self &); //purposely not implemented
   void operator =(const Self&); //purposely not implemented
 
   virtual OutputVectorDataPointerType ProcessTile();
+
+  unsigned int m_TileSize;
+
+  /** Gradient modulus range over the image (maximum lower than minimum
+   * while it is not computed) */
+  double m_ModulusMinimum;
+  double m_ModulusMaximum;
+
+  /** Tiles of the current streamed region and their segments */
+  std::vector<RegionType>                  m_Tiles;
+  std::vector<OutputVectorDataPointerType> m_TilesVectorData;
+  std::vector<std::string>                 m_TileErrors;
 };
 
 template <class TImageType>
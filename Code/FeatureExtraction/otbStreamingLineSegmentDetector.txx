@@ -23,8 +23,13 @@
 
 #include "otbStreamingLineSegmentDetector.h"
 
+#include <algorithm>
+
 #include "otbVectorDataTransformFilter.h"
 #include "itkAffineTransform.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+#include "itkCastImageFilter.h"
 
 namespace otb
 {
@@ -32,6 +37,7 @@ namespace otb
 template<class TInputImage>
 PersistentStreamingLineSegmentDetector<TInputImage>
 ::PersistentStreamingLineSegmentDetector()
+  : m_TileSize(0), m_ModulusMinimum(0.), m_ModulusMaximum(-1.)
 {
 }
 
@@ -61,6 +67,88 @@ PersistentStreamingLineSegmentDetector<TInputImage>
     }
 }
 
+template<class TInputImage>
+void
+PersistentStreamingLineSegmentDetector<TInputImage>
+::Reset()
+{
+  Superclass::Reset();
+
+  m_ModulusMinimum = 0.;
+  m_ModulusMaximum = -1.;
+  if (m_TileSize != 0 && this->GetInput())
+    {
+    this->ComputeModulusRange();
+    }
+}
+
+template<class TInputImage>
+void
+PersistentStreamingLineSegmentDetector<TInputImage>
+::ComputeModulusRange()
+{
+  typedef typename LSDType::OutputImageType                       ModulusInputImageType;
+  typedef itk::CastImageFilter<InputImageType, ModulusInputImageType>  CastFilterType;
+  typedef typename Superclass::ExtractImageFilterType             ExtractFilterType;
+  typedef typename LSDType::GradientFilterType                    GradientFilterType;
+  typedef typename LSDType::MagnitudeFilterType                   MagnitudeFilterType;
+  typedef typename LSDType::MagnitudeImageType                    MagnitudeImageType;
+
+  InputImagePointerType input = const_cast<InputImageType *>(this->GetInput());
+  input->UpdateOutputInformation();
+  const RegionType largestRegion = input->GetLargestPossibleRegion();
+
+  double min = itk::NumericTraits<double>::max();
+  double max = itk::NumericTraits<double>::NonpositiveMin();
+
+  // Same tiles and margin as the detection, so that the memory stays
+  // bounded by the tile size
+  for (unsigned long y = 0; y < largestRegion.GetSize()[1]; y += m_TileSize)
+    {
+    for (unsigned long x = 0; x < largestRegion.GetSize()[0]; x += m_TileSize)
+      {
+      typename RegionType::IndexType index = largestRegion.GetIndex();
+      typename RegionType::SizeType  size;
+      index[0] += x;
+      index[1] += y;
+      size[0] = std::min(static_cast<unsigned long>(m_TileSize), largestRegion.GetSize()[0] - x);
+      size[1] = std::min(static_cast<unsigned long>(m_TileSize), largestRegion.GetSize()[1] - y);
+      RegionType padded(index, size);
+      padded.PadByRadius(1);
+      padded.Crop(largestRegion);
+
+      typename ExtractFilterType::Pointer extract = ExtractFilterType::New();
+      extract->SetInput(input);
+      extract->SetExtractionRegion(padded);
+
+      typename CastFilterType::Pointer cast = CastFilterType::New();
+      cast->SetInput(extract->GetOutput());
+
+      typename GradientFilterType::Pointer gradient = GradientFilterType::New();
+      gradient->SetInput(cast->GetOutput());
+      gradient->SetSigma(0.6);
+
+      typename MagnitudeFilterType::Pointer magnitude = MagnitudeFilterType::New();
+      magnitude->SetInput(gradient->GetOutput());
+      magnitude->Update();
+
+      itk::ImageRegionConstIterator<MagnitudeImageType> it(magnitude->GetOutput(),
+                                                           magnitude->GetOutput()->GetBufferedRegion());
+      for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+        {
+        min = std::min(min, static_cast<double>(it.Get()));
+        max = std::max(max, static_cast<double>(it.Get()));
+        }
+      }
+    }
+
+  if (max >= min)
+    {
+    m_ModulusMinimum = min;
+    m_ModulusMaximum = max;
+    }
+}
+
 template<class TInputImage>
 typename PersistentStreamingLineSegmentDetector<TInputImage>::OutputVectorDataPointerType
 PersistentStreamingLineSegmentDetector<TInputImage>
@@ -86,6 +174,150 @@ PersistentStreamingLineSegmentDetector<TInputImage>
   return lsd->GetOutput();
 }
 
+template<class TInputImage>
+void
+PersistentStreamingLineSegmentDetector<TInputImage>
+::ProcessTiles(std::vector<RegionType>& regions, std::vector<OutputVectorDataPointerType>& tilesVectorData)
+{
+  if (m_TileSize == 0)
+    {
+    Superclass::ProcessTiles(regions, tilesVectorData);
+    return;
+    }
+
+  // Cut the streamed region into tiles
+  const RegionType streamRegion = this->GetOutput()->GetRequestedRegion();
+  m_Tiles.clear();
+  for (unsigned long y = 0; y < streamRegion.GetSize()[1]; y += m_TileSize)
+    {
+    for (unsigned long x = 0; x < streamRegion.GetSize()[0]; x += m_TileSize)
+      {
+      typename RegionType::IndexType index = streamRegion.GetIndex();
+      typename RegionType::SizeType  size;
+      index[0] += x;
+      index[1] += y;
+      size[0] = std::min(static_cast<unsigned long>(m_TileSize), streamRegion.GetSize()[0] - x);
+      size[1] = std::min(static_cast<unsigned long>(m_TileSize), streamRegion.GetSize()[1] - y);
+      m_Tiles.push_back(RegionType(index, size));
+      }
+    }
+
+  m_TilesVectorData.assign(m_Tiles.size(), OutputVectorDataPointerType());
+  m_TileErrors.assign(m_Tiles.size(), std::string());
+
+  // Detect the segments of the tiles in parallel
+  ThreadStruct str;
+  str.Filter = this;
+
+  this->GetMultiThreader()->SetNumberOfThreads(
+    std::min(this->GetNumberOfThreads(), static_cast<int>(m_Tiles.size())));
+  this->GetMultiThreader()->SetSingleMethod(this->ThreaderCallback, &str);
+  this->GetMultiThreader()->SingleMethodExecute();
+
+  for (unsigned int i = 0; i < m_Tiles.size(); ++i)
+    {
+    if (!m_TileErrors[i].empty())
+      {
+      m_TilesVectorData.clear();
+      itkExceptionMacro(<< "Line segment detection failed on tile " << m_Tiles[i] << ": " << m_TileErrors[i]);
+      }
+    }
+
+  // The tiles are returned in a fixed order, whatever the threads
+  regions = m_Tiles;
+  tilesVectorData = m_TilesVectorData;
+  m_TilesVectorData.clear();
+}
+
+template<class TInputImage>
+void
+PersistentStreamingLineSegmentDetector<TInputImage>
+::ThreadedDetection(unsigned int threadId, unsigned int threadCount)
+{
+  const InputImageType * input = this->GetInput();
+
+  for (unsigned int i = threadId; i < m_Tiles.size(); i += threadCount)
+    {
+    try
+      {
+      // Copy the tile and a one pixel margin (the gradient support) in an
+      // image of its own, indexed from zero: the detector then works as on
+      // a small image, the geometry being carried by the origin
+      RegionType padded = m_Tiles[i];
+      padded.PadByRadius(1);
+      padded.Crop(input->GetLargestPossibleRegion());
+
+      RegionType tileImageRegion;
+      tileImageRegion.SetSize(padded.GetSize());
+
+      typename InputImageType::PointType origin;
+      input->TransformIndexToPhysicalPoint(padded.GetIndex(), origin);
+
+      InputImagePointerType tileImage = InputImageType::New();
+      tileImage->SetRegions(tileImageRegion);
+      tileImage->SetOrigin(origin);
+      tileImage->SetSpacing(input->GetSpacing());
+      tileImage->SetMetaDataDictionary(input->GetMetaDataDictionary());
+      tileImage->Allocate();
+
+      itk::ImageRegionConstIterator<InputImageType> inIt(input, padded);
+      itk::ImageRegionIterator<InputImageType>      outIt(tileImage, tileImageRegion);
+      for (inIt.GoToBegin(), outIt.GoToBegin(); !inIt.IsAtEnd(); ++inIt, ++outIt)
+        {
+        outIt.Set(inIt.Get());
+        }
+
+      // The number of tests and the gradient range are the ones of the
+      // whole image
+      LSDPointerType lsd = LSDType::New();
+      lsd->SetInput(tileImage);
+      lsd->SetReferenceSize(input->GetLargestPossibleRegion().GetSize());
+      lsd->SetModulusMinimum(m_ModulusMinimum);
+      lsd->SetModulusMaximum(m_ModulusMaximum);
+      lsd->SetNumberOfThreads(1);
+      lsd->Update();
+
+      m_TilesVectorData[i] = lsd->GetOutput();
+      }
+    catch (itk::ExceptionObject& err)
+      {
+      m_TileErrors[i] = err.GetDescription();
+      }
+    catch (std::exception& err)
+      {
+      m_TileErrors[i] = err.what();
+      }
+    }
+}
+
+template<class TInputImage>
+ITK_THREAD_RETURN_TYPE
+PersistentStreamingLineSegmentDetector<TInputImage>
+::ThreaderCallback(void *arg)
+{
+  ThreadStruct *str;
+  int           threadId, threadCount;
+
+  threadId = ((itk::MultiThreader::ThreadInfoStruct *) (arg))->ThreadID;
+  threadCount = ((itk::MultiThreader::ThreadInfoStruct *) (arg))->NumberOfThreads;
+  str = (ThreadStruct *) (((itk::MultiThreader::ThreadInfoStruct *) (arg))->UserData);
+
+  str->Filter->ThreadedDetection(threadId, threadCount);
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template<class TInputImage>
+void
+PersistentStreamingLineSegmentDetector<TInputImage>
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "TileSize: " << m_TileSize << std::endl;
+  os << indent << "ModulusMinimum: " << m_ModulusMinimum << std::endl;
+  os << indent << "ModulusMaximum: " << m_ModulusMaximum << std::endl;
+}
+
 
 } // end namespace otb
 #endif
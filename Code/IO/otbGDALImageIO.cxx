@@ -18,6 +18,9 @@
 #include <iostream>
 #include <fstream>
 #include <vector>
+#include <map>
+#include <limits>
+#include <algorithm>
 
 #include "otbGDALImageIO.h"
 #include "otbMacro.h"
@@ -236,6 +239,218 @@ public:
   GDALDataType pixType;
 }; // end of GDALDataTypeWrapper
 
+// Averages the regions written in a dataset into its overviews as they
+// come. The overview pixels are gathered in cells: a cell is written and
+// released as soon as all the full resolution pixels it covers have been
+// received, so that only the cells along the streaming front are kept.
+class GDALOverviewsBuilder
+{
+public:
+  GDALOverviewsBuilder(GDALDataset* dataset, GDALDataType pixType, int bytePerPixel,
+                       unsigned int nbOverviews, unsigned int tileDimension)
+    : m_Dataset(dataset), m_PixType(pixType), m_BytePerPixel(bytePerPixel),
+      m_NbBands(dataset->GetRasterCount()), m_NbValues(dataset->GetRasterCount())
+  {
+    if (GDALDataTypeIsComplex(pixType))
+      {
+      m_NbValues *= 2;
+      }
+
+    const int width = dataset->GetRasterXSize();
+    const int height = dataset->GetRasterYSize();
+
+    std::vector<int> factors;
+    for (unsigned int i = 0; i < nbOverviews && (2 << i) <= std::max(width, height); ++i)
+      {
+      factors.push_back(2 << i);
+      }
+
+    // Empty overviews, filled by AddRegion()
+    if (factors.empty()
+        || dataset->BuildOverviews("NONE", factors.size(), &factors[0], 0, NULL, NULL, NULL) != CE_None
+        || dataset->GetRasterBand(1)->GetOverviewCount() != static_cast<int>(factors.size()))
+      {
+      return;
+      }
+
+    m_Levels.resize(factors.size());
+    for (unsigned int i = 0; i < factors.size(); ++i)
+      {
+      LevelType& level = m_Levels[i];
+      GDALRasterBand* overview = dataset->GetRasterBand(1)->GetOverview(i);
+      level.m_Index = i;
+      level.m_Factor = factors[i];
+      level.m_Width = overview->GetXSize();
+      level.m_Height = overview->GetYSize();
+      level.m_FullWidth = std::min(width, level.m_Width * level.m_Factor);
+      level.m_FullHeight = std::min(height, level.m_Height * level.m_Factor);
+      // Cells covering whole tiles of the dataset
+      level.m_CellDimension = std::max(static_cast<int>(tileDimension) / level.m_Factor, 16);
+      }
+  }
+
+  bool IsValid() const
+  {
+    return !m_Levels.empty();
+  }
+
+  // Add a region of the full resolution image, pixel interleaved
+  void AddRegion(const void* buffer, int firstColumn, int firstLine, int nbColumns, int nbLines)
+  {
+    switch (m_PixType)
+      {
+      case GDT_Byte:
+        this->Accumulate(static_cast<const unsigned char*>(buffer), firstColumn, firstLine, nbColumns, nbLines);
+        break;
+      case GDT_UInt16:
+        this->Accumulate(static_cast<const unsigned short*>(buffer), firstColumn, firstLine, nbColumns, nbLines);
+        break;
+      case GDT_Int16:
+      case GDT_CInt16:
+        this->Accumulate(static_cast<const short*>(buffer), firstColumn, firstLine, nbColumns, nbLines);
+        break;
+      case GDT_UInt32:
+        this->Accumulate(static_cast<const unsigned int*>(buffer), firstColumn, firstLine, nbColumns, nbLines);
+        break;
+      case GDT_Int32:
+      case GDT_CInt32:
+        this->Accumulate(static_cast<const int*>(buffer), firstColumn, firstLine, nbColumns, nbLines);
+        break;
+      case GDT_Float32:
+      case GDT_CFloat32:
+        this->Accumulate(static_cast<const float*>(buffer), firstColumn, firstLine, nbColumns, nbLines);
+        break;
+      case GDT_Float64:
+      case GDT_CFloat64:
+        this->Accumulate(static_cast<const double*>(buffer), firstColumn, firstLine, nbColumns, nbLines);
+        break;
+      default:
+        break;
+      }
+  }
+
+private:
+  struct CellType
+  {
+    int                 m_Width;
+    int                 m_Height;
+    std::vector<double> m_Sums;
+    long                m_RemainingPixels;
+  };
+  typedef std::map<std::pair<int, int>, CellType> CellMapType;
+
+  struct LevelType
+  {
+    int         m_Index;
+    int         m_Factor;
+    int         m_Width;
+    int         m_Height;
+    int         m_FullWidth;
+    int         m_FullHeight;
+    int         m_CellDimension;
+    CellMapType m_Cells;
+  };
+
+  template <class T>
+  void Accumulate(const T* buffer, int firstColumn, int firstLine, int nbColumns, int nbLines)
+  {
+    for (typename std::vector<LevelType>::iterator level = m_Levels.begin(); level != m_Levels.end(); ++level)
+      {
+      const int factor = level->m_Factor;
+      const int cellDimension = level->m_CellDimension;
+      const int footprint = cellDimension * factor;
+      const int endColumn = std::min(firstColumn + nbColumns, level->m_FullWidth);
+      const int endLine = std::min(firstLine + nbLines, level->m_FullHeight);
+
+      for (int cellY = firstLine / footprint; cellY * footprint < endLine; ++cellY)
+        {
+        for (int cellX = firstColumn / footprint; cellX * footprint < endColumn; ++cellX)
+          {
+          CellType& cell = level->m_Cells[std::make_pair(cellX, cellY)];
+          if (cell.m_Sums.empty())
+            {
+            cell.m_Width = std::min((cellX + 1) * cellDimension, level->m_Width) - cellX * cellDimension;
+            cell.m_Height = std::min((cellY + 1) * cellDimension, level->m_Height) - cellY * cellDimension;
+            cell.m_Sums.assign(cell.m_Width * cell.m_Height * m_NbValues, 0.);
+            cell.m_RemainingPixels = static_cast<long>(std::min((cellX + 1) * footprint, level->m_FullWidth)
+                                                       - cellX * footprint)
+                                     * (std::min((cellY + 1) * footprint, level->m_FullHeight) - cellY * footprint);
+            }
+
+          const int startX = std::max(firstColumn, cellX * footprint);
+          const int endX = std::min(endColumn, (cellX + 1) * footprint);
+          const int startY = std::max(firstLine, cellY * footprint);
+          const int endY = std::min(endLine, (cellY + 1) * footprint);
+
+          for (int y = startY; y < endY; ++y)
+            {
+            const T* in = buffer + (static_cast<long>(y - firstLine) * nbColumns + startX - firstColumn) * m_NbValues;
+            double*  sums = &cell.m_Sums[(y / factor - cellY * cellDimension) * cell.m_Width * m_NbValues];
+            for (int x = startX; x < endX; ++x)
+              {
+              double* pixelSums = sums + (x / factor - cellX * cellDimension) * m_NbValues;
+              for (int v = 0; v < m_NbValues; ++v, ++in)
+                {
+                pixelSums[v] += *in;
+                }
+              }
+            }
+
+          cell.m_RemainingPixels -= static_cast<long>(endX - startX) * (endY - startY);
+          if (cell.m_RemainingPixels == 0)
+            {
+            this->WriteCell<T>(*level, cellX, cellY, cell);
+            level->m_Cells.erase(std::make_pair(cellX, cellY));
+            }
+          }
+        }
+      }
+  }
+
+  template <class T>
+  void WriteCell(const LevelType& level, int cellX, int cellY, const CellType& cell)
+  {
+    const int firstColumn = cellX * level.m_CellDimension;
+    const int firstLine = cellY * level.m_CellDimension;
+
+    std::vector<T> values(cell.m_Sums.size());
+    for (int y = 0; y < cell.m_Height; ++y)
+      {
+      // Number of full resolution pixels averaged, smaller on the borders
+      const int line = (firstLine + y) * level.m_Factor;
+      const int nbLines = std::min(line + level.m_Factor, level.m_FullHeight) - line;
+      for (int x = 0; x < cell.m_Width; ++x)
+        {
+        const int column = (firstColumn + x) * level.m_Factor;
+        const double nbPixels = nbLines * (std::min(column + level.m_Factor, level.m_FullWidth) - column);
+        for (int v = 0; v < m_NbValues; ++v)
+          {
+          const unsigned int pos = (y * cell.m_Width + x) * m_NbValues + v;
+          const double average = cell.m_Sums[pos] / nbPixels;
+          values[pos] = std::numeric_limits<T>::is_integer ? static_cast<T>(vcl_floor(average + 0.5))
+                                                           : static_cast<T>(average);
+          }
+        }
+      }
+
+    for (int band = 0; band < m_NbBands; ++band)
+      {
+      GDALRasterBand* overview = m_Dataset->GetRasterBand(band + 1)->GetOverview(level.m_Index);
+      overview->RasterIO(GF_Write, firstColumn, firstLine, cell.m_Width, cell.m_Height,
+                         reinterpret_cast<char*>(&values[0]) + band * m_BytePerPixel,
+                         cell.m_Width, cell.m_Height, m_PixType,
+                         m_BytePerPixel * m_NbBands, m_BytePerPixel * m_NbBands * cell.m_Width);
+      }
+  }
+
+  GDALDataset*           m_Dataset;
+  GDALDataType           m_PixType;
+  int                    m_BytePerPixel;
+  int                    m_NbBands;
+  int                    m_NbValues;
+  std::vector<LevelType> m_Levels;
+}; // end of GDALOverviewsBuilder
+
 
 GDALImageIO::GDALImageIO()
 {
@@ -259,6 +474,8 @@ GDALImageIO::GDALImageIO()
 
   m_IsIndexed   = false;
   m_DatasetNumber = 0;
+  m_NumberOfOverviews = 0;
+  m_BlockSize = 0;
   //m_poBands     = NULL;
   //m_hDriver     = NULL;
   //m_poDataset   = NULL;
@@ -271,10 +488,12 @@ GDALImageIO::GDALImageIO()
   m_IsVectorImage = false;
 
   m_PxType = new GDALDataTypeWrapper;
+  m_OverviewsBuilder = NULL;
 }
 
 GDALImageIO::~GDALImageIO()
 {
+  delete m_OverviewsBuilder;
   delete m_PxType;
 }
 
@@ -298,6 +517,8 @@ void GDALImageIO::PrintSelf(std::ostream& os, itk::Indent indent) const
   os << indent << "Compression Level : " << m_CompressionLevel << "\n";
   os << indent << "IsComplex (otb side) : " << m_IsComplex << "\n";
   os << indent << "Byte per pixel : " << m_BytePerPixel << "\n";
+  os << indent << "Number of overviews : " << m_NumberOfOverviews << "\n";
+  os << indent << "Block size : " << m_BlockSize << "\n";
 }
 
 // Read a 3D image (or event more bands)... not implemented yet
@@ -1196,6 +1417,13 @@ void GDALImageIO::Write(const void* buffer)
       {
       itkExceptionMacro(<< "Error while writing image (GDAL format) " << m_FileName.c_str() << ".");
       }
+
+    // Average the region into the overviews
+    if (m_OverviewsBuilder != NULL)
+      {
+      m_OverviewsBuilder->AddRegion(buffer, lFirstColumn, lFirstLine, lNbColumns, lNbLines);
+      }
+
     // Flush dataset cache
     m_Dataset->GetDataSet()->FlushCache();
     }
@@ -1335,6 +1563,7 @@ void GDALImageIO::InternalWriteImageInformation(const void* buffer)
 
   if (m_CanStreamWrite)
     {
+    unsigned int tileDimension = 0;
 
     // Force tile mode for TIFF format. Tile mode is a lot more
     // efficient when writing huge tiffs
@@ -1343,15 +1572,26 @@ void GDALImageIO::InternalWriteImageInformation(const void* buffer)
       otbMsgDevMacro(<< "Enabling TIFF Tiled mode")
       papszOptions = CSLAddNameValue( papszOptions, "TILED", "YES" );
 
-      // Use a fixed tile size
-      // Take as reference is a 256*256 short int 4 bands tile
-      const unsigned int ReferenceTileSizeInBytes = 256 * 256 * 4 * 2;
+      if (m_BlockSize > 0 && m_BlockSize % 16 == 0)
+        {
+        // Largest tile dividing the written blocks, so that no tile is
+        // written twice (multiple of 16, needed by TIFF spec)
+        for (tileDimension = std::min(m_BlockSize, 512U); m_BlockSize % tileDimension != 0; tileDimension -= 16)
+          {
+          }
+        }
+      else
+        {
+        // Use a fixed tile size
+        // Take as reference is a 256*256 short int 4 bands tile
+        const unsigned int ReferenceTileSizeInBytes = 256 * 256 * 4 * 2;
 
-      unsigned int nbPixelPerTile = ReferenceTileSizeInBytes / m_BytePerPixel / m_NbBands;
-      unsigned int tileDimension = static_cast<unsigned int>( vcl_sqrt(static_cast<float>(nbPixelPerTile)) );
+        unsigned int nbPixelPerTile = ReferenceTileSizeInBytes / m_BytePerPixel / m_NbBands;
+        tileDimension = static_cast<unsigned int>( vcl_sqrt(static_cast<float>(nbPixelPerTile)) );
 
-      // align the tile dimension to the next multiple of 16 (needed by TIFF spec)
-      tileDimension = ( tileDimension + 15 ) / 16 * 16;
+        // align the tile dimension to the next multiple of 16 (needed by TIFF spec)
+        tileDimension = ( tileDimension + 15 ) / 16 * 16;
+        }
 
       otbMsgDevMacro(<< "Tile dimension : " << tileDimension << " * " << tileDimension)
 
@@ -1367,6 +1607,24 @@ void GDALImageIO::InternalWriteImageInformation(const void* buffer)
                      m_Dimensions[0], m_Dimensions[1],
                      m_NbBands, m_PxType->pixType,
                      papszOptions);
+
+    // Overviews averaged from the written regions
+    delete m_OverviewsBuilder;
+    m_OverviewsBuilder = NULL;
+    if (m_NumberOfOverviews > 0 && m_Dataset.IsNotNull())
+      {
+      if (driverShortName.compare("GTiff") == 0)
+        {
+        m_OverviewsBuilder = new GDALOverviewsBuilder(m_Dataset->GetDataSet(), m_PxType->pixType, m_BytePerPixel,
+                                                      m_NumberOfOverviews, tileDimension);
+        }
+      if (m_OverviewsBuilder == NULL || !m_OverviewsBuilder->IsValid())
+        {
+        itkWarningMacro(<< "Unable to write the overviews of " << m_FileName);
+        delete m_OverviewsBuilder;
+        m_OverviewsBuilder = NULL;
+        }
+      }
     }
   else
     {
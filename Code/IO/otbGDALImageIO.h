@@ -29,6 +29,7 @@ namespace otb
 {
 class GDALDatasetWrapper;
 class GDALDataTypeWrapper;
+class GDALOverviewsBuilder;
 
 /** \class GDALImageIO
  *
@@ -36,6 +37,13 @@ class GDALDataTypeWrapper;
  *
  * The streaming read is implemented.
  *
+ * When writing a GeoTIFF, internal overviews (reduced resolution levels
+ * by factors 2, 4, 8...) can be requested with SetNumberOfOverviews().
+ * They are averaged from the regions given to Write() as they come, so
+ * that the file does not have to be read again to build them. The tiles
+ * of the GeoTIFF are chosen to divide BlockSize when it is set, so that
+ * the streamed tiles of this size cover whole GeoTIFF tiles.
+ *
  * \ingroup IOFilters
  *
  */
@@ -73,6 +81,16 @@ public:
   itkSetMacro(DatasetNumber, unsigned int);
   itkGetMacro(DatasetNumber, unsigned int);
 
+  /** Set/Get the number of overviews written along with a GeoTIFF
+   *  (0 = none, default) */
+  itkSetMacro(NumberOfOverviews, unsigned int);
+  itkGetMacro(NumberOfOverviews, unsigned int);
+
+  /** Set/Get the dimension of the square blocks given to Write(), used
+   *  to choose the GeoTIFF tile size (0 = automatic tile size, default) */
+  itkSetMacro(BlockSize, unsigned int);
+  itkGetMacro(BlockSize, unsigned int);
+
   /*-------- This part of the interface deals with reading data. ------ */
 
   /** Determine the file type. Returns true if this ImageIO can read the
@@ -142,6 +160,12 @@ protected:
   /** Dataset index to extract (starting at 0)*/
   unsigned int m_DatasetNumber;
 
+  /** Number of overviews to write */
+  unsigned int m_NumberOfOverviews;
+
+  /** Dimension of the written blocks */
+  unsigned int m_BlockSize;
+
 
 private:
   GDALImageIO(const Self &); //purposely not implemented
@@ -158,6 +182,9 @@ private:
   GDALDatasetWrapperPointer m_Dataset;
 
   GDALDataTypeWrapper*    m_PxType;
+
+  /** Averages the written regions into the overviews */
+  GDALOverviewsBuilder*   m_OverviewsBuilder;
   /** Nombre d'octets par pixel */
   int m_BytePerPixel;
 
@@ -19,6 +19,7 @@
 #define __otbImageFileReader_h
 
 #include "itkImageFileReader.h"
+#include "itkMultiThreader.h"
 #include "otbCurlHelperInterface.h"
 #include "otbImageKeywordlist.h"
 
@@ -28,6 +29,16 @@ namespace otb
 /** \class ImageFileReader
  * \brief Resource to read an image from a file.
  *
+ * When the prefetch mode is enabled (PrefetchOn()) and the ImageIO can
+ * stream, the reader predicts the next region that the downstream
+ * pipeline is going to request from the offset between the last two
+ * requested regions (which is constant when a streaming writer walks
+ * its strips or tiles in order). The next region is read into a second
+ * buffer by a background thread while the current region is being
+ * processed, so that it is already in memory when the pipeline asks
+ * for it. If the prediction turns out to be wrong, the prefetched data
+ * is discarded and the region is read synchronously.
+ *
  * \sa ImageSeriesReader
  * \sa ImageIOBase
  *
@@ -82,6 +93,15 @@ public:
 
   itkSetObjectMacro(Curl, CurlHelperInterface);
 
+  /** Enable/disable the read-ahead of the next predicted region on a
+   *  background thread. Default is off. */
+  itkSetMacro(Prefetch, bool);
+  itkGetMacro(Prefetch, bool);
+  itkBooleanMacro(Prefetch);
+
+  /** Number of regions that were served from the prefetch buffer */
+  itkGetConstMacro(NumberOfPrefetchHits, unsigned long);
+
 protected:
   ImageFileReader();
   virtual ~ImageFileReader();
@@ -105,9 +125,32 @@ private:
   ImageFileReader(const Self &); //purposely not implemented
   void operator =(const Self&); //purposely not implemented
 
+  /** Wait for the background read to complete, if any. Must be called
+   *  before any other use of the ImageIO. */
+  void WaitForPrefetch();
+
+  /** Predict the next requested region and start reading it in the
+   *  background */
+  void StartPrefetch(const itk::ImageIORegion& currentRegion);
+
+  /** Entry point of the prefetch thread */
+  static ITK_THREAD_RETURN_TYPE PrefetchThreadFunction(void *arg);
+
   std::string m_ExceptionMessage;
 
   CurlHelperInterface::Pointer m_Curl;
+
+  /** Prefetch mode */
+  bool                        m_Prefetch;
+  itk::MultiThreader::Pointer m_PrefetchThreader;
+  int                         m_PrefetchThreadId;
+  itk::ImageIORegion          m_PreviousIORegion;
+  itk::ImageIORegion          m_PrefetchIORegion;
+  std::vector<char>           m_PrefetchBuffer;
+  std::string                 m_PrefetchFileName;
+  unsigned long               m_PrefetchMTime;
+  bool                        m_PrefetchValid;
+  unsigned long               m_NumberOfPrefetchHits;
 };
 
 } //namespace otb
@@ -21,6 +21,7 @@
 #include "otbImageFileReader.h"
 
 #include <fstream>
+#include <algorithm>
 
 #include "itkMetaDataObject.h"
 
@@ -53,21 +54,29 @@ bool PixelIsComplex(const T& dummy)
 
 template <class TOutputImage>
 ImageFileReader<TOutputImage>
-::ImageFileReader() : itk::ImageFileReader<TOutputImage>(), m_DatasetNumber(0)
+::ImageFileReader() : itk::ImageFileReader<TOutputImage>(), m_DatasetNumber(0),
+  m_Prefetch(false), m_PrefetchThreadId(-1), m_PrefetchMTime(0), m_PrefetchValid(false),
+  m_NumberOfPrefetchHits(0)
 {
   m_Curl = CurlHelper::New();
+  m_PrefetchThreader = itk::MultiThreader::New();
 }
 
 template <class TOutputImage>
 ImageFileReader<TOutputImage>
 ::~ImageFileReader()
 {
+  this->WaitForPrefetch();
 }
 
 template <class TOutputImage>
 void ImageFileReader<TOutputImage>
 ::PrintSelf(std::ostream& os, itk::Indent indent) const
 {
+  // The ImageIO is printed by the superclass too, and can not be used
+  // while a background read is running
+  const_cast<Self *>(this)->WaitForPrefetch();
+
   Superclass::PrintSelf(os, indent);
 
   if (this->m_ImageIO)
@@ -82,6 +91,8 @@ void ImageFileReader<TOutputImage>
 
   os << indent << "UserSpecifiedImageIO flag: " << this->m_UserSpecifiedImageIO << "\n";
   os << indent << "m_FileName: " << this->m_FileName << "\n";
+  os << indent << "Prefetch: " << m_Prefetch << "\n";
+  os << indent << "NumberOfPrefetchHits: " << m_NumberOfPrefetchHits << "\n";
 }
 
 template <class TOutputImage>
@@ -92,6 +103,9 @@ ImageFileReader<TOutputImage>
 
   typename TOutputImage::Pointer output = this->GetOutput();
 
+  // The ImageIO can not be used while a background read is running
+  this->WaitForPrefetch();
+
   // allocate the output buffer
   output->SetBufferedRegion(output->GetRequestedRegion());
   output->Allocate();
@@ -150,14 +164,33 @@ ImageFileReader<TOutputImage>
   typedef itk::DefaultConvertPixelTraits<ITK_TYPENAME TOutputImage::IOPixelType> ConvertIOPixelTraits;
   typedef itk::DefaultConvertPixelTraits<ITK_TYPENAME TOutputImage::PixelType> ConvertPixelTraits;
 
+  // Check if the region has been read ahead by the prefetch thread
+  bool prefetchHit = m_PrefetchValid
+    && m_PrefetchIORegion == ioRegion
+    && m_PrefetchFileName == this->m_FileName
+    && m_PrefetchMTime == this->GetMTime();
+  m_PrefetchValid = false;
+
+  if (prefetchHit)
+    {
+    otbMsgDevMacro(<< "Using prefetched region " << ioRegion);
+    ++m_NumberOfPrefetchHits;
+    }
+
   if (this->m_ImageIO->GetComponentTypeInfo()
       == typeid(ITK_TYPENAME ConvertPixelTraits::ComponentType)
       && (this->m_ImageIO->GetNumberOfComponents()
           == ConvertIOPixelTraits::GetNumberOfComponents()))
     {
-    // Have the ImageIO read directly into the allocated buffer
-    this->m_ImageIO->Read(buffer);
-    return;
+    if (prefetchHit)
+      {
+      std::copy(m_PrefetchBuffer.begin(), m_PrefetchBuffer.end(), reinterpret_cast<char *>(buffer));
+      }
+    else
+      {
+      // Have the ImageIO read directly into the allocated buffer
+      this->m_ImageIO->Read(buffer);
+      }
     }
   else // a type conversion is necessary
     {
@@ -165,23 +198,130 @@ ImageFileReader<TOutputImage>
     // regardless of the actual type of the pixels.
     ImageRegionType region = output->GetBufferedRegion();
 
-    // Adapt the image size with the region
-    std::streamoff nbBytes = (this->m_ImageIO->GetComponentSize() * this->m_ImageIO->GetNumberOfComponents())
-                             * static_cast<std::streamoff>(region.GetNumberOfPixels());
+    if (prefetchHit)
+      {
+      this->DoConvertBuffer(&(m_PrefetchBuffer[0]), region.GetNumberOfPixels());
+      }
+    else
+      {
+      // Adapt the image size with the region
+      std::streamoff nbBytes = (this->m_ImageIO->GetComponentSize() * this->m_ImageIO->GetNumberOfComponents())
+                               * static_cast<std::streamoff>(region.GetNumberOfPixels());
+
+      char * loadBuffer = new char[nbBytes];
+
+      otbMsgDevMacro(<< "size of Buffer to GDALImageIO::read = " << nbBytes << " = \n"
+          << "ComponentSize ("<< this->m_ImageIO->GetComponentSize() << ") x " \
+          << "Nb of Component (" << this->m_ImageIO->GetNumberOfComponents() << ") x " \
+          << "Nb of Pixel to read (" << region.GetNumberOfPixels() << ")" );
+
+      this->m_ImageIO->Read(loadBuffer);
+
+      this->DoConvertBuffer(loadBuffer, region.GetNumberOfPixels());
+
+      delete[] loadBuffer;
+      }
+    }
+
+  if (m_Prefetch && this->m_ImageIO->CanStreamRead())
+    {
+    this->StartPrefetch(ioRegion);
+    }
+}
+
+template <class TOutputImage>
+void
+ImageFileReader<TOutputImage>
+::WaitForPrefetch()
+{
+  if (m_PrefetchThreadId >= 0)
+    {
+    // Joins the prefetch thread
+    m_PrefetchThreader->TerminateThread(m_PrefetchThreadId);
+    m_PrefetchThreadId = -1;
+    }
+}
+
+template <class TOutputImage>
+void
+ImageFileReader<TOutputImage>
+::StartPrefetch(const itk::ImageIORegion& currentRegion)
+{
+  itk::ImageIORegion previousRegion = m_PreviousIORegion;
+  m_PreviousIORegion = currentRegion;
 
-    char * loadBuffer = new char[nbBytes];
+  const unsigned int dim = currentRegion.GetImageDimension();
+  if (previousRegion.GetImageDimension() != dim)
+    {
+    return;
+    }
 
-    otbMsgDevMacro(<< "size of Buffer to GDALImageIO::read = " << nbBytes << " = \n"
-        << "ComponentSize ("<< this->m_ImageIO->GetComponentSize() << ") x " \
-        << "Nb of Component (" << this->m_ImageIO->GetNumberOfComponents() << ") x " \
-        << "Nb of Pixel to read (" << region.GetNumberOfPixels() << ")" );
+  // The next region is predicted by applying the offset between the
+  // last two requested regions to the current one, and cropping it
+  // to the image extent
+  itk::ImageIORegion nextRegion(dim);
+  bool moving = false;
+  for (unsigned int i = 0; i < dim; ++i)
+    {
+    itk::ImageIORegion::IndexValueType offset = currentRegion.GetIndex(i) - previousRegion.GetIndex(i);
+    if (offset != 0)
+      {
+      moving = true;
+      }
 
-    this->m_ImageIO->Read(loadBuffer);
+    itk::ImageIORegion::IndexValueType begin = currentRegion.GetIndex(i) + offset;
+    itk::ImageIORegion::IndexValueType end   = begin + static_cast<itk::ImageIORegion::IndexValueType>(currentRegion.GetSize(i));
+    itk::ImageIORegion::IndexValueType imageEnd = (i < this->m_ImageIO->GetNumberOfDimensions()) ?
+      static_cast<itk::ImageIORegion::IndexValueType>(this->m_ImageIO->GetDimensions(i)) : 1;
 
-    this->DoConvertBuffer(loadBuffer, region.GetNumberOfPixels());
+    begin = std::max(begin, static_cast<itk::ImageIORegion::IndexValueType>(0));
+    end = std::min(end, imageEnd);
+    if (end <= begin)
+      {
+      // Prediction falls outside of the image: end of the walk
+      return;
+      }
+    nextRegion.SetIndex(i, begin);
+    nextRegion.SetSize(i, static_cast<itk::ImageIORegion::SizeValueType>(end - begin));
+    }
 
-    delete[] loadBuffer;
+  if (!moving)
+    {
+    return;
+    }
+
+  const size_t nbBytes = this->m_ImageIO->GetComponentSize() * this->m_ImageIO->GetNumberOfComponents()
+                         * nextRegion.GetNumberOfPixels();
+  m_PrefetchBuffer.resize(nbBytes);
+  m_PrefetchIORegion = nextRegion;
+  m_PrefetchFileName = this->m_FileName;
+  m_PrefetchMTime = this->GetMTime();
+  m_PrefetchValid = false;
+
+  otbMsgDevMacro(<< "Prefetching region " << nextRegion);
+  m_PrefetchThreadId = m_PrefetchThreader->SpawnThread(PrefetchThreadFunction, this);
+}
+
+template <class TOutputImage>
+ITK_THREAD_RETURN_TYPE
+ImageFileReader<TOutputImage>
+::PrefetchThreadFunction(void *arg)
+{
+  itk::MultiThreader::ThreadInfoStruct * pInfo = (itk::MultiThreader::ThreadInfoStruct *) (arg);
+  Self * reader = (Self *) (pInfo->UserData);
+
+  try
+    {
+    reader->m_ImageIO->SetIORegion(reader->m_PrefetchIORegion);
+    reader->m_ImageIO->Read(&(reader->m_PrefetchBuffer[0]));
+    reader->m_PrefetchValid = true;
+    }
+  catch (...)
+    {
+    // The region will be read again synchronously, which will report the error
+    reader->m_PrefetchValid = false;
     }
+  return ITK_THREAD_RETURN_VALUE;
 }
 
 template <class TOutputImage>
@@ -215,6 +355,10 @@ ImageFileReader<TOutputImage>
 
   typename TOutputImage::Pointer output = this->GetOutput();
 
+  // The ImageIO may be recreated or re-opened below
+  this->WaitForPrefetch();
+  m_PrefetchValid = false;
+
   itkDebugMacro(<< "Reading file for GenerateOutputInformation()" << this->m_FileName);
 
   // Check to see if we can read the file given the name or prefix
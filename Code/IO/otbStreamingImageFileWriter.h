@@ -21,7 +21,13 @@
 #include "otbMacro.h"
 #include "itkImageIOBase.h"
 #include "itkImageToImageFilter.h"
+#include "itkMultiThreader.h"
+#include "itkMutexLock.h"
+#include "itkConditionVariable.h"
 #include "otbStreamingManager.h"
+#include <deque>
+#include <set>
+#include <vector>
 
 namespace otb
 {
@@ -43,6 +49,25 @@ namespace otb
  * StreamingImageFileWriter will write directly the streaming buffer in the image file, so
  * that the output image never needs to be completely allocated
  *
+ * With the GDAL ImageIO, the tiles of a GeoTIFF file are chosen to divide the streamed tiles,
+ * and reduced resolution overviews can be requested with SetNumberOfOverviews(). They are
+ * averaged from the divisions as they are written, so that no separate pass has to read the
+ * whole file again to build them.
+ *
+ * A write-behind mode can be enabled with SetNumberOfWriteBehindBuffers(). In this mode,
+ * each division is copied into one of a bounded pool of buffers and handed to a dedicated
+ * I/O thread, so that the upstream pipeline computes division N+1 while division N is
+ * being encoded and written by the ImageIO. The extra buffers are taken into account by
+ * the streaming manager when estimating the number of divisions from the available RAM.
+ *
+ * Several divisions can also be computed at the same time, by giving the writer independent
+ * copies of the input pipeline with AddConcurrentInput(). Each pipeline then processes its
+ * own divisions, taken from a shared queue, with a fraction of the threads, and the streaming
+ * manager shares the available RAM between the concurrent divisions. This avoids the
+ * synchronization barriers of running a single division at a time with all the threads,
+ * which limits the speedup of filters with a costly BeforeThreadedGenerateData() or with
+ * small regions on machines with many cores.
+ *
  * \sa ImageFileWriter
  * \sa ImageSeriesReader
  * \sa ImageIOBase
@@ -218,6 +243,32 @@ public:
   itkGetMacro(WriteGeomFile, bool);
   itkBooleanMacro(WriteGeomFile);
 
+  /** Set/Get the number of overviews (by factors 2, 4, 8...) written
+   *  along with the image. Only GeoTIFF files written by the GDAL
+   *  ImageIO support them. Default is 0 (no overviews). */
+  itkSetMacro(NumberOfOverviews, unsigned int);
+  itkGetMacro(NumberOfOverviews, unsigned int);
+
+  /** Set/Get the number of write-behind buffers. When non zero, the
+   *  writing of each division is deferred to a dedicated I/O thread,
+   *  and at most this number of divisions can be waiting to be written
+   *  while the next ones are computed. Default is 0 (synchronous writing). */
+  itkSetMacro(NumberOfWriteBehindBuffers, unsigned int);
+  itkGetMacro(NumberOfWriteBehindBuffers, unsigned int);
+
+  /** Add a copy of the input pipeline, used to compute divisions
+   *  concurrently with the input. It must produce the same image as
+   *  the input, and must not share any filter with the input pipeline
+   *  or with the other copies. The number of threads of the filters of
+   *  the pipelines is reduced while the divisions are computed. */
+  void AddConcurrentInput(const InputImageType * input);
+
+  /** Remove all the copies of the input pipeline */
+  void ClearConcurrentInputs();
+
+  /** Return the number of copies of the input pipeline */
+  unsigned int GetNumberOfConcurrentInputs() const;
+
 protected:
   StreamingImageFileWriter();
   virtual ~StreamingImageFileWriter();
@@ -254,6 +305,50 @@ private:
     this->UpdateProgress( (m_DivisionProgress + m_CurrentDivision) / m_NumberOfDivisions );
   }
 
+  /** A division waiting to be written by the I/O thread */
+  struct WriteBehindBufferType
+  {
+    itk::ImageIORegion m_Region;
+    std::vector<char>  m_Data;
+  };
+  typedef std::deque<WriteBehindBufferType *> WriteBehindQueueType;
+
+  /** Set the pixel type and number of components of the ImageIO */
+  void SetImageIOPixelTypeInfo();
+
+  /** Start and stop the I/O thread */
+  void StartWriteBehindThread();
+  void StopWriteBehindThread();
+
+  /** Copy the buffer of the given input into a free write-behind buffer
+   *  and queue it. Blocks while all buffers are in use. */
+  void PushWriteBehindBuffer(const InputImageType * input, const itk::ImageIORegion& region);
+
+  /** Consume the queued buffers until the writer stops it */
+  void ProcessWriteBehindQueue();
+
+  /** Record an error of the I/O thread, thrown later by the main thread */
+  void SetWriteBehindError(const std::string& message);
+
+  /** Entry point of the I/O thread */
+  static ITK_THREAD_RETURN_TYPE WriteBehindThreadFunction(void *arg);
+
+  /** Compute and write all the divisions with the given number of
+   *  concurrent pipelines */
+  void GenerateConcurrentDivisions(unsigned int nbPipelines, bool useWriteBehind);
+
+  /** Compute divisions with one pipeline until the queue is empty */
+  void ProcessConcurrentDivisions(unsigned int pipelineId);
+
+  /** Record the first error of a pipeline, thrown later by the main thread */
+  void SetConcurrentError(const std::string& message);
+
+  /** Entry point of the concurrent pipeline threads */
+  static ITK_THREAD_RETURN_TYPE ConcurrentDivisionsThreadFunction(void *arg);
+
+  /** Collect the filters upstream of a data object */
+  static void CollectPipelineFilters(itk::DataObject * data, std::set<itk::ProcessObject *>& filters);
+
   unsigned int m_NumberOfDivisions;
   unsigned int m_CurrentDivision;
   float m_DivisionProgress;
@@ -275,7 +370,34 @@ private:
   
   bool m_WriteGeomFile;              // Write a geom file to store the kwl
 
+  /** Number of overviews to write */
+  unsigned int m_NumberOfOverviews;
+
   StreamingManagerPointerType m_StreamingManager;
+
+  /** Write-behind mode */
+  unsigned int                     m_NumberOfWriteBehindBuffers;
+  itk::MultiThreader::Pointer      m_WriteBehindThreader;
+  int                              m_WriteBehindThreadId;
+  itk::SimpleMutexLock             m_WriteBehindMutex;
+  itk::ConditionVariable::Pointer  m_WriteBehindCondition;
+  WriteBehindQueueType             m_PendingBuffers;
+  WriteBehindQueueType             m_FreeBuffers;
+  std::vector<WriteBehindBufferType *> m_AllocatedBuffers;
+  bool                             m_WriteBehindStopRequested;
+  bool                             m_WriteBehindFailed;
+  std::string                      m_WriteBehindErrorMessage;
+
+  /** Concurrent divisions mode */
+  std::vector<InputImagePointer>   m_ConcurrentInputs;
+  unsigned int                     m_NumberOfConcurrentPipelines;
+  unsigned int                     m_NextDivision;
+  unsigned int                     m_CompletedDivisions;
+  bool                             m_ConcurrentWriteBehind;
+  itk::SimpleMutexLock             m_ConcurrentMutex;
+  itk::SimpleMutexLock             m_ImageIOMutex;
+  bool                             m_ConcurrentFailed;
+  std::string                      m_ConcurrentErrorMessage;
 };
 
 } // end namespace otb
@@ -25,6 +25,7 @@
 
 #include "itkImageRegionMultidimensionalSplitter.h"
 #include "otbImageIOFactory.h"
+#include "otbGDALImageIO.h"
 
 #include "itkMetaDataObject.h"
 #include "otbImageKeywordlist.h"
@@ -39,6 +40,8 @@
 #include "otbTileDimensionTiledStreamingManager.h"
 #include "otbRAMDrivenTiledStreamingManager.h"
 
+#include <algorithm>
+
 
 namespace otb
 {
@@ -49,11 +52,24 @@ namespace otb
 template <class TInputImage>
 StreamingImageFileWriter<TInputImage>
 ::StreamingImageFileWriter()
-  : m_WriteGeomFile(false)
+  : m_WriteGeomFile(false),
+    m_NumberOfOverviews(0),
+    m_NumberOfWriteBehindBuffers(0),
+    m_WriteBehindThreadId(-1),
+    m_WriteBehindStopRequested(false),
+    m_WriteBehindFailed(false),
+    m_NumberOfConcurrentPipelines(1),
+    m_NextDivision(0),
+    m_CompletedDivisions(0),
+    m_ConcurrentWriteBehind(false),
+    m_ConcurrentFailed(false)
 {
   m_UserSpecifiedIORegion = true;
   m_FactorySpecifiedImageIO = false;
 
+  m_WriteBehindThreader = itk::MultiThreader::New();
+  m_WriteBehindCondition = itk::ConditionVariable::New();
+
   // By default, we use tiled streaming, with automatic tile size
   // We don't set any parameter, so the memory size is retrieved from the OTB configuration options
   this->SetAutomaticTiledStreaming();
@@ -66,6 +82,7 @@ template <class TInputImage>
 StreamingImageFileWriter<TInputImage>
 ::~StreamingImageFileWriter()
 {
+  this->StopWriteBehindThread();
 }
 
 template <class TInputImage>
@@ -308,6 +325,36 @@ StreamingImageFileWriter<TInputImage>
     {
     os << indent << "FactorySpecifiedmageIO: Off\n";
     }
+
+  os << indent << "NumberOfOverviews: " << m_NumberOfOverviews << "\n";
+  os << indent << "NumberOfWriteBehindBuffers: " << m_NumberOfWriteBehindBuffers << "\n";
+  os << indent << "NumberOfConcurrentInputs: " << m_ConcurrentInputs.size() << "\n";
+}
+
+template <class TInputImage>
+void
+StreamingImageFileWriter<TInputImage>
+::AddConcurrentInput(const InputImageType * input)
+{
+  m_ConcurrentInputs.push_back(const_cast<InputImageType *>(input));
+  this->Modified();
+}
+
+template <class TInputImage>
+void
+StreamingImageFileWriter<TInputImage>
+::ClearConcurrentInputs()
+{
+  m_ConcurrentInputs.clear();
+  this->Modified();
+}
+
+template <class TInputImage>
+unsigned int
+StreamingImageFileWriter<TInputImage>
+::GetNumberOfConcurrentInputs() const
+{
+  return m_ConcurrentInputs.size();
 }
 
 //---------------------------------------------------------
@@ -472,10 +519,37 @@ StreamingImageFileWriter<TInputImage>
     otbMsgDevMacro(<< "Buffered region is the largest possible region, there is no need for streaming.");
     this->SetNumberOfDivisionsStrippedStreaming(1);
     }
+
+  // Write-behind is useless if there is only one division, and the
+  // extra buffers have to be taken into account in the RAM budget
+  bool useWriteBehind = (m_NumberOfWriteBehindBuffers > 0);
+  m_StreamingManager->SetNumberOfExtraOutputBuffers(useWriteBehind ? m_NumberOfWriteBehindBuffers : 0);
+
+  // The concurrent pipelines share the RAM budget
+  unsigned int nbPipelines = 1;
+  if (m_ImageIO->CanStreamWrite() && inputPtr->GetBufferedRegion() != inputPtr->GetLargestPossibleRegion())
+    {
+    nbPipelines += m_ConcurrentInputs.size();
+    }
+  m_StreamingManager->SetNumberOfConcurrentDivisions(nbPipelines);
+
   m_StreamingManager->PrepareStreaming(inputPtr, outputRegion);
   m_NumberOfDivisions = m_StreamingManager->GetNumberOfSplits();
   otbMsgDebugMacro(<< "Number Of Stream Divisions : " << m_NumberOfDivisions);
 
+  useWriteBehind = useWriteBehind && (m_NumberOfDivisions > 1);
+
+  nbPipelines = std::min(nbPipelines, m_NumberOfDivisions);
+  bool useConcurrentPipelines = (nbPipelines > 1);
+  for (unsigned int p = 0; useConcurrentPipelines && p < m_ConcurrentInputs.size(); ++p)
+    {
+    m_ConcurrentInputs[p]->UpdateOutputInformation();
+    if (m_ConcurrentInputs[p]->GetLargestPossibleRegion() != inputPtr->GetLargestPossibleRegion())
+      {
+      itkExceptionMacro(<< "Concurrent input " << p << " does not have the same largest possible region as the input.");
+      }
+    }
+
   /**
    * Loop over the number of pieces, execute the upstream pipeline on each
    * piece, and copy the results into the output image.
@@ -510,6 +584,19 @@ StreamingImageFileWriter<TInputImage>
   m_ImageIO->SetUseCompression(m_UseCompression);
   m_ImageIO->SetMetaDataDictionary(inputPtr->GetMetaDataDictionary());
 
+  // GDAL files are laid out after the streamed tiles, and their
+  // overviews are built from the written divisions
+  GDALImageIO* gdalImageIO = dynamic_cast<GDALImageIO*>(m_ImageIO.GetPointer());
+  if (gdalImageIO != NULL)
+    {
+    gdalImageIO->SetBlockSize(m_StreamingManager->GetTileDimension());
+    gdalImageIO->SetNumberOfOverviews(m_NumberOfOverviews);
+    }
+  else if (m_NumberOfOverviews > 0)
+    {
+    otbWarningMacro(<< "Overviews can not be written along with " << m_FileName.c_str() << ".");
+    }
+
   /** Create Image file */
   // Setup the image IO for writing.
   //
@@ -522,28 +609,97 @@ StreamingImageFileWriter<TInputImage>
 
   this->UpdateProgress(0);
 
-  for (m_CurrentDivision = 0;
-       m_CurrentDivision < m_NumberOfDivisions && !this->GetAbortGenerateData();
-       m_CurrentDivision++, m_DivisionProgress = 0, this->UpdateFilterProgress())
+  if (useWriteBehind)
+    {
+    this->StartWriteBehindThread();
+    }
+
+  if (useConcurrentPipelines)
+    {
+    this->SetImageIOPixelTypeInfo();
+    this->GenerateConcurrentDivisions(nbPipelines, useWriteBehind);
+    }
+  else
     {
-    streamRegion = m_StreamingManager->GetSplit(m_CurrentDivision);
+    // If a division fails, the I/O thread must not keep on writing the
+    // queued divisions once Update() has been left
+    try
+      {
+      for (m_CurrentDivision = 0;
+           m_CurrentDivision < m_NumberOfDivisions && !this->GetAbortGenerateData();
+           m_CurrentDivision++, m_DivisionProgress = 0, this->UpdateFilterProgress())
+        {
+        streamRegion = m_StreamingManager->GetSplit(m_CurrentDivision);
+
+        inputPtr->SetRequestedRegion(streamRegion);
+        inputPtr->PropagateRequestedRegion();
+        inputPtr->UpdateOutputData();
+
+        // Write the whole image
+        itk::ImageIORegion ioRegion(TInputImage::ImageDimension);
+        for (unsigned int i = 0; i < TInputImage::ImageDimension; ++i)
+          {
+          ioRegion.SetSize(i, streamRegion.GetSize(i));
+          ioRegion.SetIndex(i, streamRegion.GetIndex(i));
+          }
+        this->SetIORegion(ioRegion);
+
+        if (useWriteBehind)
+          {
+          // Hand the division over to the I/O thread and go on with the
+          // next one
+          if (m_CurrentDivision == 0)
+            {
+            this->SetImageIOPixelTypeInfo();
+            }
+          this->PushWriteBehindBuffer(inputPtr, ioRegion);
+          }
+        else
+          {
+          m_ImageIO->SetIORegion(m_IORegion);
+
+          // Start writing stream region in the image file
+          this->GenerateData();
+          }
+        }
+      }
+    catch (...)
+      {
+      this->StopWriteBehindThread();
+      m_FreeBuffers.clear();
+      this->m_Updating = false;
+      throw;
+      }
+    }
 
-    inputPtr->SetRequestedRegion(streamRegion);
-    inputPtr->PropagateRequestedRegion();
-    inputPtr->UpdateOutputData();
+  if (useWriteBehind)
+    {
+    // Wait for the pending divisions to be written
+    this->StopWriteBehindThread();
 
-    // Write the whole image
-    itk::ImageIORegion ioRegion(TInputImage::ImageDimension);
-    for (unsigned int i = 0; i < TInputImage::ImageDimension; ++i)
+    if (m_WriteBehindFailed)
       {
-      ioRegion.SetSize(i, streamRegion.GetSize(i));
-      ioRegion.SetIndex(i, streamRegion.GetIndex(i));
+      this->m_Updating = false;
+      itkExceptionMacro(<< "Error while writing " << m_FileName << ": " << m_WriteBehindErrorMessage);
       }
-    this->SetIORegion(ioRegion);
-    m_ImageIO->SetIORegion(m_IORegion);
+    }
+
+  if (useConcurrentPipelines && m_ConcurrentFailed)
+    {
+    this->m_Updating = false;
+    itkExceptionMacro(<< "Error while writing " << m_FileName << ": " << m_ConcurrentErrorMessage);
+    }
 
-    // Start writing stream region in the image file
-    this->GenerateData();
+  // The geometry is written once all the divisions are done
+  if (useWriteBehind || useConcurrentPipelines)
+    {
+    if (m_WriteGeomFile)
+      {
+      ImageKeywordlist otb_kwl;
+      itk::MetaDataDictionary dict = this->GetInput()->GetMetaDataDictionary();
+      itk::ExposeMetaData<ImageKeywordlist>(dict, MetaDataKey::OSSIMKeywordlistKey, otb_kwl);
+      WriteGeometry(otb_kwl, this->GetFileName());
+      }
     }
 
   /**
@@ -601,6 +757,30 @@ StreamingImageFileWriter<TInputImage>
 {
   const InputImageType * input = this->GetInput();
 
+  this->SetImageIOPixelTypeInfo();
+
+  // Setup the image IO for writing.
+  //
+  //okay, now extract the data as a raw buffer pointer
+  const void* dataPtr = (const void*) input->GetBufferPointer();
+  m_ImageIO->Write(dataPtr);
+
+  if (m_WriteGeomFile)
+    {
+    ImageKeywordlist otb_kwl;
+    itk::MetaDataDictionary dict = this->GetInput()->GetMetaDataDictionary();
+    itk::ExposeMetaData<ImageKeywordlist>(dict, MetaDataKey::OSSIMKeywordlistKey, otb_kwl);
+    WriteGeometry(otb_kwl, this->GetFileName());
+    }
+}
+
+template<class TInputImage>
+void
+StreamingImageFileWriter<TInputImage>
+::SetImageIOPixelTypeInfo()
+{
+  const InputImageType * input = this->GetInput();
+
   // Make sure that the image is the right type and no more than
   // four components.
   typedef typename InputImageType::PixelType ImagePixelType;
@@ -618,19 +798,345 @@ StreamingImageFileWriter<TInputImage>
     // Set the pixel and component type; the number of components.
     m_ImageIO->SetPixelTypeInfo(typeid(ImagePixelType));
     }
+}
 
-  // Setup the image IO for writing.
-  //
-  //okay, now extract the data as a raw buffer pointer
-  const void* dataPtr = (const void*) input->GetBufferPointer();
-  m_ImageIO->Write(dataPtr);
+template<class TInputImage>
+void
+StreamingImageFileWriter<TInputImage>
+::StartWriteBehindThread()
+{
+  // In case a previous update was interrupted by an exception
+  this->StopWriteBehindThread();
 
-  if (m_WriteGeomFile)
+  m_WriteBehindStopRequested = false;
+  m_WriteBehindFailed = false;
+  m_WriteBehindErrorMessage = "";
+
+  // Buffers of the pool are resized to the division size when they
+  // are first used
+  for (unsigned int i = 0; i < m_NumberOfWriteBehindBuffers; ++i)
     {
-    ImageKeywordlist otb_kwl;
-    itk::MetaDataDictionary dict = this->GetInput()->GetMetaDataDictionary();
-    itk::ExposeMetaData<ImageKeywordlist>(dict, MetaDataKey::OSSIMKeywordlistKey, otb_kwl);
-    WriteGeometry(otb_kwl, this->GetFileName());
+    m_AllocatedBuffers.push_back(new WriteBehindBufferType);
+    }
+  m_FreeBuffers.assign(m_AllocatedBuffers.begin(), m_AllocatedBuffers.end());
+
+  m_WriteBehindThreadId = m_WriteBehindThreader->SpawnThread(WriteBehindThreadFunction, this);
+}
+
+template<class TInputImage>
+void
+StreamingImageFileWriter<TInputImage>
+::StopWriteBehindThread()
+{
+  if (m_WriteBehindThreadId < 0)
+    {
+    return;
+    }
+
+  m_WriteBehindMutex.Lock();
+  m_WriteBehindStopRequested = true;
+  m_WriteBehindCondition->Broadcast();
+  m_WriteBehindMutex.Unlock();
+
+  // Joins the I/O thread, which exits once the queue is empty
+  m_WriteBehindThreader->TerminateThread(m_WriteBehindThreadId);
+  m_WriteBehindThreadId = -1;
+
+  // Release the memory of the buffer pool
+  for (unsigned int i = 0; i < m_AllocatedBuffers.size(); ++i)
+    {
+    delete m_AllocatedBuffers[i];
+    }
+  m_AllocatedBuffers.clear();
+  m_PendingBuffers.clear();
+  m_FreeBuffers.clear();
+}
+
+template<class TInputImage>
+void
+StreamingImageFileWriter<TInputImage>
+::PushWriteBehindBuffer(const InputImageType * input, const itk::ImageIORegion& region)
+{
+  m_WriteBehindMutex.Lock();
+  while (m_FreeBuffers.empty() && !m_WriteBehindFailed)
+    {
+    m_WriteBehindCondition->Wait(&m_WriteBehindMutex);
+    }
+  if (m_WriteBehindFailed)
+    {
+    // The error is reported once the I/O thread is stopped
+    this->SetAbortGenerateData(true);
+    m_WriteBehindMutex.Unlock();
+    return;
+    }
+  WriteBehindBufferType * buffer = m_FreeBuffers.front();
+  m_FreeBuffers.pop_front();
+  m_WriteBehindMutex.Unlock();
+
+  // The copy is done outside of the lock, the buffer belongs to the
+  // main thread until it is queued
+  typedef typename InputImageType::InternalPixelType InternalPixelType;
+  const char * dataPtr = reinterpret_cast<const char *>(input->GetBufferPointer());
+  const size_t nbBytes = input->GetPixelContainer()->Size() * sizeof(InternalPixelType);
+
+  buffer->m_Region = region;
+  buffer->m_Data.resize(nbBytes);
+  std::copy(dataPtr, dataPtr + nbBytes, buffer->m_Data.begin());
+
+  m_WriteBehindMutex.Lock();
+  m_PendingBuffers.push_back(buffer);
+  m_WriteBehindCondition->Broadcast();
+  m_WriteBehindMutex.Unlock();
+}
+
+template<class TInputImage>
+void
+StreamingImageFileWriter<TInputImage>
+::ProcessWriteBehindQueue()
+{
+  while (true)
+    {
+    m_WriteBehindMutex.Lock();
+    while (m_PendingBuffers.empty() && !m_WriteBehindStopRequested)
+      {
+      m_WriteBehindCondition->Wait(&m_WriteBehindMutex);
+      }
+    if (m_PendingBuffers.empty())
+      {
+      // Stop has been requested and everything has been written
+      m_WriteBehindMutex.Unlock();
+      return;
+      }
+    WriteBehindBufferType * buffer = m_PendingBuffers.front();
+    m_PendingBuffers.pop_front();
+    bool skip = m_WriteBehindFailed;
+    m_WriteBehindMutex.Unlock();
+
+    if (!skip)
+      {
+      try
+        {
+        // Only this thread uses the ImageIO while write-behind is active
+        m_ImageIO->SetIORegion(buffer->m_Region);
+        m_ImageIO->Write(&(buffer->m_Data[0]));
+        }
+      // Nothing may escape the thread function: the error is reported
+      // to the main thread, which throws it at the end of the writing
+      catch (itk::ExceptionObject& err)
+        {
+        this->SetWriteBehindError(err.GetDescription());
+        }
+      catch (std::exception& err)
+        {
+        this->SetWriteBehindError(err.what());
+        }
+      catch (...)
+        {
+        this->SetWriteBehindError("Unknown exception");
+        }
+      }
+
+    m_WriteBehindMutex.Lock();
+    m_FreeBuffers.push_back(buffer);
+    m_WriteBehindCondition->Broadcast();
+    m_WriteBehindMutex.Unlock();
+    }
+}
+
+template<class TInputImage>
+void
+StreamingImageFileWriter<TInputImage>
+::SetWriteBehindError(const std::string& message)
+{
+  m_WriteBehindMutex.Lock();
+  m_WriteBehindFailed = true;
+  m_WriteBehindErrorMessage = message;
+  m_WriteBehindMutex.Unlock();
+}
+
+template<class TInputImage>
+ITK_THREAD_RETURN_TYPE
+StreamingImageFileWriter<TInputImage>
+::WriteBehindThreadFunction(void *arg)
+{
+  itk::MultiThreader::ThreadInfoStruct * pInfo = (itk::MultiThreader::ThreadInfoStruct *) (arg);
+  Self * writer = (Self *) (pInfo->UserData);
+  writer->ProcessWriteBehindQueue();
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template<class TInputImage>
+void
+StreamingImageFileWriter<TInputImage>
+::GenerateConcurrentDivisions(unsigned int nbPipelines, bool useWriteBehind)
+{
+  m_NumberOfConcurrentPipelines = nbPipelines;
+  m_NextDivision = 0;
+  m_CompletedDivisions = 0;
+  m_ConcurrentWriteBehind = useWriteBehind;
+  m_ConcurrentFailed = false;
+  m_ConcurrentErrorMessage = "";
+
+  // Split the threads between the pipelines, and remember the
+  // settings of the filters to restore them afterwards
+  int nbThreads = std::max(1, itk::MultiThreader::GetGlobalDefaultNumberOfThreads() / static_cast<int>(nbPipelines));
+
+  std::set<itk::ProcessObject *> filters;
+  CollectPipelineFilters(const_cast<InputImageType *>(this->GetInput()), filters);
+  for (unsigned int p = 0; p + 1 < nbPipelines; ++p)
+    {
+    CollectPipelineFilters(m_ConcurrentInputs[p], filters);
+    }
+
+  std::vector<std::pair<itk::ProcessObject *, int> > previousNumberOfThreads;
+  for (std::set<itk::ProcessObject *>::iterator it = filters.begin(); it != filters.end(); ++it)
+    {
+    previousNumberOfThreads.push_back(std::make_pair(*it, (*it)->GetNumberOfThreads()));
+    (*it)->SetNumberOfThreads(nbThreads);
+    }
+
+  otbMsgDevMacro(<< "Computing " << m_NumberOfDivisions << " divisions with " << nbPipelines
+                 << " concurrent pipelines of " << nbThreads << " threads")
+
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  threader->SetNumberOfThreads(nbPipelines);
+  threader->SetSingleMethod(ConcurrentDivisionsThreadFunction, this);
+  threader->SingleMethodExecute();
+
+  for (unsigned int i = 0; i < previousNumberOfThreads.size(); ++i)
+    {
+    previousNumberOfThreads[i].first->SetNumberOfThreads(previousNumberOfThreads[i].second);
+    }
+}
+
+template<class TInputImage>
+void
+StreamingImageFileWriter<TInputImage>
+::ProcessConcurrentDivisions(unsigned int pipelineId)
+{
+  InputImageType * input = (pipelineId == 0) ? const_cast<InputImageType *>(this->GetInput())
+                                             : m_ConcurrentInputs[pipelineId - 1].GetPointer();
+
+  while (true)
+    {
+    // Take the next division of the queue
+    m_ConcurrentMutex.Lock();
+    if (m_NextDivision >= m_NumberOfDivisions || m_ConcurrentFailed || this->GetAbortGenerateData())
+      {
+      m_ConcurrentMutex.Unlock();
+      return;
+      }
+    InputImageRegionType streamRegion = m_StreamingManager->GetSplit(m_NextDivision);
+    ++m_NextDivision;
+    m_ConcurrentMutex.Unlock();
+
+    try
+      {
+      input->SetRequestedRegion(streamRegion);
+      input->PropagateRequestedRegion();
+      input->UpdateOutputData();
+
+      itk::ImageIORegion ioRegion(TInputImage::ImageDimension);
+      for (unsigned int i = 0; i < TInputImage::ImageDimension; ++i)
+        {
+        ioRegion.SetSize(i, streamRegion.GetSize(i));
+        ioRegion.SetIndex(i, streamRegion.GetIndex(i));
+        }
+
+      if (m_ConcurrentWriteBehind)
+        {
+        this->PushWriteBehindBuffer(input, ioRegion);
+        }
+      else
+        {
+        // The ImageIO is shared by all the pipelines
+        m_ImageIOMutex.Lock();
+        try
+          {
+          m_ImageIO->SetIORegion(ioRegion);
+          m_ImageIO->Write(input->GetBufferPointer());
+          }
+        catch (...)
+          {
+          m_ImageIOMutex.Unlock();
+          throw;
+          }
+        m_ImageIOMutex.Unlock();
+        }
+      }
+    // Nothing may escape the thread function: the error stops the other
+    // pipelines and is thrown by the main thread once they are joined
+    catch (itk::ExceptionObject& err)
+      {
+      this->SetConcurrentError(err.GetDescription());
+      return;
+      }
+    catch (std::exception& err)
+      {
+      this->SetConcurrentError(err.what());
+      return;
+      }
+    catch (...)
+      {
+      this->SetConcurrentError("Unknown exception");
+      return;
+      }
+
+    // Every pipeline reports its completed divisions. The progress is
+    // updated under the lock so that the observers are never called
+    // concurrently and always see an increasing progress.
+    m_ConcurrentMutex.Lock();
+    ++m_CompletedDivisions;
+    this->UpdateProgress(static_cast<float>(m_CompletedDivisions) / m_NumberOfDivisions);
+    m_ConcurrentMutex.Unlock();
+    }
+}
+
+template<class TInputImage>
+void
+StreamingImageFileWriter<TInputImage>
+::SetConcurrentError(const std::string& message)
+{
+  m_ConcurrentMutex.Lock();
+  if (!m_ConcurrentFailed)
+    {
+    m_ConcurrentFailed = true;
+    m_ConcurrentErrorMessage = message;
+    }
+  m_ConcurrentMutex.Unlock();
+}
+
+template<class TInputImage>
+ITK_THREAD_RETURN_TYPE
+StreamingImageFileWriter<TInputImage>
+::ConcurrentDivisionsThreadFunction(void *arg)
+{
+  itk::MultiThreader::ThreadInfoStruct * pInfo = (itk::MultiThreader::ThreadInfoStruct *) (arg);
+  Self * writer = (Self *) (pInfo->UserData);
+  if (static_cast<unsigned int>(pInfo->ThreadID) < writer->m_NumberOfConcurrentPipelines)
+    {
+    writer->ProcessConcurrentDivisions(pInfo->ThreadID);
+    }
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template<class TInputImage>
+void
+StreamingImageFileWriter<TInputImage>
+::CollectPipelineFilters(itk::DataObject * data, std::set<itk::ProcessObject *>& filters)
+{
+  if (data == NULL)
+    {
+    return;
+    }
+  itk::ProcessObject * source = data->GetSource();
+  if (source == NULL || !filters.insert(source).second)
+    {
+    return;
+    }
+  for (unsigned int i = 0; i < source->GetNumberOfInputs(); ++i)
+    {
+    CollectPipelineFilters(source->GetInputs()[i], filters);
     }
 }
 
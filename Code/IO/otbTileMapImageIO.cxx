@@ -34,11 +34,88 @@
 #include "itkTimeProbe.h"
 #include "otbCurlHelper.h"
 
+#if !defined(WIN32) || defined(__CYGWIN__)
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#define OTB_TILEMAP_PACK_LOCKING
+#endif
+
 #include "otbLogo.inc"
 
 namespace otb
 {
 
+namespace
+{
+/** Header of the packed cache file: magic, generation */
+const char         PackFileMagic[4] = {'O', 'T', 'B', 'P'};
+const unsigned int PackFileHeaderSize = 8;
+
+/** Header of a record of the packed cache: magic, key size, data size */
+const char         PackMagic[4] = {'O', 'T', 'B', 'T'};
+const unsigned int PackHeaderSize = 12;
+
+void EncodeUInt32(unsigned int value, char * bytes)
+{
+  for (unsigned int i = 0; i < 4; ++i)
+    {
+    bytes[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+unsigned int DecodeUInt32(const char * bytes)
+{
+  unsigned int value = 0;
+  for (unsigned int i = 0; i < 4; ++i)
+    {
+    value |= static_cast<unsigned int>(static_cast<unsigned char>(bytes[i])) << (8 * i);
+    }
+  return value;
+}
+
+#ifdef OTB_TILEMAP_PACK_LOCKING
+/** Lock (or unlock) the whole pack file, against the other processes */
+bool LockPack(int fd, short type)
+{
+  struct flock lock;
+  memset(&lock, 0, sizeof(lock));
+  lock.l_type = type;
+  lock.l_whence = SEEK_SET;
+  lock.l_start = 0;
+  lock.l_len = 0;
+  while (fcntl(fd, F_SETLKW, &lock) == -1)
+    {
+    if (errno != EINTR)
+      {
+      return false;
+      }
+    }
+  return true;
+}
+
+bool WriteAll(int fd, const char * data, size_t size)
+{
+  while (size > 0)
+    {
+    const ssize_t written = write(fd, data, size);
+    if (written < 0 && errno == EINTR)
+      {
+      continue;
+      }
+    if (written <= 0)
+      {
+      return false;
+      }
+    data += written;
+    size -= written;
+    }
+  return true;
+}
+#endif
+}
+
 TileMapImageIO::TileMapImageIO()
 {
   // By default set number of dimensions to two.
@@ -79,6 +156,14 @@ TileMapImageIO::TileMapImageIO()
   // Set maximum of connections to 10
   m_MaxConnect = 10;
 
+  // Keep 128 decoded tiles (32 MB for four bands tiles) between reads
+  m_MemoryCacheSize = 128;
+  m_PackEnd = 0;
+  m_PackGeneration = 0;
+
+  // The packed cache starts again beyond 1 GB
+  m_MaximumPackSize = 1024 * 1024 * 1024;
+
   m_Curl = CurlHelper::New();
 
   this->AddSupportedWriteExtension(".otb");
@@ -130,6 +215,9 @@ void TileMapImageIO::PrintSelf(std::ostream& os, itk::Indent indent) const
 {
   Superclass::PrintSelf(os, indent);
   os << indent << "Compression Level : " << m_CompressionLevel << "\n";
+  os << indent << "Max Connect : " << m_MaxConnect << "\n";
+  os << indent << "Memory Cache Size : " << m_MemoryCacheSize << "\n";
+  os << indent << "Maximum Pack Size : " << m_MaximumPackSize << "\n";
 }
 
 // Read image with TileMap
@@ -151,10 +239,14 @@ void TileMapImageIO::Read(void* buffer)
   int nTilesY = (int) ceil(totLines / static_cast<double>(m_TileSize)) + 1;
 
   // Clear vectors
-  m_ListFilename.clear();
-  m_ListURLs.clear();
   m_ListTiles.clear();
 
+  std::vector<std::string>  listURLs;
+  std::vector<std::string>  listFilenames;
+  std::vector<unsigned int> listFetchedTiles;
+
+  itksys::SystemTools::MakeDirectory(m_CacheDirectory.c_str());
+  this->UpdatePackIndex();
 
   //Read all the required tiles
   for (int numTileY = 0; numTileY < nTilesY; numTileY++)
@@ -164,27 +256,64 @@ void TileMapImageIO::Read(void* buffer)
       double xTile = (firstSample + m_TileSize * numTileX) / ((1 << m_Depth) * static_cast<double>(m_TileSize));
       double yTile = (firstLine + m_TileSize * numTileY) / ((1 << m_Depth) * static_cast<double>(m_TileSize));
 
-      std::string lFilename;
-
       // Generate Tile filename
       this->GenerateTileInfo(xTile, yTile, numTileX, numTileY);
+      const TileNameAndCoordType& tile = m_ListTiles.back();
+
+      // Tile decoded by a previous read
+      if (this->GetTileFromMemory(tile.url) != NULL)
+        {
+        continue;
+        }
+
+      // Tile in the packed cache
+      TileBufferType decoded;
+      if (this->ReadTileFromPack(tile.url, decoded))
+        {
+        this->AddTileToMemory(tile.url).swap(decoded);
+        continue;
+        }
 
       // Try to read tile from cache
-      if (!this->CanReadFromCache(m_ListTiles.back().filename))
+      if (this->CanReadFromCache(tile.filename) && this->DecodeTile(tile.filename, decoded))
         {
-        this->GenerateURL(m_ListTiles.back().x, m_ListTiles.back().y);
-        m_ListFilename.push_back(m_ListTiles.back().filename);
+        this->WriteTileToPack(tile.url, decoded);
+        this->AddTileToMemory(tile.url).swap(decoded);
+        continue;
         }
+
+      std::ostringstream filename;
+      filename << m_CacheDirectory << "/otb-" << tile.quad << "." << m_FileSuffix;
+      listURLs.push_back(tile.url);
+      listFilenames.push_back(filename.str());
+      listFetchedTiles.push_back(m_ListTiles.size() - 1);
       }
     }
 
-  m_Curl->RetrieveFileMulti(m_ListURLs, m_ListFilename, m_MaxConnect);
+  // Fetch all the missing tiles at once
+  if (!listURLs.empty())
+    {
+    m_Curl->RetrieveFileMulti(listURLs, listFilenames, m_MaxConnect);
+    }
 
-  m_ListURLs.clear();
+  for (unsigned int i = 0; i < listFetchedTiles.size(); ++i)
+    {
+    const std::string& url = m_ListTiles[listFetchedTiles[i]].url;
+    TileBufferType     decoded;
+    if (this->DecodeTile(listFilenames[i], decoded))
+      {
+      this->WriteTileToPack(url, decoded);
+      this->AddTileToMemory(url).swap(decoded);
+      }
+    itksys::SystemTools::RemoveFile(listFilenames[i].c_str());
+    }
 
   // Generate buffer
   this->GenerateBuffer(p);
 
+  // The tiles of this read were all kept until now
+  this->TrimMemoryCache();
+
   otbMsgDevMacro(<< "TileMapImageIO::Read() completed");
 }
 
@@ -197,7 +326,7 @@ void TileMapImageIO::GenerateTileInfo(double x, double y, int numTileX, int numT
   XYToQuadTree2(x, y, quad2);
 
   std::ostringstream filename;
-  BuildFileName(quad2, filename);
+  BuildFileName(quad2, filename, true, false);
 
   // Build tile informations
   TileNameAndCoordType lTileInfos;
@@ -205,7 +334,9 @@ void TileMapImageIO::GenerateTileInfo(double x, double y, int numTileX, int numT
   lTileInfos.numTileY = numTileY;
   lTileInfos.x = x;
   lTileInfos.y = y;
+  lTileInfos.quad = quad2.str();
   lTileInfos.filename = filename.str();
+  lTileInfos.url = this->GenerateURL(x, y);
 
   // Add to vector
   m_ListTiles.push_back(lTileInfos);
@@ -231,7 +362,7 @@ bool TileMapImageIO::CanReadFromCache(const std::string& filename)
 /*
  * This method generate URLs
  */
-void TileMapImageIO::GenerateURL(double x, double y)
+std::string TileMapImageIO::GenerateURL(double x, double y)
 {
   std::ostringstream urlStream;
 
@@ -272,7 +403,7 @@ void TileMapImageIO::GenerateURL(double x, double y)
     {
     std::ostringstream quad, filename;
     XYToQuadTree2(x, y, quad);
-    BuildFileName(quad, filename, false);
+    BuildFileName(quad, filename, false, false);
     urlStream << m_ServerName;
     urlStream << filename.str();
     }
@@ -281,8 +412,7 @@ void TileMapImageIO::GenerateURL(double x, double y)
     itkExceptionMacro(<< "TileMapImageIO : Bad addressing Style");
     }
 
-  // Add url to vector
-  m_ListURLs.push_back(urlStream.str());
+  return urlStream.str();
 }
 
 /*
@@ -296,12 +426,23 @@ void TileMapImageIO::GenerateBuffer(unsigned char *p)
   int firstSample = this->GetIORegion().GetIndex()[0];
   int nComponents = this->GetNumberOfComponents();
 
-  unsigned char * bufferTile = new unsigned char[m_TileSize * m_TileSize * nComponents];
+  TileBufferType faultTile;
   for (unsigned int currentTile = 0; currentTile < m_ListTiles.size(); currentTile++)
     {
 
-    // Read tile from cache
-    this->ReadTile(m_ListTiles[currentTile].filename, bufferTile);
+    // Decoded tile, or the logo if the tile is not available
+    const TileBufferType * tile = this->GetTileFromMemory(m_ListTiles[currentTile].url);
+    if (tile == NULL)
+      {
+      if (faultTile.empty())
+        {
+        TileBufferType logo(m_TileSize * m_TileSize * 3);
+        FillCacheFaults(&logo[0]);
+        this->ConvertTile(logo, 3, faultTile);
+        }
+      tile = &faultTile;
+      }
+    const unsigned char * bufferTile = &(*tile)[0];
 
     int numTileX = m_ListTiles[currentTile].numTileX;
     int numTileY = m_ListTiles[currentTile].numTileY;
@@ -313,9 +454,9 @@ void TileMapImageIO::GenerateBuffer(unsigned char *p)
         {
         long int xImageOffset = (long int)
                                 (m_TileSize * floor(firstSample / static_cast<double>(m_TileSize)) + m_TileSize * numTileX - firstSample);
-        unsigned char * dst = p + nComponents * (xImageOffset + totSamples * yImageOffset);
-        unsigned char * src = bufferTile + nComponents * m_TileSize * tileJ;
-        int             size = nComponents * m_TileSize;
+        unsigned char *       dst = p + nComponents * (xImageOffset + totSamples * yImageOffset);
+        const unsigned char * src = bufferTile + nComponents * m_TileSize * tileJ;
+        int                   size = nComponents * m_TileSize;
 
         if (xImageOffset < 0)
           {
@@ -334,47 +475,314 @@ void TileMapImageIO::GenerateBuffer(unsigned char *p)
         }
       } //end of tile copy
     } //end of full image copy
-  delete[] bufferTile;
 }
 
 /*
- * This method read tile in the cache
+ * This method decode a tile file
  */
-void TileMapImageIO::ReadTile(const std::string& filename, void * buffer)
+bool TileMapImageIO::DecodeTile(const std::string& filename, TileBufferType& tile) const
 {
-  otbMsgDevMacro(<< "Retrieving " << filename);
-  unsigned char *           bufferCacheFault = NULL;
+  otbMsgDevMacro(<< "Decoding " << filename);
 
   itk::ImageIOBase::Pointer imageIO;
   imageIO = otb::GDALImageIO::New();
 
-  bool lCanRead = imageIO->CanReadFile(filename.c_str());
+  if (!imageIO->CanReadFile(filename.c_str()))
+    {
+    return false;
+    }
 
-  if (lCanRead == true)
+  imageIO->SetFileName(filename.c_str());
+  imageIO->ReadImageInformation();
+  if (static_cast<int>(imageIO->GetDimensions(0)) != m_TileSize
+      || static_cast<int>(imageIO->GetDimensions(1)) != m_TileSize)
     {
-    imageIO->SetFileName(filename.c_str());
-    imageIO->ReadImageInformation();
-    itk::ImageIORegion ioRegion(2);
-    ioRegion.SetIndex(0, 0);
-    ioRegion.SetIndex(1, 0);
-    ioRegion.SetSize(0, m_TileSize);
-    ioRegion.SetSize(1, m_TileSize);
-    imageIO->SetIORegion(ioRegion);
+    return false;
+    }
+
+  itk::ImageIORegion ioRegion(2);
+  ioRegion.SetIndex(0, 0);
+  ioRegion.SetIndex(1, 0);
+  ioRegion.SetSize(0, m_TileSize);
+  ioRegion.SetSize(1, m_TileSize);
+  imageIO->SetIORegion(ioRegion);
 
-    imageIO->Read(buffer);
+  const unsigned int nbBands = imageIO->GetNumberOfComponents();
+  TileBufferType     decoded(m_TileSize * m_TileSize * nbBands);
+  imageIO->Read(&decoded[0]);
+
+  this->ConvertTile(decoded, nbBands, tile);
+  return true;
+}
+
+/*
+ * This method adapt the bands of a tile to the number of components of
+ * the image: missing color bands replicate the first band, a missing
+ * alpha band is opaque
+ */
+void TileMapImageIO::ConvertTile(const TileBufferType& input, unsigned int nbBands, TileBufferType& tile) const
+{
+  const unsigned int nComponents = this->GetNumberOfComponents();
+  if (nbBands == nComponents)
+    {
+    tile = input;
+    return;
     }
-  else
+
+  const unsigned int nbPixels = m_TileSize * m_TileSize;
+  tile.assign(nbPixels * nComponents, 255);
+  for (unsigned int i = 0; i < nbPixels; ++i)
+    {
+    for (unsigned int c = 0; c < nComponents; ++c)
+      {
+      if (c < nbBands)
+        {
+        tile[i * nComponents + c] = input[i * nbBands + c];
+        }
+      else if (c < 3)
+        {
+        tile[i * nComponents + c] = input[i * nbBands];
+        }
+      }
+    }
+}
+
+/*
+ * Memory cache of the decoded tiles
+ */
+TileMapImageIO::TileBufferType * TileMapImageIO::GetTileFromMemory(const std::string& url)
+{
+  TileMemoryCacheType::iterator it = m_MemoryCache.find(url);
+  if (it == m_MemoryCache.end())
+    {
+    return NULL;
+    }
+
+  // Move the tile to the most recently used position
+  m_MemoryCacheOrder.splice(m_MemoryCacheOrder.begin(), m_MemoryCacheOrder, it->second.position);
+  return &it->second.buffer;
+}
+
+TileMapImageIO::TileBufferType& TileMapImageIO::AddTileToMemory(const std::string& url)
+{
+  TileBufferType * tile = this->GetTileFromMemory(url);
+  if (tile != NULL)
+    {
+    return *tile;
+    }
+
+  m_MemoryCacheOrder.push_front(url);
+  CachedTileType& cachedTile = m_MemoryCache[url];
+  cachedTile.position = m_MemoryCacheOrder.begin();
+  return cachedTile.buffer;
+}
+
+void TileMapImageIO::TrimMemoryCache()
+{
+  while (m_MemoryCache.size() > m_MemoryCacheSize)
+    {
+    m_MemoryCache.erase(m_MemoryCacheOrder.back());
+    m_MemoryCacheOrder.pop_back();
+    }
+}
+
+/*
+ * Packed cache file
+ */
+std::string TileMapImageIO::GetPackFileName() const
+{
+  return m_CacheDirectory + "/otb-tilemap.pack";
+}
+
+void TileMapImageIO::UpdatePackIndex()
+{
+  const std::string packFileName = this->GetPackFileName();
+  if (packFileName != m_PackFileName)
+    {
+    m_PackFileName = packFileName;
+    m_PackIndex.clear();
+    m_PackEnd = 0;
+    }
+
+  std::ifstream pack(m_PackFileName.c_str(), std::ios::in | std::ios::binary);
+  char          fileHeader[PackFileHeaderSize];
+  if (!pack || !pack.read(fileHeader, PackFileHeaderSize) || memcmp(fileHeader, PackFileMagic, 4) != 0)
+    {
+    m_PackIndex.clear();
+    m_PackEnd = 0;
+    return;
+    }
+  pack.seekg(0, std::ios::end);
+  const std::streamoff fileSize = pack.tellg();
+
+  // The pack was started again (by this process or another one) since the
+  // last update: its records are indexed from the beginning
+  const unsigned int generation = DecodeUInt32(fileHeader + 4);
+  if (m_PackEnd < static_cast<std::streamoff>(PackFileHeaderSize) || generation != m_PackGeneration
+      || fileSize < m_PackEnd)
+    {
+    m_PackIndex.clear();
+    m_PackEnd = PackFileHeaderSize;
+    m_PackGeneration = generation;
+    }
+
+  // Index the records added since the last update, up to the first
+  // incomplete one
+  std::streamoff position = m_PackEnd;
+  while (position + static_cast<std::streamoff>(PackHeaderSize) <= fileSize)
+    {
+    char header[PackHeaderSize];
+    pack.seekg(position);
+    pack.read(header, PackHeaderSize);
+    if (!pack || memcmp(header, PackMagic, 4) != 0)
+      {
+      break;
+      }
+
+    const unsigned int keySize = DecodeUInt32(header + 4);
+    PackedTileType     entry;
+    entry.record = position;
+    entry.offset = position + PackHeaderSize + keySize;
+    entry.size = DecodeUInt32(header + 8);
+    if (keySize == 0 || entry.offset + static_cast<std::streamoff>(entry.size) > fileSize)
+      {
+      break;
+      }
+
+    std::string key(keySize, ' ');
+    pack.read(&key[0], keySize);
+    if (!pack)
+      {
+      break;
+      }
+
+    m_PackIndex[key] = entry;
+    position = entry.offset + entry.size;
+    }
+  m_PackEnd = position;
+}
+
+bool TileMapImageIO::ReadTileFromPack(const std::string& url, TileBufferType& tile) const
+{
+  PackIndexType::const_iterator entry = m_PackIndex.find(url);
+  if (entry == m_PackIndex.end()
+      || entry->second.size != static_cast<unsigned int>(m_TileSize * m_TileSize * this->GetNumberOfComponents()))
+    {
+    return false;
+    }
+
+  // The pack may have been started again by another process since it was
+  // indexed: the record must still be the one of the url
+  std::ifstream pack(m_PackFileName.c_str(), std::ios::in | std::ios::binary);
+  char          header[PackHeaderSize];
+  pack.seekg(entry->second.record);
+  pack.read(header, PackHeaderSize);
+  if (!pack || memcmp(header, PackMagic, 4) != 0 || DecodeUInt32(header + 4) != url.size()
+      || DecodeUInt32(header + 8) != entry->second.size)
+    {
+    return false;
+    }
+
+  std::string key(url.size(), ' ');
+  pack.read(&key[0], key.size());
+  if (!pack || key != url)
+    {
+    return false;
+    }
+
+  tile.resize(entry->second.size);
+  pack.read(reinterpret_cast<char *>(&tile[0]), entry->second.size);
+  return !pack.fail();
+}
+
+void TileMapImageIO::WriteTileToPack(const std::string& url, const TileBufferType& tile)
+{
+  if (m_PackFileName.empty())
+    {
+    this->UpdatePackIndex();
+    }
+
+  // The record is written at once, at the end of the file
+  std::vector<char> record(PackHeaderSize + url.size() + tile.size());
+  memcpy(&record[0], PackMagic, 4);
+  EncodeUInt32(url.size(), &record[4]);
+  EncodeUInt32(tile.size(), &record[8]);
+  memcpy(&record[PackHeaderSize], url.data(), url.size());
+  memcpy(&record[PackHeaderSize + url.size()], &tile[0], tile.size());
+
+#ifdef OTB_TILEMAP_PACK_LOCKING
+  // Several processes may share the cache directory: the records are
+  // appended under an exclusive lock of the file
+  const int fd = open(m_PackFileName.c_str(), O_RDWR | O_APPEND | O_CREAT, 0666);
+  if (fd < 0 || !LockPack(fd, F_WRLCK))
     {
-    if (bufferCacheFault == NULL)
+    otbMsgDevMacro(<< "Can't write the tile cache " << m_PackFileName);
+    if (fd >= 0)
       {
-      bufferCacheFault = new unsigned char[m_TileSize * m_TileSize * 3];
-      FillCacheFaults(bufferCacheFault);
+      close(fd);
       }
-    memcpy(buffer, bufferCacheFault, m_TileSize * m_TileSize * 3);
+    return;
     }
+
+  struct stat status;
+  char        fileHeader[PackFileHeaderSize];
+  bool        valid = fstat(fd, &status) == 0 && status.st_size >= static_cast<off_t>(PackFileHeaderSize)
+                      && pread(fd, fileHeader, PackFileHeaderSize, 0) == static_cast<ssize_t>(PackFileHeaderSize)
+                      && memcmp(fileHeader, PackFileMagic, 4) == 0;
+
+  // A new, invalid or full pack is started again, with a new generation
+  // telling the other readers that their index is obsolete
+  if (!valid || static_cast<unsigned long>(status.st_size) + record.size() > m_MaximumPackSize)
+    {
+    const unsigned int generation = valid ? DecodeUInt32(fileHeader + 4) + 1 : 0;
+    memcpy(fileHeader, PackFileMagic, 4);
+    EncodeUInt32(generation, fileHeader + 4);
+    valid = ftruncate(fd, 0) == 0 && WriteAll(fd, fileHeader, PackFileHeaderSize);
+    }
+
+  if (valid)
+    {
+    WriteAll(fd, &record[0], record.size());
+    }
+  LockPack(fd, F_UNLCK);
+  close(fd);
+#else
+  // Without file locking, the cache directory must not be shared by
+  // concurrent processes
+  std::fstream pack(m_PackFileName.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+  if (!pack)
+    {
+    pack.clear();
+    pack.open(m_PackFileName.c_str(), std::ios::out | std::ios::binary);
+    }
+  if (!pack)
+    {
+    otbMsgDevMacro(<< "Can't write the tile cache " << m_PackFileName);
+    return;
+    }
+
+  pack.seekp(0, std::ios::end);
+  const std::streamoff fileSize = pack.tellp();
+  if (fileSize < static_cast<std::streamoff>(PackFileHeaderSize)
+      || static_cast<unsigned long>(fileSize) + record.size() > m_MaximumPackSize)
+    {
+    char fileHeader[PackFileHeaderSize];
+    memcpy(fileHeader, PackFileMagic, 4);
+    EncodeUInt32(m_PackGeneration + 1, fileHeader + 4);
+    pack.close();
+    pack.open(m_PackFileName.c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
+    pack.write(fileHeader, PackFileHeaderSize);
+    }
+  pack.write(&record[0], record.size());
+  pack.flush();
+#endif
+
+  // Index the record, and the ones written meanwhile by other processes
+  this->UpdatePackIndex();
 }
 
-void TileMapImageIO::BuildFileName(const std::ostringstream& quad, std::ostringstream& filename, bool inCache) const
+void TileMapImageIO::BuildFileName(const std::ostringstream& quad, std::ostringstream& filename, bool inCache,
+                                   bool createDirectory) const
 {
 
   int                quadsize = quad.str().size();
@@ -392,7 +800,10 @@ void TileMapImageIO::BuildFileName(const std::ostringstream& quad, std::ostrings
     i++;
     }
 
-  itksys::SystemTools::MakeDirectory(directory.str().c_str());
+  if (createDirectory)
+    {
+    itksys::SystemTools::MakeDirectory(directory.str().c_str());
+    }
 
   filename << directory.str();
   filename << "/";
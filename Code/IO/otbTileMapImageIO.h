@@ -22,6 +22,9 @@
 /* C++ Libraries */
 #include <string>
 #include <vector>
+#include <list>
+#include <map>
+#include <ios>
 //#include "stdlib.h"
 
 /* ITK Libraries */
@@ -43,6 +46,21 @@ enum TileMapAdressingStyle {GM = 0, OSM = 1, NEARMAP = 2, LOCAL = 3};
    *
    * \brief ImageIO object for reading and writing TileMap images
    *
+   * The tiles missing for a read are fetched concurrently, with at most
+   * MaxConnect simultaneous transfers. The decoded tiles are kept:
+   * - in memory, where the MemoryCacheSize least recently used tiles are
+   * kept between two reads,
+   * - in a single file of the cache directory, otb-tilemap.pack, which
+   * stores the decoded tiles one after the other, each record starting
+   * with a header (magic, key and data sizes) followed by the tile url
+   * and its pixels. The index of the records is rebuilt by scanning the
+   * headers, and the url of a record is checked again when it is read.
+   * Records are appended under an exclusive lock of the file (except on
+   * Windows), so that processes can share the cache directory. Beyond
+   * MaximumPackSize bytes, the pack is started again: its header holds a
+   * generation number, telling the other readers to index it again.
+   * The tiles cached as individual files by previous versions are still
+   * read, and moved to the packed cache.
    *
  */
 class ITK_EXPORT TileMapImageIO : public itk::ImageIOBase
@@ -73,6 +91,18 @@ public:
   itkSetMacro(MaxConnect, int);
   itkGetMacro(MaxConnect, int);
 
+  /** Set/Get the number of decoded tiles kept in memory between two
+   * reads */
+  itkSetMacro(MemoryCacheSize, unsigned int);
+  itkGetMacro(MemoryCacheSize, unsigned int);
+
+  /** Set/Get the maximum size of the packed cache file, in bytes */
+  itkSetMacro(MaximumPackSize, unsigned long);
+  itkGetMacro(MaximumPackSize, unsigned long);
+
+  /** Set the object used to fetch the tiles */
+  itkSetObjectMacro(Curl, CurlHelperInterface);
+
   virtual void SetCacheDirectory(const char* _arg);
   virtual void SetCacheDirectory(const std::string& _arg);
 
@@ -152,14 +182,39 @@ private:
     int numTileY;
     double x;
     double y;
+    std::string quad;
     std::string filename;
+    std::string url;
   } TileNameAndCoordType;
 
+  /** Decoded tile pixels */
+  typedef std::vector<unsigned char> TileBufferType;
+
+  /** Memory cache of the decoded tiles, by url, with the urls in least
+   * recently used order */
+  typedef std::list<std::string> TileKeyListType;
+  struct CachedTileType
+  {
+    TileBufferType            buffer;
+    TileKeyListType::iterator position;
+  };
+  typedef std::map<std::string, CachedTileType> TileMemoryCacheType;
+
+  /** Location of a tile in the packed cache file */
+  struct PackedTileType
+  {
+    std::streamoff record;
+    std::streamoff offset;
+    unsigned int   size;
+  };
+  typedef std::map<std::string, PackedTileType> PackIndexType;
+
   TileMapImageIO(const Self &); //purposely not implemented
   void operator =(const Self&); //purposely not implemented
 
   void InternalWrite(double x, double y, const void* buffer);
-  void BuildFileName(const std::ostringstream& quad, std::ostringstream& filename, bool inCache = true) const;
+  void BuildFileName(const std::ostringstream& quad, std::ostringstream& filename, bool inCache = true,
+                     bool createDirectory = true) const;
   void FillCacheFaults(void* buffer) const;
   int XYToQuadTree(double x, double y, std::ostringstream& quad) const;
   int XYToQuadTree2(double x, double y, std::ostringstream& quad) const;
@@ -167,15 +222,37 @@ private:
   /** CURL Multi */
   void GenerateTileInfo(double x, double y, int numTileX, int numTileY);
   bool CanReadFromCache(const std::string& filename);
-  void GenerateURL(double x, double y);
+  std::string GenerateURL(double x, double y);
   void GenerateBuffer(unsigned char * p);
-  void ReadTile(const std::string& filename, void * buffer);
 
-  std::vector<std::string>          m_ListFilename;
-  std::vector<std::string>          m_ListURLs;
+  /** Decode a tile file, with the number of components of the image */
+  bool DecodeTile(const std::string& filename, TileBufferType& tile) const;
+  void ConvertTile(const TileBufferType& input, unsigned int nbBands, TileBufferType& tile) const;
+
+  /** Memory cache of the decoded tiles */
+  TileBufferType * GetTileFromMemory(const std::string& url);
+  TileBufferType& AddTileToMemory(const std::string& url);
+  void TrimMemoryCache();
+
+  /** Packed cache file */
+  std::string GetPackFileName() const;
+  void UpdatePackIndex();
+  bool ReadTileFromPack(const std::string& url, TileBufferType& tile) const;
+  void WriteTileToPack(const std::string& url, const TileBufferType& tile);
+
   std::vector<TileNameAndCoordType> m_ListTiles;
   int                               m_MaxConnect;
 
+  unsigned int        m_MemoryCacheSize;
+  TileMemoryCacheType m_MemoryCache;
+  TileKeyListType     m_MemoryCacheOrder;
+
+  std::string    m_PackFileName;
+  PackIndexType  m_PackIndex;
+  std::streamoff m_PackEnd;
+  unsigned int   m_PackGeneration;
+  unsigned long  m_MaximumPackSize;
+
   CurlHelperInterface::Pointer      m_Curl;
 
   /** Byte per pixel pixel */
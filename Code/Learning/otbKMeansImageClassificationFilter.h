@@ -23,6 +23,8 @@
 #include "itkListSample.h"
 #include "itkFixedArray.h"
 #include "itkEuclideanDistance.h"
+#include "otbNearestPrototypeSearch.h"
+#include <vector>
 
 namespace otb
 {
@@ -32,9 +34,14 @@ namespace otb
  *  This filter is streamed and threaded, allowing to classify huge images. Because the
  *  internal sample type has to be an itk::FixedArray, one must specify at compilation time
  *  the maximum sample dimension. It is up to the user to specify a MaxSampleDimension sufficiently
- *  high to integrate all its features. This filter internally use one SVMClassifier per thread.
+ *  high to integrate all its features.
  *
- * \sa SVMClassifier
+ *  The centroids are stored contiguously and the pixels are classified by blocks
+ *  of BlockSize pixels with a NearestPrototypeSearch, each pixel starting from
+ *  the label of the previous one. The label of the first nearest centroid is
+ *  given, as with the EuclideanDistance.
+ *
+ * \sa NearestPrototypeSearch
  * \ingroup Streamed
  * \ingroup Threaded
  */
@@ -78,6 +85,10 @@ public:
   typedef itk::Array<double>                             KMeansParametersType;
   typedef std::map<LabelType, SampleType>                CentroidsMapType;
   typedef itk::Statistics::EuclideanDistance<SampleType> DistanceType;
+  typedef NearestPrototypeSearch<ValueType>              NearestCentroidSearchType;
+
+  /** Number of pixels classified together */
+  itkStaticConstMacro(BlockSize, unsigned int, 64);
 
   /** Set/Get the centroids */
   itkSetMacro(Centroids, KMeansParametersType);
@@ -120,8 +131,10 @@ private:
   KMeansParametersType m_Centroids;
   /** Default label for invalid pixels (when using a mask) */
   LabelType m_DefaultLabel;
-  /** Centroids - labels map */
-  CentroidsMapType m_CentroidsMap;
+  /** Centroids of the labels 1 to n, MaxSampleDimension values each */
+  std::vector<ValueType> m_CentroidsBuffer;
+  /** Search of the nearest centroid in m_CentroidsBuffer */
+  NearestCentroidSearchType m_NearestCentroid;
 };
 } // End namespace otb
 #ifndef OTB_MANUAL_INSTANTIATION
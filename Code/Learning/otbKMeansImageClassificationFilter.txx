@@ -21,6 +21,7 @@
 #include "otbKMeansImageClassificationFilter.h"
 #include "itkImageRegionIterator.h"
 #include "itkNumericTraits.h"
+#include <algorithm>
 
 namespace otb
 {
@@ -65,18 +66,12 @@ KMeansImageClassificationFilter<TInputImage, TOutputImage, VMaxSampleDimension,
   unsigned int sample_size = MaxSampleDimension;
   unsigned int nb_classes = m_Centroids.Size() / sample_size;
 
-  for (LabelType label = 1; label <= static_cast<LabelType>(nb_classes); ++label)
+  m_CentroidsBuffer.resize(nb_classes * MaxSampleDimension);
+  for (unsigned int i = 0; i < m_CentroidsBuffer.size(); ++i)
     {
-    SampleType new_centroid;
-    new_centroid.Fill(0);
-    m_CentroidsMap[label] = new_centroid;
-
-    for (unsigned int i = 0; i < MaxSampleDimension; ++i)
-      {
-      m_CentroidsMap[label][i] =
-        static_cast<ValueType>(m_Centroids[MaxSampleDimension * (static_cast < unsigned int > (label) - 1) + i]);
-      }
+    m_CentroidsBuffer[i] = static_cast<ValueType>(m_Centroids[i]);
     }
+  m_NearestCentroid.SetPrototypes(nb_classes > 0 ? &m_CentroidsBuffer[0] : 0, nb_classes, MaxSampleDimension);
 }
 
 template <class TInputImage, class TOutputImage, unsigned int VMaxSampleDimension, class TMaskImage>
@@ -107,51 +102,53 @@ KMeansImageClassificationFilter<TInputImage, TOutputImage, VMaxSampleDimension,
 
   bool validPoint = true;
 
-  while (!outIt.IsAtEnd())
-    {
-    outIt.Set(m_DefaultLabel);
-    ++outIt;
-    }
-
-  outIt.GoToBegin();
-
-  validPoint = true;
-
-  typename DistanceType::Pointer distance = DistanceType::New();
+  // Block of pixels, zero padded to MaxSampleDimension values
+  std::vector<ValueType>    block(BlockSize * MaxSampleDimension, itk::NumericTraits<ValueType>::ZeroValue());
+  std::vector<unsigned int> nearest(BlockSize);
+  std::vector<bool>         valid(BlockSize);
+  typename InputImageType::PixelType pixel;
 
   while (!outIt.IsAtEnd() && (!inIt.IsAtEnd()))
     {
-    if (inputMaskPtr)
-      {
-      validPoint = maskIt.Get() > 0;
-      ++maskIt;
-      }
-    if (validPoint)
+    // Gather the valid pixels of the block
+    unsigned int blockLength = 0;
+    unsigned int nbValid = 0;
+    for (; blockLength < BlockSize && !inIt.IsAtEnd(); ++blockLength, ++inIt)
       {
-      LabelType  label = 1;
-      LabelType  current_label = 1;
-      SampleType pixel;
-      pixel.Fill(0);
-      for (unsigned int i = 0; i < sampleSize; ++i)
+      if (inputMaskPtr)
         {
-        pixel[i] = inIt.Get()[i];
+        validPoint = maskIt.Get() > 0;
+        ++maskIt;
         }
-
-      double current_distance = distance->Evaluate(pixel, m_CentroidsMap[label]);
-
-      for (label = 2; label <= static_cast<LabelType>(m_CentroidsMap.size()); ++label)
+      valid[blockLength] = validPoint && m_NearestCentroid.GetNumberOfPrototypes() > 0;
+      if (valid[blockLength])
         {
-        double tmp_dist = distance->Evaluate(pixel, m_CentroidsMap[label]);
-        if (tmp_dist < current_distance)
+        pixel = inIt.Get();
+        ValueType * sample = &block[nbValid * MaxSampleDimension];
+        for (unsigned int i = 0; i < sampleSize; ++i)
           {
-          current_label = label;
-          current_distance = tmp_dist;
+          sample[i] = pixel[i];
           }
+        ++nbValid;
+        }
+      }
+
+    m_NearestCentroid.FindNearest(&block[0], nbValid, &nearest[0]);
+
+    // Write the labels
+    unsigned int currentValid = 0;
+    for (unsigned int n = 0; n < blockLength && !outIt.IsAtEnd(); ++n, ++outIt)
+      {
+      if (valid[n])
+        {
+        outIt.Set(static_cast<LabelType>(nearest[currentValid] + 1));
+        ++currentValid;
+        }
+      else
+        {
+        outIt.Set(m_DefaultLabel);
         }
-      outIt.Set(current_label);
       }
-    ++outIt;
-    ++inIt;
     }
 }
 /**
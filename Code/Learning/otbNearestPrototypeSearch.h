@@ -0,0 +1,145 @@
+/*=========================================================================
+
+  Program:   ORFEO Toolbox
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+
+  Copyright (c) Centre National d'Etudes Spatiales. All rights reserved.
+  See OTBCopyright.txt for details.
+
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __otbNearestPrototypeSearch_h
+#define __otbNearestPrototypeSearch_h
+
+#include "itkMacro.h"
+#include "itkEuclideanDistance.h"
+
+namespace otb
+{
+
+/** \class NearestPrototypeSearch
+ * \brief Finds the prototype nearest to a sample, in the euclidean sense.
+ *
+ * The prototypes (KMeans centroids, SOM neurons, ...) are read from a
+ * contiguous buffer of Dimension values per prototype, which is not
+ * copied: the buffer must stay valid, and may be updated between the
+ * searches, as long as the search is used. The squared distances are
+ * accumulated four components at a time, as two independent partial
+ * sums, and the evaluation of a prototype stops as soon as its partial
+ * distance exceeds the best distance found so far. The bound is checked
+ * once per four components, so that the early exit does not cost a
+ * branch per component.
+ *
+ * When several prototypes are at the same distance of the sample, the
+ * first one is returned, or the last one if LastOnTie is set. Since
+ * the components are not summed in the order of
+ * itk::Statistics::EuclideanDistance, the result is the same as the
+ * one of the exhaustive search with this distance up to rounding.
+ *
+ * Blocks of samples are searched with the winner of each sample as
+ * starting bound for the next one, which prunes most of the prototypes
+ * on spatially coherent data like images. All the methods are const,
+ * a single search can be shared by several threads.
+ *
+ * \sa KMeansImageClassificationFilter
+ * \sa SOMMap
+ */
+template <class TPrototypeValue = double>
+class NearestPrototypeSearch
+{
+public:
+  /** Value type of the prototypes */
+  typedef TPrototypeValue PrototypeValueType;
+
+  /** Constructor */
+  NearestPrototypeSearch();
+
+  /** Set the prototypes, stored prototype after prototype */
+  void SetPrototypes(const PrototypeValueType * prototypes, unsigned int nbPrototypes, unsigned int dimension);
+
+  /** Get the number of prototypes */
+  unsigned int GetNumberOfPrototypes() const
+  {
+    return m_NumberOfPrototypes;
+  }
+
+  /** Get the number of components of the prototypes and samples */
+  unsigned int GetDimension() const
+  {
+    return m_Dimension;
+  }
+
+  /** Return the last prototype at the minimum distance rather than the first one */
+  void SetLastOnTie(bool flag)
+  {
+    m_LastOnTie = flag;
+  }
+  bool GetLastOnTie() const
+  {
+    return m_LastOnTie;
+  }
+
+  /** Get the squared distance between a sample and a prototype. The
+   * evaluation stops when the partial distance exceeds bound, a value
+   * greater than bound is then returned. */
+  template <class TSampleValue>
+  double SquaredDistance(const TSampleValue * sample, unsigned int prototype, double bound) const;
+
+  /** Find the prototype nearest to a sample of Dimension values. The
+   * distance to the hint prototype is computed first to bound the
+   * search. The squared distance to the winner is stored in
+   * squaredDistance if it is not null. There must be at least one
+   * prototype. */
+  template <class TSampleValue>
+  unsigned int FindNearest(const TSampleValue * sample, unsigned int hint = 0, double * squaredDistance = 0) const;
+
+  /** Find the nearest prototypes of nbSamples samples, stored sample
+   * after sample. The squared distances to the winners are stored in
+   * squaredDistances if it is not null. */
+  template <class TSampleValue>
+  void FindNearest(const TSampleValue * samples, unsigned int nbSamples, unsigned int * nearest,
+                   double * squaredDistances = 0) const;
+
+private:
+  /** Prototypes buffer */
+  const PrototypeValueType * m_Prototypes;
+
+  /** Number of prototypes */
+  unsigned int m_NumberOfPrototypes;
+
+  /** Number of components */
+  unsigned int m_Dimension;
+
+  /** Tie policy */
+  bool m_LastOnTie;
+};
+
+/** \class NearestPrototypeSearchTraits
+ * \brief Tells whether a distance can be evaluated by NearestPrototypeSearch.
+ */
+template <class TDistance>
+struct NearestPrototypeSearchTraits
+{
+  static const bool IsEuclidean = false;
+};
+
+template <class TVector>
+struct NearestPrototypeSearchTraits<itk::Statistics::EuclideanDistance<TVector> >
+{
+  static const bool IsEuclidean = true;
+};
+
+} // end namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbNearestPrototypeSearch.txx"
+#endif
+
+#endif
@@ -0,0 +1,135 @@
+/*=========================================================================
+
+  Program:   ORFEO Toolbox
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+
+  Copyright (c) Centre National d'Etudes Spatiales. All rights reserved.
+  See OTBCopyright.txt for details.
+
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __otbNearestPrototypeSearch_txx
+#define __otbNearestPrototypeSearch_txx
+
+#include "otbNearestPrototypeSearch.h"
+#include "itkNumericTraits.h"
+
+namespace otb
+{
+
+template <class TPrototypeValue>
+NearestPrototypeSearch<TPrototypeValue>
+::NearestPrototypeSearch()
+  : m_Prototypes(0),
+    m_NumberOfPrototypes(0),
+    m_Dimension(0),
+    m_LastOnTie(false)
+{
+}
+
+template <class TPrototypeValue>
+void
+NearestPrototypeSearch<TPrototypeValue>
+::SetPrototypes(const PrototypeValueType * prototypes, unsigned int nbPrototypes, unsigned int dimension)
+{
+  m_Prototypes = prototypes;
+  m_NumberOfPrototypes = nbPrototypes;
+  m_Dimension = dimension;
+}
+
+template <class TPrototypeValue>
+template <class TSampleValue>
+double
+NearestPrototypeSearch<TPrototypeValue>
+::SquaredDistance(const TSampleValue * sample, unsigned int prototype, double bound) const
+{
+  const PrototypeValueType * p = m_Prototypes + static_cast<unsigned long>(prototype) * m_Dimension;
+
+  double       distance = 0.;
+  unsigned int i = 0;
+
+  // Four independent differences per step, the bound is checked once per step
+  for (; i + 4 <= m_Dimension; i += 4)
+    {
+    const double d0 = static_cast<double>(sample[i]) - static_cast<double>(p[i]);
+    const double d1 = static_cast<double>(sample[i + 1]) - static_cast<double>(p[i + 1]);
+    const double d2 = static_cast<double>(sample[i + 2]) - static_cast<double>(p[i + 2]);
+    const double d3 = static_cast<double>(sample[i + 3]) - static_cast<double>(p[i + 3]);
+    distance += (d0 * d0 + d1 * d1) + (d2 * d2 + d3 * d3);
+    if (distance > bound)
+      {
+      return distance;
+      }
+    }
+  for (; i < m_Dimension; ++i)
+    {
+    const double d = static_cast<double>(sample[i]) - static_cast<double>(p[i]);
+    distance += d * d;
+    }
+  return distance;
+}
+
+template <class TPrototypeValue>
+template <class TSampleValue>
+unsigned int
+NearestPrototypeSearch<TPrototypeValue>
+::FindNearest(const TSampleValue * sample, unsigned int hint, double * squaredDistance) const
+{
+  if (hint >= m_NumberOfPrototypes)
+    {
+    hint = 0;
+    }
+
+  // The hint gives the initial bound
+  unsigned int winner = hint;
+  double       minDistance = this->SquaredDistance(sample, hint, itk::NumericTraits<double>::max());
+
+  for (unsigned int k = 0; k < m_NumberOfPrototypes; ++k)
+    {
+    if (k == hint)
+      {
+      continue;
+      }
+    // Prototypes at the same distance are fully evaluated, for the tie policy
+    const double distance = this->SquaredDistance(sample, k, minDistance);
+    if (distance < minDistance
+        || (distance == minDistance && (m_LastOnTie ? k > winner : k < winner)))
+      {
+      minDistance = distance;
+      winner = k;
+      }
+    }
+
+  if (squaredDistance)
+    {
+    *squaredDistance = minDistance;
+    }
+  return winner;
+}
+
+template <class TPrototypeValue>
+template <class TSampleValue>
+void
+NearestPrototypeSearch<TPrototypeValue>
+::FindNearest(const TSampleValue * samples, unsigned int nbSamples, unsigned int * nearest,
+              double * squaredDistances) const
+{
+  unsigned int hint = 0;
+  for (unsigned int n = 0; n < nbSamples; ++n)
+    {
+    hint = this->FindNearest(samples + static_cast<unsigned long>(n) * m_Dimension, hint,
+                             squaredDistances ? squaredDistances + n : 0);
+    nearest[n] = hint;
+    }
+}
+
+} // end namespace otb
+
+#endif
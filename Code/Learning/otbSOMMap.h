@@ -39,6 +39,10 @@ namespace otb
  * Thanks to the extensiong of the Image object, reading and writing is supported through standard image
  * readers and writers.
  *
+ * When the distance is the itk::Statistics::EuclideanDistance, the winner is searched directly
+ * in the pixel buffer with a NearestPrototypeSearch, which stops evaluating a neuron as soon
+ * as it is farther than the best one found so far.
+ *
  * The training is done via the SOM class, and the activation map can be produced with the SOMActivationBuilder
  * class.
  *
@@ -79,7 +83,8 @@ public:
   typedef typename Superclass::SpacingType   SpacingType;
   typedef typename Superclass::PointType     PointType;
   /**
-   * Get The index of the winning neuron for a sample.
+   * Get The index of the winning neuron for a sample. When several neurons
+   * are at the minimum distance, the last one is returned.
    * \param sample the sample.
    * \return The index of the winning neuron.
    */
@@ -22,6 +22,7 @@ See GETCopyright.txt for details.
 #define __otbSOMMap_txx
 
 #include "itkImageRegionIteratorWithIndex.h"
+#include "otbNearestPrototypeSearch.h"
 
 namespace otb
 {
@@ -50,6 +51,19 @@ typename SOMMap<TNeuron, TDistance, VMapDimension>
 SOMMap<TNeuron, TDistance, VMapDimension>
 ::GetWinner(const NeuronType& sample)
 {
+  // Euclidean distance on the whole map: search the pixel buffer
+  if (NearestPrototypeSearchTraits<DistanceType>::IsEuclidean
+      && this->GetBufferedRegion() == this->GetLargestPossibleRegion()
+      && sample.Size() == this->GetNumberOfComponentsPerPixel()
+      && this->GetBufferedRegion().GetNumberOfPixels() > 0)
+    {
+    NearestPrototypeSearch<typename NeuronType::ComponentType> search;
+    search.SetPrototypes(this->GetBufferPointer(), this->GetBufferedRegion().GetNumberOfPixels(),
+                         this->GetNumberOfComponentsPerPixel());
+    search.SetLastOnTie(true);
+    return this->ComputeIndex(search.FindNearest(sample.GetDataPointer()));
+    }
+
   // Some typedefs
   typedef itk::ImageRegionIteratorWithIndex<Self> IteratorType;
 
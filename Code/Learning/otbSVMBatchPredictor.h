@@ -0,0 +1,178 @@
+/*=========================================================================
+
+  Program:   ORFEO Toolbox
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+
+  Copyright (c) Centre National d'Etudes Spatiales. All rights reserved.
+  See OTBCopyright.txt for details.
+
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __otbSVMBatchPredictor_h
+#define __otbSVMBatchPredictor_h
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "otbSVMModel.h"
+#include <vector>
+
+namespace otb
+{
+
+/** \class SVMBatchPredictor
+ * \brief Predicts the labels of blocks of samples with a SVMModel.
+ *
+ * SVMModel::EvaluateLabel() builds a sparse libsvm vector for each
+ * sample and walks the sparse support vectors for each kernel
+ * evaluation. This class converts the support vectors of the model to
+ * a dense matrix once, when the model is set, and classifies blocks of
+ * BlockSize samples at a time: the samples of a block are stored
+ * feature by feature, so that the kernel between one support vector
+ * and all the samples of the block is computed in loops the compiler
+ * can vectorize. Linear, polynomial, RBF and sigmoid kernels are
+ * evaluated this way, in the same order as libsvm, so that the
+ * predicted labels are the same as EvaluateLabel() ones. For the
+ * linear kernel, the support vectors of each hyperplane are further
+ * collapsed into a single weight vector (decision values are then
+ * only equal up to rounding).
+ *
+ * The generic and composed kernels of OTB (see otbSVMKernels.h) are
+ * evaluated with the kernel functor of the model, without allocating
+ * memory for each sample. Models with probability estimates or
+ * precomputed kernels fall back to SVMModel::EvaluateLabel().
+ *
+ * PredictLabels() is thread safe, a single predictor can be shared by
+ * all the threads of a filter. The predictor must be updated with
+ * SetModel() whenever the model changes.
+ *
+ * \sa SVMModel
+ * \sa SVMImageClassificationFilter
+ */
+template <class TValue, class TLabel>
+class ITK_EXPORT SVMBatchPredictor : public itk::Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef SVMBatchPredictor             Self;
+  typedef itk::Object                   Superclass;
+  typedef itk::SmartPointer<Self>       Pointer;
+  typedef itk::SmartPointer<const Self> ConstPointer;
+
+  /** Run-time type information (and related methods). */
+  itkNewMacro(Self);
+  itkTypeMacro(SVMBatchPredictor, itk::Object);
+
+  /** Value and label types */
+  typedef TValue                                ValueType;
+  typedef TLabel                                LabelType;
+  typedef SVMModel<ValueType, LabelType>        ModelType;
+  typedef typename ModelType::ConstPointer      ModelConstPointerType;
+
+  /** Number of samples classified together */
+  itkStaticConstMacro(BlockSize, unsigned int, 64);
+
+  /** Set the model and build its dense representation. The model
+   * must have been trained or loaded. */
+  void SetModel(const ModelType * model);
+
+  /** Get the model */
+  const ModelType * GetModel() const
+  {
+    return m_Model;
+  }
+
+  /** True if the kernel is evaluated on the dense support vectors */
+  bool IsDenseEvaluation() const
+  {
+    return m_PredictionMode == DENSE_KERNEL || m_PredictionMode == LINEAR_HYPERPLANES;
+  }
+
+  /** Get the number of features of the support vectors */
+  itkGetConstMacro(NumberOfFeatures, unsigned int);
+
+  /** Predict the labels of nbSamples samples of nbFeatures values,
+   * stored sample after sample */
+  void PredictLabels(const ValueType * samples, unsigned int nbSamples, unsigned int nbFeatures,
+                     LabelType * labels) const;
+
+protected:
+  /** Constructor */
+  SVMBatchPredictor();
+  /** Destructor */
+  virtual ~SVMBatchPredictor() {}
+  /** PrintSelf method */
+  void PrintSelf(std::ostream& os, itk::Indent indent) const;
+
+private:
+  SVMBatchPredictor(const Self &); //purposely not implemented
+  void operator =(const Self&); //purposely not implemented
+
+  /** How the kernel values are computed */
+  typedef enum { DENSE_KERNEL, LINEAR_HYPERPLANES, KERNEL_FUNCTOR, LIBSVM } PredictionModeType;
+
+  /** Compute the kernel values between the support vectors and a
+   * block of nbSamples samples stored feature by feature (nbFeatures
+   * rows). Values are stored support vector by support vector. */
+  void ComputeDenseKernelValues(const double * block, unsigned int nbSamples, unsigned int nbFeatures,
+                                double * kernelValues) const;
+
+  /** Same with the kernel functor of the model */
+  void ComputeFunctorKernelValues(const ValueType * samples, unsigned int nbSamples, unsigned int nbFeatures,
+                                  double * kernelValues) const;
+
+  /** Compute the labels from the decision values of a block */
+  void ComputeLabels(const double * kernelValues, const double * block, unsigned int nbSamples,
+                     unsigned int nbFeatures, LabelType * labels) const;
+
+  /** Predict with SVMModel::EvaluateLabel */
+  void PredictLabelsWithModel(const ValueType * samples, unsigned int nbSamples, unsigned int nbFeatures,
+                              LabelType * labels) const;
+
+  /** The model */
+  ModelConstPointerType m_Model;
+
+  /** Prediction mode */
+  PredictionModeType m_PredictionMode;
+
+  /** Model parameters */
+  int          m_SVMType;
+  int          m_KernelType;
+  int          m_Degree;
+  double       m_Gamma;
+  double       m_Coef0;
+  unsigned int m_NumberOfClasses;
+  unsigned int m_NumberOfSupportVectors;
+  unsigned int m_NumberOfFeatures;
+
+  /** Support vectors, one row of m_NumberOfFeatures values per vector */
+  std::vector<double> m_SupportVectors;
+
+  /** Coefficients of the support vectors, one row per class but one */
+  std::vector<double> m_Coefficients;
+
+  /** Hyperplanes of the linear kernel, one row per decision function */
+  std::vector<double> m_HyperplaneWeights;
+
+  /** Constants of the decision functions */
+  std::vector<double> m_Rho;
+
+  /** Labels, first support vector and number of support vectors of each class */
+  std::vector<int> m_Labels;
+  std::vector<unsigned int> m_Start;
+  std::vector<unsigned int> m_NumberOfClassSupportVectors;
+};
+
+} // end namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbSVMBatchPredictor.txx"
+#endif
+
+#endif
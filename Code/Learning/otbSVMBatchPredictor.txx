@@ -0,0 +1,518 @@
+/*=========================================================================
+
+  Program:   ORFEO Toolbox
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+
+  Copyright (c) Centre National d'Etudes Spatiales. All rights reserved.
+  See OTBCopyright.txt for details.
+
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __otbSVMBatchPredictor_txx
+#define __otbSVMBatchPredictor_txx
+
+#include "otbSVMBatchPredictor.h"
+#include "otbMacro.h"
+#include "vcl_cmath.h"
+#include <algorithm>
+
+namespace otb
+{
+
+template <class TValue, class TLabel>
+SVMBatchPredictor<TValue, TLabel>
+::SVMBatchPredictor()
+  : m_PredictionMode(LIBSVM),
+    m_SVMType(C_SVC),
+    m_KernelType(LINEAR),
+    m_Degree(0),
+    m_Gamma(0.),
+    m_Coef0(0.),
+    m_NumberOfClasses(0),
+    m_NumberOfSupportVectors(0),
+    m_NumberOfFeatures(0)
+{
+}
+
+template <class TValue, class TLabel>
+void
+SVMBatchPredictor<TValue, TLabel>
+::SetModel(const ModelType * model)
+{
+  if (model == NULL || model->GetModel() == NULL || model->GetModel()->l == 0)
+    {
+    itkExceptionMacro(<< "The model has no support vector, can not predict labels");
+    }
+
+  m_Model = model;
+  this->Modified();
+
+  const struct svm_model * svmModel = model->GetModel();
+  const struct svm_parameter& param = svmModel->param;
+
+  m_SVMType = param.svm_type;
+  m_KernelType = param.kernel_type;
+  m_Degree = param.degree;
+  m_Gamma = param.gamma;
+  m_Coef0 = param.coef0;
+  m_NumberOfClasses = svmModel->nr_class;
+  m_NumberOfSupportVectors = svmModel->l;
+
+  bool isClassification = (m_SVMType == C_SVC || m_SVMType == NU_SVC);
+
+  // Same condition as in SVMModel::EvaluateLabel()
+  bool predictProbability = svm_check_probability_model(svmModel) && isClassification;
+
+  // Dense support vectors, libsvm indices start at 1
+  bool validIndices = true;
+  m_NumberOfFeatures = 0;
+  for (unsigned int i = 0; i < m_NumberOfSupportVectors; ++i)
+    {
+    for (const svm_node * node = svmModel->SV[i]; node->index != -1; ++node)
+      {
+      validIndices = validIndices && (node->index > 0);
+      m_NumberOfFeatures = std::max(m_NumberOfFeatures, static_cast<unsigned int>(node->index));
+      }
+    }
+
+  if (predictProbability || !validIndices || m_KernelType == PRECOMPUTED)
+    {
+    m_PredictionMode = LIBSVM;
+    }
+  else if (m_KernelType == GENERIC || m_KernelType == COMPOSED)
+    {
+    bool hasFunctor = (m_KernelType == GENERIC) ? (param.kernel_generic != NULL) : (param.kernel_composed != NULL);
+    m_PredictionMode = hasFunctor ? KERNEL_FUNCTOR : LIBSVM;
+    }
+  else if (m_KernelType == LINEAR)
+    {
+    m_PredictionMode = LINEAR_HYPERPLANES;
+    }
+  else
+    {
+    m_PredictionMode = DENSE_KERNEL;
+    }
+
+  m_SupportVectors.assign(m_NumberOfSupportVectors * m_NumberOfFeatures, 0.);
+  if (validIndices)
+    {
+    for (unsigned int i = 0; i < m_NumberOfSupportVectors; ++i)
+      {
+      for (const svm_node * node = svmModel->SV[i]; node->index != -1; ++node)
+        {
+        m_SupportVectors[i * m_NumberOfFeatures + node->index - 1] = node->value;
+        }
+      }
+    }
+
+  // Decision functions
+  unsigned int nbCoefficientRows = isClassification ? m_NumberOfClasses - 1 : 1;
+  unsigned int nbDecisions = isClassification ? m_NumberOfClasses * (m_NumberOfClasses - 1) / 2 : 1;
+
+  m_Coefficients.resize(nbCoefficientRows * m_NumberOfSupportVectors);
+  for (unsigned int r = 0; r < nbCoefficientRows; ++r)
+    {
+    std::copy(svmModel->sv_coef[r], svmModel->sv_coef[r] + m_NumberOfSupportVectors,
+              m_Coefficients.begin() + r * m_NumberOfSupportVectors);
+    }
+  m_Rho.assign(svmModel->rho, svmModel->rho + nbDecisions);
+
+  m_Labels.clear();
+  m_Start.clear();
+  m_NumberOfClassSupportVectors.clear();
+  if (isClassification)
+    {
+    unsigned int start = 0;
+    for (unsigned int c = 0; c < m_NumberOfClasses; ++c)
+      {
+      m_Labels.push_back(svmModel->label[c]);
+      m_Start.push_back(start);
+      m_NumberOfClassSupportVectors.push_back(svmModel->nSV[c]);
+      start += svmModel->nSV[c];
+      }
+    }
+
+  // With a linear kernel, each decision function is a single dot product
+  m_HyperplaneWeights.clear();
+  if (m_PredictionMode == LINEAR_HYPERPLANES)
+    {
+    m_HyperplaneWeights.assign(nbDecisions * m_NumberOfFeatures, 0.);
+
+    if (isClassification)
+      {
+      unsigned int p = 0;
+      for (unsigned int i = 0; i < m_NumberOfClasses; ++i)
+        {
+        for (unsigned int j = i + 1; j < m_NumberOfClasses; ++j, ++p)
+          {
+          double * w = &m_HyperplaneWeights[p * m_NumberOfFeatures];
+          const double * coef1 = &m_Coefficients[(j - 1) * m_NumberOfSupportVectors];
+          const double * coef2 = &m_Coefficients[i * m_NumberOfSupportVectors];
+          for (unsigned int k = m_Start[i]; k < m_Start[i] + m_NumberOfClassSupportVectors[i]; ++k)
+            {
+            for (unsigned int f = 0; f < m_NumberOfFeatures; ++f)
+              {
+              w[f] += coef1[k] * m_SupportVectors[k * m_NumberOfFeatures + f];
+              }
+            }
+          for (unsigned int k = m_Start[j]; k < m_Start[j] + m_NumberOfClassSupportVectors[j]; ++k)
+            {
+            for (unsigned int f = 0; f < m_NumberOfFeatures; ++f)
+              {
+              w[f] += coef2[k] * m_SupportVectors[k * m_NumberOfFeatures + f];
+              }
+            }
+          }
+        }
+      }
+    else
+      {
+      for (unsigned int k = 0; k < m_NumberOfSupportVectors; ++k)
+        {
+        for (unsigned int f = 0; f < m_NumberOfFeatures; ++f)
+          {
+          m_HyperplaneWeights[f] += m_Coefficients[k] * m_SupportVectors[k * m_NumberOfFeatures + f];
+          }
+        }
+      }
+    }
+
+  otbMsgDevMacro(<< "SVMBatchPredictor: " << m_NumberOfSupportVectors << " support vectors of "
+                 << m_NumberOfFeatures << " features, prediction mode " << m_PredictionMode);
+}
+
+template <class TValue, class TLabel>
+void
+SVMBatchPredictor<TValue, TLabel>
+::PredictLabels(const ValueType * samples, unsigned int nbSamples, unsigned int nbFeatures,
+                LabelType * labels) const
+{
+  if (m_Model.IsNull())
+    {
+    itkExceptionMacro(<< "No model set, can not predict labels");
+    }
+
+  if (m_PredictionMode == LIBSVM)
+    {
+    this->PredictLabelsWithModel(samples, nbSamples, nbFeatures, labels);
+    return;
+    }
+
+  // Samples with less features than the support vectors are padded with zeros
+  const unsigned int nbBlockFeatures = std::max(nbFeatures, m_NumberOfFeatures);
+
+  std::vector<double> block(nbBlockFeatures * BlockSize);
+  std::vector<double> kernelValues;
+  if (m_PredictionMode != LINEAR_HYPERPLANES)
+    {
+    kernelValues.resize(m_NumberOfSupportVectors * BlockSize);
+    }
+
+  for (unsigned int start = 0; start < nbSamples; start += BlockSize)
+    {
+    const unsigned int nb = std::min(static_cast<unsigned int>(BlockSize), nbSamples - start);
+    const ValueType * blockSamples = samples + start * nbFeatures;
+
+    // Store the block feature by feature
+    for (unsigned int f = 0; f < nbBlockFeatures; ++f)
+      {
+      double * row = &block[f * nb];
+      if (f < nbFeatures)
+        {
+        for (unsigned int b = 0; b < nb; ++b)
+          {
+          row[b] = static_cast<double>(blockSamples[b * nbFeatures + f]);
+          }
+        }
+      else
+        {
+        std::fill(row, row + nb, 0.);
+        }
+      }
+
+    if (m_PredictionMode == DENSE_KERNEL)
+      {
+      this->ComputeDenseKernelValues(&block[0], nb, nbBlockFeatures, &kernelValues[0]);
+      }
+    else if (m_PredictionMode == KERNEL_FUNCTOR)
+      {
+      this->ComputeFunctorKernelValues(blockSamples, nb, nbFeatures, &kernelValues[0]);
+      }
+
+    this->ComputeLabels(kernelValues.empty() ? NULL : &kernelValues[0], &block[0], nb, nbBlockFeatures,
+                        labels + start);
+    }
+}
+
+template <class TValue, class TLabel>
+void
+SVMBatchPredictor<TValue, TLabel>
+::ComputeDenseKernelValues(const double * block, unsigned int nbSamples, unsigned int nbFeatures,
+                           double * kernelValues) const
+{
+  std::vector<double> sum(nbSamples);
+
+  for (unsigned int i = 0; i < m_NumberOfSupportVectors; ++i)
+    {
+    const double * sv = &m_SupportVectors[i * m_NumberOfFeatures];
+    double * values = kernelValues + i * nbSamples;
+    std::fill(sum.begin(), sum.end(), 0.);
+
+    if (m_KernelType == RBF)
+      {
+      // Squared distance, accumulated in the same order as libsvm
+      for (unsigned int f = 0; f < m_NumberOfFeatures; ++f)
+        {
+        const double   s = sv[f];
+        const double * x = block + f * nbSamples;
+        for (unsigned int b = 0; b < nbSamples; ++b)
+          {
+          const double d = x[b] - s;
+          sum[b] += d * d;
+          }
+        }
+      for (unsigned int f = m_NumberOfFeatures; f < nbFeatures; ++f)
+        {
+        const double * x = block + f * nbSamples;
+        for (unsigned int b = 0; b < nbSamples; ++b)
+          {
+          sum[b] += x[b] * x[b];
+          }
+        }
+      for (unsigned int b = 0; b < nbSamples; ++b)
+        {
+        values[b] = vcl_exp(-m_Gamma * sum[b]);
+        }
+      continue;
+      }
+
+    // Dot product based kernels
+    for (unsigned int f = 0; f < m_NumberOfFeatures; ++f)
+      {
+      const double   s = sv[f];
+      const double * x = block + f * nbSamples;
+      for (unsigned int b = 0; b < nbSamples; ++b)
+        {
+        sum[b] += x[b] * s;
+        }
+      }
+
+    switch (m_KernelType)
+      {
+      case POLY:
+        for (unsigned int b = 0; b < nbSamples; ++b)
+          {
+          // Same integer power as libsvm
+          double base = m_Gamma * sum[b] + m_Coef0;
+          double value = 1.0;
+          for (int t = m_Degree; t > 0; t /= 2)
+            {
+            if (t % 2 == 1)
+              {
+              value *= base;
+              }
+            base = base * base;
+            }
+          values[b] = value;
+          }
+        break;
+      case SIGMOID:
+        for (unsigned int b = 0; b < nbSamples; ++b)
+          {
+          values[b] = vcl_tanh(m_Gamma * sum[b] + m_Coef0);
+          }
+        break;
+      default:
+        std::copy(sum.begin(), sum.end(), values);
+        break;
+      }
+    }
+}
+
+template <class TValue, class TLabel>
+void
+SVMBatchPredictor<TValue, TLabel>
+::ComputeFunctorKernelValues(const ValueType * samples, unsigned int nbSamples, unsigned int nbFeatures,
+                             double * kernelValues) const
+{
+  const struct svm_model *     svmModel = m_Model->GetModel();
+  const struct svm_parameter&  param = svmModel->param;
+  const GenericKernelFunctorBase * functor = (m_KernelType == GENERIC)
+    ? param.kernel_generic : static_cast<const GenericKernelFunctorBase *>(param.kernel_composed);
+
+  // The sparse sample is reused for the whole block
+  std::vector<svm_node> x(nbFeatures + 1);
+  x[nbFeatures].index = -1;
+  x[nbFeatures].value = 0;
+
+  for (unsigned int b = 0; b < nbSamples; ++b)
+    {
+    for (unsigned int f = 0; f < nbFeatures; ++f)
+      {
+      x[f].index = f + 1;
+      x[f].value = samples[b * nbFeatures + f];
+      }
+    for (unsigned int i = 0; i < m_NumberOfSupportVectors; ++i)
+      {
+      kernelValues[i * nbSamples + b] = (*functor)(&x[0], svmModel->SV[i], param);
+      }
+    }
+}
+
+template <class TValue, class TLabel>
+void
+SVMBatchPredictor<TValue, TLabel>
+::ComputeLabels(const double * kernelValues, const double * block, unsigned int nbSamples,
+                unsigned int nbFeatures, LabelType * labels) const
+{
+  std::vector<double> sum(nbSamples);
+
+  if (m_SVMType == ONE_CLASS || m_SVMType == EPSILON_SVR || m_SVMType == NU_SVR)
+    {
+    if (m_PredictionMode == LINEAR_HYPERPLANES)
+      {
+      for (unsigned int f = 0; f < m_NumberOfFeatures; ++f)
+        {
+        const double   w = m_HyperplaneWeights[f];
+        const double * x = block + f * nbSamples;
+        for (unsigned int b = 0; b < nbSamples; ++b)
+          {
+          sum[b] += x[b] * w;
+          }
+        }
+      }
+    else
+      {
+      for (unsigned int i = 0; i < m_NumberOfSupportVectors; ++i)
+        {
+        const double   c = m_Coefficients[i];
+        const double * k = kernelValues + i * nbSamples;
+        for (unsigned int b = 0; b < nbSamples; ++b)
+          {
+          sum[b] += c * k[b];
+          }
+        }
+      }
+
+    for (unsigned int b = 0; b < nbSamples; ++b)
+      {
+      double value = sum[b] - m_Rho[0];
+      if (m_SVMType == ONE_CLASS)
+        {
+        value = (value > 0) ? 1 : -1;
+        }
+      labels[b] = static_cast<LabelType>(value);
+      }
+    return;
+    }
+
+  // One against one voting
+  std::vector<unsigned int> votes(m_NumberOfClasses * nbSamples, 0);
+
+  unsigned int p = 0;
+  for (unsigned int i = 0; i < m_NumberOfClasses; ++i)
+    {
+    for (unsigned int j = i + 1; j < m_NumberOfClasses; ++j, ++p)
+      {
+      std::fill(sum.begin(), sum.end(), 0.);
+
+      if (m_PredictionMode == LINEAR_HYPERPLANES)
+        {
+        const double * w = &m_HyperplaneWeights[p * m_NumberOfFeatures];
+        for (unsigned int f = 0; f < m_NumberOfFeatures; ++f)
+          {
+          const double * x = block + f * nbSamples;
+          for (unsigned int b = 0; b < nbSamples; ++b)
+            {
+            sum[b] += x[b] * w[f];
+            }
+          }
+        }
+      else
+        {
+        // Same accumulation order as libsvm
+        const double * coef1 = &m_Coefficients[(j - 1) * m_NumberOfSupportVectors];
+        const double * coef2 = &m_Coefficients[i * m_NumberOfSupportVectors];
+        for (unsigned int k = m_Start[i]; k < m_Start[i] + m_NumberOfClassSupportVectors[i]; ++k)
+          {
+          const double   c = coef1[k];
+          const double * kv = kernelValues + k * nbSamples;
+          for (unsigned int b = 0; b < nbSamples; ++b)
+            {
+            sum[b] += c * kv[b];
+            }
+          }
+        for (unsigned int k = m_Start[j]; k < m_Start[j] + m_NumberOfClassSupportVectors[j]; ++k)
+          {
+          const double   c = coef2[k];
+          const double * kv = kernelValues + k * nbSamples;
+          for (unsigned int b = 0; b < nbSamples; ++b)
+            {
+            sum[b] += c * kv[b];
+            }
+          }
+        }
+
+      for (unsigned int b = 0; b < nbSamples; ++b)
+        {
+        if (sum[b] - m_Rho[p] > 0)
+          {
+          ++votes[i * nbSamples + b];
+          }
+        else
+          {
+          ++votes[j * nbSamples + b];
+          }
+        }
+      }
+    }
+
+  for (unsigned int b = 0; b < nbSamples; ++b)
+    {
+    unsigned int voteMaxIdx = 0;
+    for (unsigned int c = 1; c < m_NumberOfClasses; ++c)
+      {
+      if (votes[c * nbSamples + b] > votes[voteMaxIdx * nbSamples + b])
+        {
+        voteMaxIdx = c;
+        }
+      }
+    labels[b] = static_cast<LabelType>(m_Labels[voteMaxIdx]);
+    }
+}
+
+template <class TValue, class TLabel>
+void
+SVMBatchPredictor<TValue, TLabel>
+::PredictLabelsWithModel(const ValueType * samples, unsigned int nbSamples, unsigned int nbFeatures,
+                         LabelType * labels) const
+{
+  typename ModelType::MeasurementType measure(nbFeatures);
+  for (unsigned int s = 0; s < nbSamples; ++s)
+    {
+    std::copy(samples + s * nbFeatures, samples + (s + 1) * nbFeatures, measure.begin());
+    labels[s] = m_Model->EvaluateLabel(measure);
+    }
+}
+
+template <class TValue, class TLabel>
+void
+SVMBatchPredictor<TValue, TLabel>
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Number of support vectors: " << m_NumberOfSupportVectors << std::endl;
+  os << indent << "Number of features: " << m_NumberOfFeatures << std::endl;
+  os << indent << "Dense evaluation: " << (this->IsDenseEvaluation() ? "On" : "Off") << std::endl;
+}
+
+} // end namespace otb
+
+#endif
@@ -20,6 +20,7 @@
 
 #include "itkInPlaceImageFilter.h"
 #include "otbSVMModel.h"
+#include "otbSVMBatchPredictor.h"
 
 namespace otb
 {
@@ -29,6 +30,9 @@ namespace otb
  *  This filter is streamed and threaded, allowing to classify huge images
  *  while fully using several core.
  *
+ *  Pixels are classified line by line with a SVMBatchPredictor, which
+ *  evaluates the usual kernels on a dense copy of the support vectors.
+ *
  * \sa SVMClassifier
  * \ingroup Streamed
  * \ingroup Threaded
@@ -71,6 +75,9 @@ public:
   typedef SVMModel<ValueType, LabelType> ModelType;
   typedef typename ModelType::Pointer    ModelPointerType;
 
+  typedef SVMBatchPredictor<ValueType, LabelType> PredictorType;
+  typedef typename PredictorType::Pointer         PredictorPointerType;
+
   /** Set/Get the svm model */
   itkSetObjectMacro(Model, ModelType);
   itkGetObjectMacro(Model, ModelType);
@@ -110,6 +117,8 @@ private:
 
   /** The SVM model used for classification */
   ModelPointerType m_Model;
+  /** The predictor built from the model before each update */
+  PredictorPointerType m_Predictor;
   /** Default label for invalid pixels (when using a mask) */
   LabelType m_DefaultLabel;
 
@@ -66,6 +66,10 @@ SVMImageClassificationFilter<TInputImage, TOutputImage, TMaskImage>
     {
     itkGenericExceptionMacro(<< "No model for classification");
     }
+
+  // Dense representation of the model, shared by all threads
+  m_Predictor = PredictorType::New();
+  m_Predictor->SetModel(m_Model);
 }
 
 template <class TInputImage, class TOutputImage, class TMaskImage>
@@ -99,32 +103,54 @@ SVMImageClassificationFilter<TInputImage, TOutputImage, TMaskImage>
 
   bool validPoint = true;
 
+  // Pixels are classified line by line
+  const unsigned int lineSize = outputRegionForThread.GetSize()[0];
+  const unsigned int nbFeatures = inputPtr->GetNumberOfComponentsPerPixel();
+
+  std::vector<ValueType> samples;
+  samples.reserve(lineSize * nbFeatures);
+  std::vector<LabelType> labels(lineSize);
+  std::vector<bool>      validPoints(lineSize);
+
   // Walk the part of the image
-  for (inIt.GoToBegin(), outIt.GoToBegin(); !inIt.IsAtEnd() && !outIt.IsAtEnd(); ++inIt, ++outIt)
+  inIt.GoToBegin();
+  outIt.GoToBegin();
+  while (!inIt.IsAtEnd() && !outIt.IsAtEnd())
     {
-    // Check pixel validity
-    if (inputMaskPtr)
+    // Gather the valid pixels of the line
+    samples.clear();
+    unsigned int nbPixels = 0;
+    for (; nbPixels < lineSize && !inIt.IsAtEnd(); ++nbPixels, ++inIt)
       {
-      validPoint = maskIt.Get() > 0;
-      ++maskIt;
-      }
-    // If point is valid
-    if (validPoint)
-      {
-      // Classifify
-      typename ModelType::MeasurementType measure;
-      for (unsigned int i = 0; i < inIt.Get().Size(); ++i)
+      // Check pixel validity
+      if (inputMaskPtr)
         {
-        measure.push_back(inIt.Get()[i]);
+        validPoint = maskIt.Get() > 0;
+        ++maskIt;
+        }
+      validPoints[nbPixels] = validPoint;
+      if (validPoint)
+        {
+        for (unsigned int i = 0; i < nbFeatures; ++i)
+          {
+          samples.push_back(inIt.Get()[i]);
+          }
         }
-      outIt.Set(m_Model->EvaluateLabel(measure));
       }
-    else
+
+    // Classify
+    if (!samples.empty())
+      {
+      m_Predictor->PredictLabels(&samples[0], samples.size() / nbFeatures, nbFeatures, &labels[0]);
+      }
+
+    // Write the labels, or the default value for invalid pixels
+    unsigned int labelIndex = 0;
+    for (unsigned int i = 0; i < nbPixels && !outIt.IsAtEnd(); ++i, ++outIt)
       {
-      // else, set default value
-      outIt.Set(m_DefaultLabel);
+      outIt.Set(validPoints[i] ? labels[labelIndex++] : m_DefaultLabel);
+      progress.CompletedPixel();
       }
-    progress.CompletedPixel();
     }
 
 }
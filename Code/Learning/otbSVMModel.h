@@ -106,6 +106,10 @@ public:
   {
     return m_Model;
   }
+  const struct svm_model* GetModel() const
+  {
+    return m_Model;
+  }
 
   /** Gets the parameters */
   struct svm_parameter& GetParameters()
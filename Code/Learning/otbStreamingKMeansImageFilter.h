@@ -0,0 +1,358 @@
+/*=========================================================================
+
+  Program:   ORFEO Toolbox
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+
+  Copyright (c) Centre National d'Etudes Spatiales. All rights reserved.
+  See OTBCopyright.txt for details.
+
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __otbStreamingKMeansImageFilter_h
+#define __otbStreamingKMeansImageFilter_h
+
+#include "otbPersistentImageFilter.h"
+#include "otbPersistentFilterStreamingDecorator.h"
+#include "otbNearestPrototypeSearch.h"
+#include "otbImage.h"
+#include "itkArray.h"
+#include <vector>
+
+namespace otb
+{
+
+/** \class PersistentKMeansImageFilter
+ * \brief Performs one KMeans pass over a large image using streaming.
+ *
+ * This filter persists its temporary data: each streamed region adds
+ * its pixels to the sums of the centroids they are nearest to, and
+ * Synthetize() replaces each centroid by the mean of its pixels. Only
+ * the centroids and their sums are kept in memory, whatever the size
+ * of the image. The nearest centroid is found with a
+ * NearestPrototypeSearch, and each thread has its own sums.
+ *
+ * Pixels can be restricted to the non-zero pixels of a mask and
+ * subsampled on a regular grid of SubsampleFactor pixels, anchored at
+ * index 0 so that it does not depend on the streaming.
+ *
+ * When MiniBatch is on (the default), the centroids are also updated
+ * after each streamed region, which is then a mini-batch: the pixels
+ * of the next regions are assigned to the updated centroids, which
+ * makes a pass converge much faster. When MiniBatch is off, the
+ * centroids are only updated by Synthetize() (Lloyd iterations), and
+ * the result does not depend on the streaming.
+ *
+ * The centroids are stored centroid after centroid, with the number of
+ * components of the input image per centroid, as expected by
+ * KMeansImageClassificationFilter when its MaxSampleDimension is this
+ * number of components. If they do not match the NumberOfClasses when
+ * Reset() is called, the pass only computes the band minimum and
+ * maximum of the pixels, and Synthetize() spreads the initial
+ * centroids along the diagonal between them.
+ *
+ * \sa StreamingKMeansImageFilter
+ * \sa KMeansImageClassificationFilter
+ * \ingroup Streamed
+ * \ingroup Multithreaded
+ */
+template <class TInputImage, class TMaskImage = otb::Image<unsigned char, TInputImage::ImageDimension> >
+class ITK_EXPORT PersistentKMeansImageFilter :
+  public PersistentImageFilter<TInputImage, TInputImage>
+{
+public:
+  /** Standard Self typedef */
+  typedef PersistentKMeansImageFilter                     Self;
+  typedef PersistentImageFilter<TInputImage, TInputImage> Superclass;
+  typedef itk::SmartPointer<Self>                         Pointer;
+  typedef itk::SmartPointer<const Self>                   ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(PersistentKMeansImageFilter, PersistentImageFilter);
+
+  /** Image related typedefs. */
+  typedef TInputImage                             ImageType;
+  typedef typename TInputImage::Pointer           InputImagePointer;
+  typedef typename TInputImage::RegionType        RegionType;
+  typedef typename TInputImage::SizeType          SizeType;
+  typedef typename TInputImage::IndexType         IndexType;
+  typedef typename TInputImage::PixelType         PixelType;
+  typedef typename TInputImage::InternalPixelType InternalPixelType;
+
+  typedef TMaskImage                           MaskImageType;
+  typedef typename MaskImageType::ConstPointer MaskImageConstPointerType;
+
+  /** Centroids, centroid after centroid */
+  typedef itk::Array<double> CentroidsType;
+
+  /** Nearest centroid search */
+  typedef NearestPrototypeSearch<double> NearestCentroidSearchType;
+
+  /** Number of pixels classified together */
+  itkStaticConstMacro(BlockSize, unsigned int, 64);
+
+  /** Set/Get the number of classes */
+  itkSetMacro(NumberOfClasses, unsigned int);
+  itkGetConstMacro(NumberOfClasses, unsigned int);
+
+  /** Set/Get the subsampling factor (1 uses every pixel) */
+  itkSetMacro(SubsampleFactor, unsigned int);
+  itkGetConstMacro(SubsampleFactor, unsigned int);
+
+  /** Update the centroids after each streamed region */
+  itkSetMacro(MiniBatch, bool);
+  itkGetConstMacro(MiniBatch, bool);
+  itkBooleanMacro(MiniBatch);
+
+  /** Set/Get the centroids. They are updated by each pass. */
+  itkSetMacro(Centroids, CentroidsType);
+  itkGetConstReferenceMacro(Centroids, CentroidsType);
+
+  /** True if the centroids match the number of classes and components */
+  bool HasValidCentroids() const;
+
+  /** Number of pixels used by the last pass */
+  itkGetConstMacro(NumberOfSamples, unsigned long);
+
+  /** Sum of the squared distances of the pixels to their centroid
+   * during the last pass */
+  itkGetConstMacro(Inertia, double);
+
+  /** Largest displacement of a centroid during the last pass */
+  itkGetConstMacro(CentroidsShift, double);
+
+  /**
+   * If set, only pixels within the mask will be used.
+   * \param mask The input mask.
+   */
+  void SetInputMask(const MaskImageType * mask);
+
+  /**
+   * Get the input mask.
+   * \return The mask.
+   */
+  const MaskImageType * GetInputMask(void);
+
+  /** Pass the input through unmodified. Do this by Grafting in the
+   *  AllocateOutputs method.
+   */
+  virtual void AllocateOutputs();
+  virtual void GenerateOutputInformation();
+  virtual void Synthetize(void);
+  virtual void Reset(void);
+
+protected:
+  PersistentKMeansImageFilter();
+  virtual ~PersistentKMeansImageFilter() {}
+  virtual void PrintSelf(std::ostream& os, itk::Indent indent) const;
+
+  /** Before threaded generate data */
+  virtual void BeforeThreadedGenerateData();
+  /** Multi-thread version GenerateData. */
+  virtual void ThreadedGenerateData(const RegionType& outputRegionForThread, int threadId);
+  /** Gather the sums of the threads */
+  virtual void AfterThreadedGenerateData();
+
+private:
+  PersistentKMeansImageFilter(const Self &); //purposely not implemented
+  void operator =(const Self&); //purposely not implemented
+
+  /** Add the sums of the threads to the sums of the pass */
+  void GatherThreadSums();
+
+  /** Set the centroids to the mean of their pixels */
+  void UpdateCentroids();
+
+  /** Parameters */
+  unsigned int m_NumberOfClasses;
+  unsigned int m_SubsampleFactor;
+  bool         m_MiniBatch;
+
+  /** Current centroids, and centroids at the beginning of the pass */
+  CentroidsType m_Centroids;
+  CentroidsType m_PreviousCentroids;
+
+  /** True if the pass computes the initial centroids */
+  bool m_Initialization;
+
+  /** Number of components of the input */
+  unsigned int m_NumberOfComponents;
+
+  /** Search of the nearest centroid */
+  NearestCentroidSearchType m_NearestCentroid;
+
+  /** Sums of the pixels (or band minimum then maximum during the
+   * initialization), pixel counts and inertia, per thread and for the pass */
+  std::vector<std::vector<double> >        m_ThreadSums;
+  std::vector<std::vector<unsigned long> > m_ThreadCounts;
+  std::vector<double>                      m_ThreadInertia;
+  std::vector<double>                      m_Sums;
+  std::vector<unsigned long>               m_Counts;
+
+  /** Results of the pass */
+  unsigned long m_NumberOfSamples;
+  double        m_Inertia;
+  double        m_CentroidsShift;
+};
+
+/**===========================================================================*/
+
+/** \class StreamingKMeansImageFilter
+ * \brief Estimates KMeans centroids of an image larger than the memory.
+ *
+ * This class streams the whole input image through the
+ * PersistentKMeansImageFilter, pass after pass, until the largest
+ * displacement of a centroid during a pass is below the
+ * ConvergenceThreshold or MaximumNumberOfIterations passes are done.
+ * If no valid initial centroids were set, a first pass initializes
+ * them (see PersistentKMeansImageFilter). The accessors wrap those of
+ * the internal persistent filter.
+ *
+ * \sa PersistentKMeansImageFilter
+ * \sa PersistentFilterStreamingDecorator
+ * \sa StreamingImageVirtualWriter
+ * \ingroup Streamed
+ * \ingroup Multithreaded
+ */
+template <class TInputImage, class TMaskImage = otb::Image<unsigned char, TInputImage::ImageDimension> >
+class ITK_EXPORT StreamingKMeansImageFilter :
+  public PersistentFilterStreamingDecorator<PersistentKMeansImageFilter<TInputImage, TMaskImage> >
+{
+public:
+  /** Standard Self typedef */
+  typedef StreamingKMeansImageFilter Self;
+  typedef PersistentFilterStreamingDecorator
+  <PersistentKMeansImageFilter<TInputImage, TMaskImage> > Superclass;
+  typedef itk::SmartPointer<Self>       Pointer;
+  typedef itk::SmartPointer<const Self> ConstPointer;
+
+  /** Type macro */
+  itkNewMacro(Self);
+
+  /** Creation through object factory macro */
+  itkTypeMacro(StreamingKMeansImageFilter, PersistentFilterStreamingDecorator);
+
+  typedef TInputImage                              InputImageType;
+  typedef TMaskImage                               MaskImageType;
+  typedef typename Superclass::FilterType          KMeansFilterType;
+  typedef typename KMeansFilterType::CentroidsType CentroidsType;
+
+  void SetInput(InputImageType * input)
+  {
+    this->GetFilter()->SetInput(input);
+  }
+  const InputImageType * GetInput()
+  {
+    return this->GetFilter()->GetInput();
+  }
+
+  void SetInputMask(const MaskImageType * mask)
+  {
+    this->GetFilter()->SetInputMask(mask);
+  }
+  const MaskImageType * GetInputMask()
+  {
+    return this->GetFilter()->GetInputMask();
+  }
+
+  /** Set/Get the number of classes */
+  void SetNumberOfClasses(unsigned int nbClasses)
+  {
+    this->GetFilter()->SetNumberOfClasses(nbClasses);
+  }
+  unsigned int GetNumberOfClasses() const
+  {
+    return this->GetFilter()->GetNumberOfClasses();
+  }
+
+  /** Set/Get the subsampling factor */
+  void SetSubsampleFactor(unsigned int factor)
+  {
+    this->GetFilter()->SetSubsampleFactor(factor);
+  }
+  unsigned int GetSubsampleFactor() const
+  {
+    return this->GetFilter()->GetSubsampleFactor();
+  }
+
+  /** Update the centroids after each streamed region */
+  void SetMiniBatch(bool flag)
+  {
+    this->GetFilter()->SetMiniBatch(flag);
+  }
+  bool GetMiniBatch() const
+  {
+    return this->GetFilter()->GetMiniBatch();
+  }
+  itkBooleanMacro(MiniBatch);
+
+  /** Set the initial centroids, get the estimated ones */
+  void SetCentroids(const CentroidsType& centroids)
+  {
+    this->GetFilter()->SetCentroids(centroids);
+  }
+  const CentroidsType& GetCentroids() const
+  {
+    return this->GetFilter()->GetCentroids();
+  }
+
+  /** Sum of the squared distances of the pixels to their centroid */
+  double GetInertia() const
+  {
+    return this->GetFilter()->GetInertia();
+  }
+
+  /** Number of pixels used by each pass */
+  unsigned long GetNumberOfSamples() const
+  {
+    return this->GetFilter()->GetNumberOfSamples();
+  }
+
+  /** Set/Get the maximum number of passes */
+  itkSetMacro(MaximumNumberOfIterations, unsigned int);
+  itkGetConstMacro(MaximumNumberOfIterations, unsigned int);
+
+  /** Set/Get the largest centroid displacement of a converged pass */
+  itkSetMacro(ConvergenceThreshold, double);
+  itkGetConstMacro(ConvergenceThreshold, double);
+
+  /** Number of passes done by the last update */
+  itkGetConstMacro(NumberOfIterations, unsigned int);
+
+protected:
+  /** Constructor */
+  StreamingKMeansImageFilter();
+  /** Destructor */
+  virtual ~StreamingKMeansImageFilter() {}
+
+  /** Stream the image until convergence */
+  virtual void GenerateData(void);
+
+  /** PrintSelf method */
+  virtual void PrintSelf(std::ostream& os, itk::Indent indent) const;
+
+private:
+  StreamingKMeansImageFilter(const Self &); //purposely not implemented
+  void operator =(const Self&); //purposely not implemented
+
+  unsigned int m_MaximumNumberOfIterations;
+  double       m_ConvergenceThreshold;
+  unsigned int m_NumberOfIterations;
+};
+
+} // end namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbStreamingKMeansImageFilter.txx"
+#endif
+
+#endif
@@ -0,0 +1,466 @@
+/*=========================================================================
+
+  Program:   ORFEO Toolbox
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+
+  Copyright (c) Centre National d'Etudes Spatiales. All rights reserved.
+  See OTBCopyright.txt for details.
+
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __otbStreamingKMeansImageFilter_txx
+#define __otbStreamingKMeansImageFilter_txx
+
+#include "otbStreamingKMeansImageFilter.h"
+#include "otbSubsampledImageRegionConstIterator.h"
+#include "itkNumericTraits.h"
+#include "otbMacro.h"
+#include "vcl_cmath.h"
+#include <algorithm>
+
+namespace otb
+{
+
+template <class TInputImage, class TMaskImage>
+PersistentKMeansImageFilter<TInputImage, TMaskImage>
+::PersistentKMeansImageFilter()
+  : m_NumberOfClasses(2),
+    m_SubsampleFactor(1),
+    m_MiniBatch(true),
+    m_Initialization(false),
+    m_NumberOfComponents(0),
+    m_NumberOfSamples(0),
+    m_Inertia(0.),
+    m_CentroidsShift(0.)
+{
+  this->SetNumberOfInputs(2);
+  this->SetNumberOfRequiredInputs(1);
+}
+
+template <class TInputImage, class TMaskImage>
+void
+PersistentKMeansImageFilter<TInputImage, TMaskImage>
+::SetInputMask(const MaskImageType * mask)
+{
+  this->itk::ProcessObject::SetNthInput(1, const_cast<MaskImageType *>(mask));
+}
+
+template <class TInputImage, class TMaskImage>
+const typename PersistentKMeansImageFilter<TInputImage, TMaskImage>
+::MaskImageType *
+PersistentKMeansImageFilter<TInputImage, TMaskImage>
+::GetInputMask()
+{
+  if (this->GetNumberOfInputs() < 2)
+    {
+    return 0;
+    }
+  return static_cast<const MaskImageType *>(this->itk::ProcessObject::GetInput(1));
+}
+
+template <class TInputImage, class TMaskImage>
+bool
+PersistentKMeansImageFilter<TInputImage, TMaskImage>
+::HasValidCentroids() const
+{
+  const TInputImage * inputPtr = this->GetInput();
+  return inputPtr != 0 && m_NumberOfClasses > 0
+         && m_Centroids.Size() == m_NumberOfClasses * inputPtr->GetNumberOfComponentsPerPixel();
+}
+
+template <class TInputImage, class TMaskImage>
+void
+PersistentKMeansImageFilter<TInputImage, TMaskImage>
+::GenerateOutputInformation()
+{
+  Superclass::GenerateOutputInformation();
+  if (this->GetInput())
+    {
+    this->GetOutput()->CopyInformation(this->GetInput());
+    this->GetOutput()->SetLargestPossibleRegion(this->GetInput()->GetLargestPossibleRegion());
+
+    if (this->GetOutput()->GetRequestedRegion().GetNumberOfPixels() == 0)
+      {
+      this->GetOutput()->SetRequestedRegion(this->GetOutput()->GetLargestPossibleRegion());
+      }
+    }
+}
+
+template <class TInputImage, class TMaskImage>
+void
+PersistentKMeansImageFilter<TInputImage, TMaskImage>
+::AllocateOutputs()
+{
+  // The output image of this filter is not intended to be used
+}
+
+template <class TInputImage, class TMaskImage>
+void
+PersistentKMeansImageFilter<TInputImage, TMaskImage>
+::Reset()
+{
+  TInputImage * inputPtr = const_cast<TInputImage *>(this->GetInput());
+  inputPtr->UpdateOutputInformation();
+
+  if (m_NumberOfClasses == 0 || m_SubsampleFactor == 0)
+    {
+    itkExceptionMacro(<< "The number of classes and the subsample factor must be positive");
+    }
+
+  m_NumberOfComponents = inputPtr->GetNumberOfComponentsPerPixel();
+  m_Initialization = !this->HasValidCentroids();
+
+  // Band minimum then maximum during the initialization
+  if (m_Initialization)
+    {
+    m_Sums.resize(2 * m_NumberOfComponents);
+    std::fill(m_Sums.begin(), m_Sums.begin() + m_NumberOfComponents, itk::NumericTraits<double>::max());
+    std::fill(m_Sums.begin() + m_NumberOfComponents, m_Sums.end(), -itk::NumericTraits<double>::max());
+    m_Counts.assign(1, 0);
+    }
+  else
+    {
+    m_Sums.assign(m_NumberOfClasses * m_NumberOfComponents, 0.);
+    m_Counts.assign(m_NumberOfClasses, 0);
+    }
+
+  unsigned int numberOfThreads = this->GetNumberOfThreads();
+  m_ThreadSums.assign(numberOfThreads, m_Sums);
+  m_ThreadCounts.assign(numberOfThreads, m_Counts);
+  m_ThreadInertia.assign(numberOfThreads, 0.);
+
+  m_PreviousCentroids = m_Centroids;
+  m_NumberOfSamples = 0;
+  m_Inertia = 0.;
+  m_CentroidsShift = 0.;
+
+  // Each pass must go through the whole image again
+  this->Modified();
+}
+
+template <class TInputImage, class TMaskImage>
+void
+PersistentKMeansImageFilter<TInputImage, TMaskImage>
+::BeforeThreadedGenerateData()
+{
+  for (unsigned int threadId = 0; threadId < m_ThreadSums.size(); ++threadId)
+    {
+    if (m_Initialization)
+      {
+      m_ThreadSums[threadId] = m_Sums;
+      }
+    else
+      {
+      m_ThreadSums[threadId].assign(m_Sums.size(), 0.);
+      }
+    m_ThreadCounts[threadId].assign(m_Counts.size(), 0);
+    m_ThreadInertia[threadId] = 0.;
+    }
+
+  if (!m_Initialization)
+    {
+    m_NearestCentroid.SetPrototypes(m_Centroids.data_block(), m_NumberOfClasses, m_NumberOfComponents);
+    }
+}
+
+template <class TInputImage, class TMaskImage>
+void
+PersistentKMeansImageFilter<TInputImage, TMaskImage>
+::ThreadedGenerateData(const RegionType& outputRegionForThread, int threadId)
+{
+  InputImagePointer         inputPtr = const_cast<TInputImage *>(this->GetInput());
+  MaskImageConstPointerType maskPtr = this->GetInputMask();
+
+  // Align the region on the subsampling grid
+  RegionType region = outputRegionForThread;
+  IndexType  index = region.GetIndex();
+  SizeType   size = region.GetSize();
+  const long factor = static_cast<long>(m_SubsampleFactor);
+  for (unsigned int dim = 0; dim < TInputImage::ImageDimension; ++dim)
+    {
+    long first = (index[dim] / factor) * factor;
+    if (first < index[dim])
+      {
+      first += factor;
+      }
+    const long last = index[dim] + static_cast<long>(size[dim]) - 1;
+    if (first > last)
+      {
+      return;
+      }
+    index[dim] = first;
+    size[dim] = last - first + 1;
+    }
+  region.SetIndex(index);
+  region.SetSize(size);
+
+  typedef SubsampledImageRegionConstIterator<TInputImage>   InputIteratorType;
+  typedef SubsampledImageRegionConstIterator<MaskImageType> MaskIteratorType;
+
+  InputIteratorType it(inputPtr, region);
+  it.SetSubsampleFactor(factor);
+  it.GoToBegin();
+
+  MaskIteratorType maskIt;
+  if (maskPtr)
+    {
+    maskIt = MaskIteratorType(maskPtr, region);
+    maskIt.SetSubsampleFactor(factor);
+    maskIt.GoToBegin();
+    }
+
+  const unsigned int          nbComponents = m_NumberOfComponents;
+  std::vector<double>&        sums = m_ThreadSums[threadId];
+  std::vector<unsigned long>& counts = m_ThreadCounts[threadId];
+
+  // Blocks of valid pixels
+  std::vector<double>       block(BlockSize * nbComponents);
+  std::vector<unsigned int> nearest(BlockSize);
+  std::vector<double>       squaredDistances(BlockSize);
+  PixelType                 pixel;
+
+  while (!it.IsAtEnd())
+    {
+    unsigned int nbSamples = 0;
+    for (; nbSamples < BlockSize && !it.IsAtEnd(); ++it)
+      {
+      if (maskPtr)
+        {
+        const bool validPoint = maskIt.Get() > 0;
+        ++maskIt;
+        if (!validPoint)
+          {
+          continue;
+          }
+        }
+      pixel = it.Get();
+      double * sample = &block[nbSamples * nbComponents];
+      for (unsigned int c = 0; c < nbComponents; ++c)
+        {
+        sample[c] = static_cast<double>(pixel[c]);
+        }
+      ++nbSamples;
+      }
+
+    if (m_Initialization)
+      {
+      for (unsigned int n = 0; n < nbSamples; ++n)
+        {
+        const double * sample = &block[n * nbComponents];
+        for (unsigned int c = 0; c < nbComponents; ++c)
+          {
+          sums[c] = std::min(sums[c], sample[c]);
+          sums[nbComponents + c] = std::max(sums[nbComponents + c], sample[c]);
+          }
+        }
+      counts[0] += nbSamples;
+      continue;
+      }
+
+    m_NearestCentroid.FindNearest(&block[0], nbSamples, &nearest[0], &squaredDistances[0]);
+
+    for (unsigned int n = 0; n < nbSamples; ++n)
+      {
+      const double * sample = &block[n * nbComponents];
+      double *       sum = &sums[nearest[n] * nbComponents];
+      for (unsigned int c = 0; c < nbComponents; ++c)
+        {
+        sum[c] += sample[c];
+        }
+      ++counts[nearest[n]];
+      m_ThreadInertia[threadId] += squaredDistances[n];
+      }
+    }
+}
+
+template <class TInputImage, class TMaskImage>
+void
+PersistentKMeansImageFilter<TInputImage, TMaskImage>
+::AfterThreadedGenerateData()
+{
+  this->GatherThreadSums();
+
+  // The streamed region is a mini-batch
+  if (m_MiniBatch && !m_Initialization)
+    {
+    this->UpdateCentroids();
+    }
+}
+
+template <class TInputImage, class TMaskImage>
+void
+PersistentKMeansImageFilter<TInputImage, TMaskImage>
+::GatherThreadSums()
+{
+  // Threads are gathered in order, so that the sums do not depend on
+  // the scheduling
+  const unsigned int nbComponents = m_NumberOfComponents;
+  for (unsigned int threadId = 0; threadId < m_ThreadSums.size(); ++threadId)
+    {
+    const std::vector<double>& sums = m_ThreadSums[threadId];
+    if (m_Initialization)
+      {
+      for (unsigned int c = 0; c < nbComponents; ++c)
+        {
+        m_Sums[c] = std::min(m_Sums[c], sums[c]);
+        m_Sums[nbComponents + c] = std::max(m_Sums[nbComponents + c], sums[nbComponents + c]);
+        }
+      }
+    else
+      {
+      for (unsigned int i = 0; i < m_Sums.size(); ++i)
+        {
+        m_Sums[i] += sums[i];
+        }
+      }
+    for (unsigned int k = 0; k < m_Counts.size(); ++k)
+      {
+      m_Counts[k] += m_ThreadCounts[threadId][k];
+      }
+    m_Inertia += m_ThreadInertia[threadId];
+    }
+}
+
+template <class TInputImage, class TMaskImage>
+void
+PersistentKMeansImageFilter<TInputImage, TMaskImage>
+::UpdateCentroids()
+{
+  // Centroids without pixel are kept
+  for (unsigned int k = 0; k < m_NumberOfClasses; ++k)
+    {
+    if (m_Counts[k] > 0)
+      {
+      for (unsigned int c = 0; c < m_NumberOfComponents; ++c)
+        {
+        m_Centroids[k * m_NumberOfComponents + c] = m_Sums[k * m_NumberOfComponents + c] / m_Counts[k];
+        }
+      }
+    }
+}
+
+template <class TInputImage, class TMaskImage>
+void
+PersistentKMeansImageFilter<TInputImage, TMaskImage>
+::Synthetize()
+{
+  if (m_Initialization)
+    {
+    m_NumberOfSamples = m_Counts[0];
+    if (m_NumberOfSamples == 0)
+      {
+      itkExceptionMacro(<< "No valid pixel to initialize the centroids");
+      }
+
+    // Centroids spread along the diagonal of the bounding box of the pixels
+    m_Centroids.SetSize(m_NumberOfClasses * m_NumberOfComponents);
+    for (unsigned int k = 0; k < m_NumberOfClasses; ++k)
+      {
+      const double position = (k + 0.5) / m_NumberOfClasses;
+      for (unsigned int c = 0; c < m_NumberOfComponents; ++c)
+        {
+        const double minimum = m_Sums[c];
+        const double maximum = m_Sums[m_NumberOfComponents + c];
+        m_Centroids[k * m_NumberOfComponents + c] = minimum + position * (maximum - minimum);
+        }
+      }
+    m_CentroidsShift = itk::NumericTraits<double>::max();
+    return;
+    }
+
+  this->UpdateCentroids();
+
+  m_NumberOfSamples = 0;
+  m_CentroidsShift = 0.;
+  for (unsigned int k = 0; k < m_NumberOfClasses; ++k)
+    {
+    m_NumberOfSamples += m_Counts[k];
+
+    double shift = 0.;
+    for (unsigned int c = 0; c < m_NumberOfComponents; ++c)
+      {
+      const double d = m_Centroids[k * m_NumberOfComponents + c] - m_PreviousCentroids[k * m_NumberOfComponents + c];
+      shift += d * d;
+      }
+    m_CentroidsShift = std::max(m_CentroidsShift, vcl_sqrt(shift));
+    }
+  otbMsgDevMacro(<< "KMeans pass: " << m_NumberOfSamples << " samples, inertia " << m_Inertia
+                 << ", centroids shift " << m_CentroidsShift);
+}
+
+template <class TInputImage, class TMaskImage>
+void
+PersistentKMeansImageFilter<TInputImage, TMaskImage>
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "NumberOfClasses: " << m_NumberOfClasses << std::endl;
+  os << indent << "SubsampleFactor: " << m_SubsampleFactor << std::endl;
+  os << indent << "MiniBatch: " << m_MiniBatch << std::endl;
+  os << indent << "Centroids: " << m_Centroids << std::endl;
+  os << indent << "NumberOfSamples: " << m_NumberOfSamples << std::endl;
+  os << indent << "Inertia: " << m_Inertia << std::endl;
+  os << indent << "CentroidsShift: " << m_CentroidsShift << std::endl;
+}
+
+/**===========================================================================*/
+
+template <class TInputImage, class TMaskImage>
+StreamingKMeansImageFilter<TInputImage, TMaskImage>
+::StreamingKMeansImageFilter()
+  : m_MaximumNumberOfIterations(100),
+    m_ConvergenceThreshold(1e-3),
+    m_NumberOfIterations(0)
+{
+}
+
+template <class TInputImage, class TMaskImage>
+void
+StreamingKMeansImageFilter<TInputImage, TMaskImage>
+::GenerateData(void)
+{
+  KMeansFilterType * filter = this->GetFilter();
+  this->GetStreamer()->SetInput(filter->GetOutput());
+
+  // Initialization pass, when no valid centroids were given
+  filter->Reset();
+  if (!filter->HasValidCentroids())
+    {
+    this->GetStreamer()->Update();
+    filter->Synthetize();
+    }
+
+  m_NumberOfIterations = 0;
+  bool converged = false;
+  while (!converged && m_NumberOfIterations < m_MaximumNumberOfIterations)
+    {
+    filter->Reset();
+    this->GetStreamer()->Update();
+    filter->Synthetize();
+    ++m_NumberOfIterations;
+    converged = filter->GetCentroidsShift() <= m_ConvergenceThreshold;
+    }
+}
+
+template <class TInputImage, class TMaskImage>
+void
+StreamingKMeansImageFilter<TInputImage, TMaskImage>
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "MaximumNumberOfIterations: " << m_MaximumNumberOfIterations << std::endl;
+  os << indent << "ConvergenceThreshold: " << m_ConvergenceThreshold << std::endl;
+  os << indent << "NumberOfIterations: " << m_NumberOfIterations << std::endl;
+}
+
+} // end namespace otb
+#endif
@@ -67,6 +67,25 @@ public:
 
   virtual bool Compute(double deltaEnergy) = 0;
 
+  /** Methods to cancel random effects. Deterministic optimizers ignore them. */
+  virtual void InitializeSeed(int itkNotUsed(seed)) {}
+  virtual void InitializeSeed() {}
+
+  /** Create an optimizer of the same type with the same parameters.
+   * It is used by the otb::MarkovRandomFieldFilter to optimize in
+   * several threads. */
+  virtual Pointer CreateCopy() const
+  {
+    Pointer copy = dynamic_cast<Self *>(this->CreateAnother().GetPointer());
+    if (copy.IsNull())
+      {
+      itkExceptionMacro(<< "Unable to create a copy of the optimizer.");
+      }
+    copy->m_NumberOfParameters = m_NumberOfParameters;
+    copy->m_Parameters = m_Parameters;
+    return copy;
+  }
+
 protected:
   MRFOptimizer() :
     m_NumberOfParameters(1),
@@ -21,7 +21,7 @@
 #include "otbMRFOptimizer.h"
 #include "otbMath.h"
 #include "itkNumericTraits.h"
-#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "otbMersenneTwisterRandomVariateGenerator.h"
 
 namespace otb
 {
@@ -98,6 +98,15 @@ public:
     m_Generator->SetSeed();
   }
 
+  /** The copy draws from its own random sequence. */
+  virtual Superclass::Pointer CreateCopy() const
+  {
+    Superclass::Pointer copy = Superclass::CreateCopy();
+    static_cast<Self *>(copy.GetPointer())->m_Generator =
+      otb::MersenneTwisterRandomVariateGenerator::New().GetPointer();
+    return copy;
+  }
+
 protected:
   MRFOptimizerMetropolis()
     {
@@ -80,6 +80,27 @@ public:
   virtual int Compute(const InputImageNeighborhoodIterator& itData,
                       const LabelledImageNeighborhoodIterator& itRegul) = 0;
 
+  /** Methods to cancel random effects. Deterministic samplers ignore them. */
+  virtual void InitializeSeed(int itkNotUsed(seed)) {}
+  virtual void InitializeSeed() {}
+
+  /** Create a sampler of the same type with the same settings. The
+   * energies are shared with the copy: it is used by the
+   * otb::MarkovRandomFieldFilter to sample in several threads. */
+  virtual Pointer CreateCopy() const
+  {
+    Pointer copy = dynamic_cast<Self *>(this->CreateAnother().GetPointer());
+    if (copy.IsNull())
+      {
+      itkExceptionMacro(<< "Unable to create a copy of the sampler.");
+      }
+    copy->SetNumberOfClasses(m_NumberOfClasses);
+    copy->SetLambda(m_Lambda);
+    copy->SetEnergyRegularization(m_EnergyRegularization);
+    copy->SetEnergyFidelity(m_EnergyFidelity);
+    return copy;
+  }
+
 protected:
   unsigned int m_NumberOfClasses;
   double       m_EnergyBefore;
@@ -19,7 +19,7 @@
 #define __otbMRFSamplerRandom_h
 
 #include "otbMRFSampler.h"
-#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "otbMersenneTwisterRandomVariateGenerator.h"
 #include "itkNumericTraits.h"
 
 namespace otb
@@ -85,6 +85,15 @@ public:
     m_Generator->SetSeed();
   }
 
+  /** The copy draws from its own random sequence. */
+  virtual typename Superclass::Pointer CreateCopy() const
+  {
+    typename Superclass::Pointer copy = Superclass::CreateCopy();
+    static_cast<Self *>(copy.GetPointer())->m_Generator =
+      otb::MersenneTwisterRandomVariateGenerator::New().GetPointer();
+    return copy;
+  }
+
 protected:
   // The constructor and destructor.
   MRFSamplerRandom()
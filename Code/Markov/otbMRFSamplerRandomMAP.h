@@ -19,7 +19,7 @@
 #ifndef __otbMRFSamplerRandomMAP_h
 #define __otbMRFSamplerRandomMAP_h
 
-#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "otbMersenneTwisterRandomVariateGenerator.h"
 #include "otbMRFSampler.h"
 
 namespace otb
@@ -151,6 +151,15 @@ public:
     m_Generator->SetSeed();
   }
 
+  /** The copy draws from its own random sequence. */
+  virtual typename Superclass::Pointer CreateCopy() const
+  {
+    typename Superclass::Pointer copy = Superclass::CreateCopy();
+    static_cast<Self *>(copy.GetPointer())->m_Generator =
+      otb::MersenneTwisterRandomVariateGenerator::New().GetPointer();
+    return copy;
+  }
+
 protected:
   // The constructor and destructor.
   MRFSamplerRandomMAP() :
@@ -22,7 +22,7 @@
 
 #include "vnl/vnl_vector.h"
 #include "vnl/vnl_matrix.h"
-#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "otbMersenneTwisterRandomVariateGenerator.h"
 
 #include "itkImageClassifierBase.h"
 
@@ -35,6 +35,7 @@
 #include "itkNeighborhood.h"
 #include "itkSize.h"
 #include "itkRandomImageSource.h"
+#include "itkMultiThreader.h"
 #include "otbMRFEnergy.h"
 #include "otbMRFOptimizer.h"
 #include "otbMRFSampler.h"
@@ -72,6 +73,21 @@ namespace otb
  *   markovFilter->SetSampler(sampler);
  * \endcode
  *
+ * By default the pixels are visited in raster order by a single thread.
+ * When ParallelUpdate is on, the pixels are grouped in colors such that
+ * two pixels of the same color never lie in the neighborhood of each
+ * other ((radius+1)^Dimension colors, i.e. four colors for a 3x3
+ * neighborhood). The pixels of a color are then updated concurrently,
+ * one color after the other. Each line of a color is sampled with its
+ * own random stream, seeded from the filter generator, so that the
+ * result does not depend on the number of threads.
+ *
+ * When Streaming is on, the filter no longer requires the whole image:
+ * each requested region is padded by HaloRadius pixels, regularized
+ * independently and cropped. This allows to regularize images that do
+ * not fit in memory at the cost of small differences near the tile
+ * borders when the halo is narrower than the propagation distance of
+ * the iterations.
  *
  * \ingroup Markov
  *
@@ -299,6 +315,24 @@ public:
   /** Get macro for number of iterations */
   itkGetConstReferenceMacro(NumberOfIterations, unsigned int);
 
+  /** Set/Get the use of the multi-threaded graph-coloring update scheme
+   * (default is off, i.e. sequential raster sweeps). */
+  itkSetMacro(ParallelUpdate, bool);
+  itkGetMacro(ParallelUpdate, bool);
+  itkBooleanMacro(ParallelUpdate);
+
+  /** Set/Get the tiled mode: when on, only the requested region padded
+   * by HaloRadius is regularized (default is off). */
+  itkSetMacro(Streaming, bool);
+  itkGetMacro(Streaming, bool);
+  itkBooleanMacro(Streaming);
+
+  /** Set/Get the width of the margin regularized around each tile in
+   * Streaming mode. Zero (the default) means the neighborhood radius
+   * times the maximum number of iterations. */
+  itkSetMacro(HaloRadius, unsigned int);
+  itkGetMacro(HaloRadius, unsigned int);
+
 #ifdef ITK_USE_CONCEPT_CHECKING
   /** Begin concept checking */
   itkConceptMacro(UnsignedIntConvertibleToClassifiedCheck,
@@ -314,14 +348,18 @@ public:
   /** End concept checking */
 #endif
 
-  /** Methods to cancel random effects.*/
+  /** Methods to cancel random effects. In Streaming mode, the seed is
+   * restored before each tile.*/
   void InitializeSeed(int seed)
   {
     m_Generator->SetSeed(seed);
+    m_Seed = seed;
+    m_SeedSet = true;
   }
   void InitializeSeed()
   {
     m_Generator->SetSeed();
+    m_SeedSet = false;
   }
 
 protected:
@@ -347,6 +385,25 @@ protected:
   virtual void EnlargeOutputRequestedRegion(itk::DataObject *);
   virtual void GenerateOutputInformation();
 
+  /** Region regularized for the current output requested region: the
+   * requested region padded by the halo in Streaming mode. */
+  LabelledImageRegionType GetRegularizedRegion();
+
+  /** Update all the pixels of a color in parallel (ParallelUpdate mode) */
+  virtual void MinimizeOnceParallel();
+
+  /** Update the lines of the current color assigned to a thread */
+  virtual void ThreadedMinimizeLines(unsigned int threadId, unsigned int threadCount);
+
+  /** Static function used as a "callback" by the MultiThreader. */
+  static ITK_THREAD_RETURN_TYPE ThreaderCallback(void *arg);
+
+  /** Internal structure used for passing image data into the threading library */
+  struct ThreadStruct
+  {
+    Pointer Filter;
+  };
+
   MarkovRandomFieldFilter(const Self &); //purposely not implemented
   void operator =(const Self&); //purposely not implemented
 
@@ -390,6 +447,28 @@ protected:
 
   virtual void MinimizeOnce();
 
+  bool         m_ParallelUpdate;
+  bool         m_Streaming;
+  unsigned int m_HaloRadius;
+  int          m_Seed;
+  bool         m_SeedSet;
+
+  /** Label buffer the iterations work on (the output unless Streaming) */
+  LabelledImagePointer m_LabelledImage;
+
+  /** Current color pass of the parallel update */
+  std::vector<LabelledImageIndexType> m_ColorLines;
+  std::vector<unsigned long>          m_ColorLineNumbers;
+  LabelledImageOffsetType             m_ColorOffset;
+  unsigned long                       m_ColorSeed;
+  RandomGeneratorType::Pointer        m_ColorGenerator;
+
+  /** Per-thread samplers, optimizers and statistics */
+  std::vector<SamplerPointer>   m_ThreadSamplers;
+  std::vector<OptimizerPointer> m_ThreadOptimizers;
+  std::vector<int>              m_ThreadErrorCounter;
+  std::vector<double>           m_ThreadDeltaEnergy;
+
 private:
 
 }; // class MarkovRandomFieldFilter
@@ -37,7 +37,13 @@ MarkovRandomFieldFilter<TInputImage, TClassifiedImage>
   m_NumberOfIterations(0),
   m_Lambda(1.0),
   m_ExternalClassificationSet(false),
-  m_StopCondition(MaximumNumberOfIterations)
+  m_StopCondition(MaximumNumberOfIterations),
+  m_ParallelUpdate(false),
+  m_Streaming(false),
+  m_HaloRadius(0),
+  m_Seed(0),
+  m_SeedSet(false),
+  m_ColorSeed(0)
 {
   m_Generator = RandomGeneratorType::New();
   m_Generator->SetSeed();
@@ -113,6 +119,15 @@ MarkovRandomFieldFilter<TInputImage, TClassifiedImage>
 
   os << indent << " Lambda: " <<
   m_Lambda << std::endl;
+
+  os << indent << " Parallel update: " <<
+  m_ParallelUpdate << std::endl;
+
+  os << indent << " Streaming: " <<
+  m_Streaming << std::endl;
+
+  os << indent << " Halo radius: " <<
+  m_HaloRadius << std::endl;
 } // end PrintSelf
 
 /**
@@ -128,7 +143,55 @@ MarkovRandomFieldFilter<TInputImage, TClassifiedImage>
   InputImagePointer inputPtr =
     const_cast<InputImageType *>(this->GetInput());
   OutputImagePointer outputPtr = this->GetOutput();
-  inputPtr->SetRequestedRegion(outputPtr->GetRequestedRegion());
+
+  if (!m_Streaming)
+    {
+    inputPtr->SetRequestedRegion(outputPtr->GetRequestedRegion());
+    return;
+    }
+
+  // In streaming mode, the tile is regularized with its halo
+  LabelledImageRegionType regularizedRegion = this->GetRegularizedRegion();
+  InputImageRegionType    inputRequestedRegion;
+  inputRequestedRegion.SetIndex(regularizedRegion.GetIndex());
+  inputRequestedRegion.SetSize(regularizedRegion.GetSize());
+  inputPtr->SetRequestedRegion(inputRequestedRegion);
+
+  if (m_ExternalClassificationSet)
+    {
+    TrainingImagePointer trainingPtr =
+      const_cast<TrainingImageType *>(this->GetTrainingInput());
+    trainingPtr->SetRequestedRegion(regularizedRegion);
+    }
+}
+
+/**
+ * GetRegularizedRegion method.
+ */
+template <class TInputImage, class TClassifiedImage>
+typename MarkovRandomFieldFilter<TInputImage, TClassifiedImage>::LabelledImageRegionType
+MarkovRandomFieldFilter<TInputImage, TClassifiedImage>
+::GetRegularizedRegion()
+{
+  OutputImagePointer      outputPtr = this->GetOutput();
+  LabelledImageRegionType region = outputPtr->GetRequestedRegion();
+
+  if (m_Streaming)
+    {
+    typename LabelledImageRegionType::SizeType halo;
+    for (unsigned int i = 0; i < ClassifiedImageDimension; ++i)
+      {
+      halo[i] = m_HaloRadius;
+      if (m_HaloRadius == 0)
+        {
+        halo[i] = m_LabelledImageNeighborhoodRadius[i] * m_MaximumNumberOfIterations;
+        }
+      }
+    region.PadByRadius(halo);
+    region.Crop(outputPtr->GetLargestPossibleRegion());
+    }
+
+  return region;
 }
 
 /**
@@ -140,7 +203,11 @@ MarkovRandomFieldFilter<TInputImage, TClassifiedImage>
 ::EnlargeOutputRequestedRegion(itk::DataObject *output)
 {
   // this filter requires the all of the output image to be in
-  // the buffer
+  // the buffer, unless it processes the image tile by tile
+  if (m_Streaming)
+    {
+    return;
+    }
   TClassifiedImage *imgData;
   imgData = dynamic_cast<TClassifiedImage*>(output);
   imgData->SetRequestedRegionToLargestPossibleRegion();
@@ -167,6 +234,12 @@ MarkovRandomFieldFilter<TInputImage, TClassifiedImage>
 
 //   InputImageConstPointer inputImage = this->GetInput();
 
+  //Each tile starts from the same random sequence
+  if (m_Streaming && m_SeedSet)
+    {
+    m_Generator->SetSeed(m_Seed);
+    }
+
   //Allocate memory for the labelled images
   this->Allocate();
 
@@ -176,6 +249,21 @@ MarkovRandomFieldFilter<TInputImage, TClassifiedImage>
   //Run the Markov random field
   this->ApplyMarkovRandomFieldFilter();
 
+  //Crop the regularized tile to the requested region
+  LabelledImagePointer outputPtr = this->GetOutput();
+  if (m_LabelledImage != outputPtr)
+    {
+    LabelledImageRegionConstIterator
+    tileIt(m_LabelledImage, outputPtr->GetRequestedRegion());
+    LabelledImageRegionIterator
+    outImageIt(outputPtr, outputPtr->GetRequestedRegion());
+    for (tileIt.GoToBegin(), outImageIt.GoToBegin(); !outImageIt.IsAtEnd(); ++tileIt, ++outImageIt)
+      {
+      outImageIt.Set(tileIt.Get());
+      }
+    }
+  m_LabelledImage = NULL;
+
 } // end GenerateData
 
 /**
@@ -252,16 +340,29 @@ MarkovRandomFieldFilter<TInputImage, TClassifiedImage>
   outputPtr->SetBufferedRegion(outputPtr->GetRequestedRegion());
   outputPtr->Allocate();
 
+  //In streaming mode, the iterations work on a separate buffer
+  //holding the tile and its halo
+  LabelledImageRegionType regularizedRegion = this->GetRegularizedRegion();
+  m_LabelledImage = outputPtr;
+  if (regularizedRegion != outputPtr->GetRequestedRegion())
+    {
+    m_LabelledImage = LabelledImageType::New();
+    m_LabelledImage->CopyInformation(outputPtr);
+    m_LabelledImage->SetRequestedRegion(regularizedRegion);
+    m_LabelledImage->SetBufferedRegion(regularizedRegion);
+    m_LabelledImage->Allocate();
+    }
+
   //Copy input data in the output buffer memory or
   //initialize to random values if not set
   LabelledImageRegionIterator
-  outImageIt(outputPtr, outputPtr->GetRequestedRegion());
+  outImageIt(m_LabelledImage, regularizedRegion);
 
   if (m_ExternalClassificationSet)
     {
     typename TrainingImageType::ConstPointer trainingImage = this->GetTrainingInput();
     LabelledImageRegionConstIterator
-    trainingImageIt(trainingImage, outputPtr->GetRequestedRegion());
+    trainingImageIt(trainingImage, regularizedRegion);
 
     while (!outImageIt.IsAtEnd())
       {
@@ -300,7 +401,7 @@ MarkovRandomFieldFilter<TInputImage, TClassifiedImage>
   m_ImageDeltaEnergy = 0.0;
 
   InputImageSizeType inputImageSize =
-    this->GetInput()->GetBufferedRegion().GetSize();
+    m_LabelledImage->GetBufferedRegion().GetSize();
 
   //---------------------------------------------------------------------
   //Get the number of valid pixels in the output MRF image
@@ -362,6 +463,25 @@ MarkovRandomFieldFilter<TInputImage, TClassifiedImage>
   m_NumberOfIterations = 0;
   m_ErrorCounter = m_TotalNumberOfValidPixelsInOutputImage;
 
+  //Each thread samples with its own copies of the sampler and optimizer.
+  //The seeds of the color passes come from a private generator, as
+  //creating the copies may reseed the global one.
+  if (m_ParallelUpdate)
+    {
+    m_ColorGenerator = otb::MersenneTwisterRandomVariateGenerator::New().GetPointer();
+    m_ColorGenerator->SetSeed(m_Generator->GetIntegerVariate());
+    const unsigned int numberOfThreads = this->GetNumberOfThreads();
+    m_ThreadSamplers.resize(numberOfThreads);
+    m_ThreadOptimizers.resize(numberOfThreads);
+    m_ThreadErrorCounter.resize(numberOfThreads);
+    m_ThreadDeltaEnergy.resize(numberOfThreads);
+    for (unsigned int i = 0; i < numberOfThreads; ++i)
+      {
+      m_ThreadSamplers[i] = m_Sampler->CreateCopy();
+      m_ThreadOptimizers[i] = m_Optimizer->CreateCopy();
+      }
+    }
+
   while ((m_NumberOfIterations < m_MaximumNumberOfIterations) &&
          (m_ErrorCounter >= maxNumPixelError))
     {
@@ -377,6 +497,12 @@ MarkovRandomFieldFilter<TInputImage, TClassifiedImage>
 
     }
 
+  m_ThreadSamplers.clear();
+  m_ThreadOptimizers.clear();
+  m_ColorGenerator = NULL;
+  m_ColorLines.clear();
+  m_ColorLineNumbers.clear();
+
   otbMsgDevMacro(<< "m_NumberOfIterations: " << m_NumberOfIterations);
   otbMsgDevMacro(<< "m_MaximumNumberOfIterations: " << m_MaximumNumberOfIterations);
   otbMsgDevMacro(<< "m_ErrorCounter: " << m_ErrorCounter);
@@ -402,12 +528,18 @@ void
 MarkovRandomFieldFilter<TInputImage, TClassifiedImage>
 ::MinimizeOnce()
 {
+  if (m_ParallelUpdate)
+    {
+    this->MinimizeOnceParallel();
+    return;
+    }
+
   LabelledImageNeighborhoodIterator
-  labelledIterator(m_LabelledImageNeighborhoodRadius, this->GetOutput(),
-                   this->GetOutput()->GetLargestPossibleRegion());
+  labelledIterator(m_LabelledImageNeighborhoodRadius, m_LabelledImage,
+                   m_LabelledImage->GetBufferedRegion());
   InputImageNeighborhoodIterator
   dataIterator(m_InputImageNeighborhoodRadius, this->GetInput(),
-               this->GetInput()->GetLargestPossibleRegion());
+               m_LabelledImage->GetBufferedRegion());
   m_ErrorCounter = 0;
 
   for (labelledIterator.GoToBegin(), dataIterator.GoToBegin();
@@ -430,6 +562,171 @@ MarkovRandomFieldFilter<TInputImage, TClassifiedImage>
 
 }
 
+/**
+*Apply the MRF image filter on the whole image once, color by color
+*/
+template<class TInputImage, class TClassifiedImage>
+void
+MarkovRandomFieldFilter<TInputImage, TClassifiedImage>
+::MinimizeOnceParallel()
+{
+  const LabelledImageRegionType region = m_LabelledImage->GetBufferedRegion();
+  const LabelledImageIndexType  start = region.GetIndex();
+  const SizeType                size = region.GetSize();
+
+  // Two pixels whose coordinates are congruent modulo radius+1 along
+  // each dimension are out of reach of each other's neighborhood
+  unsigned int numberOfColors = 1;
+  unsigned long numberOfLines = 1;
+  for (unsigned int i = 0; i < ClassifiedImageDimension; ++i)
+    {
+    numberOfColors *= m_LabelledImageNeighborhoodRadius[i] + 1;
+    if (i > 0)
+      {
+      numberOfLines *= size[i];
+      }
+    }
+
+  m_ErrorCounter = 0;
+
+  for (unsigned int color = 0; color < numberOfColors; ++color)
+    {
+    unsigned int code = color;
+    for (unsigned int i = 0; i < ClassifiedImageDimension; ++i)
+      {
+      m_ColorOffset[i] = code % (m_LabelledImageNeighborhoodRadius[i] + 1);
+      code /= m_LabelledImageNeighborhoodRadius[i] + 1;
+      }
+
+    // Drawn for every color to keep the random sequence independent
+    // from the image size
+    m_ColorSeed = m_ColorGenerator->GetIntegerVariate();
+
+    // Lines along the first dimension containing pixels of this color
+    m_ColorLines.clear();
+    m_ColorLineNumbers.clear();
+    if (static_cast<unsigned long>(m_ColorOffset[0]) >= size[0])
+      {
+      continue;
+      }
+    for (unsigned long line = 0; line < numberOfLines; ++line)
+      {
+      LabelledImageIndexType index = start;
+      index[0] += m_ColorOffset[0];
+      unsigned long remainder = line;
+      bool          belongsToColor = true;
+      for (unsigned int i = 1; i < ClassifiedImageDimension; ++i)
+        {
+        const unsigned long position = remainder % size[i];
+        remainder /= size[i];
+        index[i] += position;
+        belongsToColor = belongsToColor
+                         && (position % (m_LabelledImageNeighborhoodRadius[i] + 1)
+                             == static_cast<unsigned long>(m_ColorOffset[i]));
+        }
+      if (belongsToColor)
+        {
+        m_ColorLines.push_back(index);
+        m_ColorLineNumbers.push_back(line);
+        }
+      }
+
+    // Set up the multithreaded processing
+    std::fill(m_ThreadErrorCounter.begin(), m_ThreadErrorCounter.end(), 0);
+    std::fill(m_ThreadDeltaEnergy.begin(), m_ThreadDeltaEnergy.end(), 0.0);
+
+    ThreadStruct str;
+    str.Filter = this;
+
+    this->GetMultiThreader()->SetNumberOfThreads(m_ThreadSamplers.size());
+    this->GetMultiThreader()->SetSingleMethod(this->ThreaderCallback, &str);
+    this->GetMultiThreader()->SingleMethodExecute();
+
+    for (unsigned int i = 0; i < m_ThreadSamplers.size(); ++i)
+      {
+      m_ErrorCounter += m_ThreadErrorCounter[i];
+      m_ImageDeltaEnergy += m_ThreadDeltaEnergy[i];
+      }
+    }
+}
+
+template<class TInputImage, class TClassifiedImage>
+void
+MarkovRandomFieldFilter<TInputImage, TClassifiedImage>
+::ThreadedMinimizeLines(unsigned int threadId, unsigned int threadCount)
+{
+  SamplerType *   sampler = m_ThreadSamplers[threadId];
+  OptimizerType * optimizer = m_ThreadOptimizers[threadId];
+
+  int    errorCounter = 0;
+  double deltaEnergy = 0.0;
+
+  const LabelledImageRegionType region = m_LabelledImage->GetBufferedRegion();
+  const unsigned int            step = m_LabelledImageNeighborhoodRadius[0] + 1;
+
+  const unsigned long numberOfLines = m_ColorLines.size();
+  const unsigned long firstLine = numberOfLines * threadId / threadCount;
+  const unsigned long lastLine = numberOfLines * (threadId + 1) / threadCount;
+
+  for (unsigned long line = firstLine; line < lastLine; ++line)
+    {
+    LabelledImageRegionType lineRegion;
+    SizeType                lineSize;
+    lineSize.Fill(1);
+    lineSize[0] = region.GetIndex()[0] + region.GetSize()[0] - m_ColorLines[line][0];
+    lineRegion.SetIndex(m_ColorLines[line]);
+    lineRegion.SetSize(lineSize);
+
+    // The random streams only depend on the line, not on the thread
+    const unsigned long seed = m_ColorSeed + 2 * m_ColorLineNumbers[line];
+    sampler->InitializeSeed(static_cast<int>(seed));
+    optimizer->InitializeSeed(static_cast<int>(seed + 1));
+
+    LabelledImageNeighborhoodIterator
+    labelledIterator(m_LabelledImageNeighborhoodRadius, m_LabelledImage, lineRegion);
+    InputImageNeighborhoodIterator
+    dataIterator(m_InputImageNeighborhoodRadius, this->GetInput(), lineRegion);
+
+    unsigned int position = 0;
+    for (labelledIterator.GoToBegin(), dataIterator.GoToBegin();
+         !labelledIterator.IsAtEnd();
+         ++labelledIterator, ++dataIterator, ++position)
+      {
+      if (position % step != 0)
+        {
+        continue;
+        }
+      sampler->Compute(dataIterator, labelledIterator);
+      if (optimizer->Compute(sampler->GetDeltaEnergy()))
+        {
+        labelledIterator.SetCenterPixel(sampler->GetValue());
+        ++errorCounter;
+        deltaEnergy += sampler->GetDeltaEnergy();
+        }
+      }
+    }
+
+  m_ThreadErrorCounter[threadId] = errorCounter;
+  m_ThreadDeltaEnergy[threadId] = deltaEnergy;
+}
+
+template<class TInputImage, class TClassifiedImage>
+ITK_THREAD_RETURN_TYPE
+MarkovRandomFieldFilter<TInputImage, TClassifiedImage>
+::ThreaderCallback(void *arg)
+{
+  ThreadStruct *str;
+  int           threadId, threadCount;
+
+  threadId = ((itk::MultiThreader::ThreadInfoStruct *) (arg))->ThreadID;
+  threadCount = ((itk::MultiThreader::ThreadInfoStruct *) (arg))->NumberOfThreads;
+  str = (ThreadStruct *) (((itk::MultiThreader::ThreadInfoStruct *) (arg))->UserData);
+
+  str->Filter->ThreadedMinimizeLines(threadId, threadCount);
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
 } // namespace otb
 
 #endif
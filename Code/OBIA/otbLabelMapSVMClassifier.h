@@ -20,6 +20,7 @@ PURPOSE.  See the above copyright notices for more information.
 
 #include "itkInPlaceLabelMapFilter.h"
 #include "otbSVMModel.h"
+#include "otbSVMBatchPredictor.h"
 #include "itkListSample.h"
 #include "otbAttributesMapLabelObject.h"
 
@@ -28,6 +29,11 @@ namespace otb {
 /** \class LabelMapSVMClassifier
  * \brief Classify each LabelObject of the input LabelMap in place
  *
+ * The measurement vectors of all the label objects are gathered, then
+ * the label objects are split in as many contiguous ranges as there are
+ * threads, and each thread classifies its range by batches with a
+ * shared SVMBatchPredictor.
+ *
  * \sa otb::AttributesMapLabelObject
  * \sa otb::SVMModel
  * \sa itk::InPlaceLabelMapFilter
@@ -63,6 +69,7 @@ public:
   /** Type definitions for the SVM Model. */
   typedef SVMModel<AttributesValueType, ClassLabelType>   SVMModelType;
   typedef typename SVMModelType::Pointer                  SVMModelPointer;
+  typedef SVMBatchPredictor<AttributesValueType, ClassLabelType> PredictorType;
 
   /** Standard New method. */
   itkNewMacro(Self);
@@ -87,10 +94,16 @@ protected:
   LabelMapSVMClassifier();
   ~LabelMapSVMClassifier() {};
 
-  virtual void ThreadedProcessLabelObject( LabelObjectType * labelObject );
+  virtual void GenerateData();
 
   virtual void ReleaseInputs();
 
+  /** Classify the label objects of the range [begin, end) */
+  void ThreadedClassify(unsigned long begin, unsigned long end, int threadId);
+
+  /** Static function used as a "callback" by the MultiThreader */
+  static ITK_THREAD_RETURN_TYPE ClassifyThreaderCallback(void *arg);
+
 
 private:
   LabelMapSVMClassifier(const Self&); //purposely not implemented
@@ -102,6 +115,16 @@ private:
   /** The functor used to build the measurement vector */
   MeasurementFunctorType m_MeasurementFunctor;
 
+  /** The predictor shared by the threads */
+  typename PredictorType::Pointer m_Predictor;
+
+  /** Label objects to classify, and their measurements stored one after
+   *  the other: the measurement of the i-th object goes from
+   *  m_SampleOffsets[i] to m_SampleOffsets[i+1] */
+  std::vector<LabelObjectType *>   m_LabelObjects;
+  std::vector<AttributesValueType> m_Samples;
+  std::vector<unsigned long>       m_SampleOffsets;
+
 }; // end of class
 
 } // end namespace otb
@@ -19,6 +19,7 @@ PURPOSE.  See the above copyright notices for more information.
 #define __otbLabelMapSVMClassifier_txx
 
 #include "otbLabelMapSVMClassifier.h"
+#include "itkProgressReporter.h"
 
 
 namespace otb {
@@ -27,10 +28,6 @@ template <class TInputImage>
 LabelMapSVMClassifier<TInputImage>
 ::LabelMapSVMClassifier()
 {
-  // Force to single-threaded (SVMModel is not thread-safe)
-  // This way, we benefit of the LabelMapFilter design and only need
-  // to implement ThreadedProcessLabelObject
-  this->SetNumberOfThreads(1);
 }
 
 template<class TInputImage>
@@ -46,10 +43,96 @@ LabelMapSVMClassifier<TInputImage>
 template<class TInputImage>
 void
 LabelMapSVMClassifier<TInputImage>
-::ThreadedProcessLabelObject( LabelObjectType * labelObject )
+::GenerateData()
 {
-  ClassLabelType classLabel = m_Model->EvaluateLabel(m_MeasurementFunctor(labelObject));
-  labelObject->SetClassLabel(classLabel);
+  if (!m_Model)
+    {
+    itkExceptionMacro(<< "No model for classification");
+    }
+
+  // Allocate the output (or graft the input when running in place)
+  this->AllocateOutputs();
+
+  m_Predictor = PredictorType::New();
+  m_Predictor->SetModel(m_Model);
+
+  // The measurements are computed sequentially, since the functor is
+  // not required to be thread safe
+  LabelMapType * labelMap = this->GetLabelMap();
+  m_LabelObjects.clear();
+  m_Samples.clear();
+  m_SampleOffsets.assign(1, 0);
+
+  typename LabelMapType::LabelObjectContainerType::iterator it = labelMap->GetLabelObjectContainer().begin();
+  for (; it != labelMap->GetLabelObjectContainer().end(); ++it)
+    {
+    MeasurementVectorType measurement = m_MeasurementFunctor(it->second);
+    m_LabelObjects.push_back(it->second);
+    m_Samples.insert(m_Samples.end(), measurement.begin(), measurement.end());
+    m_SampleOffsets.push_back(m_Samples.size());
+    }
+
+  this->GetMultiThreader()->SetNumberOfThreads(this->GetNumberOfThreads());
+  this->GetMultiThreader()->SetSingleMethod(this->ClassifyThreaderCallback, this);
+  this->GetMultiThreader()->SingleMethodExecute();
+
+  m_LabelObjects.clear();
+  m_Samples.clear();
+  m_SampleOffsets.clear();
+  m_Predictor = NULL;
+}
+
+template<class TInputImage>
+void
+LabelMapSVMClassifier<TInputImage>
+::ThreadedClassify(unsigned long begin, unsigned long end, int threadId)
+{
+  itk::ProgressReporter progress(this, threadId, end - begin);
+
+  // Label objects are classified by batches of measurements of the same size
+  std::vector<ClassLabelType> labels;
+  unsigned long batchBegin = begin;
+  while (batchBegin < end)
+    {
+    const unsigned long nbFeatures = m_SampleOffsets[batchBegin + 1] - m_SampleOffsets[batchBegin];
+    unsigned long       batchEnd = batchBegin + 1;
+    while (batchEnd < end && m_SampleOffsets[batchEnd + 1] - m_SampleOffsets[batchEnd] == nbFeatures)
+      {
+      ++batchEnd;
+      }
+
+    labels.resize(batchEnd - batchBegin);
+    m_Predictor->PredictLabels(nbFeatures > 0 ? &m_Samples[m_SampleOffsets[batchBegin]] : NULL,
+                               batchEnd - batchBegin, nbFeatures, &labels[0]);
+    for (unsigned long i = batchBegin; i < batchEnd; ++i)
+      {
+      m_LabelObjects[i]->SetClassLabel(labels[i - batchBegin]);
+      progress.CompletedPixel();
+      }
+
+    batchBegin = batchEnd;
+    }
+}
+
+template<class TInputImage>
+ITK_THREAD_RETURN_TYPE
+LabelMapSVMClassifier<TInputImage>
+::ClassifyThreaderCallback(void *arg)
+{
+  int   threadId = ((itk::MultiThreader::ThreadInfoStruct *) (arg))->ThreadID;
+  int   threadCount = ((itk::MultiThreader::ThreadInfoStruct *) (arg))->NumberOfThreads;
+  Self* filter = (Self *) (((itk::MultiThreader::ThreadInfoStruct *) (arg))->UserData);
+
+  // Contiguous ranges of label objects, of nearly the same size
+  const unsigned long nbLabelObjects = filter->m_LabelObjects.size();
+  const unsigned long begin = nbLabelObjects * threadId / threadCount;
+  const unsigned long end = nbLabelObjects * (threadId + 1) / threadCount;
+  if (begin < end)
+    {
+    filter->ThreadedClassify(begin, end, threadId);
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
 }
 
 }// end namespace otb
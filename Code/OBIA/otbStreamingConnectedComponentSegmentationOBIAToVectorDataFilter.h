@@ -20,6 +20,9 @@
 
 #include "itkMacro.h"
 #include "otbPersistentImageToVectorDataFilter.h"
+
+#include <map>
+#include <set>
 #include "otbPersistentFilterStreamingDecorator.h"
 
 #include "otbConnectedComponentMuParserFunctor.h"
@@ -113,6 +116,9 @@ public:
 
   typedef typename RelabelComponentFilterType::ObjectSizeType ObjectSizeType;
 
+  typedef typename Superclass::DataNodeType DataNodeType;
+  typedef typename Superclass::RegionType   RegionType;
+
 
   /* Set the mathematical expression used for the mask */
   itkSetStringMacro(MaskExpression);
@@ -175,13 +181,37 @@ public:
   itkGetMacro(ComputeFeretDiameter, bool);
 
 
+  virtual void Reset();
+
+  /** Find the segments connected across the seams before merging them */
+  virtual void Synthetize();
+
 protected:
   PersistentConnectedComponentSegmentationOBIAToVectorDataFilter();
 
   virtual ~PersistentConnectedComponentSegmentationOBIAToVectorDataFilter();
 
   void GenerateInputRequestedRegion();
+
+  /** Two pieces are merged only if the connected component expression
+   * links some of their pixels across the seam */
+  virtual bool IsConnectedAcrossSeam(unsigned int tile1, const DataNodeType * feature1,
+                                     unsigned int tile2, const DataNodeType * feature2) const;
 private:
+  /** Label and value of a pixel on a tile border */
+  struct SeamPixelType
+  {
+    unsigned int         m_Tile;
+    unsigned int         m_Label;
+    VectorImagePixelType m_Value;
+  };
+  typedef std::pair<long, long>                             SeamPixelIndexType;
+  typedef std::map<SeamPixelIndexType, SeamPixelType>       SeamPixelMapType;
+  typedef std::pair<unsigned int, unsigned int>             TileLabelType;
+  typedef std::set<std::pair<TileLabelType, TileLabelType> > SeamConnectionSetType;
+
+  SeamPixelMapType      m_SeamPixels;
+  SeamConnectionSetType m_SeamConnections;
 
   ObjectSizeType m_MinimumObjectSize;
   std::string    m_MaskExpression;
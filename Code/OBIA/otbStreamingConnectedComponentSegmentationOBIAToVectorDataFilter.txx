@@ -85,6 +85,31 @@ PersistentConnectedComponentSegmentationOBIAToVectorDataFilter<TVImage, TLabelIm
   relabel->SetMinimumObjectSize(m_MinimumObjectSize);
   relabel->Update();
 
+  // Keep the borders of the tile to find the objects connected across
+  // the seams. The tile is not registered yet in the tile list.
+  if (this->GetMergeSeams())
+    {
+    const unsigned int tile = this->GetTileRegions().size();
+    const RegionType   region = relabel->GetOutput()->GetBufferedRegion();
+    const long         xBegin = region.GetIndex()[0];
+    const long         yBegin = region.GetIndex()[1];
+    const long         xEnd = xBegin + static_cast<long>(region.GetSize()[0]) - 1;
+    const long         yEnd = yBegin + static_cast<long>(region.GetSize()[1]) - 1;
+    typename LabelImageType::IndexType index;
+    for (index[1] = yBegin; index[1] <= yEnd; ++index[1])
+      {
+      const bool borderRow = (index[1] == yBegin || index[1] == yEnd);
+      for (index[0] = xBegin; index[0] <= xEnd; index[0] = (borderRow || index[0] == xEnd) ? index[0] + 1 : xEnd)
+        {
+        SeamPixelType pixel;
+        pixel.m_Tile = tile;
+        pixel.m_Label = relabel->GetOutput()->GetPixel(index);
+        pixel.m_Value = extract->GetOutput()->GetPixel(index);
+        m_SeamPixels[SeamPixelIndexType(index[0], index[1])] = pixel;
+        }
+      }
+    }
+
   //Attributes computation
   // LabelImage to Label Map transformation
   typename LabelImageToLabelMapFilterType::Pointer labelImageToLabelMap = LabelImageToLabelMapFilterType::New();
@@ -154,5 +179,69 @@ PersistentConnectedComponentSegmentationOBIAToVectorDataFilter<TVImage, TLabelIm
   return vdTransform->GetOutput();
 }
 
+template<class TVImage, class TLabelImage, class TMaskImage, class TOutputVectorData>
+void
+PersistentConnectedComponentSegmentationOBIAToVectorDataFilter<TVImage, TLabelImage, TMaskImage, TOutputVectorData>
+::Reset()
+{
+  Superclass::Reset();
+  m_SeamPixels.clear();
+  m_SeamConnections.clear();
+}
+
+template<class TVImage, class TLabelImage, class TMaskImage, class TOutputVectorData>
+void
+PersistentConnectedComponentSegmentationOBIAToVectorDataFilter<TVImage, TLabelImage, TMaskImage, TOutputVectorData>
+::Synthetize()
+{
+  // Apply the connected component criterion to the pairs of neighbour
+  // pixels lying in two different tiles
+  FunctorType functor;
+  functor.SetExpression(m_ConnectedComponentExpression);
+
+  for (typename SeamPixelMapType::const_iterator it = m_SeamPixels.begin(); it != m_SeamPixels.end(); ++it)
+    {
+    if (it->second.m_Label == 0)
+      {
+      continue;
+      }
+    const SeamPixelIndexType neighbours[2] = {SeamPixelIndexType(it->first.first + 1, it->first.second),
+                                              SeamPixelIndexType(it->first.first, it->first.second + 1)};
+    for (unsigned int n = 0; n < 2; ++n)
+      {
+      typename SeamPixelMapType::const_iterator neighbour = m_SeamPixels.find(neighbours[n]);
+      if (neighbour == m_SeamPixels.end() || neighbour->second.m_Tile == it->second.m_Tile
+          || neighbour->second.m_Label == 0)
+        {
+        continue;
+        }
+      const TileLabelType piece1(it->second.m_Tile, it->second.m_Label);
+      const TileLabelType piece2(neighbour->second.m_Tile, neighbour->second.m_Label);
+      if (m_SeamConnections.count(std::make_pair(std::min(piece1, piece2), std::max(piece1, piece2))) == 0
+          && functor(it->second.m_Value, neighbour->second.m_Value))
+        {
+        m_SeamConnections.insert(std::make_pair(std::min(piece1, piece2), std::max(piece1, piece2)));
+        }
+      }
+    }
+  m_SeamPixels.clear();
+
+  Superclass::Synthetize();
+
+  m_SeamConnections.clear();
+}
+
+template<class TVImage, class TLabelImage, class TMaskImage, class TOutputVectorData>
+bool
+PersistentConnectedComponentSegmentationOBIAToVectorDataFilter<TVImage, TLabelImage, TMaskImage, TOutputVectorData>
+::IsConnectedAcrossSeam(unsigned int tile1, const DataNodeType * feature1,
+                        unsigned int tile2, const DataNodeType * feature2) const
+{
+  // The node id holds the label of the object in its tile
+  const TileLabelType piece1(tile1, atoi(feature1->GetNodeId()));
+  const TileLabelType piece2(tile2, atoi(feature2->GetNodeId()));
+  return m_SeamConnections.count(std::make_pair(std::min(piece1, piece2), std::max(piece1, piece2))) > 0;
+}
+
 } // end namespace otb
 #endif
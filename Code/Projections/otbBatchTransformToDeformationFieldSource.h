@@ -0,0 +1,92 @@
+/*=========================================================================
+
+  Program:   ORFEO Toolbox
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+
+  Copyright (c) Centre National d'Etudes Spatiales. All rights reserved.
+  See OTBCopyright.txt for details.
+
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __otbBatchTransformToDeformationFieldSource_h
+#define __otbBatchTransformToDeformationFieldSource_h
+
+#include "itkTransformToDeformationFieldSource.h"
+#include "otbGenericRSTransform.h"
+#include "otbRationalTransform.h"
+
+namespace otb
+{
+
+/** \class BatchTransformToDeformationFieldSource
+ *  \brief Generate a deformation field from a transform, one row at a time.
+ *
+ * This filter behaves as itk::TransformToDeformationFieldSource, but when
+ * the transform is a GenericRSTransform or a RationalTransform, the points
+ * of each row of the output region are transformed in a single call to
+ * their TransformPoints() method. This avoids the per-point overhead of
+ * sensor models and allows DEM heights to be queried for a whole row.
+ * Other transforms are handled by the superclass.
+ *
+ * \sa StreamingResampleImageFilter
+ * \sa GenericRSTransform
+ *
+ * \ingroup Projection
+ */
+template <class TOutputImage, class TTransformPrecisionType = double>
+class ITK_EXPORT BatchTransformToDeformationFieldSource :
+    public itk::TransformToDeformationFieldSource<TOutputImage, TTransformPrecisionType>
+{
+public:
+  /** Standard class typedefs. */
+  typedef BatchTransformToDeformationFieldSource Self;
+  typedef itk::TransformToDeformationFieldSource
+  <TOutputImage, TTransformPrecisionType>        Superclass;
+  typedef itk::SmartPointer<Self>                Pointer;
+  typedef itk::SmartPointer<const Self>          ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(BatchTransformToDeformationFieldSource, itk::TransformToDeformationFieldSource);
+
+  itkStaticConstMacro(ImageDimension, unsigned int, TOutputImage::ImageDimension);
+
+  typedef typename Superclass::OutputImageType       OutputImageType;
+  typedef typename Superclass::OutputImageRegionType OutputImageRegionType;
+  typedef typename Superclass::TransformType         TransformType;
+  typedef typename Superclass::PixelType             PixelType;
+  typedef typename Superclass::PixelValueType        PixelValueType;
+  typedef typename Superclass::PointType             PointType;
+
+  /** Transforms with a batch interface */
+  typedef GenericRSTransform<double, ImageDimension, ImageDimension> GenericRSTransformType;
+  typedef RationalTransform<double, ImageDimension>                  RationalTransformType;
+
+protected:
+  BatchTransformToDeformationFieldSource() {}
+  virtual ~BatchTransformToDeformationFieldSource() {}
+
+  /** Transform the points of the region row by row when possible */
+  virtual void ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, int threadId);
+
+private:
+  BatchTransformToDeformationFieldSource(const Self &); //purposely not implemented
+  void operator =(const Self&); //purposely not implemented
+};
+
+} // namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbBatchTransformToDeformationFieldSource.txx"
+#endif
+
+#endif
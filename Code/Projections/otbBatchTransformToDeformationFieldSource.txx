@@ -0,0 +1,108 @@
+/*=========================================================================
+
+  Program:   ORFEO Toolbox
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+
+  Copyright (c) Centre National d'Etudes Spatiales. All rights reserved.
+  See OTBCopyright.txt for details.
+
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __otbBatchTransformToDeformationFieldSource_txx
+#define __otbBatchTransformToDeformationFieldSource_txx
+
+#include "otbBatchTransformToDeformationFieldSource.h"
+#include "itkImageLinearIteratorWithIndex.h"
+#include "itkProgressReporter.h"
+#include <vector>
+
+namespace otb
+{
+
+template <class TOutputImage, class TTransformPrecisionType>
+void
+BatchTransformToDeformationFieldSource<TOutputImage, TTransformPrecisionType>
+::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, int threadId)
+{
+  const TransformType *          transform = this->GetTransform();
+  const GenericRSTransformType * rsTransform = dynamic_cast<const GenericRSTransformType *>(transform);
+  const RationalTransformType *  rationalTransform = dynamic_cast<const RationalTransformType *>(transform);
+
+  // Fall back to the point by point implementation
+  if (rsTransform == NULL && rationalTransform == NULL)
+    {
+    Superclass::ThreadedGenerateData(outputRegionForThread, threadId);
+    return;
+    }
+
+  // Get the output pointer
+  typename OutputImageType::Pointer outputPtr = this->GetOutput();
+
+  // Walk the output region row by row
+  typedef itk::ImageLinearIteratorWithIndex<OutputImageType> OutputIteratorType;
+  OutputIteratorType outIt(outputPtr, outputRegionForThread);
+  outIt.SetDirection(0);
+
+  const unsigned long rowSize = outputRegionForThread.GetSize()[0];
+  std::vector<double> inputPoints(rowSize * ImageDimension);
+  std::vector<double> transformedPoints(rowSize * ImageDimension);
+
+  PointType outputPoint;
+  PixelType deformation;
+
+  // Support for progress methods/callbacks
+  itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels());
+
+  outIt.GoToBegin();
+  while (!outIt.IsAtEnd())
+    {
+    // Gather the physical points of the row
+    unsigned long nbPoints = 0;
+    while (!outIt.IsAtEndOfLine())
+      {
+      outputPtr->TransformIndexToPhysicalPoint(outIt.GetIndex(), outputPoint);
+      for (unsigned int i = 0; i < ImageDimension; ++i)
+        {
+        inputPoints[nbPoints * ImageDimension + i] = outputPoint[i];
+        }
+      ++nbPoints;
+      ++outIt;
+      }
+
+    // Transform the whole row
+    if (rsTransform != NULL)
+      {
+      rsTransform->TransformPoints(&inputPoints[0], &transformedPoints[0], nbPoints);
+      }
+    else
+      {
+      rationalTransform->TransformPoints(&inputPoints[0], &transformedPoints[0], nbPoints);
+      }
+
+    // Compute and set the deformations
+    outIt.GoToBeginOfLine();
+    for (unsigned long p = 0; p < nbPoints; ++p, ++outIt)
+      {
+      for (unsigned int i = 0; i < ImageDimension; ++i)
+        {
+        deformation[i] = static_cast<PixelValueType>(transformedPoints[p * ImageDimension + i]
+                                                     - inputPoints[p * ImageDimension + i]);
+        }
+      outIt.Set(deformation);
+      progress.CompletedPixel();
+      }
+
+    outIt.NextLine();
+    }
+}
+
+} // namespace otb
+
+#endif
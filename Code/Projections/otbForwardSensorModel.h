@@ -72,6 +72,11 @@ public:
   /** Compute the world coordinates. */
   OutputPointType TransformPoint(const InputPointType& point) const;
 
+  /** Compute the world coordinates of nbPoints points at once. The input
+   *  buffer holds InputSpaceDimension interleaved coordinates per point,
+   *  the output buffer receives OutputSpaceDimension coordinates per point. */
+  virtual void TransformPoints(const double* in, double* out, size_t nbPoints) const;
+
 protected:
   ForwardSensorModel();
   virtual ~ForwardSensorModel();
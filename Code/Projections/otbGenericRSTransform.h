@@ -21,6 +21,7 @@
 #include <iostream>
 #include <sstream>
 #include <stdio.h>
+#include <vector>
 #include "itkTransform.h"
 #include "itkExceptionObject.h"
 #include "itkMacro.h"
@@ -172,6 +173,13 @@ public:
 
   OutputPointType TransformPoint(const InputPointType& point) const;
 
+  /** Transform nbPoints points at once. The input buffer holds
+   *  InputSpaceDimension interleaved coordinates per point, the output
+   *  buffer receives OutputSpaceDimension coordinates per point. Sensor
+   *  models are evaluated through their batch interface, which saves
+   *  per-point overhead and queries the DEM once for all the points. */
+  virtual void TransformPoints(const double* in, double* out, size_t nbPoints) const;
+
   virtual void  InstanciateTransform();
 
   // Get inverse methods
@@ -194,6 +202,11 @@ protected:
 
   void PrintSelf(std::ostream& os, itk::Indent indent) const;
 
+  /** Transform nbPoints points with one of the internal transforms,
+   *  through its batch interface if it has one */
+  void TransformPointsWith(const GenericTransformType* transform,
+                           const double* in, double* out, size_t nbPoints) const;
+
 private:
   GenericRSTransform(const Self &);    //purposely not implemented
   void operator =(const Self&);    //purposely not implemented
@@ -283,6 +283,99 @@ GenericRSTransform<TScalarType, NInputDimensions, NOutputDimensions>
   return outputPoint;
 }
 
+template<class TScalarType, unsigned int NInputDimensions, unsigned int NOutputDimensions>
+void
+GenericRSTransform<TScalarType, NInputDimensions, NOutputDimensions>
+::TransformPoints(const double* in, double* out, size_t nbPoints) const
+{
+  if (nbPoints == 0)
+    {
+    return;
+    }
+
+  // Intermediate coordinates are handed from the first transform to the
+  // second one, which requires both spaces to have the same dimension
+  if (NInputDimensions != NOutputDimensions)
+    {
+    InputPointType  inputPoint;
+    OutputPointType outputPoint;
+    for (size_t i = 0; i < nbPoints; ++i)
+      {
+      for (unsigned int dim = 0; dim < NInputDimensions; ++dim)
+        {
+        inputPoint[dim] = in[i * NInputDimensions + dim];
+        }
+      outputPoint = this->TransformPoint(inputPoint);
+      for (unsigned int dim = 0; dim < NOutputDimensions; ++dim)
+        {
+        out[i * NOutputDimensions + dim] = outputPoint[dim];
+        }
+      }
+    return;
+    }
+
+  // Check that the transform is up to date
+  this->GetTransform();
+
+  // Apply input origin/spacing
+  std::vector<double> inputPoints(in, in + nbPoints * NInputDimensions);
+  for (size_t i = 0; i < nbPoints; ++i)
+    {
+    inputPoints[i * NInputDimensions] = inputPoints[i * NInputDimensions] * m_InputSpacing[0] + m_InputOrigin[0];
+    inputPoints[i * NInputDimensions + 1] = inputPoints[i * NInputDimensions + 1] * m_InputSpacing[1]
+                                            + m_InputOrigin[1];
+    }
+
+  // Transform points
+  std::vector<double> geoPoints(nbPoints * NOutputDimensions);
+  this->TransformPointsWith(m_InputTransform, &inputPoints[0], &geoPoints[0], nbPoints);
+  this->TransformPointsWith(m_OutputTransform, &geoPoints[0], out, nbPoints);
+
+  // Apply output origin/spacing
+  for (size_t i = 0; i < nbPoints; ++i)
+    {
+    out[i * NOutputDimensions] = (out[i * NOutputDimensions] - m_OutputOrigin[0]) / m_OutputSpacing[0];
+    out[i * NOutputDimensions + 1] = (out[i * NOutputDimensions + 1] - m_OutputOrigin[1]) / m_OutputSpacing[1];
+    }
+}
+
+template<class TScalarType, unsigned int NInputDimensions, unsigned int NOutputDimensions>
+void
+GenericRSTransform<TScalarType, NInputDimensions, NOutputDimensions>
+::TransformPointsWith(const GenericTransformType* transform, const double* in, double* out, size_t nbPoints) const
+{
+  typedef otb::ForwardSensorModel<double, InputSpaceDimension, InputSpaceDimension>  ForwardSensorModelType;
+  typedef otb::InverseSensorModel<double, InputSpaceDimension, OutputSpaceDimension> InverseSensorModelType;
+
+  // Sensor models have a batch interface
+  if (const ForwardSensorModelType * forwardModel = dynamic_cast<const ForwardSensorModelType *>(transform))
+    {
+    forwardModel->TransformPoints(in, out, nbPoints);
+    return;
+    }
+  if (const InverseSensorModelType * inverseModel = dynamic_cast<const InverseSensorModelType *>(transform))
+    {
+    inverseModel->TransformPoints(in, out, nbPoints);
+    return;
+    }
+
+  // Otherwise, transform points one by one
+  typename GenericTransformType::InputPointType  inputPoint;
+  typename GenericTransformType::OutputPointType outputPoint;
+  for (size_t i = 0; i < nbPoints; ++i)
+    {
+    for (unsigned int dim = 0; dim < NInputDimensions; ++dim)
+      {
+      inputPoint[dim] = in[i * NInputDimensions + dim];
+      }
+    outputPoint = transform->TransformPoint(inputPoint);
+    for (unsigned int dim = 0; dim < NOutputDimensions; ++dim)
+      {
+      out[i * NOutputDimensions + dim] = outputPoint[dim];
+      }
+    }
+}
+
 template<class TScalarType, unsigned int NInputDimensions, unsigned int NOutputDimensions>
 bool
 GenericRSTransform<TScalarType, NInputDimensions, NOutputDimensions>
@@ -71,6 +71,11 @@ public:
 
   // Transform of geographic point in image sensor index
   virtual OutputPointType TransformPoint(const InputPointType& point) const;
+
+  /** Compute the image coordinates of nbPoints points at once. The input
+   *  buffer holds InputSpaceDimension interleaved coordinates per point,
+   *  the output buffer receives OutputSpaceDimension coordinates per point. */
+  virtual void TransformPoints(const double* in, double* out, size_t nbPoints) const;
   // Transform of geographic point in image sensor index -- Backward Compatibility
   //  OutputPointType TransformPoint(const InputPointType &point, double height) const;
 
@@ -21,6 +21,7 @@
 #include "otbInverseSensorModel.h"
 #include "itkExceptionObject.h"
 #include "otbMacro.h"
+#include <vector>
 
 namespace otb
 {
@@ -64,6 +65,40 @@ InverseSensorModel<TScalarType, NInputDimensions, NOutputDimensions>
   return outputPoint;
 }
 
+template <class TScalarType, unsigned int NInputDimensions, unsigned int NOutputDimensions>
+void
+InverseSensorModel<TScalarType, NInputDimensions, NOutputDimensions>
+::TransformPoints(const double* in, double* out, size_t nbPoints) const
+{
+  if (nbPoints == 0)
+    {
+    return;
+    }
+
+  // The adapter works on (x, y, z) triplets
+  std::vector<double> inputPoints(3 * nbPoints);
+  std::vector<double> outputPoints(3 * nbPoints);
+
+  for (size_t i = 0; i < nbPoints; ++i)
+    {
+    inputPoints[3 * i] = in[i * NInputDimensions];
+    inputPoints[3 * i + 1] = in[i * NInputDimensions + 1];
+    inputPoints[3 * i + 2] = (NInputDimensions == 3) ? in[i * NInputDimensions + 2] : this->m_AverageElevation;
+    }
+
+  this->m_Model->InverseTransformPoints(&inputPoints[0], &outputPoints[0], nbPoints);
+
+  for (size_t i = 0; i < nbPoints; ++i)
+    {
+    out[i * NOutputDimensions] = outputPoints[3 * i];
+    out[i * NOutputDimensions + 1] = outputPoints[3 * i + 1];
+    if (NOutputDimensions == 3)
+      {
+      out[i * NOutputDimensions + 2] = outputPoints[3 * i + 2];
+      }
+    }
+}
+
 template <class TScalarType, unsigned int NInputDimensions, unsigned int NOutputDimensions>
 void
 InverseSensorModel<TScalarType, NInputDimensions, NOutputDimensions>
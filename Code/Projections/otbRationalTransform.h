@@ -21,6 +21,8 @@
 #include "itkTransform.h"
 #include "itkExceptionObject.h"
 #include "itkMacro.h"
+#include <algorithm>
+#include <vector>
 
 namespace otb
 {
@@ -69,6 +71,9 @@ public:
 
   itkStaticConstMacro(SpaceDimension, unsigned int, Dimension);
 
+  /** Number of points evaluated together by TransformPoints() */
+  itkStaticConstMacro(BlockSize, unsigned int, 64);
+
   /** Set the numerator degree */
   itkSetMacro(NumeratorDegree, unsigned int);
 
@@ -129,6 +134,97 @@ public:
     return outputPoint;
   }
 
+  /** Transform nbPoints points at once. Both buffers hold Dimension
+   *  interleaved coordinates per point.
+   *
+   *  Points are processed by blocks of BlockSize: the powers of each
+   *  coordinate are computed once per block and shared by the numerator
+   *  and the denominator, and every inner loop runs over the points of
+   *  the block so that the compiler can vectorize it. The accumulation
+   *  order is the same as in TransformPoint(), so both methods return
+   *  identical results. */
+  virtual void TransformPoints(const double* in, double* out, size_t nbPoints) const
+  {
+    // Check for consistency
+    if(this->GetNumberOfParameters() != this->m_Parameters.size())
+      {
+      itkExceptionMacro(<<"Wrong number of parameters: found "<<this->m_Parameters.Size()<<", expected "<<this->GetNumberOfParameters());
+      }
+
+    if(nbPoints == 0)
+      {
+      return;
+      }
+
+    const unsigned int dimensionStride = (m_DenominatorDegree+1)+(m_NumeratorDegree+1);
+    const unsigned int maxDegree = std::max(m_NumeratorDegree, m_DenominatorDegree);
+    const double * parameters = this->m_Parameters.data_block();
+
+    // Scratch buffers: monomials, numerator and denominator of one block
+    std::vector<double> buffer((maxDegree + 3) * BlockSize);
+    double * powers = &buffer[0];
+    double * num    = powers + (maxDegree + 1) * BlockSize;
+    double * denom  = num + BlockSize;
+
+    for(size_t blockStart = 0; blockStart < nbPoints; blockStart += BlockSize)
+      {
+      const size_t blockLength = std::min(static_cast<size_t>(BlockSize), nbPoints - blockStart);
+      const double * blockIn = in + blockStart * SpaceDimension;
+      double * blockOut = out + blockStart * SpaceDimension;
+
+      for(unsigned int dim = 0; dim < SpaceDimension; ++dim)
+        {
+        const double * numCoefs = parameters + dim*dimensionStride;
+        const double * denomCoefs = numCoefs + m_NumeratorDegree + 1;
+
+        // Monomials x^0 ... x^maxDegree
+        for(size_t i = 0; i < blockLength; ++i)
+          {
+          powers[i] = 1.;
+          }
+        for(unsigned int degree = 1; degree <= maxDegree; ++degree)
+          {
+          const double * previous = powers + (degree - 1) * BlockSize;
+          double * current = powers + degree * BlockSize;
+          for(size_t i = 0; i < blockLength; ++i)
+            {
+            current[i] = previous[i] * blockIn[i*SpaceDimension+dim];
+            }
+          }
+
+        // Numerator and denominator
+        for(size_t i = 0; i < blockLength; ++i)
+          {
+          num[i] = 0.;
+          denom[i] = 0.;
+          }
+        for(unsigned int numDegree = 0; numDegree <= m_NumeratorDegree; ++numDegree)
+          {
+          const double coef = numCoefs[numDegree];
+          const double * power = powers + numDegree * BlockSize;
+          for(size_t i = 0; i < blockLength; ++i)
+            {
+            num[i] += coef * power[i];
+            }
+          }
+        for(unsigned int denomDegree = 0; denomDegree <= m_DenominatorDegree; ++denomDegree)
+          {
+          const double coef = denomCoefs[denomDegree];
+          const double * power = powers + denomDegree * BlockSize;
+          for(size_t i = 0; i < blockLength; ++i)
+            {
+            denom[i] += coef * power[i];
+            }
+          }
+
+        for(size_t i = 0; i < blockLength; ++i)
+          {
+          blockOut[i*SpaceDimension+dim] = num[i] / denom[i];
+          }
+        }
+      }
+  }
+
   // Get the number of parameters
   virtual unsigned int GetNumberOfParameters() const
   {
@@ -0,0 +1,308 @@
+/*=========================================================================
+
+  Program:   ORFEO Toolbox
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+
+  Copyright (c) Centre National d'Etudes Spatiales. All rights reserved.
+  See OTBCopyright.txt for details.
+
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+
+#ifndef __otbHermitian3x3EigenSolver_h
+#define __otbHermitian3x3EigenSolver_h
+
+#include <complex>
+#include <algorithm>
+#include "otbMath.h"
+
+namespace otb
+{
+
+/** \class Hermitian3x3EigenSolver
+ * \brief Closed form eigen decomposition of a 3*3 Hermitian matrix.
+ *
+ * This class computes the eigen values and the unit eigen vectors of the
+ * coherency or covariance matrices used in polarimetry, without any memory
+ * allocation. The matrix is given by its 6 channels (lower triangle, in row
+ * order), as produced by the SinclairToReciprocal*MatrixFunctor:
+ *
+ * \f[ \begin{pmatrix} c_0 & \bar{c_1} & \bar{c_2} \\ c_1 & c_3 & \bar{c_4} \\ c_2 & c_4 & c_5 \end{pmatrix} \f]
+ *
+ * The eigen values are the roots of the characteristic polynomial, given by
+ * the trigonometric solution of the cubic. They are sorted in decreasing
+ * order. The eigen vector of the best separated eigen value is computed as
+ * the largest cross product of two rows of \f$ M - \lambda I \f$, the second
+ * one is searched in the orthogonal complement of the first one and the last
+ * one is orthogonal to both, so that repeated eigen values still give an
+ * orthonormal basis.
+ *
+ * \ingroup SARPolarimetry
+ */
+class Hermitian3x3EigenSolver
+{
+public:
+  typedef std::complex<double> ComplexType;
+
+  /** Compute the decomposition of the matrix given by its 6 channels */
+  template <class TInput>
+  inline void Compute(const TInput& matrix)
+  {
+    this->Compute(static_cast<double>(matrix[0].real()), ComplexType(matrix[1]), ComplexType(matrix[2]),
+                  static_cast<double>(matrix[3].real()), ComplexType(matrix[4]),
+                  static_cast<double>(matrix[5].real()));
+  }
+
+  /** Compute the decomposition of the matrix given by its diagonal
+   *  (a00, a11, a22) and its lower triangle (a10, a20, a21) */
+  inline void Compute(double a00, const ComplexType& a10, const ComplexType& a20,
+                      double a11, const ComplexType& a21, double a22)
+  {
+    // Scale the matrix to avoid overflow and underflow
+    double scale = std::max(std::max(vcl_abs(a00), vcl_abs(a11)), vcl_abs(a22));
+    scale = std::max(scale, std::max(std::max(std::abs(a10), std::abs(a20)), std::abs(a21)));
+
+    if (scale == 0.)
+      {
+      for (unsigned int i = 0; i < 3; ++i)
+        {
+        m_EigenValues[i] = 0.;
+        for (unsigned int j = 0; j < 3; ++j)
+          {
+          m_EigenVectors[i][j] = ComplexType(i == j ? 1. : 0., 0.);
+          }
+        }
+      return;
+      }
+
+    m_Diagonal[0] = a00 / scale;
+    m_Diagonal[1] = a11 / scale;
+    m_Diagonal[2] = a22 / scale;
+    m_Lower[0] = a10 / scale;
+    m_Lower[1] = a20 / scale;
+    m_Lower[2] = a21 / scale;
+
+    // Characteristic polynomial of B = (A - q I) / p
+    const double q = (m_Diagonal[0] + m_Diagonal[1] + m_Diagonal[2]) / 3.;
+    const double b00 = m_Diagonal[0] - q;
+    const double b11 = m_Diagonal[1] - q;
+    const double b22 = m_Diagonal[2] - q;
+    const double n10 = std::norm(m_Lower[0]);
+    const double n20 = std::norm(m_Lower[1]);
+    const double n21 = std::norm(m_Lower[2]);
+    const double p = vcl_sqrt((b00 * b00 + b11 * b11 + b22 * b22 + 2. * (n10 + n20 + n21)) / 6.);
+
+    if (p == 0.)
+      {
+      // Multiple of the identity
+      for (unsigned int i = 0; i < 3; ++i)
+        {
+        m_EigenValues[i] = q * scale;
+        for (unsigned int j = 0; j < 3; ++j)
+          {
+          m_EigenVectors[i][j] = ComplexType(i == j ? 1. : 0., 0.);
+          }
+        }
+      return;
+      }
+
+    const double det = b00 * b11 * b22 - b00 * n21 - b11 * n20 - b22 * n10
+                       + 2. * (m_Lower[0] * m_Lower[2] * std::conj(m_Lower[1])).real();
+    double halfDet = det / (2. * p * p * p);
+    halfDet = std::min(std::max(halfDet, -1.), 1.);
+
+    const double angle = vcl_acos(halfDet) / 3.;
+    const double beta0 = 2. * vcl_cos(angle);
+    const double beta2 = 2. * vcl_cos(angle + 2. * CONST_PI / 3.);
+    const double beta1 = -(beta0 + beta2);
+
+    m_EigenValues[0] = q + p * beta0;
+    m_EigenValues[1] = q + p * beta1;
+    m_EigenValues[2] = q + p * beta2;
+
+    // Start from the eigen value which is the farthest from the two others
+    if (halfDet >= 0.)
+      {
+      this->ComputeIsolatedEigenVector(m_EigenValues[0], m_EigenVectors[0]);
+      this->ComputeComplementEigenVector(m_EigenValues[1], m_EigenVectors[0], m_EigenVectors[1]);
+      Cross(m_EigenVectors[0], m_EigenVectors[1], m_EigenVectors[2]);
+      }
+    else
+      {
+      this->ComputeIsolatedEigenVector(m_EigenValues[2], m_EigenVectors[2]);
+      this->ComputeComplementEigenVector(m_EigenValues[1], m_EigenVectors[2], m_EigenVectors[1]);
+      Cross(m_EigenVectors[1], m_EigenVectors[2], m_EigenVectors[0]);
+      }
+
+    for (unsigned int i = 0; i < 3; ++i)
+      {
+      m_EigenValues[i] *= scale;
+      }
+  }
+
+  /** Get the i-th eigen value, in decreasing order */
+  double GetEigenValue(unsigned int i) const
+  {
+    return m_EigenValues[i];
+  }
+
+  /** Get the unit eigen vector of the i-th eigen value */
+  const ComplexType * GetEigenVector(unsigned int i) const
+  {
+    return m_EigenVectors[i];
+  }
+
+private:
+  /** Product of the scaled matrix by a vector */
+  inline void Multiply(const ComplexType * v, ComplexType * res) const
+  {
+    res[0] = m_Diagonal[0] * v[0] + std::conj(m_Lower[0]) * v[1] + std::conj(m_Lower[1]) * v[2];
+    res[1] = m_Lower[0] * v[0] + m_Diagonal[1] * v[1] + std::conj(m_Lower[2]) * v[2];
+    res[2] = m_Lower[1] * v[0] + m_Lower[2] * v[1] + m_Diagonal[2] * v[2];
+  }
+
+  /** Conjugate of the cross product: the result is orthogonal to u and v */
+  static inline void Cross(const ComplexType * u, const ComplexType * v, ComplexType * res)
+  {
+    res[0] = std::conj(u[1] * v[2] - u[2] * v[1]);
+    res[1] = std::conj(u[2] * v[0] - u[0] * v[2]);
+    res[2] = std::conj(u[0] * v[1] - u[1] * v[0]);
+  }
+
+  static inline double SquaredNorm(const ComplexType * v)
+  {
+    return std::norm(v[0]) + std::norm(v[1]) + std::norm(v[2]);
+  }
+
+  /** Eigen vector of a simple eigen value: the kernel of M - lambda I is
+   *  orthogonal to the conjugate of its rows, the best conditioned cross
+   *  product is kept */
+  inline void ComputeIsolatedEigenVector(double lambda, ComplexType * vector) const
+  {
+    ComplexType rows[3][3];
+    rows[0][0] = m_Diagonal[0] - lambda;
+    rows[0][1] = std::conj(m_Lower[0]);
+    rows[0][2] = std::conj(m_Lower[1]);
+    rows[1][0] = m_Lower[0];
+    rows[1][1] = m_Diagonal[1] - lambda;
+    rows[1][2] = std::conj(m_Lower[2]);
+    rows[2][0] = m_Lower[1];
+    rows[2][1] = m_Lower[2];
+    rows[2][2] = m_Diagonal[2] - lambda;
+
+    // The rows are conjugated so that their cross product spans the kernel
+    for (unsigned int i = 0; i < 3; ++i)
+      {
+      for (unsigned int j = 0; j < 3; ++j)
+        {
+        rows[i][j] = std::conj(rows[i][j]);
+        }
+      }
+
+    ComplexType candidates[3][3];
+    Cross(rows[0], rows[1], candidates[0]);
+    Cross(rows[0], rows[2], candidates[1]);
+    Cross(rows[1], rows[2], candidates[2]);
+
+    unsigned int best = 0;
+    double bestNorm = SquaredNorm(candidates[0]);
+    for (unsigned int i = 1; i < 3; ++i)
+      {
+      const double norm = SquaredNorm(candidates[i]);
+      if (norm > bestNorm)
+        {
+        best = i;
+        bestNorm = norm;
+        }
+      }
+
+    if (bestNorm > 0.)
+      {
+      const double invNorm = 1. / vcl_sqrt(bestNorm);
+      for (unsigned int j = 0; j < 3; ++j)
+        {
+        vector[j] = candidates[best][j] * invNorm;
+        }
+      }
+    else
+      {
+      vector[0] = ComplexType(1., 0.);
+      vector[1] = ComplexType(0., 0.);
+      vector[2] = ComplexType(0., 0.);
+      }
+  }
+
+  /** Eigen vector of lambda in the orthogonal complement of the unit vector w */
+  inline void ComputeComplementEigenVector(double lambda, const ComplexType * w, ComplexType * vector) const
+  {
+    // Orthonormal basis (u, v) of the complement of w
+    ComplexType u[3], v[3];
+    if (std::norm(w[0]) > std::norm(w[1]))
+      {
+      const double invNorm = 1. / vcl_sqrt(std::norm(w[0]) + std::norm(w[2]));
+      u[0] = -std::conj(w[2]) * invNorm;
+      u[1] = ComplexType(0., 0.);
+      u[2] = std::conj(w[0]) * invNorm;
+      }
+    else
+      {
+      const double invNorm = 1. / vcl_sqrt(std::norm(w[1]) + std::norm(w[2]));
+      u[0] = ComplexType(0., 0.);
+      u[1] = std::conj(w[2]) * invNorm;
+      u[2] = -std::conj(w[1]) * invNorm;
+      }
+    Cross(w, u, v);
+
+    // Restriction of M - lambda I to the complement
+    ComplexType mu[3], mv[3];
+    this->Multiply(u, mu);
+    this->Multiply(v, mv);
+    const double m00 = (std::conj(u[0]) * mu[0] + std::conj(u[1]) * mu[1] + std::conj(u[2]) * mu[2]).real() - lambda;
+    const double m11 = (std::conj(v[0]) * mv[0] + std::conj(v[1]) * mv[1] + std::conj(v[2]) * mv[2]).real() - lambda;
+    const ComplexType m01 = std::conj(u[0]) * mv[0] + std::conj(u[1]) * mv[1] + std::conj(u[2]) * mv[2];
+
+    // Kernel of the 2*2 restriction, from its best conditioned row
+    ComplexType x0(1., 0.), x1(0., 0.);
+    const double norm01 = std::norm(m01);
+    if (vcl_abs(m00) >= vcl_abs(m11))
+      {
+      const double norm = m00 * m00 + norm01;
+      if (norm > 0.)
+        {
+        const double invNorm = 1. / vcl_sqrt(norm);
+        x0 = -m01 * invNorm;
+        x1 = ComplexType(m00 * invNorm, 0.);
+        }
+      }
+    else
+      {
+      const double norm = m11 * m11 + norm01;
+      const double invNorm = 1. / vcl_sqrt(norm);
+      x0 = ComplexType(m11 * invNorm, 0.);
+      x1 = -std::conj(m01) * invNorm;
+      }
+
+    for (unsigned int j = 0; j < 3; ++j)
+      {
+      vector[j] = x0 * u[j] + x1 * v[j];
+      }
+  }
+
+  double      m_EigenValues[3];
+  ComplexType m_EigenVectors[3][3];
+
+  /** Scaled matrix */
+  double      m_Diagonal[3];
+  ComplexType m_Lower[3];
+};
+
+} // end namespace otb
+
+#endif
@@ -21,7 +21,7 @@
 
 #include "otbUnaryFunctorImageFilter.h"
 #include "otbMath.h"
-#include "vnl/algo/vnl_complex_eigensystem.h"
+#include "otbHermitian3x3EigenSolver.h"
 #include <algorithm>
 
 namespace otb
@@ -50,7 +50,11 @@ namespace Functor {
  * - \f$ if p[i] > 1, p[i]=1 \f$
  * - \f$ if \alpha_{i} > 90, \alpha_{i}=90 \f$
  *
+ * The diagonalisation is done in closed form by the Hermitian3x3EigenSolver,
+ * which directly gives the eigen values sorted in decreasing order.
+ *
  * \ingroup SARPolarimetry
+ * \sa Hermitian3x3EigenSolver
  *
  */
 template< class TInput, class TOutput>
@@ -58,10 +62,7 @@ class ReciprocalHAlphaFunctor
 {
 public:
   typedef typename std::complex<double> ComplexType;
-  typedef vnl_matrix<ComplexType>       VNLMatrixType;
-  typedef vnl_vector<ComplexType>       VNLVectorType;
-  typedef vnl_vector<double>           VNLDoubleVectorType;
-  typedef std::vector<double>           VectorType;
+  typedef Hermitian3x3EigenSolver       EigenSolverType;
   typedef typename TOutput::ValueType   OutputValueType;
   
   
@@ -70,26 +71,9 @@ public:
     TOutput result;
     result.SetSize(m_NumberOfComponentsPerPixel);
  
-    const double T0 = static_cast<double>(Coherency[0].real());
-    const double T1 = static_cast<double>(Coherency[3].real());
-    const double T2 = static_cast<double>(Coherency[5].real());
-    
-    VNLMatrixType vnlMat(3, 3, 0.);
-    vnlMat[0][0] = ComplexType(T0,  0.);
-    vnlMat[0][1] = std::conj(ComplexType(Coherency[1]));
-    vnlMat[0][2] = std::conj(ComplexType(Coherency[2]));
-    vnlMat[1][0] = ComplexType(Coherency[1]);
-    vnlMat[1][1] = ComplexType(T1,  0.);
-    vnlMat[1][2] = std::conj(ComplexType(Coherency[4]));
-    vnlMat[2][0] = ComplexType(Coherency[2]);
-    vnlMat[2][1] = ComplexType(Coherency[4]);
-    vnlMat[2][2] = ComplexType(T2,  0.);
-    
-    // Only compute the left symetry to respect the previous Hermitian Analisys code
-    vnl_complex_eigensystem syst(vnlMat, false, true);
-    const VNLMatrixType eigenVectors( syst.L );
-    const VNLVectorType eigenValues(syst.W);
-    
+    EigenSolverType solver;
+    solver.Compute(Coherency);
+
     // Entropy estimation
     double totalEigenValues(0.0);
     double p[3];
@@ -97,26 +81,17 @@ public:
     double alpha;
     double anisotropy;
     
-    // Sort eigen values in decreasing order
-    VectorType sortedRealEigenValues(3,  eigenValues[0].real());
-    sortedRealEigenValues[1] = eigenValues[1].real();
-    sortedRealEigenValues[2] = eigenValues[2].real();
-    std::sort( sortedRealEigenValues.begin(), sortedRealEigenValues.end() );
-    std::reverse( sortedRealEigenValues.begin(), sortedRealEigenValues.end() );
+    // Eigen values in decreasing order
+    double sortedRealEigenValues[3];
+    sortedRealEigenValues[0] = solver.GetEigenValue(0);
+    sortedRealEigenValues[1] = solver.GetEigenValue(1);
+    sortedRealEigenValues[2] = solver.GetEigenValue(2);
     
     // Extract the first component of each the eigen vector sorted by eigen value decrease order
-    VNLVectorType sortedGreaterEigenVector(3, eigenVectors[0][0]);
-    for(unsigned int i=0; i<3; i++)
-      {
-        if( vcl_abs( eigenValues[1].real()-sortedRealEigenValues[i] ) < m_Epsilon )
-          {
-            sortedGreaterEigenVector[i] = eigenVectors[1][0];
-          }
-        else if( vcl_abs( eigenValues[2].real()-sortedRealEigenValues[i] ) < m_Epsilon )
-          {
-            sortedGreaterEigenVector[i] = eigenVectors[2][0];
-          }
-      }
+    ComplexType sortedGreaterEigenVector[3];
+    sortedGreaterEigenVector[0] = solver.GetEigenVector(0)[0];
+    sortedGreaterEigenVector[1] = solver.GetEigenVector(1)[0];
+    sortedGreaterEigenVector[2] = solver.GetEigenVector(2)[0];
  
     totalEigenValues = sortedRealEigenValues[0] + sortedRealEigenValues[1] + sortedRealEigenValues[2];
     if (totalEigenValues <m_Epsilon)
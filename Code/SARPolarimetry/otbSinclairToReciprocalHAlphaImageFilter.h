@@ -0,0 +1,147 @@
+/*=========================================================================
+
+  Program:   ORFEO Toolbox
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+
+  Copyright (c) Centre National d'Etudes Spatiales. All rights reserved.
+  See OTBCopyright.txt for details.
+
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __otbSinclairToReciprocalHAlphaImageFilter_h
+#define __otbSinclairToReciprocalHAlphaImageFilter_h
+
+#include "itkImageToImageFilter.h"
+#include "itkFixedArray.h"
+#include "otbReciprocalHAlphaImageFilter.h"
+#include <complex>
+
+namespace otb
+{
+
+/** \class SinclairToReciprocalHAlphaImageFilter
+ * \brief Compute the H-Alpha image (3 channels) directly from the reciprocal Sinclair images.
+ *
+ * This filter gives the same result as the chain SinclairReciprocalImageFilter (with the
+ * SinclairToReciprocalCoherencyMatrixFunctor), boxcar averaging of the coherency matrix and
+ * ReciprocalHAlphaImageFilter, in a single pass and without any intermediate coherency image.
+ *
+ * The coherency matrix of each pixel is averaged over a (2*radius+1) window (multi-look
+ * speckle filtering) set by SetRadius(). The window sums are updated with running box sums
+ * over the rows and columns of each thread region (see RunningWindowSums), so that the cost
+ * per pixel does not depend on the radius. The three inputs must have the same largest
+ * possible region. The image borders are handled as a zero flux Neumann boundary condition.
+ * The default radius is 0 (no averaging).
+ *
+ * The class is templated by the 3 input images (HH, HV_VH and VV) and the output image. For
+ * more details on the output channels, please refer to the class ReciprocalHAlphaFunctor.
+ *
+ * \ingroup SARPolarimetry
+ * \sa SinclairReciprocalImageFilter
+ * \sa ReciprocalHAlphaImageFilter
+ * \sa ReciprocalHAlphaFunctor
+ */
+template <class TInputImageHH, class TInputImageHV_VH, class TInputImageVV, class TOutputImage>
+class ITK_EXPORT SinclairToReciprocalHAlphaImageFilter : public itk::ImageToImageFilter<TInputImageHH, TOutputImage>
+{
+public:
+  /** Standard class typedefs. */
+  typedef SinclairToReciprocalHAlphaImageFilter                 Self;
+  typedef itk::ImageToImageFilter<TInputImageHH, TOutputImage>  Superclass;
+  typedef itk::SmartPointer<Self>                               Pointer;
+  typedef itk::SmartPointer<const Self>                         ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(SinclairToReciprocalHAlphaImageFilter, ImageToImageFilter);
+
+  /** Some convenient typedefs. */
+  typedef TInputImageHH                                         HHInputImageType;
+  typedef TInputImageHV_VH                                      HV_VHInputImageType;
+  typedef TInputImageVV                                         VVInputImageType;
+  typedef TOutputImage                                          OutputImageType;
+  typedef typename OutputImageType::Pointer                     OutputImagePointer;
+  typedef typename OutputImageType::RegionType                  OutputImageRegionType;
+  typedef typename OutputImageType::PixelType                   OutputPixelType;
+  typedef typename TInputImageHH::SizeType                      SizeType;
+  typedef std::complex<double>                                  ComplexType;
+  typedef itk::FixedArray<ComplexType, 6>                       CoherencyType;
+  typedef Functor::ReciprocalHAlphaFunctor<CoherencyType, OutputPixelType> FunctorType;
+
+  itkStaticConstMacro(ImageDimension, unsigned int, TInputImageHH::ImageDimension);
+
+  void SetInputHH(const TInputImageHH * image);
+  // This method set the second input, same as SetInputVH
+  void SetInputHV(const TInputImageHV_VH * image);
+  // This method set the second input, same as SetInputHV
+  void SetInputVH(const TInputImageHV_VH * image);
+  // This method set the second input, same as SetInputHV and SetInputHV
+  void SetInputHV_VH(const TInputImageHV_VH * image);
+  void SetInputVV(const TInputImageVV * image);
+
+  /** Set/Get the radius of the averaging window */
+  itkSetMacro(Radius, SizeType);
+  itkGetConstReferenceMacro(Radius, SizeType);
+
+  /** Set unsigned int radius */
+  void SetRadius(unsigned int radius)
+  {
+    m_Radius.Fill(radius);
+    this->Modified();
+  }
+
+  /** Get the functor object */
+  FunctorType& GetFunctor()
+  {
+    return m_Functor;
+  }
+
+protected:
+  /** Constructor */
+  SinclairToReciprocalHAlphaImageFilter();
+  /** Destructor */
+  virtual ~SinclairToReciprocalHAlphaImageFilter() {}
+
+  /** Set the number of channels of the output, and check that the
+   *  inputs have the same largest possible region */
+  virtual void GenerateOutputInformation();
+
+  /** Pad the input requested regions by the radius */
+  virtual void GenerateInputRequestedRegion();
+
+  /** Check that the inputs have the same buffered region */
+  virtual void BeforeThreadedGenerateData();
+
+  /** Average the coherency matrices with running sums and apply the functor */
+  virtual void ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread,
+                                    int threadId);
+
+  void PrintSelf(std::ostream& os, itk::Indent indent) const;
+
+private:
+  SinclairToReciprocalHAlphaImageFilter(const Self &); //purposely not implemented
+  void operator =(const Self&); //purposely not implemented
+
+  /** Radius of the averaging window */
+  SizeType    m_Radius;
+
+  /** The H-Alpha functor */
+  FunctorType m_Functor;
+};
+
+} // end namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbSinclairToReciprocalHAlphaImageFilter.txx"
+#endif
+
+#endif
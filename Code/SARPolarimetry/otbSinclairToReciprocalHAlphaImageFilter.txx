@@ -0,0 +1,292 @@
+/*=========================================================================
+
+  Program:   ORFEO Toolbox
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+
+  Copyright (c) Centre National d'Etudes Spatiales. All rights reserved.
+  See OTBCopyright.txt for details.
+
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __otbSinclairToReciprocalHAlphaImageFilter_txx
+#define __otbSinclairToReciprocalHAlphaImageFilter_txx
+
+#include "otbSinclairToReciprocalHAlphaImageFilter.h"
+#include "itkImageRegionIterator.h"
+#include "itkProgressReporter.h"
+#include "otbRunningWindowSums.h"
+
+#include <algorithm>
+
+namespace otb
+{
+
+/**
+ * Constructor
+ */
+template <class TInputImageHH, class TInputImageHV_VH, class TInputImageVV, class TOutputImage>
+SinclairToReciprocalHAlphaImageFilter<TInputImageHH, TInputImageHV_VH, TInputImageVV, TOutputImage>
+::SinclairToReciprocalHAlphaImageFilter()
+{
+  this->SetNumberOfRequiredInputs(3);
+  m_Radius.Fill(0);
+}
+
+template <class TInputImageHH, class TInputImageHV_VH, class TInputImageVV, class TOutputImage>
+void
+SinclairToReciprocalHAlphaImageFilter<TInputImageHH, TInputImageHV_VH, TInputImageVV, TOutputImage>
+::SetInputHH(const TInputImageHH * image)
+{
+  // Process object is not const-correct so the const casting is required.
+  this->SetNthInput(0, const_cast<TInputImageHH *>(image));
+}
+
+template <class TInputImageHH, class TInputImageHV_VH, class TInputImageVV, class TOutputImage>
+void
+SinclairToReciprocalHAlphaImageFilter<TInputImageHH, TInputImageHV_VH, TInputImageVV, TOutputImage>
+::SetInputHV(const TInputImageHV_VH * image)
+{
+  this->SetInputHV_VH(image);
+}
+
+template <class TInputImageHH, class TInputImageHV_VH, class TInputImageVV, class TOutputImage>
+void
+SinclairToReciprocalHAlphaImageFilter<TInputImageHH, TInputImageHV_VH, TInputImageVV, TOutputImage>
+::SetInputVH(const TInputImageHV_VH * image)
+{
+  this->SetInputHV_VH(image);
+}
+
+template <class TInputImageHH, class TInputImageHV_VH, class TInputImageVV, class TOutputImage>
+void
+SinclairToReciprocalHAlphaImageFilter<TInputImageHH, TInputImageHV_VH, TInputImageVV, TOutputImage>
+::SetInputHV_VH(const TInputImageHV_VH * image)
+{
+  this->SetNthInput(1, const_cast<TInputImageHV_VH *>(image));
+}
+
+template <class TInputImageHH, class TInputImageHV_VH, class TInputImageVV, class TOutputImage>
+void
+SinclairToReciprocalHAlphaImageFilter<TInputImageHH, TInputImageHV_VH, TInputImageVV, TOutputImage>
+::SetInputVV(const TInputImageVV * image)
+{
+  this->SetNthInput(2, const_cast<TInputImageVV *>(image));
+}
+
+template <class TInputImageHH, class TInputImageHV_VH, class TInputImageVV, class TOutputImage>
+void
+SinclairToReciprocalHAlphaImageFilter<TInputImageHH, TInputImageHV_VH, TInputImageVV, TOutputImage>
+::GenerateOutputInformation()
+{
+  // Call to the superclass implementation
+  Superclass::GenerateOutputInformation();
+
+  // The pixels of the three inputs are read at the same index
+  const HHInputImageType * inputPtrHH = dynamic_cast<const HHInputImageType *>(this->itk::ProcessObject::GetInput(0));
+  const HV_VHInputImageType * inputPtrHV_VH
+    = dynamic_cast<const HV_VHInputImageType *>(this->itk::ProcessObject::GetInput(1));
+  const VVInputImageType * inputPtrVV = dynamic_cast<const VVInputImageType *>(this->itk::ProcessObject::GetInput(2));
+  if (inputPtrHH && inputPtrHV_VH && inputPtrVV
+      && (inputPtrHV_VH->GetLargestPossibleRegion() != inputPtrHH->GetLargestPossibleRegion()
+          || inputPtrVV->GetLargestPossibleRegion() != inputPtrHH->GetLargestPossibleRegion()))
+    {
+    itkExceptionMacro(<< "The HH, HV_VH and VV inputs must have the same largest possible region");
+    }
+
+  // initialize the number of channels of the output image
+  this->GetOutput()->SetNumberOfComponentsPerPixel(m_Functor.GetOutputSize());
+}
+
+template <class TInputImageHH, class TInputImageHV_VH, class TInputImageVV, class TOutputImage>
+void
+SinclairToReciprocalHAlphaImageFilter<TInputImageHH, TInputImageHV_VH, TInputImageVV, TOutputImage>
+::GenerateInputRequestedRegion()
+{
+  // call the superclass' implementation of this method
+  Superclass::GenerateInputRequestedRegion();
+
+  OutputImagePointer outputPtr = this->GetOutput();
+  if (!outputPtr)
+    {
+    return;
+    }
+
+  for (unsigned int i = 0; i < 3; ++i)
+    {
+    typedef itk::ImageBase<ImageDimension> ImageBaseType;
+    ImageBaseType * inputPtr = dynamic_cast<ImageBaseType *>(this->itk::ProcessObject::GetInput(i));
+    if (!inputPtr)
+      {
+      return;
+      }
+
+    // pad the output requested region by the averaging radius
+    typename ImageBaseType::RegionType inputRequestedRegion = outputPtr->GetRequestedRegion();
+    inputRequestedRegion.PadByRadius(m_Radius);
+
+    // crop the input requested region at the input's largest possible region
+    if (inputRequestedRegion.Crop(inputPtr->GetLargestPossibleRegion()))
+      {
+      inputPtr->SetRequestedRegion(inputRequestedRegion);
+      }
+    else
+      {
+      // Couldn't crop the region (requested region is outside the largest
+      // possible region).  Throw an exception.
+      inputPtr->SetRequestedRegion(inputRequestedRegion);
+
+      itk::InvalidRequestedRegionError e(__FILE__, __LINE__);
+      std::ostringstream msg;
+      msg << this->GetNameOfClass()
+          << "::GenerateInputRequestedRegion()";
+      e.SetLocation(msg.str().c_str());
+      e.SetDescription("Requested region is (at least partially) outside the largest possible region.");
+      e.SetDataObject(inputPtr);
+      throw e;
+      }
+    }
+}
+
+template <class TInputImageHH, class TInputImageHV_VH, class TInputImageVV, class TOutputImage>
+void
+SinclairToReciprocalHAlphaImageFilter<TInputImageHH, TInputImageHV_VH, TInputImageVV, TOutputImage>
+::BeforeThreadedGenerateData()
+{
+  // ThreadedGenerateData() walks the buffer of the HH input only
+  const HHInputImageType * inputPtrHH = dynamic_cast<const HHInputImageType *>(this->itk::ProcessObject::GetInput(0));
+  const HV_VHInputImageType * inputPtrHV_VH
+    = dynamic_cast<const HV_VHInputImageType *>(this->itk::ProcessObject::GetInput(1));
+  const VVInputImageType * inputPtrVV = dynamic_cast<const VVInputImageType *>(this->itk::ProcessObject::GetInput(2));
+  if (inputPtrHV_VH->GetBufferedRegion() != inputPtrHH->GetBufferedRegion()
+      || inputPtrVV->GetBufferedRegion() != inputPtrHH->GetBufferedRegion())
+    {
+    itkExceptionMacro(<< "The HH, HV_VH and VV inputs must have the same buffered region");
+    }
+}
+
+/**
+ * ThreadedGenerateData Averages the coherency matrix from running sums
+ */
+template <class TInputImageHH, class TInputImageHV_VH, class TInputImageVV, class TOutputImage>
+void
+SinclairToReciprocalHAlphaImageFilter<TInputImageHH, TInputImageHV_VH, TInputImageVV, TOutputImage>
+::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread,
+                       int threadId)
+{
+  const TInputImageHH * inputPtrHH
+    = dynamic_cast<const TInputImageHH *>(this->itk::ProcessObject::GetInput(0));
+  const TInputImageHV_VH * inputPtrHV_VH
+    = dynamic_cast<const TInputImageHV_VH *>(this->itk::ProcessObject::GetInput(1));
+  const TInputImageVV * inputPtrVV
+    = dynamic_cast<const TInputImageVV *>(this->itk::ProcessObject::GetInput(2));
+  OutputImagePointer outputPtr = this->GetOutput();
+
+  // The three inputs share the same buffered region (checked in BeforeThreadedGenerateData())
+  const typename TInputImageHH::RegionType bufferedRegion = inputPtrHH->GetBufferedRegion();
+  const long bufferStartX = bufferedRegion.GetIndex()[0];
+  const long bufferStartY = bufferedRegion.GetIndex()[1];
+  const long bufferEndX   = bufferStartX + static_cast<long>(bufferedRegion.GetSize()[0]) - 1;
+  const long bufferEndY   = bufferStartY + static_cast<long>(bufferedRegion.GetSize()[1]) - 1;
+
+  const long radiusX = m_Radius[0];
+  const long radiusY = m_Radius[1];
+  const long width   = outputRegionForThread.GetSize()[0];
+  const long height  = outputRegionForThread.GetSize()[1];
+  const long startX  = outputRegionForThread.GetIndex()[0] - radiusX;
+  const long startY  = outputRegionForThread.GetIndex()[1] - radiusY;
+  const long paddedWidth  = width + 2 * radiusX;
+  const long paddedHeight = height + 2 * radiusY;
+
+  // Coherency of a pixel: T11, T22 and T33 are real, T12, T13 and T23 complex
+  RunningWindowSums windowSums(9, width, radiusX, radiusY);
+
+  const double invCount = 1. / windowSums.GetWindowCount();
+  CoherencyType coherency;
+
+  // support progress methods/callbacks
+  itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels());
+
+  itk::ImageRegionIterator<TOutputImage> outputIt(outputPtr, outputRegionForThread);
+  outputIt.GoToBegin();
+
+  typename TInputImageHH::IndexType index;
+
+  for (long row = 0; row < paddedHeight; ++row)
+    {
+    // Read the row, replicating the buffer borders
+    index[1] = std::min(std::max(startY + row, bufferStartY), bufferEndY);
+
+    double * pixel = windowSums.GetRowBuffer();
+    for (long column = 0; column < paddedWidth; ++column, pixel += 9)
+      {
+      index[0] = std::min(std::max(startX + column, bufferStartX), bufferEndX);
+
+      const ComplexType S_hh = static_cast<ComplexType>(inputPtrHH->GetPixel(index));
+      const ComplexType S_hv = static_cast<ComplexType>(inputPtrHV_VH->GetPixel(index));
+      const ComplexType S_vv = static_cast<ComplexType>(inputPtrVV->GetPixel(index));
+
+      // Same computation as the SinclairToReciprocalCoherencyMatrixFunctor,
+      // including its final division by two
+      const ComplexType HHPlusVV  = S_hh + S_vv;
+      const ComplexType HHMinusVV = S_hh - S_vv;
+      const ComplexType twoHV     = ComplexType(2.0) * S_hv;
+
+      const ComplexType T12 = HHPlusVV * vcl_conj(HHMinusVV);
+      const ComplexType T13 = HHPlusVV * vcl_conj(twoHV);
+      const ComplexType T23 = HHMinusVV * vcl_conj(twoHV);
+
+      pixel[0] = std::norm(HHPlusVV);
+      pixel[1] = T12.real();
+      pixel[2] = T12.imag();
+      pixel[3] = T13.real();
+      pixel[4] = T13.imag();
+      pixel[5] = std::norm(HHMinusVV);
+      pixel[6] = T23.real();
+      pixel[7] = T23.imag();
+      pixel[8] = std::norm(twoHV);
+
+      for (unsigned int k = 0; k < 9; ++k)
+        {
+        pixel[k] /= 2.0;
+        }
+      }
+
+    if (windowSums.PushRow())
+      {
+      for (long column = 0; column < width; ++column)
+        {
+        const double * w = windowSums.GetWindowSums(column);
+        coherency[0] = ComplexType(w[0] * invCount, 0.);
+        coherency[1] = ComplexType(w[1] * invCount, w[2] * invCount);
+        coherency[2] = ComplexType(w[3] * invCount, w[4] * invCount);
+        coherency[3] = ComplexType(w[5] * invCount, 0.);
+        coherency[4] = ComplexType(w[6] * invCount, w[7] * invCount);
+        coherency[5] = ComplexType(w[8] * invCount, 0.);
+
+        outputIt.Set(m_Functor(coherency));
+        ++outputIt;
+        progress.CompletedPixel();
+        }
+      }
+    }
+}
+
+template <class TInputImageHH, class TInputImageHV_VH, class TInputImageVV, class TOutputImage>
+void
+SinclairToReciprocalHAlphaImageFilter<TInputImageHH, TInputImageHV_VH, TInputImageVV, TOutputImage>
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Radius: " << m_Radius << std::endl;
+}
+
+} // end namespace otb
+
+#endif
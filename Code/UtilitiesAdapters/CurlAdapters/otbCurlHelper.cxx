@@ -25,6 +25,7 @@
 #ifdef OTB_USE_CURL
 #include <curl/curl.h>
 #include <cstring>
+#include <algorithm>
 #endif
 
 #include <cstdio>
@@ -358,108 +359,113 @@ int CurlHelper::RetrieveFileMulti(const std::vector<std::string>& listURLs,
 
   // Initialize curl handle resource
   CurlMultiResource::Pointer  multiHandle = CurlMultiResource::New();
-  
-  std::vector<CurlResource::Pointer> listCurlHandles;
-  std::vector<CurlFileDescriptorResource::Pointer> listFiles;
 
-  std::vector<std::string>::const_iterator filename;
-  filename = listFilename.begin();
-  while (filename != listFilename.end())
-    {
-    CurlFileDescriptorResource::Pointer lOutputFile = CurlFileDescriptorResource::New();
-    lOutputFile->OpenFile((*filename).c_str());
+  // Configure multi handle - set the maximum connections
+  CurlHandleError::ProcessCURLcode(curl_multi_setopt(multiHandle->GetCurlMultiResource(), CURLMOPT_MAXCONNECTS, maxConnect));
+  CurlHandleError::ProcessCURLcode(curl_multi_setopt(multiHandle->GetCurlMultiResource(), CURLMOPT_PIPELINING, 0));
 
-    // Add file to vector
-    listFiles.push_back(lOutputFile);
-    ++filename;
-    }
+  // The transfers are started as the previous ones complete, so that no
+  // more than maxConnect transfers (and output files) are open at once
+  const unsigned int nbTransfers = std::min(listURLs.size(), listFilename.size());
+  const unsigned int maxActive = maxConnect > 0 ? static_cast<unsigned int>(maxConnect) : 1;
 
-  listCurlHandles.clear();
+  std::vector<CurlResource::Pointer>               listCurlHandles(nbTransfers);
+  std::vector<CurlFileDescriptorResource::Pointer> listFiles(nbTransfers);
+  std::vector<unsigned int>                        listTransferIds(nbTransfers);
 
-  std::vector<std::string>::const_iterator url;
-  std::vector<CurlFileDescriptorResource::Pointer>::const_iterator      file;
-  url = listURLs.begin();
-  file = listFiles.begin();
-  while ((url != listURLs.end()) && (file != listFiles.end()))
+  unsigned int nextTransfer = 0;
+  unsigned int nbActive = 0;
+  int          error = 0;
+  int          lStillRunning = 0;
+
+  while (nextTransfer < nbTransfers || nbActive > 0)
     {
-    otbMsgDevMacro(<< "Retrieving: " << (*url).data());
-    CurlResource::Pointer lEasyHandle = CurlResource::New();
-
-    // Param easy handle
-    CurlHandleError::ProcessCURLcode(curl_easy_setopt(lEasyHandle->GetCurlResource(), CURLOPT_USERAGENT, m_Browser.data()));
-    CurlHandleError::ProcessCURLcode(curl_easy_setopt(lEasyHandle->GetCurlResource(), CURLOPT_URL, (*url).data()));
-    CurlHandleError::ProcessCURLcode(curl_easy_setopt(lEasyHandle->GetCurlResource(), CURLOPT_WRITEFUNCTION,
-                                 &Self::CallbackWriteDataToFile));
-    CurlHandleError::ProcessCURLcode(curl_easy_setopt(lEasyHandle->GetCurlResource(), CURLOPT_WRITEDATA,
-                                 (void*) (*file)->GetFileResource()));
-
-    // Add easy handle to multi handle
-    CurlHandleError::ProcessCURLcode(curl_multi_add_handle(multiHandle->GetCurlMultiResource(), lEasyHandle->GetCurlResource()));
-
-    // Add hanle to vector
-    listCurlHandles.push_back(lEasyHandle);
-    ++url;
-    ++file;
-    }
+    // Fill the free connection slots
+    while (nextTransfer < nbTransfers && nbActive < maxActive)
+      {
+      otbMsgDevMacro(<< "Retrieving: " << listURLs[nextTransfer].data());
+      CurlFileDescriptorResource::Pointer lOutputFile = CurlFileDescriptorResource::New();
+      lOutputFile->OpenFile(listFilename[nextTransfer].c_str());
+
+      CurlResource::Pointer lEasyHandle = CurlResource::New();
+
+      // Param easy handle
+      CurlHandleError::ProcessCURLcode(curl_easy_setopt(lEasyHandle->GetCurlResource(), CURLOPT_USERAGENT, m_Browser.data()));
+      CurlHandleError::ProcessCURLcode(curl_easy_setopt(lEasyHandle->GetCurlResource(), CURLOPT_URL,
+                                                        listURLs[nextTransfer].data()));
+      CurlHandleError::ProcessCURLcode(curl_easy_setopt(lEasyHandle->GetCurlResource(), CURLOPT_WRITEFUNCTION,
+                                   &Self::CallbackWriteDataToFile));
+      CurlHandleError::ProcessCURLcode(curl_easy_setopt(lEasyHandle->GetCurlResource(), CURLOPT_WRITEDATA,
+                                   (void*) lOutputFile->GetFileResource()));
+      // Keep the transfer number to release its resources on completion
+      CurlHandleError::ProcessCURLcode(curl_easy_setopt(lEasyHandle->GetCurlResource(), CURLOPT_PRIVATE,
+                                   (char*) &listTransferIds[nextTransfer]));
+
+      // Add easy handle to multi handle
+      CurlHandleError::ProcessCURLcode(curl_multi_add_handle(multiHandle->GetCurlMultiResource(),
+                                                             lEasyHandle->GetCurlResource()));
+
+      listTransferIds[nextTransfer] = nextTransfer;
+      listFiles[nextTransfer] = lOutputFile;
+      listCurlHandles[nextTransfer] = lEasyHandle;
+      ++nextTransfer;
+      ++nbActive;
+      }
 
-  //fetch tiles
-  // Configure multi handle - set the maximum connections
-  CurlHandleError::ProcessCURLcode(curl_multi_setopt(multiHandle->GetCurlMultiResource(), CURLMOPT_MAXCONNECTS, maxConnect));
-  CurlHandleError::ProcessCURLcode(curl_multi_setopt(multiHandle->GetCurlMultiResource(), CURLMOPT_PIPELINING, 0));
+    // Perform
+    while (CURLM_CALL_MULTI_PERFORM == curl_multi_perform(multiHandle->GetCurlMultiResource(), &lStillRunning));
 
-  // Perform
-  int lStillRunning;
+    // Release the completed transfers
+    int      remaining_msgs = 0;
+    CURLMsg *msg;
+    while ((msg = curl_multi_info_read(multiHandle->GetCurlMultiResource(), &remaining_msgs)) != NULL)
+      {
+      if (msg->msg != CURLMSG_DONE)
+        {
+        continue;
+        }
+      if (CURLE_OK != msg->data.result) error = 1;
 
-  while (CURLM_CALL_MULTI_PERFORM == curl_multi_perform(multiHandle->GetCurlMultiResource(), &lStillRunning));
+      char * transferId = NULL;
+      curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &transferId);
+      const unsigned int transfer = *reinterpret_cast<unsigned int *>(transferId);
 
-  // Now get that URL
-  while (lStillRunning)
-    {
+      curl_multi_remove_handle(multiHandle->GetCurlMultiResource(), msg->easy_handle);
+      listCurlHandles[transfer] = NULL;
+      listFiles[transfer] = NULL;
+      --nbActive;
+      }
+
+    if (lStillRunning == 0 || nbActive == 0)
+      {
+      continue;
+      }
+
+    // Wait for activity on the sockets, or for the delay curl asks for
     struct timeval timeout;
-    int            rc; // Return code
+    long           curlTimeout = -1;
 
     fd_set fdread;
     fd_set fdwrite;
     fd_set fdexcep;
-    int    maxfd;
+    int    maxfd = -1;
 
     FD_ZERO(&fdread);
     FD_ZERO(&fdwrite);
     FD_ZERO(&fdexcep);
 
-    /* set a suitable timeout to play around with */
+    curl_multi_timeout(multiHandle->GetCurlMultiResource(), &curlTimeout);
+    if (curlTimeout < 0 || curlTimeout > 100)
+      {
+      curlTimeout = 100;
+      }
     timeout.tv_sec = 0;
-    timeout.tv_usec = 1;
+    timeout.tv_usec = curlTimeout * 1000;
 
     /* get file descriptors from the transfers */
     CurlHandleError::ProcessCURLcode(curl_multi_fdset(multiHandle->GetCurlMultiResource(), &fdread, &fdwrite, &fdexcep, &maxfd));
 
-    rc = select(maxfd + 1, &fdread, &fdwrite, &fdexcep, &timeout);
-
-    switch (rc)
-      {
-      case -1:
-        /* select error */
-        break;
-      case 0:
-        /* timeout */
-      default:
-        /* timeout or readable/writable sockets */
-        while (CURLM_CALL_MULTI_PERFORM == curl_multi_perform(multiHandle->GetCurlMultiResource(), &lStillRunning));
-        break;
-      }
-    }
-
-  int      remaining_msgs = 1;
-  int      error = 0;
-  CURLMsg *msg;
-  while (remaining_msgs)
-    {
-    msg = curl_multi_info_read(multiHandle->GetCurlMultiResource(), &remaining_msgs);
-    if (msg != NULL)
-      {
-      if (CURLE_OK != msg->data.result) error = 1;
-      }
+    select(maxfd + 1, &fdread, &fdwrite, &fdexcep, &timeout);
     }
 
   if (error != 0)
@@ -467,10 +473,6 @@ int CurlHelper::RetrieveFileMulti(const std::vector<std::string>& listURLs,
     itkExceptionMacro(<< "otbCurlHelper: Error occurs while perform Multi handle");
     }
 
-  // Cleanup
-  listFiles.clear();
-  listCurlHandles.clear();
-
   return 0;
 #else
   //fallback on non curl multi
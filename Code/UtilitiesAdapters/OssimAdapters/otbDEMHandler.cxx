@@ -24,13 +24,16 @@
 #include "base/ossimDirectory.h"
 #include "base/ossimGeoidEgm96.h"
 #include "base/ossimRefPtr.h"
+#include "base/ossimGpt.h"
 
 namespace otb
 {
 
 DEMHandler
 ::DEMHandler() :
-  m_ElevManager(ossimElevManager::instance())
+  m_ElevManager(ossimElevManager::instance()),
+  m_TileCache(DEMTileCache::GetInstance()),
+  m_UseTileCache(false)
 {
 }
 
@@ -45,6 +48,9 @@ DEMHandler
     {
     itkExceptionMacro("Failed to open DEM Directory: " << ossimDEMDir);
     }
+
+  // Tiles decoded before may now have data
+  m_TileCache->Flush();
 }
 
 void
@@ -58,7 +64,9 @@ bool
 DEMHandler
 ::IsValidDEMDirectory(const char* DEMDirectory)
 {
-  return m_ElevManager->loadElevationPath(DEMDirectory);
+  bool valid = m_ElevManager->loadElevationPath(DEMDirectory);
+  m_TileCache->Flush();
+  return valid;
 }
 
 void
@@ -75,6 +83,7 @@ DEMHandler
       otbMsgDevMacro(<< "Geoid successfully opened");
       ossimGeoidManager::instance()->addGeoid(geoidPtr);
       geoidPtr.release();
+      m_TileCache->Flush();
       }
     else
       {
@@ -95,6 +104,11 @@ double
 DEMHandler
 ::GetHeightAboveMSL(double lon, double lat) const
 {
+  if (m_UseTileCache)
+    {
+    return m_TileCache->GetHeightAboveMSL(lon, lat);
+    }
+
   double   height;
   ossimGpt ossimWorldPoint;
   ossimWorldPoint.lon = lon;
@@ -114,6 +128,11 @@ double
 DEMHandler
 ::GetHeightAboveEllipsoid(double lon, double lat) const
 {
+  if (m_UseTileCache)
+    {
+    return m_TileCache->GetHeightAboveEllipsoid(lon, lat);
+    }
+
   double   height;
   ossimGpt ossimWorldPoint;
   ossimWorldPoint.lon = lon;
@@ -130,11 +149,44 @@ DEMHandler
   return GetHeightAboveEllipsoid(geoPoint[0], geoPoint[1]);
 }
 
+void
+DEMHandler
+::GetHeightsAboveMSL(const double* lonLat, double* heights, unsigned long nbPoints) const
+{
+  if (m_UseTileCache)
+    {
+    m_TileCache->GetHeightsAboveMSL(lonLat, heights, nbPoints);
+    return;
+    }
+
+  for (unsigned long i = 0; i < nbPoints; ++i)
+    {
+    heights[i] = this->GetHeightAboveMSL(lonLat[2 * i], lonLat[2 * i + 1]);
+    }
+}
+
+void
+DEMHandler
+::GetHeightsAboveEllipsoid(const double* lonLat, double* heights, unsigned long nbPoints) const
+{
+  if (m_UseTileCache)
+    {
+    m_TileCache->GetHeightsAboveEllipsoid(lonLat, heights, nbPoints);
+    return;
+    }
+
+  for (unsigned long i = 0; i < nbPoints; ++i)
+    {
+    heights[i] = this->GetHeightAboveEllipsoid(lonLat[2 * i], lonLat[2 * i + 1]);
+    }
+}
+
 void
 DEMHandler
 ::SetDefaultHeightAboveEllipsoid(double h)
 {
   m_ElevManager->setDefaultHeightAboveEllipsoid(h);
+  m_TileCache->Flush();
 }
 
 void
@@ -143,6 +195,7 @@ DEMHandler
 {
   Superclass::PrintSelf(os, indent);
   os << indent << "DEMHandler" << std::endl;
+  os << indent << "UseTileCache: " << m_UseTileCache << std::endl;
 }
 
 } // namespace otb
@@ -25,6 +25,7 @@
 #include "itkObject.h"
 #include "itkObjectFactory.h"
 #include "itkPoint.h"
+#include "otbDEMTileCache.h"
 
 class ossimElevManager;
 
@@ -37,6 +38,15 @@ namespace otb
  * This class is based on ossimElevManager.
  * It allows to obtain height above MSL(Mean Sea Level) of a geographic point
  * Handle DTED and SRTM formats.
+ *
+ * By default, each query is forwarded to ossimElevManager. With
+ * UseTileCacheOn(), heights are interpolated from the tiles decoded in the
+ * DEMTileCache, which can be queried concurrently from several threads,
+ * at the cost of the approximations described there (fixed 3 arc-seconds
+ * posts, geoid interpolated from its 15 minutes grid). Batch methods allow
+ * to compute the heights of a whole set of points at once.
+ *
+ * \sa DEMTileCache
  * \ingroup Images
  *
  */
@@ -77,6 +87,19 @@ public:
   virtual double GetHeightAboveEllipsoid(double lon, double lat) const;
   virtual double GetHeightAboveEllipsoid(const PointType& geoPoint) const;
 
+  /** Compute the heights above MSL of nbPoints geographic points, given
+   *  as interleaved (lon, lat) pairs. */
+  virtual void GetHeightsAboveMSL(const double* lonLat, double* heights, unsigned long nbPoints) const;
+
+  /** Compute the heights above ellipsoid of nbPoints geographic points,
+   *  given as interleaved (lon, lat) pairs. */
+  virtual void GetHeightsAboveEllipsoid(const double* lonLat, double* heights, unsigned long nbPoints) const;
+
+  /** Use the DEM tile cache (default is off) */
+  itkSetMacro(UseTileCache, bool);
+  itkGetMacro(UseTileCache, bool);
+  itkBooleanMacro(UseTileCache);
+
   /** Set the default height above ellipsoid in case no information is available*/
   virtual void SetDefaultHeightAboveEllipsoid(double h);
 
@@ -88,6 +111,9 @@ protected:
 
   ossimElevManager* m_ElevManager;
 
+  DEMTileCache::Pointer m_TileCache;
+  bool                  m_UseTileCache;
+
 };
 
 } // namespace otb
@@ -0,0 +1,397 @@
+/*=========================================================================
+
+  Program:   ORFEO Toolbox
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+
+  Copyright (c) Centre National d'Etudes Spatiales. All rights reserved.
+  See OTBCopyright.txt for details.
+
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#include "otbDEMTileCache.h"
+#include "otbMacro.h"
+
+#include "vcl_cmath.h"
+#include <algorithm>
+
+#include "elevation/ossimElevManager.h"
+#include "base/ossimGeoidManager.h"
+#include "base/ossimGpt.h"
+#include "base/ossimCommon.h"
+
+namespace otb
+{
+
+/** Initialize the singleton */
+DEMTileCache::Pointer DEMTileCache::Instance = NULL;
+
+DEMTileCache::Pointer
+DEMTileCache
+::GetInstance()
+{
+  if (!Instance)
+    {
+    Instance = Self::New();
+    }
+  return Instance;
+}
+
+DEMTileCache
+::DEMTileCache() :
+  m_MaximumMemory(128 * 1024 * 1024),
+  m_TilesPerDegree(4),
+  m_PostsPerDegree(1200)
+{
+  for (unsigned int i = 0; i < NumberOfShards; ++i)
+    {
+    m_Shards[i].m_Memory = 0;
+    }
+}
+
+void
+DEMTileCache
+::SetMaximumMemory(unsigned long bytes)
+{
+  m_MaximumMemory = bytes;
+  this->Modified();
+}
+
+void
+DEMTileCache
+::SetTilesPerDegree(unsigned int tilesPerDegree)
+{
+  if (tilesPerDegree == 0)
+    {
+    itkExceptionMacro(<< "The number of tiles per degree must be strictly positive.");
+    }
+  this->Flush();
+  m_TilesPerDegree = tilesPerDegree;
+  this->Modified();
+}
+
+void
+DEMTileCache
+::SetPostsPerDegree(unsigned int postsPerDegree)
+{
+  if (postsPerDegree == 0)
+    {
+    itkExceptionMacro(<< "The number of posts per degree must be strictly positive.");
+    }
+  this->Flush();
+  m_PostsPerDegree = postsPerDegree;
+  this->Modified();
+}
+
+void
+DEMTileCache
+::Flush()
+{
+  m_DecodeLock.Lock();
+  for (unsigned int i = 0; i < NumberOfShards; ++i)
+    {
+    m_Shards[i].m_Lock.Lock();
+    m_Shards[i].m_Tiles.clear();
+    m_Shards[i].m_LRU.clear();
+    m_Shards[i].m_Memory = 0;
+    m_Shards[i].m_Lock.Unlock();
+    }
+  m_DecodeLock.Unlock();
+}
+
+unsigned long
+DEMTileCache
+::GetMemoryUsage() const
+{
+  unsigned long memory = 0;
+  for (unsigned int i = 0; i < NumberOfShards; ++i)
+    {
+    m_Shards[i].m_Lock.Lock();
+    memory += m_Shards[i].m_Memory;
+    m_Shards[i].m_Lock.Unlock();
+    }
+  return memory;
+}
+
+unsigned int
+DEMTileCache
+::GetNumberOfPostsPerTile() const
+{
+  return (m_PostsPerDegree + m_TilesPerDegree - 1) / m_TilesPerDegree + 1;
+}
+
+unsigned int
+DEMTileCache
+::GetNumberOfGeoidPostsPerTile() const
+{
+  // Geoid models are given on a 15 minutes grid
+  return std::max(1U, (4 + m_TilesPerDegree - 1) / m_TilesPerDegree) + 1;
+}
+
+DEMTileCache::TileKeyType
+DEMTileCache
+::GetTileKey(double lon, double lat) const
+{
+  return TileKeyType(static_cast<long>(vcl_floor(lon * m_TilesPerDegree)),
+                     static_cast<long>(vcl_floor(lat * m_TilesPerDegree)));
+}
+
+unsigned int
+DEMTileCache
+::GetShardIndex(const TileKeyType& key) const
+{
+  const unsigned long hash = static_cast<unsigned long>(key.first) * 73856093UL
+                             ^ static_cast<unsigned long>(key.second) * 19349663UL;
+  return static_cast<unsigned int>(hash % NumberOfShards);
+}
+
+void
+DEMTileCache
+::DecodeTile(const TileKeyType& key, TileType& tile) const
+{
+  const double       span = 1. / m_TilesPerDegree;
+  const double       west = key.first * span;
+  const double       south = key.second * span;
+  const unsigned int nbPosts = this->GetNumberOfPostsPerTile();
+  const unsigned int nbGeoidPosts = this->GetNumberOfGeoidPostsPerTile();
+  const double       spacing = span / (nbPosts - 1);
+  const double       geoidSpacing = span / (nbGeoidPosts - 1);
+
+  // Border posts are sampled slightly inside the tile, so that they are
+  // read from the DEM cell covering the tile
+  const double margin = 1e-7 * spacing;
+
+  otbMsgDevMacro(<< "Decoding DEM tile " << key.first << ", " << key.second
+                 << " (" << nbPosts << "x" << nbPosts << " posts)");
+
+  ossimElevManager* elevManager = ossimElevManager::instance();
+
+  tile.m_Heights.resize(nbPosts * nbPosts);
+  ossimGpt worldPoint;
+  for (unsigned int row = 0; row < nbPosts; ++row)
+    {
+    worldPoint.lat = std::min(std::max(south + row * spacing, south + margin), south + span - margin);
+    for (unsigned int col = 0; col < nbPosts; ++col)
+      {
+      worldPoint.lon = std::min(std::max(west + col * spacing, west + margin), west + span - margin);
+      tile.m_Heights[row * nbPosts + col] = static_cast<float>(elevManager->getHeightAboveMSL(worldPoint));
+      }
+    }
+
+  tile.m_GeoidOffsets.resize(nbGeoidPosts * nbGeoidPosts);
+  for (unsigned int row = 0; row < nbGeoidPosts; ++row)
+    {
+    worldPoint.lat = south + row * geoidSpacing;
+    for (unsigned int col = 0; col < nbGeoidPosts; ++col)
+      {
+      worldPoint.lon = west + col * geoidSpacing;
+      double offset = ossimGeoidManager::instance()->offsetFromEllipsoid(worldPoint);
+      tile.m_GeoidOffsets[row * nbGeoidPosts + col] = ossim::isnan(offset) ? 0. : offset;
+      }
+    }
+}
+
+const DEMTileCache::TileType&
+DEMTileCache
+::InsertTile(ShardType& shard, const TileKeyType& key, const TileType& tile) const
+{
+  shard.m_LRU.push_front(key);
+  TileMapType::iterator it =
+    shard.m_Tiles.insert(std::make_pair(key, TileEntryType(tile, shard.m_LRU.begin()))).first;
+  shard.m_Memory += tile.m_Heights.size() * sizeof(float) + tile.m_GeoidOffsets.size() * sizeof(double);
+
+  // Evict least recently used tiles, but keep at least the new one
+  const unsigned long shardMaximumMemory = m_MaximumMemory / NumberOfShards;
+  while (shard.m_Memory > shardMaximumMemory && shard.m_LRU.size() > 1)
+    {
+    TileMapType::iterator evicted = shard.m_Tiles.find(shard.m_LRU.back());
+    shard.m_Memory -= evicted->second.first.m_Heights.size() * sizeof(float)
+                      + evicted->second.first.m_GeoidOffsets.size() * sizeof(double);
+    shard.m_Tiles.erase(evicted);
+    shard.m_LRU.pop_back();
+    }
+
+  return it->second.first;
+}
+
+double
+DEMTileCache
+::InterpolateHeight(const TileType& tile, const TileKeyType& key,
+                    double lon, double lat, bool aboveEllipsoid) const
+{
+  const double span = 1. / m_TilesPerDegree;
+  const double west = key.first * span;
+  const double south = key.second * span;
+
+  // Bilinear interpolation of the height above MSL
+  const unsigned int nbPosts = this->GetNumberOfPostsPerTile();
+  double x = (lon - west) * (nbPosts - 1) / span;
+  double y = (lat - south) * (nbPosts - 1) / span;
+  unsigned int col = static_cast<unsigned int>(std::min(std::max(vcl_floor(x), 0.), nbPosts - 2.));
+  unsigned int row = static_cast<unsigned int>(std::min(std::max(vcl_floor(y), 0.), nbPosts - 2.));
+  double dx = std::min(std::max(x - col, 0.), 1.);
+  double dy = std::min(std::max(y - row, 0.), 1.);
+
+  const float* posts = &tile.m_Heights[row * nbPosts + col];
+  const double height = (1 - dy) * ((1 - dx) * posts[0] + dx * posts[1])
+                        + dy * ((1 - dx) * posts[nbPosts] + dx * posts[nbPosts + 1]);
+
+  if (!aboveEllipsoid)
+    {
+    return height;
+    }
+
+  // Bilinear interpolation of the geoid offset
+  const unsigned int nbGeoidPosts = this->GetNumberOfGeoidPostsPerTile();
+  x = (lon - west) * (nbGeoidPosts - 1) / span;
+  y = (lat - south) * (nbGeoidPosts - 1) / span;
+  col = static_cast<unsigned int>(std::min(std::max(vcl_floor(x), 0.), nbGeoidPosts - 2.));
+  row = static_cast<unsigned int>(std::min(std::max(vcl_floor(y), 0.), nbGeoidPosts - 2.));
+  dx = std::min(std::max(x - col, 0.), 1.);
+  dy = std::min(std::max(y - row, 0.), 1.);
+
+  const double* offsets = &tile.m_GeoidOffsets[row * nbGeoidPosts + col];
+  const double offset = (1 - dy) * ((1 - dx) * offsets[0] + dx * offsets[1])
+                        + dy * ((1 - dx) * offsets[nbGeoidPosts] + dx * offsets[nbGeoidPosts + 1]);
+
+  return height + offset;
+}
+
+void
+DEMTileCache
+::GetHeights(const double* lonLat, double* heights, unsigned long nbPoints, bool aboveEllipsoid) const
+{
+  unsigned long begin = 0;
+  while (begin < nbPoints)
+    {
+    // Find the run of points lying in the same tile
+    const TileKeyType key = this->GetTileKey(lonLat[2 * begin], lonLat[2 * begin + 1]);
+    unsigned long     end = begin + 1;
+    while (end < nbPoints && this->GetTileKey(lonLat[2 * end], lonLat[2 * end + 1]) == key)
+      {
+      ++end;
+      }
+
+    ShardType& shard = m_Shards[this->GetShardIndex(key)];
+
+    // Fast path: the tile is already decoded
+    bool found = false;
+    shard.m_Lock.Lock();
+    TileMapType::iterator it = shard.m_Tiles.find(key);
+    if (it != shard.m_Tiles.end())
+      {
+      shard.m_LRU.splice(shard.m_LRU.begin(), shard.m_LRU, it->second.second);
+      for (unsigned long i = begin; i < end; ++i)
+        {
+        heights[i] = this->InterpolateHeight(it->second.first, key, lonLat[2 * i], lonLat[2 * i + 1], aboveEllipsoid);
+        }
+      found = true;
+      }
+    shard.m_Lock.Unlock();
+
+    if (!found)
+      {
+      // Slow path: decode the tile, unless another thread did it meanwhile
+      m_DecodeLock.Lock();
+      shard.m_Lock.Lock();
+      found = (shard.m_Tiles.find(key) != shard.m_Tiles.end());
+      shard.m_Lock.Unlock();
+
+      TileType tile;
+      if (!found)
+        {
+        this->DecodeTile(key, tile);
+        }
+
+      shard.m_Lock.Lock();
+      const TileType& cachedTile = found ? shard.m_Tiles.find(key)->second.first : this->InsertTile(shard, key, tile);
+      for (unsigned long i = begin; i < end; ++i)
+        {
+        heights[i] = this->InterpolateHeight(cachedTile, key, lonLat[2 * i], lonLat[2 * i + 1], aboveEllipsoid);
+        }
+      shard.m_Lock.Unlock();
+      m_DecodeLock.Unlock();
+      }
+
+    begin = end;
+    }
+
+  if (!aboveEllipsoid)
+    {
+    return;
+    }
+
+  // Where no DEM data is available, the height above ellipsoid falls back
+  // on ossimElevManager (default height or geoid), whose accesses are
+  // serialized with the decoding
+  bool locked = false;
+  for (unsigned long i = 0; i < nbPoints; ++i)
+    {
+    if (ossim::isnan(heights[i]))
+      {
+      if (!locked)
+        {
+        m_DecodeLock.Lock();
+        locked = true;
+        }
+      heights[i] = ossimElevManager::instance()->getHeightAboveEllipsoid(ossimGpt(lonLat[2 * i + 1], lonLat[2 * i]));
+      }
+    }
+  if (locked)
+    {
+    m_DecodeLock.Unlock();
+    }
+}
+
+double
+DEMTileCache
+::GetHeightAboveMSL(double lon, double lat) const
+{
+  const double lonLat[2] = {lon, lat};
+  double       height;
+  this->GetHeights(lonLat, &height, 1, false);
+  return height;
+}
+
+double
+DEMTileCache
+::GetHeightAboveEllipsoid(double lon, double lat) const
+{
+  const double lonLat[2] = {lon, lat};
+  double       height;
+  this->GetHeights(lonLat, &height, 1, true);
+  return height;
+}
+
+void
+DEMTileCache
+::GetHeightsAboveMSL(const double* lonLat, double* heights, unsigned long nbPoints) const
+{
+  this->GetHeights(lonLat, heights, nbPoints, false);
+}
+
+void
+DEMTileCache
+::GetHeightsAboveEllipsoid(const double* lonLat, double* heights, unsigned long nbPoints) const
+{
+  this->GetHeights(lonLat, heights, nbPoints, true);
+}
+
+void
+DEMTileCache
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "MaximumMemory: " << m_MaximumMemory << std::endl;
+  os << indent << "TilesPerDegree: " << m_TilesPerDegree << std::endl;
+  os << indent << "PostsPerDegree: " << m_PostsPerDegree << std::endl;
+  os << indent << "MemoryUsage: " << this->GetMemoryUsage() << std::endl;
+}
+
+} // namespace otb
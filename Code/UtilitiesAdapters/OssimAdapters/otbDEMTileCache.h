@@ -0,0 +1,194 @@
+/*=========================================================================
+
+  Program:   ORFEO Toolbox
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+
+  Copyright (c) Centre National d'Etudes Spatiales. All rights reserved.
+  See OTBCopyright.txt for details.
+
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#ifndef __otbDEMTileCache_h
+#define __otbDEMTileCache_h
+
+#include <vector>
+#include <list>
+#include <map>
+#include <utility>
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "itkSimpleFastMutexLock.h"
+
+namespace otb
+{
+/** \class DEMTileCache
+ *
+ * \brief Process-wide cache of decoded DEM tiles, safe for concurrent queries.
+ *
+ * The world is cut into square tiles of 1/TilesPerDegree degrees. When a
+ * tile is first needed, the heights above MSL of its posts (PostsPerDegree
+ * posts per degree, tile borders included) are decoded once from
+ * ossimElevManager, together with the geoid offsets on a 15 minutes grid.
+ * Heights are then bilinearly interpolated from the decoded posts, and the
+ * height above ellipsoid is the sum of the interpolated height above MSL
+ * and geoid offset. The results are thus approximations: with the default
+ * post spacing of 3 arc-seconds, the posts match the ones of SRTM and DTED
+ * level 1 cells, and heights above MSL are those of ossimElevManager, but
+ * finer cells are resampled and the geoid is interpolated from its 15
+ * minutes grid.
+ *
+ * Every point is served from its decoded tile, so that a height does not
+ * depend on the order of the queries. Where no DEM data is available, the
+ * height above ellipsoid is the one of ossimElevManager (default height
+ * above ellipsoid, or geoid), read under the decode lock.
+ *
+ * Decoded tiles are kept in memory following a least recently used policy,
+ * within the MaximumMemory budget. The cache is split into independent
+ * shards, each one protected by its own lock held only during the lookup and
+ * the interpolation, so that queries from several threads do not contend on
+ * a single lock. Access to ossim is serialized and only happens on cache miss.
+ *
+ * Since ossimElevManager is a singleton, so is this cache: use GetInstance().
+ * It must be flushed whenever the DEM directory, the geoid or the default
+ * height change, which DEMHandler takes care of.
+ *
+ * \sa DEMHandler
+ */
+class ITK_EXPORT DEMTileCache : public itk::Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef DEMTileCache                  Self;
+  typedef itk::Object                   Superclass;
+  typedef itk::SmartPointer<Self>       Pointer;
+  typedef itk::SmartPointer<const Self> ConstPointer;
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(DEMTileCache, Object);
+
+  /** Get the unique instance of the cache */
+  static Pointer GetInstance();
+
+  /** Set/Get the maximum memory used by decoded tiles, in bytes */
+  void SetMaximumMemory(unsigned long bytes);
+  itkGetMacro(MaximumMemory, unsigned long);
+
+  /** Set/Get the number of tiles per degree (along each axis). Flushes the cache. */
+  void SetTilesPerDegree(unsigned int tilesPerDegree);
+  itkGetMacro(TilesPerDegree, unsigned int);
+
+  /** Set/Get the number of posts per degree (along each axis). It is
+   *  rounded up to a multiple of TilesPerDegree. Flushes the cache. */
+  void SetPostsPerDegree(unsigned int postsPerDegree);
+  itkGetMacro(PostsPerDegree, unsigned int);
+
+  /** Remove all the decoded tiles */
+  void Flush();
+
+  /** Get the memory currently used by decoded tiles, in bytes */
+  unsigned long GetMemoryUsage() const;
+
+  /** Get the height above MSL of a point. NaN if no data is available. */
+  double GetHeightAboveMSL(double lon, double lat) const;
+
+  /** Get the height above ellipsoid of a point. Where no data is
+   *  available, falls back on ossimElevManager. */
+  double GetHeightAboveEllipsoid(double lon, double lat) const;
+
+  /** Get the heights above MSL (or above ellipsoid) of nbPoints points,
+   *  given as interleaved (lon, lat) pairs. Consecutive points falling in
+   *  the same tile are interpolated within a single lookup. */
+  void GetHeightsAboveMSL(const double* lonLat, double* heights, unsigned long nbPoints) const;
+  void GetHeightsAboveEllipsoid(const double* lonLat, double* heights, unsigned long nbPoints) const;
+
+protected:
+  /** This is protected for the singleton. Use GetInstance() instead. */
+  itkNewMacro(Self);
+  /** Constructor */
+  DEMTileCache();
+  /** Destructor */
+  virtual ~DEMTileCache() {}
+  /** PrintSelf method */
+  void PrintSelf(std::ostream& os, itk::Indent indent) const;
+
+private:
+  DEMTileCache(const Self&); //purposely not implemented
+  void operator =(const Self&); //purposely not implemented
+
+  /** Tile index (along longitude, along latitude) */
+  typedef std::pair<long, long> TileKeyType;
+
+  /** A decoded tile. Posts are stored row by row, from south to north. */
+  struct TileType
+  {
+    std::vector<float>  m_Heights;
+    std::vector<double> m_GeoidOffsets;
+  };
+
+  typedef std::list<TileKeyType>                                  LRUListType;
+  typedef std::pair<TileType, LRUListType::iterator>              TileEntryType;
+  typedef std::map<TileKeyType, TileEntryType>                    TileMapType;
+
+  /** An independent part of the cache */
+  struct ShardType
+  {
+    itk::SimpleFastMutexLock m_Lock;
+    TileMapType              m_Tiles;
+    LRUListType              m_LRU;
+    unsigned long            m_Memory;
+  };
+
+  itkStaticConstMacro(NumberOfShards, unsigned int, 16);
+
+  /** Compute the heights of nbPoints points */
+  void GetHeights(const double* lonLat, double* heights, unsigned long nbPoints, bool aboveEllipsoid) const;
+
+  /** Interpolate the height of a point in a decoded tile */
+  double InterpolateHeight(const TileType& tile, const TileKeyType& key,
+                           double lon, double lat, bool aboveEllipsoid) const;
+
+  /** Get the key of the tile containing a point */
+  TileKeyType GetTileKey(double lon, double lat) const;
+
+  /** Get the shard holding a tile */
+  unsigned int GetShardIndex(const TileKeyType& key) const;
+
+  /** Decode a tile from ossimElevManager (decode lock must be held) */
+  void DecodeTile(const TileKeyType& key, TileType& tile) const;
+
+  /** Insert a decoded tile in its shard (shard lock must be held) and
+   *  return it. Least recently used tiles are evicted if needed. */
+  const TileType& InsertTile(ShardType& shard, const TileKeyType& key, const TileType& tile) const;
+
+  /** Get the number of posts per tile side */
+  unsigned int GetNumberOfPostsPerTile() const;
+
+  /** Get the number of geoid posts per tile side */
+  unsigned int GetNumberOfGeoidPostsPerTile() const;
+
+  /** The instance singleton */
+  static Pointer Instance;
+
+  unsigned long m_MaximumMemory;
+  unsigned int  m_TilesPerDegree;
+  unsigned int  m_PostsPerDegree;
+
+  /** Cache shards. Mutable since queries are const. */
+  mutable ShardType m_Shards[NumberOfShards];
+
+  /** Serializes the accesses to ossim on cache misses. Lock order is
+   *  decode lock first, then shard lock. */
+  mutable itk::SimpleFastMutexLock m_DecodeLock;
+};
+
+} // namespace otb
+
+#endif
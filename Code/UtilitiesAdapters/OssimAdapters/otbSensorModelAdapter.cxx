@@ -19,6 +19,7 @@
 #include "otbSensorModelAdapter.h"
 
 #include <cassert>
+#include <vector>
 
 #include "otbMacro.h"
 #include "otbImageKeywordlist.h"
@@ -181,6 +182,126 @@ void SensorModelAdapter::InverseTransformPoint(double lon, double lat, double h,
   z = ossimGPoint.height();
 }
 
+void SensorModelAdapter::ForwardTransformPoints(const double* xyz, double* lonLatH, size_t nbPoints) const
+{
+  if (this->m_SensorModel == NULL)
+    {
+    itkExceptionMacro(<< "ForwardTransformPoints(): Invalid Model pointer m_SensorModel == NULL !");
+    }
+
+  if (nbPoints == 0)
+    {
+    return;
+    }
+
+  ossimDpt ossimPoint;
+  ossimGpt ossimGPoint;
+
+  if (this->m_UseDEM)
+    {
+    // First localisation without elevation
+    std::vector<double> lonLat(2 * nbPoints);
+    for (size_t i = 0; i < nbPoints; ++i)
+      {
+      ossimPoint.x = xyz[3 * i];
+      ossimPoint.y = xyz[3 * i + 1];
+      this->m_SensorModel->lineSampleToWorld(ossimPoint, ossimGPoint);
+      lonLat[2 * i] = ossimGPoint.lon;
+      lonLat[2 * i + 1] = ossimGPoint.lat;
+      lonLatH[3 * i] = ossimGPoint.lon;
+      lonLatH[3 * i + 1] = ossimGPoint.lat;
+      lonLatH[3 * i + 2] = ossimGPoint.hgt;
+      }
+
+    // As in ForwardTransformPoint(), the DEM is sampled at the first
+    // localisation, so that further iterations would not change the result
+    if (m_NbIter > 0)
+      {
+      std::vector<double> heights(nbPoints);
+      this->m_DEMHandler->GetHeightsAboveMSL(&lonLat[0], &heights[0], nbPoints);
+
+      for (size_t i = 0; i < nbPoints; ++i)
+        {
+        ossimPoint.x = xyz[3 * i];
+        ossimPoint.y = xyz[3 * i + 1];
+        this->m_SensorModel->lineSampleHeightToWorld(ossimPoint, heights[i], ossimGPoint);
+        lonLatH[3 * i] = ossimGPoint.lon;
+        lonLatH[3 * i + 1] = ossimGPoint.lat;
+        lonLatH[3 * i + 2] = ossimGPoint.hgt;
+        }
+      }
+    return;
+    }
+
+  for (size_t i = 0; i < nbPoints; ++i)
+    {
+    ossimPoint.x = xyz[3 * i];
+    ossimPoint.y = xyz[3 * i + 1];
+    const double z = xyz[3 * i + 2];
+
+    if (z != -32768)
+      {
+      this->m_SensorModel->lineSampleHeightToWorld(ossimPoint, z, ossimGPoint);
+      }
+    else
+      {
+      this->m_SensorModel->lineSampleToWorld(ossimPoint, ossimGPoint);
+      }
+
+    lonLatH[3 * i] = ossimGPoint.lon;
+    lonLatH[3 * i + 1] = ossimGPoint.lat;
+    lonLatH[3 * i + 2] = ossimGPoint.hgt;
+    }
+}
+
+void SensorModelAdapter::InverseTransformPoints(const double* lonLatH, double* xyz, size_t nbPoints) const
+{
+  if (this->m_SensorModel == NULL)
+    {
+    itkExceptionMacro(<< "InverseTransformPoints(): Invalid Model pointer m_SensorModel == NULL !");
+    }
+
+  if (nbPoints == 0)
+    {
+    return;
+    }
+
+  // In case a DEM is used, query the elevation of all the points at once
+  std::vector<double> heights;
+  if (this->m_UseDEM)
+    {
+    std::vector<double> lonLat(2 * nbPoints);
+    for (size_t i = 0; i < nbPoints; ++i)
+      {
+      lonLat[2 * i] = lonLatH[3 * i];
+      lonLat[2 * i + 1] = lonLatH[3 * i + 1];
+      }
+    heights.resize(nbPoints);
+    this->m_DEMHandler->GetHeightsAboveMSL(&lonLat[0], &heights[0], nbPoints);
+    }
+
+  ossimGpt ossimGPoint;
+  ossimDpt ossimDPoint;
+
+  for (size_t i = 0; i < nbPoints; ++i)
+    {
+    ossimGPoint.lon = lonLatH[3 * i];
+    ossimGPoint.lat = lonLatH[3 * i + 1];
+    ossimGPoint.height(this->m_UseDEM ? heights[i] : lonLatH[3 * i + 2]);
+
+    // -32768 stands for unknown altitude and should never be passed to ossim
+    if (ossimGPoint.height() == -32768)
+      {
+      ossimGPoint.height(ossim::nan());
+      }
+
+    this->m_SensorModel->worldToLineSample(ossimGPoint, ossimDPoint);
+    xyz[3 * i] = ossimDPoint.x;
+    xyz[3 * i + 1] = ossimDPoint.y;
+    xyz[3 * i + 2] = ossimGPoint.height();
+    }
+}
+
 ossimProjection* SensorModelAdapter::GetOssimModel() //FIXME temporary only
 {
   return m_SensorModel;
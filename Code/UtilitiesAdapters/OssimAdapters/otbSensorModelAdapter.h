@@ -18,6 +18,8 @@
 #ifndef __otbSensorModelAdapter_h
 #define __otbSensorModelAdapter_h
 
+#include <cstddef>
+
 #include "itkObject.h"
 #include "itkObjectFactory.h"
 #include "otbDEMHandler.h"
@@ -73,6 +75,17 @@ public:
   void InverseTransformPoint(double lon, double lat, double h,
                              double& x, double& y, double& z) const;
 
+  /** Batch version of ForwardTransformPoint(): xyz holds nbPoints
+   *  interleaved (x, y, z) triplets, lonLatH receives the interleaved
+   *  (lon, lat, h) triplets. When a DEM is used, the heights of all the
+   *  points are queried in a single call to the DEM handler. */
+  void ForwardTransformPoints(const double* xyz, double* lonLatH, size_t nbPoints) const;
+
+  /** Batch version of InverseTransformPoint(): lonLatH holds nbPoints
+   *  interleaved (lon, lat, h) triplets, xyz receives the interleaved
+   *  (x, y, z) triplets. */
+  void InverseTransformPoints(const double* lonLatH, double* xyz, size_t nbPoints) const;
+
   ossimProjection* GetOssimModel(); // FIXME temporary only
 
   /** Is sensor model valid method. return false if the m_SensorModel is null*/
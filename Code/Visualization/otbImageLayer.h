@@ -33,12 +33,25 @@
 
 #include "otbGroundSpacingImageFunction.h"
 
+#include <list>
+#include <map>
+
 namespace otb
 {
 /** \class ImageLayer
 *   \brief This class is a layer container.
 *   It contains everything related to a layer in the viewer model.
 *
+*   The extract and the scaled extract are composed from a cache of
+*   rendered tiles of TileSize x TileSize pixels, kept until the
+*   rendering function or the sources of the image (the process objects
+*   upstream, like the file name of a reader) are modified. Panning or
+*   zooming only reads and renders the tiles that are not cached yet,
+*   one request to the image pipeline per tile. The least recently used tiles
+*   are dropped beyond MaximumNumberOfCachedTiles. The quicklook remains
+*   the overview of the image and is rendered only when the rendering
+*   function is modified.
+*
 *   \sa ImageViewerModel
 *   \sa Layer
 *  \ingroup Visualization
@@ -79,6 +92,7 @@ public:
   typedef typename GroundSpacingImageType::FloatType FloatType;
   /** Output image typedef */
   typedef TOutputImage                        OutputImageType;
+  typedef typename OutputImageType::Pointer   OutputImagePointerType;
   typedef typename OutputImageType::PixelType OutputPixelType;
 
   /** Histogram typedef */
@@ -112,7 +126,7 @@ public:
       {
       this->m_Image = img;
       this->m_ExtractFilter->SetInput(m_Image);
-      this->m_ScaledExtractFilter->SetInput(m_Image);
+      this->ClearTileCache();
       }
   }
   itkGetObjectMacro(Image, ImageType);
@@ -143,38 +157,23 @@ public:
     m_RenderingFunction->SetListSample(this->GetListSample());
     m_QuicklookRenderingFilter->SetRenderingFunction(m_RenderingFunction);
     m_ExtractRenderingFilter->SetRenderingFunction(m_RenderingFunction);
-    m_ScaledExtractRenderingFilter->SetRenderingFunction(m_RenderingFunction);
+    this->ClearTileCache();
   }
   itkGetObjectMacro(RenderingFunction, RenderingFunctionType);
 
-  /** Reimplemented to pass the parameter to the extract filter */
-  virtual void SetExtractRegion(const RegionType& region)
-  {
-    // This check should be done in the itk::ExtractImageFilter
-    if (this->GetExtractRegion() != region)
-      {
-      Superclass::SetExtractRegion(region);
-      // SetExtractionRegion throws an exception in case of empty region
-      if (region.GetNumberOfPixels() > 0)
-        {
-        m_ExtractFilter->SetExtractionRegion(region);
-        }
-      }
-  }
+  /** Set/Get the size of the rendered tiles */
+  itkSetMacro(TileSize, unsigned int);
+  itkGetMacro(TileSize, unsigned int);
 
-  /** Reimplemented to pass the parameter to the extract filter */
-  virtual void SetScaledExtractRegion(const RegionType& region)
+  /** Set/Get the maximum number of rendered tiles kept in the cache */
+  itkSetMacro(MaximumNumberOfCachedTiles, unsigned int);
+  itkGetMacro(MaximumNumberOfCachedTiles, unsigned int);
+
+  /** Drop the rendered tiles */
+  void ClearTileCache()
   {
-    // This check should be done in the itk::ExtractImageFilter
-    if (this->GetScaledExtractRegion() != region)
-      {
-      Superclass::SetScaledExtractRegion(region);
-      // SetExtractionRegion throws an exception in case of empty region
-      if (region.GetNumberOfPixels() > 0)
-        {
-        m_ScaledExtractFilter->SetExtractionRegion(region);
-        }
-      }
+    m_TileCache.clear();
+    m_TileCacheOrder.clear();
   }
 
   /** Actually render the image */
@@ -217,6 +216,19 @@ protected:
   /** Update the images */
   virtual void RenderImages();
 
+  /** Render a region of the image from the tile cache */
+  virtual OutputImagePointerType RenderRegion(const RegionType& region);
+
+  /** Region of the tile of the given position (in tiles) */
+  RegionType GetTileRegion(const IndexType& tile) const;
+
+  /** Latest modification time of the sources of a data object, ignoring
+   * the regeneration of the data by the pipeline */
+  static unsigned long GetSourcesMTime(const itk::DataObject * data);
+
+  /** Buffer the tile of the image containing the index, if it is in the extract */
+  void BufferImageTile(const IndexType& index);
+
   virtual void InitTransform();
 
   virtual void ComputeApproximativeGroundSpacing();
@@ -246,11 +258,37 @@ private:
   /** Rendering filters */
   RenderingFilterPointerType m_QuicklookRenderingFilter;
   RenderingFilterPointerType m_ExtractRenderingFilter;
-  RenderingFilterPointerType m_ScaledExtractRenderingFilter;
 
-  /** Extract filters */
+  /** Extract filter */
   ExtractFilterPointerType m_ExtractFilter;
-  ExtractFilterPointerType m_ScaledExtractFilter;
+
+  /** Rendered tiles, by position in tiles, and from the most to the
+   * least recently used */
+  struct TileKeyType
+  {
+    IndexValueType x;
+    IndexValueType y;
+    bool operator <(const TileKeyType& other) const
+    {
+      return y < other.y || (y == other.y && x < other.x);
+    }
+  };
+  typedef std::list<TileKeyType> TileKeyListType;
+  struct CachedTileType
+  {
+    OutputImagePointerType             tile;
+    typename TileKeyListType::iterator position;
+  };
+  typedef std::map<TileKeyType, CachedTileType> TileCacheType;
+
+  TileCacheType   m_TileCache;
+  TileKeyListType m_TileCacheOrder;
+  unsigned int    m_TileSize;
+  unsigned int    m_MaximumNumberOfCachedTiles;
+
+  /** Modification time of the rendering function and of the image
+   * sources when the cached tiles were rendered */
+  unsigned long m_TileCacheTime;
 
   /** Coordinate transform */
   TransformType::Pointer    m_Transform;
@@ -19,6 +19,7 @@
 #define __otbImageLayer_txx
 
 #include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
 #include "otbMacro.h"
 #include "otbI18n.h"
 #include "itkTimeProbe.h"
@@ -36,13 +37,12 @@ namespace otb
 template <class TImage, class TOutputImage>
 ImageLayer<TImage, TOutputImage>
 ::ImageLayer() : m_Quicklook(), m_Image(), m_ListSample(), m_ListSampleProvided(false), m_RenderingFunction(),
-  m_QuicklookRenderingFilter(), m_ExtractRenderingFilter(), m_ScaledExtractRenderingFilter(),
-  m_ExtractFilter(), m_ScaledExtractFilter()
+  m_QuicklookRenderingFilter(), m_ExtractRenderingFilter(), m_ExtractFilter(),
+  m_TileCache(), m_TileCacheOrder(), m_TileSize(256), m_MaximumNumberOfCachedTiles(128), m_TileCacheTime(0)
 {
   // Rendering filters
   m_QuicklookRenderingFilter = RenderingFilterType::New();
   m_ExtractRenderingFilter = RenderingFilterType::New();
-  m_ScaledExtractRenderingFilter = RenderingFilterType::New();
 
   m_ListSample = ListSampleType::New();
 
@@ -52,15 +52,12 @@ ImageLayer<TImage, TOutputImage>
   m_RenderingFunction = DefaultRenderingFunctionType::New();
   m_QuicklookRenderingFilter->SetRenderingFunction(m_RenderingFunction);
   m_ExtractRenderingFilter->SetRenderingFunction(m_RenderingFunction);
-  m_ScaledExtractRenderingFilter->SetRenderingFunction(m_RenderingFunction);
 
-  // Extract filters
+  // Extract filter
   m_ExtractFilter = ExtractFilterType::New();
-  m_ScaledExtractFilter = ExtractFilterType::New();
 
   // Wiring
   m_ExtractRenderingFilter->SetInput(m_ExtractFilter->GetOutput());
-  m_ScaledExtractRenderingFilter->SetInput(m_ScaledExtractFilter->GetOutput());
 
   m_Transform = TransformType::New();
   m_CoordinateToName = CoordinateToName::New();
@@ -83,6 +80,8 @@ ImageLayer<TImage, TOutputImage>
 ::PrintSelf(std::ostream& os, itk::Indent indent) const
 {
   Superclass::PrintSelf(os, indent);
+  os << indent << "Tile size: " << m_TileSize << std::endl;
+  os << indent << "Cached tiles: " << m_TileCache.size() << " / " << m_MaximumNumberOfCachedTiles << std::endl;
 }
 
 template <class TImage, class TOutputImage>
@@ -136,16 +135,7 @@ ImageLayer<TImage, TOutputImage>
     {
     itk::TimeProbe probe;
     probe.Start();
-
-    // Impacting modified on the the rendering function
-    if (m_RenderingFunction->GetMTime() > m_ExtractRenderingFilter->GetOutput()->GetUpdateMTime())
-      {
-      m_ExtractRenderingFilter->Modified();
-      }
-
-    m_ExtractRenderingFilter->GetOutput()->SetRequestedRegion(this->GetExtractRegion());
-    m_ExtractRenderingFilter->Update();
-    this->SetRenderedExtract(m_ExtractRenderingFilter->GetOutput());
+    this->SetRenderedExtract(this->RenderRegion(this->GetExtractRegion()));
     probe.Stop();
     otbMsgDevMacro(<< "ImageLayer::RenderImages():" << " (" << this->GetName() << ")"
                    << " extract regenerated (" << probe.GetMeanTime() << " s.)");
@@ -161,15 +151,7 @@ ImageLayer<TImage, TOutputImage>
     {
     itk::TimeProbe probe;
     probe.Start();
-    // Impacting modified on the the rendering function
-    if (m_RenderingFunction->GetMTime() > m_ScaledExtractRenderingFilter->GetOutput()->GetUpdateMTime())
-      {
-      m_ScaledExtractRenderingFilter->Modified();
-      }
-
-    m_ScaledExtractRenderingFilter->GetOutput()->SetRequestedRegion(this->GetScaledExtractRegion());
-    m_ScaledExtractRenderingFilter->Update();
-    this->SetRenderedScaledExtract(m_ScaledExtractRenderingFilter->GetOutput());
+    this->SetRenderedScaledExtract(this->RenderRegion(this->GetScaledExtractRegion()));
     this->SetHasScaledExtract(true);
     probe.Stop();
     otbMsgDevMacro(<< "ImageLayer::RenderImages():" << " (" << this->GetName() << ")"
@@ -181,6 +163,181 @@ ImageLayer<TImage, TOutputImage>
     }
 }
 
+template <class TImage, class TOutputImage>
+typename ImageLayer<TImage, TOutputImage>::RegionType
+ImageLayer<TImage, TOutputImage>
+::GetTileRegion(const IndexType& tile) const
+{
+  const RegionType& largestRegion = m_Image->GetLargestPossibleRegion();
+
+  RegionType region;
+  for (unsigned int dim = 0; dim < 2; ++dim)
+    {
+    region.SetIndex(dim, largestRegion.GetIndex()[dim] + tile[dim] * static_cast<IndexValueType>(m_TileSize));
+    region.SetSize(dim, m_TileSize);
+    }
+  region.Crop(largestRegion);
+  return region;
+}
+
+template <class TImage, class TOutputImage>
+typename ImageLayer<TImage, TOutputImage>::OutputImagePointerType
+ImageLayer<TImage, TOutputImage>
+::RenderRegion(const RegionType& region)
+{
+  // Tiles rendered before a modification of the rendering function or
+  // of the image sources are obsolete
+  const unsigned long renderingTime = std::max(m_RenderingFunction->GetMTime(), GetSourcesMTime(m_Image));
+  if (renderingTime != m_TileCacheTime)
+    {
+    this->ClearTileCache();
+    m_TileCacheTime = renderingTime;
+    }
+
+  // Tiles covering the region
+  const IndexType& origin = m_Image->GetLargestPossibleRegion().GetIndex();
+  IndexType        firstTile, lastTile;
+  for (unsigned int dim = 0; dim < 2; ++dim)
+    {
+    firstTile[dim] = (region.GetIndex()[dim] - origin[dim]) / m_TileSize;
+    lastTile[dim] = (region.GetIndex()[dim] + static_cast<IndexValueType>(region.GetSize()[dim]) - 1 - origin[dim])
+                    / m_TileSize;
+    }
+
+  // Render the missing tiles, each one on its own so that only their
+  // pixels are read
+  IndexType    tile;
+  unsigned int nbRenderedTiles = 0;
+  for (tile[1] = firstTile[1]; tile[1] <= lastTile[1]; ++tile[1])
+    {
+    for (tile[0] = firstTile[0]; tile[0] <= lastTile[0]; ++tile[0])
+      {
+      TileKeyType key;
+      key.x = tile[0];
+      key.y = tile[1];
+      if (m_TileCache.find(key) != m_TileCache.end())
+        {
+        continue;
+        }
+
+      const RegionType tileRegion = this->GetTileRegion(tile);
+
+      // Impacting modified on the the rendering function
+      if (m_RenderingFunction->GetMTime() > m_ExtractRenderingFilter->GetOutput()->GetUpdateMTime())
+        {
+        m_ExtractRenderingFilter->Modified();
+        }
+
+      m_ExtractFilter->SetExtractionRegion(tileRegion);
+      m_ExtractRenderingFilter->GetOutput()->SetRequestedRegion(tileRegion);
+      m_ExtractRenderingFilter->Update();
+
+      OutputImagePointerType renderedTile = OutputImageType::New();
+      renderedTile->SetRegions(tileRegion);
+      renderedTile->Allocate();
+
+      itk::ImageRegionConstIterator<OutputImageType> inIt(m_ExtractRenderingFilter->GetOutput(), tileRegion);
+      itk::ImageRegionIterator<OutputImageType>      outIt(renderedTile, tileRegion);
+      for (inIt.GoToBegin(), outIt.GoToBegin(); !outIt.IsAtEnd(); ++inIt, ++outIt)
+        {
+        outIt.Set(inIt.Get());
+        }
+
+      m_TileCacheOrder.push_front(key);
+      CachedTileType& cachedTile = m_TileCache[key];
+      cachedTile.tile = renderedTile;
+      cachedTile.position = m_TileCacheOrder.begin();
+      ++nbRenderedTiles;
+      }
+    }
+  if (nbRenderedTiles > 0)
+    {
+    otbMsgDevMacro(<< "ImageLayer::RenderRegion():" << " (" << this->GetName() << ") "
+                   << nbRenderedTiles << " tiles rendered");
+    }
+
+  // Compose the region from the tiles
+  OutputImagePointerType output = OutputImageType::New();
+  output->CopyInformation(m_Image);
+  output->SetRegions(region);
+  output->Allocate();
+
+  for (tile[1] = firstTile[1]; tile[1] <= lastTile[1]; ++tile[1])
+    {
+    for (tile[0] = firstTile[0]; tile[0] <= lastTile[0]; ++tile[0])
+      {
+      TileKeyType key;
+      key.x = tile[0];
+      key.y = tile[1];
+      CachedTileType& cachedTile = m_TileCache[key];
+
+      // Most recently used
+      m_TileCacheOrder.splice(m_TileCacheOrder.begin(), m_TileCacheOrder, cachedTile.position);
+
+      RegionType copyRegion = cachedTile.tile->GetBufferedRegion();
+      copyRegion.Crop(region);
+
+      itk::ImageRegionConstIterator<OutputImageType> inIt(cachedTile.tile, copyRegion);
+      itk::ImageRegionIterator<OutputImageType>      outIt(output, copyRegion);
+      for (inIt.GoToBegin(), outIt.GoToBegin(); !outIt.IsAtEnd(); ++inIt, ++outIt)
+        {
+        outIt.Set(inIt.Get());
+        }
+      }
+    }
+
+  // Drop the least recently used tiles
+  while (m_TileCache.size() > m_MaximumNumberOfCachedTiles)
+    {
+    m_TileCache.erase(m_TileCacheOrder.back());
+    m_TileCacheOrder.pop_back();
+    }
+
+  return output;
+}
+
+template <class TImage, class TOutputImage>
+unsigned long
+ImageLayer<TImage, TOutputImage>
+::GetSourcesMTime(const itk::DataObject * data)
+{
+  // The data produced by a pipeline is modified by each update: only the
+  // process objects and the data without source tell a modification
+  itk::ProcessObject * source = data->GetSource().GetPointer();
+  if (source == NULL)
+    {
+    return data->GetMTime();
+    }
+
+  unsigned long time = source->GetMTime();
+  for (unsigned int i = 0; i < source->GetInputs().size(); ++i)
+    {
+    if (source->GetInputs()[i].IsNotNull())
+      {
+      time = std::max(time, GetSourcesMTime(source->GetInputs()[i]));
+      }
+    }
+  return time;
+}
+
+template <class TImage, class TOutputImage>
+void
+ImageLayer<TImage, TOutputImage>
+::BufferImageTile(const IndexType& index)
+{
+  // The rendered tiles do not keep the image pixels
+  if (this->GetExtractRegion().IsInside(index) && !m_Image->GetBufferedRegion().IsInside(index))
+    {
+    IndexType tile;
+    for (unsigned int dim = 0; dim < 2; ++dim)
+      {
+      tile[dim] = (index[dim] - m_Image->GetLargestPossibleRegion().GetIndex()[dim]) / m_TileSize;
+      }
+    m_Image->SetRequestedRegion(this->GetTileRegion(tile));
+    m_Image->Update();
+    }
+}
+
 template <class TImage, class TOutputImage>
 void
 ImageLayer<TImage, TOutputImage>
@@ -256,6 +413,8 @@ ImageLayer<TImage, TOutputImage>
 
   // Ensure rendering function intialization
   m_RenderingFunction->Initialize(m_Image->GetMetaDataDictionary()); //FIXME check, but the call must be done in the generator. To be moved to the layer?
+  this->BufferImageTile(index);
+
   // The ouptut stringstream
   std::ostringstream oss;
   oss << otbGetTextMacro("Layer") << ": " << this->GetName();
@@ -381,6 +540,8 @@ ImageLayer<TImage, TOutputImage>
   PixelType pixel;
   itk::PixelBuilder<PixelType>::Zero(pixel, (m_Image->GetNumberOfComponentsPerPixel()));
 
+  this->BufferImageTile(index);
+
   // Ensure rendering function initialization
   m_RenderingFunction->Initialize(m_Image->GetMetaDataDictionary()); //FIXME check, but the call must be done in the generator. To be moved to the layer?
 
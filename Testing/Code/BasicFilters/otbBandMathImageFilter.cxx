@@ -20,6 +20,8 @@
 #include "itkExceptionObject.h"
 #include <iostream>
 #include <complex>  //only for the isnan() test line 148
+#include <vector>
+#include <string>
 
 #include "otbMath.h"
 #include "otbImage.h"
@@ -270,3 +272,110 @@ int otbBandMathImageFilterWithIdx( int argc, char* argv[])
 
   return EXIT_SUCCESS;
 }
+
+int otbBandMathImageFilterScanline( int argc, char* argv[])
+{
+  typedef short                                             PixelType;
+  typedef otb::Image<PixelType, 2>                          ImageType;
+  typedef otb::BandMathImageFilter<ImageType>               FilterType;
+  typedef itk::ImageRegionIteratorWithIndex<ImageType>      IteratorType;
+
+  const unsigned int N = 100;
+
+  ImageType::SizeType size;
+  size.Fill(N);
+  ImageType::IndexType index;
+  index.Fill(0);
+  ImageType::RegionType region;
+  region.SetSize(size);
+  region.SetIndex(index);
+
+  ImageType::SpacingType spacing;
+  spacing[0] = 0.5;
+  spacing[1] = -2.;
+  ImageType::PointType origin;
+  origin[0] = 10.;
+  origin[1] = 300.;
+
+  ImageType::Pointer image1 = ImageType::New();
+  ImageType::Pointer image2 = ImageType::New();
+  ImageType::Pointer image3 = ImageType::New();
+
+  image1->SetRegions(region);
+  image1->SetSpacing(spacing);
+  image1->SetOrigin(origin);
+  image1->Allocate();
+  image2->SetRegions(region);
+  image2->SetSpacing(spacing);
+  image2->SetOrigin(origin);
+  image2->Allocate();
+  image3->SetRegions(region);
+  image3->SetSpacing(spacing);
+  image3->SetOrigin(origin);
+  image3->Allocate();
+
+  IteratorType it1(image1, region);
+  IteratorType it2(image2, region);
+  IteratorType it3(image3, region);
+
+  for (it1.GoToBegin(), it2.GoToBegin(), it3.GoToBegin(); !it1.IsAtEnd(); ++it1, ++it2, ++it3)
+    {
+    ImageType::IndexType idx = it1.GetIndex();
+    it1.Set( idx[0] + idx[1] - 50 );
+    it2.Set( idx[0] * idx[1] );
+    it3.Set( idx[0] - 3 * idx[1] );
+    }
+
+  // Expressions covering operators, built-in and user defined functions,
+  // functions with a variable number of arguments, index variables,
+  // overflows and underflows
+  std::vector<std::string> expressions;
+  expressions.push_back("cos(2 * pi * b1)/(2 * pi * b2 + 1E-3)*sin(pi * canal3) + ndvi(b1, b2) * sqrt(2) * canal3");
+  expressions.push_back("if((b1 > 0) and (canal3 <= 10), min(b1, b2, canal3), max(b1, b2) ^ 2)");
+  expressions.push_back("-b2 * 100 + avg(b1, canal3) - (b1 == b2) + (b1 != canal3) * 7");
+  expressions.push_back("idxX * 1000 - idxY + idxPhyX * idxPhyY");
+  expressions.push_back("42");
+
+  bool pass = true;
+
+  for (unsigned int e = 0; e < expressions.size(); ++e)
+    {
+    FilterType::Pointer scanlineFilter = FilterType::New();
+    scanlineFilter->SetNthInput(0, image1);
+    scanlineFilter->SetNthInput(1, image2);
+    scanlineFilter->SetNthInput(2, image3, "canal3");
+    scanlineFilter->SetExpression(expressions[e]);
+    scanlineFilter->UseScanlineEvaluationOn();
+    scanlineFilter->Update();
+
+    FilterType::Pointer pixelFilter = FilterType::New();
+    pixelFilter->SetNthInput(0, image1);
+    pixelFilter->SetNthInput(1, image2);
+    pixelFilter->SetNthInput(2, image3, "canal3");
+    pixelFilter->SetExpression(expressions[e]);
+    pixelFilter->UseScanlineEvaluationOff();
+    pixelFilter->Update();
+
+    IteratorType itScanline(scanlineFilter->GetOutput(), region);
+    IteratorType itPixel(pixelFilter->GetOutput(), region);
+
+    for (itScanline.GoToBegin(), itPixel.GoToBegin(); !itScanline.IsAtEnd(); ++itScanline, ++itPixel)
+      {
+      if (itScanline.Get() != itPixel.Get())
+        {
+        std::cerr << "Expression " << expressions[e] << " at " << itScanline.GetIndex()
+                  << ": scanline evaluation gives " << itScanline.Get()
+                  << ", pixel evaluation gives " << itPixel.Get() << std::endl;
+        pass = false;
+        break;
+        }
+      }
+    }
+
+  if (!pass)
+    {
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
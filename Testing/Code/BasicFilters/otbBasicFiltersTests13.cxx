@@ -27,6 +27,9 @@ void RegisterTests()
   REGISTER_TEST(otbBandMathImageFilterNew);
   REGISTER_TEST(otbBandMathImageFilter);
   REGISTER_TEST(otbBandMathImageFilterWithIdx);
+  REGISTER_TEST(otbBandMathImageFilterScanline);
+  REGISTER_TEST(otbMultiExpressionBandMathImageFilterNew);
+  REGISTER_TEST(otbMultiExpressionBandMathImageFilter);
   REGISTER_TEST(otbComplexToIntensityFilterTest);
   REGISTER_TEST(otbRealAndImaginaryImageToComplexImageFilterTest);
   REGISTER_TEST(otbRealImageToComplexImageFilterTest);
@@ -28,6 +28,7 @@ void RegisterTests()
   REGISTER_TEST(otbContinuousMinimumMaximumImageCalculatorTest);
   REGISTER_TEST(otbMeanShiftImageFilterNew);
   REGISTER_TEST(otbMeanShiftImageFilter);
+  REGISTER_TEST(otbMeanShiftImageFilterNativeEngine);
   REGISTER_TEST(otbMeanShiftVectorImageFilterNew);
   REGISTER_TEST(otbMeanShiftVectorImageFilter);
   REGISTER_TEST(otbFunctionToImageFilterNew);
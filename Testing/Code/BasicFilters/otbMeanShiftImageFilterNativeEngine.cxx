@@ -0,0 +1,142 @@
+/*=========================================================================
+
+  Program:   ORFEO Toolbox
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+
+  Copyright (c) Centre National d'Etudes Spatiales. All rights reserved.
+  See OTBCopyright.txt for details.
+
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#include "otbImage.h"
+#include "otbImageFileReader.h"
+#include "otbMeanShiftImageFilter.h"
+#include "itkStreamingImageFilter.h"
+#include "itkChangeLabelImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+
+template <class TImage>
+unsigned long CountDifferences(const TImage * image1, const TImage * image2)
+{
+  itk::ImageRegionConstIterator<TImage> it1(image1, image1->GetLargestPossibleRegion());
+  itk::ImageRegionConstIterator<TImage> it2(image2, image2->GetLargestPossibleRegion());
+
+  unsigned long nbDifferences = 0;
+  for (it1.GoToBegin(), it2.GoToBegin(); !it1.IsAtEnd() && !it2.IsAtEnd(); ++it1, ++it2)
+    {
+    if (it1.Get() != it2.Get())
+      {
+      ++nbDifferences;
+      }
+    }
+  return nbDifferences;
+}
+
+int otbMeanShiftImageFilterNativeEngine(int argc, char * argv[])
+{
+  if (argc != 6)
+    {
+    std::cerr << "Usage: " << argv[0] << " infname spatialRadius rangeRadius minregionsize scale" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const char *       infname       = argv[1];
+  const unsigned int spatialRadius = atoi(argv[2]);
+  const double       rangeRadius   = atof(argv[3]);
+  const unsigned int minRegionSize = atoi(argv[4]);
+  const double       scale         = atof(argv[5]);
+
+  const unsigned int Dimension = 2;
+  typedef float                                           PixelType;
+  typedef otb::Image<PixelType, Dimension>                ImageType;
+  typedef otb::ImageFileReader<ImageType>                 ReaderType;
+  typedef otb::MeanShiftImageFilter<ImageType, ImageType> FilterType;
+  typedef FilterType::LabeledOutputType                   LabeledImageType;
+  typedef itk::StreamingImageFilter<ImageType, ImageType> StreamingFilterType;
+  typedef itk::StreamingImageFilter<LabeledImageType, LabeledImageType> LabeledStreamingFilterType;
+  typedef itk::ChangeLabelImageFilter<LabeledImageType, LabeledImageType> ChangeLabelFilterType;
+
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(infname);
+  reader->Update();
+
+  // Reference: one thread, no streaming
+  FilterType::Pointer filters[2];
+  const int           nbThreads[2] = {1, 4};
+
+  for (unsigned int i = 0; i < 2; ++i)
+    {
+    filters[i] = FilterType::New();
+    filters[i]->SetInput(reader->GetOutput());
+    filters[i]->SetSpatialRadius(spatialRadius);
+    filters[i]->SetRangeRadius(rangeRadius);
+    filters[i]->SetMinimumRegionSize(minRegionSize);
+    filters[i]->SetScale(scale);
+    filters[i]->UseEdisonOff();
+    filters[i]->SetNumberOfThreads(nbThreads[i]);
+    filters[i]->Update();
+    }
+
+  unsigned long nbDifferences = CountDifferences<ImageType>(filters[0]->GetOutput(), filters[1]->GetOutput());
+  std::cout << "Filtered output, 1 vs 4 threads: " << nbDifferences << " differences" << std::endl;
+
+  unsigned long nbClusterDifferences =
+    CountDifferences<ImageType>(filters[0]->GetClusteredOutput(), filters[1]->GetClusteredOutput())
+    + CountDifferences<LabeledImageType>(filters[0]->GetLabeledClusteredOutput(),
+                                         filters[1]->GetLabeledClusteredOutput())
+    + CountDifferences<LabeledImageType>(filters[0]->GetClusterBoundariesOutput(),
+                                         filters[1]->GetClusterBoundariesOutput());
+  std::cout << "Clustered outputs, 1 vs 4 threads: " << nbClusterDifferences << " differences" << std::endl;
+
+  // Streamed filtered output
+  FilterType::Pointer streamedFilter = FilterType::New();
+  streamedFilter->SetInput(reader->GetOutput());
+  streamedFilter->SetSpatialRadius(spatialRadius);
+  streamedFilter->SetRangeRadius(rangeRadius);
+  streamedFilter->SetMinimumRegionSize(minRegionSize);
+  streamedFilter->SetScale(scale);
+  streamedFilter->UseEdisonOff();
+
+  StreamingFilterType::Pointer streamer = StreamingFilterType::New();
+  streamer->SetInput(streamedFilter->GetOutput());
+  streamer->SetNumberOfStreamDivisions(5);
+  streamer->Update();
+
+  unsigned long nbStreamingDifferences = CountDifferences<ImageType>(filters[0]->GetOutput(), streamer->GetOutput());
+  std::cout << "Filtered output, streamed: " << nbStreamingDifferences << " differences" << std::endl;
+
+  // Streamed labeled output: provisional labels of the tiles, then stitched
+  streamedFilter->Reset();
+
+  LabeledStreamingFilterType::Pointer labeledStreamer = LabeledStreamingFilterType::New();
+  labeledStreamer->SetInput(streamedFilter->GetLabeledClusteredOutput());
+  labeledStreamer->SetNumberOfStreamDivisions(5);
+  labeledStreamer->Update();
+
+  streamedFilter->Synthetize();
+
+  ChangeLabelFilterType::Pointer relabel = ChangeLabelFilterType::New();
+  relabel->SetInput(labeledStreamer->GetOutput());
+  relabel->SetChangeMap(streamedFilter->GetStitchedLabels());
+  relabel->Update();
+
+  unsigned long nbStitchingDifferences =
+    CountDifferences<LabeledImageType>(filters[0]->GetLabeledClusteredOutput(), relabel->GetOutput());
+  std::cout << "Labeled output, streamed: " << nbStitchingDifferences << " differences, "
+            << streamedFilter->GetModes().size() << " modes instead of " << filters[0]->GetModes().size() << std::endl;
+
+  if (nbDifferences > 0 || nbClusterDifferences > 0 || nbStreamingDifferences > 0 || nbStitchingDifferences > 0
+      || streamedFilter->GetModes().size() != filters[0]->GetModes().size())
+    {
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
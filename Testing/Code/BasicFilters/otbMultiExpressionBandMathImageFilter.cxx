@@ -0,0 +1,142 @@
+/*=========================================================================
+
+  Program:   ORFEO Toolbox
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+
+  Copyright (c) Centre National d'Etudes Spatiales. All rights reserved.
+  See OTBCopyright.txt for details.
+
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+
+
+#include "itkExceptionObject.h"
+#include <iostream>
+#include <vector>
+#include <string>
+
+#include "otbImage.h"
+#include "otbVectorImage.h"
+#include "otbBandMathImageFilter.h"
+#include "otbMultiExpressionBandMathImageFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+int otbMultiExpressionBandMathImageFilterNew( int argc, char* argv[])
+{
+  typedef double                                                        PixelType;
+  typedef otb::Image<PixelType, 2>                                      ImageType;
+  typedef otb::VectorImage<PixelType, 2>                                VectorImageType;
+  typedef otb::MultiExpressionBandMathImageFilter<ImageType, VectorImageType> FilterType;
+
+  FilterType::Pointer         filter       = FilterType::New();
+
+  return EXIT_SUCCESS;
+}
+
+int otbMultiExpressionBandMathImageFilter( int argc, char* argv[])
+{
+  typedef short                                                         PixelType;
+  typedef otb::Image<PixelType, 2>                                      ImageType;
+  typedef otb::VectorImage<PixelType, 2>                                VectorImageType;
+  typedef otb::BandMathImageFilter<ImageType>                           BandMathFilterType;
+  typedef otb::MultiExpressionBandMathImageFilter<ImageType, VectorImageType> FilterType;
+  typedef itk::ImageRegionIteratorWithIndex<ImageType>                  IteratorType;
+  typedef itk::ImageRegionIteratorWithIndex<VectorImageType>            VectorIteratorType;
+
+  const unsigned int N = 100;
+
+  ImageType::SizeType size;
+  size.Fill(N);
+  ImageType::IndexType index;
+  index.Fill(0);
+  ImageType::RegionType region;
+  region.SetSize(size);
+  region.SetIndex(index);
+
+  ImageType::Pointer image1 = ImageType::New();
+  ImageType::Pointer image2 = ImageType::New();
+  ImageType::Pointer image3 = ImageType::New();
+
+  image1->SetRegions(region);
+  image1->Allocate();
+  image2->SetRegions(region);
+  image2->Allocate();
+  image3->SetRegions(region);
+  image3->Allocate();
+
+  IteratorType it1(image1, region);
+  IteratorType it2(image2, region);
+  IteratorType it3(image3, region);
+
+  for (it1.GoToBegin(), it2.GoToBegin(), it3.GoToBegin(); !it1.IsAtEnd(); ++it1, ++it2, ++it3)
+    {
+    ImageType::IndexType idx = it1.GetIndex();
+    it1.Set( idx[0] + idx[1] + 1 );
+    it2.Set( idx[0] * idx[1] );
+    it3.Set( idx[0] - 3 * idx[1] );
+    }
+
+  // Expressions sharing subexpressions, plus index variables and overflows
+  std::vector<std::string> expressions;
+  expressions.push_back("ndvi(b1, b2) * 100");
+  expressions.push_back("ndvi(b1, b2) > 0.2");
+  expressions.push_back("(b2 - b1)/(b2 + b1) * 100");
+  expressions.push_back("if(ndvi(b1, b2) > 0.2, canal3, (b2 - b1) * 1000)");
+  expressions.push_back("(idxX > 50) * canal3 + sqrt(b1 * b1 + b2 * b2)");
+  expressions.push_back("7");
+
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetNthInput(0, image1);
+  filter->SetNthInput(1, image2);
+  filter->SetNthInput(2, image3, "canal3");
+  filter->SetExpressions(expressions);
+  filter->Update();
+
+  if (filter->GetOutput()->GetNumberOfComponentsPerPixel() != expressions.size())
+    {
+    std::cerr << "Output has " << filter->GetOutput()->GetNumberOfComponentsPerPixel()
+              << " bands, " << expressions.size() << " expected." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  bool pass = true;
+
+  for (unsigned int e = 0; e < expressions.size(); ++e)
+    {
+    BandMathFilterType::Pointer bandMathFilter = BandMathFilterType::New();
+    bandMathFilter->SetNthInput(0, image1);
+    bandMathFilter->SetNthInput(1, image2);
+    bandMathFilter->SetNthInput(2, image3, "canal3");
+    bandMathFilter->SetExpression(expressions[e]);
+    bandMathFilter->Update();
+
+    IteratorType itRef(bandMathFilter->GetOutput(), region);
+    VectorIteratorType itMulti(filter->GetOutput(), region);
+
+    for (itRef.GoToBegin(), itMulti.GoToBegin(); !itRef.IsAtEnd(); ++itRef, ++itMulti)
+      {
+      if (itMulti.Get()[e] != itRef.Get())
+        {
+        std::cerr << "Expression " << expressions[e] << " at " << itRef.GetIndex()
+                  << ": multi expression filter gives " << itMulti.Get()[e]
+                  << ", BandMathImageFilter gives " << itRef.Get() << std::endl;
+        pass = false;
+        break;
+        }
+      }
+    }
+
+  if (!pass)
+    {
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
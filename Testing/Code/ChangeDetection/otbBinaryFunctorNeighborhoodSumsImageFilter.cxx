@@ -0,0 +1,109 @@
+/*=========================================================================
+
+  Program:   ORFEO Toolbox
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+
+  Copyright (c) Centre National d'Etudes Spatiales. All rights reserved.
+  See OTBCopyright.txt for details.
+
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#include "otbImage.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "otbMeanDifferenceImageFilter.h"
+#include "otbMeanRatioImageFilter.h"
+#include "otbCorrelationChangeDetector.h"
+
+typedef otb::Image<float, 2> SumsTestImageType;
+
+// Pattern with flat areas, so that null variances are checked too
+static SumsTestImageType::Pointer GenerateSumsTestImage(unsigned int seed)
+{
+  SumsTestImageType::RegionType region;
+  region.SetSize(0, 57);
+  region.SetSize(1, 43);
+
+  SumsTestImageType::Pointer image = SumsTestImageType::New();
+  image->SetRegions(region);
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex<SumsTestImageType> it(image, region);
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+    const long x = it.GetIndex()[0];
+    const long y = it.GetIndex()[1];
+    if (x < 20 && y < 15)
+      {
+      it.Set(7 + seed);
+      }
+    else
+      {
+      it.Set(1 + (x * (seed + 3) + y * y * (2 * seed + 1) + x * y) % 251);
+      }
+    }
+  return image;
+}
+
+// Check a sums based change detector against the neighborhood iterators version of its functor
+template <class TFilter>
+static bool CheckSumsFilter(SumsTestImageType * image1, SumsTestImageType * image2, const char * name)
+{
+  typedef typename TFilter::FunctorType FunctorType;
+  typedef otb::BinaryFunctorNeighborhoodImageFilter<SumsTestImageType, SumsTestImageType,
+                                                    SumsTestImageType, FunctorType> ReferenceFilterType;
+
+  typename TFilter::RadiusSizeType radius;
+  radius[0] = 2;
+  radius[1] = 4;
+
+  typename TFilter::Pointer filter = TFilter::New();
+  filter->SetInput1(image1);
+  filter->SetInput2(image2);
+  filter->SetRadius(radius);
+  filter->Update();
+
+  typename ReferenceFilterType::Pointer reference = ReferenceFilterType::New();
+  reference->SetInput1(image1);
+  reference->SetInput2(image2);
+  reference->SetRadius(radius);
+  reference->Update();
+
+  itk::ImageRegionIteratorWithIndex<SumsTestImageType> it(filter->GetOutput(),
+                                                          filter->GetOutput()->GetLargestPossibleRegion());
+  itk::ImageRegionIteratorWithIndex<SumsTestImageType> refIt(reference->GetOutput(),
+                                                             filter->GetOutput()->GetLargestPossibleRegion());
+  for (it.GoToBegin(), refIt.GoToBegin(); !it.IsAtEnd(); ++it, ++refIt)
+    {
+    if (vcl_abs(it.Get() - refIt.Get()) > 1e-4 * (1. + vcl_abs(refIt.Get())))
+      {
+      std::cout << name << ": " << it.Get() << " instead of " << refIt.Get()
+                << " at " << it.GetIndex() << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+int otbBinaryFunctorNeighborhoodSumsImageFilter(int argc, char * argv[])
+{
+  SumsTestImageType::Pointer image1 = GenerateSumsTestImage(0);
+  SumsTestImageType::Pointer image2 = GenerateSumsTestImage(5);
+
+  typedef otb::MeanDifferenceImageFilter<SumsTestImageType, SumsTestImageType, SumsTestImageType> MeanDiffType;
+  typedef otb::MeanRatioImageFilter<SumsTestImageType, SumsTestImageType, SumsTestImageType>      MeanRatioType;
+  typedef otb::CorrelationChangeDetector<SumsTestImageType, SumsTestImageType, SumsTestImageType> CorrelType;
+
+  bool ok = CheckSumsFilter<MeanDiffType>(image1, image2, "MeanDifference");
+  ok = CheckSumsFilter<MeanRatioType>(image1, image2, "MeanRatio") && ok;
+  ok = CheckSumsFilter<CorrelType>(image1, image2, "Correlation") && ok;
+  ok = CheckSumsFilter<CorrelType>(image1, image1, "Correlation (same image)") && ok;
+
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -30,4 +30,5 @@ void RegisterTests()
   REGISTER_TEST(otbMeanRatioChangeDetectionTest);
   REGISTER_TEST(otbLHMIChangeDetectionTest);
   REGISTER_TEST(otbJHMIChangeDetectionTest);
+  REGISTER_TEST(otbBinaryFunctorNeighborhoodSumsImageFilter);
 }
@@ -28,6 +28,7 @@ void RegisterTests()
   REGISTER_TEST(otbKullbackLeiblerDistanceImageFilter);
   REGISTER_TEST(otbKullbackLeiblerProfileImageFilterNew);
   REGISTER_TEST(otbKullbackLeiblerProfileImageFilter);
+  REGISTER_TEST(otbKullbackLeiblerProfileImageFilterSlidingMoments);
   REGISTER_TEST(otbKullbackLeiblerSupervizedDistanceImageFilterNew);
   REGISTER_TEST(otbKullbackLeiblerSupervizedDistanceImageFilter);
 }
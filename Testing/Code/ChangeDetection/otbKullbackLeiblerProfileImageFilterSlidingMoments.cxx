@@ -0,0 +1,104 @@
+/*=========================================================================
+
+  Program:   ORFEO Toolbox
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+
+  Copyright (c) Centre National d'Etudes Spatiales. All rights reserved.
+  See OTBCopyright.txt for details.
+
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#include "itkExceptionObject.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "otbImage.h"
+#include "otbVectorImage.h"
+#include "otbKullbackLeiblerProfileImageFilter.h"
+
+// The sliding window sums must give the same profiles as the neighborhood
+// iterators, up to the rounding of the raw moments
+int otbKullbackLeiblerProfileImageFilterSlidingMoments(int argc, char * argv[])
+{
+  typedef double                                                                        PixelType;
+  typedef otb::Image<PixelType, 2>                                                      ImageType;
+  typedef otb::VectorImage<PixelType, 2>                                                VectorImageType;
+  typedef otb::KullbackLeiblerProfileImageFilter<ImageType, ImageType, VectorImageType> FilterType;
+  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator                        GeneratorType;
+
+  GeneratorType::Pointer generator = GeneratorType::New();
+  generator->Initialize(1234);
+
+  ImageType::RegionType region;
+  region.SetSize(0, 61);
+  region.SetSize(1, 47);
+
+  // Speckle-like images with a flat area, so that null variances are checked too
+  ImageType::Pointer images[2];
+  for (unsigned int i = 0; i < 2; ++i)
+    {
+    images[i] = ImageType::New();
+    images[i]->SetRegions(region);
+    images[i]->Allocate();
+
+    itk::ImageRegionIteratorWithIndex<ImageType> it(images[i], region);
+    for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+      {
+      const long x = it.GetIndex()[0];
+      const long y = it.GetIndex()[1];
+      if (x < 15 && y < 12)
+        {
+        it.Set(50.);
+        }
+      else
+        {
+        const double mean = (i == 1 && x > 30) ? 120. : 80.;
+        it.Set(vcl_floor(mean * generator->GetVariateWithOpenUpperRange() + 0.5 * mean));
+        }
+      }
+    }
+
+  const unsigned char radiusList[3][2] = {{1, 3}, {2, 6}, {0, 2}};
+
+  for (unsigned int r = 0; r < 3; ++r)
+    {
+    FilterType::Pointer reference = FilterType::New();
+    reference->SetRadius(radiusList[r][0], radiusList[r][1]);
+    reference->SetInput1(images[0]);
+    reference->SetInput2(images[1]);
+    reference->Update();
+
+    FilterType::Pointer filter = FilterType::New();
+    filter->SetRadius(radiusList[r][0], radiusList[r][1]);
+    filter->SetInput1(images[0]);
+    filter->SetInput2(images[1]);
+    filter->UseSlidingMomentsOn();
+    filter->Update();
+
+    itk::ImageRegionConstIterator<VectorImageType> refIt(reference->GetOutput(), region);
+    itk::ImageRegionConstIterator<VectorImageType> it(filter->GetOutput(), region);
+    for (refIt.GoToBegin(), it.GoToBegin(); !it.IsAtEnd(); ++refIt, ++it)
+      {
+      const VectorImageType::PixelType ref = refIt.Get();
+      const VectorImageType::PixelType value = it.Get();
+      for (unsigned int c = 0; c < ref.GetSize(); ++c)
+        {
+        if (vcl_abs(value[c] - ref[c]) > 1e-6 * std::max(1., vcl_abs(ref[c])))
+          {
+          std::cout << "Radius [" << int(radiusList[r][0]) << ", " << int(radiusList[r][1]) << "], pixel "
+                    << it.GetIndex() << ": got " << value << " instead of " << ref << std::endl;
+          return EXIT_FAILURE;
+          }
+        }
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
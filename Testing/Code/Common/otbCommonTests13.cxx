@@ -26,9 +26,12 @@ void RegisterTests()
 {
   REGISTER_TEST(otbPipelineMemoryPrintCalculatorNew);
   REGISTER_TEST(otbPipelineMemoryPrintCalculatorTest);
+  REGISTER_TEST(otbPipelineMemoryPrintCalculatorMeasuredTest);
   REGISTER_TEST(otbStreamingManagerNew);
   REGISTER_TEST(otbNumberOfLinesStrippedStreamingManager);
   REGISTER_TEST(otbRAMDrivenStrippedStreamingManager);
+  REGISTER_TEST(otbRAMDrivenStrippedStreamingManagerMeasured);
   REGISTER_TEST(otbTileDimensionTiledStreamingManager);
   REGISTER_TEST(otbRAMDrivenTiledStreamingManager);
+  REGISTER_TEST(otbRunningWindowSums);
 }
@@ -21,6 +21,7 @@
 #include "otbImage.h"
 #include "otbImageFileReader.h"
 #include "otbVectorImageToIntensityImageFilter.h"
+#include "itkExtractImageFilter.h"
 
 int otbPipelineMemoryPrintCalculatorNew(int argc, char * argv[])
 {
@@ -64,3 +65,61 @@ int otbPipelineMemoryPrintCalculatorTest(int argc, char * argv[])
 
   return EXIT_SUCCESS;
 }
+
+int otbPipelineMemoryPrintCalculatorMeasuredTest(int argc, char * argv[])
+{
+  typedef otb::VectorImage<double, 2>            VectorImageType;
+  typedef otb::Image<double, 2>                  ImageType;
+  typedef otb::ImageFileReader<VectorImageType>  ReaderType;
+  typedef otb::VectorImageToIntensityImageFilter
+    <VectorImageType, ImageType>                 IntensityImageFilterType;
+  typedef itk::ExtractImageFilter<ImageType, ImageType> ExtractFilterType;
+
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+
+  IntensityImageFilterType::Pointer intensity = IntensityImageFilterType::New();
+  intensity->SetInput(reader->GetOutput());
+  intensity->UpdateOutputInformation();
+
+  // Probe region of 50x50 pixels at the image center
+  ImageType::RegionType largestRegion = intensity->GetOutput()->GetLargestPossibleRegion();
+  ImageType::RegionType probeRegion;
+  ImageType::SizeType   probeSize;
+  probeSize.Fill(50);
+  ImageType::IndexType  probeIndex;
+  probeIndex[0] = largestRegion.GetIndex()[0] + largestRegion.GetSize()[0] / 2 - 25;
+  probeIndex[1] = largestRegion.GetIndex()[1] + largestRegion.GetSize()[1] / 2 - 25;
+  probeRegion.SetSize(probeSize);
+  probeRegion.SetIndex(probeIndex);
+  probeRegion.Crop(largestRegion);
+
+  ExtractFilterType::Pointer extract = ExtractFilterType::New();
+  extract->SetInput(intensity->GetOutput());
+  extract->SetExtractionRegion(probeRegion);
+
+  otb::PipelineMemoryPrintCalculator::Pointer calculator = otb::PipelineMemoryPrintCalculator::New();
+  calculator->SetDataToWrite(extract->GetOutput());
+  calculator->SetBiasCorrectionFactor(static_cast<double>(largestRegion.GetNumberOfPixels())
+                                      / probeRegion.GetNumberOfPixels());
+  calculator->UseMeasuredMemoryPrintOn();
+  calculator->Compute();
+
+  std::cout << calculator << std::endl;
+
+  // The breakdown holds the reader, the intensity filter and the extract
+  if (calculator->GetFilterMemoryPrints().size() != 3)
+    {
+    std::cerr << "Expected 3 filters in the breakdown, got " << calculator->GetFilterMemoryPrints().size() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // The measurement is only available on some platforms
+  if (otb::PipelineMemoryPrintCalculator::GetAllocatedMemory() > 0 && calculator->GetMemoryPrint() <= 0)
+    {
+    std::cerr << "The measured memory print should be positive" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
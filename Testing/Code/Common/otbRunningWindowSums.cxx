@@ -0,0 +1,86 @@
+/*=========================================================================
+
+  Program:   ORFEO Toolbox
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+
+  Copyright (c) Centre National d'Etudes Spatiales. All rights reserved.
+  See OTBCopyright.txt for details.
+
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+
+#include "otbRunningWindowSums.h"
+
+// Check the window sums against the brute force sums over the window
+int otbRunningWindowSums(int argc, char * argv[])
+{
+  const unsigned int nbSums = 2;
+  const long         width = 13;
+  const long         height = 11;
+  const long         radiusX = 2;
+  const long         radiusY = 3;
+  const long         paddedWidth = width + 2 * radiusX;
+  const long         paddedHeight = height + 2 * radiusY;
+
+  // Integer values, so that the sums are exact
+  std::vector<double> values(nbSums * paddedWidth * paddedHeight);
+  for (unsigned long i = 0; i < values.size(); ++i)
+    {
+    values[i] = static_cast<double>((i * 37 + 11) % 101);
+    }
+
+  otb::RunningWindowSums windowSums(nbSums, width, radiusX, radiusY);
+
+  long outputRow = 0;
+  for (long row = 0; row < paddedHeight; ++row)
+    {
+    std::copy(&values[nbSums * paddedWidth * row], &values[nbSums * paddedWidth * (row + 1)],
+              windowSums.GetRowBuffer());
+
+    if (!windowSums.PushRow())
+      {
+      continue;
+      }
+
+    for (long column = 0; column < width; ++column)
+      {
+      for (unsigned int s = 0; s < nbSums; ++s)
+        {
+        double expected = 0.;
+        for (long y = outputRow; y <= outputRow + 2 * radiusY; ++y)
+          {
+          for (long x = column; x <= column + 2 * radiusX; ++x)
+            {
+            expected += values[nbSums * (paddedWidth * y + x) + s];
+            }
+          }
+
+        if (windowSums.GetWindowSums(column)[s] != expected)
+          {
+          std::cout << "Sum " << s << " of pixel (" << column << ", " << outputRow << "): got "
+                    << windowSums.GetWindowSums(column)[s] << " instead of " << expected << std::endl;
+          return EXIT_FAILURE;
+          }
+        }
+      }
+    ++outputRow;
+    }
+
+  if (outputRow != height)
+    {
+    std::cout << outputRow << " output rows instead of " << height << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -22,8 +22,11 @@
 #include "otbRAMDrivenStrippedStreamingManager.h"
 #include "otbTileDimensionTiledStreamingManager.h"
 #include "otbRAMDrivenTiledStreamingManager.h"
+#include "itkImageToImageFilter.h"
+#include "itkImageRegionIterator.h"
 
 #include <fstream>
+#include <vector>
 
 const int Dimension = 2;
 typedef otb::VectorImage<unsigned short, Dimension>           ImageType;
@@ -185,3 +188,109 @@ int otbRAMDrivenTiledStreamingManager(int argc, char * argv[])
 
   return EXIT_SUCCESS;
 }
+
+namespace otb
+{
+/** \class FixedAllocationImageFilter
+ * Copy the input, allocating meanwhile a table whose size does not
+ * depend on the region (like a model or a lookup table).
+ */
+template <class TImage>
+class ITK_EXPORT FixedAllocationImageFilter : public itk::ImageToImageFilter<TImage, TImage>
+{
+public:
+  typedef FixedAllocationImageFilter                Self;
+  typedef itk::ImageToImageFilter<TImage, TImage>   Superclass;
+  typedef itk::SmartPointer<Self>                   Pointer;
+  typedef itk::SmartPointer<const Self>             ConstPointer;
+
+  itkNewMacro(Self);
+  itkTypeMacro(FixedAllocationImageFilter, ImageToImageFilter);
+
+  itkSetMacro(TableSize, unsigned long);
+
+protected:
+  FixedAllocationImageFilter() : m_TableSize(0) {}
+  virtual ~FixedAllocationImageFilter() {}
+
+  virtual void GenerateData()
+  {
+    std::vector<char> table(m_TableSize, 1);
+
+    this->AllocateOutputs();
+    typename TImage::RegionType region = this->GetOutput()->GetRequestedRegion();
+    itk::ImageRegionConstIterator<TImage> inputIt(this->GetInput(), region);
+    itk::ImageRegionIterator<TImage>      outputIt(this->GetOutput(), region);
+    for (inputIt.GoToBegin(), outputIt.GoToBegin(); !inputIt.IsAtEnd(); ++inputIt, ++outputIt)
+      {
+      outputIt.Set(inputIt.Get());
+      }
+
+    // The allocated memory is sampled on the progress event, while the
+    // table is still allocated
+    this->UpdateProgress(table[m_TableSize - 1]);
+  }
+
+private:
+  FixedAllocationImageFilter(const Self &); //purposely not implemented
+  void operator =(const Self&);             //purposely not implemented
+
+  unsigned long m_TableSize;
+};
+}
+
+int otbRAMDrivenStrippedStreamingManagerMeasured(int argc, char * argv[])
+{
+  typedef otb::FixedAllocationImageFilter<ImageType> FilterType;
+
+  ImageType::RegionType region;
+  region.SetIndex(0, 0);
+  region.SetIndex(1, 0);
+  region.SetSize(0, 1000);
+  region.SetSize(1, 1000);
+
+  // 20 MB image, and 32 MB allocated by the filter whatever the region
+  ImageType::Pointer image = makeImage(region);
+  image->Allocate();
+  ImageType::PixelType pixel(10);
+  pixel.Fill(1);
+  image->FillBuffer(pixel);
+
+  const unsigned long tableSize = 32 * 1024 * 1024;
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput(image);
+  filter->SetTableSize(tableSize);
+  filter->UpdateOutputInformation();
+
+  RAMDrivenStrippedStreamingManagerType::Pointer streamingManager = RAMDrivenStrippedStreamingManagerType::New();
+  streamingManager->SetAvailableRAMInMB(40);
+  streamingManager->UseMeasuredMemoryPrintOn();
+  streamingManager->PrepareStreaming(filter->GetOutput(), region);
+
+  const unsigned int nbSplits = streamingManager->GetNumberOfSplits();
+  std::cout << "Number of splits: " << nbSplits << std::endl;
+
+  // The measurement is only available on some platforms
+  if (otb::PipelineMemoryPrintCalculator::GetAllocatedMemory() == 0)
+    {
+    return EXIT_SUCCESS;
+    }
+
+  if (streamingManager->GetFilterMemoryPrints().size() != 1
+      || streamingManager->GetFilterMemoryPrints()[0].m_MeasuredPrint < static_cast<long long int>(tableSize))
+    {
+    std::cerr << "The measured print of the filter should hold its table" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Only the 20 MB proportional to the region are divided, in the 8 MB
+  // left by the table. Extrapolating the table from the probe region
+  // would give thousands of divisions
+  if (nbSplits < 3 || nbSplits > 4)
+    {
+    std::cerr << "Expected 3 or 4 splits" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -28,4 +28,5 @@ void RegisterTests()
   REGISTER_TEST(otbStreamingWarpImageFilter);
   REGISTER_TEST(otbFineRegistrationImageFilterNew);
   REGISTER_TEST(otbFineRegistrationImageFilterTest);
+  REGISTER_TEST(otbFineRegistrationImageFilterDenseCorrelation);
 }
@@ -0,0 +1,148 @@
+/*=========================================================================
+
+  Program:   ORFEO Toolbox
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+
+  Copyright (c) Centre National d'Etudes Spatiales. All rights reserved.
+  See OTBCopyright.txt for details.
+
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#include "otbImage.h"
+#include "itkFixedArray.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkNormalizedCorrelationImageToImageMetric.h"
+#include "otbFineRegistrationImageFilter.h"
+
+typedef double                                                                 PixelType;
+typedef itk::FixedArray<PixelType, 2>                                          DeformationValueType;
+typedef otb::Image<PixelType, 2>                                               ImageType;
+typedef otb::Image<DeformationValueType, 2>                                    FieldImageType;
+typedef otb::FineRegistrationImageFilter<ImageType, ImageType, FieldImageType> RegistrationFilterType;
+typedef itk::NormalizedCorrelationImageToImageMetric<ImageType, ImageType>     NCCType;
+
+// Smooth pattern sampled at (x - tx, y - ty)
+static ImageType::Pointer GenerateShiftedPattern(double tx, double ty)
+{
+  ImageType::RegionType region;
+  region.SetSize(0, 60);
+  region.SetSize(1, 50);
+
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(region);
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex<ImageType> it(image, region);
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+    const double x = it.GetIndex()[0] - tx;
+    const double y = it.GetIndex()[1] - ty;
+    it.Set(100. + 20. * vcl_sin(0.35 * x) * vcl_cos(0.27 * y) + 10. * vcl_sin(0.13 * (x + 2. * y)));
+    }
+  return image;
+}
+
+static RegistrationFilterType::Pointer Register(ImageType * fixed, ImageType * moving, unsigned int radius,
+                                                bool dense, double precision, bool subtractMean,
+                                                bool metricRefinement)
+{
+  RegistrationFilterType::Pointer registration = RegistrationFilterType::New();
+  registration->SetFixedInput(fixed);
+  registration->SetMovingInput(moving);
+  registration->SetRadius(radius);
+  registration->SetSearchRadius(4);
+  registration->SetSubPixelAccuracy(precision);
+  registration->SetGridStep(2);
+  registration->SetUseDenseCorrelation(dense);
+  registration->SetUseMetricRefinement(metricRefinement);
+
+  RegistrationFilterType::SpacingType offset;
+  offset[0] = 1.;
+  offset[1] = -1.;
+  registration->SetInitialOffset(offset);
+
+  NCCType::Pointer metric = NCCType::New();
+  metric->SetSubtractMean(subtractMean);
+  registration->SetMetric(metric);
+  registration->MinimizeOn();
+
+  registration->Update();
+  return registration;
+}
+
+int otbFineRegistrationImageFilterDenseCorrelation(int argc, char * argv[])
+{
+  ImageType::Pointer fixed  = GenerateShiftedPattern(0., 0.);
+  ImageType::Pointer moving = GenerateShiftedPattern(2.3, -1.6);
+
+  // The dense engine must find the generic optimum, with and without sub-pixel search on the metric
+  for (unsigned int test = 0; test < 4; ++test)
+    {
+    const double precision    = (test < 2) ? 1. : 0.1;
+    const bool   subtractMean = (test % 2 == 1);
+
+    RegistrationFilterType::Pointer generic = Register(fixed, moving, 3, false, precision, subtractMean, true);
+    RegistrationFilterType::Pointer dense   = Register(fixed, moving, 3, true, precision, subtractMean, true);
+
+    itk::ImageRegionIteratorWithIndex<ImageType> genericIt(generic->GetOutput(),
+                                                           generic->GetOutput()->GetLargestPossibleRegion());
+    itk::ImageRegionIteratorWithIndex<ImageType> denseIt(dense->GetOutput(),
+                                                         generic->GetOutput()->GetLargestPossibleRegion());
+    itk::ImageRegionIteratorWithIndex<FieldImageType> genericFieldIt(generic->GetOutputDeformationField(),
+                                                        generic->GetOutput()->GetLargestPossibleRegion());
+    itk::ImageRegionIteratorWithIndex<FieldImageType> denseFieldIt(dense->GetOutputDeformationField(),
+                                                        generic->GetOutput()->GetLargestPossibleRegion());
+
+    for (genericIt.GoToBegin(), denseIt.GoToBegin(), genericFieldIt.GoToBegin(), denseFieldIt.GoToBegin();
+         !genericIt.IsAtEnd(); ++genericIt, ++denseIt, ++genericFieldIt, ++denseFieldIt)
+      {
+      // Border windows with very few valid pixels give several perfect matches,
+      // in which case only the metric value is checked
+      const bool perfectMatch = vcl_abs(genericIt.Get()) > 1. - 1e-9;
+
+      if (vcl_abs(genericIt.Get() - denseIt.Get()) > 1e-9
+          || (!perfectMatch && genericFieldIt.Get() != denseFieldIt.Get()))
+        {
+        std::cout << "Dense and generic results differ at " << genericIt.GetIndex() << ": "
+                  << denseIt.Get() << " " << denseFieldIt.Get() << " instead of "
+                  << genericIt.Get() << " " << genericFieldIt.Get() << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  // The sub-pixel offset must be close to the true shift, with the dichotomic search and with
+  // the quadratic fit. The correlation surface is only smooth enough for the fit on large windows.
+  for (unsigned int test = 0; test < 2; ++test)
+    {
+    const unsigned int radius = (test == 0) ? 3 : 8;
+    const bool metricRefinement = (test == 0);
+
+    RegistrationFilterType::Pointer dense = Register(fixed, moving, radius, true, 0.1, true, metricRefinement);
+    ImageType::RegionType inner = dense->GetOutput()->GetLargestPossibleRegion();
+    const long margin = (radius + 4) / 2;
+    inner.SetIndex(0, margin);
+    inner.SetIndex(1, margin);
+    inner.SetSize(0, inner.GetSize()[0] - 2 * margin);
+    inner.SetSize(1, inner.GetSize()[1] - 2 * margin);
+
+    itk::ImageRegionIteratorWithIndex<FieldImageType> fieldIt(dense->GetOutputDeformationField(), inner);
+    for (fieldIt.GoToBegin(); !fieldIt.IsAtEnd(); ++fieldIt)
+      {
+      if (vcl_abs(fieldIt.Get()[0] - 2.3) > 0.15 || vcl_abs(fieldIt.Get()[1] + 1.6) > 0.15)
+        {
+        std::cout << "Wrong sub-pixel offset " << fieldIt.Get() << " at " << fieldIt.GetIndex() << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
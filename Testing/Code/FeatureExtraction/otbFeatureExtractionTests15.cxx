@@ -26,6 +26,8 @@ void RegisterTests()
 {
   REGISTER_TEST(otbStreamingLineSegmentDetectorNew);
   REGISTER_TEST(otbStreamingLineSegmentDetector);
+  REGISTER_TEST(otbStreamingLineSegmentDetectorTiled);
+  REGISTER_TEST(otbStreamingLineSegmentDetectorMergeSeams);
   REGISTER_TEST(otbSqrtSpectralAngleImageFilter);
   REGISTER_TEST(otbScalarImageToTexturesFilterNew);
   REGISTER_TEST(otbMaskedScalarImageToGreyLevelRunLengthMatrixGeneratorNew);
@@ -38,4 +40,6 @@ void RegisterTests()
   REGISTER_TEST(otbScalarImageToPanTexTextureFilter);
   REGISTER_TEST(otbScalarImageToHigherOrderTexturesFilterNew);
   REGISTER_TEST(otbScalarImageToHigherOrderTexturesFilter);
+  REGISTER_TEST(otbSlidingWindowGreyLevelCooccurrenceMatrixNew);
+  REGISTER_TEST(otbSlidingWindowGreyLevelCooccurrenceMatrix);
 }
@@ -0,0 +1,181 @@
+/*=========================================================================
+
+  Program:   ORFEO Toolbox
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+
+  Copyright (c) Centre National d'Etudes Spatiales. All rights reserved.
+  See OTBCopyright.txt for details.
+
+
+  This software is distributed WITHOUT ANY WARRANTY; without even
+  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#include "itkExceptionObject.h"
+
+#include "otbSlidingWindowGreyLevelCooccurrenceMatrix.h"
+#include "otbMaskedScalarImageToGreyLevelCoocurenceMatrixGenerator.h"
+#include "itkGreyLevelCooccurrenceMatrixTextureCoefficientsCalculator.h"
+#include "otbGreyLevelCooccurrenceMatrixAdvancedTextureCoefficientsCalculator.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "otbImage.h"
+#include "otbImageFileReader.h"
+
+const unsigned int Dimension = 2;
+typedef float                                                    PixelType;
+typedef otb::Image<PixelType, Dimension>                         ImageType;
+typedef otb::SlidingWindowGreyLevelCooccurrenceMatrix<ImageType> CooccurrenceMatrixType;
+
+int otbSlidingWindowGreyLevelCooccurrenceMatrixNew(int argc, char * argv[])
+{
+  CooccurrenceMatrixType::Pointer matrix = CooccurrenceMatrixType::New();
+
+  std::cout << matrix << std::endl;
+
+  return EXIT_SUCCESS;
+}
+
+int otbSlidingWindowGreyLevelCooccurrenceMatrix(int argc, char * argv[])
+{
+  if (argc != 6)
+    {
+    std::cerr << "Usage: " << argv[0] << " infname nbBins radius offsetx offsety" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const char *       infname      = argv[1];
+  const unsigned int nbBins       = atoi(argv[2]);
+  const unsigned int radius       = atoi(argv[3]);
+  const int          offsetx      = atoi(argv[4]);
+  const int          offsety      = atoi(argv[5]);
+
+  typedef otb::ImageFileReader<ImageType> ReaderType;
+  typedef otb::MaskedScalarImageToGreyLevelCooccurrenceMatrixGenerator
+  <ImageType>                                      GeneratorType;
+  typedef GeneratorType::HistogramType             HistogramType;
+  typedef itk::Statistics::GreyLevelCooccurrenceMatrixTextureCoefficientsCalculator
+  <HistogramType>                                  CalculatorType;
+  typedef otb::GreyLevelCooccurrenceMatrixAdvancedTextureCoefficientsCalculator
+  <HistogramType>                                  AdvancedCalculatorType;
+
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(infname);
+  reader->Update();
+
+  ImageType::Pointer image = reader->GetOutput();
+
+  CooccurrenceMatrixType::SizeType sradius;
+  sradius.Fill(radius);
+
+  CooccurrenceMatrixType::OffsetType offset;
+  offset[0] = offsetx;
+  offset[1] = offsety;
+
+  const PixelType minimum = 0;
+  const PixelType maximum = 256;
+
+  // Sliding window co-occurrence matrix
+  CooccurrenceMatrixType::Pointer matrix = CooccurrenceMatrixType::New();
+  matrix->SetInput(image);
+  matrix->SetRegion(image->GetRequestedRegion());
+  matrix->SetRadius(sradius);
+  matrix->SetOffset(offset);
+  matrix->SetNumberOfBinsPerAxis(nbBins);
+  matrix->SetPixelValueMinMax(minimum, maximum);
+  matrix->Initialize();
+
+  // Reference histogram based computation
+  GeneratorType::Pointer generator = GeneratorType::New();
+  generator->SetInput(image);
+  generator->SetOffset(offset);
+  generator->SetNumberOfBinsPerAxis(nbBins);
+  generator->SetPixelValueMinMax(minimum, maximum);
+  generator->SetNormalize(true);
+
+  CalculatorType::Pointer         calculator = CalculatorType::New();
+  AdvancedCalculatorType::Pointer advancedCalculator = AdvancedCalculatorType::New();
+
+  // Scan a sub-region touching the image borders, row by row, so that
+  // both incremental updates and rebuilds are checked
+  ImageType::RegionType scanRegion = image->GetLargestPossibleRegion();
+  ImageType::SizeType   scanSize = scanRegion.GetSize();
+  scanSize[1] = std::min(scanSize[1], static_cast<ImageType::SizeType::SizeValueType>(2 * radius + 5));
+  scanRegion.SetSize(scanSize);
+
+  // Histogram frequencies are stored in single precision
+  const double epsilon = 1e-4;
+  unsigned int nbErrors = 0;
+
+  itk::ImageRegionConstIteratorWithIndex<ImageType> it(image, scanRegion);
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+    matrix->SetCenter(it.GetIndex());
+    CooccurrenceMatrixType::HaralickTexturesType textures = matrix->ComputeHaralickTextures();
+    CooccurrenceMatrixType::AdvancedTexturesType advancedTextures = matrix->ComputeAdvancedTextures();
+
+    ImageType::RegionType window;
+    window.SetIndex(it.GetIndex() - sradius);
+    ImageType::SizeType windowSize;
+    windowSize.Fill(2 * radius + 1);
+    window.SetSize(windowSize);
+
+    if (matrix->GetTotalFrequency() == 0)
+      {
+      // Empty windows can not be normalized by the generator
+      continue;
+      }
+
+    generator->SetRegion(window);
+    generator->Compute();
+
+    calculator->SetHistogram(generator->GetOutput());
+    calculator->Compute();
+    advancedCalculator->SetHistogram(generator->GetOutput());
+    advancedCalculator->Compute();
+
+    double reference[17];
+    reference[0] = calculator->GetEnergy();
+    reference[1] = calculator->GetEntropy();
+    reference[2] = calculator->GetCorrelation();
+    reference[3] = calculator->GetInverseDifferenceMoment();
+    reference[4] = calculator->GetInertia();
+    reference[5] = calculator->GetClusterShade();
+    reference[6] = calculator->GetClusterProminence();
+    reference[7] = calculator->GetHaralickCorrelation();
+    reference[8] = advancedCalculator->GetVariance();
+    reference[9] = advancedCalculator->GetMean();
+    reference[10] = advancedCalculator->GetSumAverage();
+    reference[11] = advancedCalculator->GetSumVariance();
+    reference[12] = advancedCalculator->GetSumEntropy();
+    reference[13] = advancedCalculator->GetDifferenceEntropy();
+    reference[14] = advancedCalculator->GetDifferenceVariance();
+    reference[15] = advancedCalculator->GetIC1();
+    reference[16] = advancedCalculator->GetIC2();
+
+    for (unsigned int i = 0; i < 17; ++i)
+      {
+      const double value = (i < 8) ? textures[i] : advancedTextures[i - 8];
+      const double tolerance = epsilon * std::max(1., vcl_abs(reference[i]));
+      if (vcl_abs(value - reference[i]) > tolerance)
+        {
+        if (nbErrors < 10)
+          {
+          std::cerr << "Texture " << i << " at index " << it.GetIndex() << ": expected " << reference[i]
+                    << ", got " << value << std::endl;
+          }
+        ++nbErrors;
+        }
+      }
+    }
+
+  if (nbErrors > 0)
+    {
+    std::cerr << nbErrors << " textures differ from the histogram based computation." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
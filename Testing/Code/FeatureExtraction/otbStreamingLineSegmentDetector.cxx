@@ -20,6 +20,7 @@
 #include "otbStreamingLineSegmentDetector.h"
 #include "otbImageFileReader.h"
 #include "otbVectorDataFileWriter.h"
+#include "itkImageRegionConstIterator.h"
 
 #include "otbPersistentImageToVectorDataFilter.h"
 #include "otbPersistentFilterStreamingDecorator.h"
@@ -70,3 +71,221 @@ int otbStreamingLineSegmentDetector(int argc, char * argv[])
 
   return EXIT_SUCCESS;
 }
+
+int otbStreamingLineSegmentDetectorTiled(int argc, char * argv[])
+{
+  typedef float InputPixelType;
+  const unsigned int Dimension = 2;
+
+  // Typedefs
+  typedef otb::Image<InputPixelType,  Dimension> ImageType;
+  typedef otb::ImageFileReader<ImageType>        ReaderType;
+
+  typedef otb::StreamingLineSegmentDetector<ImageType>::FilterType             StreamingLineSegmentDetectorType;
+  typedef StreamingLineSegmentDetectorType::FilterType::OutputVectorDataType   OutputVectorDataType;
+  typedef OutputVectorDataType::DataTreeType                                   DataTreeType;
+  typedef itk::PreOrderTreeIterator<DataTreeType>                              TreeIteratorType;
+  typedef otb::VectorDataFileWriter<OutputVectorDataType>                      WriterType;
+
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+  reader->GenerateOutputInformation();
+
+  // The tiles are processed by one thread, then by several threads: the
+  // segments must be the same
+  std::vector<double> coordinates[2];
+  StreamingLineSegmentDetectorType::Pointer lsdFilter;
+  for (unsigned int run = 0; run < 2; ++run)
+    {
+    lsdFilter = StreamingLineSegmentDetectorType::New();
+    lsdFilter->GetFilter()->SetInput(reader->GetOutput());
+    lsdFilter->GetFilter()->SetTileSize(atoi(argv[4]));
+    lsdFilter->GetFilter()->SetNumberOfThreads(run == 0 ? 1 : 4);
+    lsdFilter->GetStreamer()->SetNumberOfLinesStrippedStreaming(atoi(argv[3]));
+    lsdFilter->Update();
+
+    TreeIteratorType it(lsdFilter->GetFilter()->GetOutputVectorData()->GetDataTree());
+    for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+      {
+      if (it.Get()->IsLineFeature())
+        {
+        OutputVectorDataType::LineType::VertexListType::ConstIterator vIt =
+          it.Get()->GetLine()->GetVertexList()->Begin();
+        for (; vIt != it.Get()->GetLine()->GetVertexList()->End(); ++vIt)
+          {
+          coordinates[run].push_back(vIt.Value()[0]);
+          coordinates[run].push_back(vIt.Value()[1]);
+          }
+        }
+      }
+    }
+
+  std::cout << coordinates[0].size() / 4 << " segments detected" << std::endl;
+
+  // The tiles are thresholded with the gradient range of the whole image
+  typedef otb::LineSegmentDetector<ImageType, double> LSDType;
+  LSDType::Pointer lsd = LSDType::New();
+  lsd->SetInput(reader->GetOutput());
+  lsd->Update();
+
+  double min = itk::NumericTraits<double>::max();
+  double max = itk::NumericTraits<double>::NonpositiveMin();
+  itk::ImageRegionConstIterator<LSDType::MagnitudeImageType> modIt(lsd->GetGradMod(),
+                                                                   lsd->GetGradMod()->GetBufferedRegion());
+  for (modIt.GoToBegin(); !modIt.IsAtEnd(); ++modIt)
+    {
+    min = std::min(min, static_cast<double>(modIt.Get()));
+    max = std::max(max, static_cast<double>(modIt.Get()));
+    }
+
+  // The tile borders only slightly change the gradient
+  const double tolerance = 0.05 * (max - min);
+  if (vcl_abs(lsdFilter->GetFilter()->GetModulusMinimum() - min) > tolerance
+      || vcl_abs(lsdFilter->GetFilter()->GetModulusMaximum() - max) > tolerance)
+    {
+    std::cerr << "The gradient range of the tiles [" << lsdFilter->GetFilter()->GetModulusMinimum() << ", "
+              << lsdFilter->GetFilter()->GetModulusMaximum() << "] is not the one of the image ["
+              << min << ", " << max << "]" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  if (coordinates[0] != coordinates[1])
+    {
+    std::cerr << "The segments depend on the number of threads ("
+              << coordinates[0].size() / 4 << " segments with 1 thread, "
+              << coordinates[1].size() / 4 << " segments with 4 threads)" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetFileName(argv[2]);
+  writer->SetInput(lsdFilter->GetFilter()->GetOutputVectorData());
+  writer->Update();
+
+  return EXIT_SUCCESS;
+}
+
+namespace
+{
+// Count the segments and the ones crossing a seam (given by its ordinate),
+// and sum their lengths
+template <class TVectorData>
+void ComputeSegmentStatistics(const TVectorData * vectorData, const std::vector<double>& seams, double margin,
+                              unsigned int& nbSegments, unsigned int& nbCrossingSegments, double& length)
+{
+  typedef itk::PreOrderTreeIterator<typename TVectorData::DataTreeType> TreeIteratorType;
+  typedef typename TVectorData::LineType::VertexType                     VertexType;
+
+  nbSegments = 0;
+  nbCrossingSegments = 0;
+  length = 0;
+  TreeIteratorType it(vectorData->GetDataTree());
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+    if (!it.Get()->IsLineFeature() || it.Get()->GetLine()->GetVertexList()->Size() != 2)
+      {
+      continue;
+      }
+    const VertexType& p0 = it.Get()->GetLine()->GetVertexList()->GetElement(0);
+    const VertexType& p1 = it.Get()->GetLine()->GetVertexList()->GetElement(1);
+
+    ++nbSegments;
+    length += vcl_sqrt((p1[0] - p0[0]) * (p1[0] - p0[0]) + (p1[1] - p0[1]) * (p1[1] - p0[1]));
+
+    // Extremities closer than the margin to a seam are not across it
+    const double yMin = std::min(p0[1], p1[1]) + margin;
+    const double yMax = std::max(p0[1], p1[1]) - margin;
+    for (unsigned int i = 0; i < seams.size(); ++i)
+      {
+      if (yMin < seams[i] && seams[i] < yMax)
+        {
+        ++nbCrossingSegments;
+        break;
+        }
+      }
+    }
+}
+}
+
+int otbStreamingLineSegmentDetectorMergeSeams(int argc, char * argv[])
+{
+  typedef float InputPixelType;
+  const unsigned int Dimension = 2;
+
+  // Typedefs
+  typedef otb::Image<InputPixelType,  Dimension> ImageType;
+  typedef otb::ImageFileReader<ImageType>        ReaderType;
+
+  typedef otb::StreamingLineSegmentDetector<ImageType>::FilterType             StreamingLineSegmentDetectorType;
+  typedef StreamingLineSegmentDetectorType::FilterType::OutputVectorDataType   OutputVectorDataType;
+  typedef otb::VectorDataFileWriter<OutputVectorDataType>                      WriterType;
+
+  // Single strip (reference), strips, and strips with the pieces merged
+  // across the seams. Each detection has its own reader, so that a
+  // streamed one does not get the whole image buffered by another one.
+  StreamingLineSegmentDetectorType::Pointer lsdFilters[3];
+  for (unsigned int i = 0; i < 3; ++i)
+    {
+    ReaderType::Pointer reader = ReaderType::New();
+    reader->SetFileName(argv[1]);
+    reader->GenerateOutputInformation();
+
+    lsdFilters[i] = StreamingLineSegmentDetectorType::New();
+    lsdFilters[i]->GetFilter()->SetInput(reader->GetOutput());
+    lsdFilters[i]->GetFilter()->SetMergeSeams(i == 2);
+    if (i == 0)
+      {
+      lsdFilters[i]->GetStreamer()->SetNumberOfDivisionsStrippedStreaming(1);
+      }
+    else
+      {
+      lsdFilters[i]->GetStreamer()->SetNumberOfLinesStrippedStreaming(atoi(argv[3]));
+      }
+    lsdFilters[i]->Update();
+    }
+
+  // Ordinates of the seams between the strips
+  const ImageType * image = lsdFilters[2]->GetFilter()->GetInput();
+  std::vector<double> seams;
+  for (unsigned int i = 1; i < lsdFilters[2]->GetStreamer()->GetStreamingManager()->GetNumberOfSplits(); ++i)
+    {
+    ImageType::IndexType index = lsdFilters[2]->GetStreamer()->GetStreamingManager()->GetSplit(i).GetIndex();
+    seams.push_back(image->GetOrigin()[1] + (index[1] - 0.5) * image->GetSpacing()[1]);
+    }
+  const double margin = 2. * vcl_abs(image->GetSpacing()[1]);
+
+  const char * names[3] = {"Single strip", "Strips", "Merged strips"};
+  unsigned int nbSegments[3], nbCrossingSegments[3];
+  double       length[3];
+  for (unsigned int i = 0; i < 3; ++i)
+    {
+    ComputeSegmentStatistics(lsdFilters[i]->GetFilter()->GetOutputVectorData(), seams, margin,
+                             nbSegments[i], nbCrossingSegments[i], length[i]);
+    std::cout << names[i] << ": " << nbSegments[i] << " segments, " << nbCrossingSegments[i]
+              << " across the seams, length " << length[i] << std::endl;
+    }
+
+  // The detection on a strip misses the pieces too short to be
+  // meaningful, so that only a part of the segments crossing the seams in
+  // the reference can be restored
+  if (nbCrossingSegments[2] < 0.25 * nbCrossingSegments[0])
+    {
+    std::cerr << "The segments cut by the seams have not been merged." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Merging joins the pieces, without dropping nor adding any length but
+  // the overlaps of the pieces
+  if (nbSegments[2] >= nbSegments[1] || vcl_abs(length[2] - length[1]) > 0.1 * length[1])
+    {
+    std::cerr << "The merged segments do not match their pieces." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetFileName(argv[2]);
+  writer->SetInput(lsdFilters[2]->GetFilter()->GetOutputVectorData());
+  writer->Update();
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,173 @@
+/*=========================================================================
+
+  Program:   ORFEO Toolbox
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+
+  Copyright (c) Centre National d'Etudes Spatiales. All rights reserved.
+  See OTBCopyright.txt for details.
+
+
+  This software is distributed WITHOUT ANY WARRANTY; without even
+  the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#include "itkExceptionObject.h"
+#include "itkMultiThreader.h"
+#include "vnl/vnl_math.h"
+
+#include "otbDEMHandler.h"
+#include "otbDEMTileCache.h"
+
+#include <vector>
+
+namespace
+{
+struct DEMHandlerTileCacheTestData
+{
+  otb::DEMHandler::Pointer demHandler;
+  std::vector<double>      lonLat;
+  std::vector<double>      heights;
+  unsigned int             nbThreads;
+};
+
+ITK_THREAD_RETURN_TYPE DEMHandlerTileCacheTestThread(void * arg)
+{
+  itk::MultiThreader::ThreadInfoStruct * info = static_cast<itk::MultiThreader::ThreadInfoStruct *>(arg);
+  DEMHandlerTileCacheTestData * data = static_cast<DEMHandlerTileCacheTestData *>(info->UserData);
+
+  // Each thread processes an interleaved subset of the points
+  const unsigned long nbPoints = data->heights.size();
+  for (unsigned long i = info->ThreadID; i < nbPoints; i += data->nbThreads)
+    {
+    data->heights[i] = data->demHandler->GetHeightAboveEllipsoid(data->lonLat[2 * i], data->lonLat[2 * i + 1]);
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+bool DEMHandlerTileCacheTestCompare(const char * name, double reference, double value)
+{
+  if (vnl_math_isnan(reference) && vnl_math_isnan(value))
+    {
+    return true;
+    }
+  if (vnl_math_isnan(reference) || vnl_math_isnan(value) || vcl_abs(reference - value) > 1e-3)
+    {
+    std::cerr << name << ": expected " << reference << ", got " << value << std::endl;
+    return false;
+    }
+  return true;
+}
+}
+
+int otbDEMHandlerTileCacheTest(int argc, char * argv[])
+{
+  if (argc != 5)
+    {
+    std::cerr << "Usage: " << argv[0] << " srtmDirectory geoidFile lon lat" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const char * srtmDirectory = argv[1];
+  const char * geoidFile = argv[2];
+  const double lon = atof(argv[3]);
+  const double lat = atof(argv[4]);
+
+  typedef otb::DEMHandler DEMHandlerType;
+
+  DEMHandlerType::Pointer demHandler = DEMHandlerType::New();
+  demHandler->OpenGeoidFile(geoidFile);
+  demHandler->OpenDEMDirectory(srtmDirectory);
+
+  // A grid of points around the given location, crossing tile borders,
+  // moved by varying fractions of the 3 arc-seconds posts so that the
+  // heights are interpolated between them
+  const unsigned int  nbSteps = 50;
+  const double        step = 0.5 / nbSteps;
+  const double        postSpacing = 3. / 3600.;
+  const unsigned long nbPoints = nbSteps * nbSteps;
+
+  std::vector<double> lonLat(2 * nbPoints);
+  for (unsigned int j = 0; j < nbSteps; ++j)
+    {
+    for (unsigned int i = 0; i < nbSteps; ++i)
+      {
+      lonLat[2 * (j * nbSteps + i)] = lon - 0.25 + i * step + ((i * 7 + j) % 10) * 0.1 * postSpacing;
+      lonLat[2 * (j * nbSteps + i) + 1] = lat - 0.25 + j * step + ((j * 3 + i) % 10) * 0.1 * postSpacing;
+      }
+    }
+
+  // The cache is off by default
+  if (demHandler->GetUseTileCache())
+    {
+    std::cerr << "The tile cache must be off by default" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Reference heights from ossimElevManager
+  demHandler->UseTileCacheOff();
+  std::vector<double> referenceMSL(nbPoints);
+  std::vector<double> referenceEllipsoid(nbPoints);
+  for (unsigned long i = 0; i < nbPoints; ++i)
+    {
+    referenceMSL[i] = demHandler->GetHeightAboveMSL(lonLat[2 * i], lonLat[2 * i + 1]);
+    referenceEllipsoid[i] = demHandler->GetHeightAboveEllipsoid(lonLat[2 * i], lonLat[2 * i + 1]);
+    }
+
+  // Every point is served from its decoded tile, whatever the order of
+  // the queries
+  otb::DEMTileCache::GetInstance()->Flush();
+  demHandler->UseTileCacheOn();
+  const double firstHeight = demHandler->GetHeightAboveMSL(lonLat[0], lonLat[1]);
+  bool success = DEMHandlerTileCacheTestCompare("First height above MSL", referenceMSL[0], firstHeight);
+  if (otb::DEMTileCache::GetInstance()->GetMemoryUsage() == 0)
+    {
+    std::cerr << "The queried tile was not decoded" << std::endl;
+    success = false;
+    }
+  if (demHandler->GetHeightAboveMSL(lonLat[0], lonLat[1]) != firstHeight)
+    {
+    std::cerr << "The height of a point depends on the order of the queries" << std::endl;
+    success = false;
+    }
+
+  // Heights from the tile cache, point by point and in batch
+  std::vector<double> batchMSL(nbPoints);
+  std::vector<double> batchEllipsoid(nbPoints);
+  demHandler->GetHeightsAboveMSL(&lonLat[0], &batchMSL[0], nbPoints);
+  demHandler->GetHeightsAboveEllipsoid(&lonLat[0], &batchEllipsoid[0], nbPoints);
+
+  for (unsigned long i = 0; i < nbPoints && success; ++i)
+    {
+    success = DEMHandlerTileCacheTestCompare("Height above MSL", referenceMSL[i],
+                                             demHandler->GetHeightAboveMSL(lonLat[2 * i], lonLat[2 * i + 1]))
+              && DEMHandlerTileCacheTestCompare("Batch height above MSL", referenceMSL[i], batchMSL[i])
+              && DEMHandlerTileCacheTestCompare("Batch height above ellipsoid", referenceEllipsoid[i], batchEllipsoid[i]);
+    }
+
+  // Concurrent queries, starting from an empty cache
+  otb::DEMTileCache::GetInstance()->Flush();
+  DEMHandlerTileCacheTestData data;
+  data.demHandler = demHandler;
+  data.lonLat = lonLat;
+  data.heights.resize(nbPoints);
+  data.nbThreads = 4;
+
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  threader->SetNumberOfThreads(data.nbThreads);
+  threader->SetSingleMethod(DEMHandlerTileCacheTestThread, &data);
+  threader->SingleMethodExecute();
+
+  for (unsigned long i = 0; i < nbPoints && success; ++i)
+    {
+    success = DEMHandlerTileCacheTestCompare("Concurrent height above ellipsoid", referenceEllipsoid[i],
+                                             data.heights[i]);
+    }
+
+  std::cout << otb::DEMTileCache::GetInstance() << std::endl;
+
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -27,4 +27,10 @@ void RegisterTests()
   REGISTER_TEST(otbStreamingImageFileWriterTestCalculateNumberOfDivisions);
   REGISTER_TEST(otbStreamingImageFileWriterWithFilterTest);
   REGISTER_TEST(otbStreamingWithImageFileWriterTestCalculateNumberOfDivisions);
+  REGISTER_TEST(otbStreamingImageFileWriterWriteBehindTest);
+  REGISTER_TEST(otbStreamingImageFileWriterConcurrentTest);
+  REGISTER_TEST(otbStreamingImageFileWriterErrorTest);
+  REGISTER_TEST(otbStreamingImageFileWriterPipelineErrorTest);
+  REGISTER_TEST(otbImageFileReaderPrefetchTest);
+  REGISTER_TEST(otbStreamingImageFileWriterOverviewsTest);
 }
@@ -26,6 +26,7 @@ void RegisterTests()
 {
   REGISTER_TEST(otbDEMHandlerNew);
   REGISTER_TEST(otbDEMHandlerTest);
+  REGISTER_TEST(otbDEMHandlerTileCacheTest);
   REGISTER_TEST(otbDEMToImageGeneratorNew);
   REGISTER_TEST(otbDEMToImageGeneratorTest);
   REGISTER_TEST(otbDEMToImageGeneratorFromImageTest);
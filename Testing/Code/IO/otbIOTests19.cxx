@@ -26,6 +26,7 @@ void RegisterTests()
 {
   REGISTER_TEST(otbImageFileReaderServerName);
   REGISTER_TEST(otbTileMapImageIOTest);
+  REGISTER_TEST(otbTileMapImageIOCacheTest);
   REGISTER_TEST(otbTileMapWriter);
   REGISTER_TEST(otbOSMToVectorDataGeneratorNew);
   REGISTER_TEST(otbOSMToVectorDataGeneratorTest);
@@ -0,0 +1,72 @@
+/*=========================================================================
+
+  Program:   ORFEO Toolbox
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+
+  Copyright (c) Centre National d'Etudes Spatiales. All rights reserved.
+  See OTBCopyright.txt for details.
+
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+
+#include "itkExceptionObject.h"
+#include <iostream>
+
+#include "otbVectorImage.h"
+#include "otbImageFileReader.h"
+#include "otbStreamingImageFileWriter.h"
+
+int otbImageFileReaderPrefetchTest(int argc, char* argv[])
+{
+  const char * inputFilename  = argv[1];
+  const char * outputFilename = argv[2];
+  std::string  streamingMode(argv[3]);
+  unsigned int streamingParameter = atoi(argv[4]);
+
+  typedef unsigned short PixelType;
+  const unsigned int Dimension = 2;
+
+  typedef otb::VectorImage<PixelType, Dimension>   ImageType;
+  typedef otb::ImageFileReader<ImageType>          ReaderType;
+  typedef otb::StreamingImageFileWriter<ImageType> StreamingWriterType;
+
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(inputFilename);
+  reader->PrefetchOn();
+
+  StreamingWriterType::Pointer writer = StreamingWriterType::New();
+  writer->SetFileName(outputFilename);
+  writer->SetInput(reader->GetOutput());
+
+  if (streamingMode == "stripped")
+    {
+    writer->SetNumberOfLinesStrippedStreaming(streamingParameter);
+    }
+  else if (streamingMode == "tiled")
+    {
+    writer->SetTileDimensionTiledStreaming(streamingParameter);
+    }
+  else
+    {
+    itkGenericExceptionMacro(<< "Parameter value not authorized !!!");
+    }
+
+  writer->Update();
+
+  // The regions are walked in order, so most of them must have been prefetched
+  std::cout << "Prefetch hits: " << reader->GetNumberOfPrefetchHits() << std::endl;
+  if (reader->GetNumberOfPrefetchHits() == 0)
+    {
+    std::cout << "No region was served from the prefetch buffer." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,82 @@
+/*=========================================================================
+
+  Program:   ORFEO Toolbox
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+
+  Copyright (c) Centre National d'Etudes Spatiales. All rights reserved.
+  See OTBCopyright.txt for details.
+
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+
+#include "itkExceptionObject.h"
+#include <iostream>
+#include <vector>
+
+#include "otbImage.h"
+#include "otbImageFileReader.h"
+#include "otbStreamingImageFileWriter.h"
+#include "itkMeanImageFilter.h"
+
+int otbStreamingImageFileWriterConcurrentTest(int argc, char* argv[])
+{
+  const char * inputFilename  = argv[1];
+  const char * serialOutputFilename = argv[2];
+  const char * concurrentOutputFilename = argv[3];
+  unsigned int tileDimension = atoi(argv[4]);
+  unsigned int nbConcurrentInputs = atoi(argv[5]);
+  unsigned int nbBuffers = atoi(argv[6]);
+
+  typedef float PixelType;
+  const unsigned int Dimension = 2;
+
+  typedef otb::Image<PixelType, Dimension>                 ImageType;
+  typedef otb::ImageFileReader<ImageType>                  ReaderType;
+  typedef itk::MeanImageFilter<ImageType, ImageType>       MeanFilterType;
+  typedef otb::StreamingImageFileWriter<ImageType>         StreamingWriterType;
+
+  // One independent pipeline for the serial writer, and one per
+  // concurrent division for the concurrent writer
+  std::vector<ReaderType::Pointer>     readers;
+  std::vector<MeanFilterType::Pointer> filters;
+  for (unsigned int i = 0; i < nbConcurrentInputs + 2; ++i)
+    {
+    ReaderType::Pointer reader = ReaderType::New();
+    reader->SetFileName(inputFilename);
+
+    MeanFilterType::Pointer filter = MeanFilterType::New();
+    ImageType::SizeType radius;
+    radius.Fill(2);
+    filter->SetRadius(radius);
+    filter->SetInput(reader->GetOutput());
+
+    readers.push_back(reader);
+    filters.push_back(filter);
+    }
+
+  StreamingWriterType::Pointer serialWriter = StreamingWriterType::New();
+  serialWriter->SetFileName(serialOutputFilename);
+  serialWriter->SetInput(filters[0]->GetOutput());
+  serialWriter->SetTileDimensionTiledStreaming(tileDimension);
+  serialWriter->Update();
+
+  StreamingWriterType::Pointer concurrentWriter = StreamingWriterType::New();
+  concurrentWriter->SetFileName(concurrentOutputFilename);
+  concurrentWriter->SetInput(filters[1]->GetOutput());
+  for (unsigned int i = 0; i < nbConcurrentInputs; ++i)
+    {
+    concurrentWriter->AddConcurrentInput(filters[i + 2]->GetOutput());
+    }
+  concurrentWriter->SetTileDimensionTiledStreaming(tileDimension);
+  concurrentWriter->SetNumberOfWriteBehindBuffers(nbBuffers);
+  concurrentWriter->Update();
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,259 @@
+/*=========================================================================
+
+  Program:   ORFEO Toolbox
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+
+  Copyright (c) Centre National d'Etudes Spatiales. All rights reserved.
+  See OTBCopyright.txt for details.
+
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#include "itkExceptionObject.h"
+#include <iostream>
+#include <new>
+#include <vector>
+#include <cstdlib>
+
+#include "itkImageIOBase.h"
+#include "itkShiftScaleImageFilter.h"
+#include "itkImageToImageFilter.h"
+#include "otbImage.h"
+#include "otbStreamingImageFileWriter.h"
+
+namespace otb
+{
+/** \class FailingImageIO
+ * ImageIO throwing a std::bad_alloc once a few regions have been written.
+ */
+class FailingImageIO : public itk::ImageIOBase
+{
+public:
+  typedef FailingImageIO                Self;
+  typedef itk::ImageIOBase              Superclass;
+  typedef itk::SmartPointer<Self>       Pointer;
+  typedef itk::SmartPointer<const Self> ConstPointer;
+
+  itkNewMacro(Self);
+  itkTypeMacro(FailingImageIO, itk::ImageIOBase);
+
+  virtual bool CanReadFile(const char*)
+  {
+    return false;
+  }
+  virtual void ReadImageInformation() {}
+  virtual void Read(void*) {}
+
+  virtual bool CanWriteFile(const char*)
+  {
+    return true;
+  }
+  virtual bool CanStreamWrite()
+  {
+    return true;
+  }
+  virtual void WriteImageInformation() {}
+  virtual void Write(const void*)
+  {
+    if (++m_NumberOfWrites > m_NumberOfSuccessfulWrites)
+      {
+      throw std::bad_alloc();
+      }
+  }
+
+  itkSetMacro(NumberOfSuccessfulWrites, unsigned int);
+  itkGetMacro(NumberOfWrites, unsigned int);
+
+protected:
+  FailingImageIO() : m_NumberOfWrites(0), m_NumberOfSuccessfulWrites(2) {}
+  virtual ~FailingImageIO() {}
+
+private:
+  FailingImageIO(const Self &); //purposely not implemented
+  void operator =(const Self&); //purposely not implemented
+
+  unsigned int m_NumberOfWrites;
+  unsigned int m_NumberOfSuccessfulWrites;
+};
+
+/** \class FailingImageFilter
+ * Copy the input, but throw once a few regions have been generated.
+ */
+template <class TImage>
+class ITK_EXPORT FailingImageFilter : public itk::ImageToImageFilter<TImage, TImage>
+{
+public:
+  typedef FailingImageFilter                      Self;
+  typedef itk::ImageToImageFilter<TImage, TImage> Superclass;
+  typedef itk::SmartPointer<Self>                 Pointer;
+  typedef itk::SmartPointer<const Self>           ConstPointer;
+
+  itkNewMacro(Self);
+  itkTypeMacro(FailingImageFilter, ImageToImageFilter);
+
+protected:
+  FailingImageFilter() : m_NumberOfRegions(0) {}
+  virtual ~FailingImageFilter() {}
+
+  virtual void GenerateData()
+  {
+    if (++m_NumberOfRegions > 2)
+      {
+      itkExceptionMacro(<< "Failing region " << m_NumberOfRegions);
+      }
+    this->AllocateOutputs();
+    this->GetOutput()->FillBuffer(3);
+  }
+
+private:
+  FailingImageFilter(const Self &); //purposely not implemented
+  void operator =(const Self&);     //purposely not implemented
+
+  unsigned int m_NumberOfRegions;
+};
+}
+
+// A std::exception thrown by the ImageIO in a writer thread must be
+// reported by Update() as an itk::ExceptionObject
+int otbStreamingImageFileWriterErrorTest(int argc, char* argv[])
+{
+  if (argc != 3)
+    {
+    std::cerr << "Usage: " << argv[0] << " nbConcurrentInputs nbWriteBehindBuffers" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const unsigned int nbConcurrentInputs = atoi(argv[1]);
+  const unsigned int nbWriteBehindBuffers = atoi(argv[2]);
+
+  typedef otb::Image<unsigned short, 2>                    ImageType;
+  typedef itk::ShiftScaleImageFilter<ImageType, ImageType> FilterType;
+  typedef otb::StreamingImageFileWriter<ImageType>         WriterType;
+
+  ImageType::RegionType region;
+  region.SetSize(0, 50);
+  region.SetSize(1, 100);
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(region);
+  image->Allocate();
+  image->FillBuffer(3);
+
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput(image);
+
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetFileName("failing.tif");
+  writer->SetImageIO(otb::FailingImageIO::New());
+  writer->SetInput(filter->GetOutput());
+  writer->SetNumberOfLinesStrippedStreaming(10);
+  writer->SetNumberOfWriteBehindBuffers(nbWriteBehindBuffers);
+
+  // Each concurrent pipeline is a copy of the filter
+  std::vector<FilterType::Pointer> copies;
+  for (unsigned int i = 0; i < nbConcurrentInputs; ++i)
+    {
+    FilterType::Pointer copy = FilterType::New();
+    copy->SetInput(image);
+    writer->AddConcurrentInput(copy->GetOutput());
+    copies.push_back(copy);
+    }
+
+  try
+    {
+    writer->Update();
+    }
+  catch (itk::ExceptionObject& err)
+    {
+    std::cout << "Expected exception: " << err.GetDescription() << std::endl;
+    return EXIT_SUCCESS;
+    }
+
+  std::cout << "The writing error has not been reported." << std::endl;
+  return EXIT_FAILURE;
+}
+
+// An exception of the upstream pipeline must stop the I/O thread before
+// leaving Update(), and leave the writer ready for another Update()
+int otbStreamingImageFileWriterPipelineErrorTest(int argc, char* argv[])
+{
+  if (argc != 2)
+    {
+    std::cerr << "Usage: " << argv[0] << " nbWriteBehindBuffers" << std::endl;
+    return EXIT_FAILURE;
+    }
+  const unsigned int nbWriteBehindBuffers = atoi(argv[1]);
+
+  typedef otb::Image<unsigned short, 2>             ImageType;
+  typedef otb::FailingImageFilter<ImageType>        FilterType;
+  typedef otb::StreamingImageFileWriter<ImageType>  WriterType;
+
+  ImageType::RegionType region;
+  region.SetSize(0, 50);
+  region.SetSize(1, 100);
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(region);
+  image->Allocate();
+  image->FillBuffer(3);
+
+  otb::FailingImageIO::Pointer imageIO = otb::FailingImageIO::New();
+  imageIO->SetNumberOfSuccessfulWrites(100);
+
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput(image);
+
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetFileName("failing.tif");
+  writer->SetImageIO(imageIO);
+  writer->SetInput(filter->GetOutput());
+  writer->SetNumberOfLinesStrippedStreaming(10);
+  writer->SetNumberOfWriteBehindBuffers(nbWriteBehindBuffers);
+
+  bool thrown = false;
+  try
+    {
+    writer->Update();
+    }
+  catch (itk::ExceptionObject& err)
+    {
+    std::cout << "Expected exception: " << err.GetDescription() << std::endl;
+    thrown = true;
+    }
+  if (!thrown)
+    {
+    std::cout << "The pipeline error has not been reported." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // The two regions generated before the error are written by the time
+  // Update() returns
+  if (imageIO->GetNumberOfWrites() != 2)
+    {
+    std::cout << "Wrote " << imageIO->GetNumberOfWrites()
+              << " regions before leaving Update(), expected 2." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // A second Update() of the same writer runs the pipeline again
+  filter->Modified();
+  thrown = false;
+  try
+    {
+    writer->Update();
+    }
+  catch (itk::ExceptionObject&)
+    {
+    thrown = true;
+    }
+  if (!thrown)
+    {
+    std::cout << "The writer did not run again after the error." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,136 @@
+/*=========================================================================
+
+  Program:   ORFEO Toolbox
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+
+  Copyright (c) Centre National d'Etudes Spatiales. All rights reserved.
+  See OTBCopyright.txt for details.
+
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+
+#include "itkExceptionObject.h"
+#include <iostream>
+#include <vector>
+
+#include "gdal_priv.h"
+
+#include "otbVectorImage.h"
+#include "otbImageFileReader.h"
+#include "otbStreamingImageFileWriter.h"
+
+int otbStreamingImageFileWriterOverviewsTest(int argc, char* argv[])
+{
+  const char * inputFilename  = argv[1];
+  const char * outputFilename = argv[2];
+  std::string  streamingMode  = argv[3];
+  unsigned int streamingParameter = atoi(argv[4]);
+  unsigned int nbOverviews = atoi(argv[5]);
+
+  typedef unsigned short PixelType;
+  const unsigned int Dimension = 2;
+
+  typedef otb::VectorImage<PixelType, Dimension>   ImageType;
+  typedef otb::ImageFileReader<ImageType>          ReaderType;
+  typedef otb::StreamingImageFileWriter<ImageType> StreamingWriterType;
+
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(inputFilename);
+
+  StreamingWriterType::Pointer writer = StreamingWriterType::New();
+  writer->SetFileName(outputFilename);
+  writer->SetInput(reader->GetOutput());
+  if (streamingMode == "tiled")
+    {
+    writer->SetTileDimensionTiledStreaming(streamingParameter);
+    }
+  else
+    {
+    writer->SetNumberOfLinesStrippedStreaming(streamingParameter);
+    }
+  writer->SetNumberOfOverviews(nbOverviews);
+  writer->Update();
+  writer = NULL;
+
+  // Check the overviews against the average of the full resolution pixels
+  GDALAllRegister();
+  GDALDataset* dataset = static_cast<GDALDataset*>(GDALOpen(outputFilename, GA_ReadOnly));
+  if (dataset == NULL)
+    {
+    std::cout << "Unable to open " << outputFilename << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const int width = dataset->GetRasterXSize();
+  const int height = dataset->GetRasterYSize();
+  int       nbErrors = 0;
+
+  for (int band = 1; band <= dataset->GetRasterCount(); ++band)
+    {
+    GDALRasterBand* fullBand = dataset->GetRasterBand(band);
+    if (fullBand->GetOverviewCount() != static_cast<int>(nbOverviews))
+      {
+      std::cout << "Band " << band << " has " << fullBand->GetOverviewCount() << " overviews" << std::endl;
+      ++nbErrors;
+      continue;
+      }
+
+    std::vector<double> full(width * height);
+    fullBand->RasterIO(GF_Read, 0, 0, width, height, &full[0], width, height, GDT_Float64, 0, 0);
+
+    for (unsigned int level = 0; level < nbOverviews; ++level)
+      {
+      const int       factor = 2 << level;
+      GDALRasterBand* overviewBand = fullBand->GetOverview(level);
+      const int       overviewWidth = overviewBand->GetXSize();
+      const int       overviewHeight = overviewBand->GetYSize();
+
+      std::vector<double> overview(overviewWidth * overviewHeight);
+      overviewBand->RasterIO(GF_Read, 0, 0, overviewWidth, overviewHeight, &overview[0],
+                             overviewWidth, overviewHeight, GDT_Float64, 0, 0);
+
+      for (int oy = 0; oy < overviewHeight; ++oy)
+        {
+        for (int ox = 0; ox < overviewWidth; ++ox)
+          {
+          double sum = 0.;
+          int    nbPixels = 0;
+          for (int y = oy * factor; y < std::min((oy + 1) * factor, height); ++y)
+            {
+            for (int x = ox * factor; x < std::min((ox + 1) * factor, width); ++x)
+              {
+              sum += full[y * width + x];
+              ++nbPixels;
+              }
+            }
+          const double expected = vcl_floor(sum / nbPixels + 0.5);
+          if (overview[oy * overviewWidth + ox] != expected)
+            {
+            if (nbErrors < 10)
+              {
+              std::cout << "Band " << band << ", overview " << level << " [" << ox << ", " << oy << "]: "
+                        << overview[oy * overviewWidth + ox] << " instead of " << expected << std::endl;
+              }
+            ++nbErrors;
+            }
+          }
+        }
+      }
+    }
+  GDALClose(dataset);
+
+  if (nbErrors > 0)
+    {
+    std::cout << nbErrors << " wrong overview pixels" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,51 @@
+/*=========================================================================
+
+  Program:   ORFEO Toolbox
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+
+  Copyright (c) Centre National d'Etudes Spatiales. All rights reserved.
+  See OTBCopyright.txt for details.
+
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+
+#include "itkExceptionObject.h"
+#include <iostream>
+
+#include "otbVectorImage.h"
+#include "otbImageFileReader.h"
+#include "otbStreamingImageFileWriter.h"
+
+int otbStreamingImageFileWriterWriteBehindTest(int argc, char* argv[])
+{
+  const char * inputFilename  = argv[1];
+  const char * outputFilename = argv[2];
+  unsigned int nbLinesPerStrip = atoi(argv[3]);
+  unsigned int nbBuffers = atoi(argv[4]);
+
+  typedef unsigned short PixelType;
+  const unsigned int Dimension = 2;
+
+  typedef otb::VectorImage<PixelType, Dimension>   ImageType;
+  typedef otb::ImageFileReader<ImageType>          ReaderType;
+  typedef otb::StreamingImageFileWriter<ImageType> StreamingWriterType;
+
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(inputFilename);
+
+  StreamingWriterType::Pointer writer = StreamingWriterType::New();
+  writer->SetFileName(outputFilename);
+  writer->SetInput(reader->GetOutput());
+  writer->SetNumberOfLinesStrippedStreaming(nbLinesPerStrip);
+  writer->SetNumberOfWriteBehindBuffers(nbBuffers);
+  writer->Update();
+
+  return EXIT_SUCCESS;
+}
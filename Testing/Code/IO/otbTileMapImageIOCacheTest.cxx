@@ -0,0 +1,241 @@
+/*=========================================================================
+
+  Program:   ORFEO Toolbox
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+
+  Copyright (c) Centre National d'Etudes Spatiales. All rights reserved.
+  See OTBCopyright.txt for details.
+
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+
+#include <cstdio>
+#include <sstream>
+#include "itksys/SystemTools.hxx"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "otbVectorImage.h"
+#include "otbImageFileReader.h"
+#include "otbImageFileWriter.h"
+#include "otbTileMapImageIO.h"
+#include "otbCurlHelperInterface.h"
+
+namespace otb
+{
+/** \class TileServerStandIn
+ * Local stand-in for the tile server: each OSM url "server/depth/x/y.png"
+ * is answered with a 4 bands tile encoding its coordinates.
+ */
+class TileServerStandIn : public CurlHelperInterface
+{
+public:
+  typedef TileServerStandIn             Self;
+  typedef CurlHelperInterface           Superclass;
+  typedef itk::SmartPointer<Self>       Pointer;
+  typedef itk::SmartPointer<const Self> ConstPointer;
+
+  itkTypeMacro(TileServerStandIn, CurlHelperInterface);
+  itkNewMacro(Self);
+
+  typedef VectorImage<unsigned char, 2> TileType;
+
+  virtual bool TestUrlAvailability(const std::string& url) const
+  {
+    return true;
+  }
+
+  virtual int RetrieveFile(const std::ostringstream& urlStream, std::string filename) const
+  {
+    return this->RetrieveFile(urlStream.str(), filename);
+  }
+
+  virtual int RetrieveFile(const std::string& urlString, std::string filename) const
+  {
+    ++m_NumberOfRequests;
+
+    long int depth, x, y;
+    std::string::size_type pos = urlString.rfind('/', urlString.rfind('/', urlString.rfind('/') - 1) - 1);
+    if (sscanf(urlString.c_str() + pos + 1, "%ld/%ld/%ld", &depth, &x, &y) != 3)
+      {
+      return 1;
+      }
+
+    TileType::RegionType region;
+    region.SetSize(0, 256);
+    region.SetSize(1, 256);
+    TileType::Pointer tile = TileType::New();
+    tile->SetRegions(region);
+    tile->SetNumberOfComponentsPerPixel(4);
+    tile->Allocate();
+
+    TileType::PixelType pixel(4);
+    TileType::IndexType index;
+    for (index[1] = 0; index[1] < 256; ++index[1])
+      {
+      for (index[0] = 0; index[0] < 256; ++index[0])
+        {
+        pixel[0] = x % 256;
+        pixel[1] = y % 256;
+        pixel[2] = (index[0] + index[1]) % 256;
+        pixel[3] = 255;
+        tile->SetPixel(index, pixel);
+        }
+      }
+
+    typedef ImageFileWriter<TileType> WriterType;
+    WriterType::Pointer writer = WriterType::New();
+    writer->SetFileName(filename);
+    writer->SetInput(tile);
+    writer->Update();
+    return 0;
+  }
+
+  virtual int RetrieveUrlInMemory(const std::string& urlString, std::string& output) const
+  {
+    return 1;
+  }
+
+  virtual int RetrieveFileMulti(const std::vector<std::string>& listURLs,
+                                const std::vector<std::string>& listFiles,
+                                int maxConnect) const
+  {
+    for (unsigned int i = 0; i < listURLs.size(); ++i)
+      {
+      this->RetrieveFile(listURLs[i], listFiles[i]);
+      }
+    return 0;
+  }
+
+  unsigned int GetNumberOfRequests() const
+  {
+    return m_NumberOfRequests;
+  }
+
+protected:
+  TileServerStandIn() : m_NumberOfRequests(0) {}
+  virtual ~TileServerStandIn() {}
+
+private:
+  TileServerStandIn(const Self &);  //purposely not implemented
+  void operator =(const Self&);  //purposely not implemented
+
+  mutable unsigned int m_NumberOfRequests;
+};
+}
+
+typedef otb::VectorImage<unsigned char, 2> TileMapImageType;
+
+// TileMap reader of the stand-in server, at depth 10
+static otb::TileMapImageIO::Pointer CreateTileMapImageIO(const std::string& cacheDirectory,
+                                                        otb::TileServerStandIn * server)
+{
+  otb::TileMapImageIO::Pointer tileIO = otb::TileMapImageIO::New();
+  tileIO->SetDepth(10);
+  tileIO->SetCacheDirectory(cacheDirectory);
+  tileIO->SetCurl(server);
+  return tileIO;
+}
+
+// Read a region starting in the given tile and check the tiles pattern
+static bool ReadAndCheckTileMapRegion(otb::TileMapImageIO * tileIO, long int tileX, long int tileY)
+{
+  typedef otb::ImageFileReader<TileMapImageType> ReaderType;
+
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetImageIO(tileIO);
+  reader->SetFileName("http://tile.openstreetmap.org/");
+  reader->UpdateOutputInformation();
+
+  TileMapImageType::RegionType region;
+  region.SetIndex(0, tileX * 256 + 100);
+  region.SetIndex(1, tileY * 256 + 50);
+  region.SetSize(0, 600);
+  region.SetSize(1, 400);
+  reader->GetOutput()->SetRequestedRegion(region);
+  reader->Update();
+
+  itk::ImageRegionConstIteratorWithIndex<TileMapImageType> it(reader->GetOutput(), region);
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+    TileMapImageType::IndexType index = it.GetIndex();
+    TileMapImageType::PixelType pixel = it.Get();
+    if (pixel[0] != (index[0] / 256) % 256 || pixel[1] != (index[1] / 256) % 256
+        || pixel[2] != (index[0] % 256 + index[1] % 256) % 256 || pixel[3] != 255)
+      {
+      std::cout << "Wrong pixel " << pixel << " at " << index << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+// Read a region and check the total number of requests to the server
+static bool CheckRequests(const char * name, otb::TileMapImageIO * tileIO, long int tileX, long int tileY,
+                          otb::TileServerStandIn * server, unsigned int expectedRequests)
+{
+  if (!ReadAndCheckTileMapRegion(tileIO, tileX, tileY))
+    {
+    return false;
+    }
+  std::cout << name << ": " << server->GetNumberOfRequests() << " requests" << std::endl;
+  return server->GetNumberOfRequests() == expectedRequests;
+}
+
+int otbTileMapImageIOCacheTest(int argc, char* argv[])
+{
+  if (argc != 2)
+    {
+    std::cout << argv[0] << " <cacheDirectory>" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::string cacheDirectory = argv[1];
+  itksys::SystemTools::RemoveADirectory(cacheDirectory.c_str());
+
+  otb::TileServerStandIn::Pointer server = otb::TileServerStandIn::New();
+
+  // First read fetches all the tiles: 4x3 tiles cover the region. A new
+  // reader must then find every tile in the packed cache
+  if (!CheckRequests("First read", CreateTileMapImageIO(cacheDirectory, server), 300, 400, server, 12)
+      || !CheckRequests("Second read", CreateTileMapImageIO(cacheDirectory, server), 300, 400, server, 12))
+    {
+    return EXIT_FAILURE;
+    }
+
+  // Two readers share a pack of at most 20 tiles, without memory cache
+  const std::string    sharedDirectory = cacheDirectory + "/shared";
+  const unsigned long  maximumPackSize = 20 * 256 * 256 * 4;
+  otb::TileMapImageIO::Pointer firstIO = CreateTileMapImageIO(sharedDirectory, server);
+  otb::TileMapImageIO::Pointer secondIO = CreateTileMapImageIO(sharedDirectory, server);
+  firstIO->SetMaximumPackSize(maximumPackSize);
+  secondIO->SetMaximumPackSize(maximumPackSize);
+  firstIO->SetMemoryCacheSize(0);
+  secondIO->SetMemoryCacheSize(0);
+
+  // The second reader finds the tiles packed by the first one, then packs
+  // new tiles beyond the maximum size: the pack is started again, and
+  // the first reader, whose index is obsolete, must fetch its tiles again
+  if (!CheckRequests("First shared read", firstIO, 300, 400, server, 24)
+      || !CheckRequests("Second reader, same region", secondIO, 300, 400, server, 24)
+      || !CheckRequests("Second reader, other region", secondIO, 500, 600, server, 36)
+      || !CheckRequests("First reader, first region", firstIO, 300, 400, server, 48))
+    {
+    return EXIT_FAILURE;
+    }
+
+  const unsigned long packSize =
+    itksys::SystemTools::FileLength((sharedDirectory + "/otb-tilemap.pack").c_str());
+  std::cout << "Pack size: " << packSize << " bytes" << std::endl;
+  if (packSize > maximumPackSize)
+    {
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
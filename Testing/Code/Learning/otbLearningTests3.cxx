@@ -31,6 +31,8 @@ void RegisterTests()
   REGISTER_TEST(otbSEMClassifierNew);
   REGISTER_TEST(otbSVMImageClassificationFilterNew);
   REGISTER_TEST(otbSVMImageClassificationFilter);
+  REGISTER_TEST(otbSVMBatchPredictorNew);
+  REGISTER_TEST(otbSVMBatchPredictorTest);
   REGISTER_TEST(otbSVMImageClassificationWithRuleFilterNew);
   REGISTER_TEST(otbSVMImageClassificationWithRuleFilter);
   REGISTER_TEST(otbSVMModelGenericKernelsTest);
@@ -40,6 +42,9 @@ void RegisterTests()
   REGISTER_TEST(otbSVMModelCopyComposedKernelTest);
   REGISTER_TEST(otbKMeansImageClassificationFilterNew);
   REGISTER_TEST(otbKMeansImageClassificationFilter);
+  REGISTER_TEST(otbNearestPrototypeSearchTest);
+  REGISTER_TEST(otbStreamingKMeansImageFilterNew);
+  REGISTER_TEST(otbStreamingKMeansImageFilter);
   REGISTER_TEST(otbSVMInverseCosSpectralAngleKernelFunctorImageModelEstimatorTest);
   REGISTER_TEST(otbSVMInverseCosSpectralAngleKernelFunctorImageClassificationTest);
 }
@@ -0,0 +1,110 @@
+/*=========================================================================
+
+  Program:   ORFEO Toolbox
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+
+  Copyright (c) Centre National d'Etudes Spatiales. All rights reserved.
+  See OTBCopyright.txt for details.
+
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+
+#include "otbNearestPrototypeSearch.h"
+#include "itkVariableLengthVector.h"
+#include "itkEuclideanDistance.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "vcl_cmath.h"
+#include <iostream>
+#include <vector>
+
+int otbNearestPrototypeSearchTest(int argc, char* argv[])
+{
+  typedef float                                                  PrototypeValueType;
+  typedef otb::NearestPrototypeSearch<PrototypeValueType>        SearchType;
+  typedef itk::VariableLengthVector<double>                      VectorType;
+  typedef itk::Statistics::EuclideanDistance<VectorType>         DistanceType;
+  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator GeneratorType;
+
+  GeneratorType::Pointer generator = GeneratorType::New();
+  generator->Initialize(12345);
+  DistanceType::Pointer distance = DistanceType::New();
+
+  if (!otb::NearestPrototypeSearchTraits<DistanceType>::IsEuclidean)
+    {
+    std::cout << "EuclideanDistance not recognized" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const unsigned int nbPrototypes = 50;
+  const unsigned int nbSamples = 200;
+
+  // Small integer values: the distances are exact and the ties frequent
+  for (unsigned int dimension = 1; dimension <= 13; ++dimension)
+    {
+    std::vector<PrototypeValueType> prototypes(nbPrototypes * dimension);
+    for (unsigned int i = 0; i < prototypes.size(); ++i)
+      {
+      prototypes[i] = generator->GetIntegerVariate(4);
+      }
+    std::vector<double> samples(nbSamples * dimension);
+    for (unsigned int i = 0; i < samples.size(); ++i)
+      {
+      samples[i] = generator->GetIntegerVariate(4);
+      }
+
+    SearchType search;
+    search.SetPrototypes(&prototypes[0], nbPrototypes, dimension);
+
+    for (unsigned int lastOnTie = 0; lastOnTie < 2; ++lastOnTie)
+      {
+      search.SetLastOnTie(lastOnTie == 1);
+
+      std::vector<unsigned int> nearest(nbSamples);
+      search.FindNearest(&samples[0], nbSamples, &nearest[0]);
+
+      VectorType sample(dimension), prototype(dimension);
+      for (unsigned int n = 0; n < nbSamples; ++n)
+        {
+        // Exhaustive search
+        for (unsigned int i = 0; i < dimension; ++i)
+          {
+          sample[i] = samples[n * dimension + i];
+          }
+        unsigned int winner = 0;
+        double       minDistance = itk::NumericTraits<double>::max();
+        for (unsigned int k = 0; k < nbPrototypes; ++k)
+          {
+          for (unsigned int i = 0; i < dimension; ++i)
+            {
+            prototype[i] = prototypes[k * dimension + i];
+            }
+          double d = distance->Evaluate(sample, prototype);
+          if (d < minDistance || (lastOnTie && d == minDistance))
+            {
+            minDistance = d;
+            winner = k;
+            }
+          }
+
+        double       squaredDistance;
+        unsigned int single = search.FindNearest(&samples[n * dimension], n % nbPrototypes, &squaredDistance);
+        if (nearest[n] != winner || single != winner
+            || vcl_abs(vcl_sqrt(squaredDistance) - minDistance) > 1e-12)
+          {
+          std::cout << "Dimension " << dimension << ", sample " << n << ": winner " << nearest[n]
+                    << " (" << single << ") instead of " << winner << std::endl;
+          return EXIT_FAILURE;
+          }
+        }
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
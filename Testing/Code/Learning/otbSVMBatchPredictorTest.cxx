@@ -0,0 +1,142 @@
+/*=========================================================================
+
+  Program:   ORFEO Toolbox
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+
+  Copyright (c) Centre National d'Etudes Spatiales. All rights reserved.
+  See OTBCopyright.txt for details.
+
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+
+#include "otbSVMBatchPredictor.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include <iostream>
+
+int otbSVMBatchPredictorNew(int argc, char* argv[])
+{
+  typedef otb::SVMBatchPredictor<double, unsigned short> PredictorType;
+
+  // Instantiating object
+  PredictorType::Pointer predictor = PredictorType::New();
+
+  std::cout << predictor << std::endl;
+
+  return EXIT_SUCCESS;
+}
+
+namespace
+{
+typedef double                                         ValueType;
+typedef int                                            LabelType;
+typedef otb::SVMModel<ValueType, LabelType>            ModelType;
+typedef otb::SVMBatchPredictor<ValueType, LabelType>   PredictorType;
+typedef itk::Statistics::MersenneTwisterRandomVariateGenerator GeneratorType;
+
+/** Count the samples whose label differs from SVMModel::EvaluateLabel() one */
+unsigned int CountPredictionErrors(const ModelType * model, const std::vector<ValueType>& samples,
+                                   unsigned int nbFeatures)
+{
+  PredictorType::Pointer predictor = PredictorType::New();
+  predictor->SetModel(model);
+
+  const unsigned int     nbSamples = samples.size() / nbFeatures;
+  std::vector<LabelType> labels(nbSamples);
+  predictor->PredictLabels(&samples[0], nbSamples, nbFeatures, &labels[0]);
+
+  unsigned int nbErrors = 0;
+  for (unsigned int i = 0; i < nbSamples; ++i)
+    {
+    ModelType::MeasurementType measure(samples.begin() + i * nbFeatures, samples.begin() + (i + 1) * nbFeatures);
+    if (labels[i] != model->EvaluateLabel(measure))
+      {
+      ++nbErrors;
+      }
+    }
+  return nbErrors;
+}
+}
+
+int otbSVMBatchPredictorTest(int argc, char* argv[])
+{
+  const unsigned int nbFeatures = 4;
+  const unsigned int nbClasses = 3;
+  // Not a multiple of the block size
+  const unsigned int nbSamples = 1000;
+
+  GeneratorType::Pointer generator = GeneratorType::New();
+  generator->Initialize(12345);
+
+  std::vector<ValueType> samples;
+  for (unsigned int i = 0; i < nbSamples * nbFeatures; ++i)
+    {
+    samples.push_back(generator->GetUniformVariate(0., 255.));
+    }
+
+  bool success = true;
+
+  // Model loaded from file
+  ModelType::Pointer loadedModel = ModelType::New();
+  loadedModel->LoadModel(argv[1]);
+  unsigned int nbErrors = CountPredictionErrors(loadedModel, samples, nbFeatures);
+  std::cout << "Loaded model: " << nbErrors << " errors" << std::endl;
+  success = success && (nbErrors == 0);
+
+  // Models trained on gaussian clusters, for each kernel
+  const int kernels[] = {LINEAR, POLY, RBF, SIGMOID};
+  const int svmTypes[] = {C_SVC, ONE_CLASS, EPSILON_SVR};
+
+  for (unsigned int t = 0; t < 3; ++t)
+    {
+    for (unsigned int k = 0; k < 4; ++k)
+      {
+      ModelType::Pointer model = ModelType::New();
+      model->SetSVMType(svmTypes[t]);
+      model->SetKernelType(kernels[k]);
+      model->SetPolynomialKernelDegree(3);
+      model->SetKernelGamma(1. / (255. * 255. * nbFeatures));
+      model->SetKernelCoef0(1.);
+
+      for (unsigned int i = 0; i < 300; ++i)
+        {
+        LabelType                  label = i % nbClasses;
+        ModelType::MeasurementType measure;
+        for (unsigned int f = 0; f < nbFeatures; ++f)
+          {
+          measure.push_back(generator->GetNormalVariate(80. * label + 40. * (f % 2), 900.));
+          }
+        model->AddSample(measure, label);
+        }
+      model->Train();
+
+      nbErrors = CountPredictionErrors(model, samples, nbFeatures);
+      std::cout << "SVM type " << svmTypes[t] << ", kernel " << kernels[k] << ": " << nbErrors << " errors"
+                << std::endl;
+
+      // Hyperplanes of the linear kernel are only equal up to rounding
+      if (kernels[k] == LINEAR)
+        {
+        success = success && (nbErrors <= nbSamples / 100);
+        }
+      else
+        {
+        success = success && (nbErrors == 0);
+        }
+      }
+    }
+
+  if (!success)
+    {
+    std::cerr << "Batch prediction differs from SVMModel::EvaluateLabel()" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
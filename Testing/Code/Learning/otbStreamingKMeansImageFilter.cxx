@@ -0,0 +1,191 @@
+/*=========================================================================
+
+  Program:   ORFEO Toolbox
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+
+  Copyright (c) Centre National d'Etudes Spatiales. All rights reserved.
+  See OTBCopyright.txt for details.
+
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+
+#include "otbStreamingKMeansImageFilter.h"
+#include "otbVectorImage.h"
+#include "otbImage.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "vcl_cmath.h"
+#include <iostream>
+#include <algorithm>
+
+namespace
+{
+typedef otb::VectorImage<unsigned short, 2>             ImageType;
+typedef otb::Image<unsigned char, 2>                    MaskType;
+typedef otb::StreamingKMeansImageFilter<ImageType, MaskType> KMeansFilterType;
+typedef KMeansFilterType::CentroidsType                 CentroidsType;
+
+const unsigned int NbBands = 3;
+const unsigned int NbClusters = 3;
+const double       Centers[NbClusters][NbBands] = {{10, 10, 10}, {50, 20, 80}, {90, 90, 30}};
+
+unsigned int ClusterOf(const ImageType::IndexType& index)
+{
+  return (index[0] / 20 + index[1] / 15) % NbClusters;
+}
+
+// Three clusters of pixels, with a zero mean noise
+ImageType::Pointer GenerateImage()
+{
+  ImageType::RegionType region;
+  region.SetSize(0, 120);
+  region.SetSize(1, 90);
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(region);
+  image->SetNumberOfComponentsPerPixel(NbBands);
+  image->Allocate();
+
+  ImageType::PixelType pixel(NbBands);
+  itk::ImageRegionIteratorWithIndex<ImageType> it(image, region);
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+    const ImageType::IndexType index = it.GetIndex();
+    for (unsigned int b = 0; b < NbBands; ++b)
+      {
+      const int noise = static_cast<int>((index[0] + 2 * index[1] + b) % 5) - 2;
+      pixel[b] = static_cast<unsigned short>(Centers[ClusterOf(index)][b] + noise);
+      }
+    it.Set(pixel);
+    }
+  return image;
+}
+
+// Compare the estimated centroids to the expected ones, in any order
+bool CheckCentroids(const CentroidsType& centroids, const std::vector<unsigned int>& expected, double tolerance)
+{
+  if (centroids.Size() != expected.size() * NbBands)
+    {
+    std::cout << "Wrong number of centroids: " << centroids << std::endl;
+    return false;
+    }
+  for (unsigned int e = 0; e < expected.size(); ++e)
+    {
+    bool found = false;
+    for (unsigned int k = 0; k < expected.size() && !found; ++k)
+      {
+      double distance = 0.;
+      for (unsigned int b = 0; b < NbBands; ++b)
+        {
+        distance = std::max(distance, vcl_abs(centroids[k * NbBands + b] - Centers[expected[e]][b]));
+        }
+      found = distance <= tolerance;
+      }
+    if (!found)
+      {
+      std::cout << "Cluster " << expected[e] << " not found in " << centroids << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+}
+
+int otbStreamingKMeansImageFilterNew(int argc, char* argv[])
+{
+  KMeansFilterType::Pointer filter = KMeansFilterType::New();
+
+  std::cout << filter << std::endl;
+
+  return EXIT_SUCCESS;
+}
+
+int otbStreamingKMeansImageFilter(int argc, char* argv[])
+{
+  ImageType::Pointer image = GenerateImage();
+
+  std::vector<unsigned int> allClusters;
+  for (unsigned int k = 0; k < NbClusters; ++k)
+    {
+    allClusters.push_back(k);
+    }
+
+  // Mini-batch estimation, with the initialization pass
+  KMeansFilterType::Pointer miniBatch = KMeansFilterType::New();
+  miniBatch->SetInput(image);
+  miniBatch->SetNumberOfClasses(NbClusters);
+  miniBatch->GetStreamer()->SetNumberOfDivisionsStrippedStreaming(6);
+  miniBatch->Update();
+  std::cout << "Mini-batch: " << miniBatch->GetNumberOfIterations() << " passes, centroids "
+            << miniBatch->GetCentroids() << std::endl;
+  if (!CheckCentroids(miniBatch->GetCentroids(), allClusters, 0.5)
+      || miniBatch->GetNumberOfSamples() != 120 * 90)
+    {
+    return EXIT_FAILURE;
+    }
+
+  // Lloyd iterations, from given centroids, do not depend on the streaming
+  const double  initialValues[NbClusters * NbBands] = {5, 5, 5, 40, 30, 70, 95, 80, 40};
+  CentroidsType initialCentroids(NbClusters * NbBands);
+  std::copy(initialValues, initialValues + NbClusters * NbBands, initialCentroids.begin());
+
+  CentroidsType centroids[2];
+  const unsigned int nbDivisions[2] = {1, 7};
+  for (unsigned int i = 0; i < 2; ++i)
+    {
+    KMeansFilterType::Pointer lloyd = KMeansFilterType::New();
+    lloyd->SetInput(image);
+    lloyd->SetNumberOfClasses(NbClusters);
+    lloyd->SetCentroids(initialCentroids);
+    lloyd->MiniBatchOff();
+    lloyd->SetSubsampleFactor(2);
+    lloyd->GetStreamer()->SetNumberOfDivisionsStrippedStreaming(nbDivisions[i]);
+    lloyd->Update();
+    centroids[i] = lloyd->GetCentroids();
+    std::cout << "Lloyd, " << nbDivisions[i] << " divisions: " << lloyd->GetNumberOfIterations()
+              << " passes, centroids " << centroids[i] << std::endl;
+    if (lloyd->GetNumberOfSamples() != 60 * 45)
+      {
+      std::cout << "Wrong number of samples: " << lloyd->GetNumberOfSamples() << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+  if (centroids[0] != centroids[1] || !CheckCentroids(centroids[0], allClusters, 0.5))
+    {
+    return EXIT_FAILURE;
+    }
+
+  // Masked pixels are ignored
+  MaskType::Pointer mask = MaskType::New();
+  mask->SetRegions(image->GetLargestPossibleRegion());
+  mask->Allocate();
+  itk::ImageRegionIteratorWithIndex<MaskType> maskIt(mask, mask->GetLargestPossibleRegion());
+  for (maskIt.GoToBegin(); !maskIt.IsAtEnd(); ++maskIt)
+    {
+    maskIt.Set(ClusterOf(maskIt.GetIndex()) == 1 ? 0 : 255);
+    }
+
+  KMeansFilterType::Pointer masked = KMeansFilterType::New();
+  masked->SetInput(image);
+  masked->SetInputMask(mask);
+  masked->SetNumberOfClasses(2);
+  masked->GetStreamer()->SetNumberOfDivisionsStrippedStreaming(4);
+  masked->Update();
+  std::cout << "Masked: " << masked->GetNumberOfIterations() << " passes, centroids "
+            << masked->GetCentroids() << std::endl;
+
+  std::vector<unsigned int> unmaskedClusters;
+  unmaskedClusters.push_back(0);
+  unmaskedClusters.push_back(2);
+  if (!CheckCentroids(masked->GetCentroids(), unmaskedClusters, 0.5))
+    {
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
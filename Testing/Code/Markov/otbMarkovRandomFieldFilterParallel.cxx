@@ -0,0 +1,161 @@
+/*=========================================================================
+
+  Program:   ORFEO Toolbox
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+
+  Copyright (c) Centre National d'Etudes Spatiales. All rights reserved.
+  See OTBCopyright.txt for details.
+
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#include "otbImageFileReader.h"
+#include "otbImage.h"
+#include "otbMarkovRandomFieldFilter.h"
+#include "itkStreamingImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+
+#include "otbMRFEnergyPotts.h"
+#include "otbMRFEnergyGaussianClassification.h"
+#include "otbMRFOptimizerMetropolis.h"
+#include "otbMRFSamplerRandom.h"
+
+const unsigned int Dimension = 2;
+
+typedef double                                   InternalPixelType;
+typedef unsigned char                            LabelledPixelType;
+typedef otb::Image<InternalPixelType, Dimension> InputImageType;
+typedef otb::Image<LabelledPixelType, Dimension> LabelledImageType;
+
+typedef otb::MarkovRandomFieldFilter<InputImageType, LabelledImageType>         MarkovRandomFieldFilterType;
+typedef otb::MRFSamplerRandom<InputImageType, LabelledImageType>                SamplerType;
+typedef otb::MRFOptimizerMetropolis                                             OptimizerType;
+typedef otb::MRFEnergyPotts<LabelledImageType, LabelledImageType>               EnergyRegularizationType;
+typedef otb::MRFEnergyGaussianClassification<InputImageType, LabelledImageType> EnergyFidelityType;
+
+MarkovRandomFieldFilterType::Pointer CreateParallelMarkovFilter(InputImageType * input,
+                                                                unsigned int nbIterations,
+                                                                int nbThreads)
+{
+  MarkovRandomFieldFilterType::Pointer markovFilter         = MarkovRandomFieldFilterType::New();
+  EnergyRegularizationType::Pointer    energyRegularization = EnergyRegularizationType::New();
+  EnergyFidelityType::Pointer          energyFidelity       = EnergyFidelityType::New();
+  OptimizerType::Pointer               optimizer            = OptimizerType::New();
+  SamplerType::Pointer                 sampler              = SamplerType::New();
+
+  markovFilter->InitializeSeed(2);
+
+  unsigned int nClass = 4;
+  energyFidelity->SetNumberOfParameters(2 * nClass);
+  EnergyFidelityType::ParametersType parameters;
+  parameters.SetSize(energyFidelity->GetNumberOfParameters());
+  parameters[0] = 10.0; //Class 0 mean
+  parameters[1] = 10.0; //Class 0 stdev
+  parameters[2] = 80.0; //Class 1 mean
+  parameters[3] = 10.0; //Class 1 stdev
+  parameters[4] = 150.0; //Class 2 mean
+  parameters[5] = 10.0; //Class 2 stdev
+  parameters[6] = 220.0; //Class 3 mean
+  parameters[7] = 10.0; //Class 3 stde
+  energyFidelity->SetParameters(parameters);
+
+  optimizer->SetSingleParameter(1.0);
+  markovFilter->SetNumberOfClasses(nClass);
+  markovFilter->SetMaximumNumberOfIterations(nbIterations);
+  markovFilter->SetErrorTolerance(0.0);
+  markovFilter->SetLambda(1.0);
+  markovFilter->SetNeighborhoodRadius(1);
+  markovFilter->ParallelUpdateOn();
+  markovFilter->SetNumberOfThreads(nbThreads);
+
+  markovFilter->SetEnergyRegularization(energyRegularization);
+  markovFilter->SetEnergyFidelity(energyFidelity);
+  markovFilter->SetOptimizer(optimizer);
+  markovFilter->SetSampler(sampler);
+
+  markovFilter->SetInput(input);
+
+  return markovFilter;
+}
+
+unsigned long CountDifferences(const LabelledImageType * image1, const LabelledImageType * image2)
+{
+  typedef itk::ImageRegionConstIterator<LabelledImageType> IteratorType;
+  IteratorType  it1(image1, image1->GetLargestPossibleRegion());
+  IteratorType  it2(image2, image2->GetLargestPossibleRegion());
+  unsigned long nbDifferences = 0;
+  for (it1.GoToBegin(), it2.GoToBegin(); !it1.IsAtEnd(); ++it1, ++it2)
+    {
+    if (it1.Get() != it2.Get())
+      {
+      ++nbDifferences;
+      }
+    }
+  return nbDifferences;
+}
+
+int otbMarkovRandomFieldFilterParallel(int argc, char* argv[])
+{
+  typedef otb::ImageFileReader<InputImageType> ReaderType;
+
+  const char *       inputFilename  = argv[1];
+  const unsigned int nbIterations   = atoi(argv[2]);
+
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(inputFilename);
+  reader->Update();
+
+  // The result of the graph-coloring update must not depend on the
+  // number of threads
+  MarkovRandomFieldFilterType::Pointer singleThreadFilter =
+    CreateParallelMarkovFilter(reader->GetOutput(), nbIterations, 1);
+  singleThreadFilter->Update();
+
+  MarkovRandomFieldFilterType::Pointer multiThreadFilter =
+    CreateParallelMarkovFilter(reader->GetOutput(), nbIterations, 4);
+  multiThreadFilter->Update();
+
+  unsigned long nbDifferences = CountDifferences(singleThreadFilter->GetOutput(), multiThreadFilter->GetOutput());
+  if (nbDifferences != 0)
+    {
+    std::cerr << nbDifferences << " pixels differ between 1 and 4 threads." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // With a halo covering the whole image, the tiled mode must give the
+  // same result as the whole image processing
+  const InputImageType::SizeType size = reader->GetOutput()->GetLargestPossibleRegion().GetSize();
+
+  MarkovRandomFieldFilterType::Pointer tiledFilter =
+    CreateParallelMarkovFilter(reader->GetOutput(), nbIterations, 4);
+  tiledFilter->StreamingOn();
+  tiledFilter->SetHaloRadius(std::max(size[0], size[1]));
+
+  typedef itk::StreamingImageFilter<LabelledImageType, LabelledImageType> StreamingFilterType;
+  StreamingFilterType::Pointer streamer = StreamingFilterType::New();
+  streamer->SetInput(tiledFilter->GetOutput());
+  streamer->SetNumberOfStreamDivisions(4);
+  streamer->Update();
+
+  nbDifferences = CountDifferences(singleThreadFilter->GetOutput(), streamer->GetOutput());
+  if (nbDifferences != 0)
+    {
+    std::cerr << nbDifferences << " pixels differ between whole image and tiled processing." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // With a narrow halo, each tile is regularized on its own
+  tiledFilter->SetHaloRadius(4);
+  streamer->Update();
+
+  nbDifferences = CountDifferences(singleThreadFilter->GetOutput(), streamer->GetOutput());
+  std::cout << nbDifferences << " pixels differ with a halo of 4 pixels." << std::endl;
+
+  return EXIT_SUCCESS;
+}
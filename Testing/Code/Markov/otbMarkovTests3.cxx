@@ -26,4 +26,5 @@ void RegisterTests()
 {
   REGISTER_TEST(otbMRFEnergyFisherClassificationNew);
   REGISTER_TEST(otbMRFEnergyFisherClassification);
+  REGISTER_TEST(otbMarkovRandomFieldFilterParallel);
 }
@@ -53,4 +53,5 @@ REGISTER_TEST(otbVectorDataToLabelMapFilterNew);
 REGISTER_TEST(otbVectorDataToLabelMapFilter);
 REGISTER_TEST(otbStreamingConnectedComponentSegmentationOBIAToVectorDataFilterNew);
 REGISTER_TEST(otbStreamingConnectedComponentSegmentationOBIAToVectorDataFilter);
+REGISTER_TEST(otbStreamingConnectedComponentSegmentationOBIAToVectorDataFilterMergeSeams);
 }
@@ -21,6 +21,7 @@
 #include "otbImageFileReader.h"
 #include "otbVectorDataFileWriter.h"
 #include "otbStreamingConnectedComponentSegmentationOBIAToVectorDataFilter.h"
+#include "itkPreOrderTreeIterator.h"
 
 typedef float InputPixelType;
 const unsigned int Dimension = 2;
@@ -82,3 +83,69 @@ int otbStreamingConnectedComponentSegmentationOBIAToVectorDataFilter(int argc, c
 
   return EXIT_SUCCESS;
 }
+
+void ComputePolygonStatistics(const VectorDataType * vectorData, unsigned int& nbPolygons, double& area)
+{
+  typedef itk::PreOrderTreeIterator<VectorDataType::DataTreeType> TreeIteratorType;
+  TreeIteratorType it(vectorData->GetDataTree());
+
+  nbPolygons = 0;
+  area = 0.;
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+    if (it.Get()->IsPolygonFeature())
+      {
+      ++nbPolygons;
+      area += it.Get()->GetPolygonExteriorRing()->GetArea();
+      }
+    }
+}
+
+int otbStreamingConnectedComponentSegmentationOBIAToVectorDataFilterMergeSeams(int argc, char * argv[])
+{
+  const char * inputFilename          = argv[1];
+  const char * maskexpression         = argv[2];
+  const char * segmentationexpression = argv[3];
+  unsigned int nbstreams              = atoi(argv[4]);
+
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(inputFilename);
+  reader->UpdateOutputInformation();
+
+  // Reference: the whole image in a single tile
+  ConnectedComponentSegmentationOBIAToVectorDataFilterType::FilterType::Pointer reference
+    = ConnectedComponentSegmentationOBIAToVectorDataFilterType::FilterType::New();
+  reference->GetFilter()->SetInput(reader->GetOutput());
+  reference->GetFilter()->SetMaskExpression(maskexpression);
+  reference->GetFilter()->SetConnectedComponentExpression(segmentationexpression);
+  reference->GetFilter()->SetMinimumObjectSize(0);
+  reference->GetStreamer()->SetNumberOfDivisionsStrippedStreaming(1);
+  reference->Update();
+
+  // Streamed segmentation with the pieces merged across the seams
+  ConnectedComponentSegmentationOBIAToVectorDataFilterType::FilterType::Pointer connected
+    = ConnectedComponentSegmentationOBIAToVectorDataFilterType::FilterType::New();
+  connected->GetFilter()->SetInput(reader->GetOutput());
+  connected->GetFilter()->SetMaskExpression(maskexpression);
+  connected->GetFilter()->SetConnectedComponentExpression(segmentationexpression);
+  connected->GetFilter()->SetMinimumObjectSize(0);
+  connected->GetFilter()->MergeSeamsOn();
+  connected->GetStreamer()->SetNumberOfDivisionsStrippedStreaming(nbstreams);
+  connected->Update();
+
+  unsigned int referenceNbPolygons, nbPolygons;
+  double       referenceArea, area;
+  ComputePolygonStatistics(reference->GetFilter()->GetOutputVectorData(), referenceNbPolygons, referenceArea);
+  ComputePolygonStatistics(connected->GetFilter()->GetOutputVectorData(), nbPolygons, area);
+
+  std::cout << "Single tile: " << referenceNbPolygons << " polygons, area " << referenceArea << std::endl;
+  std::cout << nbstreams << " tiles: " << nbPolygons << " polygons, area " << area << std::endl;
+
+  if (nbPolygons != referenceNbPolygons || vcl_abs(area - referenceArea) > 1e-6 * referenceArea)
+    {
+    std::cerr << "The streamed segmentation differs from the single tile one." << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,124 @@
+/*=========================================================================
+
+  Program:   ORFEO Toolbox
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+
+  Copyright (c) Centre National d'Etudes Spatiales. All rights reserved.
+  See OTBCopyright.txt for details.
+
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+
+#include <cmath>
+#include <vector>
+
+#include "otbVectorImage.h"
+#include "otbImageFileReader.h"
+#include "otbGenericRSTransform.h"
+#include <ogr_spatialref.h>
+
+int otbGenericRSTransformTransformPoints(int argc, char* argv[])
+{
+  /*
+   * This test checks that the batch TransformPoints() method gives the same
+   * results as the point-wise TransformPoint() method, in both directions.
+   */
+  typedef otb::VectorImage<double, 2>     ImageType;
+  typedef otb::ImageFileReader<ImageType> ReaderType;
+  typedef otb::GenericRSTransform<>       TransformType;
+  typedef TransformType::InputPointType   PointType;
+
+  const unsigned int gridSize = 20;
+  const double       tolerance = 1e-9;
+
+  // Reader
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+  reader->UpdateOutputInformation();
+
+  // Build wgs ref
+  OGRSpatialReference oSRS;
+  oSRS.SetWellKnownGeogCS("WGS84");
+  char * wgsRef = NULL;
+  oSRS.exportToWkt(&wgsRef);
+
+  // Instanciate Image->WGS transform
+  TransformType::Pointer img2wgs = TransformType::New();
+  img2wgs->SetInputProjectionRef(reader->GetOutput()->GetProjectionRef());
+  img2wgs->SetInputKeywordList(reader->GetOutput()->GetImageKeywordlist());
+  img2wgs->SetOutputProjectionRef(wgsRef);
+  img2wgs->InstanciateTransform();
+
+  // Instanciate WGS->Image transform
+  TransformType::Pointer wgs2img = TransformType::New();
+  wgs2img->SetInputProjectionRef(wgsRef);
+  wgs2img->SetOutputProjectionRef(reader->GetOutput()->GetProjectionRef());
+  wgs2img->SetOutputKeywordList(reader->GetOutput()->GetImageKeywordlist());
+  wgs2img->InstanciateTransform();
+
+  // Regular grid of image points
+  ImageType::SizeType size = reader->GetOutput()->GetLargestPossibleRegion().GetSize();
+  const unsigned int  nbPoints = gridSize * gridSize;
+  std::vector<double> imgPoints(2 * nbPoints);
+  for (unsigned int j = 0; j < gridSize; ++j)
+    {
+    for (unsigned int i = 0; i < gridSize; ++i)
+      {
+      imgPoints[2 * (j * gridSize + i)]     = static_cast<double>(i * size[0]) / gridSize;
+      imgPoints[2 * (j * gridSize + i) + 1] = static_cast<double>(j * size[1]) / gridSize;
+      }
+    }
+
+  std::vector<double> geoPoints(2 * nbPoints);
+  img2wgs->TransformPoints(&imgPoints[0], &geoPoints[0], nbPoints);
+
+  std::vector<double> backPoints(2 * nbPoints);
+  wgs2img->TransformPoints(&geoPoints[0], &backPoints[0], nbPoints);
+
+  bool pass = true;
+
+  for (unsigned int k = 0; k < nbPoints; ++k)
+    {
+    PointType imgPoint, geoPoint, backPoint;
+    imgPoint[0] = imgPoints[2 * k];
+    imgPoint[1] = imgPoints[2 * k + 1];
+    geoPoint = img2wgs->TransformPoint(imgPoint);
+
+    if (vcl_abs(geoPoint[0] - geoPoints[2 * k]) > tolerance
+        || vcl_abs(geoPoint[1] - geoPoints[2 * k + 1]) > tolerance)
+      {
+      std::cerr << "Forward mismatch at " << imgPoint << ": TransformPoint gives " << geoPoint
+                << ", TransformPoints gives [" << geoPoints[2 * k] << ", " << geoPoints[2 * k + 1] << "]" << std::endl;
+      pass = false;
+      }
+
+    geoPoint[0] = geoPoints[2 * k];
+    geoPoint[1] = geoPoints[2 * k + 1];
+    backPoint = wgs2img->TransformPoint(geoPoint);
+
+    if (vcl_abs(backPoint[0] - backPoints[2 * k]) > tolerance
+        || vcl_abs(backPoint[1] - backPoints[2 * k + 1]) > tolerance)
+      {
+      std::cerr << "Inverse mismatch at " << geoPoint << ": TransformPoint gives " << backPoint
+                << ", TransformPoints gives [" << backPoints[2 * k] << ", " << backPoints[2 * k + 1] << "]" << std::endl;
+      pass = false;
+      }
+    }
+
+  // An empty batch must be a no-op
+  img2wgs->TransformPoints(&imgPoints[0], &geoPoints[0], 0);
+
+  if (!pass)
+    {
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -32,6 +32,7 @@ void RegisterTests()
   REGISTER_TEST(otbGenericRSTransform);
   REGISTER_TEST(otbGenericRSTransformWithSRID);
   REGISTER_TEST(otbGenericRSTransformFromImage);
+  REGISTER_TEST(otbGenericRSTransformTransformPoints);
   REGISTER_TEST(otbGenericRSTransformImageAndMNTToWGS84ConversionChecking);
   REGISTER_TEST(otbVectorDataProjectionFilterNew);
   REGISTER_TEST(otbVectorDataProjectionFilter);
@@ -34,6 +34,7 @@ void RegisterTests()
   REGISTER_TEST(otbImageToGenericRSOutputParameters);
   REGISTER_TEST(otbRationalTransformNew);
   REGISTER_TEST(otbRationalTransform);
+  REGISTER_TEST(otbRationalTransformTransformPoints);
   REGISTER_TEST(otbGeographicalDistanceNew);
   REGISTER_TEST(otbGeographicalDistance);
   REGISTER_TEST(otbVectorDataTransformFilterNew);
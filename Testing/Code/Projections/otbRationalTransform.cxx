@@ -19,6 +19,8 @@
 
 #include "otbRationalTransform.h"
 #include <fstream>
+#include <vector>
+#include "vcl_cmath.h"
 
 int otbRationalTransformNew(int argc, char* argv[])
 {
@@ -97,3 +99,61 @@ int otbRationalTransform(int argc, char* argv[])
   return EXIT_SUCCESS;
 }
 
+
+int otbRationalTransformTransformPoints(int argc, char* argv[])
+{
+  typedef otb::RationalTransform<> RationalTransformType;
+
+  const unsigned int nbPoints = atoi(argv[1]);
+
+  // Instantiation, with the degrees of a RPC model
+  RationalTransformType::Pointer rt = RationalTransformType::New();
+  rt->SetNumeratorDegree(3);
+  rt->SetDenominatorDegree(3);
+
+  RationalTransformType::ParametersType params(rt->GetNumberOfParameters());
+  for(unsigned int i = 0; i < params.Size(); ++i)
+    {
+    params[i] = 1. + 0.1 * i;
+    }
+  rt->SetParameters(params);
+
+  // Points spread over a 10000x10000 image
+  std::vector<double> inputPoints(2 * nbPoints);
+  for(unsigned int i = 0; i < nbPoints; ++i)
+    {
+    inputPoints[2*i]   = (i % 997) * 10.03;
+    inputPoints[2*i+1] = (i / 997) * 10.07;
+    }
+
+  std::vector<double> scalarOutput(2 * nbPoints);
+  std::vector<double> batchOutput(2 * nbPoints);
+
+  RationalTransformType::InputPointType inputPoint;
+  RationalTransformType::OutputPointType outputPoint;
+
+  for(unsigned int i = 0; i < nbPoints; ++i)
+    {
+    inputPoint[0] = inputPoints[2*i];
+    inputPoint[1] = inputPoints[2*i+1];
+    outputPoint = rt->TransformPoint(inputPoint);
+    scalarOutput[2*i]   = outputPoint[0];
+    scalarOutput[2*i+1] = outputPoint[1];
+    }
+
+  rt->TransformPoints(&inputPoints[0], &batchOutput[0], nbPoints);
+
+  // Both paths use the same accumulation order, only allow for
+  // floating point contraction differences
+  for(unsigned int i = 0; i < 2 * nbPoints; ++i)
+    {
+    if(vcl_abs(scalarOutput[i] - batchOutput[i]) > 1e-12 * (1. + vcl_abs(scalarOutput[i])))
+      {
+      std::cerr<<"Mismatch at coordinate "<<i<<": TransformPoint gives "<<scalarOutput[i]
+               <<", TransformPoints gives "<<batchOutput[i]<<std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,144 @@
+/*=========================================================================
+
+  Program:   ORFEO Toolbox
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+
+  Copyright (c) Centre National d'Etudes Spatiales. All rights reserved.
+  See OTBCopyright.txt for details.
+
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+
+#include "itkExceptionObject.h"
+#include "itkVariableLengthVector.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "vnl/algo/vnl_complex_eigensystem.h"
+
+#include "otbHermitian3x3EigenSolver.h"
+
+typedef std::complex<double>                   ComplexType;
+typedef itk::VariableLengthVector<ComplexType> MatrixType;
+
+// Check the decomposition of the matrix against vnl_complex_eigensystem
+bool CheckHermitian3x3EigenSolver(const MatrixType& matrix)
+{
+  vnl_matrix<ComplexType> vnlMat(3, 3);
+  vnlMat[0][0] = matrix[0];
+  vnlMat[0][1] = std::conj(matrix[1]);
+  vnlMat[0][2] = std::conj(matrix[2]);
+  vnlMat[1][0] = matrix[1];
+  vnlMat[1][1] = matrix[3];
+  vnlMat[1][2] = std::conj(matrix[4]);
+  vnlMat[2][0] = matrix[2];
+  vnlMat[2][1] = matrix[4];
+  vnlMat[2][2] = matrix[5];
+
+  // vnl_complex_eigensystem does not accept the null matrix
+  double ref[3] = {0., 0., 0.};
+  if (!vnlMat.is_zero())
+    {
+    vnl_complex_eigensystem syst(vnlMat, false, true);
+    for (unsigned int i = 0; i < 3; ++i)
+      {
+      ref[i] = syst.W[i].real();
+      }
+    }
+  std::sort(ref, ref + 3);
+  std::reverse(ref, ref + 3);
+
+  otb::Hermitian3x3EigenSolver solver;
+  solver.Compute(matrix);
+
+  const double tol = 1e-9 * std::max(1., vnlMat.array_inf_norm());
+
+  for (unsigned int i = 0; i < 3; ++i)
+    {
+    const double lambda = solver.GetEigenValue(i);
+    if (vcl_abs(lambda - ref[i]) > tol)
+      {
+      std::cout << "Eigen value " << i << ": " << lambda << " instead of " << ref[i] << std::endl;
+      return false;
+      }
+
+    // M v = lambda v
+    const ComplexType * v = solver.GetEigenVector(i);
+    for (unsigned int r = 0; r < 3; ++r)
+      {
+      ComplexType mv = vnlMat[r][0] * v[0] + vnlMat[r][1] * v[1] + vnlMat[r][2] * v[2];
+      if (std::abs(mv - lambda * v[r]) > tol)
+        {
+        std::cout << "Eigen vector " << i << " does not match its eigen value" << std::endl;
+        return false;
+        }
+      }
+
+    // Orthonormal basis
+    for (unsigned int j = 0; j <= i; ++j)
+      {
+      const ComplexType * w = solver.GetEigenVector(j);
+      ComplexType dot = std::conj(w[0]) * v[0] + std::conj(w[1]) * v[1] + std::conj(w[2]) * v[2];
+      if (std::abs(dot - ComplexType(i == j ? 1. : 0., 0.)) > 1e-9)
+        {
+        std::cout << "Eigen vectors " << j << " and " << i << " are not orthonormal" << std::endl;
+        return false;
+        }
+      }
+    }
+  return true;
+}
+
+int otbHermitian3x3EigenSolver(int argc, char * argv[])
+{
+  MatrixType matrix(6);
+
+  // Null matrix and multiple of the identity
+  matrix.Fill(ComplexType(0., 0.));
+  if (!CheckHermitian3x3EigenSolver(matrix)) return EXIT_FAILURE;
+  matrix[0] = matrix[3] = matrix[5] = ComplexType(2.5, 0.);
+  if (!CheckHermitian3x3EigenSolver(matrix)) return EXIT_FAILURE;
+
+  // Double eigen value
+  matrix[5] = ComplexType(7., 0.);
+  if (!CheckHermitian3x3EigenSolver(matrix)) return EXIT_FAILURE;
+  matrix[0] = ComplexType(-1., 0.);
+  if (!CheckHermitian3x3EigenSolver(matrix)) return EXIT_FAILURE;
+
+  // Rank one coherency matrix of a pure target
+  ComplexType k[3] = {ComplexType(1., 4.), ComplexType(2., 3.), ComplexType(-3., 2.)};
+  matrix[0] = k[0] * std::conj(k[0]);
+  matrix[1] = k[1] * std::conj(k[0]);
+  matrix[2] = k[2] * std::conj(k[0]);
+  matrix[3] = k[1] * std::conj(k[1]);
+  matrix[4] = k[2] * std::conj(k[1]);
+  matrix[5] = k[2] * std::conj(k[2]);
+  if (!CheckHermitian3x3EigenSolver(matrix)) return EXIT_FAILURE;
+
+  // Random Hermitian matrices of various magnitudes
+  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator GeneratorType;
+  GeneratorType::Pointer generator = GeneratorType::New();
+  generator->Initialize(12345);
+
+  for (unsigned int n = 0; n < 1000; ++n)
+    {
+    const double scale = vcl_pow(10., static_cast<double>(n % 7) - 3.);
+    for (unsigned int i = 0; i < 6; ++i)
+      {
+      matrix[i] = ComplexType(generator->GetUniformVariate(-scale, scale),
+                              (i == 0 || i == 3 || i == 5) ? 0. : generator->GetUniformVariate(-scale, scale));
+      }
+    if (!CheckHermitian3x3EigenSolver(matrix))
+      {
+      std::cout << "Matrix: " << matrix << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
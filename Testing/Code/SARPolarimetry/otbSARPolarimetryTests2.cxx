@@ -32,6 +32,8 @@ void RegisterTests()
   REGISTER_TEST(otbReciprocalLinearCovarianceToReciprocalCircularCovarianceImageFilter);
   REGISTER_TEST(otbReciprocalHAlphaImageFilterNew);
   REGISTER_TEST(otbReciprocalHAlphaImageFilter);
+  REGISTER_TEST(otbHermitian3x3EigenSolver);
+  REGISTER_TEST(otbSinclairToReciprocalHAlphaImageFilter);
   REGISTER_TEST(otbReciprocalCoherencyToReciprocalMuellerImageFilterNew);
   REGISTER_TEST(otbReciprocalCoherencyToReciprocalMuellerImageFilter);
   REGISTER_TEST(otbMuellerToPolarisationDegreeAndPowerImageFilterNew);
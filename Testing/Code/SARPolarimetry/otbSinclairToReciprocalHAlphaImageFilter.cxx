@@ -0,0 +1,188 @@
+/*=========================================================================
+
+  Program:   ORFEO Toolbox
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+
+  Copyright (c) Centre National d'Etudes Spatiales. All rights reserved.
+  See OTBCopyright.txt for details.
+
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+
+#include "itkExceptionObject.h"
+#include "itkImageRegionIterator.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+
+#include "otbImage.h"
+#include "otbVectorImage.h"
+#include "otbSinclairReciprocalImageFilter.h"
+#include "otbSinclairToReciprocalCoherencyMatrixFunctor.h"
+#include "otbReciprocalHAlphaImageFilter.h"
+#include "otbSinclairToReciprocalHAlphaImageFilter.h"
+
+typedef std::complex<double>                        ComplexType;
+typedef otb::Image<ComplexType, 2>                  ImageType;
+typedef otb::VectorImage<ComplexType, 2>            CoherencyImageType;
+typedef otb::VectorImage<double, 2>                 RealImageType;
+
+typedef otb::Functor::SinclairToReciprocalCoherencyMatrixFunctor<ComplexType, ComplexType, ComplexType,
+    CoherencyImageType::PixelType>                                                          CoherencyFunctorType;
+typedef otb::SinclairReciprocalImageFilter<ImageType, ImageType, ImageType, CoherencyImageType,
+    CoherencyFunctorType>                                                                   CoherencyFilterType;
+typedef otb::Functor::ReciprocalHAlphaFunctor<CoherencyImageType::PixelType, RealImageType::PixelType> HAlphaFunctorType;
+typedef otb::SinclairToReciprocalHAlphaImageFilter<ImageType, ImageType, ImageType, RealImageType> FilterType;
+typedef itk::Statistics::MersenneTwisterRandomVariateGenerator GeneratorType;
+
+// Random Sinclair images of the given amplitude, with a stronger HH-VV
+// correlated part
+static void GenerateSinclairImages(GeneratorType * generator, const ImageType::RegionType& region,
+                                   double amplitude, ImageType::Pointer images[3])
+{
+  for (unsigned int i = 0; i < 3; ++i)
+    {
+    images[i] = ImageType::New();
+    images[i]->SetRegions(region);
+    images[i]->Allocate();
+    }
+  itk::ImageRegionIterator<ImageType> itHH(images[0], region);
+  itk::ImageRegionIterator<ImageType> itHV(images[1], region);
+  itk::ImageRegionIterator<ImageType> itVV(images[2], region);
+  for (itHH.GoToBegin(), itHV.GoToBegin(), itVV.GoToBegin(); !itHH.IsAtEnd(); ++itHH, ++itHV, ++itVV)
+    {
+    const ComplexType common(generator->GetNormalVariate() * 3., generator->GetNormalVariate() * 3.);
+    itHH.Set(amplitude * (common + ComplexType(generator->GetNormalVariate(), generator->GetNormalVariate())));
+    itHV.Set(amplitude * ComplexType(generator->GetNormalVariate(), generator->GetNormalVariate()));
+    itVV.Set(amplitude * (common + ComplexType(generator->GetNormalVariate(), generator->GetNormalVariate())));
+    }
+}
+
+// Compare the filter with the coherency image, followed by the
+// averaging and the H-Alpha functor pixel by pixel
+static bool CheckAgainstChain(ImageType::Pointer images[3], const FilterType::SizeType& radius)
+{
+  const ImageType::RegionType region = images[0]->GetLargestPossibleRegion();
+
+  CoherencyFilterType::Pointer coherencyFilter = CoherencyFilterType::New();
+  coherencyFilter->SetInputHH(images[0]);
+  coherencyFilter->SetInputHV_VH(images[1]);
+  coherencyFilter->SetInputVV(images[2]);
+  coherencyFilter->Update();
+  CoherencyImageType::Pointer coherency = coherencyFilter->GetOutput();
+
+  HAlphaFunctorType hAlphaFunctor;
+
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInputHH(images[0]);
+  filter->SetInputHV_VH(images[1]);
+  filter->SetInputVV(images[2]);
+  filter->SetRadius(radius);
+  filter->Update();
+
+  if (filter->GetOutput()->GetNumberOfComponentsPerPixel() != 3)
+    {
+    std::cout << "Wrong number of channels" << std::endl;
+    return false;
+    }
+
+  itk::ImageRegionConstIteratorWithIndex<RealImageType> it(filter->GetOutput(), region);
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+    const RealImageType::IndexType index = it.GetIndex();
+
+    // Average over the window, replicating the image borders
+    CoherencyImageType::PixelType mean(6);
+    mean.Fill(ComplexType(0., 0.));
+    for (long dy = -static_cast<long>(radius[1]); dy <= static_cast<long>(radius[1]); ++dy)
+      {
+      for (long dx = -static_cast<long>(radius[0]); dx <= static_cast<long>(radius[0]); ++dx)
+        {
+        CoherencyImageType::IndexType neighbor;
+        neighbor[0] = std::min(std::max(index[0] + dx, 0L), static_cast<long>(region.GetSize()[0]) - 1);
+        neighbor[1] = std::min(std::max(index[1] + dy, 0L), static_cast<long>(region.GetSize()[1]) - 1);
+        mean += coherency->GetPixel(neighbor);
+        }
+      }
+    mean /= static_cast<double>((2 * radius[0] + 1) * (2 * radius[1] + 1));
+
+    const RealImageType::PixelType ref = hAlphaFunctor(mean);
+    const RealImageType::PixelType value = it.Get();
+    for (unsigned int c = 0; c < 3; ++c)
+      {
+      if (vcl_abs(value[c] - ref[c]) > 1e-9 * std::max(1., vcl_abs(ref[c])))
+        {
+        std::cout << "Radius " << radius << ", pixel " << index << ": got " << value
+                  << " instead of " << ref << std::endl;
+        return false;
+        }
+      }
+    }
+  return true;
+}
+
+int otbSinclairToReciprocalHAlphaImageFilter(int argc, char * argv[])
+{
+  GeneratorType::Pointer generator = GeneratorType::New();
+  generator->Initialize(4321);
+
+  ImageType::RegionType region;
+  region.SetSize(0, 37);
+  region.SetSize(1, 23);
+
+  FilterType::SizeType radiusList[2];
+  radiusList[0][0] = 2;
+  radiusList[0][1] = 1;
+  radiusList[1][0] = 1;
+  radiusList[1][1] = 3;
+
+  // Unit amplitudes, then a total power around 1e-6, where the H-Alpha
+  // functor clamps the sum of the eigenvalues: the coherency must be
+  // scaled exactly as in the chain
+  const double amplitudes[2] = {1., 2e-4};
+
+  ImageType::Pointer images[3];
+  for (unsigned int a = 0; a < 2; ++a)
+    {
+    GenerateSinclairImages(generator, region, amplitudes[a], images);
+    for (unsigned int r = 0; r < 2; ++r)
+      {
+      if (!CheckAgainstChain(images, radiusList[r]))
+        {
+        std::cout << "Amplitude " << amplitudes[a] << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  // Inputs of different sizes must be rejected
+  ImageType::RegionType smallerRegion = region;
+  smallerRegion.SetSize(1, region.GetSize()[1] - 1);
+  ImageType::Pointer smallerVV = ImageType::New();
+  smallerVV->SetRegions(smallerRegion);
+  smallerVV->Allocate();
+  smallerVV->FillBuffer(ComplexType(1., 0.));
+
+  FilterType::Pointer mismatchFilter = FilterType::New();
+  mismatchFilter->SetInputHH(images[0]);
+  mismatchFilter->SetInputHV_VH(images[1]);
+  mismatchFilter->SetInputVV(smallerVV);
+  try
+    {
+    mismatchFilter->Update();
+    }
+  catch (itk::ExceptionObject& err)
+    {
+    std::cout << "Expected exception: " << err.GetDescription() << std::endl;
+    return EXIT_SUCCESS;
+    }
+
+  std::cout << "Inputs of different sizes have not been rejected" << std::endl;
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,212 @@
+/*=========================================================================
+
+  Program:   ORFEO Toolbox
+  Language:  C++
+  Date:      $Date$
+  Version:   $Revision$
+
+
+  Copyright (c) Centre National d'Etudes Spatiales. All rights reserved.
+  See OTBCopyright.txt for details.
+
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notices for more information.
+
+=========================================================================*/
+#include "otbImageLayer.h"
+#include "otbStandardRenderingFunction.h"
+#include "otbRenderingImageFilter.h"
+#include "otbImage.h"
+#include "otbImageFileReader.h"
+#include "otbImageFileWriter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "itkCommand.h"
+
+typedef otb::Image<double, 2>                                             ImageType;
+typedef otb::Image<itk::RGBAPixel<unsigned char>, 2>                      OutputImageType;
+typedef otb::ImageFileReader<ImageType>                                   ReaderType;
+typedef otb::ImageFileWriter<ImageType>                                   WriterType;
+typedef otb::ImageLayer<ImageType, OutputImageType>                       LayerType;
+typedef otb::RenderingImageFilter<ImageType, OutputImageType>             RenderingFilterType;
+typedef otb::Function::StandardRenderingFunction<double,
+                                                 OutputImageType::PixelType> RenderingFunctionType;
+typedef RenderingFunctionType::ParametersType                             ParametersType;
+
+// Synthetic image written to a file
+static ImageType::Pointer WriteImage(const char * filename, unsigned int factor)
+{
+  ImageType::RegionType largestRegion;
+  largestRegion.SetSize(0, 700);
+  largestRegion.SetSize(1, 500);
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(largestRegion);
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex<ImageType> it(image, largestRegion);
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+    it.Set((it.GetIndex()[0] * factor + it.GetIndex()[1] * 3) % 256);
+    }
+
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetFileName(filename);
+  writer->SetInput(image);
+  writer->Update();
+
+  return image;
+}
+
+// Count the pixels read from the file
+static void CountReadPixels(itk::Object * caller, const itk::EventObject&, void * clientData)
+{
+  *static_cast<unsigned long *>(clientData) +=
+    static_cast<ReaderType *>(caller)->GetOutput()->GetBufferedRegion().GetNumberOfPixels();
+}
+
+// Compare the extract rendered by the layer with the direct rendering
+static bool CheckRenderedExtract(LayerType * layer, OutputImageType * reference)
+{
+  OutputImageType *            extract = layer->GetRenderedExtract();
+  const ImageType::RegionType& region = layer->GetExtractRegion();
+
+  if (extract->GetLargestPossibleRegion() != region)
+    {
+    std::cout << "Wrong extract region " << extract->GetLargestPossibleRegion() << std::endl;
+    return false;
+    }
+
+  itk::ImageRegionConstIterator<OutputImageType> it(extract, region);
+  itk::ImageRegionConstIterator<OutputImageType> refIt(reference, region);
+  for (it.GoToBegin(), refIt.GoToBegin(); !it.IsAtEnd(); ++it, ++refIt)
+    {
+    if (it.Get() != refIt.Get())
+      {
+      std::cout << "Wrong rendering in extract " << region.GetIndex() << std::endl;
+      return false;
+      }
+    }
+  return true;
+}
+
+int otbImageLayerTileCache(int argc, char * argv[])
+{
+  ImageType::Pointer image = WriteImage(argv[1], 7);
+  ImageType::Pointer otherImage = WriteImage(argv[2], 5);
+
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+  reader->UpdateOutputInformation();
+  const ImageType::RegionType largestRegion = reader->GetOutput()->GetLargestPossibleRegion();
+
+  unsigned long nbReadPixels = 0;
+  itk::CStyleCommand::Pointer command = itk::CStyleCommand::New();
+  command->SetCallback(&CountReadPixels);
+  command->SetClientData(&nbReadPixels);
+  reader->AddObserver(itk::EndEvent(), command);
+
+  ParametersType parameters(2);
+  parameters[0] = 20;
+  parameters[1] = 230;
+
+  RenderingFunctionType::Pointer function = RenderingFunctionType::New();
+  function->AutoMinMaxOff();
+  function->SetParameters(parameters);
+
+  LayerType::Pointer layer = LayerType::New();
+  layer->SetExtent(largestRegion);
+  layer->SetVisible(true);
+  layer->SetHasQuicklook(false);
+  layer->SetImage(reader->GetOutput());
+  layer->SetRenderingFunction(function);
+  layer->SetTileSize(64);
+  layer->SetMaximumNumberOfCachedTiles(24);
+
+  // Direct rendering of the whole image
+  RenderingFilterType::Pointer rendering = RenderingFilterType::New();
+  rendering->SetInput(image);
+  rendering->SetRenderingFunction(function);
+  rendering->Update();
+
+  // After a first extract, panning by one tile reads the 7 new tiles
+  // only, not their bounding box, and panning back reads nothing
+  const long int      panPositions[][2] = {{0, 0}, {64, 64}, {0, 0}};
+  const unsigned long expectedReadPixels[] = {0, 7 * 64 * 64, 0};
+  ImageType::RegionType extractRegion;
+  extractRegion.SetSize(0, 280);
+  extractRegion.SetSize(1, 190);
+  for (unsigned int i = 0; i < 3; ++i)
+    {
+    nbReadPixels = 0;
+    extractRegion.SetIndex(0, panPositions[i][0]);
+    extractRegion.SetIndex(1, panPositions[i][1]);
+    layer->SetExtractRegion(extractRegion);
+    layer->Render();
+
+    if (i > 0 && nbReadPixels != expectedReadPixels[i])
+      {
+      std::cout << nbReadPixels << " pixels read when panning to " << extractRegion.GetIndex() << ", "
+                << expectedReadPixels[i] << " expected" << std::endl;
+      return EXIT_FAILURE;
+      }
+    if (!CheckRenderedExtract(layer, rendering->GetOutput()))
+      {
+      return EXIT_FAILURE;
+      }
+    }
+
+  // Pan across the image, back and forth
+  const long int positions[][2] = {{0, 0}, {40, 25}, {300, 100}, {420, 310}, {310, 110}, {0, 0}};
+  const unsigned int nbPositions = sizeof(positions) / sizeof(positions[0]);
+
+  for (unsigned int i = 0; i < nbPositions; ++i)
+    {
+    extractRegion.SetIndex(0, positions[i][0]);
+    extractRegion.SetIndex(1, positions[i][1]);
+    layer->SetExtractRegion(extractRegion);
+    layer->Render();
+
+    if (!CheckRenderedExtract(layer, rendering->GetOutput()))
+      {
+      return EXIT_FAILURE;
+      }
+    }
+
+  // Modifying the rendering function must invalidate the cached tiles
+  parameters[0] = 60;
+  parameters[1] = 120;
+  function->SetParameters(parameters);
+  rendering->Modified();
+  rendering->Update();
+  layer->Render();
+
+  if (!CheckRenderedExtract(layer, rendering->GetOutput()))
+    {
+    return EXIT_FAILURE;
+    }
+
+  // Pixel values are still exact in the extract
+  ImageType::IndexType index = extractRegion.GetIndex();
+  index[0] += 250;
+  index[1] += 180;
+  if (layer->GetValueAtIndex(index)[0] != image->GetPixel(index))
+    {
+    std::cout << "Wrong value at " << index << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Reading another file must invalidate the cached tiles
+  reader->SetFileName(argv[2]);
+  rendering->SetInput(otherImage);
+  rendering->Update();
+  layer->Render();
+
+  if (!CheckRenderedExtract(layer, rendering->GetOutput()))
+    {
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -39,6 +39,7 @@ void RegisterTests()
   REGISTER_TEST(otbRenderingImageFilterPhase);
   REGISTER_TEST(otbImageLayerScalar);
   REGISTER_TEST(otbImageLayerVector);
+  REGISTER_TEST(otbImageLayerTileCache);
   REGISTER_TEST(otbLayerBasedModelNew);
   REGISTER_TEST(otbImageLayerRenderingModelNew);
   REGISTER_TEST(otbImageLayerRenderingModelSingleLayer);
@@ -128,6 +128,17 @@ private:
     void EnableByteCode(bool a_bIsOn=true);
     void EnableBuiltInOprt(bool a_bIsOn=true);
 
+    /*** Begin OTB modification ***/
+    /** \brief Return the bytecode of the expression.
+
+      The bytecode is only valid once the expression has been evaluated.
+    */
+    const ParserByteCode& GetByteCode() const
+    {
+      return m_vByteCode;
+    }
+    /*** End OTB modification ***/
+
     bool HasBuiltInOprt() const;
     void AddValIdent(identfun_type a_pCallback);
 